@@ -0,0 +1,268 @@
+// attitude_bench: star-tracker pointing reconstruction for a swarm.
+//
+//     attitude_bench [--spacecraft N] [--frames F] [--batches B] [--stars S]
+//                    [--catalog C] [--drift ARCSEC] [--threads T] [--seed X]
+//
+// Scatters S stars over the sky and keeps the brightest C as the onboard
+// catalogue, so frames also hold stars the catalogue lacks. Each of N
+// spacecraft starts at a random attitude and drifts by about ARCSEC per
+// frame; every batch renders F star-camera frames per spacecraft
+// (Gaussian PSF, shot and read noise) and runs StarTracker::solve_batch.
+// The first batch is lost in space for every craft, later ones track.
+// Reports frames/s and batch latency, identification rate,
+// cross-boresight and roll error against the truth, single-frame solve()
+// latency in each mode, and quest_batch() against per-profile quest().
+// Exits non-zero if under 99% of frames are identified or the median
+// cross-boresight error reaches one arcsecond.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <numbers>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "solarlens/attitude/quest.hpp"
+#include "solarlens/attitude/star_catalog.hpp"
+#include "solarlens/attitude/star_tracker.hpp"
+#include "solarlens/sched/scheduler.hpp"
+
+namespace {
+
+using namespace solarlens;
+using Clock = std::chrono::steady_clock;
+
+constexpr double arcsec = std::numbers::pi / (180.0 * 3600.0);
+
+double seconds_since(Clock::time_point t0)
+{
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+double percentile(std::vector<double> v, double q)
+{
+    if (v.empty())
+        return 0.0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, static_cast<std::size_t>(q * double(v.size())))];
+}
+
+attitude::Quaternion random_attitude(std::mt19937_64& rng)
+{
+    std::normal_distribution<double> g(0.0, 1.0);
+    attitude::Quaternion q {g(rng), g(rng), g(rng), g(rng)};
+    const double n = std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w);
+    return {q.x / n, q.y / n, q.z / n, q.w / n};
+}
+
+// Small rotation of about `angle` radians about a random axis, applied in
+// the body frame.
+attitude::Quaternion drifted(const attitude::Quaternion& q, double angle, std::mt19937_64& rng)
+{
+    std::normal_distribution<double> g(0.0, 1.0);
+    const attitude::Vec3 axis = attitude::normalized({g(rng), g(rng), g(rng)});
+    return attitude::compose(attitude::Quaternion::from_axis_angle(axis, angle), q);
+}
+
+void render(const attitude::StarCatalog& sky, const attitude::CameraModel& camera, const attitude::Quaternion& q,
+            std::vector<float>& image, std::mt19937_64& rng)
+{
+    constexpr double background = 100.0;
+    constexpr double read_noise = 5.0;
+    constexpr double psf_sigma = 1.0;
+    constexpr int box = 4;
+    const std::uint32_t w = camera.width;
+    const std::uint32_t h = camera.height;
+    image.assign(std::size_t(w) * h, float(background));
+    std::vector<std::uint32_t> visible;
+    sky.within(q.to_inertial({0.0, 0.0, 1.0}), camera.field_radius() + 0.01, visible);
+    for (const std::uint32_t s : visible) {
+        const attitude::Vec3 b = q.to_body(sky.star(s).direction);
+        if (b[2] <= 0.0)
+            continue;
+        const auto [px, py] = camera.project(b);
+        // Magnitude 6 gives about 20000 electrons.
+        const double flux = 20000.0 * std::pow(10.0, -0.4 * (double(sky.star(s).magnitude) - 6.0));
+        const long cx = std::lround(px);
+        const long cy = std::lround(py);
+        for (long y = cy - box; y <= cy + box; ++y)
+            for (long x = cx - box; x <= cx + box; ++x) {
+                if (x < 0 || y < 0 || x >= long(w) || y >= long(h))
+                    continue;
+                // Pixel-integrated Gaussian.
+                const auto cdf = [](double t) { return 0.5 * std::erfc(-t / (psf_sigma * std::numbers::sqrt2)); };
+                const double fx = cdf(double(x) + 0.5 - px) - cdf(double(x) - 0.5 - px);
+                const double fy = cdf(double(y) + 0.5 - py) - cdf(double(y) - 0.5 - py);
+                image[std::size_t(y) * w + std::size_t(x)] += float(flux * fx * fy);
+            }
+    }
+    std::normal_distribution<float> g(0.0f, 1.0f);
+    for (float& v : image)
+        v += g(rng) * std::sqrt(float(read_noise * read_noise) + std::max(v, 0.0f));
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::size_t spacecraft = 8;
+    std::size_t frames_per_batch = 4;
+    std::size_t batches = 4;
+    std::size_t sky_stars = 24000;
+    std::size_t catalog_stars = 12000;
+    double drift_arcsec = 30.0;
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::uint64_t seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string flag = argv[i];
+        if (flag == "--spacecraft")
+            spacecraft = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (flag == "--frames")
+            frames_per_batch = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (flag == "--batches")
+            batches = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (flag == "--stars")
+            sky_stars = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (flag == "--catalog")
+            catalog_stars = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (flag == "--drift")
+            drift_arcsec = std::atof(argv[i + 1]);
+        else if (flag == "--threads")
+            threads = static_cast<unsigned>(std::max(1, std::atoi(argv[i + 1])));
+        else if (flag == "--seed")
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+    }
+    catalog_stars = std::min(catalog_stars, sky_stars);
+
+    // Uniform sky with N(<m) growing as 10^(0.5 m).
+    std::mt19937_64 rng(seed);
+    std::normal_distribution<double> g(0.0, 1.0);
+    std::uniform_real_distribution<double> uniform(0.0, 1.0);
+    std::vector<attitude::CatalogStar> stars(sky_stars);
+    for (std::size_t i = 0; i < sky_stars; ++i) {
+        const double m = 7.5 + 2.0 * std::log10(std::max(uniform(rng), 1e-12));
+        stars[i] = {std::uint32_t(i), attitude::normalized({g(rng), g(rng), g(rng)}), float(m)};
+    }
+    std::sort(stars.begin(), stars.end(), [](const auto& a, const auto& b) { return a.magnitude < b.magnitude; });
+
+    attitude::StarTrackerConfig config;
+    const double field = 2.0 * config.camera.field_radius();
+    const auto t_catalog = Clock::now();
+    const attitude::StarCatalog catalog({stars.begin(), stars.begin() + std::ptrdiff_t(catalog_stars)}, field);
+    const double catalog_seconds = seconds_since(t_catalog);
+    const attitude::StarCatalog sky(stars, 1e-6);
+    std::printf("catalogue: %zu stars to magnitude %.2f, %zu pairs under %.1f deg, %.2f MB, built in %.2f s\n",
+                catalog.size(), double(stars[catalog_stars - 1].magnitude), catalog.pair_count(),
+                field * 180.0 / std::numbers::pi, double(catalog.memory_bytes()) / 1e6, catalog_seconds);
+
+    sched::Scheduler scheduler(threads);
+    attitude::StarTracker tracker(catalog, config);
+    std::vector<attitude::Quaternion> truth(spacecraft);
+    for (auto& q : truth)
+        q = random_attitude(rng);
+
+    const std::size_t per_batch = spacecraft * frames_per_batch;
+    const std::size_t pixels = std::size_t(config.camera.width) * config.camera.height;
+    std::vector<std::vector<float>> images(per_batch, std::vector<float>(pixels));
+    std::vector<attitude::StarFrame> frames(per_batch);
+    std::vector<attitude::Quaternion> frame_truth(per_batch);
+    std::vector<attitude::AttitudeSolution> solutions(per_batch);
+    std::vector<double> cross_errors;
+    std::vector<double> roll_errors;
+    std::vector<double> batch_seconds;
+    std::size_t identified = 0;
+    std::size_t total = 0;
+    std::size_t lost_in_space = 0;
+    double solve_seconds = 0.0;
+    for (std::size_t b = 0; b < batches; ++b) {
+        for (std::size_t c = 0; c < spacecraft; ++c)
+            for (std::size_t f = 0; f < frames_per_batch; ++f) {
+                const std::size_t i = c * frames_per_batch + f;
+                truth[c] = drifted(truth[c], drift_arcsec * arcsec, rng);
+                frame_truth[i] = truth[c];
+                render(sky, config.camera, truth[c], images[i], rng);
+                frames[i] = {std::uint32_t(c), {images[i].data(), config.camera.width, config.camera.height}};
+            }
+        const auto t0 = Clock::now();
+        tracker.solve_batch(frames, solutions, scheduler);
+        const double seconds = seconds_since(t0);
+        batch_seconds.push_back(seconds);
+        if (b > 0)
+            solve_seconds += seconds;
+        for (std::size_t i = 0; i < per_batch; ++i) {
+            ++total;
+            const attitude::AttitudeSolution& s = solutions[i];
+            if (!s.valid())
+                continue;
+            ++identified;
+            lost_in_space += s.mode == attitude::IdentificationMode::lost_in_space;
+            const attitude::Quaternion e = attitude::compose(s.q, frame_truth[i].conjugate());
+            cross_errors.push_back(2.0 * std::hypot(e.x, e.y) / arcsec);
+            roll_errors.push_back(2.0 * std::abs(e.z) / arcsec);
+        }
+    }
+    const double rate = double(identified) / double(std::max<std::size_t>(total, 1));
+    std::printf("%zu spacecraft x %zu frames x %zu batches, %u x %u px, %u threads\n", spacecraft,
+                frames_per_batch, batches, config.camera.width, config.camera.height, threads);
+    std::printf("identified %.2f%% (%zu lost in space), first batch %.3f s, tracking %.1f frames/s, "
+                "batch latency p50 %.1f ms\n",
+                100.0 * rate, lost_in_space, batch_seconds.front(),
+                batches > 1 ? double(per_batch * (batches - 1)) / solve_seconds : 0.0,
+                1e3 * percentile({batch_seconds.begin() + (batches > 1), batch_seconds.end()}, 0.5));
+    std::printf("cross-boresight error p50 %.3f p99 %.3f arcsec, roll p50 %.2f p99 %.2f arcsec\n",
+                percentile(cross_errors, 0.5), percentile(cross_errors, 0.99), percentile(roll_errors, 0.5),
+                percentile(roll_errors, 0.99));
+
+    // Single-frame latency per mode on the last batch's images.
+    std::vector<double> lis_ms;
+    std::vector<double> track_ms;
+    std::size_t stars_detected = 0;
+    std::size_t stars_matched = 0;
+    for (std::size_t i = 0; i < per_batch; ++i) {
+        auto t0 = Clock::now();
+        const attitude::AttitudeSolution lost = tracker.solve(frames[i].image);
+        lis_ms.push_back(1e3 * seconds_since(t0));
+        t0 = Clock::now();
+        const attitude::AttitudeSolution tracked = tracker.solve(frames[i].image, &frame_truth[i]);
+        track_ms.push_back(1e3 * seconds_since(t0));
+        stars_detected += tracked.stars_detected;
+        stars_matched += tracked.stars_matched;
+        (void)lost;
+    }
+    std::printf("solve(): lost in space p50 %.2f p99 %.2f ms, tracking p50 %.2f p99 %.2f ms, "
+                "%.1f stars detected and %.1f matched per frame\n",
+                percentile(lis_ms, 0.5), percentile(lis_ms, 0.99), percentile(track_ms, 0.5),
+                percentile(track_ms, 0.99), double(stars_detected) / double(per_batch),
+                double(stars_matched) / double(per_batch));
+
+    // QUEST throughput on random 12-star problems.
+    std::vector<attitude::AttitudeProfile> profiles(200'000);
+    for (auto& p : profiles) {
+        const attitude::Quaternion q = random_attitude(rng);
+        for (int k = 0; k < 12; ++k) {
+            const attitude::Vec3 r = attitude::normalized({g(rng), g(rng), g(rng)});
+            p.add(q.to_body(r), r);
+        }
+    }
+    std::vector<attitude::AttitudeFit> batch(profiles.size());
+    std::vector<attitude::AttitudeFit> single(profiles.size());
+    auto t0 = Clock::now();
+    attitude::quest_batch(profiles, batch);
+    const double batch_ns = 1e9 * seconds_since(t0) / double(profiles.size());
+    t0 = Clock::now();
+    for (std::size_t i = 0; i < profiles.size(); ++i)
+        single[i] = attitude::quest(profiles[i]);
+    const double single_ns = 1e9 * seconds_since(t0) / double(profiles.size());
+    double worst = 0.0;
+    for (std::size_t i = 0; i < profiles.size(); ++i)
+        worst = std::max(worst, attitude::attitude_error(batch[i].q, single[i].q));
+    std::printf("quest: %.1f ns per solve batched, %.1f ns one at a time, max difference %.2e rad\n", batch_ns,
+                single_ns, worst);
+
+    const bool ok = rate >= 0.99 && percentile(cross_errors, 0.5) < 1.0 && worst < 1e-12;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,240 @@
+// bus_bench: telemetry bus fan-out latency against a mutex/condvar queue.
+//
+//     bus_bench [--subscribers N] [--publishers P] [--messages M]
+//               [--interval-us U] [--capacity C]
+//
+// P publisher threads share one topic and publish M housekeeping messages
+// each, one every U microseconds (0 = as fast as possible); N subscriber
+// threads block in wait_receive() and record publish-to-receive latency.
+// The same traffic then goes through per-subscriber std::mutex +
+// std::condition_variable queues for comparison. Reports latency
+// percentiles and delivered messages per second.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "solarlens/bus/bus.hpp"
+
+namespace {
+
+using namespace solarlens;
+
+struct Housekeeping {
+    static constexpr std::uint16_t message_type = 1;
+    std::uint16_t spacecraft;
+    std::uint16_t channel;
+    std::uint32_t flags;
+    double value;
+};
+
+struct Result {
+    double seconds = 0.0;
+    std::vector<std::int64_t> latency_ns;
+    std::uint64_t delivered = 0;
+    std::uint64_t dropped = 0;
+};
+
+struct Params {
+    std::size_t subscribers = 16;
+    std::size_t publishers = 1;
+    std::size_t messages = 20000;
+    unsigned interval_us = 20;
+    std::size_t capacity = 4096;
+};
+
+void pace(unsigned interval_us, std::chrono::steady_clock::time_point& next)
+{
+    if (interval_us == 0)
+        return;
+    next += std::chrono::microseconds(interval_us);
+    while (std::chrono::steady_clock::now() < next)
+        std::this_thread::yield();
+}
+
+Result run_bus(const Params& p)
+{
+    bus::TelemetryBus telemetry;
+    auto& topic = telemetry.topic<Housekeeping>(
+        "housekeeping", p.publishers == 1 ? bus::Publishers::single : bus::Publishers::multiple);
+    bus::SubscriberOptions opts;
+    opts.capacity = p.capacity;
+    opts.policy = bus::Backpressure::block;
+    opts.block_timeout = std::chrono::milliseconds(100);
+    std::vector<std::shared_ptr<bus::Subscription<Housekeeping>>> subs;
+    for (std::size_t i = 0; i < p.subscribers; ++i)
+        subs.push_back(topic.subscribe(opts));
+
+    std::vector<std::vector<std::int64_t>> lat(p.subscribers);
+    std::vector<std::thread> consumers;
+    for (std::size_t i = 0; i < p.subscribers; ++i)
+        consumers.emplace_back([&, i] {
+            lat[i].reserve(p.messages * p.publishers);
+            bus::Envelope<Housekeeping> e;
+            while (subs[i]->wait_receive(e))
+                lat[i].push_back(bus::bus_clock_ns() - e.header.publish_ns);
+        });
+
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> producers;
+    for (std::size_t k = 0; k < p.publishers; ++k)
+        producers.emplace_back([&, k] {
+            auto next = std::chrono::steady_clock::now();
+            for (std::size_t m = 0; m < p.messages; ++m) {
+                topic.publish({static_cast<std::uint16_t>(k), 3, 0, double(m)});
+                pace(p.interval_us, next);
+            }
+        });
+    for (auto& t : producers)
+        t.join();
+    for (auto& s : subs)
+        s->close();
+    for (auto& t : consumers)
+        t.join();
+
+    Result r;
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    for (std::size_t i = 0; i < p.subscribers; ++i) {
+        r.latency_ns.insert(r.latency_ns.end(), lat[i].begin(), lat[i].end());
+        r.delivered += subs[i]->stats().delivered;
+        r.dropped += subs[i]->stats().dropped;
+    }
+    return r;
+}
+
+/// The baseline the bus replaces.
+class LockedQueue {
+public:
+    void push(const bus::Envelope<Housekeeping>& e)
+    {
+        {
+            const std::lock_guard lock(mutex_);
+            queue_.push_back(e);
+        }
+        cv_.notify_one();
+    }
+
+    bool pop(bus::Envelope<Housekeeping>& e)
+    {
+        std::unique_lock lock(mutex_);
+        cv_.wait(lock, [&] { return !queue_.empty() || closed_; });
+        if (queue_.empty())
+            return false;
+        e = queue_.front();
+        queue_.pop_front();
+        return true;
+    }
+
+    void close()
+    {
+        {
+            const std::lock_guard lock(mutex_);
+            closed_ = true;
+        }
+        cv_.notify_all();
+    }
+
+private:
+    std::mutex mutex_;
+    std::condition_variable cv_;
+    std::deque<bus::Envelope<Housekeeping>> queue_;
+    bool closed_ = false;
+};
+
+Result run_locked(const Params& p)
+{
+    std::vector<std::unique_ptr<LockedQueue>> queues;
+    for (std::size_t i = 0; i < p.subscribers; ++i)
+        queues.push_back(std::make_unique<LockedQueue>());
+    std::vector<std::vector<std::int64_t>> lat(p.subscribers);
+    std::vector<std::thread> consumers;
+    for (std::size_t i = 0; i < p.subscribers; ++i)
+        consumers.emplace_back([&, i] {
+            lat[i].reserve(p.messages * p.publishers);
+            bus::Envelope<Housekeeping> e;
+            while (queues[i]->pop(e))
+                lat[i].push_back(bus::bus_clock_ns() - e.header.publish_ns);
+        });
+
+    std::atomic<std::uint64_t> sequence {0};
+    const auto t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> producers;
+    for (std::size_t k = 0; k < p.publishers; ++k)
+        producers.emplace_back([&, k] {
+            auto next = std::chrono::steady_clock::now();
+            for (std::size_t m = 0; m < p.messages; ++m) {
+                bus::Envelope<Housekeeping> e {};
+                e.header.sequence = sequence.fetch_add(1, std::memory_order_relaxed);
+                e.header.publish_ns = bus::bus_clock_ns();
+                e.body = {static_cast<std::uint16_t>(k), 3, 0, double(m)};
+                for (auto& q : queues)
+                    q->push(e);
+                pace(p.interval_us, next);
+            }
+        });
+    for (auto& t : producers)
+        t.join();
+    for (auto& q : queues)
+        q->close();
+    for (auto& t : consumers)
+        t.join();
+
+    Result r;
+    r.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    for (const auto& l : lat)
+        r.latency_ns.insert(r.latency_ns.end(), l.begin(), l.end());
+    r.delivered = r.latency_ns.size();
+    return r;
+}
+
+void report(const char* name, Result r)
+{
+    std::sort(r.latency_ns.begin(), r.latency_ns.end());
+    const auto pct = [&](double q) {
+        if (r.latency_ns.empty())
+            return 0.0;
+        const auto i = std::min(r.latency_ns.size() - 1, std::size_t(q * double(r.latency_ns.size())));
+        return 1e-3 * double(r.latency_ns[i]);
+    };
+    std::printf("%-12s %10.2f %10.2f %10.2f %12.3e %10llu\n", name, pct(0.5), pct(0.99),
+                pct(1.0 - 1e-9), double(r.delivered) / r.seconds,
+                static_cast<unsigned long long>(r.dropped));
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    Params p;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string flag = argv[i];
+        if (flag == "--subscribers")
+            p.subscribers = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (flag == "--publishers")
+            p.publishers = std::max<std::size_t>(1, std::strtoul(argv[i + 1], nullptr, 10));
+        else if (flag == "--messages")
+            p.messages = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (flag == "--interval-us")
+            p.interval_us = static_cast<unsigned>(std::atoi(argv[i + 1]));
+        else if (flag == "--capacity")
+            p.capacity = std::strtoul(argv[i + 1], nullptr, 10);
+    }
+    p.subscribers = std::clamp<std::size_t>(p.subscribers, 1, bus::max_subscribers);
+
+    std::printf("%zu publishers x %zu messages, %zu subscribers, interval %u us\n", p.publishers,
+                p.messages, p.subscribers, p.interval_us);
+    std::printf("%-12s %10s %10s %10s %12s %10s\n", "queue", "p50 us", "p99 us", "max us",
+                "deliveries/s", "dropped");
+    report("bus", run_bus(p));
+    report("mutex+cv", run_locked(p));
+    return 0;
+}
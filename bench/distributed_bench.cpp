@@ -0,0 +1,248 @@
+// distributed_bench: strong scaling of the distributed reconstruction.
+//
+//     distributed_bench [--map-size M] [--samples N] [--support R] [--ranks P]
+//                       [--iterations I] [--seed X]
+//     mpirun -n P distributed_bench --mpi 1 [...]
+//
+// Simulates N noisy ring samples of an M x M map, solves them once with a
+// single TileSolver over the whole map, then with DistributedSolver on
+// 1, 2, 4, ... P in-process ranks (threads over make_local_group), each
+// for exactly I CG iterations. Every distributed map must match the
+// single-node one. Per rank count it reports the slowest rank's CPU time,
+// the speedup and parallel efficiency that implies with one core per
+// rank, wall time, and halo values each rank sends per iteration. CPU
+// time is per thread, so the scaling figures hold on a machine with fewer
+// cores than ranks; network latency is not modelled.
+//
+// With --mpi 1 (builds configured with SOLARLENS_WITH_MPI) the world
+// communicator is used instead and rank 0 prints one row.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <time.h>
+
+#ifdef SOLARLENS_BENCH_MPI
+#include <mpi.h>
+#endif
+
+#include "solarlens/recon/communicator.hpp"
+#include "solarlens/recon/distributed.hpp"
+#include "solarlens/recon/psf_kernel.hpp"
+#include "solarlens/recon/tile_solver.hpp"
+
+namespace {
+
+using namespace solarlens;
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point t0)
+{
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+double thread_cpu_seconds()
+{
+    timespec ts {};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return double(ts.tv_sec) + 1e-9 * double(ts.tv_nsec);
+}
+
+double truth(std::uint32_t x, std::uint32_t y, std::uint32_t size)
+{
+    const double u = double(x) / size - 0.5;
+    const double v = double(y) / size - 0.5;
+    const double disc = u * u + v * v < 0.16 ? 1.0 : 0.0;
+    return disc * (0.7 + 0.3 * std::sin(23.0 * u) * std::cos(17.0 * v));
+}
+
+struct RankRun {
+    recon::DistributedReport report;
+    double cpu_seconds = 0.0;
+};
+
+double relative_error(const std::vector<double>& a, const std::vector<double>& b)
+{
+    double num = 0.0;
+    double den = 0.0;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        num += (a[i] - b[i]) * (a[i] - b[i]);
+        den += b[i] * b[i];
+    }
+    return den > 0.0 ? std::sqrt(num / den) : std::sqrt(num);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::uint32_t map_size = 256;
+    std::size_t sample_count = 100'000;
+    double support = 8.0;
+    int max_ranks = 16;
+    int iterations = 40;
+    std::uint64_t seed = 1;
+    bool use_mpi = false;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string flag = argv[i];
+        if (flag == "--map-size")
+            map_size = static_cast<std::uint32_t>(std::atoi(argv[i + 1]));
+        else if (flag == "--samples")
+            sample_count = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (flag == "--support")
+            support = std::atof(argv[i + 1]);
+        else if (flag == "--ranks")
+            max_ranks = std::max(1, std::atoi(argv[i + 1]));
+        else if (flag == "--iterations")
+            iterations = std::max(1, std::atoi(argv[i + 1]));
+        else if (flag == "--seed")
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (flag == "--mpi")
+            use_mpi = std::atoi(argv[i + 1]) != 0;
+    }
+
+    recon::SglPsf::Params params;
+    params.support_radius_px = support;
+    const recon::SglPsf psf(params);
+    const recon::SampledKernel kernel(psf);
+
+    // Samples: noisy PSF-weighted sums over the truth map.
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<float> position(-0.49f, float(map_size) - 0.51f);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::vector<recon::RingSample> samples(sample_count);
+    const double r = kernel.radius();
+    for (auto& s : samples) {
+        s.u = position(rng);
+        s.v = position(rng);
+        double flux = 0.0;
+        const long x_lo = std::max(0L, static_cast<long>(std::ceil(s.u - r)));
+        const long x_hi = std::min(long(map_size) - 1, static_cast<long>(std::floor(s.u + r)));
+        const long y_lo = std::max(0L, static_cast<long>(std::ceil(s.v - r)));
+        const long y_hi = std::min(long(map_size) - 1, static_cast<long>(std::floor(s.v + r)));
+        for (long y = y_lo; y <= y_hi; ++y)
+            for (long x = x_lo; x <= x_hi; ++x) {
+                const double d = std::hypot(double(x) - s.u, double(y) - s.v);
+                if (d < r)
+                    flux += kernel(d) * truth(std::uint32_t(x), std::uint32_t(y), map_size);
+            }
+        s.sigma = 0.05f;
+        s.flux = float(flux + double(s.sigma) * noise(rng));
+    }
+
+    recon::DistributedConfig config;
+    config.map_size = map_size;
+    config.solver.max_iterations = iterations;
+    config.solver.tolerance = 1e-30; // Fixed work per run.
+    config.solver.regularization = 1e-2;
+
+#ifdef SOLARLENS_BENCH_MPI
+    if (use_mpi) {
+        int provided = 0;
+        MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+        {
+            const auto comm = recon::make_mpi_communicator();
+            recon::DistributedSolver solver(psf, config, *comm);
+            solver.add_samples(samples);
+            std::vector<double> x(solver.block().area(), 0.0);
+            comm->barrier();
+            const double cpu0 = thread_cpu_seconds();
+            const auto t0 = Clock::now();
+            const recon::DistributedReport report = solver.solve(x);
+            const double wall = seconds_since(t0);
+            const double cpu = thread_cpu_seconds() - cpu0;
+            std::vector<double> map(comm->rank() == 0 ? std::size_t(map_size) * map_size : 0);
+            solver.gather(x, map);
+            std::vector<double> all(std::size_t(comm->size()), 0.0);
+            all[std::size_t(comm->rank())] = cpu;
+            comm->allreduce_sum(all);
+            if (comm->rank() == 0) {
+                std::printf("%-6s %-7s %6s %12s %12s %10s\n", "ranks", "grid", "iters", "residual", "max cpu s",
+                            "wall s");
+                std::printf("%-6d %3ux%-3u %6d %12.3e %12.3f %10.3f\n", comm->size(), solver.grid().columns,
+                            solver.grid().rows, report.solve.iterations, report.solve.relative_residual,
+                            *std::max_element(all.begin(), all.end()), wall);
+            }
+        }
+        MPI_Finalize();
+        return 0;
+    }
+#else
+    if (use_mpi) {
+        std::fprintf(stderr, "distributed_bench: built without SOLARLENS_WITH_MPI\n");
+        return 2;
+    }
+#endif
+
+    // Single-node reference: one TileSolver over the whole map.
+    const recon::TileRect whole {0, 0, map_size, map_size};
+    std::vector<double> reference(whole.area(), 0.0);
+    recon::TileSolver single(kernel, config.solver);
+    const double single_cpu0 = thread_cpu_seconds();
+    const recon::SolveResult single_result = single.solve(
+        whole, [&](const recon::SampleVisitor& visit) { visit(samples); }, reference);
+    const double single_cpu = thread_cpu_seconds() - single_cpu0;
+    std::vector<double> exact(whole.area());
+    for (std::uint32_t y = 0; y < map_size; ++y)
+        for (std::uint32_t x = 0; x < map_size; ++x)
+            exact[std::size_t(y) * map_size + x] = truth(x, y, map_size);
+    std::printf("map %u x %u, %zu samples, R = %.1f px, %d iterations\n", map_size, map_size, sample_count, r,
+                iterations);
+    std::printf("single node: %.3f s, residual %.3e, error vs truth %.4f\n\n", single_cpu,
+                single_result.relative_residual, relative_error(reference, exact));
+
+    std::printf("%-6s %-7s %12s %12s %9s %7s %10s %14s %10s\n", "ranks", "grid", "residual", "vs single",
+                "max cpu s", "speedup", "efficiency", "halo/rank/it", "wall s");
+    bool ok = true;
+    double base_cpu = 0.0;
+    for (int ranks = 1; ranks <= max_ranks; ranks *= 2) {
+        auto group = recon::make_local_group(ranks);
+        std::vector<RankRun> runs(static_cast<std::size_t>(ranks));
+        std::vector<double> map(whole.area(), 0.0);
+        recon::BlockGrid grid {};
+        const auto t0 = Clock::now();
+        std::vector<std::thread> threads;
+        for (int rank = 0; rank < ranks; ++rank)
+            threads.emplace_back([&, rank] {
+                recon::Communicator& comm = *group[std::size_t(rank)];
+                recon::DistributedSolver solver(psf, config, comm);
+                solver.add_samples(samples);
+                std::vector<double> x(solver.block().area(), 0.0);
+                const double cpu0 = thread_cpu_seconds();
+                runs[std::size_t(rank)].report = solver.solve(x);
+                runs[std::size_t(rank)].cpu_seconds = thread_cpu_seconds() - cpu0;
+                solver.gather(x, rank == 0 ? std::span<double>(map) : std::span<double> {});
+                if (rank == 0)
+                    grid = solver.grid();
+            });
+        for (auto& t : threads)
+            t.join();
+        const double wall = seconds_since(t0);
+
+        double max_cpu = 0.0;
+        std::uint64_t max_halo = 0;
+        for (const RankRun& run : runs) {
+            max_cpu = std::max(max_cpu, run.cpu_seconds);
+            max_halo = std::max(max_halo, run.report.halo_values_sent);
+        }
+        if (ranks == 1)
+            base_cpu = max_cpu;
+        const recon::SolveResult& solve = runs[0].report.solve;
+        const double diff = relative_error(map, reference);
+        const double speedup = base_cpu / max_cpu;
+        std::printf("%-6d %3ux%-3u %12.3e %12.3e %9.3f %7.2f %10.2f %14.0f %10.3f\n", ranks, grid.columns, grid.rows,
+                    solve.relative_residual, diff, max_cpu, speedup, speedup / ranks,
+                    double(max_halo) / double(solve.iterations + 1), wall);
+        ok = ok && diff < 1e-9 && solve.iterations == single_result.iterations;
+    }
+    if (!ok)
+        std::printf("distributed solution differs from the single-node solve\n");
+    return ok ? 0 : 1;
+}
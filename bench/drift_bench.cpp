@@ -0,0 +1,198 @@
+// drift_bench: narrowband drift search against the receiver's data rate.
+//
+//     drift_bench [--channels N] [--steps T] [--blocks B] [--tones K]
+//                 [--snr S] [--threads P] [--seed X]
+//
+// Simulates B blocks of T power spectra of N fine channels (2.79 Hz, one
+// spectrum a second): chi-squared noise on a sloping bandpass with K
+// drifting tones per block at random frequencies, drift rates within the
+// searched +/- 2 Hz/s and summed SNR S. Streams them through a
+// DriftSearcher on P threads and reports tones recovered (right channel
+// and drift rate), false hits, and the search time per block against the
+// block's duration. Then searches one block single-threaded at every SIMD
+// level and checks the hits match scalar exactly. Exits non-zero if a tone
+// is missed or another hit appears, if the search runs slower than real
+// time, or if the kernels disagree.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "solarlens/core/simd.hpp"
+#include "solarlens/modem/drift_search.hpp"
+#include "solarlens/sched/scheduler.hpp"
+
+namespace {
+
+using namespace solarlens;
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point t0)
+{
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+struct Tone {
+    double channel = 0.0; ///< In the block's first spectrum.
+    double drift = 0.0;   ///< Channels per step.
+};
+
+// Spectrum `step` of a block: unit-mean exponential noise times the
+// bandpass, with each tone's power split between its two nearest
+// channels.
+void spectrum(std::mt19937_64& rng, const std::vector<Tone>& tones, double amplitude, std::size_t step,
+              std::vector<float>& out)
+{
+    const std::size_t n = out.size();
+    for (std::size_t i = 0; i < n; ++i) {
+        const double u = (double(rng() >> 11) + 0.5) * 0x1.0p-53;
+        out[i] = float(-std::log(u) * (1.0 + 0.3 * double(i) / double(n)));
+    }
+    for (const Tone& t : tones) {
+        const double at = t.channel + t.drift * double(step);
+        const auto lo = static_cast<std::size_t>(std::floor(at));
+        const double frac = at - std::floor(at);
+        if (lo + 1 < n) {
+            out[lo] += float(amplitude * (1.0 - frac));
+            out[lo + 1] += float(amplitude * frac);
+        }
+    }
+}
+
+bool same_hits(const std::vector<modem::DriftHit>& a, const std::vector<modem::DriftHit>& b)
+{
+    return a.size() == b.size() && std::equal(a.begin(), a.end(), b.begin(), [](const auto& x, const auto& y) {
+               return x.channel == y.channel && x.drift_hz_per_s == y.drift_hz_per_s && x.snr == y.snr;
+           });
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::size_t channels = std::size_t(1) << 20;
+    std::size_t steps = 32;
+    std::size_t blocks = 4;
+    std::size_t tone_count = 16;
+    double snr = 25.0;
+    unsigned threads = std::thread::hardware_concurrency();
+    std::uint64_t seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string flag = argv[i];
+        if (flag == "--channels")
+            channels = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (flag == "--steps")
+            steps = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (flag == "--blocks")
+            blocks = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (flag == "--tones")
+            tone_count = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (flag == "--snr")
+            snr = std::atof(argv[i + 1]);
+        else if (flag == "--threads")
+            threads = static_cast<unsigned>(std::atoi(argv[i + 1]));
+        else if (flag == "--seed")
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+    }
+
+    sched::Scheduler scheduler(std::max(1u, threads));
+    modem::DriftSearchConfig config;
+    config.channels = channels;
+    config.time_steps = steps;
+    config.scheduler = &scheduler;
+    modem::DriftSearcher searcher(config);
+    const std::size_t max_drift = config.max_drift_channels();
+    const double drift_unit = config.channel_hz / (double(steps - 1) * config.step_s);
+    // A tone's power sums over the block; the noise sum deviates by about
+    // sqrt(steps) times the bandpass.
+    const double amplitude = snr / std::sqrt(double(steps));
+    std::printf("%zu channels x %zu steps per block (%.0f s), drifts to +/-%zu channels (%.2f Hz/s), "
+                "%zu tones of SNR %.0f per block, %u threads\n",
+                channels, steps, double(steps) * config.step_s, max_drift, config.max_drift_hz_per_s, tone_count,
+                snr, std::max(1u, threads));
+
+    std::mt19937_64 rng(seed);
+    std::vector<float> row(channels);
+    std::vector<std::vector<float>> first_block;
+    std::size_t recovered = 0, missed = 0, false_hits = 0;
+    double search_s = 0.0, worst_s = 0.0;
+    for (std::size_t b = 0; b < blocks; ++b) {
+        std::vector<Tone> tones(tone_count);
+        std::uniform_real_distribution<double> where(double(max_drift) + 2, double(channels - max_drift) - 3);
+        std::uniform_real_distribution<double> rate(-double(max_drift), double(max_drift));
+        for (Tone& t : tones)
+            t = {where(rng), rate(rng) / double(steps - 1)};
+        std::vector<modem::DriftHit> hits;
+        for (std::size_t s = 0; s < steps; ++s) {
+            spectrum(rng, tones, amplitude, s, row);
+            if (b == 0)
+                first_block.push_back(row);
+            const auto t0 = Clock::now();
+            hits = searcher.push(row);
+            const double dt = seconds_since(t0);
+            if (s + 1 == steps) {
+                search_s += dt;
+                worst_s = std::max(worst_s, dt);
+            }
+        }
+        // A tone is found if a hit is within a channel of its start and a
+        // drift step of its rate.
+        std::vector<bool> matched(hits.size(), false);
+        for (const Tone& t : tones) {
+            bool found = false;
+            const double rate_hz_s = t.drift * double(steps - 1) * drift_unit;
+            for (std::size_t h = 0; h < hits.size(); ++h)
+                if (std::abs(double(hits[h].channel) - t.channel) <= 1.5
+                    && std::abs(hits[h].drift_hz_per_s - rate_hz_s) <= 1.5 * drift_unit) {
+                    found = true;
+                    matched[h] = true;
+                }
+            found ? ++recovered : ++missed;
+        }
+        false_hits += std::size_t(std::count(matched.begin(), matched.end(), false));
+    }
+    const double block_s = double(steps) * config.step_s;
+    std::printf("recovered %zu of %zu tones, %zu false hits\n", recovered, recovered + missed, false_hits);
+    std::printf("search %.1f ms per block (worst %.1f ms) for %.0f s of data: %.0fx real time, "
+                "%.1f M channel-steps/s\n",
+                1e3 * search_s / double(blocks), 1e3 * worst_s, block_s, block_s * double(blocks) / search_s,
+                double(channels * steps * blocks) / search_s / 1e6);
+
+    // One block, single-threaded, per kernel.
+    int status = missed != 0 || false_hits != 0 || worst_s > block_s ? 1 : 0;
+    std::vector<modem::DriftHit> reference;
+    double scalar_s = 0.0;
+    std::printf("\n%-8s %12s %10s %16s\n", "kernel", "ms/block", "speedup", "hits vs scalar");
+    for (auto level : {core::SimdLevel::scalar, core::SimdLevel::neon, core::SimdLevel::avx2,
+                       core::SimdLevel::avx512}) {
+        if (!core::simd_level_supported(level))
+            continue;
+        modem::DriftSearchConfig single = config;
+        single.simd = level;
+        single.scheduler = nullptr;
+        modem::DriftSearcher timed(single);
+        std::vector<modem::DriftHit> hits;
+        for (std::size_t s = 0; s + 1 < steps; ++s)
+            timed.push(first_block[s]);
+        const auto t0 = Clock::now();
+        hits = timed.push(first_block[steps - 1]);
+        const double dt = seconds_since(t0);
+        if (reference.empty()) {
+            reference = hits;
+            scalar_s = dt;
+        }
+        const bool same = same_hits(hits, reference);
+        std::printf("%-8s %12.1f %9.2fx %16s\n", core::to_string(level), 1e3 * dt, scalar_s / dt,
+                    same ? "identical" : "DIFFER");
+        if (!same)
+            status = 1;
+    }
+    return status;
+}
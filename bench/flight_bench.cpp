@@ -0,0 +1,261 @@
+// flight_bench: onboard co-add, ring photometry and compression.
+//
+//     flight_bench [--width W] [--height H] [--frames F] [--delta D]
+//                  [--rows R] [--bps B] [--seed X]
+//
+// Renders F raw 16-bit coronagraph frames (bias, corona falloff, a
+// sector-modulated Einstein ring, shot and read noise), co-adds them with
+// every SIMD kernel the CPU runs, and codes the co-add as a photometry,
+// lossless and near-lossless (max error D) product, in slices of R rows.
+// Reports time per frame and per product, the longest slice, product
+// sizes against the raw frames, and downlink time at B bits per second.
+// Decodes every product on the ground side and exits non-zero unless
+// lossless is exact, near-lossless stays within D, the sector sums
+// match, every kernel writes identical bytes, and nothing allocated on
+// the flight side.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "solarlens/core/simd.hpp"
+#include "solarlens/flight/processor.hpp"
+#include "solarlens/flight/product.hpp"
+
+namespace {
+
+std::atomic<std::uint64_t> allocations {0};
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size == 0 ? 1 : size))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace {
+
+using namespace solarlens;
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point t0)
+{
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+std::vector<std::uint16_t> render(std::uint32_t w, std::uint32_t h, const flight::RingGeometry& ring,
+                                  std::mt19937_64& rng)
+{
+    std::normal_distribution<double> g(0.0, 1.0);
+    std::vector<std::uint16_t> frame(std::size_t(w) * h);
+    const double ring_r = 0.5 * (ring.inner + ring.outer);
+    for (std::uint32_t y = 0; y < h; ++y)
+        for (std::uint32_t x = 0; x < w; ++x) {
+            const double dx = x - ring.cx;
+            const double dy = y - ring.cy;
+            const double r = std::max(std::sqrt(dx * dx + dy * dy), 20.0);
+            const double corona = 2.0e6 / (r * r);
+            const double phase = std::atan2(dy, dx);
+            const double ring_flux = 300.0 * (1.0 + 0.3 * std::cos(3.0 * phase))
+                                     * std::exp(-0.5 * (r - ring_r) * (r - ring_r) / 9.0);
+            const double signal = corona + ring_flux;
+            const double counts = 500.0 + signal + std::sqrt(signal) * g(rng) + 6.0 * g(rng);
+            frame[std::size_t(y) * w + x] = static_cast<std::uint16_t>(std::clamp(counts, 0.0, 65535.0));
+        }
+    return frame;
+}
+
+struct ModeRun {
+    flight::FlightMode mode;
+    std::vector<std::byte> product;
+    double coadd_s = 0.0;      // Per frame.
+    double product_s = 0.0;
+    double worst_slice_s = 0.0;
+    std::uint64_t allocations = 0;
+};
+
+ModeRun run_mode(flight::FlightConfig config, const std::vector<std::vector<std::uint16_t>>& frames,
+                 std::uint32_t rows_per_slice)
+{
+    ModeRun out;
+    out.mode = config.mode;
+    std::vector<std::byte> workspace(flight::FlightProcessor::workspace_bytes(config));
+    flight::FlightProcessor processor(config, workspace);
+    out.product.resize(flight::FlightProcessor::max_product_bytes(config));
+
+    // Warm up: first use of each instrumentation stage registers it.
+    processor.add_frame({frames[0].data(), config.width, config.height});
+    processor.encode(out.product);
+    processor.reset();
+
+    const std::uint64_t before = allocations.load();
+    auto t0 = Clock::now();
+    for (const auto& f : frames)
+        processor.add_frame({f.data(), config.width, config.height});
+    out.coadd_s = seconds_since(t0) / double(frames.size());
+
+    t0 = Clock::now();
+    processor.begin_product(out.product);
+    for (;;) {
+        const auto s0 = Clock::now();
+        const bool done = processor.encode_rows(rows_per_slice);
+        out.worst_slice_s = std::max(out.worst_slice_s, seconds_since(s0));
+        if (done)
+            break;
+    }
+    out.product_s = seconds_since(t0);
+    out.allocations = allocations.load() - before;
+    out.product.resize(processor.product_bytes());
+    return out;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    flight::FlightConfig base;
+    std::uint32_t rows_per_slice = 32;
+    double bps = 10.0;
+    std::uint64_t seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        if (arg == "--width")
+            base.width = static_cast<std::uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (arg == "--height")
+            base.height = static_cast<std::uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (arg == "--frames")
+            base.frames_per_coadd = static_cast<std::uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (arg == "--delta")
+            base.near_lossless_delta = static_cast<std::uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (arg == "--rows")
+            rows_per_slice = static_cast<std::uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (arg == "--bps")
+            bps = std::strtod(argv[i + 1], nullptr);
+        else if (arg == "--seed")
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+    }
+    base.ring.cx = 0.5f * float(base.width) - 0.5f;
+    base.ring.cy = 0.5f * float(base.height) - 0.5f;
+
+    std::mt19937_64 rng(seed);
+    std::vector<std::vector<std::uint16_t>> frames;
+    for (std::uint32_t f = 0; f < base.frames_per_coadd; ++f)
+        frames.push_back(render(base.width, base.height, base.ring, rng));
+    const double raw_bytes = 2.0 * double(base.width) * base.height * base.frames_per_coadd;
+    std::printf("%ux%u, %u frames per co-add, %u-bit samples, raw frames %.1f MB\n", base.width, base.height,
+                base.frames_per_coadd, base.sample_bits(), raw_bytes * 1e-6);
+
+    bool ok = true;
+    std::vector<core::SimdLevel> levels;
+    for (const auto level : {core::SimdLevel::scalar, core::SimdLevel::neon, core::SimdLevel::avx2,
+                             core::SimdLevel::avx512})
+        if (core::simd_level_supported(level))
+            levels.push_back(level);
+
+    std::vector<std::uint32_t> truth(std::size_t(base.width) * base.height, 0);
+    for (const auto& f : frames)
+        for (std::size_t i = 0; i < truth.size(); ++i)
+            truth[i] += f[i];
+
+    for (const auto mode : {flight::FlightMode::photometry, flight::FlightMode::lossless,
+                            flight::FlightMode::near_lossless}) {
+        std::vector<std::byte> reference;
+        for (const auto level : levels) {
+            flight::FlightConfig config = base;
+            config.mode = mode;
+            config.simd = level;
+            const ModeRun r = run_mode(config, frames, rows_per_slice);
+            std::printf("%-13s %-7s coadd %6.2f ms/frame  product %7.2f ms  worst %u-row slice %6.3f ms  "
+                        "%9zu B (%6.1fx)  %8.2f h at %.0f bps  allocs %llu\n",
+                        flight::to_string(mode), core::to_string(level), r.coadd_s * 1e3, r.product_s * 1e3,
+                        rows_per_slice, r.worst_slice_s * 1e3, r.product.size(),
+                        raw_bytes / double(r.product.size()), 8.0 * double(r.product.size()) / bps / 3600.0, bps,
+                        static_cast<unsigned long long>(r.allocations));
+            ok &= r.allocations == 0;
+            if (reference.empty())
+                reference = r.product;
+            else if (r.product != reference) {
+                std::printf("  product differs from %s\n", core::to_string(levels.front()));
+                ok = false;
+            }
+        }
+
+        const flight::FlightProduct decoded = flight::decode_product(reference);
+        std::vector<std::uint64_t> signal(decoded.sectors.size(), 0);
+        std::uint64_t max_error = 0;
+        if (mode != flight::FlightMode::photometry) {
+            for (std::size_t i = 0; i < truth.size(); ++i) {
+                const auto e = static_cast<std::uint64_t>(std::llabs(std::int64_t(decoded.image[i]) - truth[i]));
+                max_error = std::max(max_error, e);
+            }
+            const std::uint64_t allowed = mode == flight::FlightMode::lossless ? 0 : base.near_lossless_delta;
+            std::printf("  decoded co-add: max error %llu (allowed %llu)\n",
+                        static_cast<unsigned long long>(max_error), static_cast<unsigned long long>(allowed));
+            ok &= max_error <= allowed;
+        }
+        if (mode == flight::FlightMode::photometry) {
+            double lo = 1e300;
+            double hi = -1e300;
+            for (const auto& sec : decoded.sectors) {
+                const double ring = double(sec.signal) / std::max<std::uint32_t>(sec.signal_pixels, 1)
+                                    - double(sec.background) / std::max<std::uint32_t>(sec.background_pixels, 1);
+                lo = std::min(lo, ring);
+                hi = std::max(hi, ring);
+            }
+            std::printf("  %zu sectors, ring minus background %.0f..%.0f counts per pixel\n",
+                        decoded.sectors.size(), lo, hi);
+        }
+    }
+
+    // Sector sums from the lossless product must equal sums over its image.
+    {
+        flight::FlightConfig config = base;
+        const ModeRun r = run_mode(config, frames, rows_per_slice);
+        const flight::FlightProduct p = flight::decode_product(r.product);
+        std::vector<flight::SectorSums> recount(p.sectors.size());
+        const double two_pi = 2.0 * 3.14159265358979323846;
+        for (std::uint32_t y = 0; y < p.height; ++y)
+            for (std::uint32_t x = 0; x < p.width; ++x) {
+                const double dx = double(x) - p.ring.cx;
+                const double dy = double(y) - p.ring.cy;
+                const double r2 = dx * dx + dy * dy;
+                double turn = std::atan2(dy, dx) / two_pi;
+                if (turn < 0.0)
+                    turn += 1.0;
+                const auto s = std::min<std::size_t>(static_cast<std::size_t>(turn * p.ring.sectors),
+                                                     p.ring.sectors - 1);
+                const std::uint32_t v = p.image[std::size_t(y) * p.width + x];
+                if (r2 >= double(p.ring.inner) * p.ring.inner && r2 < double(p.ring.outer) * p.ring.outer)
+                    recount[s].signal += v;
+                else if (r2 >= double(p.ring.background_inner) * p.ring.background_inner
+                         && r2 < double(p.ring.background_outer) * p.ring.background_outer)
+                    recount[s].background += v;
+            }
+        bool match = true;
+        for (std::size_t s = 0; s < recount.size(); ++s)
+            match &= recount[s].signal == p.sectors[s].signal && recount[s].background == p.sectors[s].background;
+        std::printf("sector sums match a recount over the decoded image: %s\n", match ? "yes" : "NO");
+        ok &= match;
+    }
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,151 @@
+// perf_bench: cost of the instrumentation hot path.
+//
+//     perf_bench [--threads T] [--samples N] [--prometheus PATH] [--trace PATH]
+//
+// Times ScopedTimer, Stage::record and Counter::add per call on 1..T
+// threads at once, against one mutex-guarded HdrHistogram shared by all
+// threads (what a naive global registry does), with and without tracing.
+// Then checks HdrHistogram quantiles against exact ones on log-normal
+// latencies, and optionally writes the collected data in both export
+// formats.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "solarlens/perf/export.hpp"
+#include "solarlens/perf/histogram.hpp"
+#include "solarlens/perf/instrument.hpp"
+
+namespace {
+
+using namespace solarlens;
+
+// Runs fn(samples) on `threads` threads released together; returns
+// nanoseconds per call per thread.
+template <typename Fn>
+double per_call_ns(unsigned threads, std::size_t samples, Fn fn)
+{
+    std::atomic<unsigned> ready {0};
+    std::atomic<bool> go {false};
+    std::vector<double> ns(threads);
+    std::vector<std::thread> pool;
+    for (unsigned t = 0; t < threads; ++t)
+        pool.emplace_back([&, t] {
+            ready.fetch_add(1);
+            while (!go.load())
+                std::this_thread::yield();
+            const auto t0 = std::chrono::steady_clock::now();
+            fn(samples);
+            ns[t] = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+        });
+    while (ready.load() < threads)
+        std::this_thread::yield();
+    go.store(true);
+    for (auto& th : pool)
+        th.join();
+    return *std::max_element(ns.begin(), ns.end()) / double(samples);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    unsigned threads = std::max(1u, std::thread::hardware_concurrency());
+    std::size_t samples = 2'000'000;
+    std::string prometheus_path;
+    std::string trace_path;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string flag = argv[i];
+        if (flag == "--threads")
+            threads = static_cast<unsigned>(std::max(1, std::atoi(argv[i + 1])));
+        else if (flag == "--samples")
+            samples = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (flag == "--prometheus")
+            prometheus_path = argv[i + 1];
+        else if (flag == "--trace")
+            trace_path = argv[i + 1];
+    }
+
+    static const perf::Stage timed("bench.scoped_timer");
+    static const perf::Stage recorded("bench.record");
+    static const perf::Counter counted("bench.calls");
+    perf::HdrHistogram shared;
+    std::mutex shared_mutex;
+
+    std::printf("%-8s %14s %14s %14s %14s %14s\n", "threads", "timer ns", "timer+trace", "record ns", "counter ns",
+                "mutex ns");
+    for (unsigned t = 1; t <= threads; t *= 2) {
+        perf::set_tracing(false);
+        const double timer = per_call_ns(t, samples, [](std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i)
+                const perf::ScopedTimer scope(timed);
+        });
+        perf::set_tracing(true);
+        const double traced = per_call_ns(t, samples, [](std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i)
+                const perf::ScopedTimer scope(timed);
+        });
+        perf::set_tracing(false);
+        const double record = per_call_ns(t, samples, [](std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i)
+                recorded.record(i & 4095);
+        });
+        const double counter = per_call_ns(t, samples, [](std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i)
+                counted.add();
+        });
+        const double locked = per_call_ns(t, samples, [&](std::size_t n) {
+            for (std::size_t i = 0; i < n; ++i) {
+                std::lock_guard lock(shared_mutex);
+                shared.record(i & 4095);
+            }
+        });
+        std::printf("%-8u %14.1f %14.1f %14.1f %14.1f %14.1f\n", t, timer, traced, record, counter, locked);
+        if (t < threads && 2 * t > threads)
+            t = threads / 2;
+    }
+
+    // Accuracy against exact quantiles.
+    std::mt19937_64 rng(1);
+    std::lognormal_distribution<double> latency(std::log(20'000.0), 1.5);
+    std::vector<std::uint64_t> values(1'000'000);
+    perf::HdrHistogram h;
+    for (auto& v : values) {
+        v = static_cast<std::uint64_t>(latency(rng)) + 1;
+        h.record(v);
+    }
+    std::sort(values.begin(), values.end());
+    double worst = 0.0;
+    std::printf("\n%-9s %14s %14s %10s\n", "quantile", "exact ns", "hdr ns", "rel err");
+    for (const double q : {0.5, 0.9, 0.99, 0.999, 0.9999}) {
+        const auto rank = static_cast<std::size_t>(std::ceil(q * double(values.size()))) - 1;
+        const double exact = double(values[rank]);
+        const double got = double(h.value_at_quantile(q));
+        const double err = std::abs(got - exact) / exact;
+        worst = std::max(worst, err);
+        std::printf("%-9g %14.0f %14.0f %10.4f\n", q, exact, got, err);
+    }
+
+    const perf::Snapshot snap = perf::snapshot();
+    const auto* calls = snap.counter("bench.calls");
+    std::printf("\nbench.calls = %llu\n", static_cast<unsigned long long>(calls ? calls->value : 0));
+    if (!prometheus_path.empty()) {
+        std::ofstream out(prometheus_path);
+        perf::write_prometheus(snap, out);
+    }
+    if (!trace_path.empty()) {
+        std::ofstream out(trace_path);
+        perf::write_chrome_trace(perf::collect_trace(), out);
+    }
+    return worst <= 1.0 / 64 ? 0 : 1;
+}
@@ -0,0 +1,185 @@
+// precision_bench: mixed-precision against FP64 tile solves.
+//
+//     precision_bench [--map-size M] [--samples N] [--support R]
+//                     [--tolerance T] [--inner I] [--lambda L] [--seed X]
+//
+// Simulates N noisy ring samples of an M x M map and solves them to the
+// relative residual T with a TileSolver in each precision. Per precision
+// it reports CG iterations, FP64 refinement rounds, the FP64 residual the
+// solver reported and an independent FP64 recomputation of it, the
+// difference from the FP64 map, and time. Exits non-zero if a solve
+// misses the tolerance or its reported residual is not the true one.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "solarlens/recon/psf_kernel.hpp"
+#include "solarlens/recon/tile_solver.hpp"
+
+namespace {
+
+using namespace solarlens;
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point t0)
+{
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+double truth(std::uint32_t x, std::uint32_t y, std::uint32_t size)
+{
+    const double u = double(x) / size - 0.5;
+    const double v = double(y) / size - 0.5;
+    const double disc = u * u + v * v < 0.16 ? 1.0 : 0.0;
+    return disc * (0.7 + 0.3 * std::sin(23.0 * u) * std::cos(17.0 * v));
+}
+
+double relative_error(const std::vector<double>& a, const std::vector<double>& b)
+{
+    double num = 0.0;
+    double den = 0.0;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        num += (a[i] - b[i]) * (a[i] - b[i]);
+        den += b[i] * b[i];
+    }
+    return den > 0.0 ? std::sqrt(num / den) : std::sqrt(num);
+}
+
+// Calls fn(pixel, distance) for each map pixel within r of a sample.
+template <typename Fn>
+void for_stencil(const recon::RingSample& s, double r, std::uint32_t size, Fn&& fn)
+{
+    const long x_lo = std::max(0L, static_cast<long>(std::ceil(s.u - r)));
+    const long x_hi = std::min(long(size) - 1, static_cast<long>(std::floor(s.u + r)));
+    const long y_lo = std::max(0L, static_cast<long>(std::ceil(s.v - r)));
+    const long y_hi = std::min(long(size) - 1, static_cast<long>(std::floor(s.v + r)));
+    for (long y = y_lo; y <= y_hi; ++y)
+        for (long x = x_lo; x <= x_hi; ++x) {
+            const double d = std::hypot(double(x) - s.u, double(y) - s.v);
+            if (d < r)
+                fn(std::size_t(y) * size + std::size_t(x), d);
+        }
+}
+
+// |A^T W (y - A x) - lambda x| / |A^T W y|, straight from the samples.
+double true_residual(const std::vector<recon::RingSample>& samples, const recon::SampledKernel& kernel,
+                     std::uint32_t size, double lambda, const std::vector<double>& x)
+{
+    std::vector<double> b(x.size(), 0.0), r(x.size(), 0.0);
+    for (std::size_t j = 0; j < x.size(); ++j)
+        r[j] = -lambda * x[j];
+    for (const recon::RingSample& s : samples) {
+        const double w = 1.0 / (double(s.sigma) * double(s.sigma));
+        double ax = 0.0;
+        for_stencil(s, kernel.radius(), size, [&](std::size_t j, double d) { ax += kernel(d) * x[j]; });
+        for_stencil(s, kernel.radius(), size, [&](std::size_t j, double d) {
+            b[j] += kernel(d) * w * s.flux;
+            r[j] += kernel(d) * w * (s.flux - ax);
+        });
+    }
+    double rr = 0.0, bb = 0.0;
+    for (std::size_t j = 0; j < x.size(); ++j) {
+        rr += r[j] * r[j];
+        bb += b[j] * b[j];
+    }
+    return std::sqrt(rr / bb);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::uint32_t map_size = 64;
+    std::size_t sample_count = 10'000;
+    double support = 8.0;
+    double tolerance = 1e-8;
+    double lambda = 1e-3;
+    double inner = recon::SolverOptions {}.inner_tolerance;
+    std::uint64_t seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string flag = argv[i];
+        if (flag == "--map-size")
+            map_size = static_cast<std::uint32_t>(std::atoi(argv[i + 1]));
+        else if (flag == "--samples")
+            sample_count = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (flag == "--support")
+            support = std::atof(argv[i + 1]);
+        else if (flag == "--tolerance")
+            tolerance = std::atof(argv[i + 1]);
+        else if (flag == "--inner")
+            inner = std::atof(argv[i + 1]);
+        else if (flag == "--lambda")
+            lambda = std::atof(argv[i + 1]);
+        else if (flag == "--seed")
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+    }
+
+    recon::SglPsf::Params params;
+    params.support_radius_px = support;
+    const recon::SglPsf psf(params);
+    const recon::SampledKernel kernel(psf);
+
+    // Samples: noisy PSF-weighted sums over the truth map.
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<float> position(-0.49f, float(map_size) - 0.51f);
+    std::normal_distribution<double> noise(0.0, 1.0);
+    std::vector<recon::RingSample> samples(sample_count);
+    for (auto& s : samples) {
+        s.u = position(rng);
+        s.v = position(rng);
+        double flux = 0.0;
+        for_stencil(s, kernel.radius(), map_size, [&](std::size_t j, double d) {
+            flux += kernel(d) * truth(std::uint32_t(j % map_size), std::uint32_t(j / map_size), map_size);
+        });
+        s.sigma = 0.05f;
+        s.flux = float(flux + double(s.sigma) * noise(rng));
+    }
+
+    const recon::TileRect whole {0, 0, map_size, map_size};
+    const auto source = [&](const recon::SampleVisitor& visit) { visit(samples); };
+    std::printf("map %u x %u, %zu samples, R = %.1f px, lambda %.0e, tolerance %.0e\n", map_size, map_size,
+                sample_count, kernel.radius(), lambda, tolerance);
+    std::printf("%-6s %6s %8s %12s %12s %12s %9s %8s\n", "mode", "iters", "rounds", "reported", "recomputed",
+                "vs fp64 map", "seconds", "speedup");
+
+    struct Mode {
+        const char* name;
+        recon::Precision precision;
+    };
+    int status = 0;
+    std::vector<double> reference;
+    double reference_seconds = 0.0;
+    for (const Mode mode : {Mode {"fp64", recon::Precision::fp64}, Mode {"fp32", recon::Precision::fp32},
+                            Mode {"bf16", recon::Precision::bf16}}) {
+        recon::SolverOptions options;
+        options.max_iterations = 5000;
+        options.tolerance = tolerance;
+        options.regularization = lambda;
+        options.precision = mode.precision;
+        options.inner_tolerance = inner;
+        recon::TileSolver solver(kernel, options);
+        std::vector<double> x(whole.area(), 0.0);
+        const auto t0 = Clock::now();
+        const recon::SolveResult result = solver.solve(whole, source, x);
+        const double seconds = seconds_since(t0);
+        const double recomputed = true_residual(samples, kernel, map_size, lambda, x);
+        if (reference.empty()) {
+            reference = x;
+            reference_seconds = seconds;
+        }
+        std::printf("%-6s %6d %8d %12.3e %12.3e %12.3e %9.3f %8.2f\n", mode.name, result.iterations,
+                    result.refinements, result.relative_residual, recomputed, relative_error(x, reference), seconds,
+                    reference_seconds / seconds);
+        // The reported residual must be the true FP64 one, to within the
+        // rounding of recomputing it.
+        if (result.relative_residual > tolerance || recomputed > 2 * tolerance)
+            status = 1;
+    }
+    return status;
+}
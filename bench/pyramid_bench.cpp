@@ -0,0 +1,202 @@
+// pyramid_bench: interactive pan and zoom over a map pyramid.
+//
+//     pyramid_bench [--size N] [--tile T] [--cache-mb M] [--preview P]
+//                   [--views V] [--seed N] [--dir PATH]
+//
+// Writes an N x N synthetic map, opens a MapPyramid on it (time to first
+// overview), then replays V random viewport moves: each picks a level and
+// a 1920 x 1080 window near the previous one and fetches every visible
+// tile. Reports fetch latency percentiles for resident and lazy levels,
+// cache hit rate and evictions. Finally rewrites a patch of the map,
+// invalidates it and checks refetched tiles against a direct downsample.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "solarlens/recon/map_file.hpp"
+#include "solarlens/recon/map_pyramid.hpp"
+
+namespace {
+
+using namespace solarlens;
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point t0)
+{
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+double percentile(std::vector<double> v, double q)
+{
+    if (v.empty())
+        return 0.0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, static_cast<std::size_t>(q * double(v.size())))];
+}
+
+float pattern(std::uint32_t x, std::uint32_t y, float epoch)
+{
+    const float u = float(x) / 97.0f;
+    const float v = float(y) / 61.0f;
+    return std::sin(u + epoch) * std::cos(v) + 0.001f * float((x * 7 + y * 13) % 101);
+}
+
+// Level `level` pixel (x, y) by repeated 2x2 means over the level-0 map.
+float reference(const std::vector<float>& map, std::uint32_t size, std::uint32_t level, std::uint32_t x,
+                std::uint32_t y)
+{
+    if (level == 0)
+        return map[std::size_t(y) * size + x];
+    const std::uint32_t below = (size + (1u << (level - 1)) - 1) >> (level - 1);
+    float sum = 0.0f;
+    float count = 0.0f;
+    for (std::uint32_t dy = 0; dy < 2; ++dy)
+        for (std::uint32_t dx = 0; dx < 2; ++dx)
+            if (2 * x + dx < below && 2 * y + dy < below) {
+                sum += reference(map, size, level - 1, 2 * x + dx, 2 * y + dy);
+                count += 1.0f;
+            }
+    return sum / count;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::uint32_t size = 4096;
+    recon::PyramidConfig config;
+    std::size_t views = 400;
+    std::uint64_t seed = 1;
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "solarlens_pyramid_bench";
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string flag = argv[i];
+        if (flag == "--size")
+            size = static_cast<std::uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (flag == "--tile")
+            config.tile_size = static_cast<std::uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (flag == "--cache-mb")
+            config.cache_bytes = std::strtoull(argv[i + 1], nullptr, 10) << 20;
+        else if (flag == "--preview")
+            config.preview_size = static_cast<std::uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (flag == "--views")
+            views = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (flag == "--seed")
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+        else if (flag == "--dir")
+            dir = argv[i + 1];
+    }
+    std::filesystem::create_directories(dir);
+    const auto map_path = dir / "map.slmp";
+
+    auto t0 = Clock::now();
+    {
+        recon::MapFileWriter writer(map_path, size, size);
+        std::vector<float> row(size);
+        for (std::uint32_t y = 0; y < size; ++y) {
+            for (std::uint32_t x = 0; x < size; ++x)
+                row[x] = pattern(x, y, 0.0f);
+            writer.write_block(0, y, size, 1, row);
+        }
+    }
+    std::printf("map: %u x %u (%.0f MiB) written in %.2f s\n", size, size,
+                double(size) * size * sizeof(float) / (1 << 20), seconds_since(t0));
+
+    t0 = Clock::now();
+    recon::MapPyramid pyramid(map_path, config);
+    const double open_s = seconds_since(t0);
+    std::printf("pyramid: %u levels, resident from level %u (%u x %u), opened in %.1f ms\n", pyramid.levels(),
+                pyramid.first_resident_level(), pyramid.width(pyramid.first_resident_level()),
+                pyramid.height(pyramid.first_resident_level()), 1e3 * open_s);
+
+    // Viewport random walk.
+    constexpr std::uint32_t view_w = 1920;
+    constexpr std::uint32_t view_h = 1080;
+    std::mt19937_64 rng(seed);
+    std::vector<double> resident_us;
+    std::vector<double> lazy_us;
+    double cx = 0.5;
+    double cy = 0.5;
+    std::uint32_t level = pyramid.levels() - 1;
+    for (std::size_t v = 0; v < views; ++v) {
+        // Mostly pan, sometimes zoom one level.
+        const auto r = rng() % 10;
+        if (r == 0 && level > 0)
+            --level;
+        else if (r == 1 && level + 1 < pyramid.levels())
+            ++level;
+        std::normal_distribution<double> step(0.0, 0.5 * double(view_w) / double(pyramid.width(level)));
+        cx = std::clamp(cx + step(rng), 0.0, 1.0);
+        cy = std::clamp(cy + step(rng), 0.0, 1.0);
+        const double px = cx * pyramid.width(level);
+        const double py = cy * pyramid.height(level);
+        const auto span = [&](double centre, std::uint32_t extent, std::uint32_t tiles) {
+            const double lo = std::max(0.0, centre - extent / 2.0) / config.tile_size;
+            const double hi = (centre + extent / 2.0) / config.tile_size;
+            return std::pair<std::uint32_t, std::uint32_t>(
+                static_cast<std::uint32_t>(lo), std::min(tiles, static_cast<std::uint32_t>(hi) + 1));
+        };
+        const auto [tx0, tx1] = span(px, view_w, pyramid.tiles_x(level));
+        const auto [ty0, ty1] = span(py, view_h, pyramid.tiles_y(level));
+        for (std::uint32_t ty = ty0; ty < ty1; ++ty)
+            for (std::uint32_t tx = tx0; tx < tx1; ++tx) {
+                t0 = Clock::now();
+                const auto tile = pyramid.tile(level, tx, ty);
+                (level >= pyramid.first_resident_level() ? resident_us : lazy_us).push_back(1e6 * seconds_since(t0));
+            }
+    }
+    const auto stats = pyramid.stats();
+    std::printf("\n%-9s %8s %10s %10s %10s\n", "levels", "fetches", "p50 us", "p99 us", "max us");
+    for (const auto& [name, lat] : {std::pair {"resident", &resident_us}, std::pair {"lazy", &lazy_us}})
+        std::printf("%-9s %8zu %10.1f %10.1f %10.1f\n", name, lat->size(), percentile(*lat, 0.5),
+                    percentile(*lat, 0.99), lat->empty() ? 0.0 : *std::max_element(lat->begin(), lat->end()));
+    std::printf("hits %llu, misses %llu (hit rate %.3f), evictions %llu, cached %zu tiles / %.1f MiB of %.0f\n",
+                static_cast<unsigned long long>(stats.hits), static_cast<unsigned long long>(stats.misses),
+                double(stats.hits) / double(std::max<std::uint64_t>(1, stats.hits + stats.misses)),
+                static_cast<unsigned long long>(stats.evictions), stats.cached_tiles,
+                double(stats.cached_bytes) / (1 << 20), double(config.cache_bytes) / (1 << 20));
+
+    // Rewrite a patch, invalidate, and check the affected tiles at every
+    // level against a direct downsample of the new map.
+    const recon::TileRect patch {size / 3, size / 5, std::min(size, size / 3 + 700), std::min(size, size / 5 + 300)};
+    std::vector<float> map(std::size_t(size) * size);
+    for (std::uint32_t y = 0; y < size; ++y)
+        for (std::uint32_t x = 0; x < size; ++x)
+            map[std::size_t(y) * size + x] = pattern(x, y, patch.contains(float(x), float(y)) ? 1.0f : 0.0f);
+    {
+        recon::MapFileWriter writer(map_path);
+        std::vector<float> block(patch.area());
+        for (std::uint32_t y = 0; y < patch.height(); ++y)
+            for (std::uint32_t x = 0; x < patch.width(); ++x)
+                block[std::size_t(y) * patch.width() + x] = map[std::size_t(patch.y0 + y) * size + patch.x0 + x];
+        writer.write_block(patch.x0, patch.y0, patch.width(), patch.height(), block);
+    }
+    t0 = Clock::now();
+    pyramid.invalidate(patch);
+    const double invalidate_ms = 1e3 * seconds_since(t0);
+
+    double worst = 0.0;
+    std::size_t checked = 0;
+    for (std::uint32_t l = 0; l < pyramid.levels(); ++l) {
+        const std::uint32_t tx = (patch.x0 >> l) / config.tile_size;
+        const std::uint32_t ty = (patch.y0 >> l) / config.tile_size;
+        const auto tile = pyramid.tile(l, tx, ty);
+        for (std::uint32_t i = 0; i < 64; ++i) {
+            const std::uint32_t x = tile->x0 + static_cast<std::uint32_t>(rng() % tile->width);
+            const std::uint32_t y = tile->y0 + static_cast<std::uint32_t>(rng() % tile->height);
+            const float got = tile->pixels[std::size_t(y - tile->y0) * tile->width + (x - tile->x0)];
+            worst = std::max(worst, double(std::abs(got - reference(map, size, l, x, y))));
+            ++checked;
+        }
+    }
+    std::printf("invalidate %.1f ms; %zu refetched pixels across all levels, max error %.2e\n", invalidate_ms,
+                checked, worst);
+    std::filesystem::remove_all(dir);
+    return worst <= 1e-5 ? 0 : 1;
+}
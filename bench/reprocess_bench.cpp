@@ -0,0 +1,348 @@
+// reprocess_bench: full-mission reprocessing through the product cache.
+//
+//     reprocess_bench [--spacecraft N] [--frames F] [--frame-size S]
+//                     [--threads T] [--work-dir DIR] [--json PATH]
+//
+// Writes N x F simulated raw frames to disk once, then runs a three-stage
+// reduction over them (corona calibration, ring photometry with a
+// photometric zero point, sample assembly) five ways: without a cache,
+// against an empty cache, again unchanged, after a zero-point change
+// (photometry and assembly invalidated, calibration reused) and after a
+// corona fit change (everything downstream of the raw frames
+// invalidated). Reports wall time, products computed and read back from
+// the cache per stage (a calibrated frame whose photometry is reused is
+// never opened), and cache traffic for each run as JSON. Exits non-zero
+// unless every cached run returns exactly the samples an uncached run
+// with the same constants does; exits 2 on an unknown flag or a flag
+// without its value.
+// Scratch files go in a per-process temporary directory removed on exit,
+// or in raw/ and cache/ under --work-dir, which are replaced and kept.
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "solarlens/archive/product_cache.hpp"
+#include "solarlens/calib/corona.hpp"
+#include "solarlens/core/file.hpp"
+#include "solarlens/core/mapped_file.hpp"
+#include "solarlens/recon/ring_sample.hpp"
+#include "solarlens/sched/scheduler.hpp"
+#include "solarlens/sim/swarm.hpp"
+
+namespace {
+
+using namespace solarlens;
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point t0)
+{
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+/// Constants a reprocessing campaign changes.
+struct Constants {
+    calib::CoronaGeometry geometry;
+    double zero_point = 1.0;
+};
+
+struct StageCount {
+    std::atomic<std::uint64_t> computed {0};
+    std::atomic<std::uint64_t> reused {0};
+};
+
+struct RunReport {
+    const char* name;
+    double seconds = 0.0;
+    std::uint64_t calib_computed = 0, calib_reused = 0;
+    std::uint64_t phot_computed = 0, phot_reused = 0;
+    std::uint64_t samples_computed = 0, samples_reused = 0;
+    archive::ProductCacheStats cache;
+    std::vector<recon::RingSample> samples;
+};
+
+class Reduction {
+public:
+    Reduction(const sim::SwarmSimulator& swarm, std::vector<std::filesystem::path> raw,
+              sched::Scheduler& scheduler)
+        : swarm_(swarm)
+        , raw_(std::move(raw))
+        , scheduler_(scheduler)
+    {
+    }
+
+    /// One pass over every raw frame; `cache` may be null.
+    RunReport run(const char* name, const Constants& k, archive::ProductCache* cache) const
+    {
+        RunReport report {};
+        report.name = name;
+        const calib::CoronaSubtractor subtractor(k.geometry);
+        const archive::ProductCacheStats before = cache ? cache->stats() : archive::ProductCacheStats {};
+        StageCount calib_count, phot_count;
+        std::vector<core::Digest> keys(raw_.size());
+        std::vector<recon::RingSample> samples(raw_.size());
+        const auto t0 = Clock::now();
+
+        sched::parallel_for(scheduler_, 0, raw_.size(), 1, [&](std::size_t lo, std::size_t hi) {
+            std::vector<std::byte> calibrated, photometry;
+            for (std::size_t i = lo; i < hi; ++i) {
+                const auto calibrate = [&](std::vector<std::byte>& out) {
+                    calib_count.computed.fetch_add(1, std::memory_order_relaxed);
+                    const core::MappedFile raw(raw_[i]);
+                    const auto* counts = reinterpret_cast<const std::uint16_t*>(raw.bytes().data());
+                    const std::uint32_t n = swarm_.config().frame_size;
+                    out.resize(std::size_t(n) * n * sizeof(float));
+                    auto* pixels = reinterpret_cast<float*>(out.data());
+                    std::copy(counts, counts + std::size_t(n) * n, pixels);
+                    subtractor.process({pixels, n, n});
+                };
+                const auto measure = [&](std::span<const std::byte> frame, std::vector<std::byte>& out) {
+                    phot_count.computed.fetch_add(1, std::memory_order_relaxed);
+                    const std::uint32_t n = swarm_.config().frame_size;
+                    const sim::RingPhotometry ring =
+                        swarm_.measure_ring({reinterpret_cast<const float*>(frame.data()), n, n});
+                    const double flux[2] = {ring.flux * k.zero_point, ring.sigma * k.zero_point};
+                    out.resize(sizeof(flux));
+                    std::memcpy(out.data(), flux, sizeof(flux));
+                };
+
+                std::span<const std::byte> phot;
+                std::optional<archive::Product> phot_product;
+                if (cache == nullptr) {
+                    calibrate(calibrated);
+                    measure(calibrated, photometry);
+                    phot = photometry;
+                } else {
+                    const core::Digest calib_key = calib_key_of(k.geometry, cache->file_digest(raw_[i]));
+                    const core::Digest phot_key =
+                        archive::ProductKey("photometry.ring", 1).param("zero_point", k.zero_point)
+                            .input(calib_key).digest();
+                    // Only open the calibrated frame if photometry must run.
+                    phot_product = cache->find(phot_key);
+                    if (phot_product) {
+                        phot_count.reused.fetch_add(1, std::memory_order_relaxed);
+                    } else {
+                        const archive::Product frame = cache->get_or_compute(calib_key, calibrate);
+                        measure(frame.payload(), photometry);
+                        phot_product = cache->store(phot_key, photometry);
+                    }
+                    phot = phot_product->payload();
+                    keys[i] = phot_key;
+                }
+                double flux[2];
+                std::memcpy(flux, phot.data(), sizeof(flux));
+                float u = 0, v = 0;
+                const std::size_t frames = swarm_.config().frames_per_craft;
+                swarm_.position(i / frames, i % frames, u, v);
+                samples[i] = {u, v, float(flux[0]), float(flux[1])};
+            }
+        });
+
+        if (cache == nullptr) {
+            report.samples = std::move(samples);
+        } else {
+            archive::ProductKey assembly("recon.samples", 1);
+            for (const core::Digest& key : keys)
+                assembly.input(key);
+            bool built = false;
+            const auto assemble = [&](std::vector<std::byte>& out) {
+                built = true;
+                const auto bytes = std::as_bytes(std::span(samples));
+                out.assign(bytes.begin(), bytes.end());
+            };
+            const archive::Product product = cache->get_or_compute(assembly.digest(), assemble);
+            const auto payload = product.payload();
+            report.samples.resize(payload.size() / sizeof(recon::RingSample));
+            std::memcpy(report.samples.data(), payload.data(), payload.size());
+            report.samples_computed = built ? 1 : 0;
+            report.samples_reused = built ? 0 : 1;
+        }
+        report.seconds = seconds_since(t0);
+        report.calib_computed = calib_count.computed;
+        report.phot_computed = phot_count.computed;
+        report.phot_reused = phot_count.reused;
+        report.calib_reused = report.phot_computed - report.calib_computed;
+        if (cache != nullptr) {
+            const archive::ProductCacheStats after = cache->stats();
+            report.cache.hits = after.hits - before.hits;
+            report.cache.misses = after.misses - before.misses;
+            report.cache.stores = after.stores - before.stores;
+            report.cache.bytes_read = after.bytes_read - before.bytes_read;
+            report.cache.bytes_written = after.bytes_written - before.bytes_written;
+        }
+        return report;
+    }
+
+private:
+    static core::Digest calib_key_of(const calib::CoronaGeometry& g, const core::Digest& raw)
+    {
+        return archive::ProductKey("calib.corona", 1)
+            .param("centre_x", double(g.centre_x))
+            .param("centre_y", double(g.centre_y))
+            .param("occulter", double(g.occulter))
+            .param("fit_inner", double(g.fit_inner))
+            .param("fit_outer", double(g.fit_outer))
+            .param("ring_inner", double(g.ring_inner))
+            .param("ring_outer", double(g.ring_outer))
+            .input(raw)
+            .digest();
+    }
+
+    const sim::SwarmSimulator& swarm_;
+    std::vector<std::filesystem::path> raw_;
+    sched::Scheduler& scheduler_;
+};
+
+bool same_samples(const std::vector<recon::RingSample>& a, const std::vector<recon::RingSample>& b)
+{
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size() * sizeof(recon::RingSample)) == 0;
+}
+
+int usage()
+{
+    std::fprintf(stderr, "usage: reprocess_bench [--spacecraft N] [--frames F] [--frame-size S]\n"
+                         "                       [--threads T] [--work-dir DIR] [--json PATH]\n");
+    return 2;
+}
+
+/// Removes the bench's own scratch directory however main() returns; a
+/// --work-dir given by the caller is left in place.
+struct RemoveOnExit {
+    std::filesystem::path dir;
+
+    ~RemoveOnExit()
+    {
+        std::error_code ec;
+        if (!dir.empty())
+            std::filesystem::remove_all(dir, ec);
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    sim::SwarmConfig cfg;
+    cfg.spacecraft = 4;
+    cfg.frames_per_craft = 64;
+    unsigned threads = std::thread::hardware_concurrency();
+    const std::filesystem::path default_work_dir =
+        std::filesystem::temp_directory_path() / ("solarlens-reprocess-bench-" + std::to_string(::getpid()));
+    std::filesystem::path work_dir = default_work_dir;
+    std::string json_path;
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc)
+            return usage();
+        const std::string flag = argv[i];
+        const char* value = argv[i + 1];
+        if (flag == "--spacecraft")
+            cfg.spacecraft = std::strtoul(value, nullptr, 10);
+        else if (flag == "--frames")
+            cfg.frames_per_craft = std::strtoul(value, nullptr, 10);
+        else if (flag == "--frame-size")
+            cfg.frame_size = static_cast<std::uint32_t>(std::atoi(value));
+        else if (flag == "--threads")
+            threads = static_cast<unsigned>(std::atoi(value));
+        else if (flag == "--work-dir")
+            work_dir = value;
+        else if (flag == "--json")
+            json_path = value;
+        else
+            return usage();
+    }
+
+    const sim::SwarmSimulator swarm(cfg);
+    sched::Scheduler scheduler(std::max(1u, threads));
+    const RemoveOnExit scratch {work_dir == default_work_dir ? work_dir : std::filesystem::path {}};
+    // Only the bench's own subdirectories are cleared; the cold run needs an
+    // empty cache.
+    std::filesystem::remove_all(work_dir / "raw");
+    std::filesystem::remove_all(work_dir / "cache");
+    std::filesystem::create_directories(work_dir / "raw");
+
+    std::vector<std::filesystem::path> raw;
+    std::vector<std::uint16_t> counts(std::size_t(cfg.frame_size) * cfg.frame_size);
+    for (std::size_t c = 0; c < cfg.spacecraft; ++c)
+        for (std::size_t f = 0; f < cfg.frames_per_craft; ++f) {
+            swarm.render(c, f, counts);
+            raw.push_back(work_dir / "raw" / ("c" + std::to_string(c) + "_f" + std::to_string(f) + ".u16"));
+            core::File(raw.back(), core::File::Mode::write).write(std::as_bytes(std::span(counts)));
+        }
+    const Reduction reduction(swarm, raw, scheduler);
+
+    Constants base {swarm.geometry(), 1.0};
+    Constants zero_point = base;
+    zero_point.zero_point = 1.02;
+    Constants corona_fit = zero_point;
+    corona_fit.geometry.fit_outer *= 0.95f;
+
+    archive::ProductCache cache(work_dir / "cache");
+    std::vector<RunReport> runs;
+    runs.push_back(reduction.run("uncached", base, nullptr));
+    runs.push_back(reduction.run("cold", base, &cache));
+    runs.push_back(reduction.run("warm", base, &cache));
+    runs.push_back(reduction.run("zero_point", zero_point, &cache));
+    runs.push_back(reduction.run("corona_fit", corona_fit, &cache));
+    const RunReport check_zero_point = reduction.run("check", zero_point, nullptr);
+    const RunReport check_corona_fit = reduction.run("check", corona_fit, nullptr);
+    const bool exact = same_samples(runs[1].samples, runs[0].samples)
+                       && same_samples(runs[2].samples, runs[0].samples)
+                       && same_samples(runs[3].samples, check_zero_point.samples)
+                       && same_samples(runs[4].samples, check_corona_fit.samples);
+
+    std::FILE* out = json_path.empty() ? stdout : std::fopen(json_path.c_str(), "w");
+    if (out == nullptr) {
+        std::perror(json_path.c_str());
+        return 1;
+    }
+    std::fprintf(out, "{\n  \"benchmark\": \"reprocess_bench\",\n");
+    std::fprintf(out, "  \"config\": {\"spacecraft\": %zu, \"frames_per_craft\": %zu, \"frame_size\": %u, "
+                      "\"threads\": %zu},\n",
+                 cfg.spacecraft, cfg.frames_per_craft, cfg.frame_size, scheduler.worker_count());
+    std::fprintf(out, "  \"runs\": {\n");
+    for (std::size_t i = 0; i < runs.size(); ++i) {
+        const RunReport& r = runs[i];
+        std::fprintf(out,
+                     "    \"%s\": {\"seconds\": %.6f, \"speedup\": %.2f, "
+                     "\"calibrate\": {\"computed\": %llu, \"reused\": %llu}, "
+                     "\"photometry\": {\"computed\": %llu, \"reused\": %llu}, "
+                     "\"samples\": {\"computed\": %llu, \"reused\": %llu}, "
+                     "\"cache\": {\"hits\": %llu, \"misses\": %llu, \"bytes_read\": %llu, "
+                     "\"bytes_written\": %llu}}%s\n",
+                     r.name, r.seconds, r.seconds > 0 ? runs[0].seconds / r.seconds : 0.0,
+                     static_cast<unsigned long long>(r.calib_computed),
+                     static_cast<unsigned long long>(r.calib_reused),
+                     static_cast<unsigned long long>(r.phot_computed),
+                     static_cast<unsigned long long>(r.phot_reused),
+                     static_cast<unsigned long long>(r.samples_computed),
+                     static_cast<unsigned long long>(r.samples_reused),
+                     static_cast<unsigned long long>(r.cache.hits),
+                     static_cast<unsigned long long>(r.cache.misses),
+                     static_cast<unsigned long long>(r.cache.bytes_read),
+                     static_cast<unsigned long long>(r.cache.bytes_written),
+                     i + 1 < runs.size() ? "," : "");
+    }
+    std::fprintf(out, "  },\n");
+    std::fprintf(out, "  \"cache_bytes\": %llu,\n  \"exact\": %s\n}\n",
+                 static_cast<unsigned long long>(cache.size_bytes()), exact ? "true" : "false");
+    if (out != stdout)
+        std::fclose(out);
+
+    if (!exact) {
+        std::fprintf(stderr, "reprocess_bench: cached samples differ from an uncached run\n");
+        return 1;
+    }
+    return 0;
+}
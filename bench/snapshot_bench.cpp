@@ -0,0 +1,192 @@
+// snapshot_bench: mission-control warm-up versus restart from a snapshot.
+//
+//     snapshot_bench [--spacecraft N] [--days D] [--sequences S]
+//                    [--distances K] [--dir PATH]
+//
+// Warms up the state a mission-control daemon needs before it can serve a
+// pass: a PSF table over K craft distances, the housekeeping dictionary, a
+// year's predicted states for N spacecraft, and the contact timeline of D
+// days of DSN windows part-way through booking S command loads. Writes all
+// of it to one snapshot, then restores it as a restarted daemon would and
+// checks that the restored state is identical: the same table values and
+// dictionary, bit-equal states, and the same receipts for new uplinks on
+// both timelines. Reports warm-up, write and restore times. Exits non-zero
+// if anything differs or the restore takes a second or more.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include "solarlens/core/snapshot.hpp"
+#include "solarlens/nav/propagator.hpp"
+#include "solarlens/recon/psf_table.hpp"
+#include "solarlens/tm/dictionary.hpp"
+#include "solarlens/uplink/engine.hpp"
+
+namespace {
+
+using namespace solarlens;
+using Clock = std::chrono::steady_clock;
+
+constexpr double day = 86400.0;
+
+double seconds_since(Clock::time_point t0)
+{
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+uplink::Sequence command(uplink::UplinkEngine& engine, std::uint32_t craft, std::uint32_t bytes, double delay_s,
+                         std::vector<uplink::UplinkReceipt>* receipts)
+{
+    co_await engine.after(delay_s);
+    const uplink::UplinkReceipt rx = co_await engine.uplink(craft, bytes);
+    co_await engine.observed(craft, rx.onboard + 600.0);
+    if (receipts)
+        receipts->push_back(rx);
+}
+
+// New uplinks for every craft. They book after whatever the timeline has
+// already granted, so equal receipts mean equal timelines.
+std::vector<uplink::UplinkReceipt> probe(uplink::UplinkEngine& engine, std::uint32_t spacecraft, double days)
+{
+    std::vector<uplink::UplinkReceipt> receipts;
+    receipts.reserve(spacecraft);
+    for (std::uint32_t c = 0; c < spacecraft; ++c)
+        engine.spawn(command(engine, c, 2048 + 64 * (c % 7), 3600.0 * (c % 5), &receipts));
+    engine.run_until(engine.now() + days * day);
+    std::sort(receipts.begin(), receipts.end(), [](const auto& a, const auto& b) {
+        return a.transmit_start != b.transmit_start ? a.transmit_start < b.transmit_start : a.station < b.station;
+    });
+    return receipts;
+}
+
+bool same(const std::vector<uplink::UplinkReceipt>& a, const std::vector<uplink::UplinkReceipt>& b)
+{
+    return std::equal(a.begin(), a.end(), b.begin(), b.end(), [](const auto& x, const auto& y) {
+        return x.station == y.station && x.transmit_start == y.transmit_start && x.transmit_end == y.transmit_end
+               && x.onboard == y.onboard;
+    });
+}
+
+std::string decoder_text(const tm::Dictionary& dictionary)
+{
+    std::ostringstream out;
+    tm::write_decoder_header(dictionary, out);
+    return out.str();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::uint32_t spacecraft = 64;
+    double days = 60.0;
+    std::size_t sequences = 16384;
+    std::uint32_t distances = 12;
+    std::filesystem::path dir = std::filesystem::temp_directory_path()
+                                / ("solarlens-snapshot-bench-" + std::to_string(::getpid()));
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        if (arg == "--spacecraft")
+            spacecraft = static_cast<std::uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (arg == "--days")
+            days = std::atof(argv[i + 1]);
+        else if (arg == "--sequences")
+            sequences = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (arg == "--distances")
+            distances = static_cast<std::uint32_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (arg == "--dir")
+            dir = argv[i + 1];
+    }
+    std::filesystem::create_directories(dir);
+    const std::filesystem::path image = dir / "mission_control.snap";
+
+    // Warm-up, as a daemon does it from scratch.
+    const auto t_warm = Clock::now();
+    recon::PsfGridSpec spec;
+    spec.distance_au = {550.0, 1000.0, std::max(2u, distances)};
+    recon::build_psf_table(spec, dir / "psf.tbl");
+    const recon::PsfTable table = recon::PsfTable::open(dir / "psf.tbl");
+
+    const tm::Dictionary dictionary = tm::load_dictionary(SOLARLENS_SNAPSHOT_BENCH_DICTIONARY);
+
+    nav::SwarmState predicted(spacecraft);
+    for (std::uint32_t c = 0; c < spacecraft; ++c)
+        predicted.set(c, {{650.0, 1e-3 * c, 0.0}, {0.0107, 0.0, 1e-6 * c}}, 0.01);
+    nav::Propagator().propagate(predicted, 0.0, 365.0);
+
+    uplink::EngineConfig config;
+    config.light_time = uplink::constant_light_time(650.0);
+    uplink::UplinkEngine engine(config);
+    for (std::uint32_t c = 0; c < spacecraft; ++c)
+        for (std::size_t d = 0; d < static_cast<std::size_t>(days); ++d) {
+            const double start = day * (double(d) + double(c) / double(spacecraft));
+            engine.add_window(c, {start, start + 8.0 * 3600.0, c % 3, 2000.0});
+        }
+    // A backlog of command loads, planned until every craft's windows are
+    // booked a day or more ahead; the snapshot is taken mid-plan.
+    for (std::size_t s = 0; s < sequences; ++s)
+        engine.spawn(command(engine, static_cast<std::uint32_t>(s % spacecraft), 16384 + 1024 * (s % 64), 0.0,
+                             nullptr));
+    engine.run_until(0.5 * day);
+    const double warm_seconds = seconds_since(t_warm);
+    const std::uint64_t booked = engine.stats().uplinks;
+
+    const auto t_write = Clock::now();
+    core::SnapshotWriter writer;
+    table.snapshot(writer, "recon.psf_table");
+    tm::snapshot_dictionary(dictionary, writer, "tm.dictionary");
+    nav::snapshot_swarm(predicted, writer, "nav.predicted");
+    engine.snapshot_timeline(writer, "uplink.timeline");
+    writer.write(image);
+    const double write_seconds = seconds_since(t_write);
+
+    // Restart.
+    const auto t_restore = Clock::now();
+    const auto snapshot = std::make_shared<const core::Snapshot>(core::Snapshot::open(image));
+    const recon::PsfTable restored_table = recon::PsfTable::open(snapshot, "recon.psf_table");
+    const tm::Dictionary restored_dictionary = tm::restore_dictionary(*snapshot, "tm.dictionary");
+    const nav::SwarmState restored_predicted = nav::restore_swarm(*snapshot, "nav.predicted");
+    uplink::UplinkEngine restored_engine(config);
+    restored_engine.restore_timeline(*snapshot, "uplink.timeline");
+    const double restore_seconds = seconds_since(t_restore);
+
+    const auto values = table.values();
+    const auto restored_values = restored_table.values();
+    const bool table_ok = restored_table.spec() == spec
+                          && std::equal(values.begin(), values.end(), restored_values.begin(), restored_values.end());
+    const bool dictionary_ok = decoder_text(restored_dictionary) == decoder_text(dictionary);
+    const bool state_ok = restored_predicted.x == predicted.x && restored_predicted.y == predicted.y
+                          && restored_predicted.z == predicted.z && restored_predicted.vx == predicted.vx
+                          && restored_predicted.vy == predicted.vy && restored_predicted.vz == predicted.vz
+                          && restored_predicted.cr_area_mass == predicted.cr_area_mass;
+    const bool clock_ok = restored_engine.now() == engine.now();
+    const std::vector<uplink::UplinkReceipt> probed = probe(engine, spacecraft, days);
+    const bool timeline_ok = clock_ok && probed.size() == spacecraft
+                             && same(probe(restored_engine, spacecraft, days), probed);
+
+    std::printf("state: %u-node PSF table, %zu telemetry parameters, %u predicted states, %.0f days of windows, "
+                "%llu uplinks booked\n",
+                spec.distance_au.count * spec.wavelength_m.count * spec.offset_px.count,
+                dictionary.parameter_count(), spacecraft, days,
+                static_cast<unsigned long long>(booked));
+    std::printf("warm-up  %8.3f s\n", warm_seconds);
+    std::printf("write    %8.3f s  (%zu sections, %.1f MiB)\n", write_seconds, writer.section_count(),
+                double(snapshot->size_bytes()) / (1 << 20));
+    std::printf("restore  %8.3f s  (%.0fx faster than warm-up)\n", restore_seconds, warm_seconds / restore_seconds);
+    std::printf("identical: table %s, dictionary %s, states %s, timeline %s\n", table_ok ? "yes" : "NO",
+                dictionary_ok ? "yes" : "NO", state_ok ? "yes" : "NO", timeline_ok ? "yes" : "NO");
+    const int status = table_ok && dictionary_ok && state_ok && timeline_ok && restore_seconds < 1.0 ? 0 : 1;
+
+    std::filesystem::remove_all(dir);
+    return status;
+}
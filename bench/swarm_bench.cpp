@@ -0,0 +1,447 @@
+// swarm_bench: end-to-end pipeline on a synthetic swarm downlink.
+//
+//     swarm_bench [--spacecraft N] [--frames F] [--frame-size S] [--map-size M]
+//                 [--symbol-errors E] [--threads T] [--seed X] [--json PATH]
+//                 [--regularization L] [--work-dir DIR] [--min-fps R]
+//                 [--prometheus PATH] [--trace PATH] [--record PATH]
+//                 [--downlink-mbps R]
+//
+// Simulates N spacecraft at 650 AU each taking F coronagraph frames of an
+// exoplanet's Einstein ring (sim::SwarmSimulator), downlinks them as
+// RS-coded CADUs with E corrupted bytes each, then runs every stage the
+// ground segment does: ingest and frame reassembly, jitter registration,
+// corona calibration, ring photometry, one correlator integration per exposure cycle and,
+// at the end, the tiled reconstruction. Generation is timed but kept out
+// of the throughput figures.
+//
+// Writes a JSON report (stdout by default) with frames/s, per-stage
+// latency percentiles, ingest counters, registration error against the
+// simulated jitter, reconstruction error against the truth map and peak
+// RSS. Exits non-zero if any frame is lost, or if
+// --min-fps is given and throughput falls below it; exits 2 on an unknown
+// flag or a flag without its value. --prometheus writes the
+// library's per-stage instrumentation (perf/) in Prometheus text format;
+// --trace captures it as a Chrome/Perfetto trace. --record writes the
+// corrupted downlink as a pass recording (ingest/pass_recording.hpp) with
+// CADUs arriving back to back at R Mbit/s, for solarlens-replay.
+// Scratch files go in a per-process temporary directory removed on exit,
+// or in --work-dir, which is kept.
+
+#include <algorithm>
+#include <bit>
+#include <chrono>
+#include <cmath>
+#include <complex>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+#include <unistd.h>
+
+#include "solarlens/calib/corona.hpp"
+#include "solarlens/calib/registration.hpp"
+#include "solarlens/core/arena.hpp"
+#include "solarlens/corr/correlator.hpp"
+#include "solarlens/ingest/pass_recording.hpp"
+#include "solarlens/ingest/pipeline.hpp"
+#include "solarlens/ingest/tm_encoder.hpp"
+#include "solarlens/perf/export.hpp"
+#include "solarlens/perf/instrument.hpp"
+#include "solarlens/recon/deconvolution.hpp"
+#include "solarlens/recon/map_file.hpp"
+#include "solarlens/recon/ring_sample.hpp"
+#include "solarlens/sched/scheduler.hpp"
+#include "solarlens/sim/image_packets.hpp"
+#include "solarlens/sim/swarm.hpp"
+
+namespace {
+
+using namespace solarlens;
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point t0)
+{
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+/// Latency samples of one stage, one per unit of work.
+struct Stage {
+    const char* name;
+    const char* unit;
+    std::vector<double> seconds;
+
+    double total() const
+    {
+        double s = 0.0;
+        for (double v : seconds)
+            s += v;
+        return s;
+    }
+
+    double percentile(double p) const
+    {
+        if (seconds.empty())
+            return 0.0;
+        std::vector<double> sorted = seconds;
+        std::sort(sorted.begin(), sorted.end());
+        const auto rank = static_cast<std::size_t>(std::ceil(p / 100.0 * sorted.size()));
+        return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+    }
+};
+
+std::uint64_t peak_rss_bytes()
+{
+    rusage usage {};
+    ::getrusage(RUSAGE_SELF, &usage);
+    return std::uint64_t(usage.ru_maxrss) * 1024; // Linux reports KiB.
+}
+
+int usage()
+{
+    std::fprintf(stderr,
+                 "usage: swarm_bench [--spacecraft N] [--frames F] [--frame-size S] [--map-size M]\n"
+                 "                   [--symbol-errors E] [--threads T] [--seed X] [--json PATH]\n"
+                 "                   [--regularization L] [--work-dir DIR] [--min-fps R]\n"
+                 "                   [--prometheus PATH] [--trace PATH] [--record PATH]\n"
+                 "                   [--downlink-mbps R]\n");
+    return 2;
+}
+
+/// Removes the bench's own scratch directory however main() returns; a
+/// --work-dir given by the caller is left in place.
+struct RemoveOnExit {
+    std::filesystem::path dir;
+
+    ~RemoveOnExit()
+    {
+        std::error_code ec;
+        if (!dir.empty())
+            std::filesystem::remove_all(dir, ec);
+    }
+};
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    sim::SwarmConfig cfg;
+    unsigned symbol_errors = 8;
+    unsigned threads = std::thread::hardware_concurrency();
+    std::string json_path;
+    std::string prometheus_path;
+    std::string trace_path;
+    std::string record_path;
+    double downlink_mbps = 8.0;
+    const std::filesystem::path default_work_dir =
+        std::filesystem::temp_directory_path() / ("solarlens-swarm-bench-" + std::to_string(::getpid()));
+    std::filesystem::path work_dir = default_work_dir;
+    double min_fps = 0.0;
+    double regularization = 100.0;
+    for (int i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc)
+            return usage();
+        const std::string flag = argv[i];
+        const char* value = argv[i + 1];
+        if (flag == "--spacecraft")
+            cfg.spacecraft = std::strtoul(value, nullptr, 10);
+        else if (flag == "--frames")
+            cfg.frames_per_craft = std::strtoul(value, nullptr, 10);
+        else if (flag == "--frame-size")
+            cfg.frame_size = static_cast<std::uint32_t>(std::atoi(value));
+        else if (flag == "--map-size")
+            cfg.map_size = static_cast<std::uint32_t>(std::atoi(value));
+        else if (flag == "--symbol-errors")
+            symbol_errors = static_cast<unsigned>(std::atoi(value));
+        else if (flag == "--threads")
+            threads = static_cast<unsigned>(std::atoi(value));
+        else if (flag == "--seed")
+            cfg.seed = std::strtoull(value, nullptr, 10);
+        else if (flag == "--json")
+            json_path = value;
+        else if (flag == "--work-dir")
+            work_dir = value;
+        else if (flag == "--min-fps")
+            min_fps = std::atof(value);
+        else if (flag == "--regularization")
+            regularization = std::atof(value);
+        else if (flag == "--prometheus")
+            prometheus_path = value;
+        else if (flag == "--trace")
+            trace_path = value;
+        else if (flag == "--record")
+            record_path = value;
+        else if (flag == "--downlink-mbps")
+            downlink_mbps = std::atof(value);
+        else
+            return usage();
+    }
+    perf::set_tracing(!trace_path.empty());
+
+    const sim::SwarmSimulator swarm(cfg);
+    const std::uint32_t n = cfg.frame_size;
+    const ingest::LinkConfig link;
+    sched::Scheduler scheduler(std::max(1u, threads));
+    const RemoveOnExit scratch {work_dir == default_work_dir ? work_dir : std::filesystem::path {}};
+    std::filesystem::create_directories(work_dir);
+
+    // Ground segment.
+    ingest::IngestPipeline pipeline(link, &scheduler);
+    sim::FrameAssembler assembler;
+    calib::RegistrationConfig reg_cfg;
+    reg_cfg.size = std::uint32_t(1) << (31 - std::countl_zero(n));
+    reg_cfg.band = reg_cfg.size / 4;
+    calib::FrameRegistrar registrar(reg_cfg);
+    const calib::CoronaSubtractor subtractor(swarm.geometry());
+    core::PassArena arena;
+    const corr::CorrelatorConfig corr_cfg {cfg.spacecraft, cfg.channels, cfg.spectra};
+    const corr::CorrelatorBackend backend = corr::default_correlator_backend();
+    auto correlator = corr::make_correlator(corr_cfg, backend, &scheduler);
+    corr::Visibilities vis;
+    const std::filesystem::path samples_path = work_dir / "samples.slrs";
+    recon::RingSampleWriter samples(samples_path);
+    std::optional<ingest::PassRecorder> recorder;
+    if (!record_path.empty())
+        recorder.emplace(record_path, link);
+    const double cadu_ns = double(link.cadu_size()) * 8.0 / (std::max(downlink_mbps, 1e-6) * 1e6) * 1e9;
+
+    // Spacecraft side.
+    std::vector<ingest::TmEncoder> encoders;
+    std::vector<std::uint16_t> sequence(cfg.spacecraft, 0);
+    for (std::size_t c = 0; c < cfg.spacecraft; ++c)
+        encoders.emplace_back(link, static_cast<std::uint16_t>(100 + c), 0);
+    const std::uint32_t rows_per_packet = std::max(1u, 4096u / (2 * n));
+
+    Stage generate {"generate", "cycle", {}};
+    Stage ingest_stage {"ingest", "cycle", {}};
+    Stage register_stage {"register", "cycle", {}};
+    Stage calibrate {"calibrate", "cycle", {}};
+    Stage photometry {"photometry", "frame", {}};
+    Stage correlate {"correlate", "integration", {}};
+    Stage reconstruct {"reconstruct", "run", {}};
+
+    std::vector<std::uint16_t> counts(std::size_t(n) * n);
+    std::vector<std::byte> downlink;
+    std::vector<std::span<std::byte>> cadus;
+    std::vector<std::complex<float>> baseband(corr_cfg.stations * corr_cfg.samples_per_station());
+    std::mt19937 channel_rng(static_cast<std::uint32_t>(cfg.seed));
+    std::uniform_int_distribution<std::size_t> error_pos(link.sync_marker ? 4 : 0,
+                                                          link.cadu_size() - 1);
+    std::uint64_t frames_done = 0;
+    double flux_chi2 = 0.0;
+    // Jitter truth per frame. The simulated jitter is zero-mean about the
+    // boresight, as the registered offsets are about the window's mean.
+    std::vector<sim::FrameTruth> truths(swarm.frame_count());
+    std::vector<calib::FrameShift> shifts;
+    std::vector<std::uint32_t> streams;
+    double shift_err2 = 0.0;
+    std::uint64_t shifts_registered = 0;
+    const auto run_start = Clock::now();
+    double processing = 0.0;
+
+    for (std::size_t f = 0; f < cfg.frames_per_craft; ++f) {
+        // One exposure cycle: every craft takes a frame and downlinks it.
+        auto t0 = Clock::now();
+        downlink.clear();
+        for (std::size_t c = 0; c < cfg.spacecraft; ++c) {
+            truths[c * cfg.frames_per_craft + f] = swarm.render(c, f, counts);
+            const ingest::CaduSink sink = [&](std::span<const std::byte> cadu) {
+                downlink.insert(downlink.end(), cadu.begin(), cadu.end());
+                for (unsigned e = 0; e < symbol_errors; ++e)
+                    downlink[downlink.size() - cadu.size() + error_pos(channel_rng)] ^= std::byte{0x5A};
+            };
+            sim::send_frame(static_cast<std::uint32_t>(f), counts, n, n, rows_per_packet,
+                            sequence[c], encoders[c], sink);
+            encoders[c].flush(sink);
+        }
+        cadus.clear();
+        for (std::size_t off = 0; off < downlink.size(); off += link.cadu_size())
+            cadus.emplace_back(downlink.data() + off, link.cadu_size());
+        if (recorder) {
+            // Before decoding, which works in place.
+            for (const auto& cadu : cadus)
+                recorder->append(static_cast<std::uint64_t>(double(recorder->count()) * cadu_ns), cadu);
+        }
+        swarm.baseband(f, baseband);
+        generate.seconds.push_back(seconds_since(t0));
+
+        const auto cycle_start = Clock::now();
+        t0 = Clock::now();
+        pipeline.process(cadus, [&](std::span<const ingest::PacketRef> packets) {
+            for (const ingest::PacketRef& p : packets)
+                assembler.add(p);
+        });
+        std::vector<sim::FrameAssembler::Frame> frames = assembler.take_completed();
+        ingest_stage.seconds.push_back(seconds_since(t0));
+
+        t0 = Clock::now();
+        std::vector<core::ImageView<float>> views;
+        streams.clear();
+        for (auto& fr : frames) {
+            views.emplace_back(fr.pixels.data(), fr.width, fr.height);
+            streams.push_back(fr.spacecraft);
+        }
+        shifts.resize(frames.size());
+        registrar.process(views, streams, shifts, scheduler);
+        register_stage.seconds.push_back(seconds_since(t0));
+        for (std::size_t i = 0; i < frames.size(); ++i) {
+            if (!shifts[i].registered)
+                continue;
+            const std::size_t c = frames[i].spacecraft - 100u;
+            const sim::FrameTruth& now = truths[c * cfg.frames_per_craft + frames[i].index];
+            const double ex = shifts[i].dx - now.jitter_x;
+            const double ey = shifts[i].dy - now.jitter_y;
+            shift_err2 += ex * ex + ey * ey;
+            ++shifts_registered;
+        }
+
+        t0 = Clock::now();
+        std::vector<core::ImageView<const float>> raw(views.begin(), views.end());
+        const calib::CalibratedFrames calibrated =
+            calib::calibrate_frames(subtractor, raw, arena, scheduler);
+        calibrate.seconds.push_back(seconds_since(t0));
+
+        for (std::size_t i = 0; i < frames.size(); ++i) {
+            if (calibrated.models[i].fit_pixels == 0)
+                continue;
+            t0 = Clock::now();
+            const sim::RingPhotometry ring = swarm.measure_ring(calibrated.frames[i]);
+            float u = 0, v = 0;
+            swarm.position(frames[i].spacecraft - 100, frames[i].index, u, v);
+            samples.append(recon::RingSample {u, v, float(ring.flux), float(ring.sigma)});
+            photometry.seconds.push_back(seconds_since(t0));
+            const double truth = swarm.flux_at(u, v);
+            flux_chi2 += (ring.flux - truth) * (ring.flux - truth) / (ring.sigma * ring.sigma);
+            ++frames_done;
+        }
+        arena.reset();
+
+        t0 = Clock::now();
+        correlator->correlate({baseband, swarm.station_delays()}, vis);
+        correlate.seconds.push_back(seconds_since(t0));
+        processing += seconds_since(cycle_start);
+    }
+    samples.close();
+    if (recorder)
+        recorder->close();
+
+    recon::DeconvolutionConfig recon_cfg;
+    recon_cfg.map_size = cfg.map_size;
+    recon_cfg.memory_budget_bytes = std::size_t(64) << 20;
+    recon_cfg.scratch_dir = work_dir;
+    recon_cfg.scheduler = &scheduler;
+    recon_cfg.solver.regularization = regularization;
+    recon::DeconvolutionEngine engine(swarm.psf(), recon_cfg);
+    const std::filesystem::path map_path = work_dir / "map.slmp";
+    auto t0 = Clock::now();
+    const recon::DeconvolutionReport report = engine.run(samples_path, map_path);
+    reconstruct.seconds.push_back(seconds_since(t0));
+
+    std::vector<float> map(std::size_t(cfg.map_size) * cfg.map_size);
+    recon::MapFileReader(map_path).read_block(0, 0, cfg.map_size, cfg.map_size, map);
+    double err2 = 0.0, ref2 = 0.0;
+    for (std::size_t i = 0; i < map.size(); ++i) {
+        const double d = double(map[i]) - swarm.planet()[i];
+        err2 += d * d;
+        ref2 += double(swarm.planet()[i]) * swarm.planet()[i];
+    }
+    int iterations = 0;
+    for (const recon::TileReport& t : report.tiles)
+        iterations = std::max(iterations, t.solve.iterations);
+    const double wall = seconds_since(run_start);
+
+    const std::uint64_t frames_expected = swarm.frame_count();
+    const double fps = processing > 0 ? double(frames_done) / processing : 0.0;
+    const ingest::IngestStats& is = pipeline.stats();
+
+    std::FILE* out = json_path.empty() ? stdout : std::fopen(json_path.c_str(), "w");
+    if (out == nullptr) {
+        std::perror(json_path.c_str());
+        return 1;
+    }
+    std::fprintf(out, "{\n  \"benchmark\": \"swarm_bench\",\n");
+    std::fprintf(out,
+                 "  \"config\": {\"spacecraft\": %zu, \"frames_per_craft\": %zu, "
+                 "\"frame_size\": %u, \"map_size\": %u, \"distance_au\": %.1f, "
+                 "\"symbol_errors_per_cadu\": %u, \"threads\": %zu, \"seed\": %llu, "
+                 "\"correlator\": \"%s\"},\n",
+                 cfg.spacecraft, cfg.frames_per_craft, cfg.frame_size, cfg.map_size,
+                 cfg.psf.distance_au, symbol_errors, scheduler.worker_count(),
+                 static_cast<unsigned long long>(cfg.seed),
+                 std::string(corr::to_string(backend)).c_str());
+    std::fprintf(out, "  \"frames\": %llu,\n  \"frames_expected\": %llu,\n",
+                 static_cast<unsigned long long>(frames_done),
+                 static_cast<unsigned long long>(frames_expected));
+    std::fprintf(out, "  \"frames_per_second\": %.3f,\n", fps);
+    std::fprintf(out, "  \"processing_seconds\": %.6f,\n  \"wall_seconds\": %.6f,\n", processing,
+                 wall);
+    std::fprintf(out, "  \"stages\": {\n");
+    const Stage* stages[] = {&generate, &ingest_stage, &register_stage, &calibrate, &photometry, &correlate,
+                             &reconstruct};
+    for (std::size_t i = 0; i < std::size(stages); ++i) {
+        const Stage& s = *stages[i];
+        std::fprintf(out,
+                     "    \"%s\": {\"unit\": \"%s\", \"count\": %zu, \"total_s\": %.6f, "
+                     "\"p50_ms\": %.4f, \"p90_ms\": %.4f, \"p99_ms\": %.4f, \"max_ms\": %.4f}%s\n",
+                     s.name, s.unit, s.seconds.size(), s.total(), 1e3 * s.percentile(50),
+                     1e3 * s.percentile(90), 1e3 * s.percentile(99), 1e3 * s.percentile(100),
+                     i + 1 < std::size(stages) ? "," : "");
+    }
+    std::fprintf(out, "  },\n");
+    std::fprintf(out,
+                 "  \"ingest\": {\"cadus\": %llu, \"frames\": %llu, \"packets\": %llu, "
+                 "\"reassembled\": %llu, \"rs_corrected\": %llu, \"rs_failed\": %llu, "
+                 "\"crc_failed\": %llu, \"bad_header\": %llu, \"vc_gaps\": %llu, \"packets_dropped\": %llu, "
+                 "\"malformed_images\": %llu},\n",
+                 static_cast<unsigned long long>(is.cadus), static_cast<unsigned long long>(is.frames),
+                 static_cast<unsigned long long>(is.packets),
+                 static_cast<unsigned long long>(is.reassembled),
+                 static_cast<unsigned long long>(is.rs_corrected),
+                 static_cast<unsigned long long>(is.rs_failed),
+                 static_cast<unsigned long long>(is.crc_failed),
+                 static_cast<unsigned long long>(is.bad_header),
+                 static_cast<unsigned long long>(is.vc_gaps),
+                 static_cast<unsigned long long>(is.packets_dropped),
+                 static_cast<unsigned long long>(assembler.malformed()));
+    std::fprintf(out, "  \"registration\": {\"registered\": %llu, \"rms_error_px\": %.4f, \"jitter_px\": %.3f},\n",
+                 static_cast<unsigned long long>(shifts_registered),
+                 shifts_registered ? std::sqrt(shift_err2 / double(shifts_registered)) : 0.0, cfg.jitter_px);
+    std::fprintf(out,
+                 "  \"photometry\": {\"reduced_chi2\": %.4f},\n"
+                 "  \"reconstruction\": {\"samples\": %llu, \"tiles\": %zu, \"tile_size\": %u, "
+                 "\"max_iterations\": %d, \"relative_rms_error\": %.6f},\n",
+                 frames_done ? flux_chi2 / double(frames_done) : 0.0,
+                 static_cast<unsigned long long>(report.samples_read), report.tiles.size(),
+                 report.tile_size, iterations, ref2 > 0 ? std::sqrt(err2 / ref2) : 0.0);
+    std::fprintf(out, "  \"peak_rss_bytes\": %llu\n}\n",
+                 static_cast<unsigned long long>(peak_rss_bytes()));
+    if (out != stdout)
+        std::fclose(out);
+    if (!prometheus_path.empty()) {
+        std::ofstream prom(prometheus_path);
+        perf::write_prometheus(perf::snapshot(), prom);
+    }
+    if (!trace_path.empty()) {
+        std::ofstream trace(trace_path);
+        perf::write_chrome_trace(perf::collect_trace(), trace);
+    }
+
+    if (frames_done != frames_expected) {
+        std::fprintf(stderr, "swarm_bench: %llu of %llu frames lost\n",
+                     static_cast<unsigned long long>(frames_expected - frames_done),
+                     static_cast<unsigned long long>(frames_expected));
+        return 1;
+    }
+    if (min_fps > 0.0 && fps < min_fps) {
+        std::fprintf(stderr, "swarm_bench: %.1f frames/s below required %.1f\n", fps, min_fps);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,220 @@
+// timeseries_bench: housekeeping time-series ingest, compression and
+// dashboard query latency.
+//
+//     timeseries_bench [--spacecraft N] [--channels C] [--days D]
+//                      [--cadence S] [--max-ms M]
+//
+// Generates D days of quantised housekeeping (temperatures, voltages,
+// wheel speeds: slow drifts, orbit-like cycles and ADC noise) every S
+// seconds for C channels on each of N spacecraft, appends all but the last
+// day directly in time order across the swarm, and publishes the last day
+// on a telemetry bus topic recorded by a TimeSeriesRecorder. Checks that
+// every sample decodes bit for bit and that rollups match a brute-force
+// aggregate, then times dashboard queries (1000-point budget) over the
+// whole span, a week and six hours for every series. Reports ingest rate,
+// bytes per sample and query latency percentiles. Exits non-zero on any
+// mismatch or if the whole-span query's p99 exceeds M milliseconds.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "solarlens/archive/timeseries.hpp"
+#include "solarlens/bus/bus.hpp"
+
+namespace {
+
+using namespace solarlens;
+using Clock = std::chrono::steady_clock;
+
+constexpr std::int64_t second_ns = 1'000'000'000;
+constexpr std::int64_t day_ns = 86400 * second_ns;
+constexpr double pi = 3.14159265358979323846;
+
+double seconds_since(Clock::time_point t0)
+{
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+std::uint64_t mix(std::uint64_t x) noexcept
+{
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+
+// Sample i of a series: a calibrated 12-bit ADC reading.
+double value(archive::SeriesKey key, std::int64_t i, std::int64_t cadence_s)
+{
+    const double t_days = double(i * cadence_s) / 86400.0;
+    const double phase = 0.37 * key.spacecraft + 1.3 * key.channel;
+    const double drift = 0.2 * std::sin(2 * pi * t_days / 90.0 + phase);
+    const double cycle = 0.1 * std::sin(2 * pi * t_days / (0.8 + 0.1 * key.channel) + phase);
+    const std::uint64_t h = mix((std::uint64_t(key.spacecraft) << 48) ^ (std::uint64_t(key.channel) << 40)
+                                ^ std::uint64_t(i));
+    const double noise = (double(h >> 11) * 0x1.0p-53 - 0.5) * 0.004;
+    const double counts = std::round(2048.0 + 1500.0 * (drift + cycle + noise + 0.1 * key.channel));
+    const double scale[] = {0.0625, 0.00488, 1.5, 0.01};  // degC, V, rpm, A per count.
+    return counts * scale[key.channel % 4];
+}
+
+double percentile(std::vector<double> v, double q)
+{
+    std::sort(v.begin(), v.end());
+    return v.empty() ? 0.0 : v[std::min(v.size() - 1, static_cast<std::size_t>(q * double(v.size())))];
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::uint16_t spacecraft = 24;
+    std::uint16_t channels = 4;
+    double days = 90.0;
+    std::int64_t cadence_s = 30;
+    double max_ms = 10.0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        if (arg == "--spacecraft")
+            spacecraft = static_cast<std::uint16_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (arg == "--channels")
+            channels = static_cast<std::uint16_t>(std::strtoul(argv[i + 1], nullptr, 10));
+        else if (arg == "--days")
+            days = std::atof(argv[i + 1]);
+        else if (arg == "--cadence")
+            cadence_s = std::strtoll(argv[i + 1], nullptr, 10);
+        else if (arg == "--max-ms")
+            max_ms = std::atof(argv[i + 1]);
+    }
+    const std::int64_t per_series = static_cast<std::int64_t>(days * 86400.0) / cadence_s;
+    const std::int64_t bus_from = std::max<std::int64_t>(0, per_series - 86400 / cadence_s);
+    const std::int64_t span_ns = per_series * cadence_s * second_ns;
+
+    std::vector<archive::SeriesKey> keys;
+    for (std::uint16_t c = 0; c < spacecraft; ++c)
+        for (std::uint16_t ch = 0; ch < channels; ++ch)
+            keys.push_back({c, ch});
+
+    archive::TimeSeriesStore store;
+    std::vector<archive::HousekeepingSample> batch;
+    batch.reserve(4096);
+    const auto t_ingest = Clock::now();
+    for (std::int64_t i = 0; i < bus_from; ++i) {
+        for (const archive::SeriesKey& k : keys)
+            batch.push_back({i * cadence_s * second_ns, value(k, i, cadence_s), k.spacecraft, k.channel, 0});
+        if (batch.size() >= 4000 || i + 1 == bus_from) {
+            store.append(batch);
+            batch.clear();
+        }
+    }
+    const double ingest_seconds = seconds_since(t_ingest);
+    const auto direct = static_cast<std::uint64_t>(bus_from) * keys.size();
+
+    // The last day arrives over the bus.
+    bus::TelemetryBus telemetry;
+    auto& topic = telemetry.topic<archive::HousekeepingSample>("housekeeping", bus::Publishers::single);
+    std::uint64_t recorded = 0, dropped = 0;
+    const auto t_bus = Clock::now();
+    {
+        bus::SubscriberOptions options;
+        options.capacity = 8192;
+        options.policy = bus::Backpressure::block;
+        options.block_timeout = std::chrono::seconds(1);
+        archive::TimeSeriesRecorder recorder(store, topic, options);
+        for (std::int64_t i = bus_from; i < per_series; ++i)
+            for (const archive::SeriesKey& k : keys)
+                topic.publish({i * cadence_s * second_ns, value(k, i, cadence_s), k.spacecraft, k.channel, 0});
+        while (recorder.recorded() < static_cast<std::uint64_t>(per_series - bus_from) * keys.size()
+               && recorder.subscription_stats().dropped == 0)
+            std::this_thread::yield();
+        recorded = recorder.recorded();
+        dropped = recorder.subscription_stats().dropped;
+    }
+    const double bus_seconds = seconds_since(t_bus);
+    const archive::TimeSeriesStats st = store.stats();
+
+    int status = 0;
+    // Every sample back, bit for bit.
+    std::size_t bad_samples = 0;
+    for (const archive::SeriesKey& k : keys) {
+        const std::vector<archive::TimedValue> got = store.samples(k, 0, span_ns);
+        if (got.size() != std::size_t(per_series))
+            ++bad_samples;
+        for (std::size_t i = 0; i < got.size(); ++i)
+            if (got[i].t_ns != std::int64_t(i) * cadence_s * second_ns
+                || got[i].value != value(k, std::int64_t(i), cadence_s))
+                ++bad_samples;
+    }
+
+    // Rollups against brute force, over a misaligned range.
+    std::size_t bad_rollups = 0;
+    for (const archive::SeriesKey& k : {keys.front(), keys.back()}) {
+        const std::int64_t t0 = span_ns / 7 + 12345, t1 = span_ns - span_ns / 5;
+        const archive::RollupResult r = store.rollup(k, t0, t1, 1000);
+        if (r.points.size() > 1000 || r.resolution_ns == 0)
+            ++bad_rollups;
+        const std::int64_t step = cadence_s * second_ns;
+        for (const archive::RollupPoint& p : r.points) {
+            double lo = 1e300, hi = -1e300, sum = 0.0;
+            std::uint64_t n = 0;
+            for (std::int64_t i = (p.t_ns + step - 1) / step; i * step < p.t_ns + r.resolution_ns; ++i) {
+                const double v = value(k, i, cadence_s);
+                lo = std::min(lo, v);
+                hi = std::max(hi, v);
+                sum += v;
+                ++n;
+            }
+            if (n != p.count || lo != p.min || hi != p.max
+                || std::abs(sum / double(n) - p.mean) > 1e-9 * std::abs(p.mean))
+                ++bad_rollups;
+        }
+    }
+
+    // Dashboard queries: every series, three windows.
+    std::printf("%zu series x %lld samples (%.0f days every %lld s); %llu appended directly, %llu over the bus "
+                "(%llu dropped), %llu out of order\n",
+                keys.size(), static_cast<long long>(per_series), days, static_cast<long long>(cadence_s),
+                static_cast<unsigned long long>(direct), static_cast<unsigned long long>(recorded),
+                static_cast<unsigned long long>(dropped), static_cast<unsigned long long>(st.out_of_order));
+    std::printf("ingest: %.1f M samples/s direct, %.1f M samples/s through the bus\n",
+                double(direct) / ingest_seconds / 1e6, double(recorded) / bus_seconds / 1e6);
+    std::printf("storage: %.2f bytes/sample compressed (raw 16), rollups %.1f MiB, total %.1f MiB\n",
+                double(st.sample_bytes) / double(st.appended), double(st.rollup_bytes) / (1 << 20),
+                double(st.sample_bytes + st.rollup_bytes) / (1 << 20));
+    std::printf("%-10s %12s %8s %10s %10s %12s\n", "window", "resolution", "points", "p50_ms", "p99_ms",
+                "dashboard_ms");
+    struct Window {
+        const char* name;
+        std::int64_t length;
+    };
+    for (const Window w : {Window {"all", span_ns}, Window {"week", 7 * day_ns}, Window {"6 hours", day_ns / 4}}) {
+        std::vector<double> ms;
+        std::int64_t resolution = 0;
+        std::size_t points = 0;
+        const auto t_board = Clock::now();
+        for (const archive::SeriesKey& k : keys) {
+            const auto t0 = Clock::now();
+            const archive::RollupResult r = store.rollup(k, span_ns - w.length, span_ns, 1000);
+            ms.push_back(1e3 * seconds_since(t0));
+            resolution = r.resolution_ns;
+            points = r.points.size();
+        }
+        const double board_ms = 1e3 * seconds_since(t_board);
+        const std::string res = resolution == 0 ? "raw" : std::to_string(resolution / second_ns) + " s";
+        std::printf("%-10s %12s %8zu %10.3f %10.3f %12.2f\n", w.name, res.c_str(), points, percentile(ms, 0.5),
+                    percentile(ms, 0.99), board_ms);
+        if (w.length == span_ns && percentile(ms, 0.99) > max_ms)
+            status = 1;
+    }
+    std::printf("checks: %zu bad samples, %zu bad rollup points\n", bad_samples, bad_rollups);
+    if (bad_samples != 0 || bad_rollups != 0 || dropped != 0 || st.out_of_order != 0)
+        status = 1;
+    return status;
+}
@@ -0,0 +1,132 @@
+// tm_bench: compiled vs interpreted housekeeping decommutation.
+//
+//     tm_bench [--packets N] [--passes P] [--min-speedup X]
+//
+// Fills N random data fields for each packet of the cubesat_hk dictionary
+// and decodes every parameter P times, once through the decoders
+// solarlens-tm-dict generated from it at build time and once by walking
+// the parsed dictionary with decode_parameter. Every compiled value is
+// checked against the interpreted one. With --min-speedup the exit
+// status is non-zero unless the compiled path is at least X times faster.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "cubesat_hk.hpp"
+#include "solarlens/tm/dictionary.hpp"
+
+namespace {
+
+namespace tm = solarlens::tm;
+
+struct Sample {
+    const tm::PacketDef* def;
+    std::vector<std::byte> data;
+};
+
+/// Representative current-value table: one slot per parameter of the
+/// last decoded packet of each type.
+struct ValueTable {
+    std::vector<std::byte> compiled;
+    std::vector<double> interpreted;
+};
+
+double seconds_since(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::size_t packets = 2000;
+    int passes = 20;
+    double min_speedup = 0.0;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string flag = argv[i];
+        if (flag == "--packets")
+            packets = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (flag == "--passes")
+            passes = std::atoi(argv[i + 1]);
+        else if (flag == "--min-speedup")
+            min_speedup = std::atof(argv[i + 1]);
+    }
+
+    const auto dictionary = tm::load_dictionary(SOLARLENS_TM_BENCH_DICTIONARY);
+    std::mt19937_64 rng(13);
+    std::vector<Sample> samples;
+    std::size_t largest = 0;
+    for (std::size_t n = 0; n < packets; ++n)
+        for (const auto& def : dictionary.packets) {
+            Sample s {&def, std::vector<std::byte>(def.length)};
+            for (auto& b : s.data)
+                b = static_cast<std::byte>(rng());
+            samples.push_back(std::move(s));
+            largest = std::max(largest, def.parameters.size());
+        }
+    std::shuffle(samples.begin(), samples.end(), rng);
+    const std::size_t per_pass = packets * dictionary.parameter_count();
+    std::printf("%s: %zu packet types, %zu parameters, %zu packets/pass\n", dictionary.name.c_str(),
+                dictionary.packets.size(), dictionary.parameter_count(), samples.size());
+
+    // Agreement first: every compiled value against its interpretation.
+    std::size_t mismatches = 0;
+    for (const auto& s : samples) {
+        const bool known = tm::dict::cubesat_hk::dispatch(s.def->apid, s.data, [&](auto packet, const auto&) {
+            using Packet = decltype(packet);
+            std::size_t i = 0;
+            Packet::layout::for_each(s.data.data(), [&](auto, auto value) {
+                const double want = tm::decode_parameter(s.def->parameters[i++], s.data);
+                const double got = static_cast<double>(value);
+                if (std::memcmp(&want, &got, sizeof got) != 0 && !(want != want && got != got))
+                    ++mismatches;
+            });
+        });
+        if (!known)
+            ++mismatches;
+    }
+
+    ValueTable table;
+    table.compiled.resize(65536);
+    table.interpreted.resize(largest);
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass)
+        for (const auto& s : samples)
+            tm::dict::cubesat_hk::dispatch(s.def->apid, s.data, [&](auto, const auto& values) {
+                static_assert(sizeof values <= 65536);
+                std::memcpy(table.compiled.data(), &values, sizeof values);
+            });
+    const double compiled_s = seconds_since(t0);
+
+    t0 = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < passes; ++pass)
+        for (const auto& s : samples) {
+            const auto* def = dictionary.find(s.def->apid);
+            for (std::size_t i = 0; i < def->parameters.size(); ++i)
+                table.interpreted[i] = tm::decode_parameter(def->parameters[i], s.data);
+        }
+    const double interpreted_s = seconds_since(t0);
+
+    unsigned checksum = 0;
+    for (auto b : table.compiled)
+        checksum += std::to_integer<unsigned>(b);
+    for (double v : table.interpreted)
+        checksum += static_cast<unsigned>(v != 0.0);
+
+    const double total = double(per_pass) * passes;
+    const double speedup = interpreted_s / compiled_s;
+    std::printf("%-12s %14s %10s\n", "decoder", "params/s", "ns/param");
+    std::printf("%-12s %14.3e %10.2f\n", "compiled", total / compiled_s, 1e9 * compiled_s / total);
+    std::printf("%-12s %14.3e %10.2f\n", "interpreted", total / interpreted_s, 1e9 * interpreted_s / total);
+    std::printf("speedup %.2fx, %zu mismatches (checksum %u)\n", speedup, mismatches, checksum);
+    if (mismatches)
+        return 1;
+    return speedup >= min_speedup ? 0 : 1;
+}
@@ -0,0 +1,208 @@
+// uplink_bench: light-time-aware command planning for a swarm.
+//
+//     uplink_bench [--spacecraft N] [--sequences S] [--steps K] [--days D]
+//                  [--threads T] [--distance AU] [--seed X]
+//
+// Each of N spacecraft gets one 8-hour DSN allocation per day, staggered
+// across the swarm, for D days. S command sequences (spread round-robin
+// over the craft) each run K steps: wait a planning delay, uplink a
+// command block, let it execute on board a while after arrival, and wait
+// for the confirming telemetry. Half the sequences of each spacecraft
+// also hold their second step until that craft's first sequence has
+// confirmed its first command (uplink::Event). The plan runs once on the
+// calling thread and once with a T-worker scheduler.
+//
+// Reports wall time, resumptions/s, peak live sequences, uplinks granted,
+// and command latency (request to confirmation, days). Exits non-zero if
+// the two runs disagree on any receipt, or any sequence fails or stalls.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "solarlens/sched/scheduler.hpp"
+#include "solarlens/uplink/engine.hpp"
+
+namespace {
+
+using namespace solarlens;
+using Clock = std::chrono::steady_clock;
+
+constexpr double day = 86400.0;
+
+double seconds_since(Clock::time_point t0)
+{
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+double percentile(std::vector<double> v, double q)
+{
+    if (v.empty())
+        return 0.0;
+    std::sort(v.begin(), v.end());
+    return v[std::min(v.size() - 1, static_cast<std::size_t>(q * double(v.size())))];
+}
+
+struct Record {
+    std::vector<uplink::UplinkReceipt> receipts;
+    std::vector<double> latency_days;
+};
+
+uplink::Sequence command(uplink::UplinkEngine& engine, std::uint32_t craft, std::uint32_t bytes,
+                         double execute_after_s, Record& record)
+{
+    const uplink::MissionTime requested = engine.now();
+    const uplink::UplinkReceipt rx = co_await engine.uplink(craft, bytes);
+    const uplink::MissionTime seen = co_await engine.observed(craft, rx.onboard + execute_after_s);
+    record.receipts.push_back(rx);
+    record.latency_days.push_back((seen - requested) / day);
+}
+
+uplink::Sequence plan(uplink::UplinkEngine& engine, std::uint32_t craft, std::size_t steps, std::uint64_t seed,
+                      uplink::Event* lead, bool leader, Record& record)
+{
+    std::mt19937_64 rng(seed);
+    std::uniform_real_distribution<double> delay(0.0, 0.5 * day);
+    std::uniform_int_distribution<std::uint32_t> bytes(64, 4096);
+    std::uniform_real_distribution<double> execute(600.0, 6.0 * 3600.0);
+    for (std::size_t k = 0; k < steps; ++k) {
+        co_await engine.after(delay(rng));
+        if (k == 1 && lead && !leader)
+            co_await *lead;
+        co_await command(engine, craft, bytes(rng), execute(rng), record);
+        if (k == 0 && leader)
+            lead->set();
+    }
+}
+
+struct Run {
+    double seconds = 0.0;
+    uplink::EngineStats stats;
+    std::size_t stalled = 0;
+    std::string error;
+    std::vector<Record> records;
+};
+
+Run run(std::size_t spacecraft, std::size_t sequences, std::size_t steps, double days, double distance_au,
+        std::uint64_t seed, sched::Scheduler* scheduler)
+{
+    uplink::EngineConfig config;
+    config.light_time = uplink::constant_light_time(distance_au);
+    uplink::UplinkEngine engine(config, scheduler);
+    for (std::uint32_t c = 0; c < spacecraft; ++c) {
+        const double offset = day * double(c) / double(spacecraft);
+        for (std::size_t d = 0; d < static_cast<std::size_t>(days); ++d) {
+            const double start = day * double(d) + offset;
+            engine.add_window(c, {start, start + 8.0 * 3600.0, c % 3, 2000.0});
+        }
+    }
+
+    Run out;
+    out.records.resize(sequences);
+    std::vector<std::unique_ptr<uplink::Event>> leads;
+    for (std::size_t c = 0; c < spacecraft; ++c)
+        leads.push_back(std::make_unique<uplink::Event>(engine));
+    for (std::size_t s = 0; s < sequences; ++s) {
+        const auto craft = static_cast<std::uint32_t>(s % spacecraft);
+        const bool leader = s < spacecraft;
+        uplink::Event* lead = leader || (s / spacecraft) % 2 == 1 ? leads[craft].get() : nullptr;
+        engine.spawn(plan(engine, craft, steps, seed + s, lead, leader, out.records[s]), leader ? 1 : 0);
+    }
+
+    const auto t0 = Clock::now();
+    engine.run_until(days * day);
+    out.seconds = seconds_since(t0);
+    out.stats = engine.stats();
+    out.stalled = engine.stalled();
+    out.error = engine.first_error();
+    return out;
+}
+
+bool same_receipts(const Run& a, const Run& b)
+{
+    for (std::size_t s = 0; s < a.records.size(); ++s) {
+        const auto& ra = a.records[s].receipts;
+        const auto& rb = b.records[s].receipts;
+        if (ra.size() != rb.size())
+            return false;
+        for (std::size_t i = 0; i < ra.size(); ++i)
+            if (ra[i].station != rb[i].station || ra[i].transmit_start != rb[i].transmit_start
+                || ra[i].transmit_end != rb[i].transmit_end || ra[i].onboard != rb[i].onboard)
+                return false;
+    }
+    return true;
+}
+
+void report(const char* label, std::size_t threads, const Run& r)
+{
+    std::printf("%-10s threads=%-3zu wall=%.3f s resumptions=%llu (%.2f M/s) waves=%llu peak_live=%llu "
+                "uplinks=%llu completed=%llu failed=%llu stalled=%zu\n",
+                label, threads, r.seconds, static_cast<unsigned long long>(r.stats.resumptions),
+                double(r.stats.resumptions) / r.seconds * 1e-6, static_cast<unsigned long long>(r.stats.waves),
+                static_cast<unsigned long long>(r.stats.peak_live), static_cast<unsigned long long>(r.stats.uplinks),
+                static_cast<unsigned long long>(r.stats.completed), static_cast<unsigned long long>(r.stats.failed),
+                r.stalled);
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    std::size_t spacecraft = 64;
+    std::size_t sequences = 20000;
+    std::size_t steps = 4;
+    double days = 60.0;
+    double distance_au = 650.0;
+    std::size_t threads = std::max(1u, std::thread::hardware_concurrency());
+    std::uint64_t seed = 1;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        const std::string arg = argv[i];
+        if (arg == "--spacecraft")
+            spacecraft = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (arg == "--sequences")
+            sequences = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (arg == "--steps")
+            steps = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (arg == "--days")
+            days = std::strtod(argv[i + 1], nullptr);
+        else if (arg == "--threads")
+            threads = std::strtoul(argv[i + 1], nullptr, 10);
+        else if (arg == "--distance")
+            distance_au = std::strtod(argv[i + 1], nullptr);
+        else if (arg == "--seed")
+            seed = std::strtoull(argv[i + 1], nullptr, 10);
+    }
+    spacecraft = std::max<std::size_t>(spacecraft, 1);
+    threads = std::max<std::size_t>(threads, 1);
+
+    std::printf("spacecraft=%zu sequences=%zu steps=%zu days=%.0f distance=%.0f AU (one-way %.2f days)\n",
+                spacecraft, sequences, steps, days, distance_au,
+                uplink::constant_light_time(distance_au)(0, 0.0) / day);
+
+    const Run serial = run(spacecraft, sequences, steps, days, distance_au, seed, nullptr);
+    report("inline", 1, serial);
+    sched::Scheduler scheduler(threads);
+    const Run pooled = run(spacecraft, sequences, steps, days, distance_au, seed, &scheduler);
+    report("scheduler", threads, pooled);
+
+    std::vector<double> latency;
+    for (const Record& r : pooled.records)
+        latency.insert(latency.end(), r.latency_days.begin(), r.latency_days.end());
+    std::printf("command latency: median %.2f d, p99 %.2f d, max %.2f d over %zu commands\n",
+                percentile(latency, 0.5), percentile(latency, 0.99), percentile(latency, 1.0), latency.size());
+
+    const bool deterministic = same_receipts(serial, pooled);
+    std::printf("receipts identical across runs: %s\n", deterministic ? "yes" : "NO");
+    if (!serial.error.empty())
+        std::printf("first error: %s\n", serial.error.c_str());
+    const bool clean = serial.stats.failed == 0 && serial.stalled == 0 && serial.stats.completed == sequences;
+    return deterministic && clean ? 0 : 1;
+}
@@ -0,0 +1,219 @@
+#pragma once
+
+/// Chunked columnar archive with per-chunk statistics, read through mmap.
+///
+/// Layout: a 16-byte header { "SLCOLAR\0", u32 version, u32 reserved },
+/// column chunks each starting on an 8-byte boundary, then a footer with
+/// the schema and, for every chunk and column, its file range,
+/// encoding and min/max. The file ends with { u64 footer_offset, "SLCAEND\0" }.
+/// A reader maps the file once, reads the footer, and touches only the
+/// chunks and columns a query needs; statistics let whole chunks be
+/// skipped for range predicates such as a time window.
+///
+/// Each column has an encoding (raw, delta for integers, byte-shuffle for
+/// floats) optionally followed by zstd when the library is built with it.
+/// Raw uncompressed columns are returned as spans into the mapping.
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "solarlens/core/file.hpp"
+#include "solarlens/core/mapped_file.hpp"
+
+namespace solarlens::archive {
+
+enum class ColumnType : std::uint8_t { int64 = 0, uint32 = 1, float32 = 2, float64 = 3 };
+
+std::size_t column_width(ColumnType type) noexcept;
+
+namespace detail {
+
+template <typename T>
+struct ColumnTypeOf; // Undefined for types no column holds.
+
+template <>
+struct ColumnTypeOf<std::int64_t> {
+    static constexpr ColumnType value = ColumnType::int64;
+};
+
+template <>
+struct ColumnTypeOf<std::uint32_t> {
+    static constexpr ColumnType value = ColumnType::uint32;
+};
+
+template <>
+struct ColumnTypeOf<float> {
+    static constexpr ColumnType value = ColumnType::float32;
+};
+
+template <>
+struct ColumnTypeOf<double> {
+    static constexpr ColumnType value = ColumnType::float64;
+};
+
+} // namespace detail
+
+/// The column type whose values are `T`.
+template <typename T>
+inline constexpr ColumnType column_type_of = detail::ColumnTypeOf<T>::value;
+
+enum class Encoding : std::uint8_t {
+    raw = 0,
+    delta = 1,   ///< Integers: zigzag varint of successive differences.
+    shuffle = 2, ///< Floats: byte planes, so zstd sees runs of exponent bytes.
+};
+
+struct ColumnSpec {
+    std::string name;
+    ColumnType type = ColumnType::float32;
+    Encoding encoding = Encoding::raw;
+    int zstd_level = 0; ///< 0 stores the encoded bytes as they are.
+};
+
+/// True if this build can read and write zstd-compressed columns.
+bool zstd_available() noexcept;
+
+/// Min/max of one column chunk, NaNs excluded. Integer columns compare
+/// exactly through the int accessors; every column has the double ones.
+struct ColumnStats {
+    ColumnType type = ColumnType::float64;
+    std::uint64_t min_bits = 0;
+    std::uint64_t max_bits = 0;
+
+    double min() const noexcept;
+    double max() const noexcept;
+    std::int64_t min_int() const noexcept;
+    std::int64_t max_int() const noexcept;
+    /// True for a float chunk holding only NaNs; it matches no range.
+    bool empty() const noexcept;
+
+    static constexpr std::uint64_t empty_bits = ~std::uint64_t(0);
+};
+
+/// Column-major rows for one append: `columns[i]` points at `rows`
+/// values of schema column i's type.
+struct ColumnBatch {
+    std::size_t rows = 0;
+    std::vector<const void*> columns;
+};
+
+namespace detail {
+
+struct ChunkColumn {
+    std::uint64_t offset = 0;
+    std::uint64_t stored = 0;  ///< Bytes in the file.
+    std::uint64_t encoded = 0; ///< Bytes before zstd.
+    ColumnStats stats;
+};
+
+struct Chunk {
+    std::uint64_t first_row = 0;
+    std::uint32_t rows = 0;
+    std::vector<ChunkColumn> columns;
+};
+
+} // namespace detail
+
+class ArchiveWriter {
+public:
+    static constexpr std::size_t default_chunk_rows = 64 * 1024;
+
+    /// Creates (or truncates) `path`. Throws std::invalid_argument for an
+    /// empty schema, duplicate names, an encoding that does not fit the
+    /// type, or zstd in a build without it.
+    ArchiveWriter(const std::filesystem::path& path, std::vector<ColumnSpec> schema,
+                  std::size_t chunk_rows = default_chunk_rows);
+    ~ArchiveWriter();
+
+    ArchiveWriter(const ArchiveWriter&) = delete;
+    ArchiveWriter& operator=(const ArchiveWriter&) = delete;
+
+    void append(const ColumnBatch& batch);
+
+    /// Flushes the open chunk and writes the footer. Required; the
+    /// destructor only closes the file.
+    void close();
+
+    const std::vector<ColumnSpec>& schema() const noexcept { return schema_; }
+    std::uint64_t rows() const noexcept { return rows_; }
+
+private:
+    void flush_chunk();
+
+    core::File file_;
+    std::vector<ColumnSpec> schema_;
+    std::size_t chunk_rows_;
+    std::vector<std::vector<std::byte>> pending_; ///< Raw values per column.
+    std::size_t pending_rows_ = 0;
+    std::vector<detail::Chunk> chunks_;
+    std::vector<std::byte> scratch_;
+    std::uint64_t offset_ = 0;
+    std::uint64_t rows_ = 0;
+    bool closed_ = false;
+};
+
+class ArchiveReader {
+public:
+    /// Maps `path`; throws std::runtime_error if it is not a complete
+    /// archive.
+    explicit ArchiveReader(const std::filesystem::path& path);
+
+    const std::vector<ColumnSpec>& schema() const noexcept { return schema_; }
+    std::uint64_t rows() const noexcept { return rows_; }
+    std::size_t chunk_count() const noexcept { return chunks_.size(); }
+    std::uint32_t chunk_rows(std::size_t chunk) const { return chunks_.at(chunk).rows; }
+    std::uint64_t chunk_first_row(std::size_t chunk) const { return chunks_.at(chunk).first_row; }
+
+    /// Index of column `name`; throws std::out_of_range if absent.
+    std::size_t column(std::string_view name) const;
+
+    const ColumnStats& stats(std::size_t chunk, std::size_t column) const;
+
+    /// Chunks whose [min, max] on integer column `column` intersects
+    /// [lo, hi].
+    std::vector<std::size_t> chunks_overlapping(std::size_t column, std::int64_t lo,
+                                                std::int64_t hi) const;
+    /// Same for any column, compared as doubles.
+    std::vector<std::size_t> chunks_overlapping(std::size_t column, double lo, double hi) const;
+
+    /// Decodes one column chunk into `out`, which must hold
+    /// chunk_rows(chunk) values of the column's width. Raw uncompressed
+    /// chunks are returned directly from the mapping and `out` is left
+    /// untouched; either way the result holds the values.
+    std::span<const std::byte> read(std::size_t chunk, std::size_t column,
+                                    std::span<std::byte> out) const;
+
+    /// Typed convenience over read(); throws std::invalid_argument unless
+    /// `T` is the column's type (std::int64_t, std::uint32_t, float or double).
+    template <typename T>
+    std::span<const T> read(std::size_t chunk, std::size_t column, std::vector<T>& out) const
+    {
+        check_type(column, column_type_of<T>);
+        out.resize(chunk_rows(chunk));
+        const std::span<const std::byte> bytes = read(chunk, column, std::as_writable_bytes(std::span(out)));
+        return {reinterpret_cast<const T*>(bytes.data()), out.size()};
+    }
+
+    /// Bytes a query over `columns` in `chunks` reads from the file.
+    std::uint64_t stored_bytes(std::span<const std::size_t> chunks,
+                               std::span<const std::size_t> columns) const;
+
+    /// Hints that the listed column chunks will be read soon.
+    void prefetch(std::span<const std::size_t> chunks, std::span<const std::size_t> columns) const;
+
+private:
+    void check_type(std::size_t column, ColumnType type) const;
+    [[noreturn]] void corrupt(const std::string& what) const;
+
+    core::MappedFile map_;
+    std::vector<ColumnSpec> schema_;
+    std::vector<detail::Chunk> chunks_;
+    std::uint64_t rows_ = 0;
+};
+
+} // namespace solarlens::archive
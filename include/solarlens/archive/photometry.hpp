@@ -0,0 +1,91 @@
+#pragma once
+
+/// Calibrated ring photometry stored in a columnar archive.
+///
+/// One row per calibrated frame. Timestamps and spacecraft ids are
+/// delta-encoded; float columns are byte-shuffled and, in builds with
+/// zstd, compressed. Readers select chunks by time through the per-chunk
+/// statistics and decode only the columns they use.
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "solarlens/archive/columnar.hpp"
+#include "solarlens/recon/ring_sample.hpp"
+
+namespace solarlens::archive {
+
+struct PhotometryRecord {
+    std::int64_t time_ns = 0;    ///< Frame mid-exposure, ns since J2000 TT.
+    std::uint32_t spacecraft = 0;
+    std::uint32_t flags = 0;     ///< Calibration quality bits; 0 is clean.
+    float u = 0;                 ///< Image-plane position, map pixels.
+    float v = 0;
+    float flux = 0;              ///< Coronagraph-corrected ring flux.
+    float sigma = 0;
+    float background = 0;        ///< Fitted corona level under the ring.
+};
+
+/// Column names, in schema order.
+namespace photometry_column {
+inline constexpr const char* time = "time_ns";
+inline constexpr const char* spacecraft = "spacecraft";
+inline constexpr const char* flags = "flags";
+inline constexpr const char* u = "u";
+inline constexpr const char* v = "v";
+inline constexpr const char* flux = "flux";
+inline constexpr const char* sigma = "sigma";
+inline constexpr const char* background = "background";
+} // namespace photometry_column
+
+/// zstd level used by default: 3 where available, otherwise none.
+int default_zstd_level() noexcept;
+
+std::vector<ColumnSpec> photometry_schema(int zstd_level = default_zstd_level());
+
+/// Row-oriented front end that transposes records into the archive.
+class PhotometryWriter {
+public:
+    PhotometryWriter(const std::filesystem::path& path,
+                     std::size_t chunk_rows = ArchiveWriter::default_chunk_rows,
+                     int zstd_level = default_zstd_level());
+
+    void append(std::span<const PhotometryRecord> records);
+    void append(const PhotometryRecord& record) { append(std::span(&record, 1)); }
+
+    /// Writes the footer; required before the archive can be read.
+    void close() { writer_.close(); }
+
+    std::uint64_t rows() const noexcept { return writer_.rows(); }
+
+private:
+    ArchiveWriter writer_;
+    std::vector<std::int64_t> time_;
+    std::vector<std::uint32_t> spacecraft_, flags_;
+    std::vector<float> u_, v_, flux_, sigma_, background_;
+};
+
+/// Half-open time window [begin_ns, end_ns).
+struct TimeRange {
+    std::int64_t begin_ns = 0;
+    std::int64_t end_ns = 0;
+};
+
+struct ExportStats {
+    std::uint64_t samples = 0;
+    std::uint64_t rejected = 0;       ///< Rows in range dropped by `reject_flags`.
+    std::size_t chunks_read = 0;
+    std::size_t chunks_skipped = 0;
+    std::uint64_t bytes_read = 0;     ///< Stored bytes of the decoded columns.
+};
+
+/// Appends every sample in `range` whose flags do not intersect
+/// `reject_flags` to `out`. Reads only the time, flags, position, flux
+/// and sigma columns of chunks overlapping the window.
+ExportStats export_ring_samples(const ArchiveReader& archive, TimeRange range,
+                                recon::RingSampleWriter& out,
+                                std::uint32_t reject_flags = ~std::uint32_t(0));
+
+} // namespace solarlens::archive
@@ -0,0 +1,162 @@
+#pragma once
+
+/// Content-addressed cache of intermediate pipeline products.
+///
+/// A product is stored under a key that names everything it depends on:
+/// the stage that made it, the stage's version, its parameters and the
+/// keys of its inputs. Raw inputs enter through file_digest(), which hashes
+/// their contents, so the key of every product downstream is a Merkle hash
+/// of the raw data and the whole chain of stage configurations that led
+/// to it. Reprocessing after a calibration change then recomputes exactly
+/// the products whose chain includes the change; every other stage is a
+/// lookup. Keys are built from input keys, never from input bytes, so a
+/// hit costs one hash of a few hundred bytes and a map, however large the
+/// product.
+///
+/// Objects live under the cache root as objects/<2 hex>/<62 hex>, each a
+/// 56-byte header { "SLPROD\0\0", u32 version, u32 reserved,
+/// u64 payload_bytes, key } followed by the payload, which is therefore
+/// 8-byte aligned in a mapping. Stores write a temporary file and rename
+/// it into place, so any number of threads and processes can share a
+/// cache: readers see a whole object or none, and two writers of one key
+/// write the same bytes. A hit refreshes the object's modification time,
+/// which prune() uses to evict least recently used products first.
+///
+/// Bumping a stage's version is how a code change that alters its output
+/// invalidates old products; the cache cannot see code.
+
+#include <atomic>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "solarlens/core/digest.hpp"
+#include "solarlens/core/mapped_file.hpp"
+
+namespace solarlens::archive {
+
+/// Key builder. Every field is tagged and length-prefixed, so no two
+/// sequences of calls hash alike; order matters.
+class ProductKey {
+public:
+    ProductKey(std::string_view stage, std::uint32_t version);
+
+    template <std::integral T>
+    ProductKey& param(std::string_view name, T value)
+    {
+        return integer(name, static_cast<std::int64_t>(value));
+    }
+    /// Hashed by bit pattern: 0.0 and -0.0 are different parameters.
+    ProductKey& param(std::string_view name, double value);
+    ProductKey& param(std::string_view name, std::string_view value);
+    ProductKey& param(std::string_view name, std::span<const std::byte> value);
+
+    /// An input product's key or a raw input's file_digest().
+    ProductKey& input(const core::Digest& key);
+
+    core::Digest digest() const;
+
+private:
+    ProductKey& integer(std::string_view name, std::int64_t value);
+    void field(char tag, std::string_view name, std::span<const std::byte> value);
+
+    core::Sha256 hash_;
+};
+
+/// A cached payload, mapped read-only.
+class Product {
+public:
+    std::span<const std::byte> payload() const noexcept { return map_.bytes().subspan(header_bytes); }
+    const core::Digest& key() const noexcept { return key_; }
+
+    static constexpr std::size_t header_bytes = 56;
+
+private:
+    friend class ProductCache;
+    Product(core::MappedFile map, const core::Digest& key)
+        : map_(std::move(map))
+        , key_(key)
+    {
+    }
+
+    core::MappedFile map_;
+    core::Digest key_;
+};
+
+struct ProductCacheStats {
+    std::uint64_t hits = 0;
+    std::uint64_t misses = 0;
+    std::uint64_t stores = 0;
+    std::uint64_t bytes_read = 0;     ///< Payload bytes of hits.
+    std::uint64_t bytes_written = 0;  ///< Payload bytes stored.
+    std::uint64_t corrupt = 0;        ///< Objects found damaged and removed.
+};
+
+class ProductCache {
+public:
+    /// Opens or creates a cache at `root`.
+    explicit ProductCache(const std::filesystem::path& root);
+
+    ProductCache(const ProductCache&) = delete;
+    ProductCache& operator=(const ProductCache&) = delete;
+
+    /// The product stored under `key`, if any. A damaged object counts as a
+    /// miss and is removed.
+    std::optional<Product> find(const core::Digest& key);
+
+    /// Stores `payload` under `key`, replacing any object there, and
+    /// returns it mapped. Throws std::system_error on I/O failure.
+    Product store(const core::Digest& key, std::span<const std::byte> payload);
+
+    /// find(), or else `produce(std::vector<std::byte>&)` fills a payload
+    /// that is stored. Concurrent callers with one key may both produce.
+    template <typename Produce>
+    Product get_or_compute(const core::Digest& key, Produce&& produce)
+    {
+        if (std::optional<Product> hit = find(key))
+            return std::move(*hit);
+        std::vector<std::byte> payload;
+        produce(payload);
+        return store(key, payload);
+    }
+
+    /// SHA-256 of the file's contents, memoized in the cache under its
+    /// absolute path, size and modification time so an unchanged raw file
+    /// is read once per cache, not once per run.
+    core::Digest file_digest(const std::filesystem::path& path);
+
+    bool contains(const core::Digest& key) const;
+    void erase(const core::Digest& key);
+
+    /// Evicts least recently used objects until the payloads and headers
+    /// total at most `max_bytes`; returns the bytes removed.
+    std::uint64_t prune(std::uint64_t max_bytes);
+
+    /// Header plus payload bytes of every object.
+    std::uint64_t size_bytes() const;
+
+    ProductCacheStats stats() const noexcept;
+    const std::filesystem::path& root() const noexcept { return root_; }
+
+private:
+    std::filesystem::path object_path(const core::Digest& key) const;
+    // Lookup and store without touching the stats, for file_digest() memos.
+    std::optional<Product> open(const core::Digest& key);
+    Product write(const core::Digest& key, std::span<const std::byte> payload);
+
+    std::filesystem::path root_;
+    std::atomic<std::uint64_t> hits_ {0};
+    std::atomic<std::uint64_t> misses_ {0};
+    std::atomic<std::uint64_t> stores_ {0};
+    std::atomic<std::uint64_t> bytes_read_ {0};
+    std::atomic<std::uint64_t> bytes_written_ {0};
+    std::atomic<std::uint64_t> corrupt_ {0};
+};
+
+} // namespace solarlens::archive
@@ -0,0 +1,162 @@
+#pragma once
+
+/// In-memory time-series store for housekeeping telemetry, with rollups
+/// precomputed for operator dashboards.
+///
+/// Each series (one spacecraft's channel) is an append-only run of
+/// Gorilla-compressed blocks: timestamps as delta-of-delta and values as
+/// the XOR with their predecessor, so a steady cadence costs a bit per
+/// timestamp and a slowly moving value a few bits per sample. Alongside,
+/// every append updates min/max/sum buckets at each configured resolution,
+/// so a query over months reads a few hundred buckets rather than
+/// decompressing the months; rollup() picks the finest resolution that
+/// fits the caller's point budget.
+///
+/// Appends must be in time order within a series; older samples are
+/// counted as out of order and dropped, as in Gorilla. Queries may run
+/// concurrently with appends. TimeSeriesRecorder feeds a store straight
+/// from a telemetry bus topic.
+///
+/// Time is in nanoseconds (spacecraft time, since J2000 TDB); ranges are
+/// half-open [t0, t1).
+
+#include <atomic>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <shared_mutex>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "solarlens/bus/bus.hpp"
+
+namespace solarlens::archive {
+
+/// One calibrated housekeeping value, as published on the telemetry bus.
+struct HousekeepingSample {
+    static constexpr std::uint16_t message_type = 0x0100;
+
+    std::int64_t t_ns = 0;
+    double value = 0.0;
+    std::uint16_t spacecraft = 0;
+    std::uint16_t channel = 0;
+    std::uint32_t reserved = 0;
+};
+
+struct SeriesKey {
+    std::uint16_t spacecraft = 0;
+    std::uint16_t channel = 0;
+
+    auto operator<=>(const SeriesKey&) const = default;
+};
+
+struct TimeSeriesConfig {
+    std::uint32_t block_points = 1024;  ///< Samples per compressed block.
+    /// Rollup bucket widths, finest first: five minutes, an hour, a day.
+    std::vector<std::int64_t> rollup_ns = {300'000'000'000, 3'600'000'000'000, 86'400'000'000'000};
+
+    /// Throws std::invalid_argument for unusable values.
+    void validate() const;
+};
+
+struct TimedValue {
+    std::int64_t t_ns = 0;
+    double value = 0.0;
+};
+
+struct RollupPoint {
+    std::int64_t t_ns = 0;  ///< Start of the bucket.
+    double min = 0.0;
+    double max = 0.0;
+    double mean = 0.0;
+    std::uint64_t count = 0;
+};
+
+struct RollupResult {
+    /// Width of each point's bucket; 0 when the points are raw samples.
+    std::int64_t resolution_ns = 0;
+    std::vector<RollupPoint> points;
+};
+
+struct TimeSeriesStats {
+    std::uint64_t appended = 0;
+    std::uint64_t out_of_order = 0;  ///< Dropped.
+    std::size_t series = 0;
+    std::size_t sample_bytes = 0;    ///< Compressed samples.
+    std::size_t rollup_bytes = 0;
+};
+
+class TimeSeriesStore {
+public:
+    /// Throws std::invalid_argument for an unusable config.
+    explicit TimeSeriesStore(const TimeSeriesConfig& config = {});
+    ~TimeSeriesStore();
+
+    TimeSeriesStore(const TimeSeriesStore&) = delete;
+    TimeSeriesStore& operator=(const TimeSeriesStore&) = delete;
+
+    void append(SeriesKey key, std::int64_t t_ns, double value);
+
+    /// Appends a batch under one lock.
+    void append(std::span<const HousekeepingSample> samples);
+
+    /// Every sample of `key` in [t0, t1), decompressed.
+    std::vector<TimedValue> samples(SeriesKey key, std::int64_t t0, std::int64_t t1) const;
+
+    /// At most `max_points` points covering [t0, t1): raw samples if they
+    /// fit, otherwise buckets overlapping the range from the finest
+    /// resolution with no more than 16 per point, merged in equal runs to
+    /// fit the budget (the coarsest resolution if none qualifies). Throws
+    /// std::invalid_argument for a zero budget.
+    RollupResult rollup(SeriesKey key, std::int64_t t0, std::int64_t t1, std::size_t max_points) const;
+
+    /// Every series with at least one sample, in key order.
+    std::vector<SeriesKey> series() const;
+
+    TimeSeriesStats stats() const;
+    const TimeSeriesConfig& config() const noexcept { return config_; }
+
+private:
+    struct Series;
+
+    /// Caller holds mutex_ exclusively.
+    void append_locked(SeriesKey key, std::int64_t t_ns, double value);
+    /// Caller holds mutex_.
+    const Series* find(SeriesKey key) const;
+
+    TimeSeriesConfig config_;
+    mutable std::shared_mutex mutex_;
+    std::unordered_map<std::uint32_t, std::unique_ptr<Series>> series_;
+    std::uint64_t appended_ = 0;
+    std::uint64_t out_of_order_ = 0;
+};
+
+/// Subscribes to a housekeeping topic and appends everything published on
+/// it to a store, from a thread of its own, in batches.
+class TimeSeriesRecorder {
+public:
+    TimeSeriesRecorder(TimeSeriesStore& store, bus::Topic<HousekeepingSample>& topic,
+                       const bus::SubscriberOptions& options = {});
+
+    /// Closes the subscription, appends what it still holds and joins.
+    ~TimeSeriesRecorder();
+
+    TimeSeriesRecorder(const TimeSeriesRecorder&) = delete;
+    TimeSeriesRecorder& operator=(const TimeSeriesRecorder&) = delete;
+
+    std::uint64_t recorded() const noexcept { return recorded_.load(std::memory_order_relaxed); }
+    bus::SubscriptionStats subscription_stats() const noexcept { return subscription_->stats(); }
+
+private:
+    void run();
+
+    TimeSeriesStore& store_;
+    std::shared_ptr<bus::Subscription<HousekeepingSample>> subscription_;
+    std::atomic<std::uint64_t> recorded_ {0};
+    std::thread thread_;
+};
+
+} // namespace solarlens::archive
@@ -0,0 +1,48 @@
+#pragma once
+
+/// Star detection and sub-pixel centroiding on star-tracker frames.
+///
+/// The background level and noise come from the median and MAD of a
+/// strided subsample of the frame, so a handful of bright stars cannot
+/// bias them. Pixels above background + threshold_sigma * noise that are
+/// the maximum of their 3x3 neighbourhood seed a star; its centroid is the
+/// background-subtracted intensity-weighted mean over a square window.
+/// Rows are screened against the threshold before any per-pixel test, so
+/// a sparse field costs little more than one streaming read.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "solarlens/core/image.hpp"
+
+namespace solarlens::attitude {
+
+struct CentroidConfig {
+    double threshold_sigma = 6.0;
+    std::uint32_t window_radius = 2; ///< Centroid window is (2r + 1)^2 pixels.
+    std::size_t max_stars = 40;      ///< Brightest kept.
+    std::size_t background_samples = 8192;
+
+    /// Throws std::invalid_argument for unusable settings.
+    void validate() const;
+};
+
+struct StarCentroid {
+    double x = 0.0; ///< Pixel coordinates, pixel centres on integers.
+    double y = 0.0;
+    double flux = 0.0; ///< Background-subtracted window sum.
+};
+
+struct FrameBackground {
+    double level = 0.0;
+    double noise = 0.0; ///< 1-sigma, from the MAD.
+};
+
+FrameBackground estimate_background(core::ImageView<const float> frame, std::size_t samples);
+
+/// Replaces `out` with the frame's stars, brightest first.
+void find_stars(core::ImageView<const float> frame, const CentroidConfig& config,
+                std::vector<StarCentroid>& out);
+
+} // namespace solarlens::attitude
@@ -0,0 +1,161 @@
+#pragma once
+
+/// Attitude quaternions and the star-tracker camera model.
+///
+/// Conventions follow Shuster's survey: a quaternion q = (x, y, z, w) with
+/// vector part (x, y, z) represents the attitude matrix
+///
+///     A(q) = (w^2 - |v|^2) I + 2 v v^T - 2 w [v x],
+///
+/// which maps inertial (catalogue) directions into the body frame,
+/// b = A r, and compose(a, b) has A(compose(a, b)) = A(a) A(b). The camera
+/// frame is the body frame: +z is the boresight, +x along image columns
+/// and +y along image rows.
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+
+namespace solarlens::attitude {
+
+using Vec3 = std::array<double, 3>;
+using Mat3 = std::array<std::array<double, 3>, 3>;
+
+inline double dot(const Vec3& a, const Vec3& b) noexcept
+{
+    return a[0] * b[0] + a[1] * b[1] + a[2] * b[2];
+}
+
+inline Vec3 cross(const Vec3& a, const Vec3& b) noexcept
+{
+    return {a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0]};
+}
+
+inline Vec3 normalized(const Vec3& a) noexcept
+{
+    const double n = std::sqrt(dot(a, a));
+    return {a[0] / n, a[1] / n, a[2] / n};
+}
+
+/// Angle between two unit vectors, radians; accurate at small angles.
+inline double angle_between(const Vec3& a, const Vec3& b) noexcept
+{
+    const Vec3 c = cross(a, b);
+    return std::atan2(std::sqrt(dot(c, c)), dot(a, b));
+}
+
+/// Unit vector for right ascension and declination in radians.
+inline Vec3 from_radec(double ra, double dec) noexcept
+{
+    return {std::cos(dec) * std::cos(ra), std::cos(dec) * std::sin(ra), std::sin(dec)};
+}
+
+inline Vec3 multiply(const Mat3& m, const Vec3& v) noexcept
+{
+    return {dot(m[0], v), dot(m[1], v), dot(m[2], v)};
+}
+
+inline Vec3 multiply_transposed(const Mat3& m, const Vec3& v) noexcept
+{
+    return {m[0][0] * v[0] + m[1][0] * v[1] + m[2][0] * v[2], m[0][1] * v[0] + m[1][1] * v[1] + m[2][1] * v[2],
+            m[0][2] * v[0] + m[1][2] * v[1] + m[2][2] * v[2]};
+}
+
+struct Quaternion {
+    double x = 0.0;
+    double y = 0.0;
+    double z = 0.0;
+    double w = 1.0;
+
+    Mat3 matrix() const noexcept
+    {
+        const double s = w * w - x * x - y * y - z * z;
+        return {{{s + 2 * x * x, 2 * (x * y + w * z), 2 * (x * z - w * y)},
+                 {2 * (x * y - w * z), s + 2 * y * y, 2 * (y * z + w * x)},
+                 {2 * (x * z + w * y), 2 * (y * z - w * x), s + 2 * z * z}}};
+    }
+
+    /// Inertial direction into the body frame, A r.
+    Vec3 to_body(const Vec3& r) const noexcept { return multiply(matrix(), r); }
+
+    /// Body direction into the inertial frame, A^T b.
+    Vec3 to_inertial(const Vec3& b) const noexcept { return multiply_transposed(matrix(), b); }
+
+    Quaternion conjugate() const noexcept { return {-x, -y, -z, w}; }
+
+    /// Shepperd's method: picks the best-conditioned of four branches.
+    static Quaternion from_matrix(const Mat3& a) noexcept
+    {
+        const double tr = a[0][0] + a[1][1] + a[2][2];
+        Quaternion q;
+        if (tr >= a[0][0] && tr >= a[1][1] && tr >= a[2][2]) {
+            const double s = 2.0 * std::sqrt(1.0 + tr);
+            q = {(a[1][2] - a[2][1]) / s, (a[2][0] - a[0][2]) / s, (a[0][1] - a[1][0]) / s, 0.25 * s};
+        } else if (a[0][0] >= a[1][1] && a[0][0] >= a[2][2]) {
+            const double s = 2.0 * std::sqrt(1.0 + 2 * a[0][0] - tr);
+            q = {0.25 * s, (a[0][1] + a[1][0]) / s, (a[0][2] + a[2][0]) / s, (a[1][2] - a[2][1]) / s};
+        } else if (a[1][1] >= a[2][2]) {
+            const double s = 2.0 * std::sqrt(1.0 + 2 * a[1][1] - tr);
+            q = {(a[0][1] + a[1][0]) / s, 0.25 * s, (a[1][2] + a[2][1]) / s, (a[2][0] - a[0][2]) / s};
+        } else {
+            const double s = 2.0 * std::sqrt(1.0 + 2 * a[2][2] - tr);
+            q = {(a[0][2] + a[2][0]) / s, (a[1][2] + a[2][1]) / s, 0.25 * s, (a[0][1] - a[1][0]) / s};
+        }
+        return q.w < 0 ? Quaternion {-q.x, -q.y, -q.z, -q.w} : q;
+    }
+
+    /// Rotation of `angle` radians about unit `axis`, as an attitude.
+    static Quaternion from_axis_angle(const Vec3& axis, double angle) noexcept
+    {
+        const double s = std::sin(0.5 * angle);
+        return {axis[0] * s, axis[1] * s, axis[2] * s, std::cos(0.5 * angle)};
+    }
+};
+
+/// A(compose(a, b)) = A(a) A(b).
+inline Quaternion compose(const Quaternion& a, const Quaternion& b) noexcept
+{
+    return {a.w * b.x + b.w * a.x - (a.y * b.z - a.z * b.y), a.w * b.y + b.w * a.y - (a.z * b.x - a.x * b.z),
+            a.w * b.z + b.w * a.z - (a.x * b.y - a.y * b.x), a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z};
+}
+
+/// Rotation angle taking attitude `a` to attitude `b`, radians.
+inline double attitude_error(const Quaternion& a, const Quaternion& b) noexcept
+{
+    const double d = std::abs(a.x * b.x + a.y * b.y + a.z * b.z + a.w * b.w);
+    const Quaternion e = compose(b, a.conjugate());
+    const double v = std::sqrt(e.x * e.x + e.y * e.y + e.z * e.z);
+    return 2.0 * std::atan2(v, d);
+}
+
+/// Pinhole camera in pixel units, distortion already removed.
+struct CameraModel {
+    std::uint32_t width = 1024;
+    std::uint32_t height = 1024;
+    double focal_px = 4870.0; ///< About a 12 degree field on 1024 pixels.
+    double centre_x = 511.5;
+    double centre_y = 511.5;
+
+    /// Body-frame unit vector through pixel (px, py).
+    Vec3 unproject(double px, double py) const noexcept
+    {
+        return normalized({(px - centre_x) / focal_px, (py - centre_y) / focal_px, 1.0});
+    }
+
+    /// Pixel where body direction `b` lands; `b[2]` must be positive.
+    std::array<double, 2> project(const Vec3& b) const noexcept
+    {
+        return {centre_x + focal_px * b[0] / b[2], centre_y + focal_px * b[1] / b[2]};
+    }
+
+    /// Half-angle of the cone that contains the whole detector, radians.
+    double field_radius() const noexcept
+    {
+        const double hx = std::max(centre_x + 0.5, double(width) - centre_x - 0.5);
+        const double hy = std::max(centre_y + 0.5, double(height) - centre_y - 0.5);
+        return std::atan(std::sqrt(hx * hx + hy * hy) / focal_px);
+    }
+};
+
+} // namespace solarlens::attitude
@@ -0,0 +1,54 @@
+#pragma once
+
+/// Wahba-problem attitude solves with Shuster's QUEST.
+///
+/// Observations enter only through the attitude profile matrix
+/// B = sum w_i b_i r_i^T. The optimal attitude's loss is sum w_i - lambda,
+/// with lambda the largest root of K(B)'s characteristic quartic, found by
+/// Newton's method from lambda = sum w_i. Rotations near 180 degrees,
+/// where the Gibbs vector blows up, are re-solved in a reference frame
+/// turned 180 degrees about whichever axis gives the best-conditioned
+/// quaternion (the method of sequential rotations).
+///
+/// quest_batch() solves many frames at once: profiles are transposed into
+/// per-coefficient lanes and every step of the solve runs across lanes
+/// with a fixed number of Newton iterations, so the whole batch is
+/// straight-line loops the compiler vectorises. Lanes that need a
+/// sequential rotation drop to the scalar path.
+
+#include <cstddef>
+#include <span>
+
+#include "solarlens/attitude/quaternion.hpp"
+
+namespace solarlens::attitude {
+
+struct AttitudeProfile {
+    Mat3 b {};
+    double weight = 0.0; ///< Sum of observation weights.
+    std::size_t count = 0;
+
+    void add(const Vec3& body, const Vec3& reference, double w = 1.0) noexcept
+    {
+        for (int i = 0; i < 3; ++i)
+            for (int j = 0; j < 3; ++j)
+                b[i][j] += w * body[i] * reference[j];
+        weight += w;
+        ++count;
+    }
+};
+
+struct AttitudeFit {
+    Quaternion q;
+    double loss = 0.0; ///< Wahba loss, sum w_i |b_i - A r_i|^2 / 2.
+    bool valid = false; ///< False below two observations.
+};
+
+inline constexpr int quest_newton_steps = 6;
+
+AttitudeFit quest(const AttitudeProfile& profile);
+
+/// quest() on every profile; `out` must be as long as `profiles`.
+void quest_batch(std::span<const AttitudeProfile> profiles, std::span<AttitudeFit> out);
+
+} // namespace solarlens::attitude
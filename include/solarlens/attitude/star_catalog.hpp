@@ -0,0 +1,84 @@
+#pragma once
+
+/// Star catalogue indexed for star identification.
+///
+/// Two indexes are built once per catalogue:
+///
+/// - a 3-d k-d tree over the stars' unit vectors, for nearest-star and
+///   cone queries: recursive identification and the pyramid check match a
+///   predicted direction to a star in O(log n);
+/// - every pair of stars closer than `max_pair_angle` (the camera's field
+///   diameter), sorted by separation, so the candidate catalogue pairs for
+///   a measured inter-star angle are one binary search away.
+///
+/// Text catalogues hold one star per line, "id ra_deg dec_deg magnitude",
+/// with '#' starting a comment.
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "solarlens/attitude/quaternion.hpp"
+
+namespace solarlens::attitude {
+
+struct CatalogStar {
+    std::uint32_t id = 0;
+    Vec3 direction {}; ///< Unit vector, inertial frame.
+    float magnitude = 0.0f;
+};
+
+struct StarPair {
+    float angle;      ///< Separation, radians.
+    std::uint32_t a;  ///< Catalogue indexes, a < b.
+    std::uint32_t b;
+};
+
+class StarCatalog {
+public:
+    /// Throws std::invalid_argument if `max_pair_angle` is not in (0, pi).
+    StarCatalog(std::vector<CatalogStar> stars, double max_pair_angle);
+
+    std::size_t size() const noexcept { return stars_.size(); }
+    const CatalogStar& star(std::size_t i) const { return stars_.at(i); }
+    const std::vector<CatalogStar>& stars() const noexcept { return stars_; }
+    double max_pair_angle() const noexcept { return max_pair_angle_; }
+
+    /// Index of the star nearest `direction` within `max_angle` radians,
+    /// or -1.
+    long nearest(const Vec3& direction, double max_angle) const noexcept;
+
+    /// Appends the indexes of every star within `radius` radians.
+    void within(const Vec3& direction, double radius, std::vector<std::uint32_t>& out) const;
+
+    /// Pairs whose separation lies in [lo, hi], radians.
+    std::span<const StarPair> pairs_between(double lo, double hi) const noexcept;
+    std::size_t pair_count() const noexcept { return pairs_.size(); }
+
+    std::size_t memory_bytes() const noexcept;
+
+private:
+    struct Node {
+        Vec3 point;
+        std::uint32_t star;
+        std::uint8_t axis;
+    };
+
+    void build(std::size_t lo, std::size_t hi, std::vector<std::uint32_t>& order);
+    void search(std::size_t lo, std::size_t hi, const Vec3& p, double& best, long& found) const noexcept;
+    void collect(std::size_t lo, std::size_t hi, const Vec3& p, double limit,
+                 std::vector<std::uint32_t>& out) const;
+
+    std::vector<CatalogStar> stars_;
+    double max_pair_angle_;
+    std::vector<Node> tree_; // Implicit: the node of [lo, hi) sits at (lo + hi) / 2.
+    std::vector<StarPair> pairs_;
+};
+
+/// Reads a text catalogue, keeping stars no fainter than `faintest`;
+/// throws std::runtime_error on an unreadable file or malformed line.
+std::vector<CatalogStar> read_star_catalog(const std::filesystem::path& path, float faintest = 99.0f);
+
+} // namespace solarlens::attitude
@@ -0,0 +1,128 @@
+#pragma once
+
+/// Attitude determination for every star-camera frame of the swarm.
+///
+/// Each frame is centroided, its stars identified against the catalogue,
+/// and its attitude solved with QUEST. Identification has two modes:
+///
+/// - tracking: given a prior attitude, every centroid's predicted
+///   direction is matched to its nearest catalogue star (k-d tree) within
+///   `tracking_radius_arcsec`, which must cover the attitude change since
+///   the prior;
+/// - lost in space: Mortari's pyramid over the brightest centroids. The
+///   three separations of a triangle are looked up in the pair index,
+///   candidate star triples must agree in chirality, and a fourth star
+///   must land on a catalogue star before the triangle is accepted.
+///
+/// Either way the solve is refined by re-matching every centroid against
+/// the solved attitude within `match_tolerance_arcsec`, which drops
+/// misidentified stars and picks up missed ones, and re-solving until the
+/// match set is stable.
+///
+/// solve_batch() is the ground pipeline. It centroids every frame in
+/// parallel, runs lost in space only for spacecraft with no prior (one
+/// frame each), identifies every other frame in parallel by tracking
+/// from its spacecraft's prior, and solves the whole batch with one
+/// quest_batch(). Each spacecraft's last solved attitude becomes its prior
+/// for the next batch.
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "solarlens/attitude/centroid.hpp"
+#include "solarlens/attitude/quaternion.hpp"
+#include "solarlens/attitude/quest.hpp"
+#include "solarlens/attitude/star_catalog.hpp"
+#include "solarlens/core/image.hpp"
+
+namespace solarlens::sched {
+class Scheduler;
+}
+
+namespace solarlens::attitude {
+
+struct StarTrackerConfig {
+    CameraModel camera;
+    CentroidConfig centroid;
+    double match_tolerance_arcsec = 20.0;
+    double tracking_radius_arcsec = 300.0;
+    std::size_t pyramid_stars = 8; ///< Brightest centroids tried in lost in space.
+    std::size_t min_matches = 4;   ///< Identified stars needed for a solution.
+
+    /// Throws std::invalid_argument for unusable settings.
+    void validate() const;
+};
+
+enum class IdentificationMode : std::uint8_t { failed, tracking, lost_in_space };
+
+const char* to_string(IdentificationMode mode) noexcept;
+
+struct AttitudeSolution {
+    Quaternion q; ///< Inertial to camera frame.
+    IdentificationMode mode = IdentificationMode::failed;
+    std::uint32_t stars_detected = 0;
+    std::uint32_t stars_matched = 0;
+    double residual_arcsec = 0.0; ///< RMS angle between matched stars and the catalogue.
+
+    bool valid() const noexcept { return mode != IdentificationMode::failed; }
+
+    /// Inertial direction of the camera boresight.
+    Vec3 boresight() const noexcept { return q.to_inertial({0.0, 0.0, 1.0}); }
+};
+
+struct StarFrame {
+    std::uint32_t spacecraft = 0;
+    core::ImageView<const float> image;
+};
+
+class StarTracker {
+public:
+    /// The catalogue must outlive the tracker, and its pair index must
+    /// span the camera's field diameter.
+    StarTracker(const StarCatalog& catalog, const StarTrackerConfig& config);
+
+    /// One frame: tracking from `prior` if given, falling back to lost in
+    /// space. Does not touch the per-spacecraft priors; safe to call
+    /// concurrently.
+    AttitudeSolution solve(core::ImageView<const float> frame, const Quaternion* prior = nullptr) const;
+
+    /// solve() on centroids found elsewhere, brightest first.
+    AttitudeSolution identify(std::span<const StarCentroid> stars, const Quaternion* prior = nullptr) const;
+
+    /// Solves `frames` (each spacecraft's frames in time order) into
+    /// `out`, which must be as long, and updates the priors.
+    void solve_batch(std::span<const StarFrame> frames, std::span<AttitudeSolution> out,
+                     sched::Scheduler& scheduler);
+
+    std::optional<Quaternion> prior(std::uint32_t spacecraft) const;
+    void set_prior(std::uint32_t spacecraft, const Quaternion& q) { priors_[spacecraft] = q; }
+    void clear_priors() noexcept { priors_.clear(); }
+
+    const StarTrackerConfig& config() const noexcept { return config_; }
+    const StarCatalog& catalog() const noexcept { return catalog_; }
+
+private:
+    // Catalogue index per body vector, -1 where unmatched.
+    using Matches = std::vector<long>;
+
+    void body_vectors(std::span<const StarCentroid> stars, std::vector<Vec3>& body) const;
+    bool track(std::span<const Vec3> body, const Quaternion& prior, Matches& matches) const;
+    bool lost_in_space(std::span<const Vec3> body, Matches& matches) const;
+    AttitudeProfile profile(std::span<const Vec3> body, const Matches& matches) const;
+
+    /// Re-matches against `fit` and re-solves until the match set holds.
+    AttitudeSolution refine(std::span<const Vec3> body, Matches& matches, AttitudeFit fit,
+                            IdentificationMode mode) const;
+
+    const StarCatalog& catalog_;
+    StarTrackerConfig config_;
+    double tolerance_;       // Radians.
+    double tracking_radius_; // Radians.
+    std::unordered_map<std::uint32_t, Quaternion> priors_;
+};
+
+} // namespace solarlens::attitude
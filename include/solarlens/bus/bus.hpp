@@ -0,0 +1,332 @@
+#pragma once
+
+/// In-process publish/subscribe bus between mission-control subsystems.
+///
+/// A TelemetryBus holds named topics, each typed by one BusMessage. Every
+/// subscription owns a bounded ring: SPSC on single-publisher topics, MPMC
+/// otherwise, and publishing copies the envelope into each subscriber's
+/// ring, so many publishers and dozens of subscribers share no lock and a
+/// slow subscriber only fills its own ring. What happens then is the
+/// subscription's back-pressure policy.
+///
+/// Subscribing takes a mutex; publishing and receiving never do. A topic
+/// keeps every subscription it created alive until the bus is destroyed,
+/// so a publisher racing close() never touches freed memory.
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "solarlens/bus/message.hpp"
+#include "solarlens/bus/mpmc_queue.hpp"
+#include "solarlens/bus/spsc_queue.hpp"
+
+namespace solarlens::bus {
+
+enum class Publishers {
+    single,   ///< One publishing thread; subscriber rings are SPSC.
+    multiple,
+};
+
+enum class Backpressure {
+    drop_newest, ///< A full ring rejects the new message.
+    drop_oldest, ///< A full ring discards its oldest message to make room.
+    block,       ///< The publisher spins, then yields, until there is room or the timeout.
+};
+
+struct SubscriberOptions {
+    std::size_t capacity = 1024;
+    Backpressure policy = Backpressure::drop_newest;
+    std::chrono::microseconds block_timeout {1000}; ///< For Backpressure::block.
+};
+
+struct SubscriptionStats {
+    std::uint64_t delivered = 0;
+    std::uint64_t dropped = 0;     ///< Rejected (drop_newest, or block timed out).
+    std::uint64_t overwritten = 0; ///< Discarded by drop_oldest.
+};
+
+inline constexpr std::size_t max_subscribers = 64;
+
+std::int64_t bus_clock_ns() noexcept;
+
+template <BusMessage T>
+class Topic;
+
+template <BusMessage T>
+class Subscription {
+public:
+    Subscription(Publishers publishers, const SubscriberOptions& options)
+        : options_(options)
+    {
+        if (options.capacity == 0)
+            throw std::invalid_argument("bus: subscription capacity must be positive");
+        // drop_oldest pops from the producer side, which SPSC cannot do.
+        if (publishers == Publishers::single && options.policy != Backpressure::drop_oldest)
+            spsc_ = std::make_unique<SpscQueue<Envelope<T>>>(options.capacity);
+        else
+            mpmc_ = std::make_unique<MpmcQueue<Envelope<T>>>(options.capacity);
+    }
+
+    Subscription(const Subscription&) = delete;
+    Subscription& operator=(const Subscription&) = delete;
+
+    bool try_receive(Envelope<T>& out) noexcept
+    {
+        return spsc_ ? spsc_->try_pop(out) : mpmc_->try_pop(out);
+    }
+
+    /// Drains up to `out.size()` envelopes; returns the count.
+    std::size_t receive(std::span<Envelope<T>> out) noexcept
+    {
+        if (spsc_)
+            return spsc_->pop_batch(out);
+        std::size_t n = 0;
+        while (n < out.size() && mpmc_->try_pop(out[n]))
+            ++n;
+        return n;
+    }
+
+    /// Blocks until a message arrives (true) or the subscription is
+    /// closed and drained (false). Spins briefly before parking.
+    bool wait_receive(Envelope<T>& out)
+    {
+        for (int i = 0; i < spin_rounds; ++i) {
+            if (try_receive(out))
+                return true;
+            if (closed())
+                return try_receive(out);
+        }
+        for (;;) {
+            const std::uint32_t epoch = signal_.load(std::memory_order_seq_cst);
+            waiting_.store(true, std::memory_order_seq_cst);
+            const bool got = try_receive(out);
+            if (got || closed()) {
+                waiting_.store(false, std::memory_order_relaxed);
+                return got || try_receive(out);
+            }
+            signal_.wait(epoch, std::memory_order_seq_cst);
+            waiting_.store(false, std::memory_order_relaxed);
+        }
+    }
+
+    /// Stops delivery and wakes a blocked wait_receive(). Messages already
+    /// queued can still be received.
+    void close() noexcept
+    {
+        closed_.store(true, std::memory_order_seq_cst);
+        wake();
+    }
+
+    bool closed() const noexcept { return closed_.load(std::memory_order_acquire); }
+
+    SubscriptionStats stats() const noexcept
+    {
+        return {delivered_.load(std::memory_order_relaxed), dropped_.load(std::memory_order_relaxed),
+                overwritten_.load(std::memory_order_relaxed)};
+    }
+
+    std::size_t backlog() const noexcept
+    {
+        return spsc_ ? spsc_->size_approx() : mpmc_->size_approx();
+    }
+
+    const SubscriberOptions& options() const noexcept { return options_; }
+
+private:
+    friend class Topic<T>;
+    static constexpr int spin_rounds = 256;
+
+    /// Publisher side: applies the back-pressure policy.
+    bool deliver(const Envelope<T>& e) noexcept
+    {
+        bool ok = push(e);
+        if (!ok) {
+            switch (options_.policy) {
+            case Backpressure::drop_newest:
+                break;
+            case Backpressure::drop_oldest: {
+                Envelope<T> discard {};
+                while (!ok) {
+                    if (mpmc_->try_pop(discard))
+                        overwritten_.fetch_add(1, std::memory_order_relaxed);
+                    ok = push(e);
+                }
+                break;
+            }
+            case Backpressure::block: {
+                const auto deadline = std::chrono::steady_clock::now() + options_.block_timeout;
+                for (int spin = 0; !ok && !closed(); ++spin) {
+                    if (spin >= spin_rounds) {
+                        if (std::chrono::steady_clock::now() >= deadline)
+                            break;
+                        std::this_thread::yield();
+                    }
+                    ok = push(e);
+                }
+                break;
+            }
+            }
+        }
+        if (!ok) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        delivered_.fetch_add(1, std::memory_order_relaxed);
+        // Orders the ring's release store before the flag load; pairs with
+        // the seq_cst store of waiting_ in wait_receive().
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (waiting_.load(std::memory_order_relaxed))
+            wake();
+        return true;
+    }
+
+    bool push(const Envelope<T>& e) noexcept
+    {
+        return spsc_ ? spsc_->try_push(e) : mpmc_->try_push(e);
+    }
+
+    void wake() noexcept
+    {
+        signal_.fetch_add(1, std::memory_order_seq_cst);
+        signal_.notify_all();
+    }
+
+    SubscriberOptions options_;
+    std::unique_ptr<SpscQueue<Envelope<T>>> spsc_;
+    std::unique_ptr<MpmcQueue<Envelope<T>>> mpmc_;
+    alignas(64) std::atomic<std::uint64_t> delivered_ {0};
+    std::atomic<std::uint64_t> dropped_ {0};
+    std::atomic<std::uint64_t> overwritten_ {0};
+    alignas(64) std::atomic<std::uint32_t> signal_ {0};
+    std::atomic<bool> waiting_ {false};
+    std::atomic<bool> closed_ {false};
+};
+
+namespace detail {
+
+class TopicBase {
+public:
+    TopicBase(std::string name, std::uint32_t id, std::uint16_t type, Publishers publishers)
+        : name_(std::move(name))
+        , id_(id)
+        , type_(type)
+        , publishers_(publishers)
+    {
+    }
+    virtual ~TopicBase() = default;
+
+    const std::string& name() const noexcept { return name_; }
+    std::uint32_t id() const noexcept { return id_; }
+    std::uint16_t type() const noexcept { return type_; }
+    Publishers publishers() const noexcept { return publishers_; }
+
+private:
+    std::string name_;
+    std::uint32_t id_;
+    std::uint16_t type_;
+    Publishers publishers_;
+};
+
+} // namespace detail
+
+template <BusMessage T>
+class Topic final : public detail::TopicBase {
+public:
+    using TopicBase::TopicBase;
+
+    /// Throws std::length_error past max_subscribers live subscriptions.
+    std::shared_ptr<Subscription<T>> subscribe(const SubscriberOptions& options = {})
+    {
+        auto sub = std::make_shared<Subscription<T>>(publishers(), options);
+        const std::lock_guard lock(mutex_);
+        const std::size_t count = count_.load(std::memory_order_relaxed);
+        std::size_t slot = count;
+        for (std::size_t i = 0; i < count; ++i) {
+            Subscription<T>* s = slots_[i].load(std::memory_order_relaxed);
+            if (s == nullptr || s->closed()) {
+                slot = i;
+                break;
+            }
+        }
+        if (slot == max_subscribers)
+            throw std::length_error("bus: too many subscribers on " + name());
+        owned_.push_back(sub);
+        slots_[slot].store(sub.get(), std::memory_order_release);
+        if (slot == count)
+            count_.store(count + 1, std::memory_order_release);
+        return sub;
+    }
+
+    /// Copies `body` to every open subscription; returns how many accepted it.
+    std::size_t publish(const T& body) noexcept
+    {
+        Envelope<T> e {};
+        e.header.sequence = sequence_.fetch_add(1, std::memory_order_relaxed);
+        e.header.publish_ns = bus_clock_ns();
+        e.header.type = type();
+        e.header.topic = id();
+        e.body = body;
+        std::size_t accepted = 0;
+        const std::size_t count = count_.load(std::memory_order_acquire);
+        for (std::size_t i = 0; i < count; ++i) {
+            Subscription<T>* s = slots_[i].load(std::memory_order_acquire);
+            if (s != nullptr && !s->closed() && s->deliver(e))
+                ++accepted;
+        }
+        return accepted;
+    }
+
+    std::uint64_t published() const noexcept { return sequence_.load(std::memory_order_relaxed); }
+
+private:
+    alignas(64) std::atomic<std::uint64_t> sequence_ {0};
+    std::atomic<std::size_t> count_ {0};
+    std::array<std::atomic<Subscription<T>*>, max_subscribers> slots_ {};
+    std::mutex mutex_;
+    std::vector<std::shared_ptr<Subscription<T>>> owned_;
+};
+
+class TelemetryBus {
+public:
+    TelemetryBus() = default;
+    TelemetryBus(const TelemetryBus&) = delete;
+    TelemetryBus& operator=(const TelemetryBus&) = delete;
+
+    /// The topic called `name`, created on first use. Throws
+    /// std::invalid_argument if it exists with another message type or
+    /// publisher mode.
+    template <BusMessage T>
+    Topic<T>& topic(std::string_view name, Publishers publishers = Publishers::multiple)
+    {
+        const std::lock_guard lock(mutex_);
+        if (detail::TopicBase* t = find(name, T::message_type, publishers))
+            return static_cast<Topic<T>&>(*t);
+        auto t = std::make_unique<Topic<T>>(std::string(name), static_cast<std::uint32_t>(topics_.size()),
+                                            T::message_type, publishers);
+        Topic<T>& ref = *t;
+        topics_.push_back(std::move(t));
+        return ref;
+    }
+
+    std::size_t topic_count() const;
+
+private:
+    /// Caller holds mutex_.
+    detail::TopicBase* find(std::string_view name, std::uint16_t type, Publishers publishers) const;
+
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<detail::TopicBase>> topics_;
+};
+
+} // namespace solarlens::bus
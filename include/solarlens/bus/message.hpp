@@ -0,0 +1,37 @@
+#pragma once
+
+/// Fixed-layout bus messages.
+///
+/// A message type is any trivially copyable standard-layout struct with a
+/// `static constexpr std::uint16_t message_type` id unique on the bus.
+/// Subscribers receive it inside an Envelope that adds the topic's
+/// sequence number and the publish time, so gaps and latency are visible
+/// without any per-message allocation.
+
+#include <concepts>
+#include <cstdint>
+#include <type_traits>
+
+namespace solarlens::bus {
+
+template <typename T>
+concept BusMessage = std::is_trivially_copyable_v<T> && std::is_standard_layout_v<T>
+    && requires {
+           { T::message_type } -> std::convertible_to<std::uint16_t>;
+       };
+
+struct MessageHeader {
+    std::uint64_t sequence = 0;   ///< Per topic, from 0, counting dropped messages.
+    std::int64_t publish_ns = 0;  ///< steady_clock at publish.
+    std::uint16_t type = 0;
+    std::uint16_t reserved = 0;
+    std::uint32_t topic = 0;      ///< Topic id on its bus.
+};
+
+template <BusMessage T>
+struct Envelope {
+    MessageHeader header;
+    T body;
+};
+
+} // namespace solarlens::bus
@@ -0,0 +1,104 @@
+#pragma once
+
+/// Bounded multi-producer multi-consumer queue (Vyukov).
+///
+/// Every cell carries a sequence number that says whose turn it is, so
+/// producers and consumers claim positions with one CAS each and never
+/// wait on one another except when the queue is full or empty.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+
+namespace solarlens::bus {
+
+template <typename T>
+class MpmcQueue {
+    static_assert(std::is_trivially_copyable_v<T>, "values are copied through the ring");
+
+public:
+    /// `capacity` is rounded up to a power of two (at least two).
+    explicit MpmcQueue(std::size_t capacity)
+    {
+        std::size_t c = 2;
+        while (c < capacity)
+            c <<= 1;
+        mask_ = c - 1;
+        cells_ = std::make_unique<Cell[]>(c);
+        for (std::size_t i = 0; i < c; ++i)
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    std::size_t capacity() const noexcept { return mask_ + 1; }
+
+    /// Any thread. False if full.
+    bool try_push(const T& value) noexcept
+    {
+        std::uint64_t pos = enqueue_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            const std::uint64_t seq = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::int64_t>(seq - pos);
+            if (diff == 0) {
+                if (enqueue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    cell.value = value;
+                    cell.sequence.store(pos + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = enqueue_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Any thread. False if empty.
+    bool try_pop(T& out) noexcept
+    {
+        std::uint64_t pos = dequeue_.load(std::memory_order_relaxed);
+        for (;;) {
+            Cell& cell = cells_[pos & mask_];
+            const std::uint64_t seq = cell.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::int64_t>(seq - (pos + 1));
+            if (diff == 0) {
+                if (dequeue_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    out = cell.value;
+                    cell.sequence.store(pos + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = dequeue_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    /// Racy snapshot, for metrics.
+    std::size_t size_approx() const noexcept
+    {
+        const std::uint64_t e = enqueue_.load(std::memory_order_relaxed);
+        const std::uint64_t d = dequeue_.load(std::memory_order_relaxed);
+        return e > d ? std::min<std::size_t>(e - d, capacity()) : 0;
+    }
+
+private:
+    struct Cell {
+        std::atomic<std::uint64_t> sequence {0};
+        T value {};
+    };
+
+    alignas(64) std::atomic<std::uint64_t> enqueue_ {0};
+    alignas(64) std::atomic<std::uint64_t> dequeue_ {0};
+    alignas(64) std::size_t mask_ = 0;
+    std::unique_ptr<Cell[]> cells_;
+};
+
+} // namespace solarlens::bus
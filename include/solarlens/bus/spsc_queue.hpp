@@ -0,0 +1,96 @@
+#pragma once
+
+/// Bounded single-producer single-consumer ring of trivially copyable
+/// values.
+///
+/// Head and tail live on separate cache lines and each side keeps a
+/// private copy of the other's index, so in steady state a push or pop
+/// touches shared state only when the cached view says the ring is full
+/// or empty.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <type_traits>
+
+namespace solarlens::bus {
+
+template <typename T>
+class SpscQueue {
+    static_assert(std::is_trivially_copyable_v<T>, "values are copied through the ring");
+
+public:
+    /// `capacity` is rounded up to a power of two.
+    explicit SpscQueue(std::size_t capacity)
+    {
+        std::size_t c = 1;
+        while (c < capacity)
+            c <<= 1;
+        mask_ = c - 1;
+        slots_ = std::make_unique<T[]>(c);
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    std::size_t capacity() const noexcept { return mask_ + 1; }
+
+    /// Producer only. False if full.
+    bool try_push(const T& value) noexcept
+    {
+        const std::uint64_t head = head_.load(std::memory_order_relaxed);
+        if (head - cached_tail_ > mask_) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+            if (head - cached_tail_ > mask_)
+                return false;
+        }
+        slots_[head & mask_] = value;
+        head_.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer only. False if empty.
+    bool try_pop(T& out) noexcept
+    {
+        const std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+        if (tail == cached_head_) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+            if (tail == cached_head_)
+                return false;
+        }
+        out = slots_[tail & mask_];
+        tail_.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// Consumer only. Pops up to `out.size()` values with one index update.
+    std::size_t pop_batch(std::span<T> out) noexcept
+    {
+        const std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+        cached_head_ = head_.load(std::memory_order_acquire);
+        const std::size_t n = std::min<std::size_t>(out.size(), cached_head_ - tail);
+        for (std::size_t i = 0; i < n; ++i)
+            out[i] = slots_[(tail + i) & mask_];
+        tail_.store(tail + n, std::memory_order_release);
+        return n;
+    }
+
+    /// Racy snapshot, for metrics.
+    std::size_t size_approx() const noexcept
+    {
+        return head_.load(std::memory_order_relaxed) - tail_.load(std::memory_order_relaxed);
+    }
+
+private:
+    alignas(64) std::atomic<std::uint64_t> head_ {0};
+    std::uint64_t cached_tail_ = 0; // Producer-only.
+    alignas(64) std::atomic<std::uint64_t> tail_ {0};
+    std::uint64_t cached_head_ = 0; // Consumer-only.
+    alignas(64) std::size_t mask_ = 0;
+    std::unique_ptr<T[]> slots_;
+};
+
+} // namespace solarlens::bus
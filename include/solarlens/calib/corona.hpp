@@ -0,0 +1,111 @@
+#pragma once
+
+/// Radial corona model fit and subtraction for coronagraph frames.
+///
+/// The K-corona and F-corona fall off steeply and smoothly with elongation,
+/// so the model is a quartic in u = (fit_inner / r)^2 about the frame's Sun
+/// centre. u is mapped affinely onto t in [-1, 1] across the fit annulus,
+/// which keeps the 5x5 normal equations well conditioned enough for float
+/// accumulation:
+///
+///     I(r) = c0 + c1 t + c2 t^2 + c3 t^3 + c4 t^4,   t = t_num / r^2 + t_offset.
+///
+/// The constant term absorbs zodiacal light and detector offset. Fitting
+/// uses the annulus [fit_inner, fit_outer] minus the Einstein-ring annulus
+/// [ring_inner, ring_outer]; subtraction touches the whole frame and zeroes
+/// pixels inside the occulter. Working in u avoids a square root per pixel,
+/// and both passes run one row at a time through per-ISA kernels chosen at
+/// construction.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+#include "solarlens/core/arena.hpp"
+#include "solarlens/core/image.hpp"
+#include "solarlens/core/simd.hpp"
+
+namespace solarlens::sched {
+class Scheduler;
+}
+
+namespace solarlens::calib {
+
+struct CoronaGeometry {
+    float centre_x = 0.0f; ///< Sun centre, pixel coordinates.
+    float centre_y = 0.0f;
+    float occulter = 0.0f; ///< Pixels closer than this are zeroed.
+    float fit_inner = 0.0f;
+    float fit_outer = 0.0f;
+    float ring_inner = 0.0f; ///< Excluded from the fit.
+    float ring_outer = 0.0f;
+};
+
+inline constexpr int corona_terms = 5;
+
+struct CoronaModel {
+    std::array<double, corona_terms> coeffs {};
+    double t_num = 1.0;
+    double t_offset = 0.0;
+    std::uint64_t fit_pixels = 0;
+
+    /// Model intensity at radius `r` pixels.
+    double at(double r) const noexcept
+    {
+        const double t = t_num / (r * r) + t_offset;
+        double v = coeffs[corona_terms - 1];
+        for (int k = corona_terms - 2; k >= 0; --k)
+            v = v * t + coeffs[k];
+        return v;
+    }
+};
+
+class CoronaSubtractor {
+public:
+    /// Throws std::invalid_argument for inconsistent radii or a SIMD level
+    /// this process cannot run.
+    explicit CoronaSubtractor(const CoronaGeometry& geometry,
+                              core::SimdLevel level = core::best_simd_level());
+
+    /// Least-squares fit of the radial model; throws std::runtime_error if
+    /// the fit annulus holds too few finite pixels.
+    CoronaModel fit(core::ImageView<const float> frame) const;
+
+    /// Subtracts `model` in place.
+    void subtract(core::ImageView<float> frame, const CoronaModel& model) const;
+
+    /// fit() then subtract(); returns the model removed.
+    CoronaModel process(core::ImageView<float> frame) const;
+
+    const CoronaGeometry& geometry() const noexcept { return geometry_; }
+    core::SimdLevel level() const noexcept { return level_; }
+
+private:
+    CoronaGeometry geometry_;
+    core::SimdLevel level_;
+};
+
+/// Runs process() on every frame as one scheduler task each, writing the
+/// removed models to `models`. A frame whose fit fails is left untouched
+/// and its model has fit_pixels == 0; returns how many succeeded.
+std::size_t process_frames(const CoronaSubtractor& subtractor,
+                           std::span<const core::ImageView<float>> frames,
+                           std::span<CoronaModel> models, sched::Scheduler& scheduler);
+
+/// Calibrated copies of a pass's raw frames, allocated in its arena.
+struct CalibratedFrames {
+    std::pmr::vector<core::ImageView<float>> frames;
+    std::pmr::vector<CoronaModel> models;
+    std::size_t succeeded = 0;
+};
+
+/// Copies `raw` into `arena` and runs process_frames() on the copies. The
+/// products live until the arena is reset.
+CalibratedFrames calibrate_frames(const CoronaSubtractor& subtractor,
+                                  std::span<const core::ImageView<const float>> raw,
+                                  core::PassArena& arena, sched::Scheduler& scheduler);
+
+} // namespace solarlens::calib
@@ -0,0 +1,126 @@
+#pragma once
+
+/// Frame registration against a running reference, for residual pointing
+/// jitter left after attitude reconstruction.
+///
+/// Each frame's centred size x size region is high-passed with a discrete
+/// Laplacian, which flattens the corona (under a fixed window it would
+/// otherwise act as a stationary blob and pull every offset towards zero),
+/// apodized with a Hann window and optionally a tapered mask over
+/// instrument-fixed structure such as the occulter edge, and transformed
+/// once with the cached core::FftPlan. Only the band x band low-frequency
+/// block of the spectrum is kept: jitter is a few pixels at most, and the
+/// block carries all the phase slope the shift needs. The offset is the
+/// peak of the phase correlation against the stream's reference on the
+/// band grid, refined by a weighted least-squares fit of the
+/// cross-spectrum phase, which is exact for a pure translation and does
+/// not suffer the bias of peak interpolation.
+///
+/// The reference is the sum of the last `window` registered spectra of its
+/// stream (one stream per spacecraft), held as a ring of band blocks: each
+/// frame registered adds its spectrum, phase-shifted onto the reference,
+/// and removes the one that falls out of the window. No frame is ever
+/// re-transformed and no plan is ever rebuilt. Offsets are reported
+/// relative to the mean pointing of the frames in the window, so jitter
+/// about a steady boresight comes out absolute rather than relative to
+/// whichever frame seeded the stream. Registered frames are resampled in
+/// place with separable cubic convolution, so corona subtraction
+/// downstream sees the Sun where its geometry says.
+///
+/// process() takes a batch of frames from any mix of streams and splits
+/// it into tasks of frames_per_task frames with one workspace each. Every
+/// frame in a batch is registered against its stream's reference as it
+/// stood when the batch started; the references then advance in frame
+/// order. Results depend on how frames are batched, never on the worker
+/// count.
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "solarlens/core/fft.hpp"
+#include "solarlens/core/image.hpp"
+
+namespace solarlens::sched {
+class Scheduler;
+}
+
+namespace solarlens::calib {
+
+struct RegistrationConfig {
+    std::uint32_t size = 256;          ///< FFT side of the centred region; power of two.
+    std::uint32_t band = 64;           ///< Low-frequency block kept; power of two <= size.
+    std::uint32_t window = 16;         ///< Registered frames in each reference.
+    float mask_radius = 0.0f;          ///< Centre disc ignored (an occulter edge); 0 for none.
+    float mask_taper = 8.0f;           ///< Cosine taper beyond mask_radius, pixels.
+    float max_shift = 8.0f;            ///< Larger offsets are reported as failures.
+    float min_peak = 0.02f;            ///< Weaker phase-correlation peaks are failures.
+    std::uint32_t frames_per_task = 4;
+
+    /// Throws std::invalid_argument for unusable values.
+    void validate() const;
+};
+
+struct FrameShift {
+    float dx = 0.0f;          ///< The frame is the window's mean pointing moved by (dx, dy) pixels.
+    float dy = 0.0f;
+    float peak = 0.0f;        ///< Phase-correlation peak, 1 for a pure translation.
+    bool registered = false;  ///< False if no reference yet, or the fit failed.
+};
+
+class FrameRegistrar {
+public:
+    /// Throws std::invalid_argument for an unusable config.
+    explicit FrameRegistrar(const RegistrationConfig& config = {});
+    ~FrameRegistrar();
+
+    FrameRegistrar(const FrameRegistrar&) = delete;
+    FrameRegistrar& operator=(const FrameRegistrar&) = delete;
+
+    /// Registers and resamples `frames` in place; frame i belongs to stream
+    /// `streams[i]`. The first frame of a new stream becomes its reference
+    /// unshifted. A frame that fails is left untouched and not added to the
+    /// reference. Throws std::invalid_argument for mismatched spans or a
+    /// frame smaller than the region.
+    void process(std::span<const core::ImageView<float>> frames, std::span<const std::uint32_t> streams,
+                 std::span<FrameShift> shifts, sched::Scheduler& scheduler);
+
+    /// Forgets stream `stream`'s reference.
+    void reset(std::uint32_t stream);
+
+    /// Frames currently in stream `stream`'s reference.
+    std::size_t reference_frames(std::uint32_t stream) const noexcept;
+
+    const RegistrationConfig& config() const noexcept { return config_; }
+
+private:
+    struct Stream {
+        std::vector<std::complex<double>> sum;      // band^2
+        std::vector<std::complex<float>> slots;     // window x band^2
+        std::vector<FrameShift> offsets;            // window; from the seed, registered = valid
+        std::size_t head = 0;                       // Oldest slot.
+        std::size_t count = 0;
+        std::size_t snapshot = 0;                   // Offset in reference_ this batch.
+        float mean_x = 0.0f;                        // Window mean pointing this batch.
+        float mean_y = 0.0f;
+    };
+    struct Workspace;
+
+    void register_frame(const core::ImageView<float>& frame, const std::complex<float>* reference, float mean_x,
+                        float mean_y, std::complex<float>* slot, FrameShift& shift, Workspace& ws) const;
+
+    RegistrationConfig config_;
+    std::shared_ptr<const core::FftPlan> plan_;
+    std::shared_ptr<const core::FftPlan> band_plan_;
+    std::vector<float> apodization_;                // size^2
+    std::vector<float> laplacian_;                  // band^2, gain of the Laplacian
+    std::unordered_map<std::uint32_t, Stream> streams_;
+    std::vector<std::complex<float>> reference_;    // Per batch: conj(sum) of each stream in use.
+    std::vector<std::unique_ptr<Workspace>> workspaces_;
+};
+
+} // namespace solarlens::calib
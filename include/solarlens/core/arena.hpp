@@ -0,0 +1,129 @@
+#pragma once
+
+/// Pass-scoped bump allocation over recycled slabs.
+///
+/// A ground contact yields thousands of similarly sized frames and
+/// products that all die together when the pass is archived. PassArena
+/// hands out memory by bumping a pointer through fixed-size slabs and
+/// frees nothing individually; reset() returns every slab to a SlabPool
+/// in one step. The pool keeps slabs mapped for the next pass, so a
+/// long-running daemon reuses the same pages instead of fragmenting the
+/// general-purpose heap.
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory_resource>
+#include <new>
+#include <mutex>
+#include <span>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "solarlens/core/image.hpp"
+
+namespace solarlens::core {
+
+struct SlabPoolStats {
+    std::size_t mapped = 0;      ///< Slabs currently mapped, in use or cached.
+    std::size_t cached = 0;      ///< Slabs waiting for reuse.
+    std::uint64_t acquired = 0;  ///< Total acquire() calls.
+    std::uint64_t reused = 0;    ///< acquire() calls served from the cache.
+};
+
+/// Thread-safe cache of equally sized, page-aligned slabs obtained with
+/// mmap and given back to the kernel only by trim().
+class SlabPool {
+public:
+    static constexpr std::size_t default_slab_size = std::size_t(1) << 20;
+
+    /// Keeps at most `max_cached` idle slabs; more are unmapped on release.
+    explicit SlabPool(std::size_t slab_size = default_slab_size, std::size_t max_cached = 1024);
+    ~SlabPool();
+
+    SlabPool(const SlabPool&) = delete;
+    SlabPool& operator=(const SlabPool&) = delete;
+
+    /// Process-wide pool used by default.
+    static SlabPool& shared();
+
+    std::size_t slab_size() const noexcept { return slab_size_; }
+
+    std::byte* acquire();
+    void release(std::byte* slab) noexcept;
+
+    /// Unmaps idle slabs until at most `keep` remain cached.
+    void trim(std::size_t keep = 0) noexcept;
+
+    SlabPoolStats stats() const;
+
+private:
+    std::size_t slab_size_;
+    std::size_t max_cached_;
+    mutable std::mutex mutex_;
+    std::vector<std::byte*> cache_;
+    SlabPoolStats stats_;
+};
+
+/// Bump allocator for one pass. Not thread-safe: allocate from one thread
+/// at a time, e.g. before fanning work out to the scheduler.
+/// Deallocation is a no-op; requests larger than a quarter slab, or aligned
+/// more strictly than a page, get their own mapping, released on reset().
+class PassArena final : public std::pmr::memory_resource {
+public:
+    explicit PassArena(SlabPool& pool = SlabPool::shared());
+    ~PassArena() override;
+
+    PassArena(const PassArena&) = delete;
+    PassArena& operator=(const PassArena&) = delete;
+
+    /// Returns every slab to the pool. All memory handed out is invalid
+    /// afterwards; containers using the arena must be gone or emptied.
+    void reset() noexcept;
+
+    /// Uninitialised storage for `n` trivially destructible `T`s. Throws
+    /// std::bad_alloc if `n * sizeof(T)` overflows.
+    template <typename T>
+    std::span<T> allocate_array(std::size_t n)
+    {
+        static_assert(std::is_trivially_destructible_v<T>,
+                      "arena memory is never destroyed element-wise");
+        if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+            throw std::bad_alloc();
+        return {static_cast<T*>(allocate(n * sizeof(T), alignof(T))), n};
+    }
+
+    std::size_t bytes_allocated() const noexcept { return allocated_; }
+    std::size_t bytes_reserved() const noexcept;
+    std::size_t slab_count() const noexcept { return slabs_.size(); }
+    SlabPool& pool() const noexcept { return pool_; }
+
+private:
+    void* do_allocate(std::size_t bytes, std::size_t alignment) override;
+    void do_deallocate(void*, std::size_t, std::size_t) override {}
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override
+    {
+        return this == &other;
+    }
+
+    SlabPool& pool_;
+    std::vector<std::byte*> slabs_;
+    std::vector<std::pair<void*, std::size_t>> large_;
+    std::byte* cursor_ = nullptr;
+    std::byte* end_ = nullptr;
+    std::size_t allocated_ = 0;
+};
+
+/// Image of `width` x `height` in `arena`, rows padded to 64 bytes so
+/// every row starts on a vector boundary.
+template <typename T>
+ImageView<T> allocate_image(PassArena& arena, std::uint32_t width, std::uint32_t height)
+{
+    const std::size_t per_line = 64 / sizeof(T);
+    const std::size_t stride = (std::size_t(width) + per_line - 1) / per_line * per_line;
+    void* p = arena.allocate(stride * height * sizeof(T), 64);
+    return {static_cast<T*>(p), width, height, stride};
+}
+
+} // namespace solarlens::core
@@ -0,0 +1,54 @@
+#pragma once
+
+/// SHA-256 content digests.
+///
+/// Used wherever bytes must be identified by what they contain rather than
+/// where they came from: cache keys for pipeline products, and checks that
+/// a reprocessed input is the one a product was made from. Incremental, so
+/// a key can be built from several fields without concatenating them.
+
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+
+namespace solarlens::core {
+
+struct Digest {
+    std::array<std::uint8_t, 32> bytes {};
+
+    /// 64 lowercase hex characters.
+    std::string hex() const;
+
+    /// Parses hex(); throws std::invalid_argument for anything else.
+    static Digest from_hex(std::string_view text);
+
+    auto operator<=>(const Digest&) const = default;
+};
+
+class Sha256 {
+public:
+    Sha256() noexcept { reset(); }
+
+    void reset() noexcept;
+    void update(std::span<const std::byte> data) noexcept;
+    void update(std::string_view text) noexcept { update(std::as_bytes(std::span(text.data(), text.size()))); }
+
+    /// Digest of everything since the last reset(); the hasher is reset.
+    Digest finish() noexcept;
+
+private:
+    void compress(const std::uint8_t* block) noexcept;
+
+    std::array<std::uint32_t, 8> state_ {};
+    std::array<std::uint8_t, 64> buffer_ {};
+    std::size_t buffered_ = 0;
+    std::uint64_t length_ = 0;
+};
+
+Digest sha256(std::span<const std::byte> data) noexcept;
+
+} // namespace solarlens::core
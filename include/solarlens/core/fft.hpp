@@ -0,0 +1,48 @@
+#pragma once
+
+/// Radix-2 complex FFT with cached plans.
+///
+/// Plans hold the twiddle and bit-reversal tables for one power-of-two
+/// length and are immutable, so one plan serves any number of threads.
+/// FftPlan::get() returns a process-wide cached plan for a length.
+/// Transforms are unnormalised: inverse(forward(x)) == n * x.
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace solarlens::core {
+
+class FftPlan {
+public:
+    /// Throws std::invalid_argument unless `n` is a power of two >= 1.
+    explicit FftPlan(std::size_t n);
+
+    static std::shared_ptr<const FftPlan> get(std::size_t n);
+
+    std::size_t size() const noexcept { return n_; }
+
+    /// In-place transforms of `data`, which must hold size() elements.
+    void forward(std::span<std::complex<float>> data) const;
+    void inverse(std::span<std::complex<float>> data) const;
+
+    /// Forward transforms of `count` sequences starting `distance`
+    /// elements apart.
+    void forward_batch(std::complex<float>* data, std::size_t count, std::size_t distance) const;
+    void inverse_batch(std::complex<float>* data, std::size_t count, std::size_t distance) const;
+
+private:
+    void transform(std::complex<float>* data, bool inverse) const;
+
+    std::size_t n_;
+    std::vector<std::complex<float>> twiddles_; ///< Per-stage factors, see fft.cpp.
+    std::vector<std::uint32_t> bitrev_;
+};
+
+/// True if `n` is a power of two.
+constexpr bool is_power_of_two(std::size_t n) noexcept { return n != 0 && (n & (n - 1)) == 0; }
+
+} // namespace solarlens::core
@@ -0,0 +1,62 @@
+#pragma once
+
+/// Thin RAII wrapper around a POSIX file descriptor.
+///
+/// All failures throw std::system_error carrying errno and the file path, so
+/// callers never have to check return codes for plain I/O.
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+namespace solarlens::core {
+
+class File {
+public:
+    enum class Mode {
+        read,      ///< Existing file, read-only.
+        write,     ///< Create or truncate, write-only.
+        read_write, ///< Create if missing, read and write, no truncation.
+        scratch     ///< Create or truncate, read and write.
+    };
+
+    File() = default;
+    File(const std::filesystem::path& path, Mode mode);
+    ~File();
+
+    File(File&& other) noexcept;
+    File& operator=(File&& other) noexcept;
+    File(const File&) = delete;
+    File& operator=(const File&) = delete;
+
+    bool is_open() const noexcept { return fd_ >= 0; }
+    int fd() const noexcept { return fd_; }
+    const std::filesystem::path& path() const noexcept { return path_; }
+
+    /// Reads up to `out.size()` bytes at `offset`; returns the count read,
+    /// which is short only at end of file.
+    std::size_t pread(std::span<std::byte> out, std::uint64_t offset) const;
+
+    /// Reads exactly `out.size()` bytes at `offset` or throws.
+    void pread_exact(std::span<std::byte> out, std::uint64_t offset) const;
+
+    /// Writes all of `data` at `offset`.
+    void pwrite(std::span<const std::byte> data, std::uint64_t offset);
+
+    /// Writes all of `data` at the current file position.
+    void write(std::span<const std::byte> data);
+
+    void truncate(std::uint64_t size);
+    std::uint64_t size() const;
+    void sync();
+    void close();
+
+private:
+    [[noreturn]] void fail(const char* what) const;
+
+    int fd_ = -1;
+    std::filesystem::path path_;
+};
+
+} // namespace solarlens::core
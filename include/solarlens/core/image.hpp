@@ -0,0 +1,38 @@
+#pragma once
+
+/// Non-owning strided 2D image view.
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace solarlens::core {
+
+template <typename T>
+struct ImageView {
+    T* data = nullptr;
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    std::size_t stride = 0; ///< Elements between row starts.
+
+    ImageView() = default;
+    ImageView(T* data, std::uint32_t width, std::uint32_t height, std::size_t stride = 0)
+        : data(data)
+        , width(width)
+        , height(height)
+        , stride(stride != 0 ? stride : width)
+    {
+    }
+
+    /// Read-only view of a mutable image.
+    operator ImageView<const T>() const
+        requires(!std::is_const_v<T>)
+    {
+        return {data, width, height, stride};
+    }
+
+    T* row(std::uint32_t y) const noexcept { return data + std::size_t(y) * stride; }
+    T& operator()(std::uint32_t x, std::uint32_t y) const noexcept { return row(y)[x]; }
+};
+
+} // namespace solarlens::core
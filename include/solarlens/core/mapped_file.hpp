@@ -0,0 +1,41 @@
+#pragma once
+
+/// Read-only memory mapping of a whole file.
+///
+/// Mappings are MAP_SHARED, so every process on a node that maps the same
+/// file reads the same page-cache pages; nothing is copied per process.
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace solarlens::core {
+
+class MappedFile {
+public:
+    MappedFile() = default;
+    explicit MappedFile(const std::filesystem::path& path);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool is_open() const noexcept { return data_ != nullptr; }
+    std::span<const std::byte> bytes() const noexcept { return {data_, size_}; }
+    std::size_t size() const noexcept { return size_; }
+    const std::filesystem::path& path() const noexcept { return path_; }
+
+    /// Hints that `range` will be read soon (MADV_WILLNEED).
+    void prefetch(std::size_t offset, std::size_t length) const noexcept;
+
+private:
+    void unmap() noexcept;
+
+    const std::byte* data_ = nullptr;
+    std::size_t size_ = 0;
+    std::filesystem::path path_;
+};
+
+} // namespace solarlens::core
@@ -0,0 +1,34 @@
+#pragma once
+
+/// Runtime CPU dispatch.
+///
+/// Hot kernels are compiled once per instruction set in their own
+/// translation units and chosen at startup from what the CPU reports. The
+/// SOLARLENS_SIMD environment variable ("scalar", "neon", "avx2", "avx512")
+/// caps the level, which is how validation runs force the reference path.
+
+#include <optional>
+#include <string_view>
+
+namespace solarlens::core {
+
+enum class SimdLevel {
+    scalar,
+    neon,
+    avx2,   ///< AVX2 + FMA.
+    avx512, ///< AVX-512F.
+};
+
+/// Highest level both the build and the running CPU support.
+SimdLevel detected_simd_level() noexcept;
+
+/// detected_simd_level(), lowered to SOLARLENS_SIMD if that is set.
+SimdLevel best_simd_level() noexcept;
+
+/// True if kernels for `level` were compiled in and the CPU can run them.
+bool simd_level_supported(SimdLevel level) noexcept;
+
+const char* to_string(SimdLevel level) noexcept;
+std::optional<SimdLevel> parse_simd_level(std::string_view name) noexcept;
+
+} // namespace solarlens::core
@@ -0,0 +1,200 @@
+#pragma once
+
+/// Relocatable, memory-mappable state images for fast daemon restart.
+///
+/// A snapshot is a file of named sections. Each subsystem writes its warm
+/// state (tables, dictionaries, predicted states, timelines) into one or
+/// more sections as plain bytes with offsets instead of pointers, so an
+/// image means the same thing wherever it is mapped. Restoring maps the
+/// file read-only and hands each subsystem its section: large tables are
+/// used in place, small structures are rebuilt from it, and nothing is
+/// recomputed or replayed.
+///
+/// File layout, little-endian, version 1:
+///
+///     offset  size  field
+///          0     8  magic "SLSNAP\0\0"
+///          8     4  version
+///         12     4  section count
+///         16     8  file size (bytes)
+///         24     8  reserved (0)
+///         32  96 n  section table, one entry per section:
+///                   48-byte NUL-padded name, u64 offset, u64 size,
+///                   32-byte SHA-256 of the section
+///
+/// then the sections, each starting on a page boundary so arrays in them
+/// are aligned for any element type and can be mapped on their own.
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+#include "solarlens/core/digest.hpp"
+#include "solarlens/core/mapped_file.hpp"
+
+namespace solarlens::core {
+
+inline constexpr std::uint32_t snapshot_version = 1;
+inline constexpr std::size_t snapshot_name_max = 47;
+
+/// Builds a section from fields in native (little-endian) layout.
+/// Arrays are padded to their element alignment, so a SectionReader on the
+/// mapped image can return them in place.
+class SectionBuilder {
+public:
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void put(const T& value)
+    {
+        const auto* p = reinterpret_cast<const std::byte*>(&value);
+        bytes_.insert(bytes_.end(), p, p + sizeof(T));
+    }
+
+    /// u32 length, then the characters.
+    void put_string(std::string_view text);
+
+    /// u64 count, padding to alignof(T), then the elements.
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void put_array(std::span<const T> values)
+    {
+        put(static_cast<std::uint64_t>(values.size()));
+        bytes_.resize((bytes_.size() + alignof(T) - 1) / alignof(T) * alignof(T));
+        const auto raw = std::as_bytes(values);
+        bytes_.insert(bytes_.end(), raw.begin(), raw.end());
+    }
+
+    std::span<const std::byte> bytes() const noexcept { return bytes_; }
+
+private:
+    std::vector<std::byte> bytes_;
+};
+
+/// Reads back what a SectionBuilder wrote. Every read is bounds-checked
+/// and throws std::runtime_error naming the section when it runs short.
+class SectionReader {
+public:
+    SectionReader(std::span<const std::byte> bytes, std::string_view section)
+        : bytes_(bytes)
+        , section_(section)
+    {
+    }
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    T get()
+    {
+        T value;
+        std::memcpy(&value, take(sizeof(T)).data(), sizeof(T));
+        return value;
+    }
+
+    std::string get_string();
+
+    /// In place: valid while the bytes are.
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    std::span<const T> get_array()
+    {
+        const auto count = get<std::uint64_t>();
+        take((alignof(T) - at_ % alignof(T)) % alignof(T));
+        if (count > (bytes_.size() - at_) / sizeof(T))
+            truncated();
+        const std::span<const std::byte> raw = take(count * sizeof(T));
+        return {reinterpret_cast<const T*>(raw.data()), static_cast<std::size_t>(count)};
+    }
+
+    bool done() const noexcept { return at_ == bytes_.size(); }
+
+private:
+    std::span<const std::byte> take(std::size_t n);
+    [[noreturn]] void truncated() const;
+
+    std::span<const std::byte> bytes_;
+    std::string_view section_;
+    std::size_t at_ = 0;
+};
+
+class SnapshotWriter {
+public:
+    /// Copies `bytes` into the image as section `name`. Throws
+    /// std::invalid_argument for an empty, overlong or repeated name.
+    void add(std::string_view name, std::span<const std::byte> bytes);
+
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    void add_array(std::string_view name, std::span<const T> values)
+    {
+        add(name, std::as_bytes(values));
+    }
+
+    void add(std::string_view name, const SectionBuilder& builder) { add(name, builder.bytes()); }
+
+    std::size_t section_count() const noexcept { return sections_.size(); }
+
+    /// Writes the image under a temporary name, syncs it and renames it
+    /// into place, so a crash mid-write leaves the previous image intact.
+    void write(const std::filesystem::path& path) const;
+
+private:
+    struct Section {
+        std::string name;
+        std::vector<std::byte> bytes;
+    };
+
+    std::vector<Section> sections_;
+};
+
+class Snapshot {
+public:
+    /// Maps an image and checks its structure, and with `verify` every
+    /// section's digest. Throws std::runtime_error naming the file if it
+    /// is not a complete, intact image of the current version.
+    static Snapshot open(const std::filesystem::path& path, bool verify = true);
+
+    bool contains(std::string_view name) const noexcept;
+
+    /// Throws std::runtime_error if there is no such section.
+    std::span<const std::byte> section(std::string_view name) const;
+
+    /// A section as an array. Throws std::runtime_error if its size is not
+    /// a whole number of elements.
+    template <typename T>
+        requires std::is_trivially_copyable_v<T>
+    std::span<const T> array(std::string_view name) const
+    {
+        const std::span<const std::byte> bytes = section(name);
+        if (bytes.size() % sizeof(T) != 0)
+            throw std::runtime_error("snapshot: section " + std::string(name) + " is not an array of that type");
+        return {reinterpret_cast<const T*>(bytes.data()), bytes.size() / sizeof(T)};
+    }
+
+    /// Section names in file order.
+    std::vector<std::string_view> names() const;
+
+    std::size_t size_bytes() const noexcept { return file_.size(); }
+    const std::filesystem::path& path() const noexcept { return file_.path(); }
+
+    /// Hints that every section will be read soon.
+    void prefetch() const noexcept { file_.prefetch(0, file_.size()); }
+
+private:
+    struct Entry {
+        std::string_view name;
+        std::span<const std::byte> bytes;
+    };
+
+    explicit Snapshot(MappedFile file);
+
+    MappedFile file_;
+    std::vector<Entry> entries_;
+};
+
+} // namespace solarlens::core
@@ -0,0 +1,128 @@
+#pragma once
+
+/// FX correlator for swarm interferometry.
+///
+/// Each integration takes `spectra * channels` complex baseband samples
+/// per spacecraft. The F stage channelises every station with batched
+/// FFTs of length `channels` and applies each station's residual delay as
+/// a phase slope; the X stage forms, per channel, the station-by-station
+/// cross-power matrix V_c = X_c X_c^H / spectra with X_c the stations x
+/// spectra matrix of channel c. That is one Hermitian rank-k update per
+/// channel, which maps directly onto batched complex GEMM on a GPU.
+///
+/// Backends share this interface: a straightforward reference in double
+/// precision, a blocked multithreaded CPU path, and CUDA (cuFFT plus
+/// tensor-core cuBLAS) when built with SOLARLENS_WITH_CUDA.
+
+#include <complex>
+#include <cstddef>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace solarlens::sched {
+class Scheduler;
+}
+
+namespace solarlens::corr {
+
+struct CorrelatorConfig {
+    std::size_t stations = 2;
+    std::size_t channels = 256; ///< FFT length; a power of two.
+    std::size_t spectra = 64;   ///< FFT frames per integration.
+
+    std::size_t samples_per_station() const noexcept { return channels * spectra; }
+};
+
+struct CorrelatorInput {
+    /// Station-major samples: station s occupies
+    /// [s * samples_per_station, (s + 1) * samples_per_station).
+    std::span<const std::complex<float>> samples;
+    /// Residual delay of each station in samples, or empty. Integer
+    /// alignment is the caller's job; this corrects the remainder by
+    /// rotating channel k by exp(2 pi i f_k delay), f_k the bin frequency
+    /// in cycles per sample.
+    std::span<const double> delays;
+};
+
+/// Cross-power matrices, channel-major; each channel is a Hermitian
+/// stations x stations row-major matrix including the autocorrelations.
+class Visibilities {
+public:
+    Visibilities() = default;
+    Visibilities(std::size_t stations, std::size_t channels);
+
+    void resize(std::size_t stations, std::size_t channels);
+
+    std::size_t stations() const noexcept { return stations_; }
+    std::size_t channels() const noexcept { return channels_; }
+    std::size_t baselines() const noexcept { return stations_ * (stations_ - 1) / 2; }
+
+    /// <X_i X_j*> in channel `c`.
+    std::complex<float>& at(std::size_t i, std::size_t j, std::size_t c) noexcept
+    {
+        return data_[(c * stations_ + i) * stations_ + j];
+    }
+    const std::complex<float>& at(std::size_t i, std::size_t j, std::size_t c) const noexcept
+    {
+        return data_[(c * stations_ + i) * stations_ + j];
+    }
+
+    std::span<std::complex<float>> channel(std::size_t c) noexcept
+    {
+        return std::span(data_).subspan(c * stations_ * stations_, stations_ * stations_);
+    }
+
+    std::span<std::complex<float>> data() noexcept { return data_; }
+    std::span<const std::complex<float>> data() const noexcept { return data_; }
+
+private:
+    std::size_t stations_ = 0;
+    std::size_t channels_ = 0;
+    std::vector<std::complex<float>> data_;
+};
+
+class Correlator {
+public:
+    virtual ~Correlator() = default;
+
+    virtual std::string_view name() const noexcept = 0;
+    const CorrelatorConfig& config() const noexcept { return config_; }
+
+    /// Correlates one integration into `out`, resizing it as needed.
+    /// Throws std::invalid_argument if the input does not match config().
+    void correlate(const CorrelatorInput& input, Visibilities& out);
+
+protected:
+    explicit Correlator(const CorrelatorConfig& config);
+
+    virtual void run(const CorrelatorInput& input, Visibilities& out) = 0;
+
+    CorrelatorConfig config_;
+};
+
+enum class CorrelatorBackend {
+    reference, ///< Single-threaded, double accumulation; the validation baseline.
+    cpu,       ///< Blocked and parallel on the scheduler.
+    cuda,      ///< cuFFT + batched cuBLAS; needs SOLARLENS_WITH_CUDA.
+};
+
+std::string_view to_string(CorrelatorBackend backend) noexcept;
+
+/// True if this build includes `backend`. Availability of a device is
+/// only checked when the backend is created.
+bool correlator_backend_available(CorrelatorBackend backend) noexcept;
+
+/// The fastest backend compiled in: cuda if built, otherwise cpu.
+CorrelatorBackend default_correlator_backend() noexcept;
+
+/// Creates a correlator. The cpu backend runs on `scheduler` when given,
+/// single-threaded otherwise. Throws std::invalid_argument for a bad
+/// configuration or a backend not in this build, and std::runtime_error
+/// if the GPU cannot be initialised.
+std::unique_ptr<Correlator> make_correlator(const CorrelatorConfig& config,
+                                            CorrelatorBackend backend = default_correlator_backend(),
+                                            sched::Scheduler* scheduler = nullptr);
+
+} // namespace solarlens::corr
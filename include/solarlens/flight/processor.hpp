@@ -0,0 +1,177 @@
+#pragma once
+
+/// Onboard frame processing for the spacecraft flight software.
+///
+/// Downlink from 650 AU runs at bits per second, so the spacecraft sends
+/// products, not frames. FlightProcessor co-adds raw 16-bit detector
+/// frames into a 32-bit sum, measures ring-sector photometry on the sum,
+/// and packs both into one downlink product (flight/product.hpp):
+///
+/// - photometry: sector sums only, a few hundred bytes per co-add;
+/// - lossless: the co-added image, predicted with the median edge
+///   detector of LOCO-I and Rice coded in CCSDS 121 style blocks;
+/// - near_lossless: the same with the residuals quantized in the
+///   prediction loop (as in CCSDS 123.0-B-2), so every reconstructed
+///   pixel is within `near_lossless_delta` counts of the co-add.
+///
+/// Flight rules apply. All memory is a caller-supplied workspace of
+/// workspace_bytes(config), carved up once in the constructor; nothing
+/// after construction allocates, throws, or touches floating point.
+/// Every step has a fixed worst case: add_frame() is one pass over the
+/// frame, the product never exceeds max_product_bytes(config), and
+/// encode_rows() lets the flight executive bound the time spent per
+/// scheduling slot by coding the image a few rows at a time.
+///
+/// Kernels are chosen by `simd` like the other SIMD code; NEON is the
+/// flight path, and every kernel produces identical bits.
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "solarlens/core/image.hpp"
+#include "solarlens/core/simd.hpp"
+
+namespace solarlens::flight {
+
+enum class FlightMode : std::uint8_t { photometry, lossless, near_lossless };
+
+const char* to_string(FlightMode mode) noexcept;
+
+/// Annuli around the Einstein ring, in frame pixel coordinates (pixel
+/// centres at integers). Each annulus is split into `sectors` equal
+/// angles counted anticlockwise from +x. The background annulus is
+/// disabled when its outer radius is not above its inner one.
+struct RingGeometry {
+    float cx = 511.5f;
+    float cy = 511.5f;
+    float inner = 170.0f;
+    float outer = 210.0f;
+    float background_inner = 230.0f;
+    float background_outer = 270.0f;
+    std::uint16_t sectors = 64;
+
+    bool has_background() const noexcept { return background_outer > background_inner; }
+};
+
+struct FlightConfig {
+    std::uint32_t width = 1024;  ///< Multiple of 16.
+    std::uint32_t height = 1024;
+    std::uint32_t frames_per_coadd = 16; ///< At most 256, so sums fit 24 bits.
+    FlightMode mode = FlightMode::lossless;
+    std::uint32_t near_lossless_delta = 2; ///< Max error per pixel, 1..63, near_lossless only.
+    RingGeometry ring;
+    core::SimdLevel simd = core::best_simd_level();
+
+    /// Throws std::invalid_argument for unusable settings.
+    void validate() const;
+
+    /// Bits per co-added pixel: 16 + ceil(log2(frames_per_coadd)).
+    unsigned sample_bits() const noexcept;
+};
+
+/// Raw sums over one sector of each annulus.
+struct SectorSums {
+    std::uint64_t signal = 0;
+    std::uint64_t background = 0;
+    std::uint32_t signal_pixels = 0;
+    std::uint32_t background_pixels = 0;
+};
+
+class FlightProcessor {
+public:
+    /// Bytes of workspace the constructor needs for `config`.
+    static std::size_t workspace_bytes(const FlightConfig& config);
+
+    /// Upper bound on any product for `config`.
+    static std::size_t max_product_bytes(const FlightConfig& config);
+
+    /// Throws std::invalid_argument for a bad config, an unsupported SIMD
+    /// level, or a workspace smaller than workspace_bytes(config). The
+    /// workspace must outlive the processor.
+    FlightProcessor(const FlightConfig& config, std::span<std::byte> workspace);
+
+    FlightProcessor(const FlightProcessor&) = delete;
+    FlightProcessor& operator=(const FlightProcessor&) = delete;
+
+    /// Adds a raw frame to the co-add. Returns false, adding nothing, if
+    /// its size differs from the config or the co-add is already full.
+    bool add_frame(core::ImageView<const std::uint16_t> frame) noexcept;
+
+    std::uint32_t frames() const noexcept { return frames_; }
+    bool full() const noexcept { return frames_ == config_.frames_per_coadd; }
+
+    /// Measures the sectors and starts a product in `out`. Returns false
+    /// if no frame has been added or `out` is under max_product_bytes().
+    bool begin_product(std::span<std::byte> out) noexcept;
+
+    /// Codes up to `rows` more image rows of the product begun last;
+    /// returns true once the product is complete.
+    bool encode_rows(std::uint32_t rows) noexcept;
+
+    /// begin_product() plus encode_rows() to completion. Returns the
+    /// product size, or 0 if begin_product() refused.
+    std::size_t encode(std::span<std::byte> out) noexcept;
+
+    /// Size of the completed product, 0 while one is in progress.
+    std::size_t product_bytes() const noexcept { return done_ ? product_size_ : 0; }
+
+    /// Clears the co-add for the next one.
+    void reset() noexcept;
+
+    std::span<const SectorSums> sectors() const noexcept { return {sectors_, config_.ring.sectors}; }
+    core::ImageView<const std::uint32_t> coadd() const noexcept
+    {
+        return {sum_, config_.width, config_.height};
+    }
+
+    const FlightConfig& config() const noexcept { return config_; }
+
+private:
+    struct Span {
+        std::uint32_t offset; // Pixel index of the first pixel.
+        std::uint32_t length;
+        std::uint32_t bin;    // Sector, plus `sectors` for the background.
+    };
+
+    // Fill `mapped_` with row y's residuals.
+    void predict_row(std::uint32_t y) noexcept;
+    void predict_near_lossless_row(std::uint32_t y) noexcept;
+
+    FlightConfig config_;
+    unsigned bits_;
+    std::uint32_t max_value_;
+    std::size_t max_product_;
+    std::uint32_t frames_ = 0;
+
+    // Workspace regions.
+    std::uint32_t* sum_ = nullptr;
+    std::uint32_t* mapped_ = nullptr;       // One row of residuals.
+    std::uint32_t* reconstructed_ = nullptr; // Two rows, near_lossless.
+    SectorSums* sectors_ = nullptr;
+    Span* spans_ = nullptr;
+    std::size_t span_count_ = 0;
+
+    // Product in progress.
+    std::byte* out_ = nullptr;
+    std::size_t capacity_ = 0;
+    std::size_t image_offset_ = 0;
+    std::size_t product_size_ = 0;
+    std::uint32_t next_row_ = 0;
+    bool done_ = false;
+    bool overflow_ = false;
+    // Bit writer state between encode_rows() calls.
+    std::size_t bit_pos_ = 0;
+    std::uint64_t bit_acc_ = 0;
+    unsigned bit_fill_ = 0;
+
+    using AccumulateFn = void (*)(const std::uint16_t*, std::uint32_t*, std::size_t);
+    using SpanSumFn = std::uint64_t (*)(const std::uint32_t*, std::size_t);
+    using MapRowFn = void (*)(const std::uint32_t*, const std::uint32_t*, std::size_t, std::uint32_t,
+                              std::uint32_t*);
+    AccumulateFn accumulate_;
+    SpanSumFn span_sum_;
+    MapRowFn map_row_;
+};
+
+} // namespace solarlens::flight
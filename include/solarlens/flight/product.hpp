@@ -0,0 +1,46 @@
+#pragma once
+
+/// Downlink product written by FlightProcessor, and its ground decoder.
+///
+/// Layout, little-endian:
+///
+///     header    52 bytes: "SLFP", version, mode, delta, sample bits,
+///               width, height, frames, sectors, flags, image bytes, and
+///               the ring geometry as six floats
+///     sectors   per sector, LEB128 signal sum then (with a background
+///               annulus) LEB128 background sum
+///     image     lossless / near_lossless only: Rice blocks of 16 mapped
+///               residuals, row-major, padded to a byte
+///
+/// Pixel counts per sector are not sent; the decoder recomputes them from
+/// the geometry with the same code the spacecraft ran.
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "solarlens/flight/processor.hpp"
+
+namespace solarlens::flight {
+
+inline constexpr std::uint32_t product_magic = 0x50464c53; ///< "SLFP" read little-endian.
+inline constexpr std::size_t product_header_bytes = 52;
+inline constexpr std::uint8_t product_version = 1;
+
+struct FlightProduct {
+    FlightMode mode = FlightMode::photometry;
+    std::uint32_t width = 0;
+    std::uint32_t height = 0;
+    std::uint32_t frames = 0;
+    std::uint32_t near_lossless_delta = 0;
+    unsigned sample_bits = 0;
+    RingGeometry ring;
+    std::vector<SectorSums> sectors;
+    std::vector<std::uint32_t> image; ///< Co-added pixels, row-major; empty for photometry.
+};
+
+/// Throws std::runtime_error for a truncated or malformed product.
+FlightProduct decode_product(std::span<const std::byte> product);
+
+} // namespace solarlens::flight
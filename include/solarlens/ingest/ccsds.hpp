@@ -0,0 +1,136 @@
+#pragma once
+
+/// In-place views over CCSDS TM transfer frames (CCSDS 132.0-B) and space
+/// packets (CCSDS 133.0-B).
+///
+/// Views hold a span into received bytes and decode header fields on
+/// demand; nothing is copied. The caller keeps the underlying buffer alive.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace solarlens::ingest {
+
+/// Attached sync marker that precedes every channel access data unit.
+inline constexpr std::array<std::byte, 4> attached_sync_marker = {
+    std::byte {0x1A}, std::byte {0xCF}, std::byte {0xFC}, std::byte {0x1D}};
+
+inline std::uint16_t load_be16(const std::byte* p) noexcept
+{
+    return static_cast<std::uint16_t>((std::to_integer<unsigned>(p[0]) << 8) |
+                                      std::to_integer<unsigned>(p[1]));
+}
+
+inline void store_be16(std::byte* p, std::uint16_t v) noexcept
+{
+    p[0] = static_cast<std::byte>(v >> 8);
+    p[1] = static_cast<std::byte>(v & 0xFF);
+}
+
+/// CRC-16-CCITT (polynomial 0x1021, preset 0xFFFF) as used by the TM frame
+/// error control field.
+std::uint16_t crc16_ccitt(std::span<const std::byte> data) noexcept;
+
+class TmFrameView {
+public:
+    static constexpr std::size_t primary_header_size = 6;
+    static constexpr std::size_t ocf_size = 4;
+    static constexpr std::size_t fecf_size = 2;
+
+    /// First header pointer values with special meaning.
+    static constexpr std::uint16_t fhp_no_packet_start = 0x7FF;
+    static constexpr std::uint16_t fhp_idle = 0x7FE;
+
+    TmFrameView() = default;
+
+    /// `frame` spans exactly one transfer frame. Whether an FECF is present
+    /// is a mission constant not carried in the header, so the caller says.
+    TmFrameView(std::span<const std::byte> frame, bool fecf_present) noexcept
+        : frame_(frame)
+        , fecf_present_(fecf_present)
+    {
+    }
+
+    /// True if the frame is long enough to hold its headers and trailer.
+    bool well_formed() const noexcept;
+
+    unsigned version() const noexcept { return byte(0) >> 6; }
+    std::uint16_t spacecraft_id() const noexcept
+    {
+        return static_cast<std::uint16_t>((load_be16(frame_.data()) >> 4) & 0x3FF);
+    }
+    std::uint8_t virtual_channel() const noexcept { return (byte(1) >> 1) & 0x7; }
+    bool ocf_flag() const noexcept { return byte(1) & 0x1; }
+    std::uint8_t master_channel_count() const noexcept { return byte(2); }
+    std::uint8_t virtual_channel_count() const noexcept { return byte(3); }
+    bool secondary_header_flag() const noexcept { return byte(4) & 0x80; }
+    /// When set, the data field is not packet-synchronous and the first
+    /// header pointer is undefined.
+    bool sync_flag() const noexcept { return byte(4) & 0x40; }
+    std::uint16_t first_header_pointer() const noexcept
+    {
+        return load_be16(frame_.data() + 4) & 0x7FF;
+    }
+
+    /// Packet zone: everything between the headers and the trailer.
+    std::span<const std::byte> data_field() const noexcept;
+
+    /// The operational control field, or an empty span if absent.
+    std::span<const std::byte> ocf() const noexcept;
+
+    /// Checks the FECF; frames without one always pass.
+    bool fecf_ok() const noexcept;
+
+    std::span<const std::byte> bytes() const noexcept { return frame_; }
+
+private:
+    unsigned byte(std::size_t i) const noexcept { return std::to_integer<unsigned>(frame_[i]); }
+    std::size_t secondary_header_size() const noexcept;
+    std::size_t trailer_size() const noexcept;
+
+    std::span<const std::byte> frame_;
+    bool fecf_present_ = true;
+};
+
+class SpacePacketView {
+public:
+    static constexpr std::size_t primary_header_size = 6;
+    static constexpr std::uint16_t idle_apid = 0x7FF;
+
+    enum class Sequence : std::uint8_t { continuation = 0, first = 1, last = 2, unsegmented = 3 };
+
+    SpacePacketView() = default;
+
+    /// `packet` spans the whole packet, headers included.
+    explicit SpacePacketView(std::span<const std::byte> packet) noexcept : packet_(packet) {}
+
+    /// Total packet length implied by a primary header at `header`, which
+    /// must point at six readable bytes.
+    static std::size_t length_from_header(const std::byte* header) noexcept
+    {
+        return primary_header_size + 1 + load_be16(header + 4);
+    }
+
+    unsigned version() const noexcept { return std::to_integer<unsigned>(packet_[0]) >> 5; }
+    bool is_telecommand() const noexcept { return std::to_integer<unsigned>(packet_[0]) & 0x10; }
+    bool secondary_header_flag() const noexcept { return std::to_integer<unsigned>(packet_[0]) & 0x08; }
+    std::uint16_t apid() const noexcept { return load_be16(packet_.data()) & 0x7FF; }
+    Sequence sequence_flags() const noexcept
+    {
+        return static_cast<Sequence>(std::to_integer<unsigned>(packet_[2]) >> 6);
+    }
+    std::uint16_t sequence_count() const noexcept { return load_be16(packet_.data() + 2) & 0x3FFF; }
+    bool is_idle() const noexcept { return apid() == idle_apid; }
+
+    /// Packet data field (secondary header plus user data).
+    std::span<const std::byte> data() const noexcept { return packet_.subspan(primary_header_size); }
+    std::span<const std::byte> bytes() const noexcept { return packet_; }
+    std::size_t size() const noexcept { return packet_.size(); }
+
+private:
+    std::span<const std::byte> packet_;
+};
+
+} // namespace solarlens::ingest
@@ -0,0 +1,55 @@
+#pragma once
+
+/// Products retained for one ground contact until it is archived.
+///
+/// Ring slots are recycled as soon as a batch is decoded, so anything kept
+/// for the pass is copied once into the pass arena. Frames, packets and
+/// calibration products of a pass share that arena and are released
+/// together by reset().
+
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+#include <span>
+#include <vector>
+
+#include "solarlens/core/arena.hpp"
+#include "solarlens/ingest/pipeline.hpp"
+
+namespace solarlens::ingest {
+
+struct StoredPacket {
+    std::span<const std::byte> bytes;
+    std::uint16_t spacecraft_id = 0;
+    std::uint8_t virtual_channel = 0;
+
+    SpacePacketView view() const noexcept { return SpacePacketView(bytes); }
+};
+
+class ContactPass {
+public:
+    explicit ContactPass(core::SlabPool& pool = core::SlabPool::shared());
+
+    ContactPass(const ContactPass&) = delete;
+    ContactPass& operator=(const ContactPass&) = delete;
+
+    /// Arena for other products of this pass (calibrated frames, models).
+    core::PassArena& arena() noexcept { return arena_; }
+
+    /// Copies `packets` into the pass. Usable directly as a PacketSink.
+    void keep(std::span<const PacketRef> packets);
+
+    std::span<const StoredPacket> packets() const noexcept { return packets_; }
+    std::size_t packet_bytes() const noexcept { return packet_bytes_; }
+
+    /// Ends the pass: drops every product and returns its memory in one
+    /// step. Views obtained earlier become invalid.
+    void reset() noexcept;
+
+private:
+    core::PassArena arena_;
+    std::pmr::vector<StoredPacket> packets_;
+    std::size_t packet_bytes_ = 0;
+};
+
+} // namespace solarlens::ingest
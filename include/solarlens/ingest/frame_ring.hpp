@@ -0,0 +1,85 @@
+#pragma once
+
+/// Single-producer single-consumer ring of fixed-size frame slots.
+///
+/// The receiver writes datagrams straight into free slots and commits
+/// them; the decoder works on committed slots in place and releases them
+/// once every downstream consumer has finished with the spans it handed
+/// out. Slots are 64-byte aligned in one page-aligned block.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <span>
+#include <vector>
+
+namespace solarlens::ingest {
+
+class FrameRing {
+public:
+    /// `slot_count` is rounded up to a power of two.
+    FrameRing(std::size_t slot_count, std::size_t slot_size);
+
+    FrameRing(const FrameRing&) = delete;
+    FrameRing& operator=(const FrameRing&) = delete;
+
+    std::size_t slot_count() const noexcept { return mask_ + 1; }
+    std::size_t slot_size() const noexcept { return slot_size_; }
+
+    // Producer side.
+
+    std::size_t writable() const noexcept;
+
+    /// Full buffer of the i-th free slot past the write cursor.
+    std::span<std::byte> write_slot(std::size_t i) noexcept
+    {
+        return {slot_ptr(head_.load(std::memory_order_relaxed) + i), slot_size_};
+    }
+
+    /// Records how many bytes of the i-th free slot hold data.
+    void set_length(std::size_t i, std::size_t length) noexcept
+    {
+        lengths_[(head_.load(std::memory_order_relaxed) + i) & mask_] =
+            static_cast<std::uint32_t>(length);
+    }
+
+    /// Publishes the first `n` free slots to the consumer.
+    void commit(std::size_t n) noexcept;
+
+    // Consumer side.
+
+    std::size_t readable() const noexcept;
+
+    /// The i-th committed slot, sized to its length. Mutable so decoding
+    /// stages can work in place.
+    std::span<std::byte> read_slot(std::size_t i) noexcept
+    {
+        const std::uint64_t at = tail_.load(std::memory_order_relaxed) + i;
+        return {slot_ptr(at), lengths_[at & mask_]};
+    }
+
+    /// Returns the oldest `n` committed slots to the producer.
+    void release(std::size_t n) noexcept;
+
+private:
+    struct AlignedFree {
+        void operator()(std::byte* p) const noexcept { ::operator delete[](p, std::align_val_t {4096}); }
+    };
+
+    std::byte* slot_ptr(std::uint64_t at) const noexcept
+    {
+        return storage_.get() + (at & mask_) * stride_;
+    }
+
+    std::size_t mask_;
+    std::size_t slot_size_;
+    std::size_t stride_;
+    std::unique_ptr<std::byte[], AlignedFree> storage_;
+    std::vector<std::uint32_t> lengths_;
+    alignas(64) std::atomic<std::uint64_t> head_ {0};
+    alignas(64) std::atomic<std::uint64_t> tail_ {0};
+};
+
+} // namespace solarlens::ingest
@@ -0,0 +1,27 @@
+#pragma once
+
+/// Channel coding parameters of one downlink, shared by the decoder and
+/// the encoder used for simulation and replay.
+
+#include <cstddef>
+
+namespace solarlens::ingest {
+
+struct LinkConfig {
+    std::size_t frame_length = 1115; ///< TM transfer frame bytes (223 * 5).
+    bool sync_marker = true;         ///< CADUs carry the attached sync marker.
+    bool randomized = true;          ///< Pseudo-randomizer applied after coding.
+    unsigned rs_interleave = 5;      ///< Reed-Solomon interleave depth; 0 = uncoded.
+    bool fecf_present = true;        ///< Frames end in a CRC-16.
+
+    /// Throws std::invalid_argument for an inconsistent configuration.
+    void validate() const;
+
+    /// Virtual fill per RS codeword implied by frame_length.
+    std::size_t rs_virtual_fill() const noexcept;
+
+    /// Bytes per channel access data unit on the wire.
+    std::size_t cadu_size() const noexcept;
+};
+
+} // namespace solarlens::ingest
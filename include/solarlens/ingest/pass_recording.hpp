@@ -0,0 +1,128 @@
+#pragma once
+
+/// Recorded downlink passes and their replay on a virtual clock.
+///
+/// A recording holds every CADU of a contact as it reached the receiver,
+/// with its arrival time, so a pass can be decoded again later exactly as
+/// it was received. PassReplay cuts a recording into the batches a
+/// receiver draining its ring every `batch_ns` would have seen, using only
+/// the recorded arrival times: batch boundaries, and with them everything
+/// downstream that depends on batching, are the same however fast the
+/// replay runs.
+///
+/// File layout (little-endian): a 32-byte header { "SLPR", u32 version,
+/// u32 frame_length, u8 sync_marker, u8 randomized, u8 fecf_present,
+/// u8 rs_interleave, u64 count, u64 reserved } recording the link, then
+/// `count` records { u64 arrival ns since the first CADU, cadu_size()
+/// bytes }. The recording is memory-mapped for replay.
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "solarlens/core/file.hpp"
+#include "solarlens/core/mapped_file.hpp"
+#include "solarlens/ingest/link.hpp"
+
+namespace solarlens::ingest {
+
+inline constexpr std::uint32_t pass_recording_version = 1;
+
+/// Appends CADUs to a new recording; the header count is patched on
+/// close().
+class PassRecorder {
+public:
+    /// Throws std::invalid_argument for an inconsistent link.
+    PassRecorder(const std::filesystem::path& path, const LinkConfig& link);
+    ~PassRecorder();
+
+    PassRecorder(const PassRecorder&) = delete;
+    PassRecorder& operator=(const PassRecorder&) = delete;
+
+    /// Records one CADU that arrived at `arrival_ns` on any monotonic
+    /// clock; times are stored relative to the first CADU. Throws
+    /// std::invalid_argument for a CADU of the wrong size or a time
+    /// earlier than the previous one.
+    void append(std::uint64_t arrival_ns, std::span<const std::byte> cadu);
+
+    std::uint64_t count() const noexcept { return count_; }
+
+    /// Writes the final header. Called by the destructor if omitted, but
+    /// errors are only reported when called explicitly.
+    void close();
+
+private:
+    core::File file_;
+    LinkConfig link_;
+    std::vector<std::byte> record_;
+    std::uint64_t count_ = 0;
+    std::uint64_t first_ns_ = 0;
+    std::uint64_t last_ns_ = 0;
+};
+
+class PassRecording {
+public:
+    /// Throws std::runtime_error for a file that is not a complete
+    /// recording.
+    explicit PassRecording(const std::filesystem::path& path);
+
+    const LinkConfig& link() const noexcept { return link_; }
+    std::size_t count() const noexcept { return count_; }
+
+    /// Arrival of CADU i, nanoseconds after the first.
+    std::uint64_t arrival_ns(std::size_t i) const noexcept;
+    std::span<const std::byte> cadu(std::size_t i) const noexcept;
+
+    /// Arrival of the last CADU; 0 for an empty recording.
+    std::uint64_t duration_ns() const noexcept { return count_ ? arrival_ns(count_ - 1) : 0; }
+
+    /// The whole file, e.g. to identify the recording by its digest.
+    std::span<const std::byte> bytes() const noexcept { return file_.bytes(); }
+
+private:
+    const std::byte* record(std::size_t i) const noexcept;
+
+    core::MappedFile file_;
+    LinkConfig link_;
+    std::size_t count_ = 0;
+    std::size_t record_size_ = 0;
+};
+
+/// Walks a recording one receiver batch at a time. Each batch's CADUs are
+/// copied into a reused buffer, since the ingest pipeline decodes in place.
+class PassReplay {
+public:
+    /// Throws std::invalid_argument if `batch_ns` is zero.
+    PassReplay(const PassRecording& recording, std::uint64_t batch_ns);
+
+    /// Advances the virtual clock to the end of the next batch window that
+    /// holds CADUs; returns false once the recording is exhausted. Empty
+    /// windows are skipped, as a receiver would not wake for them.
+    bool next();
+
+    /// CADUs that arrived in the current window, in arrival order; valid
+    /// until the next call to next().
+    std::span<const std::span<std::byte>> cadus() const noexcept { return cadus_; }
+
+    /// Virtual time: the end of the current window, when a receiver would
+    /// have drained it.
+    std::uint64_t now_ns() const noexcept { return now_ns_; }
+
+    /// Batches returned so far.
+    std::uint64_t batches() const noexcept { return batches_; }
+
+    void rewind() noexcept;
+
+private:
+    const PassRecording& recording_;
+    std::uint64_t batch_ns_;
+    std::size_t next_ = 0;
+    std::uint64_t now_ns_ = 0;
+    std::uint64_t batches_ = 0;
+    std::vector<std::byte> buffer_;
+    std::vector<std::span<std::byte>> cadus_;
+};
+
+} // namespace solarlens::ingest
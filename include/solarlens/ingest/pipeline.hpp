@@ -0,0 +1,112 @@
+#pragma once
+
+/// Downlink decode pipeline: CADUs in, space packets out.
+///
+/// Each batch of CADUs runs through sync-marker check, derandomization and
+/// Reed-Solomon correction as whole-batch stages (RS codeblocks in
+/// parallel on the scheduler when one is given), then frame validation and
+/// packet extraction in arrival order. Frame counters and packets split
+/// across frames are tracked per (spacecraft, virtual channel), so craft
+/// sharing one downlink may interleave frames freely. Everything is
+/// decoded in place: packets contained in one frame reach the sink as
+/// spans into the receive buffer, and only packets that straddle frames
+/// are reassembled, into a batch arena that is reset once per batch.
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "solarlens/core/arena.hpp"
+#include "solarlens/ingest/ccsds.hpp"
+#include "solarlens/ingest/frame_ring.hpp"
+#include "solarlens/ingest/link.hpp"
+#include "solarlens/ingest/reed_solomon.hpp"
+
+namespace solarlens::sched {
+class Scheduler;
+}
+
+namespace solarlens::ingest {
+
+struct IngestStats {
+    std::uint64_t cadus = 0;
+    std::uint64_t bad_length = 0;     ///< CADUs of the wrong size.
+    std::uint64_t bad_sync = 0;       ///< Sync marker mismatch.
+    std::uint64_t rs_corrected = 0;   ///< Symbols fixed by Reed-Solomon.
+    std::uint64_t rs_failed = 0;      ///< Uncorrectable codeblocks.
+    std::uint64_t crc_failed = 0;
+    std::uint64_t bad_header = 0;     ///< Wrong version or truncated frame.
+    std::uint64_t frames = 0;         ///< Frames accepted.
+    std::uint64_t idle_frames = 0;
+    std::uint64_t vc_gaps = 0;        ///< Per-craft virtual-channel counter discontinuities.
+    std::uint64_t packets = 0;        ///< Packets delivered, idle excluded.
+    std::uint64_t reassembled = 0;    ///< Delivered packets that spanned frames.
+    std::uint64_t packets_dropped = 0; ///< Partial packets lost to gaps or bad pointers.
+};
+
+struct PacketRef {
+    SpacePacketView packet;
+    std::uint16_t spacecraft_id = 0;
+    std::uint8_t virtual_channel = 0;
+    bool reassembled = false;
+};
+
+/// Receives each batch's packets in arrival order. The views are valid
+/// only until the sink returns.
+using PacketSink = std::function<void(std::span<const PacketRef>)>;
+
+class IngestPipeline {
+public:
+    static constexpr std::size_t virtual_channels = 8;
+
+    explicit IngestPipeline(const LinkConfig& link, sched::Scheduler* scheduler = nullptr,
+                            core::SlabPool& pool = core::SlabPool::shared());
+
+    const LinkConfig& link() const noexcept { return link_; }
+
+    /// Decodes every committed slot of `ring` as one batch, hands the
+    /// packets to `sink`, then releases the slots. Returns the CADU count.
+    std::size_t drain(FrameRing& ring, const PacketSink& sink);
+
+    /// Decodes `cadus` in place as one batch.
+    void process(std::span<const std::span<std::byte>> cadus, const PacketSink& sink);
+
+    const IngestStats& stats() const noexcept { return stats_; }
+
+private:
+    struct Channel {
+        std::optional<std::uint8_t> last_count;
+        std::vector<std::byte> partial; ///< Packet started in an earlier frame;
+                                        ///< capacity is kept between packets.
+        std::size_t expected = 0;       ///< Its full length once the header is in.
+    };
+
+    std::span<std::byte> strip(std::span<std::byte> cadu);
+    void correct(std::span<const std::span<std::byte>> frames, std::span<int> fixed);
+    void extract(const TmFrameView& frame);
+    void continue_partial(Channel& ch, std::span<const std::byte> bytes, bool bounded,
+                          const TmFrameView& frame);
+    void start_partial(Channel& ch, std::span<const std::byte> bytes);
+    void drop_partial(Channel& ch);
+    void deliver(std::span<const std::byte> packet, const TmFrameView& frame, bool reassembled);
+
+    LinkConfig link_;
+    sched::Scheduler* scheduler_;
+    std::optional<ReedSolomon> rs_;
+    /// Keyed on (spacecraft_id << 3) | virtual_channel.
+    std::unordered_map<std::uint32_t, Channel> channels_;
+    IngestStats stats_;
+
+    // Per-batch scratch, kept to avoid reallocating.
+    std::vector<std::span<std::byte>> drained_; ///< Ring slots handed to process().
+    std::vector<std::span<std::byte>> frames_;
+    std::vector<int> fixed_;
+    std::vector<PacketRef> out_;
+    core::PassArena batch_arena_; ///< Reassembled packets of the current batch.
+};
+
+} // namespace solarlens::ingest
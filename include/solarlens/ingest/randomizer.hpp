@@ -0,0 +1,29 @@
+#pragma once
+
+/// CCSDS pseudo-randomizer (CCSDS 131.0-B section 10).
+///
+/// The sequence comes from h(x) = x^8 + x^7 + x^5 + x^3 + 1 seeded with all
+/// ones and repeats every 255 bytes. It starts at the first byte after
+/// the sync marker. Removing it is its own inverse, so one function serves
+/// both directions.
+
+#include <cstddef>
+#include <span>
+
+namespace solarlens::ingest {
+
+/// The first `n` bytes of the sequence, with n <= max_randomized_length.
+std::span<const std::byte> pseudo_random_sequence(std::size_t n);
+
+/// Longest run the precomputed sequence covers; more than any CADU of
+/// interleave depth eight.
+inline constexpr std::size_t max_randomized_length = 255 * 16;
+
+/// XORs the sequence over `data` in place.
+void derandomize(std::span<std::byte> data);
+
+/// Derandomizes every buffer in `blocks`; the table is loaded once per
+/// batch and the inner loop runs over whole machine words.
+void derandomize_batch(std::span<const std::span<std::byte>> blocks);
+
+} // namespace solarlens::ingest
@@ -0,0 +1,43 @@
+#pragma once
+
+/// CCSDS Reed-Solomon (255,223) code (CCSDS 131.0-B section 4).
+///
+/// Field generator x^8+x^7+x^2+x+1, first consecutive root 112, root
+/// spacing 11, 32 parity symbols. Symbols are in the CCSDS dual basis on
+/// the wire. With interleave depth I, byte m of a codeblock belongs to
+/// codeword m % I, so the transfer frame occupies the first data_size()
+/// bytes contiguously and parity follows. Decoding corrects in place.
+
+#include <cstddef>
+#include <span>
+
+namespace solarlens::ingest {
+
+class ReedSolomon {
+public:
+    static constexpr std::size_t symbols = 255;
+    static constexpr std::size_t data_symbols = 223;
+    static constexpr std::size_t parity_symbols = 32;
+    static constexpr std::size_t max_correctable = parity_symbols / 2;
+
+    /// `interleave` is 1..8. `virtual_fill` leading zero symbols per
+    /// codeword are implied but not transmitted (shortened code).
+    explicit ReedSolomon(unsigned interleave, std::size_t virtual_fill = 0);
+
+    unsigned interleave() const noexcept { return interleave_; }
+    std::size_t codeblock_size() const noexcept { return (symbols - fill_) * interleave_; }
+    std::size_t data_size() const noexcept { return (data_symbols - fill_) * interleave_; }
+
+    /// Fills the parity bytes of `codeblock` from its data bytes.
+    void encode(std::span<std::byte> codeblock) const;
+
+    /// Corrects `codeblock` in place. Returns the number of symbols fixed,
+    /// or -1 if any codeword had more errors than the code can correct.
+    int decode(std::span<std::byte> codeblock) const;
+
+private:
+    unsigned interleave_;
+    std::size_t fill_;
+};
+
+} // namespace solarlens::ingest
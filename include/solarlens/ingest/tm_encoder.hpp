@@ -0,0 +1,57 @@
+#pragma once
+
+/// Packs space packets into TM frames of one virtual channel and codes
+/// them into CADUs, the inverse of IngestPipeline. Used to synthesise
+/// downlink for simulation, replay and benchmarks.
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <span>
+#include <vector>
+
+#include "solarlens/ingest/link.hpp"
+#include "solarlens/ingest/reed_solomon.hpp"
+
+namespace solarlens::ingest {
+
+/// Receives each finished CADU; the span is valid until the call returns.
+using CaduSink = std::function<void(std::span<const std::byte>)>;
+
+class TmEncoder {
+public:
+    TmEncoder(const LinkConfig& link, std::uint16_t spacecraft_id, std::uint8_t virtual_channel);
+
+    /// Appends one complete space packet, emitting frames as they fill.
+    /// Packets may span frames.
+    void add_packet(std::span<const std::byte> packet, const CaduSink& sink);
+
+    /// Pads the open frame with an idle packet and emits it.
+    void flush(const CaduSink& sink);
+
+    /// Emits one idle frame (first header pointer 0x7FE).
+    void emit_idle(const CaduSink& sink);
+
+    std::uint64_t frames_emitted() const noexcept { return frames_; }
+
+private:
+    std::size_t capacity() const noexcept;
+    void append(std::span<const std::byte> bytes, bool packet_start, const CaduSink& sink);
+    void finish_frame(const CaduSink& sink);
+
+    LinkConfig link_;
+    std::uint16_t spacecraft_id_;
+    std::uint8_t virtual_channel_;
+    std::optional<ReedSolomon> rs_;
+    std::vector<std::byte> cadu_;
+    std::size_t fill_ = 0;         ///< Bytes used in the open frame's data field.
+    std::uint16_t first_header_;   ///< FHP of the open frame.
+    std::uint64_t frames_ = 0;
+};
+
+/// Builds a space packet (unsegmented, telemetry) around `data`.
+std::vector<std::byte> make_space_packet(std::uint16_t apid, std::uint16_t sequence_count,
+                                         std::span<const std::byte> data);
+
+} // namespace solarlens::ingest
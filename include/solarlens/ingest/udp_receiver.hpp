@@ -0,0 +1,57 @@
+#pragma once
+
+/// Batched UDP receive into a FrameRing.
+///
+/// Ground-station front ends forward one CADU per datagram. Each
+/// receive() call hands the kernel one iovec per free ring slot through
+/// recvmmsg, so a DSN burst lands in the ring with one syscall per batch
+/// and no intermediate buffer.
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/uio.h>
+
+#include "solarlens/ingest/frame_ring.hpp"
+
+namespace solarlens::ingest {
+
+struct UdpReceiverStats {
+    std::uint64_t datagrams = 0;
+    std::uint64_t bytes = 0;
+    std::uint64_t truncated = 0; ///< Datagrams larger than a slot, dropped.
+    std::uint64_t syscalls = 0;
+};
+
+class UdpReceiver {
+public:
+    /// Binds to `address`:`port`; port 0 picks an ephemeral port.
+    UdpReceiver(const std::string& address, std::uint16_t port,
+                int receive_buffer_bytes = 8 << 20);
+    ~UdpReceiver();
+
+    UdpReceiver(const UdpReceiver&) = delete;
+    UdpReceiver& operator=(const UdpReceiver&) = delete;
+
+    int fd() const noexcept { return fd_; }
+    std::uint16_t port() const noexcept { return port_; }
+
+    /// Receives up to min(ring.writable(), max_batch) datagrams and commits
+    /// them. `timeout_ms` < 0 blocks until data arrives, 0 polls. Returns
+    /// the number of slots committed.
+    std::size_t receive(FrameRing& ring, int timeout_ms = -1, std::size_t max_batch = 64);
+
+    const UdpReceiverStats& stats() const noexcept { return stats_; }
+
+private:
+    int fd_ = -1;
+    std::uint16_t port_ = 0;
+    UdpReceiverStats stats_;
+    std::vector<iovec> iov_;    ///< One per ring slot.
+    std::vector<mmsghdr> msgs_; ///< Their message headers.
+};
+
+} // namespace solarlens::ingest
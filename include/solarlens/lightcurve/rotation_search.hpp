@@ -0,0 +1,134 @@
+#pragma once
+
+/// Rotation period and spin-axis search over time-resolved photometry.
+///
+/// A rotating planet's reflected light varies with the surface longitude
+/// under the illuminated, visible part of the disc. That part is centred
+/// near the bisector of the star and observer directions, which moves
+/// across the planet as it orbits, so the longitude under it is
+///
+///     Phi(t) = 2 pi f t - phi_k(t; spin axis),
+///
+/// with phi_k the bisector's longitude in the planet's equatorial frame,
+/// and the modulation is damped by cos delta_k(t) per harmonic, delta_k
+/// being its latitude. For a trial rotation frequency f and spin axis
+/// (obliquity from the orbit normal, azimuth from the observer's side of
+/// the orbit) the light curve is fitted by weighted least squares with
+///
+///     F(t) = c0 + c1 g(t) + g(t) sum_k cos^k delta_k (a_k cos k Phi + b_k sin k Phi),
+///
+/// g being the Lambert phase function: a multi-harmonic generalized
+/// Lomb-Scargle in the planet's own longitude. The score of a trial is the
+/// fraction of the fixed model's chi^2 the harmonics remove.
+///
+/// The harmonic normal equations are accumulated by runtime-dispatched SIMD
+/// kernels that step every observation's phasor from one trial frequency
+/// to the next by complex multiplication, so the inner loop has no
+/// trigonometry. The search is coarse to fine: every axis is scored on a
+/// grid of spacing 1 / baseline, cells scoring below `refine_fraction` of
+/// the best coarse cell are pruned, and only the survivors are scanned at
+/// the full oversampled spacing. Peaks are then polished off the grid by
+/// parabolic steps in frequency, since a strong detection is sharper than
+/// the fine spacing and the grid would otherwise pick the axis. Axes run as scheduler tasks, and
+/// search_batch() runs many light curves at once.
+///
+/// Time is in days, frequency in cycles per day; periods are reported in
+/// hours. Flux may come from disc-integrated photometry or from summing
+/// each epoch's reconstructed map.
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "solarlens/core/simd.hpp"
+
+namespace solarlens::sched {
+class Scheduler;
+}
+
+namespace solarlens::lightcurve {
+
+struct FluxSample {
+    double t_days = 0.0;
+    double flux = 0.0;
+    double sigma = 0.0;   ///< Must be positive.
+};
+
+/// Circular orbit seen from a distant observer.
+struct OrbitGeometry {
+    double period_days = 365.25;
+    double inclination_rad = 1.0471975511965976;  ///< 0 face-on, pi/2 edge-on.
+    double phase_rad = 0.0;  ///< Orbital longitude at t = 0; 0 is inferior conjunction.
+};
+
+struct LightCurve {
+    std::span<const FluxSample> samples;
+    OrbitGeometry orbit;
+};
+
+struct RotationSearchConfig {
+    double min_period_hours = 4.0;
+    double max_period_hours = 100.0;
+    double oversample = 10.0;            ///< Fine grid spacing is 1 / (oversample * baseline).
+    std::uint32_t harmonics = 2;         ///< 1 to 4.
+    std::uint32_t obliquity_steps = 7;   ///< Both poles included.
+    std::uint32_t azimuth_steps = 8;     ///< Over [0, 2 pi).
+    double refine_fraction = 0.5;        ///< 0 scans every axis at full resolution.
+    std::uint32_t candidates = 3;        ///< Distinct periods reported.
+    core::SimdLevel simd = core::best_simd_level();
+
+    /// Throws std::invalid_argument for unusable values.
+    void validate() const;
+};
+
+struct RotationCandidate {
+    double period_hours = 0.0;
+    double obliquity_rad = 0.0;
+    double azimuth_rad = 0.0;
+    double power = 0.0;   ///< Fraction of the fixed model's chi^2 removed.
+};
+
+struct RotationSearchStats {
+    std::uint64_t coarse_trials = 0;
+    std::uint64_t fine_trials = 0;
+    std::uint64_t exhaustive_trials = 0;  ///< Fine trials over every axis, for comparison.
+};
+
+struct RotationSearchResult {
+    std::vector<RotationCandidate> candidates;  ///< Best first, at least 1 / baseline apart.
+    /// Best power of every axis within a fine step of the best period,
+    /// obliquity-major.
+    std::vector<double> axis_power;
+    RotationSearchStats stats;
+};
+
+class RotationSearch {
+public:
+    /// Throws std::invalid_argument for an unusable config or a SIMD level
+    /// this process cannot run.
+    explicit RotationSearch(const RotationSearchConfig& config = {});
+
+    /// Throws std::invalid_argument for fewer samples than free
+    /// parameters, a non-positive sigma, or a baseline too short for the
+    /// longest period.
+    RotationSearchResult search(const LightCurve& curve, sched::Scheduler& scheduler) const;
+
+    /// search() on every curve, as scheduler tasks.
+    std::vector<RotationSearchResult> search_batch(std::span<const LightCurve> curves,
+                                                   sched::Scheduler& scheduler) const;
+
+    /// Power of a single trial.
+    double power(const LightCurve& curve, double period_hours, double obliquity_rad, double azimuth_rad) const;
+
+    double obliquity(std::size_t step) const noexcept;
+    double azimuth(std::size_t step) const noexcept;
+    const RotationSearchConfig& config() const noexcept { return config_; }
+
+private:
+    struct Prepared;
+
+    RotationSearchConfig config_;
+};
+
+} // namespace solarlens::lightcurve
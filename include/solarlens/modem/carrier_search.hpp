@@ -0,0 +1,49 @@
+#pragma once
+
+/// FFT carrier search over Doppler bins.
+///
+/// The capture is cut into blocks of `fft_size` samples; each block is
+/// one coherent integration, transformed with the cached-plan FFT, and the
+/// bin powers of all blocks are summed incoherently. Blocks are split into
+/// a fixed number of chunks accumulated in parallel on the scheduler and
+/// reduced in chunk order, so the spectrum is the same for any worker
+/// count. The strongest separated peaks within the Doppler window come
+/// back as candidates, frequency refined by parabolic interpolation.
+
+#include <complex>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace solarlens::sched {
+class Scheduler;
+}
+
+namespace solarlens::modem {
+
+struct CarrierSearchConfig {
+    double sample_rate_hz = 65536.0;
+    std::size_t fft_size = 8192;          ///< Power of two.
+    double max_doppler_hz = 16000.0;      ///< Searched window is +/- this.
+    std::size_t candidates = 8;
+    std::size_t min_separation_bins = 4;
+
+    /// Throws std::invalid_argument for a non-power-of-two FFT or an
+    /// empty window.
+    void validate() const;
+};
+
+struct CarrierCandidate {
+    double frequency_hz = 0.0;
+    double power = 0.0;            ///< Summed bin power.
+    /// Peak excess over the median bin in noise standard deviations;
+    /// about 5 and above is a detection rather than noise.
+    double significance = 0.0;
+};
+
+/// Candidates strongest first. Throws std::invalid_argument if `samples`
+/// holds less than one block.
+std::vector<CarrierCandidate> search_carrier(std::span<const std::complex<float>> samples,
+                                             const CarrierSearchConfig& config, sched::Scheduler& scheduler);
+
+} // namespace solarlens::modem
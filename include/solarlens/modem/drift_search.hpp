@@ -0,0 +1,96 @@
+#pragma once
+
+/// Narrowband drift search (tree de-Doppler) over high-resolution
+/// spectrograms, for technosignatures seen through the lens.
+///
+/// A transmitter's tone drifts linearly in frequency as the bodies
+/// accelerate relative to each other. DriftSearcher takes integrated power
+/// spectra one time step at a time and, for every block of `time_steps`
+/// of them, sums each straight path (start channel, drift) through the
+/// block with the Taylor tree: log2(time_steps) passes of vector row
+/// additions instead of one sum per path and step, in runtime-dispatched
+/// SIMD kernels. Drifts of both signs up to max_drift_hz_per_s are
+/// searched. The channels are split into chunks searched in parallel on
+/// the scheduler. Each chunk's noise level comes from the median and MAD
+/// of its zero-drift sums, so a sloping bandpass sets its own threshold.
+///
+/// A completed block yields its hits at once: paths whose sum exceeds the
+/// chunk's noise by snr_threshold deviations, keeping only the strongest
+/// within max-drift channels of each other, strongest first. Blocks do not
+/// overlap, so a signal is reported once per block it crosses. The Taylor
+/// paths are piecewise approximations of straight lines, exact in the first
+/// and last step.
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "solarlens/core/simd.hpp"
+
+namespace solarlens::sched {
+class Scheduler;
+}
+
+namespace solarlens::modem {
+
+struct DriftSearchConfig {
+    std::size_t channels = std::size_t(1) << 20;
+    std::size_t time_steps = 32;        ///< Spectra per block; a power of two.
+    double channel_hz = 2.79;           ///< Fine-channel width.
+    double step_s = 1.0;                ///< Time between spectra.
+    double first_channel_hz = 0.0;      ///< Frequency of channel 0.
+    /// Searched range is +/- this; at most one channel per step.
+    double max_drift_hz_per_s = 2.0;
+    double snr_threshold = 10.0;
+    std::size_t max_hits_per_block = 256;
+    core::SimdLevel simd = core::best_simd_level();
+    /// Search chunks concurrently on this scheduler; null searches on the
+    /// calling thread.
+    sched::Scheduler* scheduler = nullptr;
+
+    /// Throws std::invalid_argument for unusable values.
+    void validate() const;
+
+    /// Largest searched drift, in channels over one block.
+    std::size_t max_drift_channels() const noexcept;
+};
+
+struct DriftHit {
+    std::uint64_t block = 0;
+    double time_s = 0.0;       ///< Start of the block, from the first spectrum.
+    std::size_t channel = 0;   ///< In the block's first spectrum.
+    double frequency_hz = 0.0; ///< At the start of the block.
+    double drift_hz_per_s = 0.0;
+    double snr = 0.0;          ///< Path sum over the chunk median, in MAD deviations.
+};
+
+class DriftSearcher {
+public:
+    /// Throws std::invalid_argument for an unusable config or a SIMD level
+    /// this process cannot run.
+    explicit DriftSearcher(const DriftSearchConfig& config);
+
+    /// Appends the next spectrum (config().channels powers). When it
+    /// completes a block, searches the block and returns its hits;
+    /// otherwise returns none. Throws std::invalid_argument for a spectrum
+    /// of the wrong size.
+    std::vector<DriftHit> push(std::span<const float> spectrum);
+
+    /// Blocks searched so far.
+    std::uint64_t blocks() const noexcept { return blocks_; }
+    /// Spectra held towards the next block.
+    std::size_t pending() const noexcept { return filled_; }
+
+    const DriftSearchConfig& config() const noexcept { return config_; }
+
+private:
+    std::vector<DriftHit> search_block();
+
+    DriftSearchConfig config_;
+    std::vector<float> block_; ///< time_steps x channels.
+    std::size_t filled_ = 0;
+    std::uint64_t blocks_ = 0;
+};
+
+} // namespace solarlens::modem
@@ -0,0 +1,64 @@
+#pragma once
+
+/// Quasi-cyclic LDPC codes for the deep-space link.
+///
+/// `quasi_cyclic` builds a J x K grid of p x p circulants, block (i, j)
+/// the identity cyclically shifted by s(i, j), with column weight J and
+/// row weight K. The shifts come from a seeded search that rejects any
+/// choice closing a 4- or 6-cycle, so the Tanner graph has girth 8,
+/// which layered min-sum needs to avoid the low-weight codewords of the
+/// algebraic (array) constructions. H is usually rank-deficient, so the
+/// encoder is derived by Gaussian elimination: pivot columns carry parity
+/// and the rest carry information bits.
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace solarlens::modem {
+
+class LdpcCode {
+public:
+    /// The same seed always gives the same code. Throws
+    /// std::invalid_argument unless 2 <= column_weight < row_weight <= p / 2,
+    /// or if the search finds no girth-8 shifts for this p.
+    static LdpcCode quasi_cyclic(std::uint32_t p = 127, std::uint32_t column_weight = 3,
+                                 std::uint32_t row_weight = 6, std::uint64_t seed = 1);
+
+    std::size_t n() const noexcept { return n_; }
+    std::size_t k() const noexcept { return info_columns_.size(); }
+    std::size_t checks() const noexcept { return row_start_.size() - 1; }
+    double rate() const noexcept { return double(k()) / double(n_); }
+
+    /// Check rows as CSR: row r covers columns[row_start[r], row_start[r + 1]).
+    std::span<const std::uint32_t> row_start() const noexcept { return row_start_; }
+    std::span<const std::uint32_t> columns() const noexcept { return columns_; }
+
+    /// Codeword positions holding information bits, ascending.
+    std::span<const std::uint32_t> info_columns() const noexcept { return info_columns_; }
+
+    /// k information bits (0/1 bytes) to an n-bit codeword.
+    void encode(std::span<const std::uint8_t> info, std::span<std::uint8_t> codeword) const;
+
+    /// Copies the information bits back out of a codeword.
+    void extract(std::span<const std::uint8_t> codeword, std::span<std::uint8_t> info) const;
+
+    /// True if every parity check is satisfied.
+    bool satisfied(std::span<const std::uint8_t> codeword) const noexcept;
+
+private:
+    LdpcCode() = default;
+    void derive_encoder();
+
+    std::size_t n_ = 0;
+    std::vector<std::uint32_t> row_start_;
+    std::vector<std::uint32_t> columns_;
+    std::vector<std::uint32_t> info_columns_;
+    /// Per parity bit: its column and the info-bit mask (k bits, packed).
+    std::vector<std::uint32_t> parity_columns_;
+    std::vector<std::uint64_t> parity_masks_;
+    std::size_t mask_words_ = 0;
+};
+
+} // namespace solarlens::modem
@@ -0,0 +1,65 @@
+#pragma once
+
+/// Batched layered min-sum LDPC decoding.
+///
+/// Codewords are decoded sixteen at a time in interleaved blocks, one
+/// codeword per SIMD lane, so a check-node update is a straight-line
+/// vector sequence with no per-codeword branching; the kernels are
+/// runtime-dispatched like the other SIMD paths. Blocks are independent
+/// and spread over the scheduler when one is given. Each block stops as
+/// soon as all of its lanes satisfy every check; a lane's result is
+/// frozen at the iteration it first does.
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "solarlens/core/simd.hpp"
+#include "solarlens/modem/ldpc.hpp"
+
+namespace solarlens::sched {
+class Scheduler;
+}
+
+namespace solarlens::modem {
+
+struct DecoderConfig {
+    std::size_t max_iterations = 50;
+    float scale = 0.75f;            ///< Normalisation of min-sum magnitudes.
+    core::SimdLevel simd = core::best_simd_level();
+};
+
+struct DecodeStatus {
+    bool converged = false;
+    std::uint16_t iterations = 0;
+};
+
+class BatchDecoder {
+public:
+    /// Codewords per interleaved block.
+    static constexpr std::size_t block_size = 16;
+
+    /// Keeps a reference to `code`. Throws std::invalid_argument for a
+    /// SIMD level this process cannot run or a check row too wide for the
+    /// kernels.
+    explicit BatchDecoder(const LdpcCode& code, const DecoderConfig& config = {});
+
+    /// Decodes status.size() codewords. `llr` holds n() channel LLRs per
+    /// codeword (positive favours 0), `bits` receives n() hard decisions
+    /// per codeword.
+    void decode(std::span<const float> llr, std::span<std::uint8_t> bits,
+                std::span<DecodeStatus> status) const;
+    void decode(std::span<const float> llr, std::span<std::uint8_t> bits, std::span<DecodeStatus> status,
+                sched::Scheduler& scheduler) const;
+
+    const LdpcCode& code() const noexcept { return *code_; }
+    const DecoderConfig& config() const noexcept { return config_; }
+
+private:
+    void decode_block(const float* llr, std::uint8_t* bits, DecodeStatus* status, std::size_t count) const;
+
+    const LdpcCode* code_;
+    DecoderConfig config_;
+};
+
+} // namespace solarlens::modem
@@ -0,0 +1,44 @@
+#pragma once
+
+/// Residual-carrier BPSK for the weak-signal link.
+///
+/// Each symbol is a phase step of +/- beta radians around a carrier:
+/// s(t) = exp(j (2 pi f t + phi + beta d_k)), d_k = 1 - 2 bit. With beta
+/// below pi / 2 a fraction cos^2(beta) of the power stays in an unmodulated
+/// carrier line, which the receiver finds with an FFT search and then uses
+/// as its phase reference, so no Costas loop has to lock at an SNR where
+/// it cannot. Symbols are rectangular and `samples_per_symbol` long.
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace solarlens::modem {
+
+struct WaveformConfig {
+    double sample_rate_hz = 65536.0;
+    std::size_t samples_per_symbol = 16;
+    double modulation_index = 1.0;       ///< beta, radians.
+    /// Symbols per carrier-phase estimate; phases are interpolated
+    /// between segment centres, which tracks a residual frequency error.
+    std::size_t phase_segment = 128;
+
+    /// Throws std::invalid_argument for a non-physical configuration.
+    void validate() const;
+};
+
+/// Writes bits.size() * samples_per_symbol samples of unit amplitude.
+void modulate(std::span<const std::uint8_t> bits, const WaveformConfig& config, double frequency_hz,
+              double phase, std::span<std::complex<float>> out);
+
+/// Coherently demodulates llr.size() symbols from `samples` at carrier
+/// `frequency_hz`: mixes down, integrates each symbol, tracks carrier
+/// phase from the residual carrier, and writes channel LLRs (positive
+/// favours 0) scaled by the estimated noise. Returns the estimated
+/// symbol SNR Es/N0 (linear); 0, with all-zero LLRs, if the symbols
+/// carry no detectable data power.
+double demodulate(std::span<const std::complex<float>> samples, const WaveformConfig& config,
+                  double frequency_hz, std::span<float> llr);
+
+} // namespace solarlens::modem
@@ -0,0 +1,127 @@
+#pragma once
+
+/// Relative navigation and baseline determination for the swarm.
+///
+/// Each deputy craft is estimated relative to the chief (craft 0 of the
+/// interferometer) with a 9-element state: relative position (km),
+/// relative velocity (km/s) and a constant-plus-random-walk differential
+/// acceleration (km/s^2) that absorbs differential radiation pressure and
+/// thruster leaks. Relative motion is linear at 650 AU: the only coupling
+/// is the solar gravity gradient at the chief, GM/r^3 (3 r r^T - I), which
+/// over a month bends a 100 km baseline by a fraction of a millimetre and
+/// so must be modelled.
+///
+/// All deputies run in one UdFilterBatch<9>. They share the transition
+/// matrix and process noise, so an epoch is one batched time update, then
+/// one batched Bierman update per observation a deputy has at that epoch.
+/// Observables are chief-to-deputy range and range rate from inter-craft
+/// ranging and azimuth and elevation of the deputy in the chief's star
+/// camera, all in the heliocentric ecliptic J2000 axes of nav; nonlinear
+/// ones are linearized about the current estimate (extended filter).
+///
+/// Time is seconds since the filter's epoch. Baselines between deputies
+/// are differences of their relative states; the deputies' filters are
+/// independent given the chief, so their covariances add.
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "solarlens/nav/ephemeris.hpp"
+#include "solarlens/nav/ud_filter.hpp"
+
+namespace solarlens::nav {
+
+enum class Observable : std::uint8_t { range, range_rate, azimuth, elevation };
+
+const char* to_string(Observable kind) noexcept;
+
+struct BaselineObservation {
+    double t = 0.0;                   ///< Seconds since the filter epoch.
+    std::uint32_t deputy = 0;         ///< Filter index, not craft id.
+    Observable kind = Observable::range;
+    double value = 0.0;               ///< km, km/s or rad.
+    double sigma = 0.0;               ///< Same units as value.
+};
+
+struct RelativeState {
+    Vec3 position_km {};
+    Vec3 velocity_km_s {};
+};
+
+struct BaselineFilterConfig {
+    Vec3 chief_position_au {650.0, 0.0, 0.0};  ///< Heliocentric; sets the gravity gradient.
+    double acceleration_psd = 1e-24;            ///< White acceleration noise, km^2/s^3.
+    double bias_psd = 1e-36;                    ///< Bias random walk, km^2/s^5.
+    double position_sigma_km = 0.1;             ///< Prior, per axis.
+    double velocity_sigma_km_s = 1e-6;          ///< Prior, per axis.
+    double bias_sigma_km_s2 = 1e-12;            ///< Prior, per axis.
+    double gate_sigma = 5.0;                    ///< 0 disables outlier rejection.
+
+    /// Throws std::invalid_argument for a chief at the Sun, negative noise
+    /// or gate, or a non-positive prior.
+    void validate() const;
+};
+
+struct BaselineEstimate {
+    RelativeState state;
+    Vec3 bias_km_s2 {};
+    Vec3 position_sigma_km {};
+    Vec3 velocity_sigma_km_s {};
+};
+
+struct BaselineFilterStats {
+    std::uint64_t epochs = 0;
+    std::uint64_t observations = 0;
+    std::uint64_t rejected = 0;
+};
+
+class BaselineFilter {
+public:
+    static constexpr std::size_t state_size = 9;
+
+    /// One filter per entry of `deputies`, started at time 0 with the
+    /// config's prior about the given relative states.
+    BaselineFilter(const BaselineFilterConfig& config, std::span<const RelativeState> deputies);
+
+    /// Filters `observations`, which must be sorted by time and not
+    /// earlier than time(). Observations sharing a time form one epoch.
+    /// Throws std::invalid_argument for unsorted or past observations or a
+    /// non-positive sigma and std::out_of_range for an unknown deputy.
+    void process(std::span<const BaselineObservation> observations);
+
+    /// Propagates every filter to `t` without observations.
+    void advance(double t);
+
+    /// Model value of `kind` for `state`: the function process() linearizes.
+    static double predicted(Observable kind, const RelativeState& state) noexcept;
+
+    /// Transition matrix over `dt` seconds for a chief at `chief_au`.
+    static Matrix<state_size, state_size> transition(const Vec3& chief_au, double dt) noexcept;
+
+    BaselineEstimate estimate(std::size_t deputy) const;
+
+    /// Deputy `j` minus deputy `i`, km, and its per-axis sigma.
+    Vec3 baseline_km(std::size_t i, std::size_t j) const;
+    Vec3 baseline_sigma_km(std::size_t i, std::size_t j) const;
+
+    std::size_t size() const noexcept { return filters_.size(); }
+    double time() const noexcept { return time_; }
+    const BaselineFilterStats& stats() const noexcept { return stats_; }
+    const BaselineFilterConfig& config() const noexcept { return config_; }
+
+private:
+    void epoch(std::span<const BaselineObservation> observations);
+
+    BaselineFilterConfig config_;
+    UdFilterBatch<state_size> filters_;
+    double time_ = 0.0;
+    BaselineFilterStats stats_;
+    // Per-lane update scratch, filters_.stride() wide.
+    std::vector<double> h_, innovation_, variance_;
+    std::vector<std::uint8_t> active_;
+    std::vector<std::uint32_t> cursor_;
+};
+
+} // namespace solarlens::nav
@@ -0,0 +1,36 @@
+#pragma once
+
+/// Low-precision planetary ephemeris from osculating Keplerian elements.
+///
+/// Mean elements and their secular rates are JPL's "Approximate Positions
+/// of the Planets" (Standish), good to a few thousand kilometres for the
+/// inner planets and better than 1e-3 AU for the giants over 1800-2050.
+/// At 650 AU the planets are perturbations of order 1e-3 of solar gravity,
+/// so this is ample for navigation and Monte Carlo planning.
+///
+/// Units throughout nav: AU, days, heliocentric ecliptic J2000 frame, time
+/// in days since J2000.0 (TDB).
+
+#include <array>
+#include <cstddef>
+
+namespace solarlens::nav {
+
+/// GM of the Sun, AU^3 / day^2 (Gaussian constant squared).
+inline constexpr double sun_gm = 2.959122082855911e-4;
+
+enum class Planet { mercury, venus, earth_moon, mars, jupiter, saturn, uranus, neptune };
+
+inline constexpr std::size_t planet_count = 8;
+
+using Vec3 = std::array<double, 3>;
+
+const char* to_string(Planet planet) noexcept;
+
+/// GM of `planet` (for Earth, the Earth-Moon system), AU^3 / day^2.
+double planet_gm(Planet planet) noexcept;
+
+/// Heliocentric position of `planet` at `t` days since J2000, AU.
+Vec3 planet_position(Planet planet, double t) noexcept;
+
+} // namespace solarlens::nav
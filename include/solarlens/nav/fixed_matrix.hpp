@@ -0,0 +1,120 @@
+#pragma once
+
+/// Fixed-size dense matrices for navigation filters.
+///
+/// Dimensions are template parameters, so every loop has a compile-time
+/// trip count the optimizer unrolls, storage is an inline std::array, and
+/// a dimension mismatch is a compile error. Row-major, doubles only: this
+/// is the handful of operations the filters need, not a linear algebra
+/// library.
+
+#include <array>
+#include <cstddef>
+
+namespace solarlens::nav {
+
+template <std::size_t R, std::size_t C>
+struct Matrix {
+    static constexpr std::size_t rows = R;
+    static constexpr std::size_t cols = C;
+
+    std::array<double, R * C> a {};
+
+    static constexpr Matrix zero() noexcept { return {}; }
+    static constexpr Matrix identity() noexcept
+        requires(R == C)
+    {
+        Matrix m;
+        for (std::size_t i = 0; i < R; ++i)
+            m(i, i) = 1.0;
+        return m;
+    }
+
+    constexpr double& operator()(std::size_t i, std::size_t j) noexcept { return a[i * C + j]; }
+    constexpr double operator()(std::size_t i, std::size_t j) const noexcept { return a[i * C + j]; }
+
+    /// Element access for column vectors.
+    constexpr double& operator[](std::size_t i) noexcept
+        requires(C == 1)
+    {
+        return a[i];
+    }
+    constexpr double operator[](std::size_t i) const noexcept
+        requires(C == 1)
+    {
+        return a[i];
+    }
+
+    /// Copies `b` into the block whose top-left corner is (i0, j0).
+    template <std::size_t BR, std::size_t BC>
+    constexpr void set_block(std::size_t i0, std::size_t j0, const Matrix<BR, BC>& b) noexcept
+    {
+        for (std::size_t i = 0; i < BR; ++i)
+            for (std::size_t j = 0; j < BC; ++j)
+                (*this)(i0 + i, j0 + j) = b(i, j);
+    }
+
+    constexpr Matrix<C, R> transpose() const noexcept
+    {
+        Matrix<C, R> t;
+        for (std::size_t i = 0; i < R; ++i)
+            for (std::size_t j = 0; j < C; ++j)
+                t(j, i) = (*this)(i, j);
+        return t;
+    }
+
+    constexpr Matrix& operator+=(const Matrix& b) noexcept
+    {
+        for (std::size_t i = 0; i < R * C; ++i)
+            a[i] += b.a[i];
+        return *this;
+    }
+    constexpr Matrix& operator-=(const Matrix& b) noexcept
+    {
+        for (std::size_t i = 0; i < R * C; ++i)
+            a[i] -= b.a[i];
+        return *this;
+    }
+    constexpr Matrix& operator*=(double s) noexcept
+    {
+        for (double& v : a)
+            v *= s;
+        return *this;
+    }
+};
+
+template <std::size_t N>
+using Vector = Matrix<N, 1>;
+
+template <std::size_t R, std::size_t C>
+constexpr Matrix<R, C> operator+(Matrix<R, C> a, const Matrix<R, C>& b) noexcept
+{
+    return a += b;
+}
+
+template <std::size_t R, std::size_t C>
+constexpr Matrix<R, C> operator-(Matrix<R, C> a, const Matrix<R, C>& b) noexcept
+{
+    return a -= b;
+}
+
+template <std::size_t R, std::size_t C>
+constexpr Matrix<R, C> operator*(double s, Matrix<R, C> a) noexcept
+{
+    return a *= s;
+}
+
+template <std::size_t R, std::size_t K, std::size_t C>
+constexpr Matrix<R, C> operator*(const Matrix<R, K>& a, const Matrix<K, C>& b) noexcept
+{
+    Matrix<R, C> m;
+    for (std::size_t i = 0; i < R; ++i)
+        for (std::size_t k = 0; k < K; ++k) {
+            const double aik = a(i, k);
+            for (std::size_t j = 0; j < C; ++j)
+                m(i, j) += aik * b(k, j);
+        }
+    return m;
+}
+
+} // namespace solarlens::nav
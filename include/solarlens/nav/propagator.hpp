@@ -0,0 +1,123 @@
+#pragma once
+
+/// Swarm trajectory propagation under solar and planetary gravity and
+/// solar radiation pressure.
+///
+/// State is structure-of-arrays, one array per coordinate, so force
+/// evaluation runs across spacecraft in SIMD lanes (runtime-dispatched
+/// like the corona kernels) and planet positions are computed once per
+/// integrator stage for the whole swarm. Integration is fixed-step RK4,
+/// which at 650 AU, where the dynamics are nearly Keplerian and slow, is
+/// accurate to metres per year with a step of a day.
+///
+/// SRP is modelled as a cannonball: acceleration P0 Cr A/m (1 AU / r)^2
+/// along the Sun-craft line, which folds into a per-craft reduction of the
+/// Sun's GM.
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+#include "solarlens/core/simd.hpp"
+#include "solarlens/nav/ephemeris.hpp"
+
+namespace solarlens::core {
+class Snapshot;
+class SnapshotWriter;
+}
+
+namespace solarlens::sched {
+class Scheduler;
+}
+
+namespace solarlens::nav {
+
+struct StateVector {
+    Vec3 r {}; ///< AU.
+    Vec3 v {}; ///< AU / day.
+};
+
+class SwarmState {
+public:
+    SwarmState() = default;
+    explicit SwarmState(std::size_t count) { resize(count); }
+
+    void resize(std::size_t count);
+    std::size_t size() const noexcept { return x.size(); }
+
+    StateVector get(std::size_t i) const noexcept
+    {
+        return {{x[i], y[i], z[i]}, {vx[i], vy[i], vz[i]}};
+    }
+    void set(std::size_t i, const StateVector& s, double cr_area_mass = 0.0) noexcept;
+
+    /// Appends every craft of `other`.
+    void append(const SwarmState& other);
+
+    std::vector<double> x, y, z;
+    std::vector<double> vx, vy, vz;
+    std::vector<double> cr_area_mass; ///< Cr * A / m, m^2 / kg.
+};
+
+/// Writes `state` as snapshot section `section`.
+void snapshot_swarm(const SwarmState& state, core::SnapshotWriter& writer, std::string_view section);
+
+/// Reads back a state written by snapshot_swarm(); throws
+/// std::runtime_error if the section is missing or malformed.
+SwarmState restore_swarm(const core::Snapshot& snapshot, std::string_view section);
+
+struct PropagatorConfig {
+    double step_days = 1.0;
+    bool planets = true;
+    bool radiation_pressure = true;
+    core::SimdLevel simd = core::best_simd_level();
+};
+
+class Propagator {
+public:
+    /// Throws std::invalid_argument for a non-positive step or a SIMD
+    /// level this process cannot run.
+    explicit Propagator(const PropagatorConfig& config = {});
+
+    /// Advances `state` from `t0` to `t1` (days since J2000; t1 < t0
+    /// integrates backwards). The step is shrunk uniformly so a whole
+    /// number of steps lands on t1.
+    void propagate(SwarmState& state, double t0, double t1) const;
+
+    /// Acceleration of every craft at time `t`, AU / day^2.
+    void acceleration(const SwarmState& state, double t, std::vector<double>& ax,
+                      std::vector<double>& ay, std::vector<double>& az) const;
+
+    const PropagatorConfig& config() const noexcept { return config_; }
+
+private:
+    PropagatorConfig config_;
+};
+
+/// Monte Carlo dispersions of a nominal swarm.
+struct DispersionConfig {
+    std::size_t cases = 1000;
+    double position_sigma_km = 10.0;      ///< Per axis.
+    double velocity_sigma_mm_s = 1.0;     ///< Per axis.
+    double cr_area_mass_sigma = 0.05;     ///< Fractional.
+    std::uint64_t seed = 1;
+    std::size_t cases_per_task = 0;       ///< 0 picks by swarm size.
+};
+
+/// Propagates `config.cases` perturbed copies of `nominal` from `t0` to
+/// `t1` on `scheduler`. Cases are batched so each task integrates several
+/// of them as one wide swarm. Returns the final states, case-major: craft
+/// j of case k is element k * nominal.size() + j. Results depend only on
+/// the seed, not on the worker count.
+SwarmState propagate_dispersions(const Propagator& propagator, const SwarmState& nominal,
+                                 double t0, double t1, const DispersionConfig& config,
+                                 sched::Scheduler& scheduler);
+
+/// Kilometres between `r` and the focal line behind the Sun for a target
+/// in unit direction `target` (the ray from the Sun away from it).
+double focal_line_offset_km(const Vec3& r, const Vec3& target) noexcept;
+
+inline constexpr double au_km = 1.495978707e8;
+
+} // namespace solarlens::nav
@@ -0,0 +1,66 @@
+#pragma once
+
+/// Snapshots and export of instrumentation data.
+///
+/// snapshot() merges every thread's buffers, live and exited, into one
+/// histogram per stage and one total per counter. write_prometheus() emits
+/// the Prometheus text exposition format: each stage as a summary with
+/// quantiles in seconds, each counter as `<prefix>_<name>_total`.
+/// write_chrome_trace() emits the Chrome trace-event JSON that
+/// chrome://tracing and ui.perfetto.dev open, one complete ("X") event per
+/// traced ScopedTimer and one track per thread.
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "solarlens/perf/histogram.hpp"
+
+namespace solarlens::perf {
+
+struct StageSnapshot {
+    std::string name;
+    HdrHistogram nanoseconds;
+};
+
+struct CounterSnapshot {
+    std::string name;
+    std::uint64_t value = 0;
+};
+
+struct Snapshot {
+    std::vector<StageSnapshot> stages;     ///< In registration order.
+    std::vector<CounterSnapshot> counters; ///< In registration order.
+
+    /// Null if no stage has this name.
+    const StageSnapshot* stage(std::string_view name) const noexcept;
+    const CounterSnapshot* counter(std::string_view name) const noexcept;
+};
+
+struct TraceEvent {
+    std::uint32_t stage = 0;
+    std::uint32_t thread = 0;
+    std::uint64_t start_ns = 0;
+    std::uint64_t duration_ns = 0;
+};
+
+struct Trace {
+    std::vector<std::string> stage_names;
+    std::vector<std::string> thread_names; ///< Indexed by TraceEvent::thread.
+    std::vector<TraceEvent> events;        ///< Sorted by start time.
+};
+
+Snapshot snapshot();
+
+/// Copies out the events still held in each thread's trace buffer.
+Trace collect_trace();
+
+/// Clears every histogram, counter and trace buffer.
+void reset();
+
+void write_prometheus(const Snapshot& snapshot, std::ostream& out, std::string_view prefix = "solarlens");
+void write_chrome_trace(const Trace& trace, std::ostream& out);
+
+} // namespace solarlens::perf
@@ -0,0 +1,102 @@
+#pragma once
+
+/// High-dynamic-range latency histogram.
+///
+/// Log-linear buckets in the style of HdrHistogram: values below 2^7 are
+/// counted exactly, and above that every power-of-two range is split into
+/// 64 equal buckets, so any recorded value is known to within 1/64 (1.6%)
+/// from 1 ns up to 2^44 ns (about 4.9 hours). The bucket index is a
+/// bit_width and a shift, cheap enough for every hot-path sample. This
+/// type is single-threaded; perf::Stage keeps one per thread and merges
+/// them on export.
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+
+namespace solarlens::perf {
+
+class HdrHistogram {
+public:
+    static constexpr unsigned sub_bucket_bits = 7;
+    static constexpr unsigned max_value_bits = 44;
+    static constexpr std::uint64_t max_value = (std::uint64_t {1} << max_value_bits) - 1;
+    static constexpr std::size_t bucket_count =
+        (std::size_t {1} << (sub_bucket_bits - 1)) * (max_value_bits - sub_bucket_bits)
+        + (std::size_t {1} << sub_bucket_bits);
+
+    /// Bucket holding `value`; values above max_value share the last one.
+    static constexpr std::size_t index_of(std::uint64_t value) noexcept
+    {
+        constexpr std::uint64_t exact = std::uint64_t {1} << sub_bucket_bits;
+        value = std::min(value, max_value);
+        if (value < exact)
+            return static_cast<std::size_t>(value);
+        const unsigned shift = static_cast<unsigned>(std::bit_width(value)) - sub_bucket_bits;
+        return (std::size_t {1} << (sub_bucket_bits - 1)) * shift + static_cast<std::size_t>(value >> shift);
+    }
+
+    /// Smallest and largest value counted in bucket `index`.
+    static constexpr std::uint64_t lowest_in(std::size_t index) noexcept
+    {
+        constexpr std::size_t half = std::size_t {1} << (sub_bucket_bits - 1);
+        if (index < 2 * half)
+            return index;
+        const std::size_t shift = index / half - 1;
+        return std::uint64_t(index - half * shift) << shift;
+    }
+    static constexpr std::uint64_t highest_in(std::size_t index) noexcept
+    {
+        constexpr std::size_t half = std::size_t {1} << (sub_bucket_bits - 1);
+        if (index < 2 * half)
+            return index;
+        return lowest_in(index) + (std::uint64_t {1} << (index / half - 1)) - 1;
+    }
+
+    void record(std::uint64_t value) noexcept { record(value, 1); }
+    void record(std::uint64_t value, std::uint64_t times) noexcept
+    {
+        counts_[index_of(value)] += times;
+        count_ += times;
+        sum_ += value * times;
+        min_ = std::min(min_, value);
+        max_ = std::max(max_, value);
+    }
+
+    /// Adds raw bucket counts, e.g. from a per-thread recorder.
+    void add_bucket(std::size_t index, std::uint64_t times) noexcept { counts_[index] += times; }
+    void add_totals(std::uint64_t count, std::uint64_t sum, std::uint64_t min, std::uint64_t max) noexcept
+    {
+        count_ += count;
+        sum_ += sum;
+        min_ = std::min(min_, min);
+        max_ = std::max(max_, max);
+    }
+
+    void merge(const HdrHistogram& other) noexcept;
+    void reset() noexcept { *this = HdrHistogram {}; }
+
+    std::uint64_t count() const noexcept { return count_; }
+    std::uint64_t sum() const noexcept { return sum_; }
+    std::uint64_t min() const noexcept { return count_ ? min_ : 0; }
+    std::uint64_t max() const noexcept { return max_; }
+    double mean() const noexcept { return count_ ? double(sum_) / double(count_) : 0.0; }
+
+    /// Highest value equivalent to the q-quantile (q in [0, 1]), clamped
+    /// to the recorded range; 0 when empty.
+    std::uint64_t value_at_quantile(double q) const noexcept;
+
+    const std::array<std::uint64_t, bucket_count>& buckets() const noexcept { return counts_; }
+
+private:
+    std::array<std::uint64_t, bucket_count> counts_ {};
+    std::uint64_t count_ = 0;
+    std::uint64_t sum_ = 0;
+    std::uint64_t min_ = std::numeric_limits<std::uint64_t>::max();
+    std::uint64_t max_ = 0;
+};
+
+} // namespace solarlens::perf
@@ -0,0 +1,86 @@
+#pragma once
+
+/// Hot-path instrumentation: per-stage latency histograms, counters and an
+/// optional event trace.
+///
+/// Stages and counters are named once, typically as function-local
+/// statics, which takes a lock; after that every sample goes to buffers
+/// owned by the recording thread. A thread only ever writes its own
+/// buffers, with relaxed atomic loads and stores rather than read-modify-
+/// write instructions, so recording has no locks, no shared cache lines
+/// and no lock-prefixed operations; a ScopedTimer costs two clock reads and
+/// a bucket increment. Exporters (perf/export.hpp) walk every thread's
+/// buffers under the registry lock and merge them. A thread's totals are
+/// folded into the registry when it exits, so nothing recorded is lost.
+///
+///     static const perf::Stage decode("ingest.decode");
+///     perf::ScopedTimer timer(decode);
+
+#include <cstdint>
+#include <string_view>
+
+namespace solarlens::perf {
+
+/// Registry limits; naming more throws std::length_error.
+inline constexpr std::uint32_t max_stages = 256;
+inline constexpr std::uint32_t max_counters = 256;
+/// Trace events kept per thread; older ones are overwritten.
+inline constexpr std::uint32_t trace_capacity = 1u << 16;
+
+/// Monotonic nanoseconds since the first instrumentation call.
+std::uint64_t now_ns() noexcept;
+
+/// A pipeline stage with a latency histogram. Naming an existing stage
+/// returns the same one, so handles in different files share a histogram.
+class Stage {
+public:
+    explicit Stage(std::string_view name);
+
+    std::uint32_t id() const noexcept { return id_; }
+
+    /// Records one latency sample in nanoseconds.
+    void record(std::uint64_t ns) const noexcept;
+
+private:
+    std::uint32_t id_;
+};
+
+/// A monotonically increasing count, summed over threads on export.
+class Counter {
+public:
+    explicit Counter(std::string_view name);
+
+    std::uint32_t id() const noexcept { return id_; }
+    void add(std::uint64_t n = 1) const noexcept;
+
+private:
+    std::uint32_t id_;
+};
+
+/// Times its own lifetime into `stage`, and traces it if tracing is on.
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const Stage& stage) noexcept
+        : stage_(stage)
+        , start_(now_ns())
+    {
+    }
+    ~ScopedTimer();
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    const Stage& stage_;
+    std::uint64_t start_;
+};
+
+/// Turns trace-event capture on or off for all threads (off by default);
+/// histograms and counters are always recorded.
+void set_tracing(bool enabled) noexcept;
+bool tracing_enabled() noexcept;
+
+/// Names the calling thread in trace exports.
+void set_thread_name(std::string_view name);
+
+} // namespace solarlens::perf
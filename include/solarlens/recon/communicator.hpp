@@ -0,0 +1,70 @@
+#pragma once
+
+/// Message passing between the ranks of a distributed reconstruction.
+///
+/// A Communicator is one rank's view of a fixed group. The solver needs
+/// only two collectives: a sum-allreduce for CG's dot products and a
+/// pairwise exchange of halo strips with the ranks whose blocks overlap its
+/// own ghost ring. The exchange is split into start and finish so interior
+/// work can run while strips are in flight.
+///
+/// Two implementations: make_local_group() runs every rank as a thread of
+/// this process over shared-memory mailboxes, and make_mpi_communicator()
+/// wraps MPI_COMM_WORLD in builds configured with SOLARLENS_WITH_MPI.
+
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace solarlens::recon {
+
+/// One leg of an exchange: `send` goes to `peer`, and `receive` is filled
+/// with what `peer` sent in its matching transfer back to this rank.
+struct HaloTransfer {
+    int peer = 0;
+    std::span<const double> send;
+    std::span<double> receive;
+};
+
+class Communicator {
+public:
+    virtual ~Communicator() = default;
+
+    virtual int rank() const noexcept = 0;
+    virtual int size() const noexcept = 0;
+
+    /// Replaces every element with its sum over all ranks. Collective;
+    /// every rank passes the same number of values.
+    virtual void allreduce_sum(std::span<double> values) = 0;
+
+    /// Posts every transfer. Each peer appears at most once, and each
+    /// side's `send` is the same length as the other's `receive`. All spans
+    /// must stay valid until finish_exchange(); only one exchange may be in
+    /// flight at a time.
+    virtual void start_exchange(std::span<const HaloTransfer> transfers) = 0;
+
+    /// Blocks until every receive of the started exchange has landed.
+    virtual void finish_exchange() = 0;
+
+    virtual void barrier() = 0;
+
+    void exchange(std::span<const HaloTransfer> transfers)
+    {
+        start_exchange(transfers);
+        finish_exchange();
+    }
+};
+
+/// `ranks` communicators sharing one in-process group, indexed by rank.
+/// Each must be driven by its own thread.
+std::vector<std::unique_ptr<Communicator>> make_local_group(int ranks);
+
+/// True if this build can talk to MPI.
+bool mpi_available() noexcept;
+
+/// Communicator over MPI_COMM_WORLD. The caller initialises and finalises
+/// MPI (MPI_THREAD_FUNNELED is enough). Throws std::invalid_argument in
+/// builds without MPI.
+std::unique_ptr<Communicator> make_mpi_communicator();
+
+} // namespace solarlens::recon
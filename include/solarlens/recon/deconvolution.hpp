@@ -0,0 +1,74 @@
+#pragma once
+
+/// Streaming, bounded-memory Einstein-ring deconvolution.
+///
+/// run() makes one pass over the input sample file to bin samples into
+/// per-tile scratch buckets, then solves each tile independently and writes
+/// its interior straight into the output map file. Neither the convolution
+/// matrix nor the full map is ever resident; peak memory is fixed by
+/// `memory_budget_bytes` whatever the sample count.
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#include "solarlens/recon/psf_kernel.hpp"
+#include "solarlens/recon/tile_plan.hpp"
+#include "solarlens/recon/tile_solver.hpp"
+
+namespace solarlens::sched {
+class Scheduler;
+}
+
+namespace solarlens::recon {
+
+struct DeconvolutionConfig {
+    std::uint32_t map_size = 1024;
+    std::uint32_t tile_size = 0; ///< 0 picks the largest that fits the budget.
+    std::size_t memory_budget_bytes = std::size_t(256) << 20;
+    std::filesystem::path scratch_dir; ///< Empty means a directory under the system temp path.
+    int kernel_oversample = 16;
+    SolverOptions solver;
+
+    /// Solve tiles concurrently on this scheduler; null solves serially on
+    /// the calling thread. Concurrent tiles split the memory budget.
+    sched::Scheduler* scheduler = nullptr;
+    std::size_t max_parallel_tiles = 0; ///< 0 means one per worker.
+};
+
+struct TileReport {
+    std::uint32_t tile = 0;
+    SolveResult solve;
+    bool in_memory = false; ///< Samples fit the chunk buffer and were read once.
+};
+
+struct DeconvolutionReport {
+    std::uint32_t tile_size = 0;
+    std::uint32_t halo = 0;
+    std::uint64_t samples_read = 0;
+    std::uint64_t samples_binned = 0; ///< Bucket insertions, counting halo duplicates.
+    std::uint64_t samples_rejected = 0; ///< Off-map samples.
+    std::size_t peak_bytes = 0;       ///< Largest planned resident working set.
+    std::size_t parallel_tiles = 1;   ///< Tiles that were solved concurrently.
+    std::vector<TileReport> tiles;
+};
+
+class DeconvolutionEngine {
+public:
+    DeconvolutionEngine(const PsfKernel& psf, const DeconvolutionConfig& config);
+
+    /// Reconstructs `map_out` from the samples in `samples_in`.
+    DeconvolutionReport run(const std::filesystem::path& samples_in,
+                            const std::filesystem::path& map_out);
+
+    const DeconvolutionConfig& config() const noexcept { return config_; }
+    const TilePlan& plan() const noexcept { return plan_; }
+
+private:
+    DeconvolutionConfig config_;
+    SampledKernel kernel_;
+    TilePlan plan_;
+};
+
+} // namespace solarlens::recon
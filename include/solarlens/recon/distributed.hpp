@@ -0,0 +1,149 @@
+#pragma once
+
+/// Reconstruction of one map across the ranks of a cluster.
+///
+/// The map is cut into a near-square grid of blocks, one per rank, and
+/// the ranks jointly run one Jacobi-preconditioned CG on the global normal
+/// equations
+///
+///     (A^T W A + lambda I) x = A^T W y
+///
+/// over the whole map: the system a single TileSolver over the full map
+/// would solve, rather than DeconvolutionEngine's independent tiles. Each
+/// rank keeps only the samples that land on its block and a ghost ring
+/// of map values one PSF support radius R wide around it, which is every
+/// pixel those samples touch. An operator application fills the ghost
+/// ring of p from the neighbouring ranks, scatters its own samples, and
+/// sends the contributions that landed in the ghost ring back to their
+/// owners. Samples whose stencil stays inside the block are scattered
+/// while the first exchange is in flight.
+///
+/// Per iteration a rank moves O(R * block side) values to its neighbours
+/// and joins two allreduces of at most two doubles; its compute and
+/// memory are 1/P of the map's. Iterates agree with the single-node solve
+/// up to summation order.
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "solarlens/recon/communicator.hpp"
+#include "solarlens/recon/psf_kernel.hpp"
+#include "solarlens/recon/ring_sample.hpp"
+#include "solarlens/recon/tile_plan.hpp"
+#include "solarlens/recon/tile_solver.hpp"
+
+namespace solarlens::recon {
+
+/// Blocks of a map_size x map_size map, `columns` across and `rows` down;
+/// rank r owns column r % columns of row r / columns.
+struct BlockGrid {
+    std::uint32_t map_size = 0;
+    std::uint32_t columns = 1;
+    std::uint32_t rows = 1;
+
+    /// The most nearly square grid of exactly `ranks` blocks.
+    static BlockGrid for_ranks(std::uint32_t map_size, int ranks);
+
+    int ranks() const noexcept { return int(columns * rows); }
+    TileRect block(int rank) const;
+};
+
+struct DistributedConfig {
+    std::uint32_t map_size = 1024;
+    int kernel_oversample = 16;
+    SolverOptions solver; ///< FP64 only.
+};
+
+struct DistributedReport {
+    SolveResult solve;                ///< Global totals, identical on every rank.
+    TileRect block;                   ///< This rank's part of the map.
+    std::uint64_t local_samples = 0;  ///< Usable samples on this rank.
+    std::size_t neighbours = 0;       ///< Ranks this one exchanges halos with.
+    std::uint64_t halo_values_sent = 0;
+    std::uint64_t exchanges = 0;
+    std::uint64_t allreduces = 0;
+};
+
+class DistributedSolver {
+public:
+    /// Collective only in that every rank must construct one with the same
+    /// kernel and configuration; no messages are sent.
+    DistributedSolver(const PsfKernel& psf, const DistributedConfig& config, Communicator& comm);
+
+    const BlockGrid& grid() const noexcept { return grid_; }
+    const TileRect& block() const noexcept { return block_; }
+    const TileRect& ghost_region() const noexcept { return ghost_; }
+    std::uint32_t halo() const noexcept { return halo_; }
+
+    /// Keeps the usable samples that land on this rank's block and drops
+    /// the rest, so every rank may be handed the same stream.
+    void add_samples(std::span<const RingSample> samples);
+
+    /// add_samples() over a whole sample file, read in bounded chunks.
+    void load_samples(const std::filesystem::path& path);
+
+    std::uint64_t local_samples() const noexcept { return inner_.size() + edge_.size(); }
+
+    /// Collective. `x` (block().area() values, row-major) holds this rank's
+    /// starting guess on entry and its part of the solution on return.
+    DistributedReport solve(std::span<double> x);
+
+    /// Collective. Copies every rank's block of `x` into `map` (map_size^2
+    /// values, row-major) on rank `root`; other ranks pass an empty map.
+    void gather(std::span<const double> x, std::span<double> map, int root = 0);
+
+private:
+    // Overlap with one neighbour: `owned` is the part of this block in the
+    // peer's ghost ring, `ghost` the part of the peer's block in ours.
+    struct Link {
+        int peer = 0;
+        TileRect owned;
+        TileRect ghost;
+        std::vector<double> owned_values;
+        std::vector<double> ghost_values;
+    };
+
+    void build_stencil(const RingSample& s);
+
+    /// Adds A^T W A v for `samples` into q (both ghost-region arrays).
+    void scatter(std::span<const RingSample> samples, std::span<const double> v, std::span<double> q);
+
+    /// q = (A^T W A + lambda I) p over the block; fills p's ghost ring.
+    void apply(std::span<double> p, std::span<double> q, DistributedReport& report);
+
+    /// Sends ghost-ring values of `v` to their owners and adds what the
+    /// neighbours sent into the block.
+    void accumulate_ghosts(std::span<double> v, DistributedReport& report);
+
+    double allreduce(std::span<double> values, DistributedReport& report);
+
+    std::size_t ghost_index(std::uint32_t x, std::uint32_t y) const noexcept
+    {
+        return std::size_t(y - ghost_.y0) * ghost_.width() + (x - ghost_.x0);
+    }
+
+    Communicator& comm_;
+    SampledKernel kernel_;
+    SolverOptions options_;
+    BlockGrid grid_;
+    TileRect block_;
+    TileRect ghost_;
+    std::uint32_t halo_ = 0;
+    std::vector<Link> links_;
+    std::vector<HaloTransfer> transfers_;
+    std::vector<RingSample> inner_; // Stencil inside the block.
+    std::vector<RingSample> edge_;  // Stencil reaches the ghost ring.
+
+    // Ghost-region arrays.
+    std::vector<double> r_;
+    std::vector<double> p_;
+    std::vector<double> q_;
+    std::vector<double> diag_;
+    std::vector<std::uint32_t> stencil_index_;
+    std::vector<double> stencil_weight_;
+};
+
+} // namespace solarlens::recon
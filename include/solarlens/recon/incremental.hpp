@@ -0,0 +1,110 @@
+#pragma once
+
+/// Incremental reconstruction for a map that fills in over months.
+///
+/// The state directory keeps everything a later update needs: the
+/// per-tile sample buckets, every tile's last solution over its solve
+/// region, and the current map. add() bins only the new samples, then
+/// re-solves just the tiles that received any, each warm-started from its
+/// previous solution. A tile whose normal equations gained a handful of
+/// rows is already close to converged, so an update costs a few CG
+/// iterations on the touched tiles instead of a full batch solve. Each
+/// update meets `solver.tolerance` from the previous solution, so the map
+/// tracks a batch solve to within that tolerance. The directory survives
+/// restarts; reopening it resumes where it left off, re-solving any tile
+/// whose bucket grew after its last solve, as an interrupted update
+/// leaves them.
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <vector>
+
+#include "solarlens/core/digest.hpp"
+#include "solarlens/core/file.hpp"
+#include "solarlens/recon/deconvolution.hpp"
+#include "solarlens/recon/psf_kernel.hpp"
+#include "solarlens/recon/ring_sample.hpp"
+#include "solarlens/recon/tile_plan.hpp"
+#include "solarlens/recon/tile_solver.hpp"
+
+namespace solarlens::sched {
+class Scheduler;
+}
+
+namespace solarlens::recon {
+
+class SpillStore;
+
+struct IncrementalConfig {
+    std::uint32_t map_size = 1024;
+    std::uint32_t tile_size = 0; ///< 0 picks the largest that fits the budget.
+    std::size_t memory_budget_bytes = std::size_t(256) << 20;
+    std::filesystem::path state_dir; ///< Required.
+    int kernel_oversample = 16;
+    SolverOptions solver;
+    sched::Scheduler* scheduler = nullptr;
+    std::size_t max_parallel_tiles = 0; ///< 0 means one per worker.
+    /// Resume state solved with a different kernel or solver options; every
+    /// tile is then re-solved by the next update.
+    bool accept_changed_settings = false;
+};
+
+struct UpdateReport {
+    std::uint64_t samples_added = 0;
+    std::uint64_t samples_rejected = 0; ///< Off-map samples.
+    std::uint64_t samples_total = 0;    ///< Samples held after the update.
+    std::size_t tiles_solved = 0;
+    int iterations = 0;                 ///< Summed over solved tiles.
+    std::vector<TileReport> tiles;      ///< Solved tiles only.
+};
+
+class IncrementalReconstructor {
+public:
+    /// Opens or creates the state in `config.state_dir`. Throws
+    /// std::runtime_error if existing state was built with a different map
+    /// size, tile size or kernel support, or, unless
+    /// `config.accept_changed_settings`, solved with different kernel
+    /// samples or solver options.
+    IncrementalReconstructor(const PsfKernel& psf, const IncrementalConfig& config);
+    ~IncrementalReconstructor();
+
+    IncrementalReconstructor(const IncrementalReconstructor&) = delete;
+    IncrementalReconstructor& operator=(const IncrementalReconstructor&) = delete;
+
+    /// Adds `samples` and refreshes the tiles they touch.
+    UpdateReport add(std::span<const RingSample> samples);
+
+    /// Streams a ring-sample file through add() as one update.
+    UpdateReport add_file(const std::filesystem::path& samples_in);
+
+    /// Re-solves every tile that holds samples, still warm-started, e.g.
+    /// right after reopening with `accept_changed_settings`.
+    UpdateReport refresh_all();
+
+    /// The map, current after every update.
+    std::filesystem::path map_path() const;
+
+    std::uint64_t sample_count() const noexcept { return total_samples_; }
+    const TilePlan& plan() const noexcept { return plan_; }
+    const IncrementalConfig& config() const noexcept { return config_; }
+
+private:
+    void bin(std::span<const RingSample> samples, UpdateReport& report);
+    void solve_dirty(UpdateReport& report);
+    void save_state();
+
+    IncrementalConfig config_;
+    SampledKernel kernel_;
+    TilePlan plan_;
+    std::unique_ptr<SpillStore> store_;
+    core::File solutions_; ///< tile_count slots of max_region_area doubles.
+    core::Digest settings_;
+    std::vector<std::uint64_t> solved_; ///< Bucket size each tile was last solved from.
+    std::vector<bool> dirty_;
+    std::uint64_t total_samples_ = 0;
+};
+
+} // namespace solarlens::recon
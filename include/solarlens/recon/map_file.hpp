@@ -0,0 +1,59 @@
+#pragma once
+
+/// Reconstructed map files: a 16-byte header { "SLMP", u32 version,
+/// u32 width, u32 height } followed by row-major float32 pixels.
+///
+/// Maps are written and read in rectangular blocks so that no stage needs a
+/// whole 1024x1024 (or larger) map resident.
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+#include "solarlens/core/file.hpp"
+
+namespace solarlens::recon {
+
+inline constexpr std::uint32_t map_file_version = 1;
+
+class MapFileWriter {
+public:
+    /// Creates (or truncates) a zero-filled map of the given size.
+    MapFileWriter(const std::filesystem::path& path, std::uint32_t width, std::uint32_t height);
+
+    /// Opens an existing map for in-place block updates; throws
+    /// std::runtime_error if it is not a valid map file.
+    explicit MapFileWriter(const std::filesystem::path& path);
+
+    std::uint32_t width() const noexcept { return width_; }
+    std::uint32_t height() const noexcept { return height_; }
+
+    /// Writes a `w` x `h` row-major block whose top-left pixel is (x0, y0).
+    void write_block(std::uint32_t x0, std::uint32_t y0, std::uint32_t w, std::uint32_t h,
+                     std::span<const float> pixels);
+
+    void close() { file_.close(); }
+
+private:
+    core::File file_;
+    std::uint32_t width_ = 0;
+    std::uint32_t height_ = 0;
+};
+
+class MapFileReader {
+public:
+    explicit MapFileReader(const std::filesystem::path& path);
+
+    std::uint32_t width() const noexcept { return width_; }
+    std::uint32_t height() const noexcept { return height_; }
+
+    void read_block(std::uint32_t x0, std::uint32_t y0, std::uint32_t w, std::uint32_t h,
+                    std::span<float> pixels) const;
+
+private:
+    core::File file_;
+    std::uint32_t width_ = 0;
+    std::uint32_t height_ = 0;
+};
+
+} // namespace solarlens::recon
@@ -0,0 +1,123 @@
+#pragma once
+
+/// Multi-resolution view of a reconstructed map for interactive pan and zoom.
+///
+/// Level 0 is the map itself; each level above halves both sides, a pixel
+/// being the mean of the (up to four) level-below pixels it covers, until
+/// the whole map fits one tile. Every level is cut into square tiles, so
+/// the levels form a quadtree: tile (x, y) of level L covers tiles (2x..2x+1,
+/// 2y..2y+1) of level L - 1.
+///
+/// The coarse levels, those no larger than `preview_size` on a side, are
+/// built in one streaming pass when the pyramid opens and stay resident, so
+/// an overview is always immediate. Finer tiles are computed on first
+/// request, from the map for level 0 and from their four children above
+/// it, and kept in an LRU cache bounded by `cache_bytes`. Only requested
+/// tiles are cached; children already in the cache are reused, so zooming
+/// out over tiles just viewed costs one halving. The map file may
+/// keep changing underneath (an IncrementalReconstructor updating it):
+/// invalidate() the rectangle an update rewrote and the affected preview
+/// pixels are recomputed and the affected cached tiles dropped. All members
+/// are safe to call from several threads; tiles are computed outside the
+/// lock.
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "solarlens/recon/map_file.hpp"
+#include "solarlens/recon/tile_plan.hpp"
+
+namespace solarlens::recon {
+
+struct PyramidConfig {
+    std::uint32_t tile_size = 256;
+    std::size_t cache_bytes = std::size_t(64) << 20;
+    /// Levels whose larger side is at most this are resident.
+    std::uint32_t preview_size = 512;
+
+    /// Throws std::invalid_argument for a zero tile size or a cache that
+    /// cannot hold one tile.
+    void validate() const;
+};
+
+struct PyramidTile {
+    std::uint32_t level = 0;
+    std::uint32_t x0 = 0;      ///< First column, in level pixels.
+    std::uint32_t y0 = 0;      ///< First row, in level pixels.
+    std::uint32_t width = 0;   ///< Edge tiles are smaller.
+    std::uint32_t height = 0;
+    std::vector<float> pixels; ///< Row-major, width x height.
+};
+
+struct PyramidStats {
+    std::uint64_t hits = 0;      ///< Includes resident-level requests.
+    std::uint64_t misses = 0;    ///< Tiles computed, children included.
+    std::uint64_t evictions = 0;
+    std::size_t cached_tiles = 0;
+    std::size_t cached_bytes = 0;
+};
+
+class MapPyramid {
+public:
+    /// Opens the map and builds the resident levels. Throws
+    /// std::runtime_error if `map_path` is not a valid map file.
+    explicit MapPyramid(const std::filesystem::path& map_path, const PyramidConfig& config = {});
+
+    std::uint32_t levels() const noexcept { return static_cast<std::uint32_t>(sizes_.size()); }
+    std::uint32_t width(std::uint32_t level) const { return sizes_.at(level).width; }
+    std::uint32_t height(std::uint32_t level) const { return sizes_.at(level).height; }
+    std::uint32_t tiles_x(std::uint32_t level) const;
+    std::uint32_t tiles_y(std::uint32_t level) const;
+    /// First resident level; levels below it are computed lazily.
+    std::uint32_t first_resident_level() const noexcept { return resident_; }
+    const PyramidConfig& config() const noexcept { return config_; }
+
+    /// Tile (tx, ty) of `level`. Throws std::out_of_range for a tile
+    /// outside the level. The returned tile stays valid after eviction or
+    /// invalidation; it is just no longer the current one.
+    std::shared_ptr<const PyramidTile> tile(std::uint32_t level, std::uint32_t tx, std::uint32_t ty);
+
+    /// Marks the level-0 rectangle `region` as rewritten in the map file.
+    void invalidate(const TileRect& region);
+
+    PyramidStats stats() const;
+
+private:
+    struct Size {
+        std::uint32_t width;
+        std::uint32_t height;
+    };
+    struct Entry {
+        std::shared_ptr<const PyramidTile> tile;
+        std::list<std::uint64_t>::iterator lru;
+    };
+
+    std::shared_ptr<const PyramidTile> fetch(std::uint32_t level, std::uint32_t tx, std::uint32_t ty, bool keep);
+    std::shared_ptr<const PyramidTile> compute(std::uint32_t level, std::uint32_t tx, std::uint32_t ty);
+    /// Recomputes resident pixels over the level-0 rectangle; holds no lock.
+    void build_resident(const TileRect& region, std::vector<std::vector<float>>& images) const;
+    TileRect tile_rect(std::uint32_t level, std::uint32_t tx, std::uint32_t ty) const;
+    void insert_locked(std::uint64_t key, std::shared_ptr<const PyramidTile> tile);
+
+    PyramidConfig config_;
+    MapFileReader map_;
+    std::vector<Size> sizes_;
+    std::uint32_t resident_ = 0;
+
+    std::mutex invalidate_mutex_;
+    mutable std::mutex mutex_;
+    /// Resident levels resident_..levels()-1, whole-level row-major images.
+    std::vector<std::vector<float>> preview_;
+    std::unordered_map<std::uint64_t, Entry> cache_;
+    std::list<std::uint64_t> lru_; ///< Most recent first.
+    std::uint64_t generation_ = 0; ///< Bumped by invalidate().
+    PyramidStats stats_;
+};
+
+} // namespace solarlens::recon
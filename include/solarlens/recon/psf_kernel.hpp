@@ -0,0 +1,83 @@
+#pragma once
+
+/// Radial point-spread functions of the solar gravitational lens (SGL).
+///
+/// On the focal line the SGL PSF is J0^2(k * sqrt(2 r_g / z) * rho): a sharp
+/// core a few centimetres wide with a 1/rho envelope, so a map pixel of any
+/// useful size sees the pixel-averaged envelope rather than the fringes.
+/// Kernels are expressed in map pixel units and normalised to 1 at rho = 0.
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+namespace solarlens::recon {
+
+class PsfKernel {
+public:
+    virtual ~PsfKernel() = default;
+
+    /// Kernel weight at radial offset `rho` (map pixels) from a sample.
+    virtual double value(double rho) const = 0;
+
+    /// Radius (map pixels) beyond which the kernel is treated as zero.
+    virtual double support_radius() const = 0;
+};
+
+/// Analytic SGL PSF averaged over the radial extent of one map pixel.
+class SglPsf final : public PsfKernel {
+public:
+    struct Params {
+        double distance_au = 650.0;    ///< Heliocentric distance of the craft.
+        double wavelength_m = 1.0e-6;  ///< Observing wavelength.
+        double pixel_pitch_m = 1.0;    ///< Image-plane size of one map pixel.
+        double support_radius_px = 16; ///< Truncation radius.
+    };
+
+    explicit SglPsf(const Params& params);
+
+    double value(double rho) const override;
+    double support_radius() const override { return params_.support_radius_px; }
+
+    /// Argument scale k * sqrt(2 r_g / z), radians per metre.
+    double alpha() const noexcept { return alpha_; }
+
+private:
+    double footprint_mean(double lo, double hi) const;
+
+    Params params_;
+    double alpha_;
+    double centre_;
+};
+
+/// Uniformly oversampled radial copy of another kernel with linear
+/// interpolation; what the solvers evaluate in their inner loops.
+class SampledKernel {
+public:
+    SampledKernel(const PsfKernel& kernel, int oversample = 16);
+
+    double radius() const noexcept { return radius_; }
+    double radius_squared() const noexcept { return radius_ * radius_; }
+
+    double operator()(double rho) const noexcept
+    {
+        const double t = rho * oversample_;
+        const auto i = static_cast<std::size_t>(t);
+        if (i + 1 >= table_.size())
+            return 0.0;
+        const double f = t - static_cast<double>(i);
+        return table_[i] + f * (table_[i + 1] - table_[i]);
+    }
+
+    std::size_t memory_bytes() const noexcept { return table_.capacity() * sizeof(double); }
+
+    /// Samples at rho = i / oversample, ending in a zero.
+    std::span<const double> table() const noexcept { return table_; }
+
+private:
+    std::vector<double> table_;
+    double radius_;
+    double oversample_;
+};
+
+} // namespace solarlens::recon
@@ -0,0 +1,126 @@
+#pragma once
+
+/// Precomputed SGL PSF tables on a (distance, wavelength, offset) grid.
+///
+/// Building a table evaluates the pixel-averaged J0^2 PSF (SglPsf) at every
+/// grid node once; afterwards a table file is memory-mapped read-only and
+/// looked up by trilinear interpolation, so opening one costs a header
+/// check and a mmap rather than a recompute, and all workers on a node share
+/// the same page-cache copy.
+///
+/// File layout, little-endian, version 1:
+///
+///     offset  size  field
+///          0     8  magic "SLPSFTB\0"
+///          8     4  version
+///         12     4  reserved (0)
+///         16    72  three axes { f64 min, f64 max, u32 count, u32 pad }:
+///                   distance (AU), wavelength (m), offset (map pixels)
+///         88     8  pixel pitch (m)
+///         96     8  data offset (page aligned)
+///        104     8  data size (bytes)
+///
+/// then float32 values indexed [distance][wavelength][offset].
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <vector>
+
+#include "solarlens/recon/psf_kernel.hpp"
+
+namespace solarlens::core {
+class Snapshot;
+class SnapshotWriter;
+}
+
+namespace solarlens::recon {
+
+inline constexpr std::uint32_t psf_table_version = 1;
+
+/// Uniformly spaced grid axis; `count` nodes from `min` to `max` inclusive.
+struct GridAxis {
+    double min = 0.0;
+    double max = 0.0;
+    std::uint32_t count = 0;
+
+    double step() const noexcept { return count > 1 ? (max - min) / (count - 1) : 0.0; }
+    double node(std::uint32_t i) const noexcept { return min + i * step(); }
+    bool operator==(const GridAxis&) const = default;
+};
+
+struct PsfGridSpec {
+    GridAxis distance_au {550.0, 1000.0, 91};
+    GridAxis wavelength_m {0.4e-6, 1.0e-6, 61};
+    GridAxis offset_px {0.0, 16.0, 257};
+    double pixel_pitch_m = 1.0;
+
+    bool operator==(const PsfGridSpec&) const = default;
+};
+
+/// Evaluates the grid and writes a table file. The file is written under a
+/// temporary name and renamed into place, so concurrent readers only ever
+/// see complete tables.
+void build_psf_table(const PsfGridSpec& spec, const std::filesystem::path& path);
+
+class TablePsfKernel;
+
+class PsfTable {
+public:
+    /// Maps an existing table; throws std::runtime_error if it is not a
+    /// valid table of the current version.
+    static PsfTable open(const std::filesystem::path& path);
+
+    /// Uses a table written by snapshot() in place; the table keeps the
+    /// image mapped. Throws std::runtime_error like open(path).
+    static PsfTable open(std::shared_ptr<const core::Snapshot> snapshot, std::string_view section);
+
+    /// Maps `path` if it holds a table for exactly `spec`, building it first
+    /// otherwise.
+    static PsfTable open_or_build(const std::filesystem::path& path, const PsfGridSpec& spec);
+
+    const PsfGridSpec& spec() const noexcept { return spec_; }
+
+    /// Interpolated PSF weight. Queries outside the distance and wavelength
+    /// axes clamp to the edge; offsets beyond the axis return 0.
+    double lookup(double distance_au, double wavelength_m, double offset_px) const noexcept;
+
+    /// Radial kernel for one craft distance and wavelength, interpolated
+    /// once so per-pixel evaluation is a 1D lookup.
+    TablePsfKernel kernel(double distance_au, double wavelength_m) const;
+
+    /// Writes the table, in its file layout, as snapshot section `section`.
+    void snapshot(core::SnapshotWriter& writer, std::string_view section) const;
+
+    /// The raw [distance][wavelength][offset] values.
+    std::span<const float> values() const noexcept { return values_; }
+
+private:
+    PsfTable(std::shared_ptr<const void> storage, const PsfGridSpec& spec, std::span<const float> values);
+
+    /// Blends the four radial rows around (distance, wavelength).
+    void interpolate_row(double distance_au, double wavelength_m, std::span<double> out) const;
+
+    std::shared_ptr<const void> storage_;  // The file or snapshot holding values_.
+    PsfGridSpec spec_;
+    std::span<const float> values_;
+};
+
+class TablePsfKernel final : public PsfKernel {
+public:
+    double value(double rho) const override;
+    double support_radius() const override { return support_; }
+
+private:
+    friend class PsfTable;
+    TablePsfKernel(std::vector<double> row, double step, double support);
+
+    std::vector<double> row_;
+    double inv_step_;
+    double support_;
+};
+
+} // namespace solarlens::recon
@@ -0,0 +1,76 @@
+#pragma once
+
+/// Einstein-ring photometry samples and their on-disk stream format.
+///
+/// Each sample is the total ring flux one spacecraft measured while sitting
+/// at position (u, v) of the image plane, expressed in map pixel units with
+/// pixel centres on integer coordinates.
+///
+/// File layout (little-endian): a 16-byte header { "SLRS", u32 version,
+/// u64 count } followed by `count` packed RingSample records.
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+
+#include "solarlens/core/file.hpp"
+
+namespace solarlens::recon {
+
+struct RingSample {
+    float u;     ///< Image-plane x position, map pixels.
+    float v;     ///< Image-plane y position, map pixels.
+    float flux;  ///< Coronagraph-corrected ring flux.
+    float sigma; ///< 1-sigma noise on `flux`; must be positive.
+};
+
+static_assert(sizeof(RingSample) == 16);
+
+inline constexpr std::uint32_t ring_sample_file_version = 1;
+
+/// Appends samples to a new sample file; the header count is patched on
+/// close().
+class RingSampleWriter {
+public:
+    explicit RingSampleWriter(const std::filesystem::path& path);
+    ~RingSampleWriter();
+
+    RingSampleWriter(const RingSampleWriter&) = delete;
+    RingSampleWriter& operator=(const RingSampleWriter&) = delete;
+
+    void append(std::span<const RingSample> samples);
+    void append(const RingSample& sample) { append(std::span(&sample, 1)); }
+
+    std::uint64_t count() const noexcept { return count_; }
+
+    /// Writes the final header. Called by the destructor if omitted, but
+    /// errors are only reported when called explicitly.
+    void close();
+
+private:
+    core::File file_;
+    std::uint64_t count_ = 0;
+};
+
+/// Sequential chunked reader; never holds more than the caller's buffer.
+class RingSampleReader {
+public:
+    explicit RingSampleReader(const std::filesystem::path& path);
+
+    std::uint64_t count() const noexcept { return count_; }
+    std::uint64_t remaining() const noexcept { return count_ - next_; }
+
+    /// Fills `out` with the next samples and returns how many were read;
+    /// zero means end of stream.
+    std::size_t read(std::span<RingSample> out);
+
+    void rewind() noexcept { next_ = 0; }
+
+private:
+    core::File file_;
+    std::uint64_t count_ = 0;
+    std::uint64_t next_ = 0;
+};
+
+} // namespace solarlens::recon
@@ -0,0 +1,78 @@
+#pragma once
+
+/// Per-tile sample buckets on scratch disk.
+///
+/// The input stream is read once and every sample is appended to the bucket
+/// of each tile that uses it (see TilePlan). Buckets are plain arrays of
+/// RingSample records; each keeps a small write buffer so the binning pass
+/// costs `tile_count * buffer_samples` records of memory regardless of
+/// input size.
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <span>
+#include <vector>
+
+#include "solarlens/core/file.hpp"
+#include "solarlens/recon/ring_sample.hpp"
+#include "solarlens/recon/tile_plan.hpp"
+
+namespace solarlens::recon {
+
+class SpillStore {
+public:
+    enum class Open {
+        fresh,  ///< Start with empty buckets.
+        resume  ///< Keep buckets already in `dir` and append to them.
+    };
+
+    SpillStore(const TilePlan& plan, const std::filesystem::path& dir,
+               std::size_t buffer_samples, Open open = Open::fresh);
+    ~SpillStore();
+
+    SpillStore(const SpillStore&) = delete;
+    SpillStore& operator=(const SpillStore&) = delete;
+
+    /// Routes one sample to every bucket that uses it; returns
+    /// the number of buckets it went to (zero for off-map samples).
+    std::size_t add(const RingSample& sample);
+
+    /// Writes out all partially filled buffers.
+    void flush();
+
+    std::uint64_t count(std::size_t tile) const { return buckets_.at(tile).count; }
+
+    /// Reads all of bucket `tile` into `out`, which must hold count(tile)
+    /// samples.
+    void load(std::size_t tile, std::span<RingSample> out) const;
+
+    /// Streams bucket `tile` through `buffer`, calling `fn` per chunk.
+    /// Buffered-but-unflushed samples are included. Const methods may be
+    /// called from several threads once binning is finished.
+    void for_each_chunk(std::size_t tile, std::span<RingSample> buffer,
+                        const std::function<void(std::span<const RingSample>)>& fn) const;
+
+    std::size_t memory_bytes() const noexcept;
+
+    /// Removes the bucket files.
+    void remove_files() noexcept;
+
+private:
+    struct Bucket {
+        core::File file;
+        std::vector<RingSample> pending;
+        std::uint64_t flushed = 0;
+        std::uint64_t count = 0;
+    };
+
+    void flush_bucket(Bucket& b);
+
+    const TilePlan& plan_;
+    std::filesystem::path dir_;
+    std::size_t buffer_samples_;
+    std::vector<Bucket> buckets_;
+};
+
+} // namespace solarlens::recon
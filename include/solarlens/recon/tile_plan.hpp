@@ -0,0 +1,109 @@
+#pragma once
+
+/// Geometry of the tiled reconstruction.
+///
+/// The map is cut into square interior tiles. A tile uses every sample that
+/// lands within one PSF support radius R of its interior, and solves for
+/// every pixel those samples touch: the interior grown by a 2R halo. Each
+/// sample's whole footprint is therefore inside the unknowns, so no sample
+/// is fitted against pixels that were truncated away, and every interior
+/// pixel sees all of the samples it would see in a global solve. Only the
+/// interior is kept; the halo pixels are under-constrained and discarded.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace solarlens::recon {
+
+struct TileRect {
+    std::uint32_t x0 = 0; ///< First column (inclusive).
+    std::uint32_t y0 = 0; ///< First row (inclusive).
+    std::uint32_t x1 = 0; ///< One past last column.
+    std::uint32_t y1 = 0; ///< One past last row.
+
+    std::uint32_t width() const noexcept { return x1 - x0; }
+    std::uint32_t height() const noexcept { return y1 - y0; }
+    std::size_t area() const noexcept { return std::size_t(width()) * height(); }
+
+    /// True if sample coordinates (u, v) fall on a pixel of this rectangle.
+    bool contains(float u, float v) const noexcept
+    {
+        const float pu = u + 0.5f;
+        const float pv = v + 0.5f;
+        return pu >= float(x0) && pu < float(x1) && pv >= float(y0) && pv < float(y1);
+    }
+};
+
+struct Tile {
+    std::uint32_t index = 0;
+    TileRect interior;
+    TileRect samples; ///< Interior plus R: where the tile's samples lie.
+    TileRect region;  ///< Interior plus 2R: the solve region.
+};
+
+class TilePlan {
+public:
+    /// `support` is the PSF support radius R in whole pixels.
+    TilePlan(std::uint32_t map_size, std::uint32_t tile_size, std::uint32_t support);
+
+    std::uint32_t map_size() const noexcept { return map_size_; }
+    std::uint32_t tile_size() const noexcept { return tile_size_; }
+    std::uint32_t support() const noexcept { return support_; }
+    std::uint32_t halo() const noexcept { return 2 * support_; }
+    std::uint32_t tiles_per_side() const noexcept { return per_side_; }
+    std::size_t tile_count() const noexcept { return tiles_.size(); }
+    const Tile& tile(std::size_t i) const { return tiles_.at(i); }
+    const std::vector<Tile>& tiles() const noexcept { return tiles_; }
+
+    /// Largest solve region of any tile, in pixels.
+    std::size_t max_region_area() const noexcept;
+
+    /// Calls `fn(tile_index)` for every tile that uses a sample at (u, v).
+    /// Samples off the map visit nothing.
+    template <typename Fn>
+    void for_each_tile_using(float u, float v, Fn&& fn) const
+    {
+        const float pu = u + 0.5f;
+        const float pv = v + 0.5f;
+        if (!(pu >= 0.0f && pv >= 0.0f && pu < float(map_size_) && pv < float(map_size_)))
+            return;
+        const auto lo = [&](float p) {
+            const long t = static_cast<long>((p - float(support_)) / float(tile_size_)) - 1;
+            return static_cast<std::uint32_t>(t < 0 ? 0 : t);
+        };
+        const auto hi = [&](float p) {
+            const auto t = static_cast<std::uint32_t>((p + float(support_)) / float(tile_size_)) + 1;
+            return t < per_side_ ? t : per_side_ - 1;
+        };
+        for (std::uint32_t ty = lo(pv), ty1 = hi(pv); ty <= ty1; ++ty)
+            for (std::uint32_t tx = lo(pu), tx1 = hi(pu); tx <= tx1; ++tx) {
+                const Tile& t = tiles_[std::size_t(ty) * per_side_ + tx];
+                if (t.samples.contains(u, v))
+                    fn(t.index);
+            }
+    }
+
+private:
+    std::uint32_t map_size_;
+    std::uint32_t tile_size_;
+    std::uint32_t support_;
+    std::uint32_t per_side_;
+    std::vector<Tile> tiles_;
+};
+
+/// Per-pixel solver state: iterate, residual, search direction, operator
+/// image and Jacobi diagonal, all FP64.
+inline constexpr std::size_t solver_bytes_per_pixel = 5 * sizeof(double);
+
+/// Smallest sample chunk a solve is allowed to stream with.
+inline constexpr std::size_t min_chunk_samples = 4096;
+
+/// Picks the largest power-of-two tile size (>= 16, <= map_size) whose
+/// solver state plus a minimum sample chunk fits in `budget_bytes` next to
+/// `fixed_bytes` of other resident data. Throws std::invalid_argument if
+/// even the smallest tile does not fit.
+std::uint32_t tile_size_for_budget(std::uint32_t map_size, std::uint32_t support,
+                                   std::size_t budget_bytes, std::size_t fixed_bytes);
+
+} // namespace solarlens::recon
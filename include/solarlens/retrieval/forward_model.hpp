@@ -0,0 +1,77 @@
+#pragma once
+
+/// Reflected-light forward model for exoplanet spectra.
+///
+/// One well-mixed isothermal layer over a Lambertian surface, with a
+/// fractional cloud deck: band-averaged reflectance is
+///
+///     R = (1 - f_c) A_s T_R T_gas(1) + f_c A_c T_R^h T_gas(h) + R_ray
+///
+/// where T_gas(h) is the correlated-k transmission of the column fraction
+/// h above the reflector along the two-way airmass, T_R the Rayleigh
+/// transmission and R_ray single-scattered Rayleigh light. Coarse, but it
+/// carries the dependence on O2, O3, CH4, H2O mixing ratios,
+/// surface pressure and temperature a biosignature retrieval fits.
+///
+/// `evaluate` takes a batch of parameter vectors and writes one spectrum
+/// each. The per-band work runs in runtime-dispatched SIMD kernels
+/// sweeping the band axis of the opacity table.
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "solarlens/core/simd.hpp"
+#include "solarlens/retrieval/opacity.hpp"
+
+namespace solarlens::retrieval {
+
+/// Retrieved parameters, in order.
+enum class Param : std::size_t {
+    log10_o2,          ///< Volume mixing ratios.
+    log10_o3,
+    log10_ch4,
+    log10_h2o,
+    log10_pressure,    ///< Surface pressure, bar.
+    temperature,       ///< K.
+    surface_albedo,
+    cloud_fraction,
+};
+
+inline constexpr std::size_t parameter_count = 8;
+
+using Theta = std::array<double, parameter_count>;
+
+const char* to_string(Param param) noexcept;
+
+struct ForwardConfig {
+    double airmass = 2.0;          ///< 1/mu0 + 1/mu.
+    double cloud_albedo = 0.8;
+    double cloud_top = 0.5;        ///< Column fraction above the cloud deck.
+    core::SimdLevel simd = core::best_simd_level();
+};
+
+class ForwardModel {
+public:
+    /// Keeps a reference to `opacity`. Throws std::invalid_argument for a
+    /// SIMD level this process cannot run or a non-physical config.
+    ForwardModel(const OpacityTable& opacity, const ForwardConfig& config = {});
+
+    std::size_t bands() const noexcept { return opacity_->bands(); }
+    const OpacityTable& opacity() const noexcept { return *opacity_; }
+    const ForwardConfig& config() const noexcept { return config_; }
+
+    /// Writes spectrum i of `batch` to out[i * bands(), (i + 1) * bands()).
+    void evaluate(std::span<const Theta> batch, std::span<float> out) const;
+
+    /// Single-spectrum convenience.
+    std::vector<float> evaluate(const Theta& theta) const;
+
+private:
+    const OpacityTable* opacity_;
+    ForwardConfig config_;
+    std::vector<float> rayleigh_;   ///< Optical depth per bar, per band.
+};
+
+} // namespace solarlens::retrieval
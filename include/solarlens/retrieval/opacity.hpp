@@ -0,0 +1,106 @@
+#pragma once
+
+/// Correlated-k opacity tables for biosignature retrievals.
+///
+/// Within each spectral band the absorption coefficient of a gas is
+/// replaced by its cumulative distribution k(g), sampled at Gauss-Legendre
+/// nodes g_i with weights w_i, so band-averaged transmission becomes
+/// sum_i w_i exp(-tau k(g_i)) instead of a line-by-line integral. Tables
+/// hold k for each species on a (log10 pressure, temperature) grid.
+///
+/// Storage is [species][pressure][temperature][g][band] with the band axis
+/// padded to a multiple of 16 floats, so for every g node and grid corner
+/// the forward model's inner loop is a contiguous sweep over bands with no
+/// scalar tail.
+///
+/// `band_model_opacity` fills a table from a Gaussian band model of the
+/// O2, O3, CH4 and H2O features between 0.4 and 2.5 um; coefficients
+/// tabulated from line lists drop into the same layout through `row`.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace solarlens::retrieval {
+
+enum class Species : std::uint8_t { o2, o3, ch4, h2o };
+
+inline constexpr std::size_t species_count = 4;
+
+const char* to_string(Species species) noexcept;
+
+struct OpacityGrid {
+    double log10_p_min = -4.0;   ///< bar.
+    double log10_p_max = 1.0;
+    std::uint32_t pressures = 11;
+    double t_min = 150.0;        ///< K.
+    double t_max = 350.0;
+    std::uint32_t temperatures = 9;
+    std::uint32_t g_points = 8;
+
+    /// Throws std::invalid_argument for empty or inverted axes.
+    void validate() const;
+};
+
+/// Bilinear position of (pressure, temperature) on the grid, clamped to it.
+struct GridCell {
+    std::uint32_t ip = 0;
+    std::uint32_t it = 0;
+    float fp = 0.0f;  ///< Fraction towards ip + 1.
+    float ft = 0.0f;
+};
+
+class OpacityTable {
+public:
+    static constexpr std::size_t band_alignment = 16;
+
+    /// Zero-filled table for bands centred on `wavelengths_um`.
+    OpacityTable(std::vector<double> wavelengths_um, const OpacityGrid& grid);
+
+    const OpacityGrid& grid() const noexcept { return grid_; }
+    std::span<const double> wavelengths_um() const noexcept { return wavelengths_; }
+    std::size_t bands() const noexcept { return wavelengths_.size(); }
+    /// Floats between consecutive g rows.
+    std::size_t stride() const noexcept { return stride_; }
+
+    std::span<const float> g_nodes() const noexcept { return g_nodes_; }
+    std::span<const float> g_weights() const noexcept { return g_weights_; }
+
+    /// k for `species` at grid node (ip, it): g_points rows of stride()
+    /// floats, in optical depth per bar of column per unit mixing ratio.
+    const float* row(Species species, std::uint32_t ip, std::uint32_t it) const noexcept
+    {
+        return data_.data() + offset(species, ip, it);
+    }
+    float* row(Species species, std::uint32_t ip, std::uint32_t it) noexcept
+    {
+        return data_.data() + offset(species, ip, it);
+    }
+
+    GridCell locate(double pressure_bar, double temperature_k) const noexcept;
+
+private:
+    std::size_t offset(Species species, std::uint32_t ip, std::uint32_t it) const noexcept
+    {
+        return ((std::size_t(species) * grid_.pressures + ip) * grid_.temperatures + it) * grid_.g_points
+            * stride_;
+    }
+
+    OpacityGrid grid_;
+    std::vector<double> wavelengths_;
+    std::size_t stride_ = 0;
+    std::vector<float> g_nodes_;
+    std::vector<float> g_weights_;
+    std::vector<float> data_;
+};
+
+/// Table for `wavelengths_um` filled from the built-in band model.
+OpacityTable band_model_opacity(std::vector<double> wavelengths_um, const OpacityGrid& grid = {});
+
+/// `count` band centres evenly spaced in log wavelength (constant
+/// resolving power) from `min_um` to `max_um`.
+std::vector<double> log_spaced_bands(double min_um, double max_um, std::size_t count);
+
+} // namespace solarlens::retrieval
@@ -0,0 +1,97 @@
+#pragma once
+
+/// Bayesian atmospheric retrieval with an affine-invariant ensemble
+/// sampler (Goodman & Weare stretch move, as in emcee).
+///
+/// The walker ensemble is split in two halves; each half moves against
+/// the other, so every proposal of a half-step is independent and the
+/// whole half goes through ForwardModel::evaluate as one batch. Pixels of
+/// a map are independent retrievals and run in parallel on the scheduler;
+/// each pixel's chain is seeded from (seed, pixel index), so results do
+/// not depend on the worker count.
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "solarlens/retrieval/forward_model.hpp"
+
+namespace solarlens::sched {
+class Scheduler;
+}
+
+namespace solarlens::retrieval {
+
+/// Uniform prior on a box.
+struct Prior {
+    Theta lower {-3.0, -10.0, -10.0, -8.0, -2.0, 150.0, 0.0, 0.0};
+    Theta upper {0.0, -3.0, -2.0, -1.0, 1.0, 350.0, 1.0, 1.0};
+
+    bool contains(const Theta& theta) const noexcept;
+    /// Throws std::invalid_argument if any lower bound is not below its upper.
+    void validate() const;
+};
+
+/// One reconstructed pixel spectrum, bands matching the forward model.
+struct Observation {
+    std::span<const float> reflectance;
+    std::span<const float> sigma;
+};
+
+struct SamplerConfig {
+    std::size_t walkers = 48;      ///< Even, at least 2 * parameter_count.
+    std::size_t steps = 1500;      ///< Including burn-in.
+    std::size_t burn_in = 500;
+    double stretch = 2.0;          ///< Stretch-move scale a.
+    std::uint64_t seed = 1;
+    bool keep_samples = false;
+
+    /// Throws std::invalid_argument for an unusable ensemble or schedule.
+    void validate() const;
+};
+
+struct ParameterSummary {
+    double mean = 0.0;
+    double sigma = 0.0;
+    double p16 = 0.0;
+    double p50 = 0.0;
+    double p84 = 0.0;
+};
+
+struct RetrievalResult {
+    std::array<ParameterSummary, parameter_count> posterior {};
+    Theta best {};
+    double best_chi2 = 0.0;
+    double acceptance = 0.0;            ///< Accepted fraction of proposals.
+    std::uint64_t evaluations = 0;      ///< Forward-model spectra computed.
+    std::vector<Theta> samples;         ///< Post burn-in, if kept.
+
+    const ParameterSummary& operator[](Param p) const noexcept { return posterior[std::size_t(p)]; }
+};
+
+class EnsembleSampler {
+public:
+    /// Keeps a reference to `model`.
+    EnsembleSampler(const ForwardModel& model, const Prior& prior = {}, const SamplerConfig& config = {});
+
+    /// Samples the posterior of one observation; `stream` picks an
+    /// independent random stream under the configured seed.
+    RetrievalResult run(const Observation& observation, std::uint64_t stream = 0) const;
+
+    const SamplerConfig& config() const noexcept { return config_; }
+    const Prior& prior() const noexcept { return prior_; }
+
+private:
+    const ForwardModel* model_;
+    Prior prior_;
+    SamplerConfig config_;
+};
+
+/// Retrieves every pixel on `scheduler`; pixel i uses stream i.
+std::vector<RetrievalResult> retrieve_pixels(const EnsembleSampler& sampler,
+                                             std::span<const Observation> pixels,
+                                             sched::Scheduler& scheduler);
+
+} // namespace solarlens::retrieval
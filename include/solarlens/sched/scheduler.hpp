@@ -0,0 +1,195 @@
+#pragma once
+
+/// Work-stealing task scheduler shared by the ingest, calibration and
+/// reconstruction stages.
+///
+/// Each worker owns a Chase-Lev deque: tasks a worker spawns go to its own
+/// deque and run LIFO for locality, while idle workers steal FIFO from
+/// random victims, so a burst from one spacecraft spreads across every
+/// core. Tasks submitted from outside the pool go through a shared
+/// injection queue. Idle workers spin briefly, then park on a futex-backed
+/// atomic until new work is published.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "solarlens/sched/ws_deque.hpp"
+
+namespace solarlens::sched {
+
+struct WorkerMetrics {
+    std::size_t queue_depth = 0;  ///< Tasks currently in this worker's deque.
+    std::uint64_t executed = 0;   ///< Tasks run by this worker.
+    std::uint64_t steals = 0;     ///< Tasks taken from other workers.
+    std::uint64_t failed_steals = 0;
+    std::uint64_t parks = 0;      ///< Times the worker went to sleep.
+};
+
+class Scheduler {
+public:
+    /// Starts `workers` threads (at least one).
+    explicit Scheduler(std::size_t workers = std::thread::hardware_concurrency());
+
+    /// Runs every task already submitted, then joins the workers.
+    ~Scheduler();
+
+    Scheduler(const Scheduler&) = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+
+    /// Queues `fn` to run on some worker. From a worker thread it goes to
+    /// that worker's deque, otherwise to the injection queue. Exceptions
+    /// escaping a submitted task terminate the process; use TaskGroup to
+    /// propagate them.
+    template <typename Fn>
+    void submit(Fn&& fn)
+    {
+        submit_node(new TaskImpl<std::decay_t<Fn>>(std::forward<Fn>(fn)));
+    }
+
+    /// Runs one queued task on the calling thread if any is available;
+    /// lets threads that wait on results help instead of blocking.
+    bool try_run_one();
+
+    std::size_t worker_count() const noexcept { return workers_.size(); }
+
+    /// Index of the calling worker in this scheduler, or -1.
+    int current_worker() const noexcept;
+
+    std::vector<WorkerMetrics> worker_metrics() const;
+    std::size_t injection_depth() const noexcept
+    {
+        return injected_size_.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct TaskNode {
+        virtual ~TaskNode() = default;
+        virtual void run() = 0;
+    };
+
+    template <typename Fn>
+    struct TaskImpl final : TaskNode {
+        explicit TaskImpl(Fn f)
+            : fn(std::move(f))
+        {
+        }
+        void run() override { fn(); }
+        Fn fn;
+    };
+
+    struct alignas(64) Worker {
+        WorkStealingDeque<TaskNode*> deque;
+        std::atomic<std::uint64_t> executed {0};
+        std::atomic<std::uint64_t> steals {0};
+        std::atomic<std::uint64_t> failed_steals {0};
+        std::atomic<std::uint64_t> parks {0};
+        std::uint64_t rng = 0;
+        std::thread thread;
+    };
+
+    void submit_node(TaskNode* node);
+    void worker_loop(std::size_t index);
+    TaskNode* find_work(std::size_t self);
+    TaskNode* pop_injected();
+    TaskNode* steal_from_others(std::size_t self, std::uint64_t& rng);
+    bool any_work_visible() const noexcept;
+    void execute(TaskNode* node, Worker* worker);
+    void wake_one();
+
+    std::vector<std::unique_ptr<Worker>> workers_;
+
+    mutable std::mutex injected_mutex_;
+    std::deque<TaskNode*> injected_;
+    std::atomic<std::size_t> injected_size_ {0};
+
+    std::atomic<std::uint64_t> outstanding_ {0}; ///< Submitted but not finished.
+    std::atomic<std::uint32_t> sleepers_ {0};
+    std::atomic<std::uint32_t> wake_epoch_ {0};
+    std::atomic<bool> stopping_ {false};
+};
+
+/// Fork-join scope: run() tasks on a scheduler, wait() for all of them.
+/// The waiting thread executes queued tasks while it waits. The first
+/// exception thrown by a task is rethrown from wait().
+class TaskGroup {
+public:
+    explicit TaskGroup(Scheduler& scheduler)
+        : scheduler_(scheduler)
+    {
+    }
+
+    /// Waits for outstanding tasks; exceptions are discarded here, so call
+    /// wait() explicitly to observe them.
+    ~TaskGroup();
+
+    TaskGroup(const TaskGroup&) = delete;
+    TaskGroup& operator=(const TaskGroup&) = delete;
+
+    template <typename Fn>
+    void run(Fn&& fn)
+    {
+        pending_.fetch_add(1, std::memory_order_relaxed);
+        scheduler_.submit([this, f = std::forward<Fn>(fn)]() mutable {
+            try {
+                f();
+            } catch (...) {
+                record(std::current_exception());
+            }
+            finish();
+        });
+    }
+
+    void wait();
+
+    Scheduler& scheduler() const noexcept { return scheduler_; }
+
+private:
+    void record(std::exception_ptr e) noexcept;
+    void finish() noexcept;
+
+    Scheduler& scheduler_;
+    std::atomic<std::size_t> pending_ {0};
+    std::mutex wake_mutex_; ///< Held by the last finish() across its wake-up.
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+};
+
+/// Calls `fn(lo, hi)` over [begin, end) in chunks of at most `grain`
+/// elements. The range is split recursively so thieves take large halves
+/// first; the calling thread participates.
+template <typename Fn>
+void parallel_for(Scheduler& scheduler, std::size_t begin, std::size_t end, std::size_t grain,
+                  Fn&& fn)
+{
+    if (begin >= end)
+        return;
+    grain = grain == 0 ? 1 : grain;
+    TaskGroup group(scheduler);
+    struct Splitter {
+        TaskGroup& group;
+        std::size_t grain;
+        Fn& fn;
+        void operator()(std::size_t lo, std::size_t hi) const
+        {
+            while (hi - lo > grain) {
+                const std::size_t mid = lo + (hi - lo) / 2;
+                group.run([self = *this, mid, hi] { self(mid, hi); });
+                hi = mid;
+            }
+            fn(lo, hi);
+        }
+    };
+    Splitter {group, grain, fn}(begin, end);
+    group.wait();
+}
+
+} // namespace solarlens::sched
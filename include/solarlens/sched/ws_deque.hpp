@@ -0,0 +1,135 @@
+#pragma once
+
+/// Chase-Lev work-stealing deque (Le, Pop, Cohen, Zappa Nardelli, PPoPP'13).
+///
+/// The owning thread pushes and takes at the bottom; any thread may steal
+/// from the top. The ring grows on demand; outgrown rings are retired to a
+/// list and freed with the deque, since a concurrent thief may still be
+/// reading one.
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+namespace solarlens::sched {
+
+template <typename T>
+class WorkStealingDeque {
+    static_assert(std::is_pointer_v<T>, "elements are stored in atomics; use pointers");
+
+public:
+    explicit WorkStealingDeque(std::size_t capacity = 256)
+    {
+        std::size_t c = 1;
+        while (c < capacity)
+            c <<= 1;
+        rings_.push_back(std::make_unique<Ring>(c));
+        ring_.store(rings_.back().get(), std::memory_order_relaxed);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    /// Owner only.
+    void push(T item)
+    {
+        const std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        const std::int64_t t = top_.load(std::memory_order_acquire);
+        Ring* r = ring_.load(std::memory_order_relaxed);
+        if (b - t > static_cast<std::int64_t>(r->mask)) {
+            r = grow(r, t, b);
+            ring_.store(r, std::memory_order_release);
+        }
+        r->put(b, item);
+        // A release store rather than the paper's release fence + relaxed
+        // store: same code on x86/ARM, and visible to ThreadSanitizer.
+        bottom_.store(b + 1, std::memory_order_release);
+    }
+
+    /// Owner only; LIFO. Returns nullptr when empty.
+    T take()
+    {
+        const std::int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        Ring* r = ring_.load(std::memory_order_relaxed);
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top_.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        T item = r->get(b);
+        if (t == b) {
+            // Last element: race thieves for it.
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                              std::memory_order_relaxed))
+                item = nullptr;
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    /// Any thread; FIFO. Returns nullptr when empty or when it lost a race.
+    T steal()
+    {
+        std::int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b)
+            return nullptr;
+        Ring* r = ring_.load(std::memory_order_acquire);
+        T item = r->get(t);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed))
+            return nullptr;
+        return item;
+    }
+
+    /// Racy snapshot of the element count, for metrics and idle checks.
+    std::size_t size_approx() const noexcept
+    {
+        const std::int64_t b = bottom_.load(std::memory_order_relaxed);
+        const std::int64_t t = top_.load(std::memory_order_relaxed);
+        return b > t ? static_cast<std::size_t>(b - t) : 0;
+    }
+
+private:
+    struct Ring {
+        explicit Ring(std::size_t capacity)
+            : mask(capacity - 1)
+            , slots(new std::atomic<T>[capacity])
+        {
+        }
+
+        T get(std::int64_t i) const noexcept
+        {
+            return slots[static_cast<std::size_t>(i) & mask].load(std::memory_order_relaxed);
+        }
+        void put(std::int64_t i, T v) noexcept
+        {
+            slots[static_cast<std::size_t>(i) & mask].store(v, std::memory_order_relaxed);
+        }
+
+        std::size_t mask;
+        std::unique_ptr<std::atomic<T>[]> slots;
+    };
+
+    Ring* grow(Ring* old, std::int64_t t, std::int64_t b)
+    {
+        auto bigger = std::make_unique<Ring>((old->mask + 1) * 2);
+        for (std::int64_t i = t; i < b; ++i)
+            bigger->put(i, old->get(i));
+        rings_.push_back(std::move(bigger));
+        return rings_.back().get();
+    }
+
+    alignas(64) std::atomic<std::int64_t> top_ {0};
+    alignas(64) std::atomic<std::int64_t> bottom_ {0};
+    std::atomic<Ring*> ring_ {nullptr};
+    std::vector<std::unique_ptr<Ring>> rings_; // Owner-only.
+};
+
+} // namespace solarlens::sched
@@ -0,0 +1,62 @@
+#pragma once
+
+/// Coronagraph frames as image telemetry.
+///
+/// A frame travels as space packets on `image_apid`, each carrying whole
+/// rows of big-endian 16-bit counts behind a 12-byte big-endian header
+/// { u32 frame, u16 width, u16 height, u16 first_row, u16 rows }.
+/// FrameAssembler rebuilds frames on the ground from the packets the
+/// ingest pipeline delivers, in any order and interleaved across craft.
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+#include "solarlens/ingest/pipeline.hpp"
+#include "solarlens/ingest/tm_encoder.hpp"
+
+namespace solarlens::sim {
+
+inline constexpr std::uint16_t image_apid = 0x100;
+inline constexpr std::size_t image_packet_header_size = 12;
+
+/// Sends `counts` (width x height) through `encoder`, `rows_per_packet`
+/// rows per packet. `sequence` is the APID's packet counter and advances.
+void send_frame(std::uint32_t frame, std::span<const std::uint16_t> counts, std::uint32_t width,
+                std::uint32_t height, std::uint32_t rows_per_packet, std::uint16_t& sequence,
+                ingest::TmEncoder& encoder, const ingest::CaduSink& sink);
+
+class FrameAssembler {
+public:
+    struct Frame {
+        std::uint16_t spacecraft = 0;
+        std::uint32_t index = 0;
+        std::uint32_t width = 0;
+        std::uint32_t height = 0;
+        std::vector<float> pixels; ///< Counts as float, row-major.
+    };
+
+    /// Consumes one packet; packets on other APIDs are ignored. Returns
+    /// false for a malformed image packet.
+    bool add(const ingest::PacketRef& packet);
+
+    /// Moves out every frame whose rows have all arrived.
+    std::vector<Frame> take_completed();
+
+    std::size_t incomplete() const noexcept { return partial_.size(); }
+    std::uint64_t malformed() const noexcept { return malformed_; }
+
+private:
+    struct Partial {
+        Frame frame;
+        std::uint32_t rows_seen = 0;
+    };
+
+    std::unordered_map<std::uint64_t, Partial> partial_;
+    std::vector<Frame> completed_;
+    std::uint64_t malformed_ = 0;
+};
+
+} // namespace solarlens::sim
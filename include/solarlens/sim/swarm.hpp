@@ -0,0 +1,128 @@
+#pragma once
+
+/// Synthetic observations of an exoplanet through the solar gravitational
+/// lens by a swarm of spacecraft near the focal line.
+///
+/// The truth is a map of the planet disc (limb darkening, bright polar
+/// caps, a few continents) on the reconstruction grid. Each spacecraft
+/// rasters its own band of the image plane; at every stop it measures the
+/// truth convolved with the SGL PSF, which its coronagraph records as an
+/// Einstein ring on top of the corona, zodiacal light and detector noise,
+/// with the whole scene offset by pointing jitter. Frames are quantised
+/// to 16-bit counts as they would be downlinked.
+///
+/// Everything is reproducible: frame (craft, index) depends only on the
+/// config, whatever order frames are generated in.
+
+#include <complex>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "solarlens/calib/corona.hpp"
+#include "solarlens/core/image.hpp"
+#include "solarlens/recon/psf_kernel.hpp"
+
+namespace solarlens::sim {
+
+struct SwarmConfig {
+    std::size_t spacecraft = 8;
+    std::size_t frames_per_craft = 128;
+    std::uint32_t map_size = 32;      ///< Reconstruction grid side, pixels.
+    std::uint32_t frame_size = 256;   ///< Coronagraph frame side, pixels.
+    recon::SglPsf::Params psf {650.0, 1.0e-6, 1.0, 8.0};
+
+    double planet_radius = 0.4;       ///< Disc radius as a fraction of the map.
+    double corona_counts = 2.0e4;     ///< Corona at the inner fit radius.
+    double zodiacal_counts = 20.0;
+    double ring_peak_counts = 60.0;   ///< Ring peak for the disc-centre flux.
+    double ring_width_px = 1.5;       ///< Gaussian sigma of the ring profile.
+    double read_noise = 3.0;          ///< Counts RMS, added to shot noise.
+    double jitter_px = 0.2;           ///< Pointing jitter RMS per axis.
+    double position_scatter_px = 0.25; ///< Raster stop scatter, map pixels.
+
+    std::size_t channels = 256;       ///< Baseband FFT length per integration.
+    std::size_t spectra = 64;
+
+    std::uint64_t seed = 1;
+
+    /// Throws std::invalid_argument for unusable values.
+    void validate() const;
+};
+
+/// What a frame really contained.
+struct FrameTruth {
+    float u = 0;
+    float v = 0;
+    double flux = 0;       ///< Noise-free ring flux.
+    float jitter_x = 0;
+    float jitter_y = 0;
+};
+
+/// Coronagraph geometry of a frame_size frame with a ring of the given
+/// width: what SwarmSimulator::geometry() uses, and what calibrating
+/// recorded frames from the same optics needs.
+calib::CoronaGeometry coronagraph_geometry(std::uint32_t frame_size, double ring_width_px);
+
+/// Ring flux extracted from a corona-subtracted frame.
+struct RingPhotometry {
+    double flux = 0;
+    double sigma = 0;
+    std::size_t pixels = 0;
+};
+
+class SwarmSimulator {
+public:
+    explicit SwarmSimulator(const SwarmConfig& config);
+
+    const SwarmConfig& config() const noexcept { return config_; }
+    std::size_t frame_count() const noexcept
+    {
+        return config_.spacecraft * config_.frames_per_craft;
+    }
+
+    /// Truth map, map_size^2 values, row-major.
+    std::span<const float> planet() const noexcept { return planet_; }
+    const recon::SglPsf& psf() const noexcept { return psf_; }
+
+    /// Coronagraph geometry of every frame; the ring sits between
+    /// ring_inner and ring_outer.
+    const calib::CoronaGeometry& geometry() const noexcept { return geometry_; }
+
+    /// Nominal raster position of `craft` at stop `frame`, map pixels.
+    void position(std::size_t craft, std::size_t frame, float& u, float& v) const noexcept;
+
+    /// Noise-free ring flux at image-plane position (u, v).
+    double flux_at(double u, double v) const noexcept;
+
+    /// Renders frame `frame` of `craft` into `counts` (frame_size^2).
+    FrameTruth render(std::size_t craft, std::size_t frame, std::span<std::uint16_t> counts) const;
+
+    /// Matched-filter ring flux of a calibrated frame, in the same units as
+    /// flux_at(). The noise comes from the residual in the ring annulus.
+    RingPhotometry measure_ring(core::ImageView<const float> calibrated) const;
+
+    /// One integration of complex baseband per spacecraft for the
+    /// correlator: a common sky signal plus receiver noise, station-major.
+    void baseband(std::size_t integration, std::span<std::complex<float>> samples) const;
+
+    /// Residual delays matching baseband(), in samples.
+    std::span<const double> station_delays() const noexcept { return delays_; }
+
+private:
+    void render_planet();
+
+    SwarmConfig config_;
+    recon::SglPsf psf_;
+    recon::SampledKernel kernel_;
+    calib::CoronaGeometry geometry_;
+    std::vector<float> planet_;
+    std::vector<float> background_; ///< Corona plus zodiacal, nominal pointing.
+    std::vector<float> grad_x_;     ///< d background / dx, for jitter.
+    std::vector<float> grad_y_;
+    std::vector<double> delays_;
+    double ring_gain_ = 1.0;        ///< Peak counts per unit flux.
+};
+
+} // namespace solarlens::sim
@@ -0,0 +1,84 @@
+#pragma once
+
+/// Telemetry dictionaries.
+///
+/// A dictionary lists each craft model's housekeeping packets and their
+/// parameters in a small line-oriented text format:
+///
+///     # comment
+///     dictionary cubesat_a
+///     packet eps_housekeeping apid 0x210 length 96
+///       param battery_voltage at 0 width 12 uint poly 0 0.00488 unit V
+///       param panel_current   at 12 width 10 int poly 0 0.01 unit A
+///       param mode            at 22 width 2 uint
+///     end
+///
+/// Bit offsets count from the MSB of the packet data field's first byte.
+/// `write_decoder_header` turns a dictionary into Parameter/PacketLayout
+/// specialisations for compiled decoders; `decode_parameter` interprets a
+/// definition at runtime for tools that only learn the dictionary late.
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <iosfwd>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "solarlens/tm/parameter.hpp"
+
+namespace solarlens::core {
+class Snapshot;
+class SnapshotWriter;
+}
+
+namespace solarlens::tm {
+
+struct ParameterDef {
+    std::string name;
+    std::size_t bit_offset = 0;
+    std::size_t bit_width = 0;
+    Encoding encoding = Encoding::unsigned_int;
+    /// Polynomial coefficients, lowest order first; empty means raw.
+    std::vector<double> calibration;
+    std::string unit;
+};
+
+struct PacketDef {
+    std::string name;
+    std::uint16_t apid = 0;
+    std::size_t length = 0;  ///< Data field bytes.
+    std::vector<ParameterDef> parameters;
+};
+
+struct Dictionary {
+    std::string name;
+    std::vector<PacketDef> packets;
+
+    const PacketDef* find(std::uint16_t apid) const noexcept;
+    std::size_t parameter_count() const noexcept;
+};
+
+/// Throws std::runtime_error naming `source` and the line on bad input.
+Dictionary parse_dictionary(std::istream& in, const std::string& source);
+Dictionary load_dictionary(const std::filesystem::path& path);
+
+/// Writes `dictionary` as snapshot section `section`.
+void snapshot_dictionary(const Dictionary& dictionary, core::SnapshotWriter& writer, std::string_view section);
+
+/// Rebuilds a dictionary written by snapshot_dictionary(); throws
+/// std::runtime_error if the section is missing or malformed.
+Dictionary restore_dictionary(const core::Snapshot& snapshot, std::string_view section);
+
+/// Emits a self-contained header declaring namespace
+/// `solarlens::tm::dict::<name>` with one struct per packet and a
+/// `dispatch` over APIDs.
+void write_decoder_header(const Dictionary& dictionary, std::ostream& out);
+
+/// Engineering value of `param` in a data field, interpreted from the
+/// definition. `data` must cover the field.
+double decode_parameter(const ParameterDef& param, std::span<const std::byte> data) noexcept;
+
+} // namespace solarlens::tm
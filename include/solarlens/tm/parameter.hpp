@@ -0,0 +1,179 @@
+#pragma once
+
+/// Compile-time housekeeping parameters.
+///
+/// A Parameter names a bit field of a packet's data field by offset and
+/// width (MSB-first, as CCSDS numbers bits) together with its encoding and
+/// calibration, all as template arguments. Extraction therefore compiles
+/// to a fixed-size big-endian load, one shift and one mask; there is no
+/// table to walk at decommutation time. Layouts are normally generated
+/// from a telemetry dictionary by `solarlens-tm-dict` rather than written
+/// by hand.
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+
+namespace solarlens::tm {
+
+enum class Encoding : std::uint8_t {
+    unsigned_int,
+    signed_int,  ///< Two's complement.
+    ieee_float,  ///< 32 or 64 bits, byte aligned.
+};
+
+/// String literal usable as a template argument.
+template <std::size_t N>
+struct FixedString {
+    constexpr FixedString(const char (&s)[N]) noexcept { std::copy_n(s, N, text); }
+    constexpr std::string_view view() const noexcept { return {text, N - 1}; }
+
+    char text[N] {};
+};
+
+namespace detail {
+
+/// Big-endian load of exactly N bytes.
+template <std::size_t N>
+constexpr std::uint64_t load_be(const std::byte* p) noexcept
+{
+    static_assert(N >= 1 && N <= 8);
+    std::uint64_t v = 0;
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+        ((v = (v << 8) | std::to_integer<std::uint64_t>(p[I])), ...);
+    }(std::make_index_sequence<N>());
+    return v;
+}
+
+} // namespace detail
+
+/// Bits [BitOffset, BitOffset + BitWidth) of a packet data field.
+template <std::size_t BitOffset, std::size_t BitWidth>
+struct BitField {
+    static_assert(BitWidth >= 1 && BitWidth <= 64, "tm: field width must be 1..64 bits");
+
+    static constexpr std::size_t first_byte = BitOffset / 8;
+    static constexpr std::size_t byte_count = (BitOffset % 8 + BitWidth + 7) / 8;
+    static constexpr unsigned shift = static_cast<unsigned>(byte_count * 8 - BitOffset % 8 - BitWidth);
+    static constexpr std::uint64_t mask = BitWidth == 64 ? ~std::uint64_t {0}
+                                                         : (std::uint64_t {1} << BitWidth) - 1;
+    /// One past the last byte read.
+    static constexpr std::size_t end_byte = first_byte + byte_count;
+
+    static_assert(byte_count <= 8, "tm: field must lie within eight consecutive bytes");
+
+    static constexpr std::uint64_t extract(const std::byte* data) noexcept
+    {
+        return (detail::load_be<byte_count>(data + first_byte) >> shift) & mask;
+    }
+};
+
+/// Raw value, no calibration.
+struct Uncalibrated {
+    template <typename Raw>
+    static constexpr Raw apply(Raw raw) noexcept
+    {
+        return raw;
+    }
+};
+
+/// Engineering value c0 + c1 x + c2 x^2 + ... of the raw value x.
+template <double... Coefficients>
+struct Polynomial {
+    static_assert(sizeof...(Coefficients) > 0);
+
+    template <typename Raw>
+    static constexpr double apply(Raw raw) noexcept
+    {
+        constexpr std::array<double, sizeof...(Coefficients)> c {Coefficients...};
+        const double x = static_cast<double>(raw);
+        double y = c.back();
+        for (std::size_t i = c.size() - 1; i-- > 0;)
+            y = y * x + c[i];
+        return y;
+    }
+};
+
+template <FixedString Name, std::size_t BitOffset, std::size_t BitWidth,
+          Encoding Enc = Encoding::unsigned_int, typename Calibration = Uncalibrated>
+struct Parameter {
+    using field = BitField<BitOffset, BitWidth>;
+
+    static_assert(Enc != Encoding::ieee_float || ((BitWidth == 32 || BitWidth == 64) && BitOffset % 8 == 0),
+                  "tm: float parameters must be byte-aligned 32- or 64-bit fields");
+
+    using raw_type = std::conditional_t<
+        Enc == Encoding::unsigned_int, std::uint64_t,
+        std::conditional_t<Enc == Encoding::signed_int, std::int64_t,
+                           std::conditional_t<BitWidth == 32, float, double>>>;
+    using value_type = decltype(Calibration::apply(raw_type {}));
+
+    static constexpr std::string_view name = Name.view();
+    static constexpr std::size_t bit_offset = BitOffset;
+    static constexpr std::size_t bit_width = BitWidth;
+    static constexpr Encoding encoding = Enc;
+
+    /// `data` is the packet data field and holds at least field::end_byte
+    /// bytes; PacketLayout checks that once per packet.
+    static constexpr raw_type raw(const std::byte* data) noexcept
+    {
+        const std::uint64_t bits = field::extract(data);
+        if constexpr (Enc == Encoding::unsigned_int) {
+            return bits;
+        } else if constexpr (Enc == Encoding::signed_int) {
+            if constexpr (BitWidth == 64)
+                return static_cast<std::int64_t>(bits);
+            else
+                return static_cast<std::int64_t>(bits << (64 - BitWidth)) >> (64 - BitWidth);
+        } else if constexpr (BitWidth == 32) {
+            return std::bit_cast<float>(static_cast<std::uint32_t>(bits));
+        } else {
+            return std::bit_cast<double>(bits);
+        }
+    }
+
+    static constexpr value_type value(const std::byte* data) noexcept
+    {
+        return Calibration::apply(raw(data));
+    }
+};
+
+/// A packet type: its APID, data field length and parameters.
+template <std::uint16_t Apid, std::size_t Length, typename... Params>
+struct PacketLayout {
+    static constexpr std::uint16_t apid = Apid;
+    static constexpr std::size_t length = Length;
+    static constexpr std::size_t parameter_count = sizeof...(Params);
+
+    static_assert(((Params::field::end_byte <= Length) && ...),
+                  "tm: parameter extends past the packet data field");
+
+    using parameters = std::tuple<Params...>;
+
+    static constexpr std::size_t index_of(std::string_view name) noexcept
+    {
+        constexpr std::array<std::string_view, sizeof...(Params)> names {Params::name...};
+        for (std::size_t i = 0; i < names.size(); ++i)
+            if (names[i] == name)
+                return i;
+        return names.size();
+    }
+
+    /// Parameter by name, resolved at compile time.
+    template <FixedString Name>
+    using parameter = std::tuple_element_t<index_of(Name.view()), parameters>;
+
+    /// Calls `fn(Param{}, value)` for every parameter in layout order.
+    template <typename Fn>
+    static constexpr void for_each(const std::byte* data, Fn&& fn)
+    {
+        (fn(Params {}, Params::value(data)), ...);
+    }
+};
+
+} // namespace solarlens::tm
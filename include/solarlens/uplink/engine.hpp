@@ -0,0 +1,304 @@
+#pragma once
+
+/// Light-time-aware command planning and uplink engine.
+///
+/// At 650 AU a command reaches the spacecraft ~3.75 days after it leaves
+/// the antenna, so every sequence is planned against predicted state and
+/// spends almost all its life waiting: for a DSN allocation, for its
+/// uplink slot, for the on-board execution time, for telemetry confirming
+/// it. Each sequence is a C++20 coroutine (uplink::Sequence) that
+/// co_awaits those events; waiting costs a few hundred bytes of frame and
+/// no thread, so thousands of sequences per spacecraft fit in one engine.
+///
+/// The engine is a discrete-event loop over mission time. run_until()
+/// jumps the clock to the earliest pending event and resumes every
+/// sequence due at that instant as one wave; with a scheduler the wave is
+/// spread across its workers. Between waves the engine grants the uplink
+/// requests made during the wave, in order of priority (higher first)
+/// then sequence id, each taking the earliest room in its spacecraft's
+/// contact windows. Waves are resumed in id order as well, so a plan
+/// depends only on its inputs, never on the worker count.
+///
+/// Mission time is seconds since J2000 TDB. The engine is driven either
+/// as a planner (run_until() a horizon, as fast as the CPU allows) or in
+/// real time, by a driver that sleeps until next_event() and then calls
+/// run_until() with the wall-clock mission time.
+///
+///     Sequence pass(UplinkEngine& e, std::uint32_t craft) {
+///         auto rx = co_await e.uplink(craft, 512);       // transmitted
+///         co_await e.observed(craft, rx.onboard + 600);  // executed, seen
+///     }
+///     engine.spawn(pass(engine, 7));
+///     engine.run_until(horizon);
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+#include "solarlens/uplink/sequence.hpp"
+
+namespace solarlens::core {
+class Snapshot;
+class SnapshotWriter;
+}
+
+namespace solarlens::nav {
+class SwarmState;
+}
+
+namespace solarlens::sched {
+class Scheduler;
+}
+
+namespace solarlens::uplink {
+
+using MissionTime = double; ///< Seconds since J2000 TDB.
+
+/// One-way light time to `spacecraft` for a signal at mission time `t`,
+/// seconds. Called concurrently from sequences, so it must be thread-safe.
+using LightTimeModel = std::function<double(std::uint32_t spacecraft, MissionTime t)>;
+
+/// Every spacecraft at a fixed distance from Earth.
+LightTimeModel constant_light_time(double distance_au);
+
+/// Light time from predicted state: each spacecraft (index into
+/// `predicted`, valid at `epoch_days` since J2000) moves on a straight
+/// line from its predicted position, and Earth follows the ephemeris.
+/// Throws std::out_of_range from the model for an unknown spacecraft.
+LightTimeModel predicted_light_time(const nav::SwarmState& predicted, double epoch_days);
+
+/// A DSN allocation: the span a station can transmit to one spacecraft.
+struct ContactWindow {
+    MissionTime start = 0.0;
+    MissionTime end = 0.0;
+    std::uint32_t station = 0;
+    double uplink_bps = 2000.0;
+};
+
+struct UplinkReceipt {
+    std::uint32_t station = 0;
+    MissionTime transmit_start = 0.0;
+    MissionTime transmit_end = 0.0;
+    MissionTime onboard = 0.0; ///< Last bit received by the spacecraft.
+};
+
+struct EngineConfig {
+    LightTimeModel light_time; ///< Empty means constant_light_time(650).
+    double command_gap_s = 1.0; ///< Idle carrier between consecutive commands in a window.
+    std::size_t wave_grain = 64; ///< Sequences resumed per scheduler task.
+
+    /// Throws std::invalid_argument for unusable settings.
+    void validate() const;
+};
+
+struct EngineStats {
+    std::uint64_t spawned = 0;
+    std::uint64_t completed = 0;
+    std::uint64_t failed = 0;      ///< Completed by an escaping exception.
+    std::uint64_t resumptions = 0;
+    std::uint64_t waves = 0;
+    std::uint64_t uplinks = 0;     ///< Requests granted.
+    std::uint64_t peak_live = 0;   ///< Most sequences alive at once.
+};
+
+class UplinkEngine {
+public:
+    /// Without a scheduler every wave runs on the thread calling run_until().
+    explicit UplinkEngine(const EngineConfig& config = {}, sched::Scheduler* scheduler = nullptr);
+
+    /// Destroys every sequence still suspended.
+    ~UplinkEngine();
+
+    UplinkEngine(const UplinkEngine&) = delete;
+    UplinkEngine& operator=(const UplinkEngine&) = delete;
+
+    /// Starts `sequence` in the next wave at the current time and returns
+    /// its id. Ids count up from 1 in spawn order; spawning from inside a
+    /// wave numbers in thread order, so reproducible plans spawn between
+    /// run_until() calls and nest work with co_await.
+    std::uint64_t spawn(Sequence sequence, int priority = 0);
+
+    /// Adds a DSN allocation for `spacecraft`. Uplink requests waiting for
+    /// room are retried against it. Throws std::invalid_argument for an
+    /// empty window or a non-positive rate.
+    void add_window(std::uint32_t spacecraft, const ContactWindow& window);
+
+    /// Processes every event up to and including `horizon`, then leaves
+    /// the clock at `horizon`. Returns the number of resumptions.
+    std::size_t run_until(MissionTime horizon);
+
+    /// Time of the earliest pending event, if any. Sequences waiting on
+    /// an uplink slot that no window can hold yet are not events.
+    std::optional<MissionTime> next_event() const;
+
+    /// Current mission time. Stable for the whole of a wave.
+    MissionTime now() const noexcept { return now_; }
+
+    double light_time(std::uint32_t spacecraft, MissionTime t) const { return light_time_(spacecraft, t); }
+
+    std::size_t live() const noexcept { return live_.load(std::memory_order_relaxed); }
+
+    /// Uplink requests no window has room for yet.
+    std::size_t stalled() const;
+
+    EngineStats stats() const;
+
+    /// Message of the first exception that escaped a top-level sequence.
+    std::string first_error() const;
+
+    /// Writes the clock, every contact window and how much of each is
+    /// already booked as snapshot section `section`. Sequences are code, not
+    /// data, and are not captured: a restarted daemon respawns those it
+    /// still owns, and their uplinks book after the restored cursors, so
+    /// airtime already granted is never given away twice. Call between
+    /// run_until() calls.
+    void snapshot_timeline(core::SnapshotWriter& writer, std::string_view section) const;
+
+    /// Restores a timeline written by snapshot_timeline(). Throws
+    /// std::logic_error unless the engine has no windows and has spawned
+    /// nothing, and std::runtime_error for a malformed section.
+    void restore_timeline(const core::Snapshot& snapshot, std::string_view section);
+
+    // Awaitables ------------------------------------------------------
+
+    struct TimeAwaiter {
+        UplinkEngine& engine;
+        MissionTime t;
+
+        bool await_ready() const noexcept { return t <= engine.now_; }
+        void await_suspend(Sequence::Handle h) { engine.schedule(h, t); }
+        MissionTime await_resume() const noexcept { return engine.now_; }
+    };
+
+    struct UplinkAwaiter {
+        UplinkEngine& engine;
+        std::uint32_t spacecraft;
+        std::uint32_t bytes;
+        UplinkReceipt receipt {};
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(Sequence::Handle h) { engine.request(*this, h); }
+        UplinkReceipt await_resume() const noexcept { return receipt; }
+    };
+
+    /// Resumes at mission time `t` (immediately if it has passed) and
+    /// yields the time resumed at.
+    TimeAwaiter at(MissionTime t) noexcept { return {*this, t}; }
+    TimeAwaiter after(double seconds) noexcept { return {*this, now_ + seconds}; }
+
+    /// Reserves the earliest slot for a `bytes`-long command in the
+    /// spacecraft's windows and resumes when transmission ends. Throws
+    /// std::invalid_argument for an empty command.
+    UplinkAwaiter uplink(std::uint32_t spacecraft, std::uint32_t bytes);
+
+    /// Resumes when telemetry of an on-board event at `onboard` reaches
+    /// the ground.
+    TimeAwaiter observed(std::uint32_t spacecraft, MissionTime onboard)
+    {
+        return {*this, onboard + light_time(spacecraft, onboard)};
+    }
+
+private:
+    friend class Event;
+
+    struct Timer {
+        MissionTime time;
+        std::uint64_t id;
+        Sequence::Handle handle;
+    };
+
+    struct Request {
+        UplinkAwaiter* awaiter;
+        Sequence::Handle handle;
+    };
+
+    struct Slot {
+        ContactWindow window;
+        MissionTime cursor; // Earliest free instant in the window.
+    };
+
+    struct Craft {
+        std::vector<Slot> slots; // By start time.
+        std::size_t first = 0;   // Slots before this one have closed.
+    };
+
+    void schedule(Sequence::Handle h, MissionTime t);
+    void make_ready(Sequence::Handle h);
+    void request(UplinkAwaiter& awaiter, Sequence::Handle h);
+    void grant_uplinks();
+    bool grant(Request& r);
+    void resume_wave(std::vector<Sequence::Handle>& wave);
+    void resume_one(Sequence::Handle h);
+    void finish(Sequence::Handle root);
+
+    EngineConfig config_;
+    LightTimeModel light_time_;
+    sched::Scheduler* scheduler_;
+
+    // Written only between waves.
+    MissionTime now_ = 0.0;
+
+    mutable std::mutex queue_mutex_;
+    std::vector<Timer> timers_; // Min-heap on time.
+    std::vector<Sequence::Handle> ready_;
+    std::vector<Request> requests_;
+    std::vector<Request> stalled_;
+    std::unordered_map<std::uint32_t, Craft> crafts_;
+    std::unordered_map<std::uint64_t, Sequence::Handle> roots_;
+
+    std::uint64_t next_id_ = 1;
+    std::atomic<std::size_t> live_ {0};
+    std::atomic<std::uint64_t> completed_ {0};
+    std::atomic<std::uint64_t> failed_ {0};
+    std::atomic<std::uint64_t> resumptions_ {0};
+    std::uint64_t spawned_ = 0;
+    std::uint64_t waves_ = 0;
+    std::uint64_t uplinks_ = 0;
+    std::uint64_t peak_live_ = 0;
+
+    mutable std::mutex error_mutex_;
+    std::string first_error_;
+};
+
+/// One-shot event for coordinating sequences, e.g. a command that may
+/// only go up once another spacecraft has confirmed its manoeuvre.
+/// Waiters resume in the wave after set(); awaiting a set event does not
+/// suspend. Must not outlive its engine.
+class Event {
+public:
+    explicit Event(UplinkEngine& engine)
+        : engine_(engine)
+    {
+    }
+
+    Event(const Event&) = delete;
+    Event& operator=(const Event&) = delete;
+
+    void set();
+    bool is_set() const;
+
+    struct Awaiter {
+        Event& event;
+
+        bool await_ready() const { return event.is_set(); }
+        bool await_suspend(Sequence::Handle h);
+        void await_resume() const noexcept {}
+    };
+    Awaiter operator co_await() noexcept { return {*this}; }
+
+private:
+    UplinkEngine& engine_;
+    mutable std::mutex mutex_;
+    bool set_ = false;
+    std::vector<Sequence::Handle> waiters_;
+};
+
+} // namespace solarlens::uplink
@@ -0,0 +1,113 @@
+#pragma once
+
+/// Coroutine type for command sequences run by UplinkEngine.
+///
+/// A Sequence is a lazily started C++20 coroutine. Top-level sequences are
+/// handed to UplinkEngine::spawn(); inside a sequence, `co_await child()`
+/// runs another Sequence to completion first. The child runs in the
+/// parent's frame of reference (same engine, same identity) and is
+/// resumed by symmetric transfer, so nesting costs no thread and no
+/// stack. An exception escaping a child is rethrown from the co_await;
+/// one escaping a top-level sequence is counted by the engine.
+
+#include <coroutine>
+#include <cstdint>
+#include <exception>
+#include <utility>
+
+namespace solarlens::uplink {
+
+class UplinkEngine;
+
+class Sequence {
+public:
+    struct promise_type {
+        UplinkEngine* engine = nullptr;
+        std::uint64_t id = 0;  ///< Top-level sequence this frame belongs to.
+        int priority = 0;      ///< Higher wins when uplink requests compete.
+        std::coroutine_handle<promise_type> root;
+        std::coroutine_handle<> continuation;
+        std::exception_ptr error;
+
+        Sequence get_return_object() noexcept
+        {
+            return Sequence(std::coroutine_handle<promise_type>::from_promise(*this));
+        }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+
+        struct FinalAwaiter {
+            bool await_ready() noexcept { return false; }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<promise_type> h) noexcept
+            {
+                if (const auto next = h.promise().continuation)
+                    return next;
+                return std::noop_coroutine();
+            }
+            void await_resume() noexcept {}
+        };
+        FinalAwaiter final_suspend() noexcept { return {}; }
+
+        void return_void() noexcept {}
+        void unhandled_exception() noexcept { error = std::current_exception(); }
+    };
+
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Sequence() = default;
+    Sequence(Sequence&& other) noexcept
+        : handle_(std::exchange(other.handle_, {}))
+    {
+    }
+    Sequence& operator=(Sequence&& other) noexcept
+    {
+        if (this != &other) {
+            if (handle_)
+                handle_.destroy();
+            handle_ = std::exchange(other.handle_, {});
+        }
+        return *this;
+    }
+    ~Sequence()
+    {
+        if (handle_)
+            handle_.destroy();
+    }
+
+    /// Gives up ownership, for the engine.
+    Handle release() noexcept { return std::exchange(handle_, {}); }
+
+    /// Awaiting a Sequence runs it as a child of the awaiting one.
+    struct ChildAwaiter {
+        Handle child;
+
+        bool await_ready() noexcept { return !child || child.done(); }
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> parent) noexcept
+        {
+            promise_type& p = child.promise();
+            const auto& q = parent.promise();
+            p.engine = q.engine;
+            p.id = q.id;
+            p.priority = q.priority;
+            p.root = q.root;
+            p.continuation = parent;
+            return child;
+        }
+        void await_resume()
+        {
+            if (child && child.promise().error)
+                std::rethrow_exception(child.promise().error);
+        }
+    };
+    ChildAwaiter operator co_await() && noexcept { return {handle_}; }
+
+private:
+    explicit Sequence(Handle h) noexcept
+        : handle_(h)
+    {
+    }
+
+    Handle handle_;
+};
+
+} // namespace solarlens::uplink
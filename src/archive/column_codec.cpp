@@ -0,0 +1,130 @@
+#include "column_codec.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#ifdef SOLARLENS_HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+namespace solarlens::archive::detail {
+
+namespace {
+
+std::int64_t load_value(ColumnType type, const std::byte* p) noexcept
+{
+    if (type == ColumnType::uint32) {
+        std::uint32_t v = 0;
+        std::memcpy(&v, p, 4);
+        return v;
+    }
+    std::int64_t v = 0;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+void store_value(ColumnType type, std::int64_t v, std::byte* p) noexcept
+{
+    if (type == ColumnType::uint32) {
+        const auto u = static_cast<std::uint32_t>(v);
+        std::memcpy(p, &u, 4);
+    } else {
+        std::memcpy(p, &v, 8);
+    }
+}
+
+} // namespace
+
+void encode_delta(ColumnType type, std::span<const std::byte> values, std::vector<std::byte>& out)
+{
+    const std::size_t width = column_width(type);
+    std::int64_t prev = 0;
+    for (std::size_t i = 0; i < values.size(); i += width) {
+        const std::int64_t v = load_value(type, values.data() + i);
+        // Wrapping difference, then zigzag so small negative steps stay short.
+        const auto d = static_cast<std::uint64_t>(v) - static_cast<std::uint64_t>(prev);
+        std::uint64_t z = (d << 1) ^ (0 - (d >> 63));
+        prev = v;
+        while (z >= 0x80) {
+            out.push_back(static_cast<std::byte>(z | 0x80));
+            z >>= 7;
+        }
+        out.push_back(static_cast<std::byte>(z));
+    }
+}
+
+bool decode_delta(ColumnType type, std::span<const std::byte> in, std::span<std::byte> out)
+{
+    const std::size_t width = column_width(type);
+    std::size_t pos = 0;
+    std::uint64_t prev = 0;
+    for (std::size_t i = 0; i < out.size(); i += width) {
+        std::uint64_t z = 0;
+        for (unsigned shift = 0;; shift += 7) {
+            if (pos == in.size() || shift > 63)
+                return false;
+            const auto b = std::to_integer<std::uint64_t>(in[pos++]);
+            z |= (b & 0x7F) << shift;
+            if (b < 0x80)
+                break;
+        }
+        prev += (z >> 1) ^ (0 - (z & 1));
+        store_value(type, static_cast<std::int64_t>(prev), out.data() + i);
+    }
+    return pos == in.size();
+}
+
+void shuffle(std::size_t width, std::span<const std::byte> values, std::vector<std::byte>& out)
+{
+    const std::size_t n = values.size() / width;
+    const std::size_t base = out.size();
+    out.resize(base + values.size());
+    std::byte* dst = out.data() + base;
+    for (std::size_t i = 0; i < n; ++i)
+        for (std::size_t b = 0; b < width; ++b)
+            dst[b * n + i] = values[i * width + b];
+}
+
+void unshuffle(std::size_t width, std::span<const std::byte> in, std::span<std::byte> out)
+{
+    const std::size_t n = out.size() / width;
+    for (std::size_t b = 0; b < width; ++b)
+        for (std::size_t i = 0; i < n; ++i)
+            out[i * width + b] = in[b * n + i];
+}
+
+#ifdef SOLARLENS_HAVE_ZSTD
+
+void zstd_compress(int level, std::span<const std::byte> in, std::vector<std::byte>& out)
+{
+    const std::size_t base = out.size();
+    out.resize(base + ZSTD_compressBound(in.size()));
+    const std::size_t n = ZSTD_compress(out.data() + base, out.size() - base, in.data(), in.size(), level);
+    if (ZSTD_isError(n))
+        throw std::runtime_error(std::string("columnar archive: zstd: ") + ZSTD_getErrorName(n));
+    out.resize(base + n);
+}
+
+bool zstd_decompress(std::span<const std::byte> in, std::span<std::byte> out)
+{
+    const std::size_t n = ZSTD_decompress(out.data(), out.size(), in.data(), in.size());
+    return !ZSTD_isError(n) && n == out.size();
+}
+
+#else
+
+void zstd_compress(int, std::span<const std::byte>, std::vector<std::byte>&)
+{
+    throw std::invalid_argument("columnar archive: built without zstd");
+}
+
+bool zstd_decompress(std::span<const std::byte>, std::span<std::byte>)
+{
+    return false;
+}
+
+#endif
+
+} // namespace solarlens::archive::detail
@@ -0,0 +1,29 @@
+#pragma once
+
+// Column chunk encoders shared by the archive writer and reader. Encoders
+// append to `out`; decoders fill exactly `out.size()` bytes and return
+// false on malformed input instead of throwing, so the reader can report
+// the file and chunk.
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include "solarlens/archive/columnar.hpp"
+
+namespace solarlens::archive::detail {
+
+// Zigzag varints: at most ten bytes per value.
+constexpr std::size_t max_delta_bytes = 10;
+
+void encode_delta(ColumnType type, std::span<const std::byte> values, std::vector<std::byte>& out);
+bool decode_delta(ColumnType type, std::span<const std::byte> in, std::span<std::byte> out);
+
+// Byte-plane transpose: plane b holds byte b of every value.
+void shuffle(std::size_t width, std::span<const std::byte> values, std::vector<std::byte>& out);
+void unshuffle(std::size_t width, std::span<const std::byte> in, std::span<std::byte> out);
+
+void zstd_compress(int level, std::span<const std::byte> in, std::vector<std::byte>& out);
+bool zstd_decompress(std::span<const std::byte> in, std::span<std::byte> out);
+
+} // namespace solarlens::archive::detail
@@ -0,0 +1,519 @@
+#include "solarlens/archive/columnar.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string>
+#include <unordered_set>
+
+#include "column_codec.hpp"
+
+namespace solarlens::archive {
+
+namespace {
+
+constexpr std::array<char, 8> head_magic = {'S', 'L', 'C', 'O', 'L', 'A', 'R', '\0'};
+constexpr std::array<char, 8> tail_magic = {'S', 'L', 'C', 'A', 'E', 'N', 'D', '\0'};
+constexpr std::uint32_t archive_version = 1;
+constexpr std::uint64_t header_size = 16;
+constexpr std::uint64_t trailer_size = 16;
+constexpr std::uint64_t column_alignment = 8;
+
+bool is_float(ColumnType type) noexcept
+{
+    return type == ColumnType::float32 || type == ColumnType::float64;
+}
+
+std::int64_t saturate(double v) noexcept
+{
+    if (v <= -0x1p63)
+        return std::numeric_limits<std::int64_t>::min();
+    if (v >= 0x1p63)
+        return std::numeric_limits<std::int64_t>::max();
+    return static_cast<std::int64_t>(v);
+}
+
+double load_double(ColumnType type, const std::byte* p) noexcept
+{
+    if (type == ColumnType::float32) {
+        float f = 0;
+        std::memcpy(&f, p, 4);
+        return f;
+    }
+    double d = 0;
+    std::memcpy(&d, p, 8);
+    return d;
+}
+
+std::int64_t load_int(ColumnType type, const std::byte* p) noexcept
+{
+    if (type == ColumnType::uint32) {
+        std::uint32_t v = 0;
+        std::memcpy(&v, p, 4);
+        return v;
+    }
+    std::int64_t v = 0;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+ColumnStats compute_stats(ColumnType type, std::span<const std::byte> values)
+{
+    const std::size_t width = column_width(type);
+    ColumnStats s;
+    s.type = type;
+    if (is_float(type)) {
+        double lo = std::numeric_limits<double>::infinity();
+        double hi = -lo;
+        bool any = false;
+        for (std::size_t i = 0; i < values.size(); i += width) {
+            const double v = load_double(type, values.data() + i);
+            if (std::isnan(v))
+                continue;
+            lo = std::min(lo, v);
+            hi = std::max(hi, v);
+            any = true;
+        }
+        s.min_bits = any ? std::bit_cast<std::uint64_t>(lo) : ColumnStats::empty_bits;
+        s.max_bits = any ? std::bit_cast<std::uint64_t>(hi) : ColumnStats::empty_bits;
+    } else {
+        std::int64_t lo = std::numeric_limits<std::int64_t>::max();
+        std::int64_t hi = std::numeric_limits<std::int64_t>::min();
+        for (std::size_t i = 0; i < values.size(); i += width) {
+            const std::int64_t v = load_int(type, values.data() + i);
+            lo = std::min(lo, v);
+            hi = std::max(hi, v);
+        }
+        s.min_bits = static_cast<std::uint64_t>(lo);
+        s.max_bits = static_cast<std::uint64_t>(hi);
+    }
+    return s;
+}
+
+void validate_schema(const std::vector<ColumnSpec>& schema)
+{
+    if (schema.empty())
+        throw std::invalid_argument("columnar archive: empty schema");
+    std::unordered_set<std::string> names;
+    for (const ColumnSpec& c : schema) {
+        if (c.name.empty() || c.name.size() > 0xFFFF)
+            throw std::invalid_argument("columnar archive: bad column name");
+        if (!names.insert(c.name).second)
+            throw std::invalid_argument("columnar archive: duplicate column " + c.name);
+        if (c.type > ColumnType::float64 || c.encoding > Encoding::shuffle)
+            throw std::invalid_argument("columnar archive: bad type or encoding for " + c.name);
+        if (c.encoding == Encoding::delta && is_float(c.type))
+            throw std::invalid_argument("columnar archive: delta needs an integer column: " + c.name);
+        if (c.zstd_level != 0 && !zstd_available())
+            throw std::invalid_argument("columnar archive: built without zstd: " + c.name);
+    }
+}
+
+class FooterWriter {
+public:
+    template <typename T>
+    void put(T v)
+    {
+        const auto* p = reinterpret_cast<const std::byte*>(&v);
+        bytes.insert(bytes.end(), p, p + sizeof(T));
+    }
+
+    std::vector<std::byte> bytes;
+};
+
+class FooterReader {
+public:
+    explicit FooterReader(std::span<const std::byte> bytes) : bytes_(bytes) {}
+
+    template <typename T>
+    bool get(T& v)
+    {
+        if (bytes_.size() - pos_ < sizeof(T))
+            return false;
+        std::memcpy(&v, bytes_.data() + pos_, sizeof(T));
+        pos_ += sizeof(T);
+        return true;
+    }
+
+    bool get(std::string& s, std::size_t n)
+    {
+        if (bytes_.size() - pos_ < n)
+            return false;
+        s.assign(reinterpret_cast<const char*>(bytes_.data() + pos_), n);
+        pos_ += n;
+        return true;
+    }
+
+    bool done() const noexcept { return pos_ == bytes_.size(); }
+
+private:
+    std::span<const std::byte> bytes_;
+    std::size_t pos_ = 0;
+};
+
+} // namespace
+
+std::size_t column_width(ColumnType type) noexcept
+{
+    return type == ColumnType::uint32 || type == ColumnType::float32 ? 4 : 8;
+}
+
+bool zstd_available() noexcept
+{
+#ifdef SOLARLENS_HAVE_ZSTD
+    return true;
+#else
+    return false;
+#endif
+}
+
+double ColumnStats::min() const noexcept
+{
+    return is_float(type) ? std::bit_cast<double>(min_bits)
+                          : double(static_cast<std::int64_t>(min_bits));
+}
+
+double ColumnStats::max() const noexcept
+{
+    return is_float(type) ? std::bit_cast<double>(max_bits)
+                          : double(static_cast<std::int64_t>(max_bits));
+}
+
+std::int64_t ColumnStats::min_int() const noexcept
+{
+    if (!is_float(type))
+        return static_cast<std::int64_t>(min_bits);
+    return saturate(std::floor(min()));
+}
+
+std::int64_t ColumnStats::max_int() const noexcept
+{
+    if (!is_float(type))
+        return static_cast<std::int64_t>(max_bits);
+    return saturate(std::ceil(max()));
+}
+
+bool ColumnStats::empty() const noexcept
+{
+    return is_float(type) && min_bits == empty_bits;
+}
+
+// --- writer -----------------------------------------------------------------
+
+ArchiveWriter::ArchiveWriter(const std::filesystem::path& path, std::vector<ColumnSpec> schema,
+                             std::size_t chunk_rows)
+    : schema_(std::move(schema))
+    , chunk_rows_(chunk_rows)
+{
+    validate_schema(schema_);
+    if (chunk_rows_ == 0 || chunk_rows_ > std::numeric_limits<std::uint32_t>::max())
+        throw std::invalid_argument("columnar archive: bad chunk_rows");
+    file_ = core::File(path, core::File::Mode::write);
+    std::array<std::byte, header_size> h {};
+    std::memcpy(h.data(), head_magic.data(), 8);
+    std::memcpy(h.data() + 8, &archive_version, 4);
+    file_.pwrite(h, 0);
+    offset_ = header_size;
+    pending_.resize(schema_.size());
+    for (std::size_t c = 0; c < schema_.size(); ++c)
+        pending_[c].reserve(chunk_rows_ * column_width(schema_[c].type));
+}
+
+ArchiveWriter::~ArchiveWriter() = default;
+
+void ArchiveWriter::append(const ColumnBatch& batch)
+{
+    if (closed_)
+        throw std::logic_error("columnar archive: append after close");
+    if (batch.columns.size() != schema_.size())
+        throw std::invalid_argument("columnar archive: batch does not match schema");
+    std::size_t done = 0;
+    while (done < batch.rows) {
+        const std::size_t take = std::min(batch.rows - done, chunk_rows_ - pending_rows_);
+        for (std::size_t c = 0; c < schema_.size(); ++c) {
+            const std::size_t width = column_width(schema_[c].type);
+            const auto* src = static_cast<const std::byte*>(batch.columns[c]) + done * width;
+            pending_[c].insert(pending_[c].end(), src, src + take * width);
+        }
+        pending_rows_ += take;
+        done += take;
+        if (pending_rows_ == chunk_rows_)
+            flush_chunk();
+    }
+}
+
+void ArchiveWriter::flush_chunk()
+{
+    if (pending_rows_ == 0)
+        return;
+    detail::Chunk chunk;
+    chunk.first_row = rows_;
+    chunk.rows = static_cast<std::uint32_t>(pending_rows_);
+    chunk.columns.resize(schema_.size());
+    std::vector<std::byte> encoded;
+    for (std::size_t c = 0; c < schema_.size(); ++c) {
+        const ColumnSpec& spec = schema_[c];
+        const std::span<const std::byte> values(pending_[c]);
+        detail::ChunkColumn& col = chunk.columns[c];
+        col.stats = compute_stats(spec.type, values);
+
+        std::span<const std::byte> payload = values;
+        if (spec.encoding != Encoding::raw) {
+            encoded.clear();
+            if (spec.encoding == Encoding::delta)
+                detail::encode_delta(spec.type, values, encoded);
+            else
+                detail::shuffle(column_width(spec.type), values, encoded);
+            payload = encoded;
+        }
+        col.encoded = payload.size();
+        if (spec.zstd_level != 0) {
+            scratch_.clear();
+            detail::zstd_compress(spec.zstd_level, payload, scratch_);
+            payload = scratch_;
+        }
+
+        offset_ = (offset_ + column_alignment - 1) / column_alignment * column_alignment;
+        col.offset = offset_;
+        col.stored = payload.size();
+        file_.pwrite(payload, offset_);
+        offset_ += payload.size();
+        pending_[c].clear();
+    }
+    rows_ += pending_rows_;
+    pending_rows_ = 0;
+    chunks_.push_back(std::move(chunk));
+}
+
+void ArchiveWriter::close()
+{
+    if (closed_)
+        return;
+    flush_chunk();
+
+    FooterWriter f;
+    f.put(std::uint32_t(schema_.size()));
+    for (const ColumnSpec& c : schema_) {
+        f.put(std::uint8_t(c.type));
+        f.put(std::uint8_t(c.encoding));
+        f.put(std::uint16_t(c.name.size()));
+        f.put(std::int32_t(c.zstd_level));
+        for (char ch : c.name)
+            f.put(ch);
+    }
+    f.put(std::uint64_t(chunks_.size()));
+    for (const detail::Chunk& chunk : chunks_) {
+        f.put(chunk.first_row);
+        f.put(chunk.rows);
+        f.put(std::uint32_t(0));
+        for (const detail::ChunkColumn& col : chunk.columns) {
+            f.put(col.offset);
+            f.put(col.stored);
+            f.put(col.encoded);
+            f.put(col.stats.min_bits);
+            f.put(col.stats.max_bits);
+        }
+    }
+    std::array<std::byte, trailer_size> t {};
+    std::memcpy(t.data(), &offset_, 8);
+    std::memcpy(t.data() + 8, tail_magic.data(), 8);
+    file_.pwrite(f.bytes, offset_);
+    file_.pwrite(t, offset_ + f.bytes.size());
+    file_.close();
+    closed_ = true;
+}
+
+// --- reader -----------------------------------------------------------------
+
+ArchiveReader::ArchiveReader(const std::filesystem::path& path)
+    : map_(path)
+{
+    const std::span<const std::byte> file = map_.bytes();
+    if (file.size() < header_size + trailer_size)
+        corrupt("truncated");
+    std::uint32_t version = 0;
+    std::memcpy(&version, file.data() + 8, 4);
+    if (std::memcmp(file.data(), head_magic.data(), 8) != 0)
+        corrupt("bad magic");
+    if (version != archive_version)
+        corrupt("unsupported version");
+    const std::byte* trailer = file.data() + file.size() - trailer_size;
+    if (std::memcmp(trailer + 8, tail_magic.data(), 8) != 0)
+        corrupt("missing footer (writer not closed?)");
+    std::uint64_t footer = 0;
+    std::memcpy(&footer, trailer, 8);
+    if (footer < header_size || footer > file.size() - trailer_size)
+        corrupt("bad footer offset");
+
+    FooterReader f(file.subspan(footer, file.size() - trailer_size - footer));
+    std::uint32_t columns = 0;
+    if (!f.get(columns) || columns == 0)
+        corrupt("bad schema");
+    schema_.resize(columns);
+    for (ColumnSpec& c : schema_) {
+        std::uint8_t type = 0, encoding = 0;
+        std::uint16_t name_size = 0;
+        std::int32_t level = 0;
+        if (!f.get(type) || !f.get(encoding) || !f.get(name_size) || !f.get(level) ||
+            !f.get(c.name, name_size))
+            corrupt("bad schema");
+        if (type > std::uint8_t(ColumnType::float64) || encoding > std::uint8_t(Encoding::shuffle))
+            corrupt("bad column " + c.name);
+        c.type = ColumnType(type);
+        c.encoding = Encoding(encoding);
+        c.zstd_level = level;
+    }
+
+    std::uint64_t chunks = 0;
+    if (!f.get(chunks))
+        corrupt("bad chunk index");
+    for (std::uint64_t i = 0; i < chunks; ++i) {
+        detail::Chunk chunk;
+        std::uint32_t reserved = 0;
+        if (!f.get(chunk.first_row) || !f.get(chunk.rows) || !f.get(reserved) ||
+            chunk.first_row != rows_)
+            corrupt("bad chunk index");
+        chunk.columns.resize(columns);
+        for (std::size_t c = 0; c < columns; ++c) {
+            detail::ChunkColumn& col = chunk.columns[c];
+            col.stats.type = schema_[c].type;
+            if (!f.get(col.offset) || !f.get(col.stored) || !f.get(col.encoded) ||
+                !f.get(col.stats.min_bits) || !f.get(col.stats.max_bits))
+                corrupt("bad chunk index");
+            if (col.offset < header_size || col.offset > footer || col.stored > footer - col.offset)
+                corrupt("column chunk outside file");
+            // read() allocates `encoded` bytes for a zstd column, so bound it
+            // by what the chunk's rows can encode to.
+            const ColumnSpec& spec = schema_[c];
+            const std::uint64_t raw = std::uint64_t(chunk.rows) * column_width(spec.type);
+            const std::uint64_t limit = spec.encoding == Encoding::delta
+                ? std::uint64_t(chunk.rows) * detail::max_delta_bytes : raw;
+            if ((spec.zstd_level == 0 && col.encoded != col.stored) || col.encoded > limit ||
+                (spec.encoding != Encoding::delta && col.encoded != raw))
+                corrupt("bad column chunk size");
+        }
+        rows_ += chunk.rows;
+        chunks_.push_back(std::move(chunk));
+    }
+    if (!f.done())
+        corrupt("trailing footer bytes");
+}
+
+void ArchiveReader::corrupt(const std::string& what) const
+{
+    throw std::runtime_error("columnar archive: " + what + " in " + map_.path().string());
+}
+
+void ArchiveReader::check_type(std::size_t column, ColumnType type) const
+{
+    if (schema_.at(column).type != type)
+        throw std::invalid_argument("columnar archive: type mismatch for " + schema_[column].name);
+}
+
+std::size_t ArchiveReader::column(std::string_view name) const
+{
+    for (std::size_t c = 0; c < schema_.size(); ++c)
+        if (schema_[c].name == name)
+            return c;
+    throw std::out_of_range("columnar archive: no column " + std::string(name));
+}
+
+const ColumnStats& ArchiveReader::stats(std::size_t chunk, std::size_t column) const
+{
+    return chunks_.at(chunk).columns.at(column).stats;
+}
+
+std::vector<std::size_t> ArchiveReader::chunks_overlapping(std::size_t column, std::int64_t lo,
+                                                           std::int64_t hi) const
+{
+    std::vector<std::size_t> out;
+    for (std::size_t i = 0; i < chunks_.size(); ++i) {
+        const ColumnStats& s = chunks_[i].columns.at(column).stats;
+        if (!s.empty() && s.max_int() >= lo && s.min_int() <= hi)
+            out.push_back(i);
+    }
+    return out;
+}
+
+std::vector<std::size_t> ArchiveReader::chunks_overlapping(std::size_t column, double lo,
+                                                           double hi) const
+{
+    std::vector<std::size_t> out;
+    for (std::size_t i = 0; i < chunks_.size(); ++i) {
+        const ColumnStats& s = chunks_[i].columns.at(column).stats;
+        if (!s.empty() && s.max() >= lo && s.min() <= hi)
+            out.push_back(i);
+    }
+    return out;
+}
+
+std::span<const std::byte> ArchiveReader::read(std::size_t chunk, std::size_t column,
+                                               std::span<std::byte> out) const
+{
+    const detail::Chunk& ch = chunks_.at(chunk);
+    const ColumnSpec& spec = schema_.at(column);
+    const detail::ChunkColumn& col = ch.columns[column];
+    const std::size_t raw = std::size_t(ch.rows) * column_width(spec.type);
+    const std::span<const std::byte> stored = map_.bytes().subspan(col.offset, col.stored);
+    const auto bad = [&] { corrupt("bad column chunk " + spec.name + "#" + std::to_string(chunk)); };
+
+    if (spec.encoding == Encoding::raw && spec.zstd_level == 0) {
+        if (col.stored != raw)
+            bad();
+        return stored;
+    }
+    if (out.size() < raw)
+        throw std::invalid_argument("columnar archive: output buffer too small");
+    out = out.first(raw);
+
+    std::span<const std::byte> encoded = stored;
+    std::vector<std::byte> inflated;
+    if (spec.zstd_level != 0) {
+        if (!zstd_available())
+            corrupt("zstd column " + spec.name + " in a build without zstd");
+        if (spec.encoding == Encoding::raw) {
+            if (col.encoded != raw || !detail::zstd_decompress(stored, out))
+                bad();
+            return out;
+        }
+        inflated.resize(col.encoded);
+        if (!detail::zstd_decompress(stored, inflated))
+            bad();
+        encoded = inflated;
+    }
+    if (spec.encoding == Encoding::delta) {
+        if (!detail::decode_delta(spec.type, encoded, out))
+            bad();
+    } else {
+        if (encoded.size() != raw)
+            bad();
+        detail::unshuffle(column_width(spec.type), encoded, out);
+    }
+    return out;
+}
+
+std::uint64_t ArchiveReader::stored_bytes(std::span<const std::size_t> chunks,
+                                          std::span<const std::size_t> columns) const
+{
+    std::uint64_t total = 0;
+    for (std::size_t chunk : chunks)
+        for (std::size_t c : columns)
+            total += chunks_.at(chunk).columns.at(c).stored;
+    return total;
+}
+
+void ArchiveReader::prefetch(std::span<const std::size_t> chunks,
+                             std::span<const std::size_t> columns) const
+{
+    for (std::size_t chunk : chunks)
+        for (std::size_t c : columns) {
+            const detail::ChunkColumn& col = chunks_.at(chunk).columns.at(c);
+            map_.prefetch(col.offset, col.stored);
+        }
+}
+
+} // namespace solarlens::archive
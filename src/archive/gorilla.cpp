@@ -0,0 +1,178 @@
+#include "gorilla.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <utility>
+
+namespace solarlens::archive::detail {
+
+namespace {
+
+// Delta-of-delta buckets: control-bit prefix, then a payload of this width.
+struct DodBucket {
+    std::uint64_t prefix;
+    unsigned prefix_bits;
+    unsigned payload_bits;
+};
+
+constexpr DodBucket dod_buckets[] = {
+    {0b10, 2, 7},
+    {0b110, 3, 9},
+    {0b1110, 4, 12},
+    {0b11110, 5, 32},
+    {0b11111, 5, 64},
+};
+
+constexpr std::uint64_t low_bits(unsigned n) noexcept
+{
+    return n >= 64 ? ~std::uint64_t {0} : (std::uint64_t {1} << n) - 1;
+}
+
+// Payloads of width n hold [-(2^(n-1) - 1), 2^(n-1)] as dod + 2^(n-1) - 1.
+constexpr bool fits(std::int64_t dod, unsigned n) noexcept
+{
+    if (n >= 64)
+        return true;
+    const std::int64_t half = std::int64_t {1} << (n - 1);
+    return dod >= -(half - 1) && dod <= half;
+}
+
+} // namespace
+
+void GorillaEncoder::append(std::int64_t t, double value)
+{
+    const auto bits = std::bit_cast<std::uint64_t>(value);
+    if (count_ == 0) {
+        put(static_cast<std::uint64_t>(t), 64);
+        put(bits, 64);
+        prev_t_ = t;
+        prev_value_ = bits;
+        ++count_;
+        return;
+    }
+
+    // Wrapping arithmetic: the decoder undoes it exactly.
+    const auto delta = static_cast<std::int64_t>(static_cast<std::uint64_t>(t) - static_cast<std::uint64_t>(prev_t_));
+    const auto dod = static_cast<std::int64_t>(static_cast<std::uint64_t>(delta)
+                                               - static_cast<std::uint64_t>(prev_delta_));
+    if (dod == 0) {
+        put(0, 1);
+    } else {
+        for (const DodBucket& b : dod_buckets)
+            if (fits(dod, b.payload_bits)) {
+                put(b.prefix, b.prefix_bits);
+                const std::uint64_t bias = b.payload_bits >= 64 ? 0 : (std::uint64_t {1} << (b.payload_bits - 1)) - 1;
+                put(static_cast<std::uint64_t>(dod) + bias, b.payload_bits);
+                break;
+            }
+    }
+    prev_delta_ = delta;
+    prev_t_ = t;
+
+    const std::uint64_t x = bits ^ prev_value_;
+    prev_value_ = bits;
+    if (x == 0) {
+        put(0, 1);
+    } else {
+        const auto leading = std::min(31u, static_cast<unsigned>(std::countl_zero(x)));
+        const auto trailing = static_cast<unsigned>(std::countr_zero(x));
+        if (window_ && leading >= leading_ && trailing >= trailing_) {
+            put(0b10, 2);
+            put(x >> trailing_, 64 - leading_ - trailing_);
+        } else {
+            const unsigned meaningful = 64 - leading - trailing;
+            put(0b11, 2);
+            put(leading, 5);
+            put(meaningful & 63, 6);  // 64 is stored as 0.
+            put(x >> trailing, meaningful);
+            leading_ = leading;
+            trailing_ = trailing;
+            window_ = true;
+        }
+    }
+    ++count_;
+}
+
+std::vector<std::uint64_t> GorillaEncoder::release()
+{
+    std::vector<std::uint64_t> out = std::move(words_);
+    out.shrink_to_fit();
+    *this = GorillaEncoder();
+    return out;
+}
+
+void GorillaEncoder::put(std::uint64_t bits, unsigned n)
+{
+    if (n == 0)
+        return;
+    bits &= low_bits(n);
+    const unsigned used = static_cast<unsigned>(bits_ % 64);
+    if (used == 0)
+        words_.push_back(0);
+    const unsigned room = 64 - used;
+    if (n <= room) {
+        words_.back() |= bits << (room - n);
+    } else {
+        words_.back() |= bits >> (n - room);
+        words_.push_back(bits << (64 - (n - room)));
+    }
+    bits_ += n;
+}
+
+std::uint64_t GorillaDecoder::get(unsigned n) noexcept
+{
+    if (n == 0)
+        return 0;
+    const std::size_t w = pos_ / 64;
+    const unsigned used = static_cast<unsigned>(pos_ % 64);
+    const unsigned room = 64 - used;
+    pos_ += n;
+    if (n <= room)
+        return (words_[w] >> (room - n)) & low_bits(n);
+    const unsigned rest = n - room;
+    return ((words_[w] & low_bits(room)) << rest) | (words_[w + 1] >> (64 - rest));
+}
+
+bool GorillaDecoder::next(std::int64_t& t, double& value) noexcept
+{
+    if (remaining_ == 0)
+        return false;
+    --remaining_;
+    if (first_) {
+        first_ = false;
+        prev_t_ = static_cast<std::int64_t>(get(64));
+        prev_value_ = get(64);
+        t = prev_t_;
+        value = std::bit_cast<double>(prev_value_);
+        return true;
+    }
+
+    std::int64_t dod = 0;
+    if (bit()) {
+        std::size_t b = 0;
+        while (b + 1 < std::size(dod_buckets) && bit())
+            ++b;
+        const unsigned n = dod_buckets[b].payload_bits;
+        const std::uint64_t bias = n >= 64 ? 0 : (std::uint64_t {1} << (n - 1)) - 1;
+        dod = static_cast<std::int64_t>(get(n) - bias);
+    }
+    prev_delta_ = static_cast<std::int64_t>(static_cast<std::uint64_t>(prev_delta_) + static_cast<std::uint64_t>(dod));
+    prev_t_ = static_cast<std::int64_t>(static_cast<std::uint64_t>(prev_t_) + static_cast<std::uint64_t>(prev_delta_));
+
+    if (bit()) {
+        if (bit()) {
+            leading_ = static_cast<unsigned>(get(5));
+            unsigned meaningful = static_cast<unsigned>(get(6));
+            if (meaningful == 0)
+                meaningful = 64;
+            trailing_ = 64 - leading_ - meaningful;
+        }
+        prev_value_ ^= get(64 - leading_ - trailing_) << trailing_;
+    }
+    t = prev_t_;
+    value = std::bit_cast<double>(prev_value_);
+    return true;
+}
+
+} // namespace solarlens::archive::detail
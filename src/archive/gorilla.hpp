@@ -0,0 +1,67 @@
+#pragma once
+
+// Gorilla time-series compression (Pelkonen et al., VLDB 2015). The first
+// sample is stored raw; after it, each timestamp is the delta of its
+// delta, in a prefix-coded bucket, and each value is the XOR with the
+// previous one, stored as its meaningful bits, reusing the previous
+// leading/trailing window when it fits. Timestamps are 64-bit, so the
+// widest buckets are 32 and 64 bits where the paper stops at 32.
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace solarlens::archive::detail {
+
+class GorillaEncoder {
+public:
+    void append(std::int64_t t, double value);
+
+    std::size_t count() const noexcept { return count_; }
+    std::span<const std::uint64_t> words() const noexcept { return words_; }
+
+    /// Hands over the bitstream and starts an empty one.
+    std::vector<std::uint64_t> release();
+
+private:
+    void put(std::uint64_t bits, unsigned n);
+
+    std::vector<std::uint64_t> words_;
+    std::size_t bits_ = 0;
+    std::size_t count_ = 0;
+    std::int64_t prev_t_ = 0;
+    std::int64_t prev_delta_ = 0;
+    std::uint64_t prev_value_ = 0;
+    unsigned leading_ = 0;
+    unsigned trailing_ = 0;
+    bool window_ = false;
+};
+
+class GorillaDecoder {
+public:
+    /// `words` must hold at least `count` samples from GorillaEncoder.
+    GorillaDecoder(std::span<const std::uint64_t> words, std::size_t count) noexcept
+        : words_(words)
+        , remaining_(count)
+    {
+    }
+
+    bool next(std::int64_t& t, double& value) noexcept;
+
+private:
+    std::uint64_t get(unsigned n) noexcept;
+    bool bit() noexcept { return get(1) != 0; }
+
+    std::span<const std::uint64_t> words_;
+    std::size_t remaining_;
+    std::size_t pos_ = 0;
+    bool first_ = true;
+    std::int64_t prev_t_ = 0;
+    std::int64_t prev_delta_ = 0;
+    std::uint64_t prev_value_ = 0;
+    unsigned leading_ = 0;
+    unsigned trailing_ = 0;
+};
+
+} // namespace solarlens::archive::detail
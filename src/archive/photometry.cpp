@@ -0,0 +1,109 @@
+#include "solarlens/archive/photometry.hpp"
+
+#include <algorithm>
+#include <array>
+
+namespace solarlens::archive {
+
+int default_zstd_level() noexcept
+{
+    return zstd_available() ? 3 : 0;
+}
+
+std::vector<ColumnSpec> photometry_schema(int zstd_level)
+{
+    namespace col = photometry_column;
+    return {
+        {col::time, ColumnType::int64, Encoding::delta, zstd_level},
+        {col::spacecraft, ColumnType::uint32, Encoding::delta, zstd_level},
+        {col::flags, ColumnType::uint32, Encoding::delta, zstd_level},
+        {col::u, ColumnType::float32, Encoding::shuffle, zstd_level},
+        {col::v, ColumnType::float32, Encoding::shuffle, zstd_level},
+        {col::flux, ColumnType::float32, Encoding::shuffle, zstd_level},
+        {col::sigma, ColumnType::float32, Encoding::shuffle, zstd_level},
+        {col::background, ColumnType::float32, Encoding::shuffle, zstd_level},
+    };
+}
+
+PhotometryWriter::PhotometryWriter(const std::filesystem::path& path, std::size_t chunk_rows,
+                                   int zstd_level)
+    : writer_(path, photometry_schema(zstd_level), chunk_rows)
+{
+}
+
+void PhotometryWriter::append(std::span<const PhotometryRecord> records)
+{
+    const std::size_t n = records.size();
+    time_.resize(n);
+    spacecraft_.resize(n);
+    flags_.resize(n);
+    u_.resize(n);
+    v_.resize(n);
+    flux_.resize(n);
+    sigma_.resize(n);
+    background_.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        const PhotometryRecord& r = records[i];
+        time_[i] = r.time_ns;
+        spacecraft_[i] = r.spacecraft;
+        flags_[i] = r.flags;
+        u_[i] = r.u;
+        v_[i] = r.v;
+        flux_[i] = r.flux;
+        sigma_[i] = r.sigma;
+        background_[i] = r.background;
+    }
+    writer_.append({n,
+                    {time_.data(), spacecraft_.data(), flags_.data(), u_.data(), v_.data(),
+                     flux_.data(), sigma_.data(), background_.data()}});
+}
+
+ExportStats export_ring_samples(const ArchiveReader& archive, TimeRange range,
+                                recon::RingSampleWriter& out, std::uint32_t reject_flags)
+{
+    namespace col = photometry_column;
+    ExportStats stats;
+    if (range.end_ns <= range.begin_ns)
+        return stats;
+    const std::size_t time = archive.column(col::time);
+    const std::size_t flags = archive.column(col::flags);
+    const std::array<std::size_t, 4> values = {archive.column(col::u), archive.column(col::v),
+                                               archive.column(col::flux),
+                                               archive.column(col::sigma)};
+
+    const std::vector<std::size_t> chunks =
+        archive.chunks_overlapping(time, range.begin_ns, range.end_ns - 1);
+    stats.chunks_read = chunks.size();
+    stats.chunks_skipped = archive.chunk_count() - chunks.size();
+    const std::array<std::size_t, 6> used = {time, flags, values[0], values[1], values[2], values[3]};
+    stats.bytes_read = archive.stored_bytes(chunks, used);
+    archive.prefetch(chunks, used);
+
+    std::vector<std::int64_t> t_buf;
+    std::vector<std::uint32_t> f_buf;
+    std::array<std::vector<float>, 4> v_buf;
+    std::vector<recon::RingSample> samples;
+    for (std::size_t chunk : chunks) {
+        const std::span<const std::int64_t> t = archive.read(chunk, time, t_buf);
+        const std::span<const std::uint32_t> f = archive.read(chunk, flags, f_buf);
+        std::array<std::span<const float>, 4> v;
+        for (std::size_t k = 0; k < 4; ++k)
+            v[k] = archive.read(chunk, values[k], v_buf[k]);
+
+        samples.clear();
+        for (std::size_t i = 0; i < t.size(); ++i) {
+            if (t[i] < range.begin_ns || t[i] >= range.end_ns)
+                continue;
+            if (f[i] & reject_flags) {
+                ++stats.rejected;
+                continue;
+            }
+            samples.push_back({v[0][i], v[1][i], v[2][i], v[3][i]});
+        }
+        out.append(samples);
+        stats.samples += samples.size();
+    }
+    return stats;
+}
+
+} // namespace solarlens::archive
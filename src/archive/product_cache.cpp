@@ -0,0 +1,270 @@
+#include "solarlens/archive/product_cache.hpp"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstring>
+#include <string>
+#include <system_error>
+
+#include <unistd.h>
+
+#include "solarlens/core/file.hpp"
+
+namespace solarlens::archive {
+
+namespace fs = std::filesystem;
+
+namespace {
+
+constexpr std::array<char, 8> object_magic = {'S', 'L', 'P', 'R', 'O', 'D', '\0', '\0'};
+constexpr std::uint32_t object_version = 1;
+
+std::atomic<std::uint64_t> temp_counter {0};
+
+template <typename T>
+void put(std::byte* p, T value) noexcept
+{
+    std::memcpy(p, &value, sizeof(T));
+}
+
+template <typename T>
+T get(const std::byte* p) noexcept
+{
+    T value {};
+    std::memcpy(&value, p, sizeof(T));
+    return value;
+}
+
+} // namespace
+
+ProductKey::ProductKey(std::string_view stage, std::uint32_t version)
+{
+    field('S', stage, std::as_bytes(std::span(&version, 1)));
+}
+
+void ProductKey::field(char tag, std::string_view name, std::span<const std::byte> value)
+{
+    std::byte head[17];
+    head[0] = std::byte(tag);
+    put(head + 1, std::uint64_t(name.size()));
+    put(head + 9, std::uint64_t(value.size()));
+    hash_.update(head);
+    hash_.update(name);
+    hash_.update(value);
+}
+
+ProductKey& ProductKey::integer(std::string_view name, std::int64_t value)
+{
+    field('i', name, std::as_bytes(std::span(&value, 1)));
+    return *this;
+}
+
+ProductKey& ProductKey::param(std::string_view name, double value)
+{
+    const std::uint64_t bits = std::bit_cast<std::uint64_t>(value);
+    field('d', name, std::as_bytes(std::span(&bits, 1)));
+    return *this;
+}
+
+ProductKey& ProductKey::param(std::string_view name, std::string_view value)
+{
+    field('s', name, std::as_bytes(std::span(value.data(), value.size())));
+    return *this;
+}
+
+ProductKey& ProductKey::param(std::string_view name, std::span<const std::byte> value)
+{
+    field('b', name, value);
+    return *this;
+}
+
+ProductKey& ProductKey::input(const core::Digest& key)
+{
+    field('k', {}, std::as_bytes(std::span(key.bytes)));
+    return *this;
+}
+
+core::Digest ProductKey::digest() const
+{
+    core::Sha256 h = hash_;
+    return h.finish();
+}
+
+ProductCache::ProductCache(const fs::path& root)
+    : root_(root)
+{
+    fs::create_directories(root_ / "objects");
+}
+
+fs::path ProductCache::object_path(const core::Digest& key) const
+{
+    const std::string hex = key.hex();
+    return root_ / "objects" / hex.substr(0, 2) / hex.substr(2);
+}
+
+std::optional<Product> ProductCache::open(const core::Digest& key)
+{
+    const fs::path path = object_path(key);
+    std::error_code ec;
+    if (!fs::is_regular_file(path, ec))
+        return std::nullopt;
+    core::MappedFile map;
+    try {
+        map = core::MappedFile(path);
+    } catch (const std::system_error&) {
+        return std::nullopt; // Evicted between the check and the open.
+    }
+    const std::span<const std::byte> bytes = map.bytes();
+    const bool intact = bytes.size() >= Product::header_bytes
+                        && std::memcmp(bytes.data(), object_magic.data(), object_magic.size()) == 0
+                        && get<std::uint32_t>(bytes.data() + 8) == object_version
+                        && get<std::uint64_t>(bytes.data() + 16) == bytes.size() - Product::header_bytes
+                        && std::memcmp(bytes.data() + 24, key.bytes.data(), key.bytes.size()) == 0;
+    if (!intact) {
+        corrupt_.fetch_add(1, std::memory_order_relaxed);
+        fs::remove(path, ec);
+        return std::nullopt;
+    }
+    fs::last_write_time(path, fs::file_time_type::clock::now(), ec);
+    return Product(std::move(map), key);
+}
+
+Product ProductCache::write(const core::Digest& key, std::span<const std::byte> payload)
+{
+    const fs::path path = object_path(key);
+    fs::create_directories(path.parent_path());
+    fs::path temp = path;
+    temp += ".tmp." + std::to_string(::getpid()) + "." + std::to_string(temp_counter.fetch_add(1));
+
+    std::array<std::byte, Product::header_bytes> header {};
+    std::memcpy(header.data(), object_magic.data(), object_magic.size());
+    put(header.data() + 8, object_version);
+    put(header.data() + 16, std::uint64_t(payload.size()));
+    std::memcpy(header.data() + 24, key.bytes.data(), key.bytes.size());
+    {
+        core::File file(temp, core::File::Mode::write);
+        file.write(header);
+        file.write(payload);
+    }
+    fs::rename(temp, path);
+    return Product(core::MappedFile(path), key);
+}
+
+std::optional<Product> ProductCache::find(const core::Digest& key)
+{
+    std::optional<Product> hit = open(key);
+    if (hit) {
+        hits_.fetch_add(1, std::memory_order_relaxed);
+        bytes_read_.fetch_add(hit->payload().size(), std::memory_order_relaxed);
+    } else {
+        misses_.fetch_add(1, std::memory_order_relaxed);
+    }
+    return hit;
+}
+
+Product ProductCache::store(const core::Digest& key, std::span<const std::byte> payload)
+{
+    Product p = write(key, payload);
+    stores_.fetch_add(1, std::memory_order_relaxed);
+    bytes_written_.fetch_add(payload.size(), std::memory_order_relaxed);
+    return p;
+}
+
+core::Digest ProductCache::file_digest(const fs::path& path)
+{
+    const fs::path absolute = fs::absolute(path).lexically_normal();
+    const std::uint64_t size = fs::file_size(absolute);
+    const auto mtime = fs::last_write_time(absolute).time_since_epoch().count();
+    const core::Digest memo = ProductKey("archive.file_digest", 1)
+                                  .param("path", std::string_view(absolute.native()))
+                                  .param("size", size)
+                                  .param("mtime", mtime)
+                                  .digest();
+    core::Digest d;
+    if (std::optional<Product> hit = open(memo); hit && hit->payload().size() == d.bytes.size()) {
+        std::memcpy(d.bytes.data(), hit->payload().data(), d.bytes.size());
+        return d;
+    }
+    d = core::sha256(core::MappedFile(absolute).bytes());
+    write(memo, std::as_bytes(std::span(d.bytes)));
+    return d;
+}
+
+bool ProductCache::contains(const core::Digest& key) const
+{
+    std::error_code ec;
+    return fs::is_regular_file(object_path(key), ec);
+}
+
+void ProductCache::erase(const core::Digest& key)
+{
+    std::error_code ec;
+    fs::remove(object_path(key), ec);
+}
+
+namespace {
+
+struct ObjectEntry {
+    fs::file_time_type used;
+    std::uint64_t bytes = 0;
+    fs::path path;
+};
+
+std::vector<ObjectEntry> list_objects(const fs::path& dir)
+{
+    std::vector<ObjectEntry> out;
+    std::error_code ec;
+    for (fs::recursive_directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        if (!it->is_regular_file(ec) || it->path().filename().string().find(".tmp.") != std::string::npos)
+            continue;
+        const std::uint64_t bytes = it->file_size(ec);
+        const fs::file_time_type used = it->last_write_time(ec);
+        if (!ec)
+            out.push_back({used, bytes, it->path()});
+    }
+    return out;
+}
+
+} // namespace
+
+std::uint64_t ProductCache::prune(std::uint64_t max_bytes)
+{
+    std::vector<ObjectEntry> objects = list_objects(root_ / "objects");
+    std::uint64_t total = 0;
+    for (const ObjectEntry& o : objects)
+        total += o.bytes;
+    std::sort(objects.begin(), objects.end(),
+              [](const ObjectEntry& a, const ObjectEntry& b) { return a.used < b.used; });
+    std::uint64_t removed = 0;
+    for (const ObjectEntry& o : objects) {
+        if (total - removed <= max_bytes)
+            break;
+        std::error_code ec;
+        if (fs::remove(o.path, ec))
+            removed += o.bytes;
+    }
+    return removed;
+}
+
+std::uint64_t ProductCache::size_bytes() const
+{
+    std::uint64_t total = 0;
+    for (const ObjectEntry& o : list_objects(root_ / "objects"))
+        total += o.bytes;
+    return total;
+}
+
+ProductCacheStats ProductCache::stats() const noexcept
+{
+    ProductCacheStats s;
+    s.hits = hits_.load(std::memory_order_relaxed);
+    s.misses = misses_.load(std::memory_order_relaxed);
+    s.stores = stores_.load(std::memory_order_relaxed);
+    s.bytes_read = bytes_read_.load(std::memory_order_relaxed);
+    s.bytes_written = bytes_written_.load(std::memory_order_relaxed);
+    s.corrupt = corrupt_.load(std::memory_order_relaxed);
+    return s;
+}
+
+} // namespace solarlens::archive
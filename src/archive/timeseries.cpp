@@ -0,0 +1,277 @@
+#include "solarlens/archive/timeseries.hpp"
+
+#include <algorithm>
+#include <array>
+#include <limits>
+#include <mutex>
+#include <stdexcept>
+
+#include "gorilla.hpp"
+#include "solarlens/perf/instrument.hpp"
+
+namespace solarlens::archive {
+
+namespace {
+
+constexpr std::size_t recorder_batch = 1024;
+// Buckets a rollup may merge into one point before moving a level coarser.
+constexpr std::uint64_t max_merge = 16;
+
+std::uint32_t pack(SeriesKey key) noexcept
+{
+    return (std::uint32_t(key.spacecraft) << 16) | key.channel;
+}
+
+std::int64_t floor_div(std::int64_t a, std::int64_t b) noexcept
+{
+    const std::int64_t q = a / b;
+    return (a % b != 0 && (a < 0) != (b < 0)) ? q - 1 : q;
+}
+
+struct Bucket {
+    std::int64_t index = 0;  // Start is index * width.
+    std::uint64_t count = 0;
+    double min = 0.0;
+    double max = 0.0;
+    double sum = 0.0;
+
+    void add(double v) noexcept
+    {
+        min = count == 0 ? v : std::min(min, v);
+        max = count == 0 ? v : std::max(max, v);
+        sum += v;
+        ++count;
+    }
+};
+
+struct Block {
+    std::int64_t first = 0;
+    std::int64_t last = 0;
+    std::uint32_t count = 0;
+    std::vector<std::uint64_t> words;
+};
+
+} // namespace
+
+struct TimeSeriesStore::Series {
+    SeriesKey key;
+    std::vector<Block> sealed;
+    detail::GorillaEncoder open;
+    std::int64_t open_first = 0;
+    std::int64_t last = std::numeric_limits<std::int64_t>::min();
+    std::vector<std::vector<Bucket>> levels;  // Per resolution, by index.
+
+    // Calls fn(t, value) for every sample in [t0, t1).
+    template <typename Fn>
+    void for_each(std::int64_t t0, std::int64_t t1, Fn&& fn) const
+    {
+        const auto scan = [&](std::span<const std::uint64_t> words, std::size_t count) {
+            detail::GorillaDecoder decoder(words, count);
+            std::int64_t t;
+            double v;
+            while (decoder.next(t, v) && t < t1)
+                if (t >= t0)
+                    fn(t, v);
+        };
+        auto it = std::partition_point(sealed.begin(), sealed.end(), [&](const Block& b) { return b.last < t0; });
+        for (; it != sealed.end() && it->first < t1; ++it)
+            scan(it->words, it->count);
+        if (open.count() > 0 && last >= t0 && open_first < t1)
+            scan(open.words(), open.count());
+    }
+};
+
+void TimeSeriesConfig::validate() const
+{
+    if (block_points < 2)
+        throw std::invalid_argument("time series: block_points must be at least 2");
+    if (rollup_ns.empty())
+        throw std::invalid_argument("time series: need at least one rollup resolution");
+    for (std::size_t i = 0; i < rollup_ns.size(); ++i)
+        if (rollup_ns[i] <= 0 || (i > 0 && rollup_ns[i] <= rollup_ns[i - 1]))
+            throw std::invalid_argument("time series: rollup resolutions must be positive and increasing");
+}
+
+TimeSeriesStore::TimeSeriesStore(const TimeSeriesConfig& config)
+    : config_(config)
+{
+    config_.validate();
+}
+
+TimeSeriesStore::~TimeSeriesStore() = default;
+
+void TimeSeriesStore::append(SeriesKey key, std::int64_t t_ns, double value)
+{
+    const std::unique_lock lock(mutex_);
+    append_locked(key, t_ns, value);
+}
+
+void TimeSeriesStore::append(std::span<const HousekeepingSample> samples)
+{
+    static const perf::Stage stage("archive.timeseries_append");
+    perf::ScopedTimer timer(stage);
+    const std::unique_lock lock(mutex_);
+    for (const HousekeepingSample& s : samples)
+        append_locked({s.spacecraft, s.channel}, s.t_ns, s.value);
+}
+
+void TimeSeriesStore::append_locked(SeriesKey key, std::int64_t t_ns, double value)
+{
+    std::unique_ptr<Series>& slot = series_[pack(key)];
+    if (!slot) {
+        slot = std::make_unique<Series>();
+        slot->key = key;
+        slot->levels.resize(config_.rollup_ns.size());
+    }
+    Series& s = *slot;
+    if (t_ns < s.last) {
+        ++out_of_order_;
+        return;
+    }
+    if (s.open.count() == 0)
+        s.open_first = t_ns;
+    s.open.append(t_ns, value);
+    s.last = t_ns;
+    if (s.open.count() == config_.block_points)
+        s.sealed.push_back({s.open_first, t_ns, config_.block_points, s.open.release()});
+
+    for (std::size_t l = 0; l < s.levels.size(); ++l) {
+        std::vector<Bucket>& level = s.levels[l];
+        const std::int64_t index = floor_div(t_ns, config_.rollup_ns[l]);
+        if (level.empty() || level.back().index != index)
+            level.push_back({index});
+        level.back().add(value);
+    }
+    ++appended_;
+}
+
+const TimeSeriesStore::Series* TimeSeriesStore::find(SeriesKey key) const
+{
+    const auto it = series_.find(pack(key));
+    return it == series_.end() ? nullptr : it->second.get();
+}
+
+std::vector<TimedValue> TimeSeriesStore::samples(SeriesKey key, std::int64_t t0, std::int64_t t1) const
+{
+    const std::shared_lock lock(mutex_);
+    std::vector<TimedValue> out;
+    if (const Series* s = find(key))
+        s->for_each(t0, t1, [&](std::int64_t t, double v) { out.push_back({t, v}); });
+    return out;
+}
+
+RollupResult TimeSeriesStore::rollup(SeriesKey key, std::int64_t t0, std::int64_t t1, std::size_t max_points) const
+{
+    static const perf::Stage stage("archive.timeseries_rollup");
+    perf::ScopedTimer timer(stage);
+    if (max_points == 0)
+        throw std::invalid_argument("time series: rollup needs a positive point budget");
+    RollupResult result;
+    const std::shared_lock lock(mutex_);
+    const Series* s = find(key);
+    if (s == nullptr || t1 <= t0)
+        return result;
+
+    const auto overlapping = [&](std::size_t l) {
+        const std::vector<Bucket>& level = s->levels[l];
+        const std::int64_t lo = floor_div(t0, config_.rollup_ns[l]);
+        const std::int64_t hi = floor_div(t1 - 1, config_.rollup_ns[l]);
+        const auto first = std::partition_point(level.begin(), level.end(),
+                                                [&](const Bucket& b) { return b.index < lo; });
+        const auto last = std::partition_point(first, level.end(), [&](const Bucket& b) { return b.index <= hi; });
+        return std::span<const Bucket>(level.data() + (first - level.begin()), std::size_t(last - first));
+    };
+
+    // Buckets a range of this length can overlap, without overflow.
+    const std::uint64_t length = std::uint64_t(t1) - std::uint64_t(t0);
+    const std::size_t coarsest = s->levels.size() - 1;
+    std::size_t level = 0;
+    while (level < coarsest && (length - 1) / std::uint64_t(config_.rollup_ns[level]) + 2 > max_merge * max_points)
+        ++level;
+    const std::int64_t width = config_.rollup_ns[level];
+    const std::span<const Bucket> buckets = overlapping(level);
+
+    // Only the two edge buckets can hold samples outside the range.
+    std::uint64_t raw = 0;
+    for (const Bucket& b : buckets)
+        raw += b.count;
+    if (raw <= max_points) {
+        s->for_each(t0, t1, [&](std::int64_t t, double v) { result.points.push_back({t, v, v, v, 1}); });
+        return result;
+    }
+
+    const std::int64_t lo = floor_div(t0, width);
+    const std::int64_t span = floor_div(t1 - 1, width) - lo + 1;
+    const std::int64_t group = (span + std::int64_t(max_points) - 1) / std::int64_t(max_points);
+    result.resolution_ns = width * group;
+    for (const Bucket& b : buckets) {
+        const std::int64_t start = (lo + (b.index - lo) / group * group) * width;
+        if (result.points.empty() || result.points.back().t_ns != start)
+            result.points.push_back({start, b.min, b.max, 0.0, 0});
+        RollupPoint& p = result.points.back();
+        p.min = std::min(p.min, b.min);
+        p.max = std::max(p.max, b.max);
+        p.mean += b.sum;  // Divided below.
+        p.count += b.count;
+    }
+    for (RollupPoint& p : result.points)
+        p.mean /= double(p.count);
+    return result;
+}
+
+std::vector<SeriesKey> TimeSeriesStore::series() const
+{
+    const std::shared_lock lock(mutex_);
+    std::vector<SeriesKey> out;
+    out.reserve(series_.size());
+    for (const auto& [packed, s] : series_)
+        out.push_back(s->key);
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+TimeSeriesStats TimeSeriesStore::stats() const
+{
+    const std::shared_lock lock(mutex_);
+    TimeSeriesStats st;
+    st.appended = appended_;
+    st.out_of_order = out_of_order_;
+    st.series = series_.size();
+    for (const auto& [packed, s] : series_) {
+        for (const Block& b : s->sealed)
+            st.sample_bytes += sizeof(Block) + b.words.size() * sizeof(std::uint64_t);
+        st.sample_bytes += s->open.words().size() * sizeof(std::uint64_t);
+        for (const std::vector<Bucket>& level : s->levels)
+            st.rollup_bytes += level.size() * sizeof(Bucket);
+    }
+    return st;
+}
+
+TimeSeriesRecorder::TimeSeriesRecorder(TimeSeriesStore& store, bus::Topic<HousekeepingSample>& topic,
+                                       const bus::SubscriberOptions& options)
+    : store_(store)
+    , subscription_(topic.subscribe(options))
+    , thread_([this] { run(); })
+{
+}
+
+TimeSeriesRecorder::~TimeSeriesRecorder()
+{
+    subscription_->close();
+    thread_.join();
+}
+
+void TimeSeriesRecorder::run()
+{
+    std::array<bus::Envelope<HousekeepingSample>, recorder_batch> envelopes;
+    std::array<HousekeepingSample, recorder_batch> batch;
+    while (subscription_->wait_receive(envelopes[0])) {
+        const std::size_t n = 1 + subscription_->receive(std::span(envelopes).subspan(1));
+        for (std::size_t i = 0; i < n; ++i)
+            batch[i] = envelopes[i].body;
+        store_.append(std::span<const HousekeepingSample>(batch.data(), n));
+        recorded_.fetch_add(n, std::memory_order_relaxed);
+    }
+}
+
+} // namespace solarlens::archive
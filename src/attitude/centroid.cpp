@@ -0,0 +1,93 @@
+#include "solarlens/attitude/centroid.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace solarlens::attitude {
+
+void CentroidConfig::validate() const
+{
+    if (!(threshold_sigma > 0) || window_radius == 0 || max_stars == 0 || background_samples < 16)
+        throw std::invalid_argument("attitude: invalid centroid configuration");
+}
+
+FrameBackground estimate_background(core::ImageView<const float> frame, std::size_t samples)
+{
+    const std::size_t area = std::size_t(frame.width) * frame.height;
+    if (area == 0)
+        return {};
+    // An odd stride walks diagonally, so a power-of-two width does not
+    // confine the subsample to a few columns.
+    const std::size_t step = (area / std::max<std::size_t>(samples, 1)) | 1;
+    std::vector<float> values;
+    values.reserve(area / step + 1);
+    for (std::size_t i = step / 2; i < area; i += step) {
+        const auto x = static_cast<std::uint32_t>(i % frame.width);
+        const float v = frame(x, static_cast<std::uint32_t>(i / frame.width));
+        if (std::isfinite(v))
+            values.push_back(v);
+    }
+    if (values.empty())
+        return {};
+    const auto mid = values.begin() + std::ptrdiff_t(values.size() / 2);
+    std::nth_element(values.begin(), mid, values.end());
+    const double median = *mid;
+    for (float& v : values)
+        v = std::abs(v - float(median));
+    std::nth_element(values.begin(), mid, values.end());
+    return {median, 1.4826 * double(*mid)};
+}
+
+void find_stars(core::ImageView<const float> frame, const CentroidConfig& config, std::vector<StarCentroid>& out)
+{
+    out.clear();
+    const FrameBackground bg = estimate_background(frame, config.background_samples);
+    // A flat frame still needs a positive margin above the level.
+    const float threshold = float(bg.level + config.threshold_sigma * std::max(bg.noise, 1e-6));
+    const std::uint32_t r = config.window_radius;
+    if (frame.width <= 2 * r || frame.height <= 2 * r)
+        return;
+
+    for (std::uint32_t y = r; y < frame.height - r; ++y) {
+        const float* row = frame.row(y);
+        // Branch-free screen; most rows of a star field hold no candidate.
+        float peak = row[r];
+        for (std::uint32_t x = r; x < frame.width - r; ++x)
+            peak = std::max(peak, row[x]);
+        if (!(peak > threshold))
+            continue;
+        const float* above = frame.row(y - 1);
+        const float* below = frame.row(y + 1);
+        for (std::uint32_t x = r; x < frame.width - r; ++x) {
+            const float v = row[x];
+            if (!(v > threshold))
+                continue;
+            // Strict on one side, non-strict on the other, so a flat-topped
+            // pair yields exactly one seed.
+            if (!(v > row[x - 1] && v >= row[x + 1] && v > above[x - 1] && v > above[x] && v > above[x + 1]
+                  && v >= below[x - 1] && v >= below[x] && v >= below[x + 1]))
+                continue;
+            double sum = 0.0;
+            double sx = 0.0;
+            double sy = 0.0;
+            for (std::uint32_t wy = y - r; wy <= y + r; ++wy) {
+                const float* wrow = frame.row(wy);
+                for (std::uint32_t wx = x - r; wx <= x + r; ++wx) {
+                    const double s = std::max(0.0, double(wrow[wx]) - bg.level);
+                    sum += s;
+                    sx += s * double(wx);
+                    sy += s * double(wy);
+                }
+            }
+            if (sum > 0.0)
+                out.push_back({sx / sum, sy / sum, sum});
+        }
+    }
+    const std::size_t keep = std::min(out.size(), config.max_stars);
+    std::partial_sort(out.begin(), out.begin() + std::ptrdiff_t(keep), out.end(),
+                      [](const StarCentroid& a, const StarCentroid& b) { return a.flux > b.flux; });
+    out.resize(keep);
+}
+
+} // namespace solarlens::attitude
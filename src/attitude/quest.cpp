@@ -0,0 +1,144 @@
+#include "solarlens/attitude/quest.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+namespace solarlens::attitude {
+
+namespace {
+
+constexpr std::size_t lanes = 8;
+
+// Below this |q4| the Gibbs vector has lost too many digits.
+constexpr double min_scalar_part = 0.1;
+
+// QUEST across up to `lanes` profiles, one array per intermediate. Every
+// loop body is independent per lane.
+void quest_lanes(const AttitudeProfile* profiles, AttitudeFit* out, std::size_t n)
+{
+    double s[6][lanes]; // S = B + B^T: s00 s01 s02 s11 s12 s22.
+    double z[3][lanes];
+    double sigma[lanes], kappa[lanes], delta[lanes];
+    double a[lanes], b[lanes], c[lanes], d[lanes], lambda[lanes];
+    for (std::size_t l = 0; l < n; ++l) {
+        const Mat3& m = profiles[l].b;
+        s[0][l] = 2 * m[0][0];
+        s[1][l] = m[0][1] + m[1][0];
+        s[2][l] = m[0][2] + m[2][0];
+        s[3][l] = 2 * m[1][1];
+        s[4][l] = m[1][2] + m[2][1];
+        s[5][l] = 2 * m[2][2];
+        z[0][l] = m[1][2] - m[2][1];
+        z[1][l] = m[2][0] - m[0][2];
+        z[2][l] = m[0][1] - m[1][0];
+        sigma[l] = m[0][0] + m[1][1] + m[2][2];
+        lambda[l] = profiles[l].weight;
+    }
+    for (std::size_t l = 0; l < n; ++l) {
+        const double s00 = s[0][l], s01 = s[1][l], s02 = s[2][l], s11 = s[3][l], s12 = s[4][l], s22 = s[5][l];
+        const double z0 = z[0][l], z1 = z[1][l], z2 = z[2][l];
+        kappa[l] = s00 * s11 - s01 * s01 + s00 * s22 - s02 * s02 + s11 * s22 - s12 * s12;
+        delta[l] = s00 * (s11 * s22 - s12 * s12) - s01 * (s01 * s22 - s12 * s02) + s02 * (s01 * s12 - s11 * s02);
+        const double sz0 = s00 * z0 + s01 * z1 + s02 * z2;
+        const double sz1 = s01 * z0 + s11 * z1 + s12 * z2;
+        const double sz2 = s02 * z0 + s12 * z1 + s22 * z2;
+        a[l] = sigma[l] * sigma[l] - kappa[l];
+        b[l] = sigma[l] * sigma[l] + z0 * z0 + z1 * z1 + z2 * z2;
+        c[l] = delta[l] + z0 * sz0 + z1 * sz1 + z2 * sz2;
+        d[l] = sz0 * sz0 + sz1 * sz1 + sz2 * sz2;
+    }
+    for (int step = 0; step < quest_newton_steps; ++step)
+        for (std::size_t l = 0; l < n; ++l) {
+            const double x = lambda[l];
+            const double x2 = x * x;
+            const double f = x2 * x2 - (a[l] + b[l]) * x2 - c[l] * x + (a[l] * b[l] + c[l] * sigma[l] - d[l]);
+            const double df = 4 * x2 * x - 2 * (a[l] + b[l]) * x - c[l];
+            lambda[l] = df != 0.0 ? x - f / df : x;
+        }
+    for (std::size_t l = 0; l < n; ++l) {
+        const double s00 = s[0][l], s01 = s[1][l], s02 = s[2][l], s11 = s[3][l], s12 = s[4][l], s22 = s[5][l];
+        const double z0 = z[0][l], z1 = z[1][l], z2 = z[2][l];
+        const double alpha = lambda[l] * lambda[l] - sigma[l] * sigma[l] + kappa[l];
+        const double beta = lambda[l] - sigma[l];
+        const double gamma = (lambda[l] + sigma[l]) * alpha - delta[l];
+        // x = (alpha I + beta S + S^2) z.
+        const double sz0 = s00 * z0 + s01 * z1 + s02 * z2;
+        const double sz1 = s01 * z0 + s11 * z1 + s12 * z2;
+        const double sz2 = s02 * z0 + s12 * z1 + s22 * z2;
+        const double x0 = alpha * z0 + beta * sz0 + (s00 * sz0 + s01 * sz1 + s02 * sz2);
+        const double x1 = alpha * z1 + beta * sz1 + (s01 * sz0 + s11 * sz1 + s12 * sz2);
+        const double x2 = alpha * z2 + beta * sz2 + (s02 * sz0 + s12 * sz1 + s22 * sz2);
+        const double norm = std::sqrt(gamma * gamma + x0 * x0 + x1 * x1 + x2 * x2);
+        const double inv = norm > 0.0 ? 1.0 / norm : 0.0;
+        out[l].q = {x0 * inv, x1 * inv, x2 * inv, gamma * inv};
+        out[l].loss = std::max(0.0, profiles[l].weight - lambda[l]);
+        out[l].valid = profiles[l].count >= 2 && norm > 0.0;
+    }
+}
+
+// B D_k for D_k the 180-degree turn about axis k: negates the other
+// two columns.
+AttitudeProfile turned(const AttitudeProfile& p, int k)
+{
+    AttitudeProfile t = p;
+    for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+            if (j != k)
+                t.b[i][j] = -t.b[i][j];
+    return t;
+}
+
+void sequential_rotation(const AttitudeProfile& profile, AttitudeFit& fit)
+{
+    AttitudeFit best = fit;
+    int best_axis = -1;
+    for (int k = 0; k < 3; ++k) {
+        const AttitudeProfile t = turned(profile, k);
+        AttitudeFit f;
+        quest_lanes(&t, &f, 1);
+        if (std::abs(f.q.w) > std::abs(best.q.w)) {
+            best = f;
+            best_axis = k;
+        }
+    }
+    if (best_axis < 0)
+        return;
+    // A = A' D_k, and D_k is the quaternion e_k with zero scalar part.
+    Quaternion turn {0.0, 0.0, 0.0, 0.0};
+    (best_axis == 0 ? turn.x : best_axis == 1 ? turn.y : turn.z) = 1.0;
+    best.q = compose(best.q, turn);
+    fit = best;
+}
+
+void finish(const AttitudeProfile& profile, AttitudeFit& fit)
+{
+    if (fit.valid && std::abs(fit.q.w) < min_scalar_part)
+        sequential_rotation(profile, fit);
+    if (fit.q.w < 0)
+        fit.q = {-fit.q.x, -fit.q.y, -fit.q.z, -fit.q.w};
+}
+
+} // namespace
+
+AttitudeFit quest(const AttitudeProfile& profile)
+{
+    AttitudeFit fit;
+    quest_lanes(&profile, &fit, 1);
+    finish(profile, fit);
+    return fit;
+}
+
+void quest_batch(std::span<const AttitudeProfile> profiles, std::span<AttitudeFit> out)
+{
+    if (out.size() != profiles.size())
+        throw std::invalid_argument("attitude: quest_batch output size does not match input");
+    for (std::size_t i = 0; i < profiles.size(); i += lanes) {
+        const std::size_t n = std::min(lanes, profiles.size() - i);
+        quest_lanes(profiles.data() + i, out.data() + i, n);
+        for (std::size_t l = 0; l < n; ++l)
+            finish(profiles[i + l], out[i + l]);
+    }
+}
+
+} // namespace solarlens::attitude
@@ -0,0 +1,179 @@
+#include "solarlens/attitude/star_catalog.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <numbers>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+
+namespace solarlens::attitude {
+
+namespace {
+
+// Squared chord length between unit vectors `angle` radians apart.
+double chord2(double angle) noexcept
+{
+    const double c = 2.0 * std::sin(0.5 * std::min(angle, std::numbers::pi));
+    return c * c;
+}
+
+double distance2(const Vec3& a, const Vec3& b) noexcept
+{
+    const double dx = a[0] - b[0];
+    const double dy = a[1] - b[1];
+    const double dz = a[2] - b[2];
+    return dx * dx + dy * dy + dz * dz;
+}
+
+} // namespace
+
+StarCatalog::StarCatalog(std::vector<CatalogStar> stars, double max_pair_angle)
+    : stars_(std::move(stars))
+    , max_pair_angle_(max_pair_angle)
+{
+    if (!(max_pair_angle > 0.0 && max_pair_angle < std::numbers::pi))
+        throw std::invalid_argument("attitude: max_pair_angle must be in (0, pi)");
+    for (CatalogStar& s : stars_)
+        s.direction = normalized(s.direction);
+
+    std::vector<std::uint32_t> order(stars_.size());
+    for (std::uint32_t i = 0; i < order.size(); ++i)
+        order[i] = i;
+    tree_.resize(stars_.size());
+    build(0, stars_.size(), order);
+
+    std::vector<std::uint32_t> near;
+    for (std::uint32_t i = 0; i < stars_.size(); ++i) {
+        near.clear();
+        within(stars_[i].direction, max_pair_angle_, near);
+        for (const std::uint32_t j : near)
+            if (j > i)
+                pairs_.push_back({float(angle_between(stars_[i].direction, stars_[j].direction)), i, j});
+    }
+    std::sort(pairs_.begin(), pairs_.end(), [](const StarPair& x, const StarPair& y) { return x.angle < y.angle; });
+}
+
+void StarCatalog::build(std::size_t lo, std::size_t hi, std::vector<std::uint32_t>& order)
+{
+    if (lo >= hi)
+        return;
+    Vec3 min_corner {2.0, 2.0, 2.0};
+    Vec3 max_corner {-2.0, -2.0, -2.0};
+    for (std::size_t i = lo; i < hi; ++i)
+        for (int k = 0; k < 3; ++k) {
+            min_corner[k] = std::min(min_corner[k], stars_[order[i]].direction[k]);
+            max_corner[k] = std::max(max_corner[k], stars_[order[i]].direction[k]);
+        }
+    int axis = 0;
+    for (int k = 1; k < 3; ++k)
+        if (max_corner[k] - min_corner[k] > max_corner[axis] - min_corner[axis])
+            axis = k;
+    const std::size_t mid = (lo + hi) / 2;
+    std::nth_element(order.begin() + std::ptrdiff_t(lo), order.begin() + std::ptrdiff_t(mid),
+                     order.begin() + std::ptrdiff_t(hi), [&](std::uint32_t a, std::uint32_t b) {
+                         return stars_[a].direction[axis] < stars_[b].direction[axis];
+                     });
+    tree_[mid] = {stars_[order[mid]].direction, order[mid], static_cast<std::uint8_t>(axis)};
+    build(lo, mid, order);
+    build(mid + 1, hi, order);
+}
+
+void StarCatalog::search(std::size_t lo, std::size_t hi, const Vec3& p, double& best, long& found) const noexcept
+{
+    if (lo >= hi)
+        return;
+    const std::size_t mid = (lo + hi) / 2;
+    const Node& node = tree_[mid];
+    const double d2 = distance2(node.point, p);
+    if (d2 < best) {
+        best = d2;
+        found = long(node.star);
+    }
+    const double delta = p[node.axis] - node.point[node.axis];
+    if (delta < 0) {
+        search(lo, mid, p, best, found);
+        if (delta * delta < best)
+            search(mid + 1, hi, p, best, found);
+    } else {
+        search(mid + 1, hi, p, best, found);
+        if (delta * delta < best)
+            search(lo, mid, p, best, found);
+    }
+}
+
+void StarCatalog::collect(std::size_t lo, std::size_t hi, const Vec3& p, double limit,
+                          std::vector<std::uint32_t>& out) const
+{
+    if (lo >= hi)
+        return;
+    const std::size_t mid = (lo + hi) / 2;
+    const Node& node = tree_[mid];
+    if (distance2(node.point, p) <= limit)
+        out.push_back(node.star);
+    const double delta = p[node.axis] - node.point[node.axis];
+    if (delta < 0 || delta * delta <= limit)
+        collect(lo, mid, p, limit, out);
+    if (delta >= 0 || delta * delta <= limit)
+        collect(mid + 1, hi, p, limit, out);
+}
+
+long StarCatalog::nearest(const Vec3& direction, double max_angle) const noexcept
+{
+    double best = chord2(max_angle);
+    long found = -1;
+    search(0, tree_.size(), direction, best, found);
+    return found;
+}
+
+void StarCatalog::within(const Vec3& direction, double radius, std::vector<std::uint32_t>& out) const
+{
+    collect(0, tree_.size(), direction, chord2(radius), out);
+}
+
+std::span<const StarPair> StarCatalog::pairs_between(double lo, double hi) const noexcept
+{
+    const auto first = std::lower_bound(pairs_.begin(), pairs_.end(), lo,
+                                        [](const StarPair& p, double v) { return double(p.angle) < v; });
+    const auto last = std::upper_bound(first, pairs_.end(), hi,
+                                       [](double v, const StarPair& p) { return v < double(p.angle); });
+    return {first, last};
+}
+
+std::size_t StarCatalog::memory_bytes() const noexcept
+{
+    return stars_.capacity() * sizeof(CatalogStar) + tree_.capacity() * sizeof(Node)
+           + pairs_.capacity() * sizeof(StarPair);
+}
+
+std::vector<CatalogStar> read_star_catalog(const std::filesystem::path& path, float faintest)
+{
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("attitude: cannot open star catalogue " + path.string());
+    std::vector<CatalogStar> stars;
+    std::string line;
+    std::size_t number = 0;
+    constexpr double deg = std::numbers::pi / 180.0;
+    while (std::getline(in, line)) {
+        ++number;
+        if (const auto hash = line.find('#'); hash != std::string::npos)
+            line.erase(hash);
+        if (line.find_first_not_of(" \t\r") == std::string::npos)
+            continue;
+        std::istringstream fields(line);
+        std::uint32_t id = 0;
+        double ra = 0.0;
+        double dec = 0.0;
+        float magnitude = 0.0f;
+        if (!(fields >> id >> ra >> dec >> magnitude))
+            throw std::runtime_error("attitude: " + path.string() + ":" + std::to_string(number)
+                                     + ": expected 'id ra_deg dec_deg magnitude'");
+        if (magnitude <= faintest)
+            stars.push_back({id, from_radec(ra * deg, dec * deg), magnitude});
+    }
+    return stars;
+}
+
+} // namespace solarlens::attitude
@@ -0,0 +1,348 @@
+#include "solarlens/attitude/star_tracker.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+#include "solarlens/perf/instrument.hpp"
+#include "solarlens/sched/scheduler.hpp"
+
+namespace solarlens::attitude {
+
+namespace {
+
+constexpr double arcsec = std::numbers::pi / (180.0 * 3600.0);
+constexpr int max_refine_passes = 4;
+
+// A centroid pair sharing one catalogue star means at least one is wrong;
+// drops both.
+std::size_t drop_duplicates(std::vector<long>& matches)
+{
+    std::vector<std::pair<long, std::size_t>> seen;
+    seen.reserve(matches.size());
+    for (std::size_t m = 0; m < matches.size(); ++m)
+        if (matches[m] >= 0)
+            seen.emplace_back(matches[m], m);
+    std::sort(seen.begin(), seen.end());
+    for (std::size_t i = 1; i < seen.size(); ++i)
+        if (seen[i].first == seen[i - 1].first)
+            matches[seen[i].second] = matches[seen[i - 1].second] = -1;
+    return std::size_t(std::count_if(matches.begin(), matches.end(), [](long s) { return s >= 0; }));
+}
+
+struct Partner {
+    std::uint32_t star;
+    std::uint32_t other;
+
+    friend bool operator<(const Partner& a, const Partner& b) noexcept
+    {
+        return a.star != b.star ? a.star < b.star : a.other < b.other;
+    }
+};
+
+} // namespace
+
+void StarTrackerConfig::validate() const
+{
+    centroid.validate();
+    if (!(camera.focal_px > 0) || camera.width == 0 || camera.height == 0)
+        throw std::invalid_argument("attitude: invalid camera model");
+    if (!(match_tolerance_arcsec > 0) || !(tracking_radius_arcsec >= match_tolerance_arcsec))
+        throw std::invalid_argument("attitude: tracking radius must be at least the match tolerance");
+    if (pyramid_stars < 4 || min_matches < 3)
+        throw std::invalid_argument("attitude: pyramid needs four stars and a solution at least three");
+}
+
+const char* to_string(IdentificationMode mode) noexcept
+{
+    switch (mode) {
+    case IdentificationMode::failed:
+        return "failed";
+    case IdentificationMode::tracking:
+        return "tracking";
+    case IdentificationMode::lost_in_space:
+        return "lost_in_space";
+    }
+    return "unknown";
+}
+
+StarTracker::StarTracker(const StarCatalog& catalog, const StarTrackerConfig& config)
+    : catalog_(catalog)
+    , config_(config)
+    , tolerance_(config.match_tolerance_arcsec * arcsec)
+    , tracking_radius_(config.tracking_radius_arcsec * arcsec)
+{
+    config_.validate();
+    if (catalog.max_pair_angle() < 2.0 * config_.camera.field_radius())
+        throw std::invalid_argument("attitude: catalogue pair index is narrower than the camera field");
+}
+
+std::optional<Quaternion> StarTracker::prior(std::uint32_t spacecraft) const
+{
+    const auto it = priors_.find(spacecraft);
+    if (it == priors_.end())
+        return std::nullopt;
+    return it->second;
+}
+
+void StarTracker::body_vectors(std::span<const StarCentroid> stars, std::vector<Vec3>& body) const
+{
+    body.clear();
+    for (const StarCentroid& s : stars)
+        body.push_back(config_.camera.unproject(s.x, s.y));
+}
+
+bool StarTracker::track(std::span<const Vec3> body, const Quaternion& prior, Matches& matches) const
+{
+    matches.assign(body.size(), -1);
+    for (std::size_t m = 0; m < body.size(); ++m)
+        matches[m] = catalog_.nearest(prior.to_inertial(body[m]), tracking_radius_);
+    return drop_duplicates(matches) >= config_.min_matches;
+}
+
+bool StarTracker::lost_in_space(std::span<const Vec3> body, Matches& matches) const
+{
+    const std::size_t n = std::min(body.size(), config_.pyramid_stars);
+    if (n < 4)
+        return false;
+    const auto& stars = catalog_.stars();
+    std::vector<Partner> ik;
+    std::vector<Partner> jk;
+    const auto partners = [&](double angle, std::vector<Partner>& out) {
+        out.clear();
+        for (const StarPair& p : catalog_.pairs_between(angle - tolerance_, angle + tolerance_)) {
+            out.push_back({p.a, p.b});
+            out.push_back({p.b, p.a});
+        }
+        std::sort(out.begin(), out.end());
+    };
+    const auto of = [](const std::vector<Partner>& v, std::uint32_t star) {
+        return std::equal_range(v.begin(), v.end(), Partner {star, 0},
+                                [](const Partner& a, const Partner& b) { return a.star < b.star; });
+    };
+
+    // The fourth star: given the triangle's attitude, some other centroid
+    // must land on a catalogue star outside the triangle.
+    const auto confirm = [&](std::size_t i, std::size_t j, std::size_t k, std::uint32_t a, std::uint32_t b,
+                             std::uint32_t c) {
+        AttitudeProfile triad;
+        triad.add(body[i], stars[a].direction);
+        triad.add(body[j], stars[b].direction);
+        triad.add(body[k], stars[c].direction);
+        const AttitudeFit fit = quest(triad);
+        if (!fit.valid)
+            return false;
+        for (std::size_t m = 0; m < body.size(); ++m) {
+            if (m == i || m == j || m == k)
+                continue;
+            const long s = catalog_.nearest(fit.q.to_inertial(body[m]), tolerance_);
+            if (s >= 0 && s != long(a) && s != long(b) && s != long(c))
+                return true;
+        }
+        return false;
+    };
+
+    // Mortari's triangle order: sweep index gaps so a single spurious
+    // centroid spoils as few consecutive triangles as possible.
+    for (std::size_t dj = 1; dj + 1 < n; ++dj)
+        for (std::size_t dk = 1; dj + dk < n; ++dk)
+            for (std::size_t i = 0; i + dj + dk < n; ++i) {
+                const std::size_t j = i + dj;
+                const std::size_t k = j + dk;
+                const double tij = angle_between(body[i], body[j]);
+                const double tik = angle_between(body[i], body[k]);
+                const double tjk = angle_between(body[j], body[k]);
+                if (std::max({tij, tik, tjk}) > catalog_.max_pair_angle())
+                    continue;
+                const auto candidates = catalog_.pairs_between(tij - tolerance_, tij + tolerance_);
+                if (candidates.empty())
+                    continue;
+                partners(tik, ik);
+                partners(tjk, jk);
+                const bool handed = dot(body[i], cross(body[j], body[k])) > 0;
+                for (const StarPair& p : candidates)
+                    for (int flip = 0; flip < 2; ++flip) {
+                        const std::uint32_t a = flip ? p.b : p.a;
+                        const std::uint32_t b = flip ? p.a : p.b;
+                        const auto [first, last] = of(ik, a);
+                        for (auto it = first; it != last; ++it) {
+                            const std::uint32_t c = it->other;
+                            if (c == b || !std::binary_search(jk.begin(), jk.end(), Partner {b, c}))
+                                continue;
+                            const bool catalogue_handed =
+                                dot(stars[a].direction, cross(stars[b].direction, stars[c].direction)) > 0;
+                            if (handed != catalogue_handed || !confirm(i, j, k, a, b, c))
+                                continue;
+                            matches.assign(body.size(), -1);
+                            matches[i] = a;
+                            matches[j] = b;
+                            matches[k] = c;
+                            return true;
+                        }
+                    }
+            }
+    return false;
+}
+
+AttitudeProfile StarTracker::profile(std::span<const Vec3> body, const Matches& matches) const
+{
+    AttitudeProfile p;
+    for (std::size_t m = 0; m < body.size(); ++m)
+        if (matches[m] >= 0)
+            p.add(body[m], catalog_.stars()[std::size_t(matches[m])].direction);
+    return p;
+}
+
+AttitudeSolution StarTracker::refine(std::span<const Vec3> body, Matches& matches, AttitudeFit fit,
+                                     IdentificationMode mode) const
+{
+    AttitudeSolution solution;
+    solution.stars_detected = static_cast<std::uint32_t>(body.size());
+    Matches next;
+    for (int pass = 0; pass < max_refine_passes; ++pass) {
+        if (!fit.valid)
+            return solution;
+        next.assign(body.size(), -1);
+        for (std::size_t m = 0; m < body.size(); ++m)
+            next[m] = catalog_.nearest(fit.q.to_inertial(body[m]), tolerance_);
+        if (drop_duplicates(next) < config_.min_matches)
+            return solution;
+        if (next == matches)
+            break;
+        matches.swap(next);
+        fit = quest(profile(body, matches));
+    }
+    double sum2 = 0.0;
+    std::uint32_t matched = 0;
+    for (std::size_t m = 0; m < body.size(); ++m)
+        if (matches[m] >= 0) {
+            const double e = angle_between(fit.q.to_body(catalog_.stars()[std::size_t(matches[m])].direction),
+                                           body[m]);
+            sum2 += e * e;
+            ++matched;
+        }
+    solution.q = fit.q;
+    solution.mode = mode;
+    solution.stars_matched = matched;
+    solution.residual_arcsec = std::sqrt(sum2 / matched) / arcsec;
+    return solution;
+}
+
+AttitudeSolution StarTracker::identify(std::span<const StarCentroid> stars, const Quaternion* prior) const
+{
+    std::vector<Vec3> body;
+    body_vectors(stars, body);
+    Matches matches;
+    if (prior && track(body, *prior, matches)) {
+        AttitudeSolution s = refine(body, matches, quest(profile(body, matches)), IdentificationMode::tracking);
+        if (s.valid())
+            return s;
+    }
+    if (lost_in_space(body, matches))
+        return refine(body, matches, quest(profile(body, matches)), IdentificationMode::lost_in_space);
+    AttitudeSolution failed;
+    failed.stars_detected = static_cast<std::uint32_t>(body.size());
+    return failed;
+}
+
+AttitudeSolution StarTracker::solve(core::ImageView<const float> frame, const Quaternion* prior) const
+{
+    static const perf::Stage stage("attitude.frame");
+    const perf::ScopedTimer timer(stage);
+    std::vector<StarCentroid> stars;
+    find_stars(frame, config_.centroid, stars);
+    return identify(stars, prior);
+}
+
+void StarTracker::solve_batch(std::span<const StarFrame> frames, std::span<AttitudeSolution> out,
+                              sched::Scheduler& scheduler)
+{
+    if (out.size() != frames.size())
+        throw std::invalid_argument("attitude: solve_batch output size does not match input");
+    static const perf::Stage stage("attitude.batch");
+    const perf::ScopedTimer timer(stage);
+
+    struct Work {
+        std::vector<StarCentroid> stars;
+        std::vector<Vec3> body;
+        Matches matches;
+        IdentificationMode mode = IdentificationMode::failed;
+        bool done = false;
+    };
+    std::vector<Work> work(frames.size());
+    sched::parallel_for(scheduler, 0, frames.size(), 1, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t f = lo; f < hi; ++f) {
+            find_stars(frames[f].image, config_.centroid, work[f].stars);
+            body_vectors(work[f].stars, work[f].body);
+        }
+    });
+
+    // Spacecraft with no prior: lost in space on frames in order until one
+    // solves, then the rest of the batch tracks from it.
+    std::unordered_map<std::uint32_t, std::vector<std::size_t>> by_craft;
+    for (std::size_t f = 0; f < frames.size(); ++f)
+        by_craft[frames[f].spacecraft].push_back(f);
+    std::vector<std::uint32_t> lost;
+    for (const auto& [craft, list] : by_craft)
+        if (!priors_.contains(craft))
+            lost.push_back(craft);
+    std::vector<std::optional<Quaternion>> seeds(lost.size());
+    sched::parallel_for(scheduler, 0, lost.size(), 1, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t c = lo; c < hi; ++c)
+            for (const std::size_t f : by_craft.at(lost[c])) {
+                Work& w = work[f];
+                if (!lost_in_space(w.body, w.matches))
+                    continue;
+                out[f] = refine(w.body, w.matches, quest(profile(w.body, w.matches)),
+                                IdentificationMode::lost_in_space);
+                out[f].stars_detected = static_cast<std::uint32_t>(w.body.size());
+                w.done = true;
+                if (out[f].valid()) {
+                    seeds[c] = out[f].q;
+                    break;
+                }
+            }
+    });
+    std::unordered_map<std::uint32_t, Quaternion> start = priors_;
+    for (std::size_t c = 0; c < lost.size(); ++c)
+        if (seeds[c])
+            start[lost[c]] = *seeds[c];
+
+    // Identify everything else independently, then one batched solve.
+    std::vector<AttitudeProfile> profiles(frames.size());
+    sched::parallel_for(scheduler, 0, frames.size(), 4, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t f = lo; f < hi; ++f) {
+            Work& w = work[f];
+            if (w.done)
+                continue;
+            const auto it = start.find(frames[f].spacecraft);
+            if (it != start.end() && track(w.body, it->second, w.matches))
+                w.mode = IdentificationMode::tracking;
+            else if (lost_in_space(w.body, w.matches))
+                w.mode = IdentificationMode::lost_in_space;
+            if (w.mode != IdentificationMode::failed)
+                profiles[f] = profile(w.body, w.matches);
+        }
+    });
+    std::vector<AttitudeFit> fits(frames.size());
+    quest_batch(profiles, fits);
+    sched::parallel_for(scheduler, 0, frames.size(), 4, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t f = lo; f < hi; ++f) {
+            Work& w = work[f];
+            if (w.done)
+                continue;
+            out[f] = refine(w.body, w.matches, fits[f], w.mode);
+            if (!out[f].valid() && w.mode == IdentificationMode::tracking && lost_in_space(w.body, w.matches))
+                out[f] = refine(w.body, w.matches, quest(profile(w.body, w.matches)),
+                                IdentificationMode::lost_in_space);
+            out[f].stars_detected = static_cast<std::uint32_t>(w.body.size());
+        }
+    });
+
+    for (std::size_t f = 0; f < frames.size(); ++f)
+        if (out[f].valid())
+            priors_[frames[f].spacecraft] = out[f].q;
+}
+
+} // namespace solarlens::attitude
@@ -0,0 +1,32 @@
+#include "solarlens/bus/bus.hpp"
+
+namespace solarlens::bus {
+
+std::int64_t bus_clock_ns() noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+std::size_t TelemetryBus::topic_count() const
+{
+    const std::lock_guard lock(mutex_);
+    return topics_.size();
+}
+
+detail::TopicBase* TelemetryBus::find(std::string_view name, std::uint16_t type,
+                                      Publishers publishers) const
+{
+    for (const auto& t : topics_) {
+        if (t->name() != name)
+            continue;
+        if (t->type() != type || t->publishers() != publishers)
+            throw std::invalid_argument("bus: topic " + t->name()
+                                        + " exists with another type or publisher mode");
+        return t.get();
+    }
+    return nullptr;
+}
+
+} // namespace solarlens::bus
@@ -0,0 +1,216 @@
+#include "solarlens/calib/corona.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "corona_kernels.hpp"
+#include "solarlens/perf/instrument.hpp"
+#include "solarlens/sched/scheduler.hpp"
+
+namespace solarlens::calib {
+
+namespace {
+
+using detail::CoronaRow;
+
+struct Kernels {
+    detail::CoronaAccumulateFn accumulate;
+    detail::CoronaSubtractFn subtract;
+};
+
+Kernels kernels_for(core::SimdLevel level)
+{
+    switch (level) {
+#if defined(SOLARLENS_HAVE_AVX512)
+    case core::SimdLevel::avx512:
+        return {detail::corona_accumulate_avx512, detail::corona_subtract_avx512};
+#endif
+#if defined(SOLARLENS_HAVE_AVX2)
+    case core::SimdLevel::avx2:
+        return {detail::corona_accumulate_avx2, detail::corona_subtract_avx2};
+#endif
+#if defined(SOLARLENS_HAVE_NEON)
+    case core::SimdLevel::neon:
+        return {detail::corona_accumulate_neon, detail::corona_subtract_neon};
+#endif
+    default:
+        return {detail::corona_accumulate_scalar, detail::corona_subtract_scalar};
+    }
+}
+
+/// Maps u = (fit_inner / r)^2 from [(fit_inner / fit_outer)^2, 1] onto
+/// t in [-1, 1]; returns {t_num, t_offset}.
+std::pair<double, double> model_variable(const CoronaGeometry& g)
+{
+    const double ratio = double(g.fit_inner) / g.fit_outer;
+    const double u_min = ratio * ratio;
+    const double scale = 2.0 / (1.0 - u_min);
+    return {double(g.fit_inner) * g.fit_inner * scale, -(1.0 + u_min) / (1.0 - u_min)};
+}
+
+CoronaRow row_params(const CoronaGeometry& g, double t_num, double t_offset, std::uint32_t y)
+{
+    const float dy = float(y) - g.centre_y;
+    return {-g.centre_x,
+            dy * dy,
+            static_cast<float>(t_num),
+            static_cast<float>(t_offset),
+            g.occulter * g.occulter,
+            g.fit_inner * g.fit_inner,
+            g.fit_outer * g.fit_outer,
+            g.ring_inner * g.ring_inner,
+            g.ring_outer * g.ring_outer};
+}
+
+/// Solves the symmetric system in place by Gaussian elimination with
+/// partial pivoting; returns false if it is singular.
+bool solve(double (&a)[corona_terms][corona_terms], double (&b)[corona_terms])
+{
+    for (int col = 0; col < corona_terms; ++col) {
+        int pivot = col;
+        for (int r = col + 1; r < corona_terms; ++r)
+            if (std::abs(a[r][col]) > std::abs(a[pivot][col]))
+                pivot = r;
+        if (a[pivot][col] == 0.0)
+            return false;
+        if (pivot != col) {
+            std::swap(a[pivot], a[col]);
+            std::swap(b[pivot], b[col]);
+        }
+        for (int r = col + 1; r < corona_terms; ++r) {
+            const double f = a[r][col] / a[col][col];
+            for (int c = col; c < corona_terms; ++c)
+                a[r][c] -= f * a[col][c];
+            b[r] -= f * b[col];
+        }
+    }
+    for (int r = corona_terms - 1; r >= 0; --r) {
+        double s = b[r];
+        for (int c = r + 1; c < corona_terms; ++c)
+            s -= a[r][c] * b[c];
+        b[r] = s / a[r][r];
+    }
+    return true;
+}
+
+} // namespace
+
+CoronaSubtractor::CoronaSubtractor(const CoronaGeometry& geometry, core::SimdLevel level)
+    : geometry_(geometry)
+    , level_(level)
+{
+    const CoronaGeometry& g = geometry;
+    if (!(g.occulter >= 0.0f && g.fit_inner > 0.0f && g.fit_inner >= g.occulter
+          && g.fit_outer > g.fit_inner && g.ring_outer >= g.ring_inner))
+        throw std::invalid_argument("CoronaSubtractor: inconsistent radii");
+    if (!core::simd_level_supported(level))
+        throw std::invalid_argument(std::string("CoronaSubtractor: SIMD level ")
+                                    + core::to_string(level) + " not available");
+}
+
+CoronaModel CoronaSubtractor::fit(core::ImageView<const float> frame) const
+{
+    const Kernels k = kernels_for(level_);
+    double moments[detail::corona_moments] = {};
+    const float lo = std::max(0.0f, geometry_.centre_y - geometry_.fit_outer);
+    const float hi = geometry_.centre_y + geometry_.fit_outer + 1.0f;
+    const auto y0 = static_cast<std::uint32_t>(std::min<float>(lo, float(frame.height)));
+    const auto y1 = static_cast<std::uint32_t>(std::min<float>(hi, float(frame.height)));
+    CoronaModel model;
+    std::tie(model.t_num, model.t_offset) = model_variable(geometry_);
+    for (std::uint32_t y = y0; y < y1; ++y)
+        k.accumulate(frame.row(y), frame.width,
+                     row_params(geometry_, model.t_num, model.t_offset, y), moments);
+
+    model.fit_pixels = static_cast<std::uint64_t>(moments[0]);
+    if (model.fit_pixels < 4 * corona_terms)
+        throw std::runtime_error("corona fit: too few usable pixels in fit annulus");
+
+    double a[corona_terms][corona_terms];
+    double b[corona_terms];
+    for (int r = 0; r < corona_terms; ++r) {
+        for (int c = 0; c < corona_terms; ++c)
+            a[r][c] = moments[r + c];
+        b[r] = moments[detail::corona_power_sums + r];
+    }
+    if (!solve(a, b))
+        throw std::runtime_error("corona fit: singular normal equations");
+    std::copy(std::begin(b), std::end(b), model.coeffs.begin());
+    return model;
+}
+
+void CoronaSubtractor::subtract(core::ImageView<float> frame, const CoronaModel& model) const
+{
+    const Kernels k = kernels_for(level_);
+    float c[corona_terms];
+    for (int i = 0; i < corona_terms; ++i)
+        c[i] = static_cast<float>(model.coeffs[i]);
+    for (std::uint32_t y = 0; y < frame.height; ++y)
+        k.subtract(frame.row(y), frame.width,
+                   row_params(geometry_, model.t_num, model.t_offset, y), c);
+}
+
+CoronaModel CoronaSubtractor::process(core::ImageView<float> frame) const
+{
+    static const perf::Stage stage("calib.corona");
+    const perf::ScopedTimer timer(stage);
+    const CoronaModel model = fit(frame);
+    subtract(frame, model);
+    return model;
+}
+
+std::size_t process_frames(const CoronaSubtractor& subtractor,
+                           std::span<const core::ImageView<float>> frames,
+                           std::span<CoronaModel> models, sched::Scheduler& scheduler)
+{
+    if (models.size() < frames.size())
+        throw std::invalid_argument("process_frames: model span shorter than frame span");
+    std::atomic<std::size_t> ok {0};
+    sched::parallel_for(scheduler, 0, frames.size(), 1, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t i = lo; i < hi; ++i) {
+            try {
+                models[i] = subtractor.process(frames[i]);
+                ok.fetch_add(1, std::memory_order_relaxed);
+            } catch (const std::runtime_error&) {
+                models[i] = CoronaModel {};
+            }
+        }
+    });
+    return ok.load();
+}
+
+CalibratedFrames calibrate_frames(const CoronaSubtractor& subtractor,
+                                  std::span<const core::ImageView<const float>> raw,
+                                  core::PassArena& arena, sched::Scheduler& scheduler)
+{
+    // Allocation happens up front on this thread; the arena is not shared
+    // with the workers.
+    CalibratedFrames out {std::pmr::vector<core::ImageView<float>>(&arena),
+                          std::pmr::vector<CoronaModel>(raw.size(), &arena)};
+    out.frames.reserve(raw.size());
+    for (const core::ImageView<const float>& src : raw)
+        out.frames.push_back(core::allocate_image<float>(arena, src.width, src.height));
+
+    std::atomic<std::size_t> ok {0};
+    sched::parallel_for(scheduler, 0, raw.size(), 1, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t i = lo; i < hi; ++i) {
+            for (std::uint32_t y = 0; y < raw[i].height; ++y)
+                std::copy_n(raw[i].row(y), raw[i].width, out.frames[i].row(y));
+            try {
+                out.models[i] = subtractor.process(out.frames[i]);
+                ok.fetch_add(1, std::memory_order_relaxed);
+            } catch (const std::runtime_error&) {
+                out.models[i] = CoronaModel {};
+            }
+        }
+    });
+    out.succeeded = ok.load();
+    return out;
+}
+
+} // namespace solarlens::calib
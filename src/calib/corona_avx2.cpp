@@ -0,0 +1,110 @@
+// AVX2 + FMA kernels: eight pixels per step, scalar tail.
+
+#include <immintrin.h>
+
+#include "corona_kernels.hpp"
+
+namespace solarlens::calib::detail {
+
+namespace {
+
+constexpr int lanes = 8;
+
+double hsum(__m256 v)
+{
+    alignas(32) float t[lanes];
+    _mm256_store_ps(t, v);
+    double s = 0.0;
+    for (int i = 0; i < lanes; ++i)
+        s += t[i];
+    return s;
+}
+
+} // namespace
+
+void corona_accumulate_avx2(const float* row, std::uint32_t width, const CoronaRow& p,
+                            double* moments)
+{
+    const __m256 dy2 = _mm256_set1_ps(p.dy2);
+    const __m256 t_num = _mm256_set1_ps(p.t_num);
+    const __m256 t_offset = _mm256_set1_ps(p.t_offset);
+    const __m256 fit_lo = _mm256_set1_ps(p.fit_lo_sq);
+    const __m256 fit_hi = _mm256_set1_ps(p.fit_hi_sq);
+    const __m256 ring_lo = _mm256_set1_ps(p.ring_lo_sq);
+    const __m256 ring_hi = _mm256_set1_ps(p.ring_hi_sq);
+    const __m256 one = _mm256_set1_ps(1.0f);
+    const __m256 step = _mm256_set1_ps(float(lanes));
+    __m256 dx = _mm256_add_ps(_mm256_set1_ps(p.x0), _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7));
+
+    __m256 acc[corona_moments];
+    for (__m256& a : acc)
+        a = _mm256_setzero_ps();
+
+    std::uint32_t x = 0;
+    for (; x + lanes <= width; x += lanes) {
+        const __m256 v = _mm256_loadu_ps(row + x);
+        const __m256 r2 = _mm256_fmadd_ps(dx, dx, dy2);
+        const __m256 in_fit = _mm256_and_ps(_mm256_cmp_ps(r2, fit_lo, _CMP_GE_OQ),
+                                            _mm256_cmp_ps(r2, fit_hi, _CMP_LE_OQ));
+        const __m256 in_ring = _mm256_and_ps(_mm256_cmp_ps(r2, ring_lo, _CMP_GE_OQ),
+                                             _mm256_cmp_ps(r2, ring_hi, _CMP_LE_OQ));
+        // Finite test: v - v is 0 for finite v and NaN otherwise.
+        const __m256 finite = _mm256_cmp_ps(_mm256_sub_ps(v, v), _mm256_setzero_ps(), _CMP_EQ_OQ);
+        const __m256 mask = _mm256_andnot_ps(in_ring, _mm256_and_ps(in_fit, finite));
+        // Mask t as well: r = 0 gives t = inf, and inf * 0 would poison
+        // the excluded lanes.
+        const __m256 t = _mm256_and_ps(mask, _mm256_add_ps(_mm256_div_ps(t_num, r2), t_offset));
+        const __m256 vm = _mm256_and_ps(mask, v);
+        __m256 tk = _mm256_and_ps(mask, one);
+        for (int k = 0; k < corona_power_sums; ++k) {
+            acc[k] = _mm256_add_ps(acc[k], tk);
+            if (k < corona_moments - corona_power_sums)
+                acc[corona_power_sums + k] = _mm256_fmadd_ps(vm, tk, acc[corona_power_sums + k]);
+            tk = _mm256_mul_ps(tk, t);
+        }
+        dx = _mm256_add_ps(dx, step);
+    }
+    for (int k = 0; k < corona_moments; ++k)
+        moments[k] += hsum(acc[k]);
+    if (x < width) {
+        CoronaRow tail = p;
+        tail.x0 += float(x);
+        corona_accumulate_scalar(row + x, width - x, tail, moments);
+    }
+}
+
+void corona_subtract_avx2(float* row, std::uint32_t width, const CoronaRow& p, const float* c)
+{
+    const __m256 dy2 = _mm256_set1_ps(p.dy2);
+    const __m256 t_num = _mm256_set1_ps(p.t_num);
+    const __m256 t_offset = _mm256_set1_ps(p.t_offset);
+    const __m256 occulter = _mm256_set1_ps(p.occulter_sq);
+    const __m256 c0 = _mm256_set1_ps(c[0]);
+    const __m256 c1 = _mm256_set1_ps(c[1]);
+    const __m256 c2 = _mm256_set1_ps(c[2]);
+    const __m256 c3 = _mm256_set1_ps(c[3]);
+    const __m256 c4 = _mm256_set1_ps(c[4]);
+    const __m256 step = _mm256_set1_ps(float(lanes));
+    __m256 dx = _mm256_add_ps(_mm256_set1_ps(p.x0), _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7));
+
+    std::uint32_t x = 0;
+    for (; x + lanes <= width; x += lanes) {
+        const __m256 r2 = _mm256_fmadd_ps(dx, dx, dy2);
+        const __m256 t = _mm256_add_ps(_mm256_div_ps(t_num, r2), t_offset);
+        __m256 model = _mm256_fmadd_ps(t, c4, c3);
+        model = _mm256_fmadd_ps(t, model, c2);
+        model = _mm256_fmadd_ps(t, model, c1);
+        model = _mm256_fmadd_ps(t, model, c0);
+        const __m256 keep = _mm256_cmp_ps(r2, occulter, _CMP_GE_OQ);
+        const __m256 out = _mm256_sub_ps(_mm256_loadu_ps(row + x), model);
+        _mm256_storeu_ps(row + x, _mm256_and_ps(keep, out));
+        dx = _mm256_add_ps(dx, step);
+    }
+    if (x < width) {
+        CoronaRow tail = p;
+        tail.x0 += float(x);
+        corona_subtract_scalar(row + x, width - x, tail, c);
+    }
+}
+
+} // namespace solarlens::calib::detail
@@ -0,0 +1,103 @@
+// AVX-512F kernels: sixteen pixels per step, masked tail.
+
+#include <immintrin.h>
+
+#include "corona_kernels.hpp"
+
+namespace solarlens::calib::detail {
+
+namespace {
+
+constexpr int lanes = 16;
+
+__mmask16 tail_mask(std::uint32_t remaining)
+{
+    return remaining >= lanes ? __mmask16(0xffff) : __mmask16((1u << remaining) - 1u);
+}
+
+} // namespace
+
+void corona_accumulate_avx512(const float* row, std::uint32_t width, const CoronaRow& p,
+                              double* moments)
+{
+    const __m512 dy2 = _mm512_set1_ps(p.dy2);
+    const __m512 t_num = _mm512_set1_ps(p.t_num);
+    const __m512 t_offset = _mm512_set1_ps(p.t_offset);
+    const __m512 fit_lo = _mm512_set1_ps(p.fit_lo_sq);
+    const __m512 fit_hi = _mm512_set1_ps(p.fit_hi_sq);
+    const __m512 ring_lo = _mm512_set1_ps(p.ring_lo_sq);
+    const __m512 ring_hi = _mm512_set1_ps(p.ring_hi_sq);
+    const __m512 one = _mm512_set1_ps(1.0f);
+    const __m512 step = _mm512_set1_ps(float(lanes));
+    __m512 dx = _mm512_add_ps(_mm512_set1_ps(p.x0),
+                              _mm512_setr_ps(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+
+    __m512 acc[corona_moments];
+    for (__m512& a : acc)
+        a = _mm512_setzero_ps();
+
+    for (std::uint32_t x = 0; x < width; x += lanes) {
+        const __mmask16 live = tail_mask(width - x);
+        const __m512 v = _mm512_maskz_loadu_ps(live, row + x);
+        const __m512 r2 = _mm512_fmadd_ps(dx, dx, dy2);
+        const __mmask16 in_fit = _mm512_mask_cmp_ps_mask(
+            _mm512_cmp_ps_mask(r2, fit_lo, _CMP_GE_OQ), r2, fit_hi, _CMP_LE_OQ);
+        const __mmask16 in_ring = _mm512_mask_cmp_ps_mask(
+            _mm512_cmp_ps_mask(r2, ring_lo, _CMP_GE_OQ), r2, ring_hi, _CMP_LE_OQ);
+        const __mmask16 finite = _mm512_cmp_ps_mask(_mm512_sub_ps(v, v), _mm512_setzero_ps(),
+                                                    _CMP_EQ_OQ);
+        const __mmask16 mask = live & in_fit & finite & __mmask16(~in_ring);
+        // Mask t as well: r = 0 gives t = inf, and inf * 0 would poison
+        // the excluded lanes.
+        const __m512 t = _mm512_maskz_add_ps(mask, _mm512_maskz_div_ps(mask, t_num, r2), t_offset);
+        const __m512 vm = _mm512_maskz_mov_ps(mask, v);
+        __m512 tk = _mm512_maskz_mov_ps(mask, one);
+        for (int k = 0; k < corona_power_sums; ++k) {
+            acc[k] = _mm512_add_ps(acc[k], tk);
+            if (k < corona_moments - corona_power_sums)
+                acc[corona_power_sums + k] = _mm512_fmadd_ps(vm, tk, acc[corona_power_sums + k]);
+            tk = _mm512_mul_ps(tk, t);
+        }
+        dx = _mm512_add_ps(dx, step);
+    }
+    for (int k = 0; k < corona_moments; ++k) {
+        alignas(64) float t[lanes];
+        _mm512_store_ps(t, acc[k]);
+        double s = 0.0;
+        for (int i = 0; i < lanes; ++i)
+            s += t[i];
+        moments[k] += s;
+    }
+}
+
+void corona_subtract_avx512(float* row, std::uint32_t width, const CoronaRow& p, const float* c)
+{
+    const __m512 dy2 = _mm512_set1_ps(p.dy2);
+    const __m512 t_num = _mm512_set1_ps(p.t_num);
+    const __m512 t_offset = _mm512_set1_ps(p.t_offset);
+    const __m512 occulter = _mm512_set1_ps(p.occulter_sq);
+    const __m512 c0 = _mm512_set1_ps(c[0]);
+    const __m512 c1 = _mm512_set1_ps(c[1]);
+    const __m512 c2 = _mm512_set1_ps(c[2]);
+    const __m512 c3 = _mm512_set1_ps(c[3]);
+    const __m512 c4 = _mm512_set1_ps(c[4]);
+    const __m512 step = _mm512_set1_ps(float(lanes));
+    __m512 dx = _mm512_add_ps(_mm512_set1_ps(p.x0),
+                              _mm512_setr_ps(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+
+    for (std::uint32_t x = 0; x < width; x += lanes) {
+        const __mmask16 live = tail_mask(width - x);
+        const __m512 r2 = _mm512_fmadd_ps(dx, dx, dy2);
+        const __m512 t = _mm512_add_ps(_mm512_div_ps(t_num, r2), t_offset);
+        __m512 model = _mm512_fmadd_ps(t, c4, c3);
+        model = _mm512_fmadd_ps(t, model, c2);
+        model = _mm512_fmadd_ps(t, model, c1);
+        model = _mm512_fmadd_ps(t, model, c0);
+        const __mmask16 keep = _mm512_cmp_ps_mask(r2, occulter, _CMP_GE_OQ);
+        const __m512 out = _mm512_sub_ps(_mm512_maskz_loadu_ps(live, row + x), model);
+        _mm512_mask_storeu_ps(row + x, live, _mm512_maskz_mov_ps(keep, out));
+        dx = _mm512_add_ps(dx, step);
+    }
+}
+
+} // namespace solarlens::calib::detail
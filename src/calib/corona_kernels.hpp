@@ -0,0 +1,54 @@
+#pragma once
+
+// Per-ISA row kernels behind CoronaSubtractor. Each set lives in its own
+// translation unit built with that ISA's flags; keep this header free of
+// inline code so nothing ISA-specific leaks into shared COMDAT sections.
+
+#include <cstdint>
+
+namespace solarlens::calib::detail {
+
+/// Everything a kernel needs for one row; radii are squared. The model
+/// variable is t = t_num / r^2 + t_offset.
+struct CoronaRow {
+    float x0;  ///< Column 0's x offset from the Sun centre.
+    float dy2; ///< Squared y offset of this row.
+    float t_num;
+    float t_offset;
+    float occulter_sq;
+    float fit_lo_sq;
+    float fit_hi_sq;
+    float ring_lo_sq;
+    float ring_hi_sq;
+};
+
+/// Moment vector layout: S0..S8 = sum t^k over fit pixels, then
+/// T0..T4 = sum I t^k.
+inline constexpr int corona_power_sums = 9;
+inline constexpr int corona_moments = corona_power_sums + 5;
+
+/// Adds this row's moments into `moments` (double[corona_moments]).
+using CoronaAccumulateFn = void (*)(const float* row, std::uint32_t width, const CoronaRow& p,
+                                    double* moments);
+
+/// Subtracts the model with coefficients `c` (float[5]) in place.
+using CoronaSubtractFn = void (*)(float* row, std::uint32_t width, const CoronaRow& p,
+                                  const float* c);
+
+void corona_accumulate_scalar(const float*, std::uint32_t, const CoronaRow&, double*);
+void corona_subtract_scalar(float*, std::uint32_t, const CoronaRow&, const float*);
+
+#if defined(SOLARLENS_HAVE_AVX2)
+void corona_accumulate_avx2(const float*, std::uint32_t, const CoronaRow&, double*);
+void corona_subtract_avx2(float*, std::uint32_t, const CoronaRow&, const float*);
+#endif
+#if defined(SOLARLENS_HAVE_AVX512)
+void corona_accumulate_avx512(const float*, std::uint32_t, const CoronaRow&, double*);
+void corona_subtract_avx512(float*, std::uint32_t, const CoronaRow&, const float*);
+#endif
+#if defined(SOLARLENS_HAVE_NEON)
+void corona_accumulate_neon(const float*, std::uint32_t, const CoronaRow&, double*);
+void corona_subtract_neon(float*, std::uint32_t, const CoronaRow&, const float*);
+#endif
+
+} // namespace solarlens::calib::detail
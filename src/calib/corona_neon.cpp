@@ -0,0 +1,111 @@
+// AArch64 NEON kernels: four pixels per step, scalar tail.
+
+#include <arm_neon.h>
+
+#include "corona_kernels.hpp"
+
+namespace solarlens::calib::detail {
+
+namespace {
+
+constexpr int lanes = 4;
+
+float32x4_t lane_offsets()
+{
+    const float offsets[lanes] = {0.0f, 1.0f, 2.0f, 3.0f};
+    return vld1q_f32(offsets);
+}
+
+float32x4_t select(uint32x4_t mask, float32x4_t v)
+{
+    return vreinterpretq_f32_u32(vandq_u32(mask, vreinterpretq_u32_f32(v)));
+}
+
+} // namespace
+
+void corona_accumulate_neon(const float* row, std::uint32_t width, const CoronaRow& p,
+                            double* moments)
+{
+    const float32x4_t dy2 = vdupq_n_f32(p.dy2);
+    const float32x4_t t_num = vdupq_n_f32(p.t_num);
+    const float32x4_t t_offset = vdupq_n_f32(p.t_offset);
+    const float32x4_t fit_lo = vdupq_n_f32(p.fit_lo_sq);
+    const float32x4_t fit_hi = vdupq_n_f32(p.fit_hi_sq);
+    const float32x4_t ring_lo = vdupq_n_f32(p.ring_lo_sq);
+    const float32x4_t ring_hi = vdupq_n_f32(p.ring_hi_sq);
+    const float32x4_t one = vdupq_n_f32(1.0f);
+    const float32x4_t step = vdupq_n_f32(float(lanes));
+    float32x4_t dx = vaddq_f32(vdupq_n_f32(p.x0), lane_offsets());
+
+    float32x4_t acc[corona_moments];
+    for (float32x4_t& a : acc)
+        a = vdupq_n_f32(0.0f);
+
+    std::uint32_t x = 0;
+    for (; x + lanes <= width; x += lanes) {
+        const float32x4_t v = vld1q_f32(row + x);
+        const float32x4_t r2 = vfmaq_f32(dy2, dx, dx);
+        const uint32x4_t in_fit = vandq_u32(vcgeq_f32(r2, fit_lo), vcleq_f32(r2, fit_hi));
+        const uint32x4_t in_ring = vandq_u32(vcgeq_f32(r2, ring_lo), vcleq_f32(r2, ring_hi));
+        const uint32x4_t finite = vceqq_f32(vsubq_f32(v, v), vdupq_n_f32(0.0f));
+        const uint32x4_t mask = vbicq_u32(vandq_u32(in_fit, finite), in_ring);
+        // Mask t as well: r = 0 gives t = inf, and inf * 0 would poison
+        // the excluded lanes.
+        const float32x4_t t = select(mask, vaddq_f32(vdivq_f32(t_num, r2), t_offset));
+        const float32x4_t vm = select(mask, v);
+        float32x4_t tk = select(mask, one);
+        for (int k = 0; k < corona_power_sums; ++k) {
+            acc[k] = vaddq_f32(acc[k], tk);
+            if (k < corona_moments - corona_power_sums)
+                acc[corona_power_sums + k] = vfmaq_f32(acc[corona_power_sums + k], vm, tk);
+            tk = vmulq_f32(tk, t);
+        }
+        dx = vaddq_f32(dx, step);
+    }
+    for (int k = 0; k < corona_moments; ++k) {
+        const float64x2_t wide = vaddq_f64(vcvt_f64_f32(vget_low_f32(acc[k])),
+                                           vcvt_high_f64_f32(acc[k]));
+        moments[k] += vaddvq_f64(wide);
+    }
+    if (x < width) {
+        CoronaRow tail = p;
+        tail.x0 += float(x);
+        corona_accumulate_scalar(row + x, width - x, tail, moments);
+    }
+}
+
+void corona_subtract_neon(float* row, std::uint32_t width, const CoronaRow& p, const float* c)
+{
+    const float32x4_t dy2 = vdupq_n_f32(p.dy2);
+    const float32x4_t t_num = vdupq_n_f32(p.t_num);
+    const float32x4_t t_offset = vdupq_n_f32(p.t_offset);
+    const float32x4_t occulter = vdupq_n_f32(p.occulter_sq);
+    const float32x4_t c0 = vdupq_n_f32(c[0]);
+    const float32x4_t c1 = vdupq_n_f32(c[1]);
+    const float32x4_t c2 = vdupq_n_f32(c[2]);
+    const float32x4_t c3 = vdupq_n_f32(c[3]);
+    const float32x4_t c4 = vdupq_n_f32(c[4]);
+    const float32x4_t step = vdupq_n_f32(float(lanes));
+    float32x4_t dx = vaddq_f32(vdupq_n_f32(p.x0), lane_offsets());
+
+    std::uint32_t x = 0;
+    for (; x + lanes <= width; x += lanes) {
+        const float32x4_t r2 = vfmaq_f32(dy2, dx, dx);
+        const float32x4_t t = vaddq_f32(vdivq_f32(t_num, r2), t_offset);
+        float32x4_t model = vfmaq_f32(c3, t, c4);
+        model = vfmaq_f32(c2, t, model);
+        model = vfmaq_f32(c1, t, model);
+        model = vfmaq_f32(c0, t, model);
+        const uint32x4_t keep = vcgeq_f32(r2, occulter);
+        const float32x4_t out = vsubq_f32(vld1q_f32(row + x), model);
+        vst1q_f32(row + x, select(keep, out));
+        dx = vaddq_f32(dx, step);
+    }
+    if (x < width) {
+        CoronaRow tail = p;
+        tail.x0 += float(x);
+        corona_subtract_scalar(row + x, width - x, tail, c);
+    }
+}
+
+} // namespace solarlens::calib::detail
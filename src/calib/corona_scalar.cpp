@@ -0,0 +1,47 @@
+// Scalar reference kernels. Built with auto-vectorisation disabled so they
+// stay a faithful baseline for validation and benchmarking.
+
+#include <cmath>
+
+#include "corona_kernels.hpp"
+
+namespace solarlens::calib::detail {
+
+void corona_accumulate_scalar(const float* row, std::uint32_t width, const CoronaRow& p,
+                              double* moments)
+{
+    for (std::uint32_t x = 0; x < width; ++x) {
+        const float dx = p.x0 + float(x);
+        const float r2 = dx * dx + p.dy2;
+        const float v = row[x];
+        const bool in_fit = r2 >= p.fit_lo_sq && r2 <= p.fit_hi_sq;
+        const bool in_ring = r2 >= p.ring_lo_sq && r2 <= p.ring_hi_sq;
+        if (!in_fit || in_ring || !std::isfinite(v))
+            continue;
+        const float t = p.t_num / r2 + p.t_offset;
+        float tk = 1.0f;
+        for (int k = 0; k < corona_power_sums; ++k) {
+            moments[k] += tk;
+            if (k < corona_moments - corona_power_sums)
+                moments[corona_power_sums + k] += double(v) * tk;
+            tk *= t;
+        }
+    }
+}
+
+void corona_subtract_scalar(float* row, std::uint32_t width, const CoronaRow& p, const float* c)
+{
+    for (std::uint32_t x = 0; x < width; ++x) {
+        const float dx = p.x0 + float(x);
+        const float r2 = dx * dx + p.dy2;
+        if (r2 < p.occulter_sq) {
+            row[x] = 0.0f;
+            continue;
+        }
+        const float t = p.t_num / r2 + p.t_offset;
+        const float model = c[0] + t * (c[1] + t * (c[2] + t * (c[3] + t * c[4])));
+        row[x] -= model;
+    }
+}
+
+} // namespace solarlens::calib::detail
@@ -0,0 +1,428 @@
+#include "solarlens/calib/registration.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "solarlens/perf/instrument.hpp"
+#include "solarlens/sched/scheduler.hpp"
+
+namespace solarlens::calib {
+
+namespace {
+
+constexpr double two_pi = 6.283185307179586;
+
+using cfloat = std::complex<float>;
+
+void transpose(cfloat* a, std::size_t n) noexcept
+{
+    for (std::size_t i = 0; i < n; ++i)
+        for (std::size_t j = i + 1; j < n; ++j)
+            std::swap(a[i * n + j], a[j * n + i]);
+}
+
+// 2D transform of an n x n row-major block, leaving it row-major.
+void transform_2d(const core::FftPlan& plan, cfloat* a, bool inverse)
+{
+    const std::size_t n = plan.size();
+    for (int pass = 0; pass < 2; ++pass) {
+        if (inverse)
+            plan.inverse_batch(a, n, n);
+        else
+            plan.forward_batch(a, n, n);
+        transpose(a, n);
+    }
+}
+
+// Signed frequency of index i on an n-point grid.
+int frequency(std::size_t i, std::size_t n) noexcept
+{
+    return i < n / 2 ? int(i) : int(i) - int(n);
+}
+
+// Keys cubic convolution weights (a = -0.5) for fractional offset f.
+void cubic_weights(float f, float (&w)[4]) noexcept
+{
+    const auto near = [](float s) { return (1.5f * s - 2.5f) * s * s + 1.0f; };
+    const auto far = [](float s) { return ((-0.5f * s + 2.5f) * s - 4.0f) * s + 2.0f; };
+    w[0] = far(1.0f + f);
+    w[1] = near(f);
+    w[2] = near(1.0f - f);
+    w[3] = far(2.0f - f);
+}
+
+// dst[i] = sum_k w[k] src[clamp(i + offset + k - 1)] for i < n, edge
+// samples repeated; elements are src_step and dst_step apart.
+void resample_line(const float* src, std::size_t src_step, float* dst, std::size_t dst_step, long n, long offset,
+                   const float (&w)[4]) noexcept
+{
+    const auto at = [&](long i) { return src[std::size_t(std::clamp(i, 0L, n - 1)) * src_step]; };
+    const auto clamped = [&](long i) {
+        dst[std::size_t(i) * dst_step] = w[0] * at(i + offset - 1) + w[1] * at(i + offset) + w[2] * at(i + offset + 1)
+                                         + w[3] * at(i + offset + 2);
+    };
+    const long lo = std::clamp(1 - offset, 0L, n);
+    const long hi = std::clamp(n - 2 - offset, lo, n);
+    for (long i = 0; i < lo; ++i)
+        clamped(i);
+    for (long i = lo; i < hi; ++i) {
+        const float* t = src + std::size_t(i + offset - 1) * src_step;
+        dst[std::size_t(i) * dst_step] = w[0] * t[0] + w[1] * t[src_step] + w[2] * t[2 * src_step]
+                                         + w[3] * t[3 * src_step];
+    }
+    for (long i = hi; i < n; ++i)
+        clamped(i);
+}
+
+} // namespace
+
+struct FrameRegistrar::Workspace {
+    std::vector<cfloat> region;   // size^2
+    std::vector<cfloat> spectrum; // band^2
+    std::vector<cfloat> surface;  // band^2
+    std::vector<cfloat> ramp_x, ramp_y;
+    std::vector<float> scratch;   // One frame.
+};
+
+void RegistrationConfig::validate() const
+{
+    if (!core::is_power_of_two(size) || size < 16)
+        throw std::invalid_argument("registration: size must be a power of two >= 16");
+    if (!core::is_power_of_two(band) || band < 8 || band > size)
+        throw std::invalid_argument("registration: band must be a power of two in [8, size]");
+    if (window == 0)
+        throw std::invalid_argument("registration: window must be positive");
+    if (!(mask_radius >= 0.0f) || !(mask_taper >= 0.0f))
+        throw std::invalid_argument("registration: mask radius and taper must be non-negative");
+    if (!(max_shift > 0.0f) || max_shift >= 0.25f * float(size))
+        throw std::invalid_argument("registration: max_shift must be in (0, size / 4)");
+    if (!(min_peak >= 0.0f))
+        throw std::invalid_argument("registration: min_peak must be non-negative");
+    if (frames_per_task == 0)
+        throw std::invalid_argument("registration: frames_per_task must be positive");
+}
+
+FrameRegistrar::FrameRegistrar(const RegistrationConfig& config)
+    : config_(config)
+{
+    config_.validate();
+    plan_ = core::FftPlan::get(config_.size);
+    band_plan_ = core::FftPlan::get(config_.band);
+
+    const std::size_t n = config_.size;
+    const double c = 0.5 * double(n) - 0.5;
+    apodization_.resize(n * n);
+    std::vector<double> hann(n);
+    for (std::size_t i = 0; i < n; ++i)
+        hann[i] = 0.5 - 0.5 * std::cos(two_pi * (double(i) + 0.5) / double(n));
+    for (std::size_t y = 0; y < n; ++y)
+        for (std::size_t x = 0; x < n; ++x) {
+            const double r = std::hypot(double(x) - c, double(y) - c);
+            double mask = 1.0;
+            if (r < config_.mask_radius)
+                mask = 0.0;
+            else if (r < config_.mask_radius + config_.mask_taper)
+                mask = 0.5 - 0.5 * std::cos(3.14159265358979323846 * (r - config_.mask_radius) / config_.mask_taper);
+            apodization_[y * n + x] = float(hann[x] * hann[y] * mask);
+        }
+    const std::size_t m = config_.band;
+    laplacian_.resize(m * m);
+    for (std::size_t y = 0; y < m; ++y)
+        for (std::size_t x = 0; x < m; ++x)
+            laplacian_[y * m + x] = float(4.0 - 2.0 * std::cos(two_pi * frequency(x, m) / double(n))
+                                          - 2.0 * std::cos(two_pi * frequency(y, m) / double(n)));
+}
+
+FrameRegistrar::~FrameRegistrar() = default;
+
+void FrameRegistrar::reset(std::uint32_t stream)
+{
+    streams_.erase(stream);
+}
+
+std::size_t FrameRegistrar::reference_frames(std::uint32_t stream) const noexcept
+{
+    const auto it = streams_.find(stream);
+    return it == streams_.end() ? 0 : it->second.count;
+}
+
+void FrameRegistrar::register_frame(const core::ImageView<float>& frame, const cfloat* reference, float mean_x,
+                                    float mean_y, cfloat* slot, FrameShift& shift, Workspace& ws) const
+{
+    static const perf::Stage stage("calib.register");
+    perf::ScopedTimer timer(stage);
+    const std::size_t n = config_.size;
+    const std::size_t m = config_.band;
+    const std::uint32_t x0 = (frame.width - config_.size) / 2;
+    const std::uint32_t y0 = (frame.height - config_.size) / 2;
+
+    // Apodized Laplacian of the region, then its low-frequency block. The
+    // Laplacian flattens the corona, which would otherwise dominate as a
+    // fixed bright blob under the window and pull every offset to zero.
+    const std::uint32_t last_x = frame.width - 1;
+    const std::uint32_t last_y = frame.height - 1;
+    for (std::size_t y = 0; y < n; ++y) {
+        const std::uint32_t fy = std::uint32_t(y0 + y);
+        const float* row = frame.row(fy);
+        const float* up = frame.row(fy > 0 ? fy - 1 : fy);
+        const float* down = frame.row(fy < last_y ? fy + 1 : fy);
+        const float* a = &apodization_[y * n];
+        cfloat* out = &ws.region[y * n];
+        for (std::size_t x = 0; x < n; ++x) {
+            const std::uint32_t fx = std::uint32_t(x0 + x);
+            const float left = row[fx > 0 ? fx - 1 : fx];
+            const float right = row[fx < last_x ? fx + 1 : fx];
+            out[x] = cfloat((4.0f * row[fx] - left - right - up[fx] - down[fx]) * a[x], 0.0f);
+        }
+    }
+    transform_2d(*plan_, ws.region.data(), false);
+    for (std::size_t by = 0; by < m; ++by) {
+        const std::size_t ky = by < m / 2 ? by : n - m + by;
+        std::copy_n(&ws.region[ky * n], m / 2, &ws.spectrum[by * m]);
+        std::copy_n(&ws.region[ky * n + n - m / 2], m / 2, &ws.spectrum[by * m + m / 2]);
+    }
+
+    if (reference == nullptr) {
+        shift = {0.0f, 0.0f, 1.0f, false};
+        if (slot != nullptr)
+            std::copy(ws.spectrum.begin(), ws.spectrum.end(), slot);
+        return;
+    }
+
+    // Phase correlation on the band grid, whose spacing is size / band
+    // pixels; the peak sits at the shift times band / size.
+    for (std::size_t i = 0; i < m * m; ++i) {
+        const cfloat c = ws.spectrum[i] * reference[i];
+        const float mag = std::abs(c);
+        ws.surface[i] = mag > 0.0f ? c / mag : cfloat(0.0f);
+    }
+    transform_2d(*band_plan_, ws.surface.data(), true);
+    std::size_t best = 0;
+    for (std::size_t i = 1; i < m * m; ++i)
+        if (ws.surface[i].real() > ws.surface[best].real())
+            best = i;
+    const std::size_t px = best % m;
+    const std::size_t py = best / m;
+    const auto value = [&](std::size_t x, std::size_t y) { return double(ws.surface[(y % m) * m + x % m].real()); };
+    const auto vertex = [](double l, double c, double r) {
+        const double d = l - 2.0 * c + r;
+        return d < 0.0 ? std::clamp(0.5 * (l - r) / d, -0.5, 0.5) : 0.0;
+    };
+    const double centre = value(px, py);
+    const double grid = double(n) / double(m);
+    double dx = (frequency(px, m) + vertex(value(px + m - 1, py), centre, value(px + 1, py))) * grid;
+    double dy = (frequency(py, m) + vertex(value(px, py + m - 1), centre, value(px, py + 1))) * grid;
+    shift.peak = float(centre / double(m * m));
+
+    // Weighted least squares on the residual cross-spectrum phase, first
+    // over the inner half of the band where a grid-sized residual cannot
+    // wrap, then over all of it.
+    const float* laplacian = laplacian_.data();
+    ws.ramp_x.resize(m);
+    ws.ramp_y.resize(m);
+    const auto ramps = [&] {
+        for (std::size_t i = 0; i < m; ++i) {
+            const double k = two_pi * frequency(i, m) / double(n);
+            ws.ramp_x[i] = std::polar(1.0f, float(k * dx));
+            ws.ramp_y[i] = std::polar(1.0f, float(k * dy));
+        }
+    };
+    for (const int limit : {int(m) / 4, int(m) / 2}) {
+        ramps();
+        double axx = 0.0, axy = 0.0, ayy = 0.0, bx = 0.0, by = 0.0;
+        for (std::size_t y = 0; y < m; ++y) {
+            const int ky = frequency(y, m);
+            if (std::abs(ky) > limit)
+                continue;
+            for (std::size_t x = 0; x < m; ++x) {
+                const int kx = frequency(x, m);
+                if (std::abs(kx) > limit || (kx == 0 && ky == 0))
+                    continue;
+                const cfloat c = ws.spectrum[y * m + x] * reference[y * m + x] * ws.ramp_x[x] * ws.ramp_y[y];
+                // |c| over the Laplacian's gain weighs by gradient power,
+                // so neither the corona's lowest frequencies nor the
+                // noise the Laplacian lifts at the top of the band win.
+                const double w = std::abs(c) / laplacian[y * m + x];
+                if (w == 0.0)
+                    continue;
+                const double phase = std::arg(c);
+                const double gx = -two_pi * kx / double(n);
+                const double gy = -two_pi * ky / double(n);
+                axx += w * gx * gx;
+                axy += w * gx * gy;
+                ayy += w * gy * gy;
+                bx += w * gx * phase;
+                by += w * gy * phase;
+            }
+        }
+        const double det = axx * ayy - axy * axy;
+        if (!(det > 0.0))
+            break;
+        dx += (ayy * bx - axy * by) / det;
+        dy += (axx * by - axy * bx) / det;
+    }
+
+    if (!(std::abs(dx) <= config_.max_shift && std::abs(dy) <= config_.max_shift) || shift.peak < config_.min_peak) {
+        shift.dx = shift.dy = 0.0f;
+        shift.registered = false;
+        if (slot != nullptr)
+            std::fill_n(slot, m * m, cfloat(0.0f));
+        return;
+    }
+    if (slot != nullptr) {
+        ramps();
+        for (std::size_t y = 0; y < m; ++y)
+            for (std::size_t x = 0; x < m; ++x)
+                slot[y * m + x] = ws.spectrum[y * m + x] * ws.ramp_x[x] * ws.ramp_y[y];
+    }
+    dx -= mean_x;
+    dy -= mean_y;
+    shift.dx = float(dx);
+    shift.dy = float(dy);
+    shift.registered = true;
+
+    // out(x, y) = in(x + dx, y + dy): rows into scratch, columns back.
+    const float fx = float(dx - std::floor(dx));
+    const float fy = float(dy - std::floor(dy));
+    float wx[4], wy[4];
+    cubic_weights(fx, wx);
+    cubic_weights(fy, wy);
+    const std::size_t w = frame.width;
+    const std::size_t h = frame.height;
+    for (std::size_t y = 0; y < h; ++y)
+        resample_line(frame.row(std::uint32_t(y)), 1, &ws.scratch[y * w], 1, long(w), long(std::floor(dx)), wx);
+    for (std::size_t x = 0; x < w; ++x)
+        resample_line(&ws.scratch[x], w, frame.data + x, frame.stride, long(h), long(std::floor(dy)), wy);
+}
+
+void FrameRegistrar::process(std::span<const core::ImageView<float>> frames, std::span<const std::uint32_t> streams,
+                             std::span<FrameShift> shifts, sched::Scheduler& scheduler)
+{
+    if (streams.size() != frames.size() || shifts.size() < frames.size())
+        throw std::invalid_argument("registration: stream and shift spans must match the frames");
+    std::size_t scratch = 0;
+    for (const auto& f : frames) {
+        if (f.width < config_.size || f.height < config_.size)
+            throw std::invalid_argument("registration: frame smaller than the registration region");
+        scratch = std::max(scratch, std::size_t(f.width) * f.height);
+    }
+    if (frames.empty())
+        return;
+
+    const std::size_t m2 = std::size_t(config_.band) * config_.band;
+    const std::size_t chunks = (frames.size() + config_.frames_per_task - 1) / config_.frames_per_task;
+    while (workspaces_.size() < chunks) {
+        auto ws = std::make_unique<Workspace>();
+        ws->region.resize(std::size_t(config_.size) * config_.size);
+        ws->spectrum.resize(m2);
+        ws->surface.resize(m2);
+        workspaces_.push_back(std::move(ws));
+    }
+    for (std::size_t c = 0; c < chunks; ++c)
+        if (workspaces_[c]->scratch.size() < scratch)
+            workspaces_[c]->scratch.resize(scratch);
+
+    std::vector<Stream*> owner(frames.size());
+    std::vector<cfloat*> slot(frames.size(), nullptr);
+    std::vector<std::uint8_t> seeded(frames.size(), 0);
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        auto [it, fresh] = streams_.try_emplace(streams[i]);
+        Stream& s = it->second;
+        if (fresh) {
+            s.sum.assign(m2, 0.0);
+            s.slots.assign(config_.window * m2, cfloat(0.0f));
+            s.offsets.assign(config_.window, FrameShift {});
+        }
+        owner[i] = &s;
+        // An empty stream takes its first frame as the reference, before
+        // anything else in the batch is registered against it.
+        if (s.count == 0) {
+            const std::size_t at = (s.head + s.count) % config_.window;
+            cfloat* dst = &s.slots[at * m2];
+            register_frame(frames[i], nullptr, 0.0f, 0.0f, dst, shifts[i], *workspaces_[0]);
+            for (std::size_t k = 0; k < m2; ++k)
+                s.sum[k] += std::complex<double>(dst[k]);
+            s.offsets[at] = {0.0f, 0.0f, 1.0f, true};
+            ++s.count;
+            seeded[i] = 1;
+        }
+    }
+
+    // Snapshot every stream's reference as the batch starts, conjugated
+    // for the cross-spectrum, and the mean pointing of its window.
+    std::size_t used = 0;
+    for (std::size_t i = 0; i < frames.size(); ++i)
+        if (!seeded[i] && owner[i]->snapshot == 0)
+            owner[i]->snapshot = ++used;
+    reference_.resize(used * m2);
+    for (auto& [id, s] : streams_) {
+        if (s.snapshot == 0)
+            continue;
+        cfloat* dst = &reference_[(s.snapshot - 1) * m2];
+        for (std::size_t k = 0; k < m2; ++k)
+            dst[k] = cfloat(std::conj(s.sum[k]));
+        double mx = 0.0, my = 0.0;
+        std::size_t valid = 0;
+        for (const FrameShift& o : s.offsets)
+            if (o.registered) {
+                mx += o.dx;
+                my += o.dy;
+                ++valid;
+            }
+        s.mean_x = valid ? float(mx / double(valid)) : 0.0f;
+        s.mean_y = valid ? float(my / double(valid)) : 0.0f;
+    }
+
+    // Slots for the frames that end up in the window, evicting the oldest.
+    std::unordered_map<const Stream*, std::size_t> remaining;
+    for (std::size_t i = 0; i < frames.size(); ++i)
+        if (!seeded[i])
+            ++remaining[owner[i]];
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        if (seeded[i])
+            continue;
+        Stream& s = *owner[i];
+        if (remaining[&s]-- > config_.window)
+            continue;
+        if (s.count == config_.window) {
+            const cfloat* old = &s.slots[s.head * m2];
+            for (std::size_t k = 0; k < m2; ++k)
+                s.sum[k] -= std::complex<double>(old[k]);
+            s.offsets[s.head] = FrameShift {};
+            s.head = (s.head + 1) % config_.window;
+            --s.count;
+        }
+        slot[i] = &s.slots[((s.head + s.count) % config_.window) * m2];
+        ++s.count;
+    }
+
+    const std::size_t per_task = config_.frames_per_task;
+    sched::parallel_for(scheduler, 0, chunks, 1, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t c = lo; c < hi; ++c) {
+            Workspace& ws = *workspaces_[c];
+            const std::size_t end = std::min(frames.size(), (c + 1) * per_task);
+            for (std::size_t i = c * per_task; i < end; ++i)
+                if (!seeded[i]) {
+                    const Stream& s = *owner[i];
+                    register_frame(frames[i], &reference_[(s.snapshot - 1) * m2], s.mean_x, s.mean_y, slot[i],
+                                   shifts[i], ws);
+                }
+        }
+    });
+
+    for (std::size_t i = 0; i < frames.size(); ++i) {
+        Stream& s = *owner[i];
+        s.snapshot = 0;
+        if (seeded[i] || slot[i] == nullptr)
+            continue;
+        for (std::size_t k = 0; k < m2; ++k)
+            s.sum[k] += std::complex<double>(slot[i][k]);
+        FrameShift& pointing = s.offsets[std::size_t(slot[i] - s.slots.data()) / m2];
+        pointing = shifts[i];
+        pointing.dx += s.mean_x;
+        pointing.dy += s.mean_y;
+    }
+}
+
+} // namespace solarlens::calib
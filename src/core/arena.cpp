@@ -0,0 +1,187 @@
+#include "solarlens/core/arena.hpp"
+
+#include <cerrno>
+#include <limits>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace solarlens::core {
+
+namespace {
+
+std::size_t page_size()
+{
+    static const std::size_t size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    return size;
+}
+
+std::size_t round_to_pages(std::size_t bytes)
+{
+    const std::size_t page = page_size();
+    return (bytes + page - 1) / page * page;
+}
+
+void* map_anonymous(std::size_t bytes)
+{
+    void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) {
+        if (errno == ENOMEM)
+            throw std::bad_alloc();
+        throw std::system_error(errno, std::generic_category(), "mmap arena slab");
+    }
+    return p;
+}
+
+} // namespace
+
+SlabPool::SlabPool(std::size_t slab_size, std::size_t max_cached)
+    : slab_size_(round_to_pages(slab_size))
+    , max_cached_(max_cached)
+{
+    if (slab_size == 0)
+        throw std::invalid_argument("slab pool: slab size must be positive");
+}
+
+SlabPool::~SlabPool()
+{
+    trim(0);
+}
+
+SlabPool& SlabPool::shared()
+{
+    static SlabPool pool;
+    return pool;
+}
+
+std::byte* SlabPool::acquire()
+{
+    {
+        const std::lock_guard lock(mutex_);
+        ++stats_.acquired;
+        if (!cache_.empty()) {
+            std::byte* slab = cache_.back();
+            cache_.pop_back();
+            ++stats_.reused;
+            return slab;
+        }
+        // Count before mapping so concurrent stats never under-report.
+        ++stats_.mapped;
+    }
+    try {
+        return static_cast<std::byte*>(map_anonymous(slab_size_));
+    } catch (...) {
+        const std::lock_guard lock(mutex_);
+        --stats_.mapped;
+        throw;
+    }
+}
+
+void SlabPool::release(std::byte* slab) noexcept
+{
+    if (!slab)
+        return;
+    {
+        const std::lock_guard lock(mutex_);
+        if (cache_.size() < max_cached_) {
+            cache_.push_back(slab);
+            return;
+        }
+        --stats_.mapped;
+    }
+    ::munmap(slab, slab_size_);
+}
+
+void SlabPool::trim(std::size_t keep) noexcept
+{
+    std::vector<std::byte*> drop;
+    {
+        const std::lock_guard lock(mutex_);
+        while (cache_.size() > keep) {
+            drop.push_back(cache_.back());
+            cache_.pop_back();
+        }
+        stats_.mapped -= drop.size();
+    }
+    for (std::byte* slab : drop)
+        ::munmap(slab, slab_size_);
+}
+
+SlabPoolStats SlabPool::stats() const
+{
+    const std::lock_guard lock(mutex_);
+    SlabPoolStats s = stats_;
+    s.cached = cache_.size();
+    return s;
+}
+
+PassArena::PassArena(SlabPool& pool)
+    : pool_(pool)
+{
+}
+
+PassArena::~PassArena()
+{
+    reset();
+}
+
+void PassArena::reset() noexcept
+{
+    for (std::byte* slab : slabs_)
+        pool_.release(slab);
+    for (auto [p, bytes] : large_)
+        ::munmap(p, bytes);
+    slabs_.clear();
+    large_.clear();
+    cursor_ = end_ = nullptr;
+    allocated_ = 0;
+}
+
+std::size_t PassArena::bytes_reserved() const noexcept
+{
+    std::size_t total = slabs_.size() * pool_.slab_size();
+    for (const auto& l : large_)
+        total += l.second;
+    return total;
+}
+
+void* PassArena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    if (bytes == 0)
+        bytes = 1;
+    const std::size_t slab = pool_.slab_size();
+    auto align_up = [alignment](std::byte* p) {
+        const auto v = reinterpret_cast<std::uintptr_t>(p);
+        return reinterpret_cast<std::byte*>((v + alignment - 1) & ~(std::uintptr_t(alignment) - 1));
+    };
+    if (bytes > slab / 4 || alignment > page_size()) {
+        // mmap only guarantees page alignment; map `alignment` extra bytes
+        // for anything stricter and hand out an aligned pointer inside.
+        const std::size_t slack = alignment > page_size() ? alignment : 0;
+        if (bytes > std::numeric_limits<std::size_t>::max() - slack - page_size())
+            throw std::bad_alloc();
+        const std::size_t mapped = round_to_pages(bytes + slack);
+        large_.reserve(large_.size() + 1);
+        auto* base = static_cast<std::byte*>(map_anonymous(mapped));
+        large_.emplace_back(base, mapped);
+        allocated_ += bytes;
+        return align_up(base);
+    }
+
+    std::byte* p = cursor_ ? align_up(cursor_) : nullptr;
+    if (!p || p + bytes > end_) {
+        slabs_.reserve(slabs_.size() + 1);
+        std::byte* fresh = pool_.acquire();
+        slabs_.push_back(fresh);
+        end_ = fresh + slab;
+        p = align_up(fresh);
+    }
+    cursor_ = p + bytes;
+    allocated_ += bytes;
+    return p;
+}
+
+} // namespace solarlens::core
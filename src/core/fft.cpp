@@ -0,0 +1,129 @@
+#include "solarlens/core/fft.hpp"
+
+#include <bit>
+#include <cmath>
+#include <map>
+#include <mutex>
+#include <numbers>
+#include <stdexcept>
+#include <utility>
+
+namespace solarlens::core {
+
+FftPlan::FftPlan(std::size_t n)
+    : n_(n)
+{
+    if (!is_power_of_two(n) || n > (std::size_t(1) << 31))
+        throw std::invalid_argument("fft: length must be a power of two");
+    // Stage with butterfly span `half` reads twiddles_[half - 1 + k],
+    // k < half, so every stage walks its factors contiguously.
+    twiddles_.resize(n > 1 ? n - 1 : 0);
+    for (std::size_t half = 1; half < n; half *= 2)
+        for (std::size_t k = 0; k < half; ++k) {
+            const double angle = -std::numbers::pi * double(k) / double(half);
+            twiddles_[half - 1 + k] = {float(std::cos(angle)), float(std::sin(angle))};
+        }
+    const int bits = std::countr_zero(n);
+    bitrev_.resize(n);
+    for (std::size_t i = 0; i < n; ++i) {
+        std::uint32_t r = 0;
+        for (int b = 0; b < bits; ++b)
+            r |= ((i >> b) & 1u) << (bits - 1 - b);
+        bitrev_[i] = r;
+    }
+}
+
+std::shared_ptr<const FftPlan> FftPlan::get(std::size_t n)
+{
+    static std::mutex mutex;
+    static std::map<std::size_t, std::shared_ptr<const FftPlan>> cache;
+    const std::lock_guard lock(mutex);
+    auto& slot = cache[n];
+    if (!slot)
+        slot = std::make_shared<const FftPlan>(n);
+    return slot;
+}
+
+void FftPlan::forward(std::span<std::complex<float>> data) const
+{
+    if (data.size() != n_)
+        throw std::invalid_argument("fft: data length does not match plan");
+    transform(data.data(), false);
+}
+
+void FftPlan::inverse(std::span<std::complex<float>> data) const
+{
+    if (data.size() != n_)
+        throw std::invalid_argument("fft: data length does not match plan");
+    transform(data.data(), true);
+}
+
+void FftPlan::forward_batch(std::complex<float>* data, std::size_t count, std::size_t distance) const
+{
+    for (std::size_t i = 0; i < count; ++i)
+        transform(data + i * distance, false);
+}
+
+void FftPlan::inverse_batch(std::complex<float>* data, std::size_t count, std::size_t distance) const
+{
+    for (std::size_t i = 0; i < count; ++i)
+        transform(data + i * distance, true);
+}
+
+void FftPlan::transform(std::complex<float>* data, bool inverse) const
+{
+    for (std::size_t i = 0; i < n_; ++i)
+        if (i < bitrev_[i])
+            std::swap(data[i], data[bitrev_[i]]);
+
+    // The first two stages need no multiplications. The complex products
+    // are written out by hand: std::complex multiplication goes through
+    // the NaN-checking libgcc helper unless -ffast-math is on.
+    float* d = reinterpret_cast<float*>(data);
+    if (n_ >= 2)
+        for (std::size_t i = 0; i < n_; i += 2) {
+            float* a = d + 2 * i;
+            const float br = a[2], bi = a[3];
+            a[2] = a[0] - br;
+            a[3] = a[1] - bi;
+            a[0] += br;
+            a[1] += bi;
+        }
+    // Span-2 butterflies: the odd twiddle is -i (forward) or +i (inverse).
+    const float rot = inverse ? -1.0f : 1.0f;
+    if (n_ >= 4)
+        for (std::size_t i = 0; i < n_; i += 4) {
+            float* a = d + 2 * i;
+            for (int k = 0; k < 2; ++k) {
+                float* x = a + 2 * k;
+                float* y = a + 2 * (k + 2);
+                const float yr = k == 0 ? y[0] : rot * y[1];
+                const float yi = k == 0 ? y[1] : -rot * y[0];
+                y[0] = x[0] - yr;
+                y[1] = x[1] - yi;
+                x[0] += yr;
+                x[1] += yi;
+            }
+        }
+
+    const float sign = inverse ? -1.0f : 1.0f;
+    for (std::size_t half = 4; half < n_; half *= 2) {
+        const std::complex<float>* w = twiddles_.data() + half - 1;
+        for (std::size_t start = 0; start < n_; start += 2 * half) {
+            float* __restrict a = d + 2 * start;
+            float* __restrict b = d + 2 * (start + half);
+            for (std::size_t k = 0; k < half; ++k) {
+                const float wr = w[k].real();
+                const float wi = sign * w[k].imag();
+                const float br = b[2 * k] * wr - b[2 * k + 1] * wi;
+                const float bi = b[2 * k] * wi + b[2 * k + 1] * wr;
+                b[2 * k] = a[2 * k] - br;
+                b[2 * k + 1] = a[2 * k + 1] - bi;
+                a[2 * k] += br;
+                a[2 * k + 1] += bi;
+            }
+        }
+    }
+}
+
+} // namespace solarlens::core
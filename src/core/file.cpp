@@ -0,0 +1,154 @@
+#include "solarlens/core/file.hpp"
+
+#include <cerrno>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace solarlens::core {
+
+namespace {
+
+int open_flags(File::Mode mode)
+{
+    switch (mode) {
+    case File::Mode::read:
+        return O_RDONLY;
+    case File::Mode::write:
+        return O_WRONLY | O_CREAT | O_TRUNC;
+    case File::Mode::read_write:
+        return O_RDWR | O_CREAT;
+    case File::Mode::scratch:
+        return O_RDWR | O_CREAT | O_TRUNC;
+    }
+    return O_RDONLY;
+}
+
+} // namespace
+
+File::File(const std::filesystem::path& path, Mode mode)
+    : path_(path)
+{
+    fd_ = ::open(path.c_str(), open_flags(mode) | O_CLOEXEC, 0644);
+    if (fd_ < 0)
+        fail("open");
+}
+
+File::~File()
+{
+    if (fd_ >= 0)
+        ::close(fd_);
+}
+
+File::File(File&& other) noexcept
+    : fd_(std::exchange(other.fd_, -1))
+    , path_(std::move(other.path_))
+{
+}
+
+File& File::operator=(File&& other) noexcept
+{
+    if (this != &other) {
+        if (fd_ >= 0)
+            ::close(fd_);
+        fd_ = std::exchange(other.fd_, -1);
+        path_ = std::move(other.path_);
+    }
+    return *this;
+}
+
+std::size_t File::pread(std::span<std::byte> out, std::uint64_t offset) const
+{
+    std::size_t done = 0;
+    while (done < out.size()) {
+        const ssize_t n = ::pread(fd_, out.data() + done, out.size() - done,
+                                  static_cast<off_t>(offset + done));
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            fail("pread");
+        }
+        if (n == 0)
+            break;
+        done += static_cast<std::size_t>(n);
+    }
+    return done;
+}
+
+void File::pread_exact(std::span<std::byte> out, std::uint64_t offset) const
+{
+    if (pread(out, offset) != out.size())
+        throw std::system_error(std::make_error_code(std::errc::io_error),
+                                "short read from " + path_.string());
+}
+
+void File::pwrite(std::span<const std::byte> data, std::uint64_t offset)
+{
+    std::size_t done = 0;
+    while (done < data.size()) {
+        const ssize_t n = ::pwrite(fd_, data.data() + done, data.size() - done,
+                                   static_cast<off_t>(offset + done));
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            fail("pwrite");
+        }
+        done += static_cast<std::size_t>(n);
+    }
+}
+
+void File::write(std::span<const std::byte> data)
+{
+    std::size_t done = 0;
+    while (done < data.size()) {
+        const ssize_t n = ::write(fd_, data.data() + done, data.size() - done);
+        if (n < 0) {
+            if (errno == EINTR)
+                continue;
+            fail("write");
+        }
+        done += static_cast<std::size_t>(n);
+    }
+}
+
+void File::truncate(std::uint64_t size)
+{
+    if (::ftruncate(fd_, static_cast<off_t>(size)) != 0)
+        fail("ftruncate");
+}
+
+std::uint64_t File::size() const
+{
+    struct stat st {};
+    if (::fstat(fd_, &st) != 0)
+        fail("fstat");
+    return static_cast<std::uint64_t>(st.st_size);
+}
+
+void File::sync()
+{
+    if (::fdatasync(fd_) != 0)
+        fail("fdatasync");
+}
+
+void File::close()
+{
+    if (fd_ >= 0) {
+        const int fd = std::exchange(fd_, -1);
+        if (::close(fd) != 0)
+            throw std::system_error(errno, std::generic_category(),
+                                    "close " + path_.string());
+    }
+}
+
+void File::fail(const char* what) const
+{
+    throw std::system_error(errno, std::generic_category(),
+                            std::string(what) + " " + path_.string());
+}
+
+} // namespace solarlens::core
@@ -0,0 +1,69 @@
+#include "solarlens/core/mapped_file.hpp"
+
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include "solarlens/core/file.hpp"
+
+namespace solarlens::core {
+
+MappedFile::MappedFile(const std::filesystem::path& path)
+    : path_(path)
+{
+    const File file(path, File::Mode::read);
+    size_ = static_cast<std::size_t>(file.size());
+    if (size_ == 0)
+        return;
+    void* p = ::mmap(nullptr, size_, PROT_READ, MAP_SHARED, file.fd(), 0);
+    if (p == MAP_FAILED)
+        throw std::system_error(errno, std::generic_category(), "mmap " + path.string());
+    data_ = static_cast<const std::byte*>(p);
+}
+
+MappedFile::~MappedFile()
+{
+    unmap();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr))
+    , size_(std::exchange(other.size_, 0))
+    , path_(std::move(other.path_))
+{
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other) {
+        unmap();
+        data_ = std::exchange(other.data_, nullptr);
+        size_ = std::exchange(other.size_, 0);
+        path_ = std::move(other.path_);
+    }
+    return *this;
+}
+
+void MappedFile::prefetch(std::size_t offset, std::size_t length) const noexcept
+{
+    if (data_ == nullptr || offset >= size_)
+        return;
+    static const auto page = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+    const std::size_t start = offset / page * page;
+    const std::size_t end = std::min(size_, offset + length);
+    ::madvise(const_cast<std::byte*>(data_) + start, end - start, MADV_WILLNEED);
+}
+
+void MappedFile::unmap() noexcept
+{
+    if (data_ != nullptr)
+        ::munmap(const_cast<std::byte*>(data_), size_);
+    data_ = nullptr;
+    size_ = 0;
+}
+
+} // namespace solarlens::core
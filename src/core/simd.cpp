@@ -0,0 +1,84 @@
+#include "solarlens/core/simd.hpp"
+
+#include <cstdlib>
+
+namespace solarlens::core {
+
+namespace {
+
+bool cpu_has(SimdLevel level) noexcept
+{
+    switch (level) {
+    case SimdLevel::scalar:
+        return true;
+#if defined(SOLARLENS_HAVE_NEON)
+    case SimdLevel::neon:
+        return true; // Mandatory on AArch64.
+#endif
+#if defined(SOLARLENS_HAVE_AVX2)
+    case SimdLevel::avx2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+#if defined(SOLARLENS_HAVE_AVX512)
+    case SimdLevel::avx512:
+        return __builtin_cpu_supports("avx512f");
+#endif
+    default:
+        return false;
+    }
+}
+
+} // namespace
+
+bool simd_level_supported(SimdLevel level) noexcept
+{
+    return cpu_has(level);
+}
+
+SimdLevel detected_simd_level() noexcept
+{
+    static const SimdLevel level = [] {
+        for (SimdLevel l : {SimdLevel::avx512, SimdLevel::avx2, SimdLevel::neon})
+            if (cpu_has(l))
+                return l;
+        return SimdLevel::scalar;
+    }();
+    return level;
+}
+
+SimdLevel best_simd_level() noexcept
+{
+    const SimdLevel detected = detected_simd_level();
+    const char* env = std::getenv("SOLARLENS_SIMD");
+    if (env == nullptr)
+        return detected;
+    const auto requested = parse_simd_level(env);
+    if (!requested || !cpu_has(*requested))
+        return detected;
+    return *requested < detected ? *requested : detected;
+}
+
+const char* to_string(SimdLevel level) noexcept
+{
+    switch (level) {
+    case SimdLevel::scalar:
+        return "scalar";
+    case SimdLevel::neon:
+        return "neon";
+    case SimdLevel::avx2:
+        return "avx2";
+    case SimdLevel::avx512:
+        return "avx512";
+    }
+    return "unknown";
+}
+
+std::optional<SimdLevel> parse_simd_level(std::string_view name) noexcept
+{
+    for (SimdLevel l : {SimdLevel::scalar, SimdLevel::neon, SimdLevel::avx2, SimdLevel::avx512})
+        if (name == to_string(l))
+            return l;
+    return std::nullopt;
+}
+
+} // namespace solarlens::core
@@ -0,0 +1,194 @@
+#include "solarlens/core/snapshot.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <utility>
+
+#include <unistd.h>
+
+#include "solarlens/core/file.hpp"
+
+namespace solarlens::core {
+
+namespace {
+
+constexpr std::array<char, 8> magic = {'S', 'L', 'S', 'N', 'A', 'P', '\0', '\0'};
+constexpr std::size_t header_size = 32;
+constexpr std::size_t name_size = snapshot_name_max + 1;
+constexpr std::size_t entry_size = name_size + 8 + 8 + 32;
+constexpr std::uint64_t section_alignment = 4096;
+
+std::atomic<std::uint64_t> temp_counter {0};
+
+std::uint64_t align_up(std::uint64_t n) noexcept
+{
+    return (n + section_alignment - 1) / section_alignment * section_alignment;
+}
+
+template <typename T>
+void put(std::byte*& p, const T& v) noexcept
+{
+    std::memcpy(p, &v, sizeof v);
+    p += sizeof v;
+}
+
+template <typename T>
+T get(const std::byte*& p) noexcept
+{
+    T v;
+    std::memcpy(&v, p, sizeof v);
+    p += sizeof v;
+    return v;
+}
+
+} // namespace
+
+void SectionBuilder::put_string(std::string_view text)
+{
+    put(static_cast<std::uint32_t>(text.size()));
+    const auto raw = std::as_bytes(std::span(text.data(), text.size()));
+    bytes_.insert(bytes_.end(), raw.begin(), raw.end());
+}
+
+std::string SectionReader::get_string()
+{
+    const auto length = get<std::uint32_t>();
+    const std::span<const std::byte> raw = take(length);
+    return {reinterpret_cast<const char*>(raw.data()), raw.size()};
+}
+
+std::span<const std::byte> SectionReader::take(std::size_t n)
+{
+    if (n > bytes_.size() - at_)
+        truncated();
+    const std::span<const std::byte> out = bytes_.subspan(at_, n);
+    at_ += n;
+    return out;
+}
+
+void SectionReader::truncated() const
+{
+    throw std::runtime_error("snapshot: section " + std::string(section_) + " is truncated");
+}
+
+void SnapshotWriter::add(std::string_view name, std::span<const std::byte> bytes)
+{
+    if (name.empty() || name.size() > snapshot_name_max || name.find('\0') != std::string_view::npos)
+        throw std::invalid_argument("snapshot: section names must be 1 to 47 characters");
+    if (std::any_of(sections_.begin(), sections_.end(), [&](const Section& s) { return s.name == name; }))
+        throw std::invalid_argument("snapshot: duplicate section " + std::string(name));
+    sections_.push_back({std::string(name), {bytes.begin(), bytes.end()}});
+}
+
+void SnapshotWriter::write(const std::filesystem::path& path) const
+{
+    std::vector<std::byte> head(header_size + entry_size * sections_.size());
+    std::vector<std::uint64_t> offsets;
+    std::uint64_t end = align_up(head.size());
+    for (const Section& s : sections_) {
+        offsets.push_back(end);
+        end = align_up(end + s.bytes.size());
+    }
+
+    std::byte* p = head.data();
+    std::memcpy(p, magic.data(), magic.size());
+    p += magic.size();
+    put(p, snapshot_version);
+    put(p, static_cast<std::uint32_t>(sections_.size()));
+    put(p, end);
+    put(p, std::uint64_t {0});
+    for (std::size_t i = 0; i < sections_.size(); ++i) {
+        const Section& s = sections_[i];
+        std::memcpy(p, s.name.data(), s.name.size());
+        p += name_size;
+        put(p, offsets[i]);
+        put(p, static_cast<std::uint64_t>(s.bytes.size()));
+        const Digest d = sha256(s.bytes);
+        std::memcpy(p, d.bytes.data(), d.bytes.size());
+        p += d.bytes.size();
+    }
+
+    std::filesystem::path temp = path;
+    temp += ".tmp." + std::to_string(::getpid()) + "." + std::to_string(temp_counter.fetch_add(1));
+    {
+        File file(temp, File::Mode::write);
+        file.pwrite(head, 0);
+        for (std::size_t i = 0; i < sections_.size(); ++i)
+            file.pwrite(sections_[i].bytes, offsets[i]);
+        file.truncate(end);
+        file.sync();
+        file.close();
+    }
+    std::filesystem::rename(temp, path);
+}
+
+Snapshot::Snapshot(MappedFile file)
+    : file_(std::move(file))
+{
+}
+
+Snapshot Snapshot::open(const std::filesystem::path& path, bool verify)
+{
+    Snapshot snapshot {MappedFile(path)};
+    const std::span<const std::byte> bytes = snapshot.file_.bytes();
+    const auto bad = [&](const std::string& why) {
+        return std::runtime_error("snapshot: " + why + " in " + path.string());
+    };
+    if (bytes.size() < header_size || std::memcmp(bytes.data(), magic.data(), magic.size()) != 0)
+        throw bad("bad magic");
+
+    const std::byte* p = bytes.data() + magic.size();
+    if (get<std::uint32_t>(p) != snapshot_version)
+        throw bad("unsupported version");
+    const auto count = get<std::uint32_t>(p);
+    if (get<std::uint64_t>(p) != bytes.size())
+        throw bad("truncated image");
+    p += sizeof(std::uint64_t);
+    if ((bytes.size() - header_size) / entry_size < count)
+        throw bad("truncated section table");
+
+    snapshot.entries_.reserve(count);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        const char* name = reinterpret_cast<const char*>(p);
+        p += name_size;
+        const auto offset = get<std::uint64_t>(p);
+        const auto size = get<std::uint64_t>(p);
+        Digest digest;
+        std::memcpy(digest.bytes.data(), p, digest.bytes.size());
+        p += digest.bytes.size();
+        if (name[snapshot_name_max] != '\0' || offset % section_alignment != 0 || offset > bytes.size()
+            || size > bytes.size() - offset)
+            throw bad("corrupt section table");
+        const Entry entry {std::string_view(name), bytes.subspan(offset, size)};
+        if (verify && sha256(entry.bytes) != digest)
+            throw bad("digest mismatch in section " + std::string(entry.name));
+        snapshot.entries_.push_back(entry);
+    }
+    return snapshot;
+}
+
+bool Snapshot::contains(std::string_view name) const noexcept
+{
+    return std::any_of(entries_.begin(), entries_.end(), [&](const Entry& e) { return e.name == name; });
+}
+
+std::span<const std::byte> Snapshot::section(std::string_view name) const
+{
+    for (const Entry& e : entries_)
+        if (e.name == name)
+            return e.bytes;
+    throw std::runtime_error("snapshot: no section " + std::string(name) + " in " + path().string());
+}
+
+std::vector<std::string_view> Snapshot::names() const
+{
+    std::vector<std::string_view> out;
+    out.reserve(entries_.size());
+    for (const Entry& e : entries_)
+        out.push_back(e.name);
+    return out;
+}
+
+} // namespace solarlens::core
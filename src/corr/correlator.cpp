@@ -0,0 +1,114 @@
+#include "solarlens/corr/correlator.hpp"
+
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+#include <string>
+
+#include "correlator_backends.hpp"
+#include "solarlens/core/fft.hpp"
+#include "solarlens/perf/instrument.hpp"
+
+namespace solarlens::corr {
+
+Visibilities::Visibilities(std::size_t stations, std::size_t channels)
+{
+    resize(stations, channels);
+}
+
+void Visibilities::resize(std::size_t stations, std::size_t channels)
+{
+    stations_ = stations;
+    channels_ = channels;
+    data_.assign(stations * stations * channels, {});
+}
+
+Correlator::Correlator(const CorrelatorConfig& config)
+    : config_(config)
+{
+    if (config_.stations < 1 || config_.spectra < 1)
+        throw std::invalid_argument("correlator: need at least one station and one spectrum");
+    if (!core::is_power_of_two(config_.channels))
+        throw std::invalid_argument("correlator: channel count must be a power of two");
+}
+
+void Correlator::correlate(const CorrelatorInput& input, Visibilities& out)
+{
+    if (input.samples.size() != config_.stations * config_.samples_per_station())
+        throw std::invalid_argument("correlator: sample count does not match configuration");
+    if (!input.delays.empty() && input.delays.size() != config_.stations)
+        throw std::invalid_argument("correlator: need one delay per station");
+    if (out.stations() != config_.stations || out.channels() != config_.channels)
+        out.resize(config_.stations, config_.channels);
+    static const perf::Stage stage("corr.integration");
+    const perf::ScopedTimer timer(stage);
+    run(input, out);
+}
+
+std::string_view to_string(CorrelatorBackend backend) noexcept
+{
+    switch (backend) {
+    case CorrelatorBackend::reference:
+        return "reference";
+    case CorrelatorBackend::cpu:
+        return "cpu";
+    case CorrelatorBackend::cuda:
+        return "cuda";
+    }
+    return "unknown";
+}
+
+bool correlator_backend_available(CorrelatorBackend backend) noexcept
+{
+    switch (backend) {
+    case CorrelatorBackend::reference:
+    case CorrelatorBackend::cpu:
+        return true;
+    case CorrelatorBackend::cuda:
+#ifdef SOLARLENS_HAVE_CUDA
+        return true;
+#else
+        return false;
+#endif
+    }
+    return false;
+}
+
+CorrelatorBackend default_correlator_backend() noexcept
+{
+    return correlator_backend_available(CorrelatorBackend::cuda) ? CorrelatorBackend::cuda
+                                                                 : CorrelatorBackend::cpu;
+}
+
+std::unique_ptr<Correlator> make_correlator(const CorrelatorConfig& config,
+                                            CorrelatorBackend backend,
+                                            sched::Scheduler* scheduler)
+{
+    switch (backend) {
+    case CorrelatorBackend::reference:
+        return detail::make_reference_correlator(config);
+    case CorrelatorBackend::cpu:
+        return detail::make_cpu_correlator(config, scheduler);
+    case CorrelatorBackend::cuda:
+#ifdef SOLARLENS_HAVE_CUDA
+        return detail::make_cuda_correlator(config);
+#else
+        break;
+#endif
+    }
+    throw std::invalid_argument("correlator: backend '" + std::string(to_string(backend)) +
+                                "' is not in this build");
+}
+
+namespace detail {
+
+std::complex<double> delay_phase(double delay, std::size_t k, std::size_t n) noexcept
+{
+    const double bin = k < n / 2 ? double(k) : double(k) - double(n);
+    const double angle = 2.0 * std::numbers::pi * bin / double(n) * delay;
+    return {std::cos(angle), std::sin(angle)};
+}
+
+} // namespace detail
+
+} // namespace solarlens::corr
@@ -0,0 +1,23 @@
+#pragma once
+
+// Backend constructors behind make_correlator(). The CUDA one is only
+// defined when the library is built with SOLARLENS_WITH_CUDA.
+
+#include <complex>
+#include <memory>
+#include <span>
+
+#include "solarlens/corr/correlator.hpp"
+
+namespace solarlens::corr::detail {
+
+std::unique_ptr<Correlator> make_reference_correlator(const CorrelatorConfig& config);
+std::unique_ptr<Correlator> make_cpu_correlator(const CorrelatorConfig& config,
+                                                sched::Scheduler* scheduler);
+std::unique_ptr<Correlator> make_cuda_correlator(const CorrelatorConfig& config);
+
+/// Phase rotation for a residual delay of `delay` samples in FFT bin `k`
+/// of an `n`-point transform.
+std::complex<double> delay_phase(double delay, std::size_t k, std::size_t n) noexcept;
+
+} // namespace solarlens::corr::detail
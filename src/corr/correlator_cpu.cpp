@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <complex>
+#include <vector>
+
+#include "correlator_backends.hpp"
+#include "solarlens/core/fft.hpp"
+#include "solarlens/sched/scheduler.hpp"
+
+namespace solarlens::corr::detail {
+
+namespace {
+
+/// Copies every station's samples and channelises them in place;
+/// `spectra` ends up [station][spectrum][channel].
+void channelize(const CorrelatorConfig& cfg, const core::FftPlan& plan, const CorrelatorInput& input,
+                std::size_t station, std::complex<float>* spectra)
+{
+    const std::size_t n = cfg.samples_per_station();
+    std::copy_n(input.samples.data() + station * n, n, spectra);
+    plan.forward_batch(spectra, cfg.spectra, cfg.channels);
+    if (input.delays.empty() || input.delays[station] == 0.0)
+        return;
+    std::vector<std::complex<float>> phase(cfg.channels);
+    for (std::size_t k = 0; k < cfg.channels; ++k)
+        phase[k] = std::complex<float>(delay_phase(input.delays[station], k, cfg.channels));
+    for (std::size_t t = 0; t < cfg.spectra; ++t) {
+        std::complex<float>* row = spectra + t * cfg.channels;
+        for (std::size_t k = 0; k < cfg.channels; ++k) {
+            const float xr = row[k].real(), xi = row[k].imag();
+            const float pr = phase[k].real(), pi = phase[k].imag();
+            row[k] = {xr * pr - xi * pi, xr * pi + xi * pr};
+        }
+    }
+}
+
+class ReferenceCorrelator final : public Correlator {
+public:
+    explicit ReferenceCorrelator(const CorrelatorConfig& config)
+        : Correlator(config)
+        , plan_(core::FftPlan::get(config.channels))
+    {
+    }
+
+    std::string_view name() const noexcept override { return "reference"; }
+
+private:
+    void run(const CorrelatorInput& input, Visibilities& out) override
+    {
+        const CorrelatorConfig& cfg = config_;
+        const std::size_t per_station = cfg.samples_per_station();
+        spectra_.resize(cfg.stations * per_station);
+        for (std::size_t s = 0; s < cfg.stations; ++s)
+            channelize(cfg, *plan_, input, s, spectra_.data() + s * per_station);
+
+        for (std::size_t c = 0; c < cfg.channels; ++c)
+            for (std::size_t i = 0; i < cfg.stations; ++i)
+                for (std::size_t j = 0; j < cfg.stations; ++j) {
+                    std::complex<double> acc = 0.0;
+                    for (std::size_t t = 0; t < cfg.spectra; ++t) {
+                        const std::size_t at = t * cfg.channels + c;
+                        const std::complex<double> a = spectra_[i * per_station + at];
+                        const std::complex<double> b = spectra_[j * per_station + at];
+                        acc += a * std::conj(b);
+                    }
+                    out.at(i, j, c) = std::complex<float>(acc / double(cfg.spectra));
+                }
+    }
+
+    std::shared_ptr<const core::FftPlan> plan_;
+    std::vector<std::complex<float>> spectra_;
+};
+
+/// Channels gathered per X task: eight complex floats fill a cache line,
+/// so every strided read of the F output is used in full.
+constexpr std::size_t channel_block = 8;
+
+class CpuCorrelator final : public Correlator {
+public:
+    CpuCorrelator(const CorrelatorConfig& config, sched::Scheduler* scheduler)
+        : Correlator(config)
+        , plan_(core::FftPlan::get(config.channels))
+        , scheduler_(scheduler)
+        , padded_((config.stations + 15) / 16 * 16)
+    {
+    }
+
+    std::string_view name() const noexcept override { return "cpu"; }
+
+private:
+    template <typename Fn>
+    void for_range(std::size_t n, Fn&& fn)
+    {
+        if (scheduler_)
+            sched::parallel_for(*scheduler_, 0, n, 1, fn);
+        else
+            fn(std::size_t(0), n);
+    }
+
+    void run(const CorrelatorInput& input, Visibilities& out) override
+    {
+        const CorrelatorConfig& cfg = config_;
+        const std::size_t per_station = cfg.samples_per_station();
+        spectra_.resize(cfg.stations * per_station);
+
+        for_range(cfg.stations, [&](std::size_t lo, std::size_t hi) {
+            for (std::size_t s = lo; s < hi; ++s)
+                channelize(cfg, *plan_, input, s, spectra_.data() + s * per_station);
+        });
+
+        const std::size_t blocks = (cfg.channels + channel_block - 1) / channel_block;
+        for_range(blocks, [&](std::size_t lo, std::size_t hi) {
+            std::vector<float> re(channel_block * cfg.spectra * padded_);
+            std::vector<float> im(re.size());
+            std::vector<float> acc_re(cfg.stations * padded_);
+            std::vector<float> acc_im(acc_re.size());
+            for (std::size_t b = lo; b < hi; ++b)
+                correlate_block(b, re, im, acc_re, acc_im, out);
+        });
+    }
+
+    void correlate_block(std::size_t block, std::vector<float>& re, std::vector<float>& im,
+                         std::vector<float>& acc_re, std::vector<float>& acc_im, Visibilities& out)
+    {
+        const CorrelatorConfig& cfg = config_;
+        const std::size_t n = cfg.stations;
+        const std::size_t c0 = block * channel_block;
+        const std::size_t width = std::min(channel_block, cfg.channels - c0);
+        const std::size_t per_station = cfg.samples_per_station();
+        const std::size_t plane = cfg.spectra * padded_;
+
+        // Gather to [channel][spectrum][station] with stations split into
+        // real and imaginary planes so the pair loop runs over contiguous
+        // floats.
+        for (std::size_t s = 0; s < n; ++s)
+            for (std::size_t t = 0; t < cfg.spectra; ++t) {
+                const std::complex<float>* src = spectra_.data() + s * per_station + t * cfg.channels + c0;
+                for (std::size_t k = 0; k < width; ++k) {
+                    re[k * plane + t * padded_ + s] = src[k].real();
+                    im[k * plane + t * padded_ + s] = src[k].imag();
+                }
+            }
+
+        const float scale = 1.0f / float(cfg.spectra);
+        for (std::size_t k = 0; k < width; ++k) {
+            std::fill(acc_re.begin(), acc_re.end(), 0.0f);
+            std::fill(acc_im.begin(), acc_im.end(), 0.0f);
+            for (std::size_t t = 0; t < cfg.spectra; ++t) {
+                const float* xr = re.data() + k * plane + t * padded_;
+                const float* xi = im.data() + k * plane + t * padded_;
+                for (std::size_t i = 0; i < n; ++i) {
+                    const float ar = xr[i];
+                    const float ai = xi[i];
+                    float* __restrict pr = acc_re.data() + i * padded_;
+                    float* __restrict pi = acc_im.data() + i * padded_;
+                    // a * conj(b) = (ar br + ai bi) + i (ai br - ar bi)
+                    for (std::size_t j = i; j < n; ++j) {
+                        pr[j] += ar * xr[j] + ai * xi[j];
+                        pi[j] += ai * xr[j] - ar * xi[j];
+                    }
+                }
+            }
+            const std::size_t c = c0 + k;
+            for (std::size_t i = 0; i < n; ++i) {
+                out.at(i, i, c) = {acc_re[i * padded_ + i] * scale, 0.0f};
+                for (std::size_t j = i + 1; j < n; ++j) {
+                    const std::complex<float> v(acc_re[i * padded_ + j] * scale,
+                                                acc_im[i * padded_ + j] * scale);
+                    out.at(i, j, c) = v;
+                    out.at(j, i, c) = std::conj(v);
+                }
+            }
+        }
+    }
+
+    std::shared_ptr<const core::FftPlan> plan_;
+    sched::Scheduler* scheduler_;
+    std::size_t padded_;
+    std::vector<std::complex<float>> spectra_;
+};
+
+} // namespace
+
+std::unique_ptr<Correlator> make_reference_correlator(const CorrelatorConfig& config)
+{
+    return std::make_unique<ReferenceCorrelator>(config);
+}
+
+std::unique_ptr<Correlator> make_cpu_correlator(const CorrelatorConfig& config,
+                                                sched::Scheduler* scheduler)
+{
+    return std::make_unique<CpuCorrelator>(config, scheduler);
+}
+
+} // namespace solarlens::corr::detail
@@ -0,0 +1,177 @@
+// CUDA correlator backend, built only with SOLARLENS_WITH_CUDA.
+//
+// F stage: one batched cuFFT C2C plan over every station's spectra.
+// A small kernel applies the residual delays while transposing to
+// [channel][station][spectrum]; with spectra contiguous each channel is a
+// column-major spectra x stations matrix B_c, and the X stage is one
+// strided-batched GEMM, C_c = B_c^H B_c, over all channels. Reading C_c in
+// column-major order gives conj(V_c) = V_c^T, so the result copies back
+// into the row-major Visibilities layout unchanged. The GEMM is allowed
+// TF32 tensor-core math.
+
+#include <cuComplex.h>
+#include <cublas_v2.h>
+#include <cuda_runtime.h>
+#include <cufft.h>
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "correlator_backends.hpp"
+
+namespace solarlens::corr::detail {
+
+namespace {
+
+void check(cudaError_t status, const char* what)
+{
+    if (status != cudaSuccess)
+        throw std::runtime_error(std::string("cuda correlator: ") + what + ": " +
+                                 cudaGetErrorString(status));
+}
+
+void check(cufftResult status, const char* what)
+{
+    if (status != CUFFT_SUCCESS)
+        throw std::runtime_error(std::string("cuda correlator: ") + what + " failed (cufft " +
+                                 std::to_string(int(status)) + ")");
+}
+
+void check(cublasStatus_t status, const char* what)
+{
+    if (status != CUBLAS_STATUS_SUCCESS)
+        throw std::runtime_error(std::string("cuda correlator: ") + what + " failed (cublas " +
+                                 std::to_string(int(status)) + ")");
+}
+
+template <typename T>
+struct DeviceBuffer {
+    T* ptr = nullptr;
+    std::size_t count = 0;
+
+    explicit DeviceBuffer(std::size_t n)
+        : count(n)
+    {
+        check(cudaMalloc(&ptr, n * sizeof(T)), "cudaMalloc");
+    }
+    ~DeviceBuffer() { cudaFree(ptr); }
+    DeviceBuffer(const DeviceBuffer&) = delete;
+    DeviceBuffer& operator=(const DeviceBuffer&) = delete;
+};
+
+/// in: [station][spectrum][channel]; out: [channel][station][spectrum].
+__global__ void delay_transpose(const cuFloatComplex* in, cuFloatComplex* out,
+                                const double* delays, int stations, int spectra, int channels)
+{
+    const long long total = (long long)stations * spectra * channels;
+    for (long long idx = blockIdx.x * (long long)blockDim.x + threadIdx.x; idx < total;
+         idx += (long long)gridDim.x * blockDim.x) {
+        const int c = int(idx % channels);
+        const int t = int((idx / channels) % spectra);
+        const int s = int(idx / ((long long)channels * spectra));
+        cuFloatComplex v = in[idx];
+        if (delays) {
+            const double bin = c < channels / 2 ? double(c) : double(c) - double(channels);
+            float sn, cs;
+            sincosf(float(6.283185307179586 * bin / channels * delays[s]), &sn, &cs);
+            v = cuCmulf(v, make_cuFloatComplex(cs, sn));
+        }
+        out[((long long)c * stations + s) * spectra + t] = v;
+    }
+}
+
+class CudaCorrelator final : public Correlator {
+public:
+    explicit CudaCorrelator(const CorrelatorConfig& config)
+        : Correlator(config)
+        , samples_(config.stations * config.samples_per_station())
+        , channel_major_(samples_.count)
+        , vis_(config.channels * config.stations * config.stations)
+        , delays_(config.stations)
+    {
+        int devices = 0;
+        check(cudaGetDeviceCount(&devices), "cudaGetDeviceCount");
+        if (devices == 0)
+            throw std::runtime_error("cuda correlator: no CUDA device");
+        check(cudaStreamCreate(&stream_), "cudaStreamCreate");
+        int n = int(config.channels);
+        check(cufftPlanMany(&fft_, 1, &n, nullptr, 1, n, nullptr, 1, n, CUFFT_C2C,
+                            int(config.stations * config.spectra)),
+              "cufftPlanMany");
+        check(cufftSetStream(fft_, stream_), "cufftSetStream");
+        check(cublasCreate(&blas_), "cublasCreate");
+        check(cublasSetStream(blas_, stream_), "cublasSetStream");
+        check(cublasSetMathMode(blas_, CUBLAS_TF32_TENSOR_OP_MATH), "cublasSetMathMode");
+    }
+
+    ~CudaCorrelator() override
+    {
+        cublasDestroy(blas_);
+        cufftDestroy(fft_);
+        cudaStreamDestroy(stream_);
+    }
+
+    std::string_view name() const noexcept override { return "cuda"; }
+
+private:
+    void run(const CorrelatorInput& input, Visibilities& out) override
+    {
+        const CorrelatorConfig& cfg = config_;
+        const int stations = int(cfg.stations);
+        const int spectra = int(cfg.spectra);
+        const int channels = int(cfg.channels);
+
+        check(cudaMemcpyAsync(samples_.ptr, input.samples.data(),
+                              samples_.count * sizeof(cuFloatComplex), cudaMemcpyHostToDevice,
+                              stream_),
+              "upload samples");
+        const double* delays = nullptr;
+        if (!input.delays.empty()) {
+            check(cudaMemcpyAsync(delays_.ptr, input.delays.data(), delays_.count * sizeof(double),
+                                  cudaMemcpyHostToDevice, stream_),
+                  "upload delays");
+            delays = delays_.ptr;
+        }
+        check(cufftExecC2C(fft_, samples_.ptr, samples_.ptr, CUFFT_FORWARD), "cufftExecC2C");
+
+        const int threads = 256;
+        const int blocks = int(std::min<std::size_t>((samples_.count + threads - 1) / threads, 65535));
+        delay_transpose<<<blocks, threads, 0, stream_>>>(samples_.ptr, channel_major_.ptr, delays,
+                                                         stations, spectra, channels);
+        check(cudaGetLastError(), "delay_transpose launch");
+
+        const cuComplex alpha = make_cuFloatComplex(1.0f / float(spectra), 0.0f);
+        const cuComplex beta = make_cuFloatComplex(0.0f, 0.0f);
+        check(cublasGemmStridedBatchedEx(
+                  blas_, CUBLAS_OP_C, CUBLAS_OP_N, stations, stations, spectra, &alpha,
+                  channel_major_.ptr, CUDA_C_32F, spectra, (long long)stations * spectra,
+                  channel_major_.ptr, CUDA_C_32F, spectra, (long long)stations * spectra, &beta,
+                  vis_.ptr, CUDA_C_32F, stations, (long long)stations * stations, channels,
+                  CUBLAS_COMPUTE_32F_FAST_TF32, CUBLAS_GEMM_DEFAULT_TENSOR_OP),
+              "cublasGemmStridedBatchedEx");
+
+        check(cudaMemcpyAsync(out.data().data(), vis_.ptr, vis_.count * sizeof(cuFloatComplex),
+                              cudaMemcpyDeviceToHost, stream_),
+              "download visibilities");
+        check(cudaStreamSynchronize(stream_), "cudaStreamSynchronize");
+    }
+
+    DeviceBuffer<cuFloatComplex> samples_;
+    DeviceBuffer<cuFloatComplex> channel_major_;
+    DeviceBuffer<cuFloatComplex> vis_;
+    DeviceBuffer<double> delays_;
+    cudaStream_t stream_ = nullptr;
+    cufftHandle fft_ = 0;
+    cublasHandle_t blas_ = nullptr;
+};
+
+} // namespace
+
+std::unique_ptr<Correlator> make_cuda_correlator(const CorrelatorConfig& config)
+{
+    return std::make_unique<CudaCorrelator>(config);
+}
+
+} // namespace solarlens::corr::detail
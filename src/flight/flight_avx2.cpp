@@ -0,0 +1,69 @@
+// AVX2 kernels: eight 32-bit pixels per vector.
+
+#include <immintrin.h>
+
+#include "flight_kernels.hpp"
+
+namespace solarlens::flight::detail {
+
+void accumulate_avx2(const std::uint16_t* frame, std::uint32_t* sum, std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m256i f = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(frame + i));
+        const __m256i lo = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(f));
+        const __m256i hi = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(f, 1));
+        auto* s = reinterpret_cast<__m256i*>(sum + i);
+        _mm256_storeu_si256(s, _mm256_add_epi32(_mm256_loadu_si256(s), lo));
+        _mm256_storeu_si256(s + 1, _mm256_add_epi32(_mm256_loadu_si256(s + 1), hi));
+    }
+    for (; i < n; ++i)
+        sum[i] += frame[i];
+}
+
+std::uint64_t span_sum_avx2(const std::uint32_t* p, std::size_t n)
+{
+    __m256i acc0 = _mm256_setzero_si256();
+    __m256i acc1 = _mm256_setzero_si256();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p + i));
+        acc0 = _mm256_add_epi64(acc0, _mm256_cvtepu32_epi64(_mm256_castsi256_si128(v)));
+        acc1 = _mm256_add_epi64(acc1, _mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1)));
+    }
+    alignas(32) std::uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), _mm256_add_epi64(acc0, acc1));
+    std::uint64_t total = lanes[0] + lanes[1] + lanes[2] + lanes[3];
+    for (; i < n; ++i)
+        total += p[i];
+    return total;
+}
+
+void map_row_avx2(const std::uint32_t* above, const std::uint32_t* row, std::size_t n, std::uint32_t max_value,
+                  std::uint32_t* mapped)
+{
+    // Samples stay below 2^31, so signed 32-bit arithmetic is exact.
+    const __m256i top = _mm256_set1_epi32(static_cast<int>(max_value));
+    const __m256i zero = _mm256_setzero_si256();
+    std::size_t x = 1;
+    for (; x + 8 <= n; x += 8) {
+        const __m256i a = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x - 1));
+        const __m256i b = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(above + x));
+        const __m256i c = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(above + x - 1));
+        const __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(row + x));
+        const __m256i g = _mm256_sub_epi32(_mm256_add_epi32(a, b), c);
+        const __m256i p = _mm256_min_epi32(_mm256_max_epi32(g, _mm256_min_epi32(a, b)), _mm256_max_epi32(a, b));
+        const __m256i d = _mm256_sub_epi32(v, p);
+        const __m256i theta = _mm256_min_epi32(p, _mm256_sub_epi32(top, p));
+        const __m256i ad = _mm256_abs_epi32(d);
+        const __m256i negative = _mm256_cmpgt_epi32(zero, d);
+        const __m256i inside = _mm256_add_epi32(_mm256_add_epi32(ad, ad), negative);
+        const __m256i outside = _mm256_add_epi32(theta, ad);
+        const __m256i m = _mm256_blendv_epi8(inside, outside, _mm256_cmpgt_epi32(ad, theta));
+        _mm256_storeu_si256(reinterpret_cast<__m256i*>(mapped + x), m);
+    }
+    for (; x < n; ++x)
+        mapped[x] = map_residual(row[x], med_predict(row[x - 1], above[x], above[x - 1]), max_value);
+}
+
+} // namespace solarlens::flight::detail
@@ -0,0 +1,68 @@
+// AVX-512F kernels: sixteen 32-bit pixels per vector.
+
+#if defined(__GNUC__) && !defined(__clang__)
+// GCC 12's headers pass _mm512_undefined_*() as the unused source of the
+// masked builtins behind the integer intrinsics, which -Wall reports.
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+#pragma GCC diagnostic ignored "-Wuninitialized"
+#endif
+
+#include <immintrin.h>
+
+#include "flight_kernels.hpp"
+
+namespace solarlens::flight::detail {
+
+void accumulate_avx512(const std::uint16_t* frame, std::uint32_t* sum, std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m512i f = _mm512_cvtepu16_epi32(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(frame + i)));
+        _mm512_storeu_si512(sum + i, _mm512_add_epi32(_mm512_loadu_si512(sum + i), f));
+    }
+    for (; i < n; ++i)
+        sum[i] += frame[i];
+}
+
+std::uint64_t span_sum_avx512(const std::uint32_t* p, std::size_t n)
+{
+    __m512i acc0 = _mm512_setzero_si512();
+    __m512i acc1 = _mm512_setzero_si512();
+    std::size_t i = 0;
+    for (; i + 16 <= n; i += 16) {
+        const __m512i v = _mm512_loadu_si512(p + i);
+        acc0 = _mm512_add_epi64(acc0, _mm512_cvtepu32_epi64(_mm512_castsi512_si256(v)));
+        acc1 = _mm512_add_epi64(acc1, _mm512_cvtepu32_epi64(_mm512_extracti64x4_epi64(v, 1)));
+    }
+    std::uint64_t total = static_cast<std::uint64_t>(_mm512_reduce_add_epi64(_mm512_add_epi64(acc0, acc1)));
+    for (; i < n; ++i)
+        total += p[i];
+    return total;
+}
+
+void map_row_avx512(const std::uint32_t* above, const std::uint32_t* row, std::size_t n, std::uint32_t max_value,
+                    std::uint32_t* mapped)
+{
+    const __m512i top = _mm512_set1_epi32(static_cast<int>(max_value));
+    std::size_t x = 1;
+    for (; x + 16 <= n; x += 16) {
+        const __m512i a = _mm512_loadu_si512(row + x - 1);
+        const __m512i b = _mm512_loadu_si512(above + x);
+        const __m512i c = _mm512_loadu_si512(above + x - 1);
+        const __m512i v = _mm512_loadu_si512(row + x);
+        const __m512i g = _mm512_sub_epi32(_mm512_add_epi32(a, b), c);
+        const __m512i p = _mm512_min_epi32(_mm512_max_epi32(g, _mm512_min_epi32(a, b)), _mm512_max_epi32(a, b));
+        const __m512i d = _mm512_sub_epi32(v, p);
+        const __m512i theta = _mm512_min_epi32(p, _mm512_sub_epi32(top, p));
+        const __m512i ad = _mm512_abs_epi32(d);
+        const __mmask16 negative = _mm512_cmplt_epi32_mask(d, _mm512_setzero_si512());
+        const __m512i twice = _mm512_add_epi32(ad, ad);
+        const __m512i inside = _mm512_mask_sub_epi32(twice, negative, twice, _mm512_set1_epi32(1));
+        const __m512i m = _mm512_mask_add_epi32(inside, _mm512_cmpgt_epi32_mask(ad, theta), theta, ad);
+        _mm512_storeu_si512(mapped + x, m);
+    }
+    for (; x < n; ++x)
+        mapped[x] = map_residual(row[x], med_predict(row[x - 1], above[x], above[x - 1]), max_value);
+}
+
+} // namespace solarlens::flight::detail
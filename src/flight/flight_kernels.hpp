@@ -0,0 +1,77 @@
+#pragma once
+
+// Per-ISA fixed-point kernels behind FlightProcessor, built per
+// translation unit like the other SIMD kernels. Integer only: the flight
+// CPU's FPU is not on the hot path, and results are bit-identical across
+// kernels.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace solarlens::flight::detail {
+
+// sum[i] += frame[i] for i < n.
+using AccumulateFn = void (*)(const std::uint16_t* frame, std::uint32_t* sum, std::size_t n);
+
+// Sum of p[0..n).
+using SpanSumFn = std::uint64_t (*)(const std::uint32_t* p, std::size_t n);
+
+// Lossless prediction of one image row y >= 1 for x in [1, n): the median
+// edge detector clamp(a + b - c, min(a, b), max(a, b)) with a = row[x-1],
+// b = above[x], c = above[x-1], then the CCSDS 121 mapping of the
+// residual against [0, max_value] into mapped[x].
+using MapRowFn = void (*)(const std::uint32_t* above, const std::uint32_t* row, std::size_t n,
+                          std::uint32_t max_value, std::uint32_t* mapped);
+
+// CCSDS 121 prediction-error mapping of sample x predicted as p.
+inline std::uint32_t map_residual(std::uint32_t x, std::uint32_t p, std::uint32_t max_value) noexcept
+{
+    const std::int64_t d = std::int64_t(x) - std::int64_t(p);
+    const std::int64_t theta = p < max_value - p ? p : max_value - p;
+    const std::int64_t ad = d < 0 ? -d : d;
+    if (ad <= theta)
+        return static_cast<std::uint32_t>(d >= 0 ? 2 * d : 2 * ad - 1);
+    return static_cast<std::uint32_t>(theta + ad);
+}
+
+// Inverse of map_residual().
+inline std::uint32_t unmap_residual(std::uint32_t m, std::uint32_t p, std::uint32_t max_value) noexcept
+{
+    const std::int64_t theta = p < max_value - p ? p : max_value - p;
+    std::int64_t d;
+    if (m <= 2 * theta)
+        d = (m & 1) ? -std::int64_t((m + 1) / 2) : std::int64_t(m / 2);
+    else
+        d = p <= max_value - p ? std::int64_t(m) - theta : theta - std::int64_t(m);
+    return static_cast<std::uint32_t>(std::int64_t(p) + d);
+}
+
+inline std::uint32_t med_predict(std::uint32_t a, std::uint32_t b, std::uint32_t c) noexcept
+{
+    const std::uint32_t lo = a < b ? a : b;
+    const std::uint32_t hi = a < b ? b : a;
+    const std::int64_t g = std::int64_t(a) + b - c;
+    return g < lo ? lo : g > hi ? hi : static_cast<std::uint32_t>(g);
+}
+
+void accumulate_scalar(const std::uint16_t*, std::uint32_t*, std::size_t);
+std::uint64_t span_sum_scalar(const std::uint32_t*, std::size_t);
+void map_row_scalar(const std::uint32_t*, const std::uint32_t*, std::size_t, std::uint32_t, std::uint32_t*);
+
+#if defined(SOLARLENS_HAVE_AVX2)
+void accumulate_avx2(const std::uint16_t*, std::uint32_t*, std::size_t);
+std::uint64_t span_sum_avx2(const std::uint32_t*, std::size_t);
+void map_row_avx2(const std::uint32_t*, const std::uint32_t*, std::size_t, std::uint32_t, std::uint32_t*);
+#endif
+#if defined(SOLARLENS_HAVE_AVX512)
+void accumulate_avx512(const std::uint16_t*, std::uint32_t*, std::size_t);
+std::uint64_t span_sum_avx512(const std::uint32_t*, std::size_t);
+void map_row_avx512(const std::uint32_t*, const std::uint32_t*, std::size_t, std::uint32_t, std::uint32_t*);
+#endif
+#if defined(SOLARLENS_HAVE_NEON)
+void accumulate_neon(const std::uint16_t*, std::uint32_t*, std::size_t);
+std::uint64_t span_sum_neon(const std::uint32_t*, std::size_t);
+void map_row_neon(const std::uint32_t*, const std::uint32_t*, std::size_t, std::uint32_t, std::uint32_t*);
+#endif
+
+} // namespace solarlens::flight::detail
@@ -0,0 +1,60 @@
+// AArch64 NEON kernels: four 32-bit pixels per vector, the flight CPU's
+// native path.
+
+#include <arm_neon.h>
+
+#include "flight_kernels.hpp"
+
+namespace solarlens::flight::detail {
+
+void accumulate_neon(const std::uint16_t* frame, std::uint32_t* sum, std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        const uint16x8_t f = vld1q_u16(frame + i);
+        vst1q_u32(sum + i, vaddw_u16(vld1q_u32(sum + i), vget_low_u16(f)));
+        vst1q_u32(sum + i + 4, vaddw_u16(vld1q_u32(sum + i + 4), vget_high_u16(f)));
+    }
+    for (; i < n; ++i)
+        sum[i] += frame[i];
+}
+
+std::uint64_t span_sum_neon(const std::uint32_t* p, std::size_t n)
+{
+    uint64x2_t acc = vdupq_n_u64(0);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4)
+        acc = vpadalq_u32(acc, vld1q_u32(p + i));
+    std::uint64_t total = vaddvq_u64(acc);
+    for (; i < n; ++i)
+        total += p[i];
+    return total;
+}
+
+void map_row_neon(const std::uint32_t* above, const std::uint32_t* row, std::size_t n, std::uint32_t max_value,
+                  std::uint32_t* mapped)
+{
+    const int32x4_t top = vdupq_n_s32(static_cast<int>(max_value));
+    std::size_t x = 1;
+    for (; x + 4 <= n; x += 4) {
+        const int32x4_t a = vreinterpretq_s32_u32(vld1q_u32(row + x - 1));
+        const int32x4_t b = vreinterpretq_s32_u32(vld1q_u32(above + x));
+        const int32x4_t c = vreinterpretq_s32_u32(vld1q_u32(above + x - 1));
+        const int32x4_t v = vreinterpretq_s32_u32(vld1q_u32(row + x));
+        const int32x4_t g = vsubq_s32(vaddq_s32(a, b), c);
+        const int32x4_t p = vminq_s32(vmaxq_s32(g, vminq_s32(a, b)), vmaxq_s32(a, b));
+        const int32x4_t d = vsubq_s32(v, p);
+        const int32x4_t theta = vminq_s32(p, vsubq_s32(top, p));
+        const int32x4_t ad = vabsq_s32(d);
+        const int32x4_t negative = vreinterpretq_s32_u32(vcltzq_s32(d));
+        const int32x4_t inside = vaddq_s32(vaddq_s32(ad, ad), negative);
+        const int32x4_t outside = vaddq_s32(theta, ad);
+        const uint32x4_t m = vbslq_u32(vcgtq_s32(ad, theta), vreinterpretq_u32_s32(outside),
+                                       vreinterpretq_u32_s32(inside));
+        vst1q_u32(mapped + x, m);
+    }
+    for (; x < n; ++x)
+        mapped[x] = map_residual(row[x], med_predict(row[x - 1], above[x], above[x - 1]), max_value);
+}
+
+} // namespace solarlens::flight::detail
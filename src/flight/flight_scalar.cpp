@@ -0,0 +1,28 @@
+// Reference kernels.
+
+#include "flight_kernels.hpp"
+
+namespace solarlens::flight::detail {
+
+void accumulate_scalar(const std::uint16_t* frame, std::uint32_t* sum, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; ++i)
+        sum[i] += frame[i];
+}
+
+std::uint64_t span_sum_scalar(const std::uint32_t* p, std::size_t n)
+{
+    std::uint64_t total = 0;
+    for (std::size_t i = 0; i < n; ++i)
+        total += p[i];
+    return total;
+}
+
+void map_row_scalar(const std::uint32_t* above, const std::uint32_t* row, std::size_t n, std::uint32_t max_value,
+                    std::uint32_t* mapped)
+{
+    for (std::size_t x = 1; x < n; ++x)
+        mapped[x] = map_residual(row[x], med_predict(row[x - 1], above[x], above[x - 1]), max_value);
+}
+
+} // namespace solarlens::flight::detail
@@ -0,0 +1,374 @@
+#include "solarlens/flight/processor.hpp"
+
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include "flight_kernels.hpp"
+#include "rice.hpp"
+#include "ring_spans.hpp"
+#include "solarlens/flight/product.hpp"
+#include "solarlens/perf/instrument.hpp"
+
+namespace solarlens::flight {
+
+namespace {
+
+constexpr std::size_t region_alignment = 64;
+
+std::size_t align_up(std::size_t n) noexcept
+{
+    return (n + region_alignment - 1) & ~(region_alignment - 1);
+}
+
+std::size_t span_count(const FlightConfig& config)
+{
+    std::size_t n = 0;
+    detail::for_each_ring_span(config.width, config.height, config.ring,
+                               [&](std::uint32_t, std::uint32_t, std::uint32_t) { ++n; });
+    return n;
+}
+
+struct Layout {
+    std::size_t sum, mapped, reconstructed, sectors, spans, total;
+};
+
+template <typename Span>
+Layout layout(const FlightConfig& config, std::size_t spans)
+{
+    const std::size_t pixels = std::size_t(config.width) * config.height;
+    Layout l {};
+    l.sum = 0;
+    l.mapped = l.sum + align_up(pixels * sizeof(std::uint32_t));
+    l.reconstructed = l.mapped + align_up(config.width * sizeof(std::uint32_t));
+    l.sectors = l.reconstructed + align_up(2 * config.width * sizeof(std::uint32_t));
+    l.spans = l.sectors + align_up(config.ring.sectors * sizeof(SectorSums));
+    l.total = l.spans + align_up(spans * sizeof(Span));
+    return l;
+}
+
+std::size_t put_u8(std::byte* p, std::uint8_t v) noexcept
+{
+    p[0] = std::byte {v};
+    return 1;
+}
+
+std::size_t put_u16(std::byte* p, std::uint16_t v) noexcept
+{
+    for (int i = 0; i < 2; ++i)
+        p[i] = std::byte(v >> (8 * i));
+    return 2;
+}
+
+std::size_t put_u32(std::byte* p, std::uint32_t v) noexcept
+{
+    for (int i = 0; i < 4; ++i)
+        p[i] = std::byte(v >> (8 * i));
+    return 4;
+}
+
+std::size_t put_varint(std::byte* p, std::uint64_t v) noexcept
+{
+    std::size_t n = 0;
+    while (v >= 0x80) {
+        p[n++] = std::byte((v & 0x7f) | 0x80);
+        v >>= 7;
+    }
+    p[n++] = std::byte(v);
+    return n;
+}
+
+constexpr std::size_t max_varint_bytes = 10;
+
+// 2^32 / (2 delta + 1), rounded up: floor(n * r / 2^32) is n / (2 delta + 1)
+// for every n below 2^32 / (2 delta + 1), which covers 25-bit residuals.
+std::uint64_t reciprocal(std::uint32_t divisor) noexcept
+{
+    return ((std::uint64_t(1) << 32) + divisor - 1) / divisor;
+}
+
+} // namespace
+
+const char* to_string(FlightMode mode) noexcept
+{
+    switch (mode) {
+    case FlightMode::photometry:
+        return "photometry";
+    case FlightMode::lossless:
+        return "lossless";
+    case FlightMode::near_lossless:
+        return "near_lossless";
+    }
+    return "unknown";
+}
+
+void FlightConfig::validate() const
+{
+    if (width == 0 || width % detail::block_size != 0)
+        throw std::invalid_argument("flight: width must be a positive multiple of 16");
+    if (height == 0)
+        throw std::invalid_argument("flight: height must be positive");
+    if (frames_per_coadd == 0 || frames_per_coadd > 256)
+        throw std::invalid_argument("flight: frames per co-add must be in 1..256");
+    if (mode == FlightMode::near_lossless && (near_lossless_delta == 0 || near_lossless_delta > 63))
+        throw std::invalid_argument("flight: near-lossless delta must be in 1..63");
+    if (ring.sectors == 0)
+        throw std::invalid_argument("flight: ring needs at least one sector");
+    if (!(ring.inner >= 0.0f && ring.outer > ring.inner))
+        throw std::invalid_argument("flight: ring annulus must have 0 <= inner < outer");
+    if (ring.has_background() && !(ring.background_inner >= 0.0f))
+        throw std::invalid_argument("flight: background annulus must have a non-negative inner radius");
+}
+
+unsigned FlightConfig::sample_bits() const noexcept
+{
+    return 16 + static_cast<unsigned>(std::bit_width(frames_per_coadd - 1));
+}
+
+std::size_t FlightProcessor::workspace_bytes(const FlightConfig& config)
+{
+    config.validate();
+    return layout<Span>(config, span_count(config)).total;
+}
+
+std::size_t FlightProcessor::max_product_bytes(const FlightConfig& config)
+{
+    config.validate();
+    const std::size_t per_sector = (config.ring.has_background() ? 2 : 1) * max_varint_bytes;
+    std::size_t bytes = product_header_bytes + config.ring.sectors * per_sector;
+    if (config.mode != FlightMode::photometry) {
+        const std::size_t blocks = std::size_t(config.width) * config.height / detail::block_size;
+        bytes += (blocks * detail::max_block_bits(config.sample_bits()) + 7) / 8;
+    }
+    return bytes;
+}
+
+FlightProcessor::FlightProcessor(const FlightConfig& config, std::span<std::byte> workspace)
+    : config_(config)
+{
+    config_.validate();
+    if (!core::simd_level_supported(config_.simd))
+        throw std::invalid_argument(std::string("flight: SIMD level ") + core::to_string(config_.simd)
+                                    + " not available");
+    bits_ = config_.sample_bits();
+    max_value_ = static_cast<std::uint32_t>((std::uint64_t(1) << bits_) - 1);
+    max_product_ = max_product_bytes(config_);
+
+    const std::size_t spans = span_count(config_);
+    const Layout l = layout<Span>(config_, spans);
+    if (workspace.size() < l.total)
+        throw std::invalid_argument("flight: workspace needs " + std::to_string(l.total) + " bytes");
+    std::byte* base = workspace.data();
+    if (reinterpret_cast<std::uintptr_t>(base) % alignof(std::uint64_t) != 0)
+        throw std::invalid_argument("flight: workspace must be 8-byte aligned");
+    sum_ = reinterpret_cast<std::uint32_t*>(base + l.sum);
+    mapped_ = reinterpret_cast<std::uint32_t*>(base + l.mapped);
+    reconstructed_ = reinterpret_cast<std::uint32_t*>(base + l.reconstructed);
+    sectors_ = reinterpret_cast<SectorSums*>(base + l.sectors);
+    spans_ = reinterpret_cast<Span*>(base + l.spans);
+
+    for (std::uint16_t s = 0; s < config_.ring.sectors; ++s)
+        sectors_[s] = SectorSums {};
+    detail::for_each_ring_span(config_.width, config_.height, config_.ring,
+                               [&](std::uint32_t offset, std::uint32_t length, std::uint32_t bin) {
+                                   spans_[span_count_++] = {offset, length, bin};
+                                   if (bin < config_.ring.sectors)
+                                       sectors_[bin].signal_pixels += length;
+                                   else
+                                       sectors_[bin - config_.ring.sectors].background_pixels += length;
+                               });
+
+    switch (config_.simd) {
+#if defined(SOLARLENS_HAVE_AVX512)
+    case core::SimdLevel::avx512:
+        accumulate_ = detail::accumulate_avx512;
+        span_sum_ = detail::span_sum_avx512;
+        map_row_ = detail::map_row_avx512;
+        break;
+#endif
+#if defined(SOLARLENS_HAVE_AVX2)
+    case core::SimdLevel::avx2:
+        accumulate_ = detail::accumulate_avx2;
+        span_sum_ = detail::span_sum_avx2;
+        map_row_ = detail::map_row_avx2;
+        break;
+#endif
+#if defined(SOLARLENS_HAVE_NEON)
+    case core::SimdLevel::neon:
+        accumulate_ = detail::accumulate_neon;
+        span_sum_ = detail::span_sum_neon;
+        map_row_ = detail::map_row_neon;
+        break;
+#endif
+    default:
+        accumulate_ = detail::accumulate_scalar;
+        span_sum_ = detail::span_sum_scalar;
+        map_row_ = detail::map_row_scalar;
+        break;
+    }
+    reset();
+}
+
+void FlightProcessor::reset() noexcept
+{
+    std::memset(sum_, 0, std::size_t(config_.width) * config_.height * sizeof(std::uint32_t));
+    frames_ = 0;
+    out_ = nullptr;
+    done_ = false;
+}
+
+bool FlightProcessor::add_frame(core::ImageView<const std::uint16_t> frame) noexcept
+{
+    static const perf::Stage stage("flight.coadd");
+    perf::ScopedTimer timer(stage);
+
+    if (frame.width != config_.width || frame.height != config_.height || full())
+        return false;
+    for (std::uint32_t y = 0; y < config_.height; ++y)
+        accumulate_(frame.row(y), sum_ + std::size_t(y) * config_.width, config_.width);
+    ++frames_;
+    return true;
+}
+
+bool FlightProcessor::begin_product(std::span<std::byte> out) noexcept
+{
+    static const perf::Stage stage("flight.photometry");
+    perf::ScopedTimer timer(stage);
+
+    if (frames_ == 0 || out.size() < max_product_)
+        return false;
+    const std::uint16_t sectors = config_.ring.sectors;
+    for (std::uint16_t s = 0; s < sectors; ++s)
+        sectors_[s].signal = sectors_[s].background = 0;
+    for (std::size_t i = 0; i < span_count_; ++i) {
+        const Span& span = spans_[i];
+        const std::uint64_t sum = span_sum_(sum_ + span.offset, span.length);
+        if (span.bin < sectors)
+            sectors_[span.bin].signal += sum;
+        else
+            sectors_[span.bin - sectors].background += sum;
+    }
+
+    const RingGeometry& ring = config_.ring;
+    std::byte* p = out.data();
+    std::size_t n = put_u32(p, product_magic);
+    n += put_u8(p + n, product_version);
+    n += put_u8(p + n, static_cast<std::uint8_t>(config_.mode));
+    n += put_u8(p + n, static_cast<std::uint8_t>(config_.mode == FlightMode::near_lossless
+                                                      ? config_.near_lossless_delta : 0));
+    n += put_u8(p + n, static_cast<std::uint8_t>(bits_));
+    n += put_u32(p + n, config_.width);
+    n += put_u32(p + n, config_.height);
+    n += put_u32(p + n, frames_);
+    n += put_u16(p + n, sectors);
+    n += put_u16(p + n, ring.has_background() ? 1 : 0);
+    n += put_u32(p + n, 0); // Image bytes, patched when the image is done.
+    for (const float f : {ring.cx, ring.cy, ring.inner, ring.outer, ring.background_inner, ring.background_outer})
+        n += put_u32(p + n, std::bit_cast<std::uint32_t>(f));
+    for (std::uint16_t s = 0; s < sectors; ++s) {
+        n += put_varint(p + n, sectors_[s].signal);
+        if (ring.has_background())
+            n += put_varint(p + n, sectors_[s].background);
+    }
+
+    out_ = out.data();
+    capacity_ = out.size();
+    image_offset_ = n;
+    product_size_ = n;
+    next_row_ = 0;
+    bit_pos_ = 0;
+    bit_acc_ = 0;
+    bit_fill_ = 0;
+    done_ = config_.mode == FlightMode::photometry;
+    return true;
+}
+
+void FlightProcessor::predict_row(std::uint32_t y) noexcept
+{
+    const std::uint32_t* row = sum_ + std::size_t(y) * config_.width;
+    if (y == 0) {
+        mapped_[0] = detail::map_residual(row[0], 0, max_value_);
+        for (std::uint32_t x = 1; x < config_.width; ++x)
+            mapped_[x] = detail::map_residual(row[x], row[x - 1], max_value_);
+        return;
+    }
+    const std::uint32_t* above = row - config_.width;
+    mapped_[0] = detail::map_residual(row[0], above[0], max_value_);
+    map_row_(above, row, config_.width, max_value_, mapped_);
+}
+
+void FlightProcessor::predict_near_lossless_row(std::uint32_t y) noexcept
+{
+    // Predicts from reconstructed pixels, as the ground will see them, so
+    // quantization error does not accumulate along the row.
+    const std::uint32_t* row = sum_ + std::size_t(y) * config_.width;
+    std::uint32_t* cur = reconstructed_ + std::size_t(y & 1) * config_.width;
+    const std::uint32_t* prev = reconstructed_ + std::size_t((y + 1) & 1) * config_.width;
+    const std::int64_t delta = config_.near_lossless_delta;
+    const std::int64_t step = 2 * delta + 1;
+    const std::uint64_t inv = reciprocal(static_cast<std::uint32_t>(step));
+    for (std::uint32_t x = 0; x < config_.width; ++x) {
+        std::uint32_t p;
+        if (y == 0)
+            p = x == 0 ? 0 : cur[x - 1];
+        else
+            p = x == 0 ? prev[0] : detail::med_predict(cur[x - 1], prev[x], prev[x - 1]);
+        const std::int64_t d = std::int64_t(row[x]) - p;
+        const std::uint64_t magnitude = static_cast<std::uint64_t>((d < 0 ? -d : d) + delta);
+        const auto q = static_cast<std::int64_t>((magnitude * inv) >> 32);
+        const std::int64_t signed_q = d < 0 ? -q : q;
+        const std::int64_t r = std::int64_t(p) + signed_q * step;
+        cur[x] = static_cast<std::uint32_t>(r < 0 ? 0 : r > std::int64_t(max_value_) ? max_value_ : r);
+        mapped_[x] = static_cast<std::uint32_t>(signed_q < 0 ? -2 * signed_q - 1 : 2 * signed_q);
+    }
+}
+
+bool FlightProcessor::encode_rows(std::uint32_t rows) noexcept
+{
+    static const perf::Stage stage("flight.encode");
+    perf::ScopedTimer timer(stage);
+
+    if (!out_ || done_)
+        return done_;
+    auto* image = reinterpret_cast<std::uint8_t*>(out_ + image_offset_);
+    detail::BitWriter writer(image, capacity_ - image_offset_, bit_pos_, bit_acc_, bit_fill_);
+    const bool near = config_.mode == FlightMode::near_lossless;
+    for (std::uint32_t r = 0; r < rows && next_row_ < config_.height; ++r, ++next_row_) {
+        if (near)
+            predict_near_lossless_row(next_row_);
+        else
+            predict_row(next_row_);
+        for (std::uint32_t x = 0; x < config_.width; x += detail::block_size)
+            detail::encode_block(mapped_ + x, bits_, writer);
+    }
+    if (next_row_ < config_.height) {
+        bit_pos_ = writer.pos();
+        bit_acc_ = writer.acc();
+        bit_fill_ = writer.fill();
+        return false;
+    }
+    const std::size_t bytes = writer.finish();
+    // The capacity covers the worst case, so this cannot trip; it only
+    // keeps a truncated product from ever being reported.
+    if (writer.overflow()) {
+        out_ = nullptr;
+        return false;
+    }
+    put_u32(out_ + 24, static_cast<std::uint32_t>(bytes));
+    product_size_ = image_offset_ + bytes;
+    done_ = true;
+    return true;
+}
+
+std::size_t FlightProcessor::encode(std::span<std::byte> out) noexcept
+{
+    if (!begin_product(out))
+        return 0;
+    while (!encode_rows(config_.height))
+        if (!out_)
+            return 0;
+    return product_size_;
+}
+
+} // namespace solarlens::flight
@@ -0,0 +1,145 @@
+#include "solarlens/flight/product.hpp"
+
+#include <bit>
+#include <stdexcept>
+#include <string>
+
+#include "flight_kernels.hpp"
+#include "rice.hpp"
+#include "ring_spans.hpp"
+
+namespace solarlens::flight {
+
+namespace {
+
+class Reader {
+public:
+    explicit Reader(std::span<const std::byte> bytes) noexcept
+        : bytes_(bytes)
+    {
+    }
+
+    std::uint64_t get(std::size_t width)
+    {
+        need(width);
+        std::uint64_t v = 0;
+        for (std::size_t i = 0; i < width; ++i)
+            v |= std::uint64_t(bytes_[pos_ + i]) << (8 * i);
+        pos_ += width;
+        return v;
+    }
+
+    std::uint64_t varint()
+    {
+        std::uint64_t v = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7) {
+            need(1);
+            const auto b = std::to_integer<std::uint8_t>(bytes_[pos_++]);
+            v |= std::uint64_t(b & 0x7f) << shift;
+            if (!(b & 0x80))
+                return v;
+        }
+        throw std::runtime_error("flight: overlong varint in product");
+    }
+
+    std::span<const std::byte> take(std::size_t n)
+    {
+        need(n);
+        const auto s = bytes_.subspan(pos_, n);
+        pos_ += n;
+        return s;
+    }
+
+private:
+    void need(std::size_t n) const
+    {
+        if (bytes_.size() - pos_ < n)
+            throw std::runtime_error("flight: truncated product");
+    }
+
+    std::span<const std::byte> bytes_;
+    std::size_t pos_ = 0;
+};
+
+// Mirror of FlightProcessor::predict_row() and predict_near_lossless_row().
+void decode_image(std::span<const std::byte> payload, FlightProduct& p)
+{
+    const std::uint32_t max_value = static_cast<std::uint32_t>((std::uint64_t(1) << p.sample_bits) - 1);
+    const std::int64_t step = 2 * std::int64_t(p.near_lossless_delta) + 1;
+    const bool near = p.mode == FlightMode::near_lossless;
+    detail::BitReader in(reinterpret_cast<const std::uint8_t*>(payload.data()), payload.size());
+    std::vector<std::uint32_t> mapped(p.width);
+    p.image.assign(std::size_t(p.width) * p.height, 0);
+    for (std::uint32_t y = 0; y < p.height; ++y) {
+        for (std::uint32_t x = 0; x < p.width; x += detail::block_size)
+            detail::decode_block(in, p.sample_bits, mapped.data() + x);
+        std::uint32_t* row = p.image.data() + std::size_t(y) * p.width;
+        const std::uint32_t* above = y > 0 ? row - p.width : nullptr;
+        for (std::uint32_t x = 0; x < p.width; ++x) {
+            std::uint32_t pred;
+            if (y == 0)
+                pred = x == 0 ? 0 : row[x - 1];
+            else
+                pred = x == 0 ? above[0] : detail::med_predict(row[x - 1], above[x], above[x - 1]);
+            if (!near) {
+                row[x] = detail::unmap_residual(mapped[x], pred, max_value);
+                continue;
+            }
+            const std::uint32_t m = mapped[x];
+            const std::int64_t q = (m & 1) ? -std::int64_t((m + 1) / 2) : std::int64_t(m / 2);
+            const std::int64_t r = std::int64_t(pred) + q * step;
+            row[x] = static_cast<std::uint32_t>(r < 0 ? 0 : r > std::int64_t(max_value) ? max_value : r);
+        }
+    }
+}
+
+} // namespace
+
+FlightProduct decode_product(std::span<const std::byte> product)
+{
+    Reader r(product);
+    if (r.get(4) != product_magic)
+        throw std::runtime_error("flight: not a flight product");
+    if (const auto version = r.get(1); version != product_version)
+        throw std::runtime_error("flight: unsupported product version " + std::to_string(version));
+    FlightProduct p;
+    const auto mode = r.get(1);
+    if (mode > static_cast<std::uint8_t>(FlightMode::near_lossless))
+        throw std::runtime_error("flight: unknown product mode");
+    p.mode = static_cast<FlightMode>(mode);
+    p.near_lossless_delta = static_cast<std::uint32_t>(r.get(1));
+    p.sample_bits = static_cast<unsigned>(r.get(1));
+    p.width = static_cast<std::uint32_t>(r.get(4));
+    p.height = static_cast<std::uint32_t>(r.get(4));
+    p.frames = static_cast<std::uint32_t>(r.get(4));
+    p.ring.sectors = static_cast<std::uint16_t>(r.get(2));
+    const bool background = (r.get(2) & 1) != 0;
+    const auto image_bytes = static_cast<std::size_t>(r.get(4));
+    float* geometry[] = {&p.ring.cx, &p.ring.cy, &p.ring.inner, &p.ring.outer, &p.ring.background_inner,
+                         &p.ring.background_outer};
+    for (float* f : geometry)
+        *f = std::bit_cast<float>(static_cast<std::uint32_t>(r.get(4)));
+    if (p.width == 0 || p.width % detail::block_size != 0 || p.height == 0 || p.ring.sectors == 0
+        || p.sample_bits < 16 || p.sample_bits > 24 || background != p.ring.has_background()
+        || (p.mode == FlightMode::near_lossless && p.near_lossless_delta == 0))
+        throw std::runtime_error("flight: inconsistent product header");
+
+    p.sectors.resize(p.ring.sectors);
+    for (SectorSums& s : p.sectors) {
+        s.signal = r.varint();
+        if (background)
+            s.background = r.varint();
+    }
+    detail::for_each_ring_span(p.width, p.height, p.ring, [&](std::uint32_t, std::uint32_t length, std::uint32_t bin) {
+        if (bin < p.ring.sectors)
+            p.sectors[bin].signal_pixels += length;
+        else
+            p.sectors[bin - p.ring.sectors].background_pixels += length;
+    });
+
+    if (p.mode != FlightMode::photometry)
+        decode_image(r.take(image_bytes), p);
+    return p;
+}
+
+} // namespace solarlens::flight
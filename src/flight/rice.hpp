@@ -0,0 +1,207 @@
+#pragma once
+
+// Adaptive Rice block coder in the style of CCSDS 121.0: blocks of
+// `block_size` mapped residuals, each prefixed by a 5-bit option id.
+//
+//   id 0          every residual is zero; nothing follows
+//   id k+1        split-sample option k: residual m is m >> k zeros, a one,
+//                 then the low k bits (k = 0 is the fundamental sequence)
+//   id raw_id     residuals verbatim in `bits` bits each
+//
+// The encoder tries the split options around log2(mean) and the raw
+// option and keeps the shortest, so a block never costs more than
+// 5 + block_size * bits. Bits are written MSB first.
+
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+
+namespace solarlens::flight::detail {
+
+inline constexpr std::size_t block_size = 16;
+inline constexpr unsigned id_bits = 5;
+inline constexpr std::uint32_t raw_id = 31;
+
+inline constexpr std::size_t max_block_bits(unsigned bits) noexcept
+{
+    return id_bits + block_size * bits;
+}
+
+// Writes into a fixed buffer; bits past the end are dropped and flagged.
+class BitWriter {
+public:
+    BitWriter() = default;
+    BitWriter(std::uint8_t* out, std::size_t capacity) noexcept
+        : out_(out)
+        , capacity_(capacity)
+    {
+    }
+
+    // Resumes a writer whose state was saved with pos()/acc()/fill().
+    BitWriter(std::uint8_t* out, std::size_t capacity, std::size_t pos, std::uint64_t acc, unsigned fill) noexcept
+        : out_(out)
+        , capacity_(capacity)
+        , pos_(pos)
+        , acc_(acc)
+        , fill_(fill)
+    {
+    }
+
+    void put(std::uint32_t value, unsigned bits) noexcept
+    {
+        if (bits == 0)
+            return;
+        acc_ = (acc_ << bits) | (value & ((std::uint64_t(1) << bits) - 1));
+        fill_ += bits;
+        while (fill_ >= 8) {
+            fill_ -= 8;
+            emit(static_cast<std::uint8_t>(acc_ >> fill_));
+        }
+    }
+
+    void put_zeros(std::uint32_t count) noexcept
+    {
+        for (; count > 32; count -= 32)
+            put(0, 32);
+        put(0, count);
+    }
+
+    // Pads to a byte boundary and returns the bytes written.
+    std::size_t finish() noexcept
+    {
+        if (fill_ > 0)
+            put(0, 8 - fill_);
+        return pos_;
+    }
+
+    std::size_t pos() const noexcept { return pos_; }
+    std::uint64_t acc() const noexcept { return acc_; }
+    unsigned fill() const noexcept { return fill_; }
+    bool overflow() const noexcept { return overflow_; }
+
+private:
+    void emit(std::uint8_t byte) noexcept
+    {
+        if (pos_ < capacity_)
+            out_[pos_++] = byte;
+        else
+            overflow_ = true;
+    }
+
+    std::uint8_t* out_ = nullptr;
+    std::size_t capacity_ = 0;
+    std::size_t pos_ = 0;
+    std::uint64_t acc_ = 0;
+    unsigned fill_ = 0;
+    bool overflow_ = false;
+};
+
+// Ground-side reader; throws std::runtime_error past the end.
+class BitReader {
+public:
+    BitReader(const std::uint8_t* in, std::size_t size) noexcept
+        : in_(in)
+        , size_(size)
+    {
+    }
+
+    std::uint32_t get(unsigned bits)
+    {
+        std::uint32_t v = 0;
+        for (unsigned i = 0; i < bits; ++i)
+            v = (v << 1) | bit();
+        return v;
+    }
+
+    // Zeros before the next one bit, which is consumed.
+    std::uint32_t zeros(std::uint32_t limit)
+    {
+        std::uint32_t n = 0;
+        while (bit() == 0)
+            if (++n > limit)
+                throw std::runtime_error("flight: corrupt Rice codeword");
+        return n;
+    }
+
+private:
+    std::uint32_t bit()
+    {
+        if (pos_ >= size_ * 8)
+            throw std::runtime_error("flight: truncated image payload");
+        const std::uint32_t b = (in_[pos_ >> 3] >> (7 - (pos_ & 7))) & 1u;
+        ++pos_;
+        return b;
+    }
+
+    const std::uint8_t* in_;
+    std::size_t size_;
+    std::size_t pos_ = 0;
+};
+
+inline std::uint64_t split_cost(const std::uint32_t* m, unsigned k) noexcept
+{
+    std::uint64_t bits = block_size * (k + 1);
+    for (std::size_t i = 0; i < block_size; ++i)
+        bits += m[i] >> k;
+    return bits;
+}
+
+// Codes one block of residuals, each below 2^bits.
+inline void encode_block(const std::uint32_t* m, unsigned bits, BitWriter& out) noexcept
+{
+    std::uint64_t sum = 0;
+    for (std::size_t i = 0; i < block_size; ++i)
+        sum += m[i];
+    if (sum == 0) {
+        out.put(0, id_bits);
+        return;
+    }
+    const unsigned max_k = bits >= 2 ? bits - 2 : 0;
+    const std::uint64_t mean = sum / block_size;
+    const unsigned guess = mean == 0 ? 0 : static_cast<unsigned>(std::bit_width(mean)) - 1;
+    unsigned best_k = 0;
+    std::uint64_t best = ~std::uint64_t(0);
+    for (unsigned k = guess == 0 ? 0 : guess - 1; k <= guess + 1 && k <= max_k; ++k) {
+        const std::uint64_t cost = split_cost(m, k);
+        if (cost < best) {
+            best = cost;
+            best_k = k;
+        }
+    }
+    if (best >= std::uint64_t(block_size) * bits) {
+        out.put(raw_id, id_bits);
+        for (std::size_t i = 0; i < block_size; ++i)
+            out.put(m[i], bits);
+        return;
+    }
+    out.put(best_k + 1, id_bits);
+    for (std::size_t i = 0; i < block_size; ++i) {
+        out.put_zeros(m[i] >> best_k);
+        out.put(1, 1);
+        out.put(m[i], best_k);
+    }
+}
+
+inline void decode_block(BitReader& in, unsigned bits, std::uint32_t* m)
+{
+    const std::uint32_t id = in.get(id_bits);
+    if (id == 0) {
+        for (std::size_t i = 0; i < block_size; ++i)
+            m[i] = 0;
+    } else if (id == raw_id) {
+        for (std::size_t i = 0; i < block_size; ++i)
+            m[i] = in.get(bits);
+    } else {
+        const unsigned k = id - 1;
+        if (k + 2 > bits && k != 0)
+            throw std::runtime_error("flight: bad Rice option id");
+        const std::uint32_t limit = std::uint32_t(((std::uint64_t(1) << bits) - 1) >> k);
+        for (std::size_t i = 0; i < block_size; ++i) {
+            const std::uint32_t q = in.zeros(limit);
+            m[i] = (q << k) | in.get(k);
+        }
+    }
+}
+
+} // namespace solarlens::flight::detail
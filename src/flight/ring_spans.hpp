@@ -0,0 +1,59 @@
+#pragma once
+
+// Ring-sector pixel runs, shared by the flight processor (which stores
+// them) and the ground decoder (which needs the pixel counts).
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <numbers>
+
+#include "solarlens/flight/processor.hpp"
+
+namespace solarlens::flight::detail {
+
+// Calls emit(offset, length, bin) for every maximal run of pixels of one
+// row in the same annulus sector; bin is the sector, plus `sectors` in
+// the background annulus. A pixel belongs to an annulus if its centre's
+// radius r satisfies inner <= r < outer.
+template <typename Emit>
+void for_each_ring_span(std::uint32_t width, std::uint32_t height, const RingGeometry& ring, Emit&& emit)
+{
+    const double outer = std::max(ring.outer, ring.has_background() ? ring.background_outer : 0.0f);
+    const double sectors = ring.sectors;
+    const auto bin_of = [&](double dx, double dy) -> long {
+        const double r2 = dx * dx + dy * dy;
+        long base;
+        if (r2 >= double(ring.inner) * ring.inner && r2 < double(ring.outer) * ring.outer)
+            base = 0;
+        else if (ring.has_background() && r2 >= double(ring.background_inner) * ring.background_inner
+                 && r2 < double(ring.background_outer) * ring.background_outer)
+            base = ring.sectors;
+        else
+            return -1;
+        double turn = std::atan2(dy, dx) / (2.0 * std::numbers::pi);
+        if (turn < 0.0)
+            turn += 1.0;
+        return base + std::min<long>(static_cast<long>(turn * sectors), ring.sectors - 1);
+    };
+    const long y0 = std::max<long>(0, static_cast<long>(std::floor(ring.cy - outer)));
+    const long y1 = std::min<long>(long(height) - 1, static_cast<long>(std::ceil(ring.cy + outer)));
+    const long x0 = std::max<long>(0, static_cast<long>(std::floor(ring.cx - outer)));
+    const long x1 = std::min<long>(long(width) - 1, static_cast<long>(std::ceil(ring.cx + outer)));
+    for (long y = y0; y <= y1; ++y) {
+        long run_bin = -1;
+        long run_start = 0;
+        for (long x = x0; x <= x1 + 1; ++x) {
+            const long bin = x <= x1 ? bin_of(double(x) - ring.cx, double(y) - ring.cy) : -1;
+            if (bin == run_bin)
+                continue;
+            if (run_bin >= 0)
+                emit(static_cast<std::uint32_t>(y * long(width) + run_start),
+                     static_cast<std::uint32_t>(x - run_start), static_cast<std::uint32_t>(run_bin));
+            run_bin = bin;
+            run_start = x;
+        }
+    }
+}
+
+} // namespace solarlens::flight::detail
@@ -0,0 +1,76 @@
+#include "solarlens/ingest/ccsds.hpp"
+
+namespace solarlens::ingest {
+
+namespace {
+
+struct Crc16Table {
+    std::array<std::uint16_t, 256> entries {};
+
+    constexpr Crc16Table()
+    {
+        for (unsigned i = 0; i < 256; ++i) {
+            std::uint16_t crc = static_cast<std::uint16_t>(i << 8);
+            for (int bit = 0; bit < 8; ++bit)
+                crc = static_cast<std::uint16_t>((crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1);
+            entries[i] = crc;
+        }
+    }
+};
+
+constexpr Crc16Table crc16_table;
+
+} // namespace
+
+std::uint16_t crc16_ccitt(std::span<const std::byte> data) noexcept
+{
+    std::uint16_t crc = 0xFFFF;
+    for (std::byte b : data) {
+        const unsigned idx = ((crc >> 8) ^ std::to_integer<unsigned>(b)) & 0xFF;
+        crc = static_cast<std::uint16_t>((crc << 8) ^ crc16_table.entries[idx]);
+    }
+    return crc;
+}
+
+std::size_t TmFrameView::secondary_header_size() const noexcept
+{
+    if (!secondary_header_flag() || frame_.size() <= primary_header_size)
+        return 0;
+    return (byte(primary_header_size) & 0x3F) + 1u;
+}
+
+std::size_t TmFrameView::trailer_size() const noexcept
+{
+    return (ocf_flag() ? ocf_size : 0) + (fecf_present_ ? fecf_size : 0);
+}
+
+bool TmFrameView::well_formed() const noexcept
+{
+    if (frame_.size() < primary_header_size)
+        return false;
+    return frame_.size() > primary_header_size + secondary_header_size() + trailer_size();
+}
+
+std::span<const std::byte> TmFrameView::data_field() const noexcept
+{
+    const std::size_t begin = primary_header_size + secondary_header_size();
+    return frame_.subspan(begin, frame_.size() - begin - trailer_size());
+}
+
+std::span<const std::byte> TmFrameView::ocf() const noexcept
+{
+    if (!ocf_flag())
+        return {};
+    const std::size_t end = frame_.size() - (fecf_present_ ? fecf_size : 0);
+    return frame_.subspan(end - ocf_size, ocf_size);
+}
+
+bool TmFrameView::fecf_ok() const noexcept
+{
+    if (!fecf_present_)
+        return true;
+    const std::size_t body = frame_.size() - fecf_size;
+    return crc16_ccitt(frame_.first(body)) == load_be16(frame_.data() + body);
+}
+
+} // namespace solarlens::ingest
@@ -0,0 +1,32 @@
+#include "solarlens/ingest/contact_pass.hpp"
+
+#include <algorithm>
+
+namespace solarlens::ingest {
+
+ContactPass::ContactPass(core::SlabPool& pool)
+    : arena_(pool)
+    , packets_(&arena_)
+{
+}
+
+void ContactPass::keep(std::span<const PacketRef> packets)
+{
+    for (const PacketRef& ref : packets) {
+        const std::span<const std::byte> src = ref.packet.bytes();
+        const std::span<std::byte> dst = arena_.allocate_array<std::byte>(src.size());
+        std::copy(src.begin(), src.end(), dst.begin());
+        packets_.push_back({dst, ref.spacecraft_id, ref.virtual_channel});
+        packet_bytes_ += src.size();
+    }
+}
+
+void ContactPass::reset() noexcept
+{
+    // The index lives in the arena too, so drop it before the memory goes.
+    std::pmr::vector<StoredPacket>(&arena_).swap(packets_);
+    arena_.reset();
+    packet_bytes_ = 0;
+}
+
+} // namespace solarlens::ingest
@@ -0,0 +1,46 @@
+#include "solarlens/ingest/frame_ring.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <stdexcept>
+
+namespace solarlens::ingest {
+
+FrameRing::FrameRing(std::size_t slot_count, std::size_t slot_size)
+    : mask_(std::bit_ceil(std::max<std::size_t>(slot_count, 1)) - 1)
+    , slot_size_(slot_size)
+    , stride_((slot_size + 63) / 64 * 64)
+    , lengths_(mask_ + 1, 0)
+{
+    if (slot_size == 0 || slot_size > UINT32_MAX)
+        throw std::invalid_argument("frame ring: bad slot size");
+    storage_.reset(static_cast<std::byte*>(
+        ::operator new[](stride_ * (mask_ + 1), std::align_val_t {4096})));
+}
+
+std::size_t FrameRing::writable() const noexcept
+{
+    const std::uint64_t head = head_.load(std::memory_order_relaxed);
+    const std::uint64_t tail = tail_.load(std::memory_order_acquire);
+    return slot_count() - static_cast<std::size_t>(head - tail);
+}
+
+void FrameRing::commit(std::size_t n) noexcept
+{
+    head_.store(head_.load(std::memory_order_relaxed) + n, std::memory_order_release);
+}
+
+std::size_t FrameRing::readable() const noexcept
+{
+    const std::uint64_t tail = tail_.load(std::memory_order_relaxed);
+    const std::uint64_t head = head_.load(std::memory_order_acquire);
+    return static_cast<std::size_t>(head - tail);
+}
+
+void FrameRing::release(std::size_t n) noexcept
+{
+    tail_.store(tail_.load(std::memory_order_relaxed) + n, std::memory_order_release);
+}
+
+} // namespace solarlens::ingest
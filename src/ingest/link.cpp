@@ -0,0 +1,44 @@
+#include "solarlens/ingest/link.hpp"
+
+#include <stdexcept>
+
+#include "solarlens/ingest/ccsds.hpp"
+#include "solarlens/ingest/randomizer.hpp"
+#include "solarlens/ingest/reed_solomon.hpp"
+
+namespace solarlens::ingest {
+
+void LinkConfig::validate() const
+{
+    const std::size_t trailer = fecf_present ? TmFrameView::fecf_size : 0;
+    if (frame_length <= TmFrameView::primary_header_size + trailer)
+        throw std::invalid_argument("link: frame length too short for its headers");
+    if (rs_interleave > 8)
+        throw std::invalid_argument("link: Reed-Solomon interleave depth must be 0..8");
+    if (rs_interleave != 0 &&
+        (frame_length % rs_interleave != 0 ||
+         frame_length > ReedSolomon::data_symbols * rs_interleave))
+        throw std::invalid_argument(
+            "link: frame length must be a multiple of the interleave depth and fit 223 * depth");
+    if (randomized && cadu_size() - (sync_marker ? attached_sync_marker.size() : 0) >
+                          max_randomized_length)
+        throw std::invalid_argument("link: CADU longer than the randomizer table");
+}
+
+std::size_t LinkConfig::rs_virtual_fill() const noexcept
+{
+    if (rs_interleave == 0)
+        return 0;
+    return ReedSolomon::data_symbols - frame_length / rs_interleave;
+}
+
+std::size_t LinkConfig::cadu_size() const noexcept
+{
+    const std::size_t coded =
+        rs_interleave == 0
+            ? frame_length
+            : frame_length + ReedSolomon::parity_symbols * rs_interleave;
+    return coded + (sync_marker ? attached_sync_marker.size() : 0);
+}
+
+} // namespace solarlens::ingest
@@ -0,0 +1,168 @@
+#include "solarlens/ingest/pass_recording.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace solarlens::ingest {
+
+namespace {
+
+constexpr std::array<char, 4> magic = {'S', 'L', 'P', 'R'};
+constexpr std::size_t header_size = 32;
+
+std::array<std::byte, header_size> encode_header(const LinkConfig& link, std::uint64_t count)
+{
+    std::array<std::byte, header_size> h {};
+    const auto frame_length = static_cast<std::uint32_t>(link.frame_length);
+    std::memcpy(h.data(), magic.data(), magic.size());
+    std::memcpy(h.data() + 4, &pass_recording_version, 4);
+    std::memcpy(h.data() + 8, &frame_length, 4);
+    h[12] = std::byte(link.sync_marker);
+    h[13] = std::byte(link.randomized);
+    h[14] = std::byte(link.fecf_present);
+    h[15] = std::byte(link.rs_interleave);
+    std::memcpy(h.data() + 16, &count, 8);
+    return h;
+}
+
+} // namespace
+
+PassRecorder::PassRecorder(const std::filesystem::path& path, const LinkConfig& link)
+    : link_(link)
+{
+    link_.validate();
+    file_ = core::File(path, core::File::Mode::write);
+    file_.write(encode_header(link_, 0));
+    record_.resize(8 + link_.cadu_size());
+}
+
+PassRecorder::~PassRecorder()
+{
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+void PassRecorder::append(std::uint64_t arrival_ns, std::span<const std::byte> cadu)
+{
+    if (cadu.size() != link_.cadu_size())
+        throw std::invalid_argument("pass recording: CADU size does not match the link");
+    if (count_ == 0)
+        first_ns_ = last_ns_ = arrival_ns;
+    if (arrival_ns < last_ns_)
+        throw std::invalid_argument("pass recording: arrival times must not decrease");
+    last_ns_ = arrival_ns;
+    const std::uint64_t at = arrival_ns - first_ns_;
+    std::memcpy(record_.data(), &at, 8);
+    std::copy(cadu.begin(), cadu.end(), record_.begin() + 8);
+    file_.write(record_);
+    ++count_;
+}
+
+void PassRecorder::close()
+{
+    if (!file_.is_open())
+        return;
+    file_.pwrite(encode_header(link_, count_), 0);
+    file_.close();
+}
+
+PassRecording::PassRecording(const std::filesystem::path& path)
+    : file_(path)
+{
+    const std::span<const std::byte> bytes = file_.bytes();
+    const std::string name = path.string();
+    if (bytes.size() < header_size || std::memcmp(bytes.data(), magic.data(), magic.size()) != 0)
+        throw std::runtime_error("pass recording: bad magic in " + name);
+    std::uint32_t version = 0;
+    std::uint32_t frame_length = 0;
+    std::uint64_t count = 0;
+    std::memcpy(&version, bytes.data() + 4, 4);
+    std::memcpy(&frame_length, bytes.data() + 8, 4);
+    std::memcpy(&count, bytes.data() + 16, 8);
+    if (version != pass_recording_version)
+        throw std::runtime_error("pass recording: unsupported version in " + name);
+    link_.frame_length = frame_length;
+    link_.sync_marker = bytes[12] != std::byte {0};
+    link_.randomized = bytes[13] != std::byte {0};
+    link_.fecf_present = bytes[14] != std::byte {0};
+    link_.rs_interleave = static_cast<unsigned>(bytes[15]);
+    try {
+        link_.validate();
+    } catch (const std::invalid_argument& e) {
+        throw std::runtime_error("pass recording: " + name + ": " + e.what());
+    }
+    record_size_ = 8 + link_.cadu_size();
+    if ((bytes.size() - header_size) / record_size_ < count)
+        throw std::runtime_error("pass recording: truncated " + name);
+    count_ = static_cast<std::size_t>(count);
+    for (std::size_t i = 1; i < count_; ++i)
+        if (arrival_ns(i) < arrival_ns(i - 1))
+            throw std::runtime_error("pass recording: arrival times out of order in " + name);
+}
+
+const std::byte* PassRecording::record(std::size_t i) const noexcept
+{
+    return file_.bytes().data() + header_size + i * record_size_;
+}
+
+std::uint64_t PassRecording::arrival_ns(std::size_t i) const noexcept
+{
+    std::uint64_t t = 0;
+    std::memcpy(&t, record(i), 8);
+    return t;
+}
+
+std::span<const std::byte> PassRecording::cadu(std::size_t i) const noexcept
+{
+    return {record(i) + 8, record_size_ - 8};
+}
+
+PassReplay::PassReplay(const PassRecording& recording, std::uint64_t batch_ns)
+    : recording_(recording)
+    , batch_ns_(batch_ns)
+{
+    if (batch_ns_ == 0)
+        throw std::invalid_argument("pass replay: batch window must be positive");
+}
+
+bool PassReplay::next()
+{
+    const std::size_t total = recording_.count();
+    if (next_ == total)
+        return false;
+    // The window holding the next arrival; windows are aligned to the
+    // first CADU, so the batching depends only on the recording.
+    const std::uint64_t window = recording_.arrival_ns(next_) / batch_ns_;
+    now_ns_ = (window + 1) * batch_ns_;
+    std::size_t end = next_;
+    while (end < total && recording_.arrival_ns(end) < now_ns_)
+        ++end;
+
+    const std::size_t size = recording_.link().cadu_size();
+    buffer_.resize((end - next_) * size);
+    cadus_.clear();
+    for (std::size_t i = next_; i < end; ++i) {
+        const std::span<const std::byte> src = recording_.cadu(i);
+        std::byte* dst = buffer_.data() + (i - next_) * size;
+        std::copy(src.begin(), src.end(), dst);
+        cadus_.emplace_back(dst, size);
+    }
+    next_ = end;
+    ++batches_;
+    return true;
+}
+
+void PassReplay::rewind() noexcept
+{
+    next_ = 0;
+    now_ns_ = 0;
+    batches_ = 0;
+    cadus_.clear();
+}
+
+} // namespace solarlens::ingest
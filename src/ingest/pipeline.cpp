@@ -0,0 +1,233 @@
+#include "solarlens/ingest/pipeline.hpp"
+
+#include <algorithm>
+
+#include "solarlens/ingest/randomizer.hpp"
+#include "solarlens/perf/instrument.hpp"
+#include "solarlens/sched/scheduler.hpp"
+
+namespace solarlens::ingest {
+
+IngestPipeline::IngestPipeline(const LinkConfig& link, sched::Scheduler* scheduler,
+                               core::SlabPool& pool)
+    : link_(link)
+    , scheduler_(scheduler)
+    , batch_arena_(pool)
+{
+    link_.validate();
+    if (link_.rs_interleave != 0)
+        rs_.emplace(link_.rs_interleave, link_.rs_virtual_fill());
+}
+
+std::size_t IngestPipeline::drain(FrameRing& ring, const PacketSink& sink)
+{
+    const std::size_t n = ring.readable();
+    if (n == 0)
+        return 0;
+    drained_.clear();
+    for (std::size_t i = 0; i < n; ++i)
+        drained_.push_back(ring.read_slot(i));
+    process(drained_, sink);
+    ring.release(n);
+    return n;
+}
+
+void IngestPipeline::process(std::span<const std::span<std::byte>> cadus, const PacketSink& sink)
+{
+    static const perf::Stage batch_stage("ingest.batch");
+    static const perf::Stage derandomize_stage("ingest.derandomize");
+    static const perf::Stage rs_stage("ingest.reed_solomon");
+    static const perf::Stage extract_stage("ingest.extract");
+    static const perf::Stage sink_stage("ingest.sink");
+    const perf::ScopedTimer batch_timer(batch_stage);
+    frames_.clear();
+    out_.clear();
+    batch_arena_.reset();
+
+    for (std::span<std::byte> cadu : cadus) {
+        ++stats_.cadus;
+        const std::span<std::byte> coded = strip(cadu);
+        if (!coded.empty())
+            frames_.push_back(coded);
+    }
+
+    if (link_.randomized) {
+        const perf::ScopedTimer timer(derandomize_stage);
+        derandomize_batch(frames_);
+    }
+
+    fixed_.assign(frames_.size(), 0);
+    if (rs_) {
+        const perf::ScopedTimer timer(rs_stage);
+        correct(frames_, fixed_);
+    }
+
+    {
+        const perf::ScopedTimer timer(extract_stage);
+        for (std::size_t i = 0; i < frames_.size(); ++i) {
+            if (fixed_[i] < 0) {
+                ++stats_.rs_failed;
+                continue;
+            }
+            stats_.rs_corrected += static_cast<std::uint64_t>(fixed_[i]);
+            const TmFrameView frame(frames_[i].first(link_.frame_length), link_.fecf_present);
+            if (!frame.well_formed() || frame.version() != 0) {
+                ++stats_.bad_header;
+                continue;
+            }
+            if (!frame.fecf_ok()) {
+                ++stats_.crc_failed;
+                continue;
+            }
+            ++stats_.frames;
+            extract(frame);
+        }
+    }
+
+    if (!out_.empty()) {
+        const perf::ScopedTimer timer(sink_stage);
+        sink(out_);
+    }
+}
+
+std::span<std::byte> IngestPipeline::strip(std::span<std::byte> cadu)
+{
+    if (cadu.size() != link_.cadu_size()) {
+        ++stats_.bad_length;
+        return {};
+    }
+    if (!link_.sync_marker)
+        return cadu;
+    if (!std::equal(attached_sync_marker.begin(), attached_sync_marker.end(), cadu.begin())) {
+        ++stats_.bad_sync;
+        return {};
+    }
+    return cadu.subspan(attached_sync_marker.size());
+}
+
+void IngestPipeline::correct(std::span<const std::span<std::byte>> frames, std::span<int> fixed)
+{
+    const ReedSolomon& rs = *rs_;
+    auto decode = [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t i = lo; i < hi; ++i)
+            fixed[i] = rs.decode(frames[i]);
+    };
+    if (scheduler_ && frames.size() > 1)
+        sched::parallel_for(*scheduler_, 0, frames.size(), 1, decode);
+    else
+        decode(0, frames.size());
+}
+
+void IngestPipeline::extract(const TmFrameView& frame)
+{
+    const std::uint32_t key = std::uint32_t(frame.spacecraft_id()) << 3 | frame.virtual_channel();
+    Channel& ch = channels_[key];
+    const std::uint8_t count = frame.virtual_channel_count();
+    if (ch.last_count && static_cast<std::uint8_t>(*ch.last_count + 1) != count) {
+        ++stats_.vc_gaps;
+        drop_partial(ch);
+    }
+    ch.last_count = count;
+
+    // Non-packet-synchronous data has no packet boundaries to follow.
+    if (frame.sync_flag())
+        return;
+
+    const std::uint16_t fhp = frame.first_header_pointer();
+    if (fhp == TmFrameView::fhp_idle) {
+        ++stats_.idle_frames;
+        return;
+    }
+    const std::span<const std::byte> data = frame.data_field();
+    const bool has_start = fhp != TmFrameView::fhp_no_packet_start;
+    if (has_start && fhp >= data.size()) {
+        ++stats_.bad_header;
+        drop_partial(ch);
+        return;
+    }
+
+    if (!ch.partial.empty())
+        continue_partial(ch, data.first(has_start ? fhp : data.size()), has_start, frame);
+    if (!has_start)
+        return;
+
+    std::size_t offset = fhp;
+    while (offset < data.size()) {
+        const std::span<const std::byte> rest = data.subspan(offset);
+        if (rest.size() < SpacePacketView::primary_header_size) {
+            start_partial(ch, rest);
+            break;
+        }
+        const std::size_t length = SpacePacketView::length_from_header(rest.data());
+        if (length > rest.size()) {
+            start_partial(ch, rest);
+            break;
+        }
+        deliver(rest.first(length), frame, false);
+        offset += length;
+    }
+}
+
+void IngestPipeline::continue_partial(Channel& ch, std::span<const std::byte> bytes, bool bounded,
+                                      const TmFrameView& frame)
+{
+    std::size_t used = 0;
+    if (ch.expected == 0) {
+        used = std::min(SpacePacketView::primary_header_size - ch.partial.size(), bytes.size());
+        ch.partial.insert(ch.partial.end(), bytes.begin(), bytes.begin() + used);
+        if (ch.partial.size() < SpacePacketView::primary_header_size) {
+            if (bounded)
+                drop_partial(ch);
+            return;
+        }
+        ch.expected = SpacePacketView::length_from_header(ch.partial.data());
+    }
+
+    const std::size_t take = std::min(ch.expected - ch.partial.size(), bytes.size() - used);
+    ch.partial.insert(ch.partial.end(), bytes.begin() + used, bytes.begin() + used + take);
+    used += take;
+
+    if (ch.partial.size() < ch.expected) {
+        // The first header pointer says a new packet starts before this
+        // one is complete: the pointer or an earlier frame is wrong.
+        if (bounded)
+            drop_partial(ch);
+        return;
+    }
+    const std::span<std::byte> packet = batch_arena_.allocate_array<std::byte>(ch.partial.size());
+    std::copy(ch.partial.begin(), ch.partial.end(), packet.begin());
+    ch.partial.clear();
+    ch.expected = 0;
+    deliver(packet, frame, true);
+}
+
+void IngestPipeline::start_partial(Channel& ch, std::span<const std::byte> bytes)
+{
+    ch.partial.assign(bytes.begin(), bytes.end());
+    ch.expected = bytes.size() >= SpacePacketView::primary_header_size
+                      ? SpacePacketView::length_from_header(bytes.data())
+                      : 0;
+}
+
+void IngestPipeline::drop_partial(Channel& ch)
+{
+    if (ch.partial.empty())
+        return;
+    ++stats_.packets_dropped;
+    ch.partial.clear();
+    ch.expected = 0;
+}
+
+void IngestPipeline::deliver(std::span<const std::byte> packet, const TmFrameView& frame,
+                             bool reassembled)
+{
+    const SpacePacketView view(packet);
+    if (view.is_idle())
+        return;
+    ++stats_.packets;
+    if (reassembled)
+        ++stats_.reassembled;
+    out_.push_back({view, frame.spacecraft_id(), frame.virtual_channel(), reassembled});
+}
+
+} // namespace solarlens::ingest
@@ -0,0 +1,82 @@
+#include "solarlens/ingest/randomizer.hpp"
+
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace solarlens::ingest {
+
+namespace {
+
+struct SequenceTable {
+    alignas(64) std::array<std::byte, max_randomized_length> bytes {};
+
+    SequenceTable()
+    {
+        // Fibonacci LFSR over h(x): output bit s0, feedback s0^s3^s5^s7.
+        unsigned state = 0xFF;
+        std::array<std::byte, 255> period {};
+        for (std::byte& out : period) {
+            unsigned value = 0;
+            for (int bit = 0; bit < 8; ++bit) {
+                const unsigned s = state;
+                const unsigned fb = ((s >> 7) ^ (s >> 4) ^ (s >> 2) ^ s) & 1u;
+                value = (value << 1) | ((s >> 7) & 1u);
+                state = ((s << 1) | fb) & 0xFF;
+            }
+            out = static_cast<std::byte>(value);
+        }
+        for (std::size_t i = 0; i < bytes.size(); ++i)
+            bytes[i] = period[i % period.size()];
+    }
+};
+
+const SequenceTable& table()
+{
+    static const SequenceTable t;
+    return t;
+}
+
+void xor_sequence(std::span<std::byte> data, const std::byte* seq)
+{
+    std::byte* p = data.data();
+    const std::size_t n = data.size();
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        std::uint64_t a;
+        std::uint64_t b;
+        std::memcpy(&a, p + i, 8);
+        std::memcpy(&b, seq + i, 8);
+        a ^= b;
+        std::memcpy(p + i, &a, 8);
+    }
+    for (; i < n; ++i)
+        p[i] ^= seq[i];
+}
+
+} // namespace
+
+std::span<const std::byte> pseudo_random_sequence(std::size_t n)
+{
+    if (n > max_randomized_length)
+        throw std::invalid_argument("randomizer: block longer than the sequence table");
+    return std::span<const std::byte>(table().bytes).first(n);
+}
+
+void derandomize(std::span<std::byte> data)
+{
+    xor_sequence(data, pseudo_random_sequence(data.size()).data());
+}
+
+void derandomize_batch(std::span<const std::span<std::byte>> blocks)
+{
+    const std::byte* seq = table().bytes.data();
+    for (std::span<std::byte> block : blocks) {
+        if (block.size() > max_randomized_length)
+            throw std::invalid_argument("randomizer: block longer than the sequence table");
+        xor_sequence(block, seq);
+    }
+}
+
+} // namespace solarlens::ingest
@@ -0,0 +1,277 @@
+#include "solarlens/ingest/reed_solomon.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+
+namespace solarlens::ingest {
+
+namespace {
+
+// Conventional-basis codec after Phil Karn's decode_rs. Log tables use
+// `nn` as the log of zero.
+constexpr int mm = 8;
+constexpr int nn = 255;
+constexpr int a0 = nn;
+constexpr int gf_poly = 0x187;
+constexpr int fcr = 112;
+constexpr int prim = 11;
+constexpr int iprim = 116;
+constexpr int nroots = static_cast<int>(ReedSolomon::parity_symbols);
+
+constexpr int modnn(int x)
+{
+    while (x >= nn) {
+        x -= nn;
+        x = (x >> mm) + (x & nn);
+    }
+    return x;
+}
+
+struct Tables {
+    std::array<std::uint8_t, 256> alpha_to {};
+    std::array<std::uint8_t, 256> index_of {};
+    std::array<std::uint8_t, nroots + 1> genpoly {};
+    std::array<std::uint8_t, 256> to_dual {};
+    std::array<std::uint8_t, 256> from_dual {};
+
+    Tables()
+    {
+        index_of[0] = a0;
+        alpha_to[a0] = 0;
+        int sr = 1;
+        for (int i = 0; i < nn; ++i) {
+            index_of[sr] = static_cast<std::uint8_t>(i);
+            alpha_to[i] = static_cast<std::uint8_t>(sr);
+            sr <<= 1;
+            if (sr & 0x100)
+                sr ^= gf_poly;
+            sr &= nn;
+        }
+
+        genpoly[0] = 1;
+        for (int i = 0, root = fcr * prim; i < nroots; ++i, root += prim) {
+            genpoly[i + 1] = 1;
+            for (int j = i; j > 0; --j) {
+                if (genpoly[j] != 0)
+                    genpoly[j] = genpoly[j - 1] ^ alpha_to[modnn(index_of[genpoly[j]] + root)];
+                else
+                    genpoly[j] = genpoly[j - 1];
+            }
+            genpoly[0] = alpha_to[modnn(index_of[genpoly[0]] + root)];
+        }
+        for (auto& g : genpoly)
+            g = index_of[g];
+
+        // Berlekamp's dual-basis transform, rows of the CCSDS T matrix.
+        static constexpr std::uint8_t tal[8] = {0x8d, 0xef, 0xec, 0x86, 0xfa, 0x99, 0xaf, 0x7b};
+        for (int i = 0; i < 256; ++i) {
+            int v = 0;
+            for (int j = 0; j < 8; ++j)
+                for (int k = 0; k < 8; ++k)
+                    if (i & (1 << k))
+                        v ^= tal[7 - k] & (1 << j);
+            to_dual[i] = static_cast<std::uint8_t>(v);
+            from_dual[v] = static_cast<std::uint8_t>(i);
+        }
+    }
+};
+
+const Tables& tables()
+{
+    static const Tables t;
+    return t;
+}
+
+void encode_codeword(const Tables& t, const std::uint8_t* data, int pad, std::uint8_t* parity)
+{
+    std::memset(parity, 0, nroots);
+    for (int i = 0; i < nn - nroots - pad; ++i) {
+        const int feedback = t.index_of[data[i] ^ parity[0]];
+        if (feedback != a0)
+            for (int j = 1; j < nroots; ++j)
+                parity[j] ^= t.alpha_to[modnn(feedback + t.genpoly[nroots - j])];
+        std::memmove(parity, parity + 1, nroots - 1);
+        parity[nroots - 1] = feedback != a0 ? t.alpha_to[modnn(feedback + t.genpoly[0])] : 0;
+    }
+}
+
+/// Returns corrections made, or -1 if uncorrectable (data untouched).
+int decode_codeword(const Tables& t, std::uint8_t* data, int pad)
+{
+    std::array<int, nroots> s {};
+    for (int i = 0; i < nroots; ++i)
+        s[i] = data[0];
+    for (int j = 1; j < nn - pad; ++j)
+        for (int i = 0; i < nroots; ++i)
+            s[i] = s[i] == 0 ? data[j]
+                             : data[j] ^ t.alpha_to[modnn(t.index_of[s[i]] + (fcr + i) * prim)];
+
+    int syn_error = 0;
+    for (int& si : s) {
+        syn_error |= si;
+        si = t.index_of[si];
+    }
+    if (!syn_error)
+        return 0;
+
+    // Berlekamp-Massey for the error locator.
+    std::array<int, nroots + 1> lambda {};
+    std::array<int, nroots + 1> b {};
+    std::array<int, nroots + 1> tmp {};
+    lambda[0] = 1;
+    for (int i = 0; i <= nroots; ++i)
+        b[i] = t.index_of[lambda[i]];
+    int el = 0;
+    for (int r = 1; r <= nroots; ++r) {
+        int discr = 0;
+        for (int i = 0; i < r; ++i)
+            if (lambda[i] != 0 && s[r - i - 1] != a0)
+                discr ^= t.alpha_to[modnn(t.index_of[lambda[i]] + s[r - i - 1])];
+        discr = t.index_of[discr];
+        if (discr == a0) {
+            std::memmove(&b[1], &b[0], nroots * sizeof(int));
+            b[0] = a0;
+            continue;
+        }
+        tmp[0] = lambda[0];
+        for (int i = 0; i < nroots; ++i)
+            tmp[i + 1] = b[i] != a0 ? lambda[i + 1] ^ t.alpha_to[modnn(discr + b[i])] : lambda[i + 1];
+        if (2 * el <= r - 1) {
+            el = r - el;
+            for (int i = 0; i <= nroots; ++i)
+                b[i] = lambda[i] == 0 ? a0 : modnn(t.index_of[lambda[i]] - discr + nn);
+        } else {
+            std::memmove(&b[1], &b[0], nroots * sizeof(int));
+            b[0] = a0;
+        }
+        lambda = tmp;
+    }
+
+    int deg_lambda = 0;
+    for (int i = 0; i <= nroots; ++i) {
+        lambda[i] = t.index_of[lambda[i]];
+        if (lambda[i] != a0)
+            deg_lambda = i;
+    }
+    if (deg_lambda == 0)
+        return -1;
+
+    // Chien search for the roots of the locator.
+    std::array<int, nroots + 1> reg {};
+    std::array<int, nroots> root {};
+    std::array<int, nroots> loc {};
+    std::copy(lambda.begin() + 1, lambda.end(), reg.begin() + 1);
+    int count = 0;
+    for (int i = 1, k = iprim - 1; i <= nn; ++i, k = modnn(k + iprim)) {
+        int q = 1;
+        for (int j = deg_lambda; j > 0; --j)
+            if (reg[j] != a0) {
+                reg[j] = modnn(reg[j] + j);
+                q ^= t.alpha_to[reg[j]];
+            }
+        if (q != 0)
+            continue;
+        root[count] = i;
+        loc[count] = k;
+        if (++count == deg_lambda)
+            break;
+    }
+    if (count != deg_lambda)
+        return -1;
+    for (int j = 0; j < count; ++j)
+        if (loc[j] < pad)
+            return -1;
+
+    // Error evaluator and Forney's formula.
+    const int deg_omega = deg_lambda - 1;
+    std::array<int, nroots + 1> omega {};
+    for (int i = 0; i <= deg_omega; ++i) {
+        int acc = 0;
+        for (int j = i; j >= 0; --j)
+            if (s[i - j] != a0 && lambda[j] != a0)
+                acc ^= t.alpha_to[modnn(s[i - j] + lambda[j])];
+        omega[i] = t.index_of[acc];
+    }
+    std::array<std::uint8_t, nroots> fix {};
+    for (int j = 0; j < count; ++j) {
+        int num1 = 0;
+        for (int i = deg_omega; i >= 0; --i)
+            if (omega[i] != a0)
+                num1 ^= t.alpha_to[modnn(omega[i] + i * root[j])];
+        const int num2 = t.alpha_to[modnn(root[j] * (fcr - 1) + nn)];
+        int den = 0;
+        for (int i = std::min(deg_lambda, nroots - 1) & ~1; i >= 0; i -= 2)
+            if (lambda[i + 1] != a0)
+                den ^= t.alpha_to[modnn(lambda[i + 1] + i * root[j])];
+        if (den == 0)
+            return -1;
+        fix[j] = num1 == 0 ? 0
+                           : t.alpha_to[modnn(t.index_of[num1] + t.index_of[num2] + nn -
+                                              t.index_of[den])];
+    }
+    for (int j = 0; j < count; ++j)
+        data[loc[j] - pad] ^= fix[j];
+    return count;
+}
+
+} // namespace
+
+ReedSolomon::ReedSolomon(unsigned interleave, std::size_t virtual_fill)
+    : interleave_(interleave)
+    , fill_(virtual_fill)
+{
+    if (interleave_ < 1 || interleave_ > 8)
+        throw std::invalid_argument("reed-solomon: interleave depth must be 1..8");
+    if (fill_ >= data_symbols)
+        throw std::invalid_argument("reed-solomon: virtual fill leaves no data");
+}
+
+void ReedSolomon::encode(std::span<std::byte> codeblock) const
+{
+    if (codeblock.size() != codeblock_size())
+        throw std::invalid_argument("reed-solomon: codeblock size mismatch");
+    const Tables& t = tables();
+    const std::size_t k = data_symbols - fill_;
+    auto* bytes = reinterpret_cast<std::uint8_t*>(codeblock.data());
+    std::uint8_t word[symbols];
+    std::uint8_t parity[parity_symbols];
+    for (unsigned c = 0; c < interleave_; ++c) {
+        for (std::size_t i = 0; i < k; ++i)
+            word[i] = t.from_dual[bytes[i * interleave_ + c]];
+        encode_codeword(t, word, static_cast<int>(fill_), parity);
+        for (std::size_t i = 0; i < parity_symbols; ++i)
+            bytes[(k + i) * interleave_ + c] = t.to_dual[parity[i]];
+    }
+}
+
+int ReedSolomon::decode(std::span<std::byte> codeblock) const
+{
+    if (codeblock.size() != codeblock_size())
+        throw std::invalid_argument("reed-solomon: codeblock size mismatch");
+    const Tables& t = tables();
+    const std::size_t n = symbols - fill_;
+    auto* bytes = reinterpret_cast<std::uint8_t*>(codeblock.data());
+    std::uint8_t word[symbols];
+    int total = 0;
+    bool failed = false;
+    for (unsigned c = 0; c < interleave_; ++c) {
+        for (std::size_t i = 0; i < n; ++i)
+            word[i] = t.from_dual[bytes[i * interleave_ + c]];
+        const int fixed = decode_codeword(t, word, static_cast<int>(fill_));
+        if (fixed < 0) {
+            failed = true;
+            continue;
+        }
+        if (fixed == 0)
+            continue;
+        total += fixed;
+        for (std::size_t i = 0; i < n; ++i)
+            bytes[i * interleave_ + c] = t.to_dual[word[i]];
+    }
+    return failed ? -1 : total;
+}
+
+} // namespace solarlens::ingest
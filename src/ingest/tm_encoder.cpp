@@ -0,0 +1,127 @@
+#include "solarlens/ingest/tm_encoder.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "solarlens/ingest/ccsds.hpp"
+#include "solarlens/ingest/randomizer.hpp"
+
+namespace solarlens::ingest {
+
+namespace {
+
+constexpr std::size_t header_size = TmFrameView::primary_header_size;
+
+} // namespace
+
+TmEncoder::TmEncoder(const LinkConfig& link, std::uint16_t spacecraft_id,
+                     std::uint8_t virtual_channel)
+    : link_(link)
+    , spacecraft_id_(spacecraft_id)
+    , virtual_channel_(virtual_channel)
+    , cadu_(link.cadu_size())
+    , first_header_(TmFrameView::fhp_no_packet_start)
+{
+    link_.validate();
+    if (spacecraft_id_ > 0x3FF || virtual_channel_ > 7)
+        throw std::invalid_argument("tm encoder: spacecraft or virtual channel id out of range");
+    if (link_.rs_interleave != 0)
+        rs_.emplace(link_.rs_interleave, link_.rs_virtual_fill());
+    if (link_.sync_marker)
+        std::copy(attached_sync_marker.begin(), attached_sync_marker.end(), cadu_.begin());
+}
+
+std::size_t TmEncoder::capacity() const noexcept
+{
+    return link_.frame_length - header_size - (link_.fecf_present ? TmFrameView::fecf_size : 0);
+}
+
+void TmEncoder::add_packet(std::span<const std::byte> packet, const CaduSink& sink)
+{
+    if (packet.size() < SpacePacketView::primary_header_size + 1 ||
+        SpacePacketView::length_from_header(packet.data()) != packet.size())
+        throw std::invalid_argument("tm encoder: packet length does not match its header");
+    append(packet, true, sink);
+}
+
+void TmEncoder::flush(const CaduSink& sink)
+{
+    if (fill_ == 0)
+        return;
+    // An idle packet needs seven bytes; if fewer remain it spills into a
+    // frame of its own.
+    std::size_t length = capacity() - fill_;
+    if (length < SpacePacketView::primary_header_size + 1)
+        length += capacity();
+    std::vector<std::byte> idle(length);
+    store_be16(idle.data(), SpacePacketView::idle_apid);
+    store_be16(idle.data() + 2, 0xC000);
+    store_be16(idle.data() + 4, static_cast<std::uint16_t>(length - SpacePacketView::primary_header_size - 1));
+    append(idle, true, sink);
+}
+
+void TmEncoder::emit_idle(const CaduSink& sink)
+{
+    flush(sink);
+    first_header_ = TmFrameView::fhp_idle;
+    fill_ = capacity();
+    finish_frame(sink);
+}
+
+void TmEncoder::append(std::span<const std::byte> bytes, bool packet_start, const CaduSink& sink)
+{
+    std::byte* data = cadu_.data() + (link_.sync_marker ? attached_sync_marker.size() : 0) + header_size;
+    while (!bytes.empty()) {
+        if (packet_start && first_header_ == TmFrameView::fhp_no_packet_start)
+            first_header_ = static_cast<std::uint16_t>(fill_);
+        packet_start = false;
+        const std::size_t take = std::min(bytes.size(), capacity() - fill_);
+        std::copy_n(bytes.data(), take, data + fill_);
+        fill_ += take;
+        bytes = bytes.subspan(take);
+        if (fill_ == capacity())
+            finish_frame(sink);
+    }
+}
+
+void TmEncoder::finish_frame(const CaduSink& sink)
+{
+    const std::size_t asm_size = link_.sync_marker ? attached_sync_marker.size() : 0;
+    const std::span<std::byte> coded = std::span<std::byte>(cadu_).subspan(asm_size);
+    std::byte* frame = coded.data();
+
+    const auto count = static_cast<std::uint8_t>(frames_);
+    store_be16(frame, static_cast<std::uint16_t>((spacecraft_id_ << 4) | (virtual_channel_ << 1)));
+    frame[2] = static_cast<std::byte>(count);
+    frame[3] = static_cast<std::byte>(count);
+    // Secondary header off, packet-synchronous, segment length id 0b11.
+    store_be16(frame + 4, static_cast<std::uint16_t>(0x1800 | first_header_));
+    if (link_.fecf_present) {
+        const std::size_t body = link_.frame_length - TmFrameView::fecf_size;
+        store_be16(frame + body, crc16_ccitt(coded.first(body)));
+    }
+    if (rs_)
+        rs_->encode(coded);
+    if (link_.randomized)
+        derandomize(coded);
+
+    sink(cadu_);
+    ++frames_;
+    fill_ = 0;
+    first_header_ = TmFrameView::fhp_no_packet_start;
+}
+
+std::vector<std::byte> make_space_packet(std::uint16_t apid, std::uint16_t sequence_count,
+                                         std::span<const std::byte> data)
+{
+    if (data.empty() || data.size() > 65536)
+        throw std::invalid_argument("space packet: data field must be 1..65536 bytes");
+    std::vector<std::byte> packet(SpacePacketView::primary_header_size + data.size());
+    store_be16(packet.data(), static_cast<std::uint16_t>(apid & 0x7FF));
+    store_be16(packet.data() + 2, static_cast<std::uint16_t>(0xC000 | (sequence_count & 0x3FFF)));
+    store_be16(packet.data() + 4, static_cast<std::uint16_t>(data.size() - 1));
+    std::copy(data.begin(), data.end(), packet.begin() + SpacePacketView::primary_header_size);
+    return packet;
+}
+
+} // namespace solarlens::ingest
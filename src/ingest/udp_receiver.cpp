@@ -0,0 +1,118 @@
+#include "solarlens/ingest/udp_receiver.hpp"
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+
+namespace solarlens::ingest {
+
+namespace {
+
+[[noreturn]] void fail(const char* what)
+{
+    throw std::system_error(errno, std::generic_category(), what);
+}
+
+} // namespace
+
+UdpReceiver::UdpReceiver(const std::string& address, std::uint16_t port,
+                         int receive_buffer_bytes)
+{
+    fd_ = ::socket(AF_INET, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+    if (fd_ < 0)
+        fail("udp receiver: socket");
+    try {
+        ::setsockopt(fd_, SOL_SOCKET, SO_RCVBUF, &receive_buffer_bytes, sizeof receive_buffer_bytes);
+        sockaddr_in addr {};
+        addr.sin_family = AF_INET;
+        addr.sin_port = htons(port);
+        if (::inet_pton(AF_INET, address.c_str(), &addr.sin_addr) != 1) {
+            errno = EINVAL;
+            fail(("udp receiver: bad address " + address).c_str());
+        }
+        if (::bind(fd_, reinterpret_cast<const sockaddr*>(&addr), sizeof addr) != 0)
+            fail("udp receiver: bind");
+        socklen_t len = sizeof addr;
+        if (::getsockname(fd_, reinterpret_cast<sockaddr*>(&addr), &len) != 0)
+            fail("udp receiver: getsockname");
+        port_ = ntohs(addr.sin_port);
+    } catch (...) {
+        ::close(fd_);
+        throw;
+    }
+}
+
+UdpReceiver::~UdpReceiver()
+{
+    if (fd_ >= 0)
+        ::close(fd_);
+}
+
+std::size_t UdpReceiver::receive(FrameRing& ring, int timeout_ms, std::size_t max_batch)
+{
+    const std::size_t batch = std::min(ring.writable(), max_batch);
+    if (batch == 0)
+        return 0;
+
+    if (timeout_ms > 0) {
+        pollfd p {fd_, POLLIN, 0};
+        const int ready = ::poll(&p, 1, timeout_ms);
+        if (ready < 0 && errno != EINTR)
+            fail("udp receiver: poll");
+        if (ready <= 0)
+            return 0;
+    }
+
+    // Sized once to the ring, so receiving never allocates.
+    if (iov_.size() < ring.slot_count()) {
+        iov_.resize(ring.slot_count());
+        msgs_.resize(ring.slot_count());
+    }
+    for (std::size_t i = 0; i < batch; ++i) {
+        const std::span<std::byte> slot = ring.write_slot(i);
+        iov_[i] = {slot.data(), slot.size()};
+        msgs_[i] = {};
+        msgs_[i].msg_hdr.msg_iov = &iov_[i];
+        msgs_[i].msg_hdr.msg_iovlen = 1;
+    }
+
+    // Block for the first datagram only, then take whatever else is queued.
+    const int flags = timeout_ms == 0 ? MSG_DONTWAIT : MSG_WAITFORONE;
+    int got;
+    do {
+        got = ::recvmmsg(fd_, msgs_.data(), static_cast<unsigned>(batch), flags, nullptr);
+    } while (got < 0 && errno == EINTR);
+    ++stats_.syscalls;
+    if (got < 0) {
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return 0;
+        fail("udp receiver: recvmmsg");
+    }
+
+    // Truncated datagrams are compacted out so committed slots stay dense.
+    std::size_t kept = 0;
+    for (int i = 0; i < got; ++i) {
+        if (msgs_[i].msg_hdr.msg_flags & MSG_TRUNC) {
+            ++stats_.truncated;
+            continue;
+        }
+        if (kept != static_cast<std::size_t>(i)) {
+            const std::span<std::byte> from = ring.write_slot(i);
+            std::copy_n(from.data(), msgs_[i].msg_len, ring.write_slot(kept).data());
+        }
+        ring.set_length(kept, msgs_[i].msg_len);
+        stats_.bytes += msgs_[i].msg_len;
+        ++kept;
+    }
+    stats_.datagrams += kept;
+    ring.commit(kept);
+    return kept;
+}
+
+} // namespace solarlens::ingest
@@ -0,0 +1,34 @@
+// AVX2 + FMA kernel: four observations per step.
+
+#include <immintrin.h>
+
+#include "harmonic_impl.hpp"
+
+namespace solarlens::lightcurve::detail {
+
+namespace {
+
+struct Avx2 {
+    using reg = __m256d;
+    static constexpr std::size_t lanes = 4;
+    static reg load(const double* p) noexcept { return _mm256_loadu_pd(p); }
+    static void store(double* p, reg v) noexcept { _mm256_storeu_pd(p, v); }
+    static reg zero() noexcept { return _mm256_setzero_pd(); }
+    static reg mul(reg a, reg b) noexcept { return _mm256_mul_pd(a, b); }
+    static reg fmadd(reg a, reg b, reg c) noexcept { return _mm256_fmadd_pd(a, b, c); }
+    static reg fnmadd(reg a, reg b, reg c) noexcept { return _mm256_fnmadd_pd(a, b, c); }
+    static double reduce(reg v) noexcept
+    {
+        const __m128d pair = _mm_add_pd(_mm256_castpd256_pd128(v), _mm256_extractf128_pd(v, 1));
+        return _mm_cvtsd_f64(_mm_add_sd(pair, _mm_unpackhi_pd(pair, pair)));
+    }
+};
+
+} // namespace
+
+void harmonic_avx2(const HarmonicArgs& args)
+{
+    dispatch_harmonics<Avx2>(args);
+}
+
+} // namespace solarlens::lightcurve::detail
@@ -0,0 +1,36 @@
+// AVX-512F kernel: eight observations per step.
+
+#include <immintrin.h>
+
+#include "harmonic_impl.hpp"
+
+namespace solarlens::lightcurve::detail {
+
+namespace {
+
+struct Avx512 {
+    using reg = __m512d;
+    static constexpr std::size_t lanes = 8;
+    static reg load(const double* p) noexcept { return _mm512_loadu_pd(p); }
+    static void store(double* p, reg v) noexcept { _mm512_storeu_pd(p, v); }
+    static reg zero() noexcept { return _mm512_setzero_pd(); }
+    static reg mul(reg a, reg b) noexcept { return _mm512_mul_pd(a, b); }
+    static reg fmadd(reg a, reg b, reg c) noexcept { return _mm512_fmadd_pd(a, b, c); }
+    static reg fnmadd(reg a, reg b, reg c) noexcept { return _mm512_fnmadd_pd(a, b, c); }
+    static double reduce(reg v) noexcept
+    {
+        // Through memory: GCC 12's _mm512_reduce_add_pd trips -Wmaybe-uninitialized.
+        alignas(64) double lane[lanes];
+        _mm512_store_pd(lane, v);
+        return ((lane[0] + lane[4]) + (lane[2] + lane[6])) + ((lane[1] + lane[5]) + (lane[3] + lane[7]));
+    }
+};
+
+} // namespace
+
+void harmonic_avx512(const HarmonicArgs& args)
+{
+    dispatch_harmonics<Avx512>(args);
+}
+
+} // namespace solarlens::lightcurve::detail
@@ -0,0 +1,83 @@
+#pragma once
+
+// The harmonic accumulation loop, written once over a vector traits type
+// V and included by each per-ISA translation unit with its own V:
+//
+//   V::lanes, V::reg, load, store, set1, zero, add, mul, fmadd(a, b, c)
+//   = a * b + c, fnmadd(a, b, c) = c - a * b, and reduce (horizontal sum).
+
+#include "harmonic_kernels.hpp"
+
+namespace solarlens::lightcurve::detail {
+
+template <typename V, std::size_t K>
+void accumulate(const HarmonicArgs& a)
+{
+    using R = typename V::reg;
+    constexpr std::size_t h = 2 * K;
+    constexpr std::size_t gram = h * (h + 1) / 2;
+    constexpr std::size_t sums = sums_for(K);
+    for (std::size_t f = 0; f < a.frequencies; ++f) {
+        R acc[sums];
+        for (R& r : acc)
+            r = V::zero();
+        for (std::size_t i = 0; i < a.count; i += V::lanes) {
+            const R c = V::load(a.cos_phase + i);
+            const R s = V::load(a.sin_phase + i);
+            const R amp = V::load(a.amp + i);
+            R weight = V::mul(V::load(a.scale + i), amp);
+            R col[h];
+            R ck = c, sk = s;
+            col[0] = V::mul(weight, ck);
+            col[1] = V::mul(weight, sk);
+            for (std::size_t k = 1; k < K; ++k) {
+                const R next_c = V::fnmadd(sk, s, V::mul(ck, c));
+                sk = V::fmadd(ck, s, V::mul(sk, c));
+                ck = next_c;
+                weight = V::mul(weight, amp);
+                col[2 * k] = V::mul(weight, ck);
+                col[2 * k + 1] = V::mul(weight, sk);
+            }
+            std::size_t at = 0;
+            for (std::size_t p = 0; p < h; ++p)
+                for (std::size_t q = p; q < h; ++q, ++at)
+                    acc[at] = V::fmadd(col[p], col[q], acc[at]);
+            const R f0 = V::load(a.fixed0 + i);
+            const R f1 = V::load(a.fixed1 + i);
+            const R y = V::load(a.data + i);
+            for (std::size_t p = 0; p < h; ++p) {
+                acc[gram + p] = V::fmadd(f0, col[p], acc[gram + p]);
+                acc[gram + h + p] = V::fmadd(f1, col[p], acc[gram + h + p]);
+                acc[gram + 2 * h + p] = V::fmadd(y, col[p], acc[gram + 2 * h + p]);
+            }
+            const R cs = V::load(a.cos_step + i);
+            const R ss = V::load(a.sin_step + i);
+            V::store(a.cos_phase + i, V::fnmadd(s, ss, V::mul(c, cs)));
+            V::store(a.sin_phase + i, V::fmadd(c, ss, V::mul(s, cs)));
+        }
+        double* out = a.sums + f * sums;
+        for (std::size_t k = 0; k < sums; ++k)
+            out[k] = V::reduce(acc[k]);
+    }
+}
+
+template <typename V>
+void dispatch_harmonics(const HarmonicArgs& a)
+{
+    switch (a.harmonics) {
+    case 1:
+        accumulate<V, 1>(a);
+        break;
+    case 2:
+        accumulate<V, 2>(a);
+        break;
+    case 3:
+        accumulate<V, 3>(a);
+        break;
+    default:
+        accumulate<V, 4>(a);
+        break;
+    }
+}
+
+} // namespace solarlens::lightcurve::detail
@@ -0,0 +1,63 @@
+#pragma once
+
+// Per-ISA harmonic-fit accumulation kernels behind RotationSearch, built
+// per translation unit like the corona and transmission kernels.
+
+#include <cstddef>
+
+namespace solarlens::lightcurve::detail {
+
+inline constexpr std::size_t max_harmonics = 4;
+
+// Sums per trial frequency for `harmonics` harmonics (H = 2 * harmonics
+// columns): the upper triangle of the harmonic Gram matrix, row-major,
+// then the H cross products with each fixed column, then the H products
+// with the data.
+constexpr std::size_t sums_for(std::size_t harmonics) noexcept
+{
+    const std::size_t h = 2 * harmonics;
+    return h * (h + 1) / 2 + 3 * h;
+}
+
+inline constexpr std::size_t max_sums = sums_for(max_harmonics);
+
+// For each of `frequencies` consecutive trial frequencies and every
+// observation i of `count` (a multiple of 8; padding has zero scale and
+// data), with phasor z_i = cos_phase[i] + j sin_phase[i] and
+// a_i = scale[i] * amp[i]:
+//   column 2(k-1)     = a_i amp[i]^(k-1) Re z_i^k
+//   column 2(k-1) + 1 = a_i amp[i]^(k-1) Im z_i^k,   k = 1..harmonics
+// accumulates sums_for(harmonics) sums into sums[f * sums_for(harmonics)],
+// then advances z_i by the step phasor for the next frequency. The
+// phasors are left at the frequency after the last.
+struct HarmonicArgs {
+    std::size_t count = 0;
+    std::size_t harmonics = 1;
+    std::size_t frequencies = 0;
+    const double* fixed0 = nullptr;   // Fixed model columns, already / sigma.
+    const double* fixed1 = nullptr;
+    const double* data = nullptr;     // flux / sigma
+    const double* scale = nullptr;    // Harmonic column scale, already / sigma.
+    const double* amp = nullptr;      // Per-harmonic attenuation.
+    double* cos_phase = nullptr;
+    double* sin_phase = nullptr;
+    const double* cos_step = nullptr;
+    const double* sin_step = nullptr;
+    double* sums = nullptr;
+};
+
+using HarmonicFn = void (*)(const HarmonicArgs& args);
+
+void harmonic_scalar(const HarmonicArgs&);
+
+#if defined(SOLARLENS_HAVE_AVX2)
+void harmonic_avx2(const HarmonicArgs&);
+#endif
+#if defined(SOLARLENS_HAVE_AVX512)
+void harmonic_avx512(const HarmonicArgs&);
+#endif
+#if defined(SOLARLENS_HAVE_NEON)
+void harmonic_neon(const HarmonicArgs&);
+#endif
+
+} // namespace solarlens::lightcurve::detail
@@ -0,0 +1,30 @@
+// AArch64 NEON kernel: two observations per step.
+
+#include <arm_neon.h>
+
+#include "harmonic_impl.hpp"
+
+namespace solarlens::lightcurve::detail {
+
+namespace {
+
+struct Neon {
+    using reg = float64x2_t;
+    static constexpr std::size_t lanes = 2;
+    static reg load(const double* p) noexcept { return vld1q_f64(p); }
+    static void store(double* p, reg v) noexcept { vst1q_f64(p, v); }
+    static reg zero() noexcept { return vdupq_n_f64(0.0); }
+    static reg mul(reg a, reg b) noexcept { return vmulq_f64(a, b); }
+    static reg fmadd(reg a, reg b, reg c) noexcept { return vfmaq_f64(c, a, b); }
+    static reg fnmadd(reg a, reg b, reg c) noexcept { return vfmsq_f64(c, a, b); }
+    static double reduce(reg v) noexcept { return vaddvq_f64(v); }
+};
+
+} // namespace
+
+void harmonic_neon(const HarmonicArgs& args)
+{
+    dispatch_harmonics<Neon>(args);
+}
+
+} // namespace solarlens::lightcurve::detail
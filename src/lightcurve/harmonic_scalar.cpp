@@ -0,0 +1,28 @@
+// Portable reference kernel: one observation per step.
+
+#include "harmonic_impl.hpp"
+
+namespace solarlens::lightcurve::detail {
+
+namespace {
+
+struct Scalar {
+    using reg = double;
+    static constexpr std::size_t lanes = 1;
+    static reg load(const double* p) noexcept { return *p; }
+    static void store(double* p, reg v) noexcept { *p = v; }
+    static reg zero() noexcept { return 0.0; }
+    static reg mul(reg a, reg b) noexcept { return a * b; }
+    static reg fmadd(reg a, reg b, reg c) noexcept { return a * b + c; }
+    static reg fnmadd(reg a, reg b, reg c) noexcept { return c - a * b; }
+    static double reduce(reg v) noexcept { return v; }
+};
+
+} // namespace
+
+void harmonic_scalar(const HarmonicArgs& args)
+{
+    dispatch_harmonics<Scalar>(args);
+}
+
+} // namespace solarlens::lightcurve::detail
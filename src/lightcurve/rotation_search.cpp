@@ -0,0 +1,493 @@
+#include "solarlens/lightcurve/rotation_search.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "harmonic_kernels.hpp"
+#include "solarlens/perf/instrument.hpp"
+#include "solarlens/sched/scheduler.hpp"
+
+namespace solarlens::lightcurve {
+
+namespace {
+
+constexpr double pi = 3.14159265358979323846;
+constexpr double two_pi = 2.0 * pi;
+
+// Observation arrays are padded to the widest kernel.
+constexpr std::size_t pad_to = 8;
+
+// Phasors are reseeded exactly this often, keeping the recurrence's
+// rounding drift far below the fit's own.
+constexpr std::size_t reseed_every = 128;
+
+// Parabolic steps when polishing a peak, each a quarter of the last.
+constexpr int polish_rounds = 4;
+constexpr std::uint64_t polish_trials = 3 * polish_rounds + 1;
+
+detail::HarmonicFn kernel_for(core::SimdLevel level)
+{
+    switch (level) {
+#if defined(SOLARLENS_HAVE_AVX512)
+    case core::SimdLevel::avx512:
+        return detail::harmonic_avx512;
+#endif
+#if defined(SOLARLENS_HAVE_AVX2)
+    case core::SimdLevel::avx2:
+        return detail::harmonic_avx2;
+#endif
+#if defined(SOLARLENS_HAVE_NEON)
+    case core::SimdLevel::neon:
+        return detail::harmonic_neon;
+#endif
+    default:
+        return detail::harmonic_scalar;
+    }
+}
+
+struct Vec3 {
+    double x = 0.0, y = 0.0, z = 0.0;
+};
+
+double dot(const Vec3& a, const Vec3& b) noexcept
+{
+    return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+Vec3 cross(const Vec3& a, const Vec3& b) noexcept
+{
+    return {a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+// Solves for r^T G^-1 r with G symmetric positive semi-definite, h x h,
+// by Cholesky; columns that are numerically dependent on earlier ones are
+// dropped rather than failing.
+double quadratic_form(double* g, double* r, std::size_t h) noexcept
+{
+    double largest = 0.0;
+    for (std::size_t i = 0; i < h; ++i)
+        largest = std::max(largest, g[i * h + i]);
+    if (!(largest > 0.0))
+        return 0.0;
+    double q = 0.0;
+    for (std::size_t j = 0; j < h; ++j) {
+        double d = g[j * h + j];
+        for (std::size_t k = 0; k < j; ++k)
+            d -= g[j * h + k] * g[j * h + k];
+        if (!(d > 1e-12 * largest)) {
+            for (std::size_t i = j; i < h; ++i)
+                g[i * h + j] = 0.0;
+            r[j] = 0.0;
+            continue;
+        }
+        const double l = std::sqrt(d);
+        g[j * h + j] = l;
+        for (std::size_t i = j + 1; i < h; ++i) {
+            double v = g[i * h + j];
+            for (std::size_t k = 0; k < j; ++k)
+                v -= g[i * h + k] * g[j * h + k];
+            g[i * h + j] = v / l;
+        }
+        // Forward substitution as we go: z_j = (r_j - L_jk z_k) / L_jj.
+        double z = r[j];
+        for (std::size_t k = 0; k < j; ++k)
+            z -= g[j * h + k] * r[k];
+        r[j] = z / l;
+        q += r[j] * r[j];
+    }
+    return q;
+}
+
+} // namespace
+
+struct RotationSearch::Prepared {
+    std::size_t count = 0;           // Padded.
+    double baseline = 0.0;           // Days.
+    std::vector<double> t;           // Days since the first sample.
+    std::vector<double> fixed0, fixed1, data, scale;
+    double fixed_data[2] = {0.0, 0.0};
+    double chi2 = 0.0;               // Of the fixed model.
+    std::vector<Vec3> bisector;      // Orbit frame; zero at new phase.
+
+    struct Axis {
+        std::vector<double> offset, amp;
+    };
+    std::vector<Axis> axes;
+
+    Prepared(const LightCurve& curve, std::size_t harmonics);
+    Axis axis(double obliquity, double azimuth) const;
+};
+
+RotationSearch::Prepared::Prepared(const LightCurve& curve, std::size_t harmonics)
+{
+    const std::span<const FluxSample> s = curve.samples;
+    if (s.size() < 2 * harmonics + 3)
+        throw std::invalid_argument("RotationSearch: too few samples for the harmonic model");
+    double first = s[0].t_days, last = s[0].t_days;
+    for (const FluxSample& x : s) {
+        if (!(x.sigma > 0.0))
+            throw std::invalid_argument("RotationSearch: sample sigma must be positive");
+        if (!std::isfinite(x.t_days) || !std::isfinite(x.flux))
+            throw std::invalid_argument("RotationSearch: samples must be finite");
+        first = std::min(first, x.t_days);
+        last = std::max(last, x.t_days);
+    }
+    baseline = last - first;
+    count = (s.size() + pad_to - 1) / pad_to * pad_to;
+    t.assign(count, 0.0);
+    fixed0.assign(count, 0.0);
+    fixed1.assign(count, 0.0);
+    data.assign(count, 0.0);
+    scale.assign(count, 0.0);
+    bisector.assign(s.size(), Vec3 {});
+
+    const OrbitGeometry& orbit = curve.orbit;
+    const Vec3 observer {std::sin(orbit.inclination_rad), 0.0, std::cos(orbit.inclination_rad)};
+    for (std::size_t i = 0; i < s.size(); ++i) {
+        const double lambda = orbit.phase_rad + two_pi * s[i].t_days / orbit.period_days;
+        const Vec3 star {-std::cos(lambda), -std::sin(lambda), 0.0};
+        const double cos_alpha = std::clamp(dot(star, observer), -1.0, 1.0);
+        const double alpha = std::acos(cos_alpha);
+        const double phase = (std::sin(alpha) + (pi - alpha) * cos_alpha) / pi;
+        const Vec3 k {star.x + observer.x, star.y + observer.y, star.z + observer.z};
+        const double norm = std::sqrt(dot(k, k));
+        if (norm > 1e-9)
+            bisector[i] = {k.x / norm, k.y / norm, k.z / norm};
+        const double w = 1.0 / s[i].sigma;
+        t[i] = s[i].t_days - first;
+        fixed0[i] = w;
+        fixed1[i] = w * phase;
+        data[i] = w * s[i].flux;
+        scale[i] = w * phase;
+    }
+
+    // Orthonormalize the fixed columns so the harmonic fit reduces to a
+    // Schur complement; a phase function constant over the light curve
+    // (face-on orbit) leaves one fixed column.
+    const auto inner = [&](const std::vector<double>& a, const std::vector<double>& b) {
+        double v = 0.0;
+        for (std::size_t i = 0; i < count; ++i)
+            v += a[i] * b[i];
+        return v;
+    };
+    const double n0 = std::sqrt(inner(fixed0, fixed0));
+    for (double& v : fixed0)
+        v /= n0;
+    const double raw1 = std::sqrt(inner(fixed1, fixed1));
+    const double p = inner(fixed0, fixed1);
+    for (std::size_t i = 0; i < count; ++i)
+        fixed1[i] -= p * fixed0[i];
+    const double n1 = std::sqrt(inner(fixed1, fixed1));
+    for (double& v : fixed1)
+        v = n1 > 1e-6 * raw1 ? v / n1 : 0.0;
+    fixed_data[0] = inner(fixed0, data);
+    fixed_data[1] = inner(fixed1, data);
+    chi2 = inner(data, data) - fixed_data[0] * fixed_data[0] - fixed_data[1] * fixed_data[1];
+}
+
+RotationSearch::Prepared::Axis RotationSearch::Prepared::axis(double obliquity, double azimuth) const
+{
+    const Vec3 n {std::sin(obliquity) * std::cos(azimuth), std::sin(obliquity) * std::sin(azimuth),
+                  std::cos(obliquity)};
+    Vec3 e1 {-n.y, n.x, 0.0};
+    const double len = std::sqrt(dot(e1, e1));
+    e1 = len > 1e-9 ? Vec3 {e1.x / len, e1.y / len, 0.0} : Vec3 {1.0, 0.0, 0.0};
+    const Vec3 e2 = cross(n, e1);
+    Axis a;
+    a.offset.assign(count, 0.0);
+    a.amp.assign(count, 0.0);
+    for (std::size_t i = 0; i < bisector.size(); ++i) {
+        const Vec3& k = bisector[i];
+        const double up = dot(k, n);
+        a.offset[i] = std::atan2(dot(k, e2), dot(k, e1));
+        a.amp[i] = dot(k, k) > 0.0 ? std::sqrt(std::max(0.0, 1.0 - up * up)) : 0.0;
+    }
+    return a;
+}
+
+namespace {
+
+// Power at `n` frequencies f_begin + m df for one axis.
+template <typename Prep, typename Axis>
+void scan(const Prep& p, const Axis& axis, detail::HarmonicFn kernel, std::size_t harmonics, double f_begin,
+          double df, std::size_t n, double* power)
+{
+    const std::size_t count = p.count;
+    const std::size_t h = 2 * harmonics;
+    const std::size_t per = detail::sums_for(harmonics);
+    std::vector<double> cos_phase(count, 1.0), sin_phase(count, 0.0);
+    std::vector<double> cos_step(count, 1.0), sin_step(count, 0.0);
+    std::vector<double> sums(reseed_every * per);
+    for (std::size_t i = 0; i < p.bisector.size(); ++i) {
+        cos_step[i] = std::cos(two_pi * df * p.t[i]);
+        sin_step[i] = std::sin(two_pi * df * p.t[i]);
+    }
+    detail::HarmonicArgs args;
+    args.count = count;
+    args.harmonics = harmonics;
+    args.fixed0 = p.fixed0.data();
+    args.fixed1 = p.fixed1.data();
+    args.data = p.data.data();
+    args.scale = p.scale.data();
+    args.amp = axis.amp.data();
+    args.cos_phase = cos_phase.data();
+    args.sin_phase = sin_phase.data();
+    args.cos_step = cos_step.data();
+    args.sin_step = sin_step.data();
+    args.sums = sums.data();
+
+    double g[2 * detail::max_harmonics * 2 * detail::max_harmonics];
+    double r[2 * detail::max_harmonics];
+    for (std::size_t b = 0; b < n; b += reseed_every) {
+        const double f = f_begin + double(b) * df;
+        for (std::size_t i = 0; i < p.bisector.size(); ++i) {
+            const double phi = two_pi * f * p.t[i] - axis.offset[i];
+            cos_phase[i] = std::cos(phi);
+            sin_phase[i] = std::sin(phi);
+        }
+        args.frequencies = std::min(reseed_every, n - b);
+        kernel(args);
+        for (std::size_t m = 0; m < args.frequencies; ++m) {
+            const double* s = sums.data() + m * per;
+            const double* c0 = s + h * (h + 1) / 2;
+            const double* c1 = c0 + h;
+            const double* y = c1 + h;
+            std::size_t at = 0;
+            for (std::size_t i = 0; i < h; ++i)
+                for (std::size_t j = i; j < h; ++j, ++at) {
+                    const double v = s[at] - c0[i] * c0[j] - c1[i] * c1[j];
+                    g[i * h + j] = v;
+                    g[j * h + i] = v;
+                }
+            for (std::size_t i = 0; i < h; ++i)
+                r[i] = y[i] - c0[i] * p.fixed_data[0] - c1[i] * p.fixed_data[1];
+            const double q = quadratic_form(g, r, h);
+            power[b + m] = p.chi2 > 0.0 ? std::clamp(q / p.chi2, 0.0, 1.0) : 0.0;
+        }
+    }
+}
+
+struct Polished {
+    double frequency = 0.0;
+    double power = 0.0;
+    double grid_loss = 0.0;  // Most a peak this sharp can lose between grid points.
+};
+
+// Parabolic refinement of one axis's peak near f on a grid of spacing
+// `step`. A strong detection is sharp on the fine grid, and without this
+// the grid's discretisation loss outweighs the difference between
+// neighbouring axes.
+template <typename Prep, typename Axis>
+Polished polish(const Prep& p, const Axis& axis, detail::HarmonicFn kernel, std::size_t harmonics, double f,
+                double step)
+{
+    Polished out;
+    out.frequency = f;
+    double v[3];
+    for (int round = 0; round < polish_rounds; ++round) {
+        scan(p, axis, kernel, harmonics, f - step, step, 3, v);
+        const double bend = v[0] - 2.0 * v[1] + v[2];
+        if (round == 0)
+            out.grid_loss = std::max(0.0, -bend) / 8.0;
+        for (int m = 0; m < 3; ++m)
+            if (v[m] > out.power) {
+                out.power = v[m];
+                out.frequency = f + double(m - 1) * step;
+            }
+        const double shift = bend < 0.0 ? std::clamp(0.5 * (v[0] - v[2]) / bend, -1.0, 1.0)
+                                         : (v[2] > v[0] ? 1.0 : -1.0);
+        f += shift * step;
+        step *= 0.25;
+    }
+    scan(p, axis, kernel, harmonics, f, 0.0, 1, v);
+    if (v[0] > out.power) {
+        out.power = v[0];
+        out.frequency = f;
+    }
+    return out;
+}
+
+struct Run {
+    std::size_t axis = 0;
+    std::size_t begin = 0;  // Fine-grid indices, inclusive.
+    std::size_t end = 0;
+    std::vector<double> power;
+};
+
+} // namespace
+
+void RotationSearchConfig::validate() const
+{
+    if (!(min_period_hours > 0.0) || !(max_period_hours > min_period_hours))
+        throw std::invalid_argument("RotationSearch: need 0 < min_period_hours < max_period_hours");
+    if (!(oversample >= 1.0))
+        throw std::invalid_argument("RotationSearch: oversample must be at least 1");
+    if (harmonics < 1 || harmonics > detail::max_harmonics)
+        throw std::invalid_argument("RotationSearch: harmonics must be 1 to 4");
+    if (obliquity_steps == 0 || azimuth_steps == 0)
+        throw std::invalid_argument("RotationSearch: spin-axis grid cannot be empty");
+    if (!(refine_fraction >= 0.0 && refine_fraction <= 1.0))
+        throw std::invalid_argument("RotationSearch: refine_fraction must be in [0, 1]");
+    if (candidates == 0)
+        throw std::invalid_argument("RotationSearch: candidates must be positive");
+}
+
+RotationSearch::RotationSearch(const RotationSearchConfig& config)
+    : config_(config)
+{
+    config_.validate();
+    if (!core::simd_level_supported(config_.simd))
+        throw std::invalid_argument(std::string("RotationSearch: SIMD level ")
+                                    + core::to_string(config_.simd) + " not available");
+}
+
+double RotationSearch::obliquity(std::size_t step) const noexcept
+{
+    return config_.obliquity_steps == 1 ? 0.0 : pi * double(step) / double(config_.obliquity_steps - 1);
+}
+
+double RotationSearch::azimuth(std::size_t step) const noexcept
+{
+    return two_pi * double(step) / double(config_.azimuth_steps);
+}
+
+double RotationSearch::power(const LightCurve& curve, double period_hours, double obliquity_rad,
+                             double azimuth_rad) const
+{
+    const Prepared p(curve, config_.harmonics);
+    double out = 0.0;
+    scan(p, p.axis(obliquity_rad, azimuth_rad), kernel_for(config_.simd), config_.harmonics,
+         24.0 / period_hours, 0.0, 1, &out);
+    return out;
+}
+
+RotationSearchResult RotationSearch::search(const LightCurve& curve, sched::Scheduler& scheduler) const
+{
+    static const perf::Stage stage("lightcurve.rotation_search");
+    perf::ScopedTimer timer(stage);
+    Prepared p(curve, config_.harmonics);
+    if (!(p.baseline * 24.0 >= config_.max_period_hours))
+        throw std::invalid_argument("RotationSearch: baseline shorter than the longest period");
+    const detail::HarmonicFn kernel = kernel_for(config_.simd);
+    const std::size_t harmonics = config_.harmonics;
+
+    const std::size_t axes = std::size_t(config_.obliquity_steps) * config_.azimuth_steps;
+    p.axes.resize(axes);
+    sched::parallel_for(scheduler, 0, axes, 1, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t a = lo; a < hi; ++a)
+            p.axes[a] = p.axis(obliquity(a / config_.azimuth_steps), azimuth(a % config_.azimuth_steps));
+    });
+
+    const double f_min = 24.0 / config_.max_period_hours;
+    const double f_max = 24.0 / config_.min_period_hours;
+    const double coarse_df = 1.0 / p.baseline;
+    const double fine_df = coarse_df / config_.oversample;
+    const auto coarse_n = std::size_t((f_max - f_min) / coarse_df) + 1;
+    const auto fine_n = std::size_t((f_max - f_min) / fine_df) + 1;
+
+    // Coarse pass over every axis.
+    std::vector<double> coarse(axes * coarse_n);
+    sched::parallel_for(scheduler, 0, axes, 1, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t a = lo; a < hi; ++a)
+            scan(p, p.axes[a], kernel, harmonics, f_min, coarse_df, coarse_n, &coarse[a * coarse_n]);
+    });
+    const double best_coarse = *std::max_element(coarse.begin(), coarse.end());
+
+    // Survivors become runs of fine-grid indices covering one coarse step
+    // either side, merged per axis.
+    std::vector<Run> runs;
+    const double ratio = coarse_df / fine_df;
+    for (std::size_t a = 0; a < axes; ++a)
+        for (std::size_t j = 0; j < coarse_n; ++j) {
+            if (coarse[a * coarse_n + j] < config_.refine_fraction * best_coarse)
+                continue;
+            const double centre = double(j) * ratio;
+            const auto begin = std::size_t(std::max(0.0, std::floor(centre - ratio)));
+            const std::size_t end = std::min(fine_n - 1, std::size_t(std::ceil(centre + ratio)));
+            if (!runs.empty() && runs.back().axis == a && begin <= runs.back().end + 1)
+                runs.back().end = std::max(runs.back().end, end);
+            else
+                runs.push_back({a, begin, end, {}});
+        }
+    sched::parallel_for(scheduler, 0, runs.size(), 1, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t k = lo; k < hi; ++k) {
+            Run& run = runs[k];
+            run.power.resize(run.end - run.begin + 1);
+            scan(p, p.axes[run.axis], kernel, harmonics, f_min + double(run.begin) * fine_df, fine_df,
+                 run.power.size(), run.power.data());
+        }
+    });
+
+    RotationSearchResult result;
+    result.stats.coarse_trials = axes * coarse_n;
+    result.stats.exhaustive_trials = axes * fine_n;
+
+    // Local maxima along frequency, then distinct periods best first.
+    struct Peak {
+        double power, frequency;
+        std::size_t axis;
+    };
+    std::vector<Peak> peaks;
+    for (const Run& run : runs) {
+        result.stats.fine_trials += run.power.size();
+        for (std::size_t m = 0; m < run.power.size(); ++m) {
+            const double v = run.power[m];
+            if ((m > 0 && run.power[m - 1] > v) || (m + 1 < run.power.size() && run.power[m + 1] > v))
+                continue;
+            peaks.push_back({v, f_min + double(run.begin + m) * fine_df, run.axis});
+        }
+    }
+    std::sort(peaks.begin(), peaks.end(), [](const Peak& a, const Peak& b) { return a.power > b.power; });
+
+    // Each new period is polished on its best axis, which bounds how much
+    // any other axis's peak nearby can have lost to the grid; those that
+    // could still win are polished too.
+    std::vector<double> chosen;
+    for (std::size_t i = 0; i < peaks.size() && result.candidates.size() < config_.candidates; ++i) {
+        const auto near = [&](double f) { return std::abs(f - peaks[i].frequency) < coarse_df; };
+        if (std::any_of(chosen.begin(), chosen.end(), near))
+            continue;
+        Polished best = polish(p, p.axes[peaks[i].axis], kernel, harmonics, peaks[i].frequency, fine_df);
+        std::size_t best_axis = peaks[i].axis;
+        result.stats.fine_trials += polish_trials;
+        const double floor = best.power - 2.0 * best.grid_loss;
+        for (std::size_t j = i + 1; j < peaks.size() && peaks[j].power >= floor; ++j) {
+            if (peaks[j].axis == peaks[i].axis || !near(peaks[j].frequency))
+                continue;
+            const Polished other = polish(p, p.axes[peaks[j].axis], kernel, harmonics, peaks[j].frequency, fine_df);
+            result.stats.fine_trials += polish_trials;
+            if (other.power > best.power) {
+                best = other;
+                best_axis = peaks[j].axis;
+            }
+        }
+        chosen.push_back(best.frequency);
+        result.candidates.push_back({24.0 / best.frequency, obliquity(best_axis / config_.azimuth_steps),
+                                     azimuth(best_axis % config_.azimuth_steps), best.power});
+    }
+
+    if (!chosen.empty()) {
+        result.axis_power.resize(axes);
+        sched::parallel_for(scheduler, 0, axes, 1, [&](std::size_t lo, std::size_t hi) {
+            for (std::size_t a = lo; a < hi; ++a)
+                result.axis_power[a] = polish(p, p.axes[a], kernel, harmonics, chosen.front(), fine_df).power;
+        });
+        result.stats.fine_trials += axes * polish_trials;
+    }
+    return result;
+}
+
+std::vector<RotationSearchResult> RotationSearch::search_batch(std::span<const LightCurve> curves,
+                                                               sched::Scheduler& scheduler) const
+{
+    std::vector<RotationSearchResult> results(curves.size());
+    sched::parallel_for(scheduler, 0, curves.size(), 1, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t i = lo; i < hi; ++i)
+            results[i] = search(curves[i], scheduler);
+    });
+    return results;
+}
+
+} // namespace solarlens::lightcurve
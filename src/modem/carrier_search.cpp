@@ -0,0 +1,100 @@
+#include "solarlens/modem/carrier_search.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+#include "solarlens/core/fft.hpp"
+#include "solarlens/sched/scheduler.hpp"
+
+namespace solarlens::modem {
+
+namespace {
+
+// Upper bound on partial spectra; enough to feed every core without
+// letting the reduction dominate.
+constexpr std::size_t max_chunks = 64;
+
+} // namespace
+
+void CarrierSearchConfig::validate() const
+{
+    if (!core::is_power_of_two(fft_size) || fft_size < 16)
+        throw std::invalid_argument("carrier search: fft_size must be a power of two >= 16");
+    if (!(sample_rate_hz > 0) || !(max_doppler_hz > 0) || candidates == 0)
+        throw std::invalid_argument("carrier search: sample rate, Doppler window and candidates must be positive");
+}
+
+std::vector<CarrierCandidate> search_carrier(std::span<const std::complex<float>> samples,
+                                             const CarrierSearchConfig& config, sched::Scheduler& scheduler)
+{
+    config.validate();
+    const std::size_t n = config.fft_size;
+    const std::size_t blocks = samples.size() / n;
+    if (blocks == 0)
+        throw std::invalid_argument("carrier search: capture shorter than one FFT block");
+    const auto plan = core::FftPlan::get(n);
+
+    const std::size_t chunks = std::min(blocks, max_chunks);
+    std::vector<std::vector<double>> partial(chunks);
+    sched::parallel_for(scheduler, 0, chunks, 1, [&](std::size_t lo, std::size_t hi) {
+        std::vector<std::complex<float>> work(n);
+        for (std::size_t c = lo; c < hi; ++c) {
+            auto& power = partial[c];
+            power.assign(n, 0.0);
+            for (std::size_t b = c * blocks / chunks; b < (c + 1) * blocks / chunks; ++b) {
+                std::copy_n(samples.data() + b * n, n, work.data());
+                plan->forward(work);
+                for (std::size_t k = 0; k < n; ++k)
+                    power[k] += std::norm(work[k]);
+            }
+        }
+    });
+    std::vector<double> power(n, 0.0);
+    for (const auto& p : partial)
+        for (std::size_t k = 0; k < n; ++k)
+            power[k] += p[k];
+
+    // Bins inside the Doppler window, in FFT order.
+    const double bin_hz = config.sample_rate_hz / double(n);
+    const auto offset = [&](std::size_t k) { return k < n / 2 ? double(k) : double(k) - double(n); };
+    std::vector<std::size_t> window;
+    for (std::size_t k = 0; k < n; ++k)
+        if (std::abs(offset(k)) * bin_hz <= config.max_doppler_hz)
+            window.push_back(k);
+
+    // Noise statistics from the median: the summed power of a noise bin
+    // is Gamma(blocks) distributed, mean m and deviation m / sqrt(blocks).
+    std::vector<double> sorted(window.size());
+    std::transform(window.begin(), window.end(), sorted.begin(), [&](std::size_t k) { return power[k]; });
+    std::nth_element(sorted.begin(), sorted.begin() + sorted.size() / 2, sorted.end());
+    const double median = sorted[sorted.size() / 2];
+    // Median of Gamma(B) is about B - 1/3 in units of the mean per block.
+    const double mean = median * double(blocks) / std::max(double(blocks) - 1.0 / 3.0, 0.5);
+    const double deviation = mean / std::sqrt(double(blocks));
+
+    std::vector<std::size_t> order = window;
+    std::sort(order.begin(), order.end(), [&](std::size_t a, std::size_t b) { return power[a] > power[b]; });
+    std::vector<CarrierCandidate> out;
+    std::vector<std::size_t> taken;
+    for (std::size_t k : order) {
+        if (out.size() == config.candidates)
+            break;
+        const bool near = std::any_of(taken.begin(), taken.end(), [&](std::size_t t) {
+            const std::size_t d = k > t ? k - t : t - k;
+            return std::min(d, n - d) < config.min_separation_bins;
+        });
+        if (near)
+            continue;
+        taken.push_back(k);
+        const double left = power[(k + n - 1) % n];
+        const double right = power[(k + 1) % n];
+        const double curve = left - 2.0 * power[k] + right;
+        const double delta = curve < 0.0 ? 0.5 * (left - right) / curve : 0.0;
+        out.push_back({(offset(k) + delta) * bin_hz, power[k], (power[k] - mean) / deviation});
+    }
+    return out;
+}
+
+} // namespace solarlens::modem
@@ -0,0 +1,212 @@
+#include "solarlens/modem/drift_search.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "solarlens/perf/instrument.hpp"
+#include "solarlens/sched/scheduler.hpp"
+#include "taylor_kernels.hpp"
+
+namespace solarlens::modem {
+
+namespace {
+
+// Start channels per chunk: the tree's two buffers stay in L2.
+constexpr std::size_t chunk_channels = 1024;
+// Upper bound on tasks per block; each allocates its own buffers.
+constexpr std::size_t max_tasks = 64;
+// Rows are padded to a multiple of the widest vector.
+constexpr std::size_t row_align = 16;
+
+detail::TaylorFn kernel_for(core::SimdLevel level)
+{
+    switch (level) {
+#if defined(SOLARLENS_HAVE_AVX512)
+    case core::SimdLevel::avx512:
+        return detail::taylor_avx512;
+#endif
+#if defined(SOLARLENS_HAVE_AVX2)
+    case core::SimdLevel::avx2:
+        return detail::taylor_avx2;
+#endif
+#if defined(SOLARLENS_HAVE_NEON)
+    case core::SimdLevel::neon:
+        return detail::taylor_neon;
+#endif
+    default:
+        return detail::taylor_scalar;
+    }
+}
+
+struct Candidate {
+    std::size_t channel = 0;
+    long drift = 0; ///< Channels over the block, signed.
+    float snr = 0.0f;
+};
+
+// Greedy non-maximum suppression: strongest first, dropping candidates
+// within `window` channels of one already kept, at most `limit` kept.
+void suppress(std::vector<Candidate>& candidates, std::size_t window, std::size_t limit)
+{
+    std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+        return a.snr != b.snr ? a.snr > b.snr : a.channel < b.channel;
+    });
+    std::vector<Candidate> kept;
+    for (const Candidate& c : candidates) {
+        if (kept.size() == limit)
+            break;
+        const bool near = std::any_of(kept.begin(), kept.end(), [&](const Candidate& k) {
+            return (k.channel > c.channel ? k.channel - c.channel : c.channel - k.channel) <= window;
+        });
+        if (!near)
+            kept.push_back(c);
+    }
+    candidates = std::move(kept);
+}
+
+} // namespace
+
+void DriftSearchConfig::validate() const
+{
+    if (channels == 0)
+        throw std::invalid_argument("drift search: need at least one channel");
+    if (time_steps < 2 || time_steps > 4096 || (time_steps & (time_steps - 1)) != 0)
+        throw std::invalid_argument("drift search: time_steps must be a power of two in [2, 4096]");
+    if (!(channel_hz > 0) || !(step_s > 0) || !(snr_threshold > 0) || max_hits_per_block == 0)
+        throw std::invalid_argument("drift search: channel width, step, threshold and hit limit must be positive");
+    if (!(max_drift_hz_per_s >= 0) || max_drift_hz_per_s > channel_hz / step_s * (1 + 1e-12))
+        throw std::invalid_argument("drift search: max drift must be in [0, one channel per step]");
+}
+
+std::size_t DriftSearchConfig::max_drift_channels() const noexcept
+{
+    const double span = max_drift_hz_per_s * double(time_steps - 1) * step_s / channel_hz;
+    return std::min(time_steps - 1, static_cast<std::size_t>(std::floor(span + 1e-9)));
+}
+
+DriftSearcher::DriftSearcher(const DriftSearchConfig& config)
+    : config_(config)
+{
+    config_.validate();
+    if (!core::simd_level_supported(config_.simd))
+        throw std::invalid_argument(std::string("drift search: SIMD level ") + core::to_string(config_.simd)
+                                    + " not available");
+    block_.resize(config_.time_steps * config_.channels);
+}
+
+std::vector<DriftHit> DriftSearcher::push(std::span<const float> spectrum)
+{
+    if (spectrum.size() != config_.channels)
+        throw std::invalid_argument("drift search: spectrum size does not match channels");
+    std::copy(spectrum.begin(), spectrum.end(), block_.begin() + filled_ * config_.channels);
+    if (++filled_ < config_.time_steps)
+        return {};
+    filled_ = 0;
+    std::vector<DriftHit> hits = search_block();
+    ++blocks_;
+    return hits;
+}
+
+std::vector<DriftHit> DriftSearcher::search_block()
+{
+    static const perf::Stage stage("modem.drift_search");
+    perf::ScopedTimer timer(stage);
+    const std::size_t rows = config_.time_steps;
+    const std::size_t total = config_.channels;
+    const std::size_t max_drift = config_.max_drift_channels();
+    const std::size_t width = (chunk_channels + rows - 1 + row_align - 1) / row_align * row_align;
+    const std::size_t chunks = (total + chunk_channels - 1) / chunk_channels;
+    const detail::TaylorFn kernel = kernel_for(config_.simd);
+    const float* block = block_.data();
+
+    std::vector<std::vector<Candidate>> found(chunks);
+    const auto search = [&](std::size_t lo, std::size_t hi) {
+        std::vector<float> data(rows * width), scratch(rows * width);
+        std::vector<float> best[2], drift[2], straight[2];
+        for (int dir = 0; dir < 2; ++dir) {
+            best[dir].resize(chunk_channels);
+            drift[dir].resize(chunk_channels);
+            straight[dir].resize(chunk_channels);
+        }
+        std::vector<float> sorted(chunk_channels);
+        for (std::size_t c = lo; c < hi; ++c) {
+            const std::size_t c0 = c * chunk_channels;
+            const std::size_t n = std::min(chunk_channels, total - c0);
+            // Positive drifts run up from c0, negative ones down from the
+            // chunk's last channel; past the band edge is zero.
+            for (int dir = 0; dir < 2; ++dir) {
+                for (std::size_t r = 0; r < rows; ++r) {
+                    const float* in = block + r * total;
+                    float* out = data.data() + r * width;
+                    std::size_t count;
+                    if (dir == 0) {
+                        count = std::min(width, total - c0);
+                        std::copy_n(in + c0, count, out);
+                    } else {
+                        count = std::min(width, c0 + n);
+                        std::reverse_copy(in + (c0 + n - count), in + c0 + n, out);
+                    }
+                    std::fill(out + count, out + width, 0.0f);
+                }
+                detail::TaylorArgs args;
+                args.rows = rows;
+                args.width = width;
+                args.channels = n;
+                args.drifts = max_drift + 1;
+                args.data = data.data();
+                args.scratch = scratch.data();
+                args.best = best[dir].data();
+                args.best_drift = drift[dir].data();
+                args.straight = straight[dir].data();
+                kernel(args);
+            }
+
+            // Noise from the zero-drift sums: median and MAD, as a
+            // Gaussian deviation.
+            std::copy_n(straight[0].begin(), n, sorted.begin());
+            const auto mid = sorted.begin() + n / 2;
+            std::nth_element(sorted.begin(), mid, sorted.begin() + n);
+            const float median = *mid;
+            for (std::size_t i = 0; i < n; ++i)
+                sorted[i] = std::abs(straight[0][i] - median);
+            std::nth_element(sorted.begin(), mid, sorted.begin() + n);
+            const float deviation = 1.4826f * *mid;
+            if (!(deviation > 0.0f))
+                continue;
+
+            for (std::size_t i = 0; i < n; ++i) {
+                const std::size_t j = n - 1 - i;
+                const bool up = best[0][i] >= best[1][j];
+                const float value = up ? best[0][i] : best[1][j];
+                const float snr = (value - median) / deviation;
+                if (snr >= config_.snr_threshold)
+                    found[c].push_back({c0 + i, up ? long(drift[0][i]) : -long(drift[1][j]), snr});
+            }
+            suppress(found[c], max_drift, config_.max_hits_per_block);
+        }
+    };
+    if (config_.scheduler != nullptr)
+        sched::parallel_for(*config_.scheduler, 0, chunks, (chunks + max_tasks - 1) / max_tasks, search);
+    else
+        search(0, chunks);
+
+    // Chunks suppress only within themselves; finish across their edges.
+    std::vector<Candidate> all;
+    for (const std::vector<Candidate>& f : found)
+        all.insert(all.end(), f.begin(), f.end());
+    suppress(all, max_drift, config_.max_hits_per_block);
+
+    const double block_s = double(rows) * config_.step_s;
+    const double drift_unit = config_.channel_hz / (double(rows - 1) * config_.step_s);
+    std::vector<DriftHit> hits;
+    hits.reserve(all.size());
+    for (const Candidate& c : all)
+        hits.push_back({blocks_, double(blocks_) * block_s, c.channel,
+                        config_.first_channel_hz + double(c.channel) * config_.channel_hz,
+                        double(c.drift) * drift_unit, double(c.snr)});
+    return hits;
+}
+
+} // namespace solarlens::modem
@@ -0,0 +1,178 @@
+#include "solarlens/modem/ldpc.hpp"
+
+#include <bit>
+#include <stdexcept>
+#include <utility>
+
+namespace solarlens::modem {
+
+namespace {
+
+std::uint64_t splitmix64(std::uint64_t& state) noexcept
+{
+    std::uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Shift table with entries in rows < i, plus row i up to column j, set.
+// True if none of them closes a 4- or 6-cycle: walking the cycle's blocks
+// with alternating signs sums the shifts to 0 mod p.
+bool cycle_free(const std::vector<std::uint32_t>& s, std::uint32_t p, std::uint32_t cols, std::uint32_t i,
+                std::uint32_t j)
+{
+    const auto at = [&](std::uint32_t r, std::uint32_t c) { return std::int64_t(s[r * cols + c]); };
+    const auto zero = [&](std::int64_t v) { return ((v % p) + p) % p == 0; };
+    const auto set = [&](std::uint32_t r, std::uint32_t c) { return r < i || (r == i && c <= j); };
+    for (std::uint32_t r = 0; r < i; ++r)
+        for (std::uint32_t c = 0; c < cols; ++c)
+            if (c != j && set(i, c) && zero(at(i, j) - at(i, c) + at(r, c) - at(r, j)))
+                return false;
+    for (std::uint32_t r1 = 0; r1 <= i; ++r1)
+        for (std::uint32_t r2 = 0; r2 <= i; ++r2) {
+            if (r1 == r2 || r1 == i || r2 == i)
+                continue;
+            for (std::uint32_t c1 = 0; c1 < cols; ++c1)
+                for (std::uint32_t c2 = 0; c2 < cols; ++c2) {
+                    if (c1 == j || c2 == j || c1 == c2 || !set(i, c2))
+                        continue;
+                    // i:(j -> c2), r1:(c2 -> c1), r2:(c1 -> j).
+                    if (zero(at(i, j) - at(i, c2) + at(r1, c2) - at(r1, c1) + at(r2, c1) - at(r2, j)))
+                        return false;
+                }
+        }
+    return true;
+}
+
+} // namespace
+
+LdpcCode LdpcCode::quasi_cyclic(std::uint32_t p, std::uint32_t column_weight, std::uint32_t row_weight,
+                                std::uint64_t seed)
+{
+    if (column_weight < 2 || column_weight >= row_weight || p < 2 * row_weight)
+        throw std::invalid_argument("ldpc: quasi-cyclic code needs 2 <= column weight < row weight <= p / 2");
+    const std::uint32_t rows = column_weight;
+    const std::uint32_t cols = row_weight;
+    // Row 0 and column 0 stay zero, which loses no generality; the rest
+    // are drawn until each closes no short cycle with those already set.
+    std::vector<std::uint32_t> shift(std::size_t(rows) * cols, 0);
+    std::uint64_t state = seed;
+    constexpr int attempts = 10000;
+    for (std::uint32_t i = 1; i < rows; ++i)
+        for (std::uint32_t j = 1; j < cols; ++j) {
+            int tries = 0;
+            do {
+                if (++tries > attempts)
+                    throw std::invalid_argument("ldpc: no girth-8 shifts found; increase the circulant size");
+                shift[i * cols + j] = static_cast<std::uint32_t>(splitmix64(state) % p);
+            } while (!cycle_free(shift, p, cols, i, j));
+        }
+
+    LdpcCode code;
+    code.n_ = std::size_t(cols) * p;
+    code.row_start_.reserve(std::size_t(rows) * p + 1);
+    code.row_start_.push_back(0);
+    for (std::uint32_t i = 0; i < rows; ++i)
+        for (std::uint32_t r = 0; r < p; ++r) {
+            // Row r of block row i has a one in block column j at
+            // (r + shift(i, j)) mod p.
+            for (std::uint32_t j = 0; j < cols; ++j)
+                code.columns_.push_back(j * p + (r + shift[i * cols + j]) % p);
+            code.row_start_.push_back(static_cast<std::uint32_t>(code.columns_.size()));
+        }
+    code.derive_encoder();
+    return code;
+}
+
+void LdpcCode::derive_encoder()
+{
+    const std::size_t rows = checks();
+    const std::size_t words = (n_ + 63) / 64;
+    std::vector<std::uint64_t> h(rows * words, 0);
+    for (std::size_t r = 0; r < rows; ++r)
+        for (std::uint32_t e = row_start_[r]; e < row_start_[r + 1]; ++e)
+            h[r * words + columns_[e] / 64] ^= std::uint64_t {1} << (columns_[e] % 64);
+
+    // Reduced row echelon form over GF(2).
+    std::vector<std::uint32_t> pivots;
+    std::size_t rank = 0;
+    for (std::size_t c = 0; c < n_ && rank < rows; ++c) {
+        const std::size_t w = c / 64;
+        const std::uint64_t bit = std::uint64_t {1} << (c % 64);
+        std::size_t pivot = rank;
+        while (pivot < rows && !(h[pivot * words + w] & bit))
+            ++pivot;
+        if (pivot == rows)
+            continue;
+        if (pivot != rank)
+            for (std::size_t x = 0; x < words; ++x)
+                std::swap(h[pivot * words + x], h[rank * words + x]);
+        for (std::size_t r = 0; r < rows; ++r)
+            if (r != rank && (h[r * words + w] & bit))
+                for (std::size_t x = 0; x < words; ++x)
+                    h[r * words + x] ^= h[rank * words + x];
+        pivots.push_back(static_cast<std::uint32_t>(c));
+        ++rank;
+    }
+
+    std::vector<bool> is_pivot(n_, false);
+    for (auto c : pivots)
+        is_pivot[c] = true;
+    info_columns_.clear();
+    for (std::uint32_t c = 0; c < n_; ++c)
+        if (!is_pivot[c])
+            info_columns_.push_back(c);
+
+    // Row r of the reduced matrix reads: bit pivots[r] = XOR of the info
+    // bits it covers.
+    const std::size_t k = info_columns_.size();
+    mask_words_ = (k + 63) / 64;
+    parity_columns_ = pivots;
+    parity_masks_.assign(rank * mask_words_, 0);
+    for (std::size_t r = 0; r < rank; ++r)
+        for (std::size_t i = 0; i < k; ++i) {
+            const std::uint32_t c = info_columns_[i];
+            if (h[r * words + c / 64] & (std::uint64_t {1} << (c % 64)))
+                parity_masks_[r * mask_words_ + i / 64] |= std::uint64_t {1} << (i % 64);
+        }
+}
+
+void LdpcCode::encode(std::span<const std::uint8_t> info, std::span<std::uint8_t> codeword) const
+{
+    if (info.size() != k() || codeword.size() != n_)
+        throw std::invalid_argument("ldpc: encode needs k info bits and an n-bit codeword");
+    std::vector<std::uint64_t> packed(mask_words_, 0);
+    for (std::size_t i = 0; i < info.size(); ++i) {
+        codeword[info_columns_[i]] = info[i] & 1;
+        packed[i / 64] |= std::uint64_t(info[i] & 1) << (i % 64);
+    }
+    for (std::size_t r = 0; r < parity_columns_.size(); ++r) {
+        std::uint64_t acc = 0;
+        for (std::size_t w = 0; w < mask_words_; ++w)
+            acc ^= parity_masks_[r * mask_words_ + w] & packed[w];
+        codeword[parity_columns_[r]] = static_cast<std::uint8_t>(std::popcount(acc) & 1);
+    }
+}
+
+void LdpcCode::extract(std::span<const std::uint8_t> codeword, std::span<std::uint8_t> info) const
+{
+    if (info.size() != k() || codeword.size() != n_)
+        throw std::invalid_argument("ldpc: extract needs an n-bit codeword and k info bits");
+    for (std::size_t i = 0; i < info.size(); ++i)
+        info[i] = codeword[info_columns_[i]];
+}
+
+bool LdpcCode::satisfied(std::span<const std::uint8_t> codeword) const noexcept
+{
+    for (std::size_t r = 0; r + 1 < row_start_.size(); ++r) {
+        unsigned parity = 0;
+        for (std::uint32_t e = row_start_[r]; e < row_start_[r + 1]; ++e)
+            parity ^= codeword[columns_[e]];
+        if (parity & 1)
+            return false;
+    }
+    return true;
+}
+
+} // namespace solarlens::modem
@@ -0,0 +1,132 @@
+#include "solarlens/modem/ldpc_decoder.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "minsum_kernels.hpp"
+#include "solarlens/sched/scheduler.hpp"
+
+namespace solarlens::modem {
+
+namespace {
+
+static_assert(BatchDecoder::block_size == detail::block_lanes);
+
+struct Kernels {
+    detail::IterateFn iterate;
+    detail::SyndromeFn syndrome;
+};
+
+Kernels kernels_for(core::SimdLevel level)
+{
+    switch (level) {
+#if defined(SOLARLENS_HAVE_AVX512)
+    case core::SimdLevel::avx512:
+        return {detail::iterate_avx512, detail::syndrome_avx512};
+#endif
+#if defined(SOLARLENS_HAVE_AVX2)
+    case core::SimdLevel::avx2:
+        return {detail::iterate_avx2, detail::syndrome_avx2};
+#endif
+#if defined(SOLARLENS_HAVE_NEON)
+    case core::SimdLevel::neon:
+        return {detail::iterate_neon, detail::syndrome_neon};
+#endif
+    default:
+        return {detail::iterate_scalar, detail::syndrome_scalar};
+    }
+}
+
+void check_sizes(const LdpcCode& code, std::span<const float> llr, std::span<std::uint8_t> bits,
+                 std::size_t count)
+{
+    if (llr.size() < count * code.n() || bits.size() < count * code.n())
+        throw std::invalid_argument("BatchDecoder: llr and bits need n values per codeword");
+}
+
+} // namespace
+
+BatchDecoder::BatchDecoder(const LdpcCode& code, const DecoderConfig& config)
+    : code_(&code)
+    , config_(config)
+{
+    if (!core::simd_level_supported(config.simd))
+        throw std::invalid_argument(std::string("BatchDecoder: SIMD level ")
+                                    + core::to_string(config.simd) + " not available");
+    const auto rows = code.row_start();
+    for (std::size_t r = 0; r + 1 < rows.size(); ++r)
+        if (rows[r + 1] - rows[r] > detail::max_check_degree)
+            throw std::invalid_argument("BatchDecoder: check degree above "
+                                        + std::to_string(detail::max_check_degree));
+}
+
+void BatchDecoder::decode(std::span<const float> llr, std::span<std::uint8_t> bits,
+                          std::span<DecodeStatus> status) const
+{
+    check_sizes(*code_, llr, bits, status.size());
+    const std::size_t n = code_->n();
+    for (std::size_t b = 0; b < status.size(); b += block_size) {
+        const std::size_t count = std::min(block_size, status.size() - b);
+        decode_block(llr.data() + b * n, bits.data() + b * n, status.data() + b, count);
+    }
+}
+
+void BatchDecoder::decode(std::span<const float> llr, std::span<std::uint8_t> bits,
+                          std::span<DecodeStatus> status, sched::Scheduler& scheduler) const
+{
+    check_sizes(*code_, llr, bits, status.size());
+    const std::size_t n = code_->n();
+    const std::size_t blocks = (status.size() + block_size - 1) / block_size;
+    sched::parallel_for(scheduler, 0, blocks, 1, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t blk = lo; blk < hi; ++blk) {
+            const std::size_t b = blk * block_size;
+            const std::size_t count = std::min(block_size, status.size() - b);
+            decode_block(llr.data() + b * n, bits.data() + b * n, status.data() + b, count);
+        }
+    });
+}
+
+void BatchDecoder::decode_block(const float* llr, std::uint8_t* bits, DecodeStatus* status,
+                                std::size_t count) const
+{
+    constexpr std::size_t lanes = detail::block_lanes;
+    const std::size_t n = code_->n();
+    const detail::CheckGraph graph {code_->checks(), code_->row_start().data(), code_->columns().data()};
+    const Kernels k = kernels_for(config_.simd);
+
+    // Unused lanes decode an all-zero word with confident LLRs.
+    std::vector<float> posterior(n * lanes, 1.0f);
+    std::vector<float> edges(code_->columns().size() * lanes, 0.0f);
+    for (std::size_t lane = 0; lane < count; ++lane)
+        for (std::size_t v = 0; v < n; ++v)
+            posterior[v * lanes + lane] = llr[lane * n + v];
+
+    const std::uint32_t used = (1u << count) - 1;
+    std::size_t it = 0;
+    const auto emit = [&](std::uint32_t which, bool converged) {
+        for (std::size_t lane = 0; lane < count; ++lane) {
+            if (!(which >> lane & 1))
+                continue;
+            for (std::size_t v = 0; v < n; ++v)
+                bits[lane * n + v] = std::signbit(posterior[v * lanes + lane]);
+            status[lane] = {converged, static_cast<std::uint16_t>(it)};
+        }
+    };
+
+    std::uint32_t pending = used;
+    for (;;) {
+        const std::uint32_t done = pending & ~k.syndrome(graph, posterior.data());
+        emit(done, true);
+        pending &= ~done;
+        if (!pending || it == config_.max_iterations)
+            break;
+        k.iterate(graph, config_.scale, posterior.data(), edges.data());
+        ++it;
+    }
+    emit(pending, false);
+}
+
+} // namespace solarlens::modem
@@ -0,0 +1,69 @@
+// AVX2 kernels: a block is two vectors of eight codewords.
+
+#include <cmath>
+
+#include <immintrin.h>
+
+#include "minsum_kernels.hpp"
+
+namespace solarlens::modem::detail {
+
+void iterate_avx2(const CheckGraph& g, float scale, float* posterior, float* edges)
+{
+    constexpr std::size_t lanes = 8;
+    const __m256 sign_bit = _mm256_set1_ps(-0.0f);
+    const __m256 inf = _mm256_set1_ps(INFINITY);
+    const __m256 alpha = _mm256_set1_ps(scale);
+    __m256 q[max_check_degree];
+    for (std::size_t r = 0; r < g.rows; ++r) {
+        const std::uint32_t first = g.row_start[r];
+        const std::size_t degree = g.row_start[r + 1] - first;
+        for (std::size_t off = 0; off < block_lanes; off += lanes) {
+            __m256 min1 = inf;
+            __m256 min2 = inf;
+            __m256 at = _mm256_setzero_ps();
+            __m256 parity = _mm256_setzero_ps();
+            for (std::size_t i = 0; i < degree; ++i) {
+                const float* l = posterior + g.columns[first + i] * block_lanes + off;
+                const float* e = edges + (first + i) * block_lanes + off;
+                q[i] = _mm256_sub_ps(_mm256_loadu_ps(l), _mm256_loadu_ps(e));
+                const __m256 m = _mm256_andnot_ps(sign_bit, q[i]);
+                parity = _mm256_xor_ps(parity, q[i]);
+                const __m256 lt = _mm256_cmp_ps(m, min1, _CMP_LT_OQ);
+                min2 = _mm256_blendv_ps(_mm256_min_ps(min2, m), min1, lt);
+                min1 = _mm256_blendv_ps(min1, m, lt);
+                at = _mm256_blendv_ps(at, _mm256_set1_ps(float(i)), lt);
+            }
+            min1 = _mm256_mul_ps(alpha, min1);
+            min2 = _mm256_mul_ps(alpha, min2);
+            for (std::size_t i = 0; i < degree; ++i) {
+                const __m256 is_min = _mm256_cmp_ps(at, _mm256_set1_ps(float(i)), _CMP_EQ_OQ);
+                const __m256 mag = _mm256_blendv_ps(min1, min2, is_min);
+                const __m256 sign = _mm256_and_ps(_mm256_xor_ps(parity, q[i]), sign_bit);
+                const __m256 r_new = _mm256_or_ps(mag, sign);
+                _mm256_storeu_ps(edges + (first + i) * block_lanes + off, r_new);
+                _mm256_storeu_ps(posterior + g.columns[first + i] * block_lanes + off, _mm256_add_ps(q[i], r_new));
+            }
+        }
+    }
+}
+
+std::uint32_t syndrome_avx2(const CheckGraph& g, const float* posterior)
+{
+    __m256 failed_lo = _mm256_setzero_ps();
+    __m256 failed_hi = _mm256_setzero_ps();
+    for (std::size_t r = 0; r < g.rows; ++r) {
+        __m256 lo = _mm256_setzero_ps();
+        __m256 hi = _mm256_setzero_ps();
+        for (std::uint32_t e = g.row_start[r]; e < g.row_start[r + 1]; ++e) {
+            const float* l = posterior + g.columns[e] * block_lanes;
+            lo = _mm256_xor_ps(lo, _mm256_loadu_ps(l));
+            hi = _mm256_xor_ps(hi, _mm256_loadu_ps(l + 8));
+        }
+        failed_lo = _mm256_or_ps(failed_lo, lo);
+        failed_hi = _mm256_or_ps(failed_hi, hi);
+    }
+    return std::uint32_t(_mm256_movemask_ps(failed_lo)) | (std::uint32_t(_mm256_movemask_ps(failed_hi)) << 8);
+}
+
+} // namespace solarlens::modem::detail
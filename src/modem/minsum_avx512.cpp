@@ -0,0 +1,79 @@
+// AVX-512F kernels: a block is one vector of sixteen codewords.
+
+#include <cmath>
+
+#include <immintrin.h>
+
+#include "minsum_kernels.hpp"
+
+namespace solarlens::modem::detail {
+
+namespace {
+
+// AVX-512F has no float logic ops (those are DQ), so signs are handled
+// through the integer forms. GCC 12 reports the undefined pass-through
+// of the masked min and andnot builtins as maybe-uninitialized; the
+// zero-masked forms with every lane set are the same instructions.
+constexpr __mmask16 all = 0xFFFF;
+
+__m512 min_ps(__m512 a, __m512 b)
+{
+    return _mm512_maskz_min_ps(all, a, b);
+}
+
+__m512i bits(__m512 v)
+{
+    return _mm512_castps_si512(v);
+}
+
+} // namespace
+
+void iterate_avx512(const CheckGraph& g, float scale, float* posterior, float* edges)
+{
+    const __m512i sign_bit = _mm512_set1_epi32(static_cast<int>(0x80000000u));
+    const __m512 inf = _mm512_set1_ps(INFINITY);
+    const __m512 alpha = _mm512_set1_ps(scale);
+    __m512 q[max_check_degree];
+    for (std::size_t r = 0; r < g.rows; ++r) {
+        const std::uint32_t first = g.row_start[r];
+        const std::size_t degree = g.row_start[r + 1] - first;
+        __m512 min1 = inf;
+        __m512 min2 = inf;
+        __m512i at = _mm512_setzero_si512();
+        __m512i parity = _mm512_setzero_si512();
+        for (std::size_t i = 0; i < degree; ++i) {
+            q[i] = _mm512_sub_ps(_mm512_loadu_ps(posterior + g.columns[first + i] * block_lanes),
+                                 _mm512_loadu_ps(edges + (first + i) * block_lanes));
+            const __m512 m = _mm512_castsi512_ps(_mm512_maskz_andnot_epi32(all, sign_bit, bits(q[i])));
+            parity = _mm512_xor_si512(parity, bits(q[i]));
+            const __mmask16 lt = _mm512_cmp_ps_mask(m, min1, _CMP_LT_OQ);
+            min2 = _mm512_mask_blend_ps(lt, min_ps(min2, m), min1);
+            min1 = _mm512_mask_blend_ps(lt, min1, m);
+            at = _mm512_mask_blend_epi32(lt, at, _mm512_set1_epi32(static_cast<int>(i)));
+        }
+        min1 = _mm512_mul_ps(alpha, min1);
+        min2 = _mm512_mul_ps(alpha, min2);
+        for (std::size_t i = 0; i < degree; ++i) {
+            const __mmask16 is_min = _mm512_cmpeq_epi32_mask(at, _mm512_set1_epi32(static_cast<int>(i)));
+            const __m512 mag = _mm512_mask_blend_ps(is_min, min1, min2);
+            const __m512i sign = _mm512_and_si512(_mm512_xor_si512(parity, bits(q[i])), sign_bit);
+            const __m512 r_new = _mm512_castsi512_ps(_mm512_or_si512(bits(mag), sign));
+            _mm512_storeu_ps(edges + (first + i) * block_lanes, r_new);
+            _mm512_storeu_ps(posterior + g.columns[first + i] * block_lanes, _mm512_add_ps(q[i], r_new));
+        }
+    }
+}
+
+std::uint32_t syndrome_avx512(const CheckGraph& g, const float* posterior)
+{
+    __m512i failed = _mm512_setzero_si512();
+    for (std::size_t r = 0; r < g.rows; ++r) {
+        __m512i parity = _mm512_setzero_si512();
+        for (std::uint32_t e = g.row_start[r]; e < g.row_start[r + 1]; ++e)
+            parity = _mm512_xor_si512(parity, _mm512_loadu_si512(posterior + g.columns[e] * block_lanes));
+        failed = _mm512_or_si512(failed, parity);
+    }
+    return _mm512_cmplt_epi32_mask(failed, _mm512_setzero_si512());
+}
+
+} // namespace solarlens::modem::detail
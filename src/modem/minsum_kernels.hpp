@@ -0,0 +1,49 @@
+#pragma once
+
+// Per-ISA layered min-sum kernels behind BatchDecoder, built per
+// translation unit like the other SIMD kernels.
+//
+// Messages are interleaved across a block of 16 codewords: element
+// [v * block_lanes + lane] is lane's value for variable (or edge) v, so
+// each check update is the same instruction sequence on 16 independent
+// decodes.
+
+#include <cstddef>
+#include <cstdint>
+
+namespace solarlens::modem::detail {
+
+inline constexpr std::size_t block_lanes = 16;
+inline constexpr std::size_t max_check_degree = 64;
+
+struct CheckGraph {
+    std::size_t rows = 0;
+    const std::uint32_t* row_start = nullptr;
+    const std::uint32_t* columns = nullptr;
+};
+
+// One layered normalised min-sum pass over every check row. `posterior`
+// holds n * block_lanes LLRs (positive = 0), `edges` the check-to-variable
+// message of every edge, in CSR order.
+using IterateFn = void (*)(const CheckGraph& graph, float scale, float* posterior, float* edges);
+
+// Bit `lane` is set if that codeword's hard decisions violate any check.
+using SyndromeFn = std::uint32_t (*)(const CheckGraph& graph, const float* posterior);
+
+void iterate_scalar(const CheckGraph&, float, float*, float*);
+std::uint32_t syndrome_scalar(const CheckGraph&, const float*);
+
+#if defined(SOLARLENS_HAVE_AVX2)
+void iterate_avx2(const CheckGraph&, float, float*, float*);
+std::uint32_t syndrome_avx2(const CheckGraph&, const float*);
+#endif
+#if defined(SOLARLENS_HAVE_AVX512)
+void iterate_avx512(const CheckGraph&, float, float*, float*);
+std::uint32_t syndrome_avx512(const CheckGraph&, const float*);
+#endif
+#if defined(SOLARLENS_HAVE_NEON)
+void iterate_neon(const CheckGraph&, float, float*, float*);
+std::uint32_t syndrome_neon(const CheckGraph&, const float*);
+#endif
+
+} // namespace solarlens::modem::detail
@@ -0,0 +1,70 @@
+// AArch64 NEON kernels: a block is four vectors of four codewords.
+
+#include <cmath>
+
+#include <arm_neon.h>
+
+#include "minsum_kernels.hpp"
+
+namespace solarlens::modem::detail {
+
+void iterate_neon(const CheckGraph& g, float scale, float* posterior, float* edges)
+{
+    constexpr std::size_t lanes = 4;
+    const uint32x4_t sign_bit = vdupq_n_u32(0x80000000u);
+    const float32x4_t inf = vdupq_n_f32(INFINITY);
+    float32x4_t q[max_check_degree];
+    for (std::size_t r = 0; r < g.rows; ++r) {
+        const std::uint32_t first = g.row_start[r];
+        const std::size_t degree = g.row_start[r + 1] - first;
+        for (std::size_t off = 0; off < block_lanes; off += lanes) {
+            float32x4_t min1 = inf;
+            float32x4_t min2 = inf;
+            uint32x4_t at = vdupq_n_u32(0);
+            uint32x4_t parity = vdupq_n_u32(0);
+            for (std::size_t i = 0; i < degree; ++i) {
+                q[i] = vsubq_f32(vld1q_f32(posterior + g.columns[first + i] * block_lanes + off),
+                                 vld1q_f32(edges + (first + i) * block_lanes + off));
+                const float32x4_t m = vabsq_f32(q[i]);
+                parity = veorq_u32(parity, vreinterpretq_u32_f32(q[i]));
+                const uint32x4_t lt = vcltq_f32(m, min1);
+                min2 = vbslq_f32(lt, min1, vminq_f32(min2, m));
+                min1 = vbslq_f32(lt, m, min1);
+                at = vbslq_u32(lt, vdupq_n_u32(static_cast<std::uint32_t>(i)), at);
+            }
+            min1 = vmulq_n_f32(min1, scale);
+            min2 = vmulq_n_f32(min2, scale);
+            for (std::size_t i = 0; i < degree; ++i) {
+                const uint32x4_t is_min = vceqq_u32(at, vdupq_n_u32(static_cast<std::uint32_t>(i)));
+                const float32x4_t mag = vbslq_f32(is_min, min2, min1);
+                const uint32x4_t sign = vandq_u32(veorq_u32(parity, vreinterpretq_u32_f32(q[i])), sign_bit);
+                const float32x4_t r_new = vreinterpretq_f32_u32(vorrq_u32(vreinterpretq_u32_f32(mag), sign));
+                vst1q_f32(edges + (first + i) * block_lanes + off, r_new);
+                vst1q_f32(posterior + g.columns[first + i] * block_lanes + off, vaddq_f32(q[i], r_new));
+            }
+        }
+    }
+}
+
+std::uint32_t syndrome_neon(const CheckGraph& g, const float* posterior)
+{
+    constexpr std::size_t lanes = 4;
+    std::uint32_t out = 0;
+    for (std::size_t off = 0; off < block_lanes; off += lanes) {
+        uint32x4_t failed = vdupq_n_u32(0);
+        for (std::size_t r = 0; r < g.rows; ++r) {
+            uint32x4_t parity = vdupq_n_u32(0);
+            for (std::uint32_t e = g.row_start[r]; e < g.row_start[r + 1]; ++e)
+                parity = veorq_u32(parity,
+                                   vreinterpretq_u32_f32(vld1q_f32(posterior + g.columns[e] * block_lanes + off)));
+            failed = vorrq_u32(failed, parity);
+        }
+        std::uint32_t flag[lanes];
+        vst1q_u32(flag, vshrq_n_u32(failed, 31));
+        for (std::size_t lane = 0; lane < lanes; ++lane)
+            out |= flag[lane] << (off + lane);
+    }
+    return out;
+}
+
+} // namespace solarlens::modem::detail
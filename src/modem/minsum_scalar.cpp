@@ -0,0 +1,57 @@
+// Reference kernels.
+
+#include <cmath>
+#include <cstring>
+
+#include "minsum_kernels.hpp"
+
+namespace solarlens::modem::detail {
+
+void iterate_scalar(const CheckGraph& g, float scale, float* posterior, float* edges)
+{
+    float q[max_check_degree];
+    for (std::size_t r = 0; r < g.rows; ++r) {
+        const std::uint32_t first = g.row_start[r];
+        const std::size_t degree = g.row_start[r + 1] - first;
+        for (std::size_t lane = 0; lane < block_lanes; ++lane) {
+            float min1 = INFINITY;
+            float min2 = INFINITY;
+            std::size_t at = 0;
+            bool negative = false;
+            for (std::size_t i = 0; i < degree; ++i) {
+                const std::size_t e = (first + i) * block_lanes + lane;
+                q[i] = posterior[g.columns[first + i] * block_lanes + lane] - edges[e];
+                const float m = std::fabs(q[i]);
+                negative ^= std::signbit(q[i]);
+                if (m < min1) {
+                    min2 = min1;
+                    min1 = m;
+                    at = i;
+                } else if (m < min2) {
+                    min2 = m;
+                }
+            }
+            for (std::size_t i = 0; i < degree; ++i) {
+                const float mag = scale * (i == at ? min2 : min1);
+                const float r_new = negative != std::signbit(q[i]) ? -mag : mag;
+                edges[(first + i) * block_lanes + lane] = r_new;
+                posterior[g.columns[first + i] * block_lanes + lane] = q[i] + r_new;
+            }
+        }
+    }
+}
+
+std::uint32_t syndrome_scalar(const CheckGraph& g, const float* posterior)
+{
+    std::uint32_t failed = 0;
+    for (std::size_t r = 0; r < g.rows; ++r)
+        for (std::size_t lane = 0; lane < block_lanes; ++lane) {
+            bool parity = false;
+            for (std::uint32_t e = g.row_start[r]; e < g.row_start[r + 1]; ++e)
+                parity ^= std::signbit(posterior[g.columns[e] * block_lanes + lane]);
+            failed |= std::uint32_t(parity) << lane;
+        }
+    return failed;
+}
+
+} // namespace solarlens::modem::detail
@@ -0,0 +1,33 @@
+// AVX2 kernel: eight channels per step.
+
+#include <immintrin.h>
+
+#include "taylor_impl.hpp"
+
+namespace solarlens::modem::detail {
+
+namespace {
+
+struct Avx2 {
+    using reg = __m256;
+    static constexpr std::size_t lanes = 8;
+    static reg load(const float* p) noexcept { return _mm256_loadu_ps(p); }
+    static void store(float* p, reg v) noexcept { _mm256_storeu_ps(p, v); }
+    static reg set1(float v) noexcept { return _mm256_set1_ps(v); }
+    static reg add(reg a, reg b) noexcept { return _mm256_add_ps(a, b); }
+    static void keep_max(reg v, reg id, reg& best, reg& best_id) noexcept
+    {
+        const __m256 gt = _mm256_cmp_ps(v, best, _CMP_GT_OQ);
+        best = _mm256_blendv_ps(best, v, gt);
+        best_id = _mm256_blendv_ps(best_id, id, gt);
+    }
+};
+
+} // namespace
+
+void taylor_avx2(const TaylorArgs& args)
+{
+    taylor_tree<Avx2>(args);
+}
+
+} // namespace solarlens::modem::detail
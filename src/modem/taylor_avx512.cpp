@@ -0,0 +1,33 @@
+// AVX-512F kernel: sixteen channels per step.
+
+#include <immintrin.h>
+
+#include "taylor_impl.hpp"
+
+namespace solarlens::modem::detail {
+
+namespace {
+
+struct Avx512 {
+    using reg = __m512;
+    static constexpr std::size_t lanes = 16;
+    static reg load(const float* p) noexcept { return _mm512_loadu_ps(p); }
+    static void store(float* p, reg v) noexcept { _mm512_storeu_ps(p, v); }
+    static reg set1(float v) noexcept { return _mm512_set1_ps(v); }
+    static reg add(reg a, reg b) noexcept { return _mm512_add_ps(a, b); }
+    static void keep_max(reg v, reg id, reg& best, reg& best_id) noexcept
+    {
+        const __mmask16 gt = _mm512_cmp_ps_mask(v, best, _CMP_GT_OQ);
+        best = _mm512_mask_blend_ps(gt, best, v);
+        best_id = _mm512_mask_blend_ps(gt, best_id, id);
+    }
+};
+
+} // namespace
+
+void taylor_avx512(const TaylorArgs& args)
+{
+    taylor_tree<Avx512>(args);
+}
+
+} // namespace solarlens::modem::detail
@@ -0,0 +1,73 @@
+#pragma once
+
+// The Taylor tree, written once over a vector traits type V and included
+// by each per-ISA translation unit with its own V:
+//
+//   V::lanes, V::reg, load, store, set1, add, and keep_max(v, id, best,
+//   best_id), which takes v and id in the lanes where v > best.
+
+#include <algorithm>
+#include <utility>
+
+#include "taylor_kernels.hpp"
+
+namespace solarlens::modem::detail {
+
+template <typename V>
+void add_rows(const float* a, const float* b, float* out, std::size_t n)
+{
+    std::size_t i = 0;
+    for (; i + V::lanes <= n; i += V::lanes)
+        V::store(out + i, V::add(V::load(a + i), V::load(b + i)));
+    for (; i < n; ++i)
+        out[i] = a[i] + b[i];
+}
+
+template <typename V>
+void taylor_tree(const TaylorArgs& a)
+{
+    // After the pass for groups of `half` spectra, row base + d of each
+    // group holds its drift-d sums. Two groups A, B of `half` make drift d
+    // of the combined one from A's drift d / 2 and B's drift d / 2 starting
+    // (d + 1) / 2 channels along, so the combined path ends d channels on.
+    const std::size_t w = a.width;
+    float* src = a.data;
+    float* dst = a.scratch;
+    for (std::size_t half = 1; half < a.rows; half *= 2) {
+        for (std::size_t base = 0; base < a.rows; base += 2 * half)
+            for (std::size_t d = 0; d < 2 * half; ++d) {
+                const std::size_t shift = (d + 1) / 2;
+                const float* lo = src + (base + d / 2) * w;
+                const float* hi = src + (base + half + d / 2) * w + shift;
+                float* out = dst + (base + d) * w;
+                add_rows<V>(lo, hi, out, w - shift);
+                // Past the end of the row; no requested channel reaches it.
+                std::fill(out + (w - shift), out + w, 0.0f);
+            }
+        std::swap(src, dst);
+    }
+
+    const std::size_t n = a.channels;
+    std::copy_n(src, n, a.straight);
+    std::copy_n(src, n, a.best);
+    std::fill_n(a.best_drift, n, 0.0f);
+    for (std::size_t d = 1; d < a.drifts; ++d) {
+        const float* row = src + d * w;
+        const auto id = V::set1(float(d));
+        std::size_t i = 0;
+        for (; i + V::lanes <= n; i += V::lanes) {
+            auto best = V::load(a.best + i);
+            auto best_id = V::load(a.best_drift + i);
+            V::keep_max(V::load(row + i), id, best, best_id);
+            V::store(a.best + i, best);
+            V::store(a.best_drift + i, best_id);
+        }
+        for (; i < n; ++i)
+            if (row[i] > a.best[i]) {
+                a.best[i] = row[i];
+                a.best_drift[i] = float(d);
+            }
+    }
+}
+
+} // namespace solarlens::modem::detail
@@ -0,0 +1,46 @@
+#pragma once
+
+// Per-ISA Taylor tree de-Doppler kernels behind DriftSearcher, built per
+// translation unit like the other SIMD kernels.
+
+#include <cstddef>
+
+namespace solarlens::modem::detail {
+
+// Runs the Taylor tree over `rows` spectra of `width` channels each (rows
+// a power of two, row i at data + i * width), then folds drift rows
+// 0 .. drifts - 1 channel by channel. Drift d sums the path that starts at
+// channel f in the first spectrum and ends at f + d in the last. For each
+// of the first `channels` start channels (channels + rows - 1 <= width):
+//   best[f]       = max over d of that sum
+//   best_drift[f] = the d attaining it (the lowest on a tie)
+//   straight[f]   = the d = 0 sum
+// `data` and `scratch` (rows * width each) are both clobbered. Additions
+// happen in the same order on every ISA, so the results are bitwise equal.
+struct TaylorArgs {
+    std::size_t rows = 0;
+    std::size_t width = 0;
+    std::size_t channels = 0;
+    std::size_t drifts = 1;
+    float* data = nullptr;
+    float* scratch = nullptr;
+    float* best = nullptr;
+    float* best_drift = nullptr;
+    float* straight = nullptr;
+};
+
+using TaylorFn = void (*)(const TaylorArgs& args);
+
+void taylor_scalar(const TaylorArgs&);
+
+#if defined(SOLARLENS_HAVE_AVX2)
+void taylor_avx2(const TaylorArgs&);
+#endif
+#if defined(SOLARLENS_HAVE_AVX512)
+void taylor_avx512(const TaylorArgs&);
+#endif
+#if defined(SOLARLENS_HAVE_NEON)
+void taylor_neon(const TaylorArgs&);
+#endif
+
+} // namespace solarlens::modem::detail
@@ -0,0 +1,33 @@
+// AArch64 NEON kernel: four channels per step.
+
+#include <arm_neon.h>
+
+#include "taylor_impl.hpp"
+
+namespace solarlens::modem::detail {
+
+namespace {
+
+struct Neon {
+    using reg = float32x4_t;
+    static constexpr std::size_t lanes = 4;
+    static reg load(const float* p) noexcept { return vld1q_f32(p); }
+    static void store(float* p, reg v) noexcept { vst1q_f32(p, v); }
+    static reg set1(float v) noexcept { return vdupq_n_f32(v); }
+    static reg add(reg a, reg b) noexcept { return vaddq_f32(a, b); }
+    static void keep_max(reg v, reg id, reg& best, reg& best_id) noexcept
+    {
+        const uint32x4_t gt = vcgtq_f32(v, best);
+        best = vbslq_f32(gt, v, best);
+        best_id = vbslq_f32(gt, id, best_id);
+    }
+};
+
+} // namespace
+
+void taylor_neon(const TaylorArgs& args)
+{
+    taylor_tree<Neon>(args);
+}
+
+} // namespace solarlens::modem::detail
@@ -0,0 +1,32 @@
+// Reference kernel: one channel per step.
+
+#include "taylor_impl.hpp"
+
+namespace solarlens::modem::detail {
+
+namespace {
+
+struct Scalar {
+    using reg = float;
+    static constexpr std::size_t lanes = 1;
+    static reg load(const float* p) noexcept { return *p; }
+    static void store(float* p, reg v) noexcept { *p = v; }
+    static reg set1(float v) noexcept { return v; }
+    static reg add(reg a, reg b) noexcept { return a + b; }
+    static void keep_max(reg v, reg id, reg& best, reg& best_id) noexcept
+    {
+        if (v > best) {
+            best = v;
+            best_id = id;
+        }
+    }
+};
+
+} // namespace
+
+void taylor_scalar(const TaylorArgs& args)
+{
+    taylor_tree<Scalar>(args);
+}
+
+} // namespace solarlens::modem::detail
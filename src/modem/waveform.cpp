@@ -0,0 +1,111 @@
+#include "solarlens/modem/waveform.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+#include <vector>
+
+namespace solarlens::modem {
+
+void WaveformConfig::validate() const
+{
+    if (!(sample_rate_hz > 0) || samples_per_symbol == 0 || phase_segment == 0)
+        throw std::invalid_argument("modem: sample rate, symbol length and phase segment must be positive");
+    if (!(modulation_index > 0 && modulation_index < std::numbers::pi / 2))
+        throw std::invalid_argument("modem: modulation index must be in (0, pi/2) to leave a carrier");
+}
+
+void modulate(std::span<const std::uint8_t> bits, const WaveformConfig& config, double frequency_hz,
+              double phase, std::span<std::complex<float>> out)
+{
+    config.validate();
+    const std::size_t sps = config.samples_per_symbol;
+    if (out.size() < bits.size() * sps)
+        throw std::invalid_argument("modem: output too short for the symbols");
+    const double w = 2.0 * std::numbers::pi * frequency_hz / config.sample_rate_hz;
+    for (std::size_t k = 0; k < bits.size(); ++k) {
+        const double step = bits[k] & 1 ? -config.modulation_index : config.modulation_index;
+        for (std::size_t i = 0; i < sps; ++i) {
+            const std::size_t t = k * sps + i;
+            // Phase reduced per sample in double so long bursts stay exact.
+            const double p = std::fmod(w * double(t), 2.0 * std::numbers::pi) + phase + step;
+            out[t] = {static_cast<float>(std::cos(p)), static_cast<float>(std::sin(p))};
+        }
+    }
+}
+
+double demodulate(std::span<const std::complex<float>> samples, const WaveformConfig& config,
+                  double frequency_hz, std::span<float> llr)
+{
+    config.validate();
+    const std::size_t sps = config.samples_per_symbol;
+    const std::size_t symbols = llr.size();
+    if (samples.size() < symbols * sps)
+        throw std::invalid_argument("modem: not enough samples for the requested symbols");
+    if (symbols == 0)
+        return 0.0;
+
+    // Mix down and integrate each symbol. The oscillator is stepped by a
+    // unit rotation and renormalised every symbol.
+    const double w = -2.0 * std::numbers::pi * frequency_hz / config.sample_rate_hz;
+    const std::complex<double> rot(std::cos(w), std::sin(w));
+    std::complex<double> osc(1.0, 0.0);
+    std::vector<std::complex<double>> y(symbols);
+    for (std::size_t k = 0; k < symbols; ++k) {
+        std::complex<double> acc = 0.0;
+        for (std::size_t i = 0; i < sps; ++i) {
+            acc += osc * std::complex<double>(samples[k * sps + i]);
+            osc *= rot;
+        }
+        osc /= std::abs(osc);
+        y[k] = acc;
+    }
+
+    // Carrier phase per segment; data averages out of the sum because the
+    // modulation is antipodal about the carrier.
+    const std::size_t seg = std::min(config.phase_segment, symbols);
+    const std::size_t segments = (symbols + seg - 1) / seg;
+    std::vector<double> phase(segments);
+    for (std::size_t s = 0; s < segments; ++s) {
+        std::complex<double> sum = 0.0;
+        for (std::size_t k = s * seg; k < std::min(symbols, (s + 1) * seg); ++k)
+            sum += y[k];
+        // Unwrapped, so interpolation follows the shortest way round.
+        phase[s] = s == 0 ? std::arg(sum)
+                          : phase[s - 1] + std::remainder(std::arg(sum) - phase[s - 1], 2.0 * std::numbers::pi);
+    }
+    const auto phase_at = [&](std::size_t k) {
+        const double pos = (double(k) + 0.5) / double(seg) - 0.5;
+        if (segments == 1 || pos <= 0.0)
+            return phase.front();
+        if (pos >= double(segments - 1))
+            return phase.back();
+        const auto s = static_cast<std::size_t>(pos);
+        const double f = pos - double(s);
+        return phase[s] + f * (phase[s + 1] - phase[s]);
+    };
+
+    // Derotated symbols: carrier on the real axis, data on the imaginary.
+    // The real part's spread is the noise per component.
+    double carrier = 0.0;
+    double data_power = 0.0;
+    for (std::size_t k = 0; k < symbols; ++k) {
+        y[k] *= std::polar(1.0, -phase_at(k));
+        carrier += y[k].real();
+        data_power += y[k].imag() * y[k].imag();
+    }
+    carrier /= double(symbols);
+    double noise = 0.0;
+    for (const auto& z : y)
+        noise += (z.real() - carrier) * (z.real() - carrier);
+    noise = std::max(noise / double(symbols), 1e-30);
+    // E[x^2] = a^2 + noise, with a the data amplitude.
+    const double a = std::sqrt(std::max(data_power / double(symbols) - noise, 0.0));
+    const double scale = 2.0 * a / noise;
+    for (std::size_t k = 0; k < symbols; ++k)
+        llr[k] = static_cast<float>(scale * y[k].imag());
+    return a * a / (2.0 * noise);
+}
+
+} // namespace solarlens::modem
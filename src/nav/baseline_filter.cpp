@@ -0,0 +1,294 @@
+#include "solarlens/nav/baseline_filter.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "solarlens/nav/propagator.hpp"
+#include "solarlens/perf/instrument.hpp"
+
+namespace solarlens::nav {
+
+namespace {
+
+constexpr std::size_t n = BaselineFilter::state_size;
+
+constexpr double sun_gm_km3_s2 = 1.32712440018e11;
+
+constexpr double two_pi = 6.283185307179586;
+
+double norm(const Vec3& v) noexcept
+{
+    return std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+}
+
+// Linearized observation row d h / d x for `kind`, 9 wide.
+void jacobian(Observable kind, const RelativeState& s, double* row) noexcept
+{
+    std::fill(row, row + n, 0.0);
+    const Vec3& p = s.position_km;
+    const Vec3& v = s.velocity_km_s;
+    const double rho = norm(p);
+    if (rho == 0.0)
+        return;
+    switch (kind) {
+    case Observable::range:
+        for (std::size_t i = 0; i < 3; ++i)
+            row[i] = p[i] / rho;
+        break;
+    case Observable::range_rate: {
+        const double rate = (p[0] * v[0] + p[1] * v[1] + p[2] * v[2]) / rho;
+        for (std::size_t i = 0; i < 3; ++i) {
+            row[i] = (v[i] - rate * p[i] / rho) / rho;
+            row[3 + i] = p[i] / rho;
+        }
+        break;
+    }
+    case Observable::azimuth: {
+        const double s2 = p[0] * p[0] + p[1] * p[1];
+        if (s2 == 0.0)
+            return;
+        row[0] = -p[1] / s2;
+        row[1] = p[0] / s2;
+        break;
+    }
+    case Observable::elevation: {
+        const double s = std::sqrt(p[0] * p[0] + p[1] * p[1]);
+        const double rho2 = rho * rho;
+        if (s == 0.0)
+            return;
+        row[0] = -p[0] * p[2] / (rho2 * s);
+        row[1] = -p[1] * p[2] / (rho2 * s);
+        row[2] = s / rho2;
+        break;
+    }
+    }
+}
+
+} // namespace
+
+const char* to_string(Observable kind) noexcept
+{
+    switch (kind) {
+    case Observable::range:
+        return "range";
+    case Observable::range_rate:
+        return "range_rate";
+    case Observable::azimuth:
+        return "azimuth";
+    case Observable::elevation:
+        return "elevation";
+    }
+    return "unknown";
+}
+
+void BaselineFilterConfig::validate() const
+{
+    if (norm(chief_position_au) == 0.0)
+        throw std::invalid_argument("BaselineFilter: chief cannot be at the Sun");
+    if (!(acceleration_psd >= 0.0) || !(bias_psd >= 0.0))
+        throw std::invalid_argument("BaselineFilter: process noise must be non-negative");
+    if (!(position_sigma_km > 0.0) || !(velocity_sigma_km_s > 0.0) || !(bias_sigma_km_s2 > 0.0))
+        throw std::invalid_argument("BaselineFilter: prior sigmas must be positive");
+    if (!(gate_sigma >= 0.0))
+        throw std::invalid_argument("BaselineFilter: gate must be non-negative");
+}
+
+BaselineFilter::BaselineFilter(const BaselineFilterConfig& config, std::span<const RelativeState> deputies)
+    : config_(config)
+    , filters_(deputies.empty() ? 1 : deputies.size())
+{
+    config_.validate();
+    if (deputies.empty())
+        throw std::invalid_argument("BaselineFilter: need at least one deputy");
+    Vector<n> sigma;
+    for (std::size_t i = 0; i < 3; ++i) {
+        sigma[i] = config_.position_sigma_km;
+        sigma[3 + i] = config_.velocity_sigma_km_s;
+        sigma[6 + i] = config_.bias_sigma_km_s2;
+    }
+    for (std::size_t f = 0; f < deputies.size(); ++f) {
+        Vector<n> x;
+        for (std::size_t i = 0; i < 3; ++i) {
+            x[i] = deputies[f].position_km[i];
+            x[3 + i] = deputies[f].velocity_km_s[i];
+        }
+        filters_.initialize(f, x, sigma);
+    }
+    const std::size_t s = filters_.stride();
+    h_.assign(n * s, 0.0);
+    innovation_.assign(s, 0.0);
+    variance_.assign(s, 1.0);
+    active_.assign(deputies.size(), 0);
+    cursor_.assign(deputies.size(), 0);
+}
+
+double BaselineFilter::predicted(Observable kind, const RelativeState& state) noexcept
+{
+    const Vec3& p = state.position_km;
+    const Vec3& v = state.velocity_km_s;
+    const double rho = norm(p);
+    switch (kind) {
+    case Observable::range:
+        return rho;
+    case Observable::range_rate:
+        return rho == 0.0 ? 0.0 : (p[0] * v[0] + p[1] * v[1] + p[2] * v[2]) / rho;
+    case Observable::azimuth:
+        return std::atan2(p[1], p[0]);
+    case Observable::elevation:
+        return rho == 0.0 ? 0.0 : std::asin(std::clamp(p[2] / rho, -1.0, 1.0));
+    }
+    return 0.0;
+}
+
+Matrix<n, n> BaselineFilter::transition(const Vec3& chief_au, double dt) noexcept
+{
+    // Gravity gradient G at the chief; Phi is the series of exp(A dt) for
+    // r'' = G r + b, to second order in G dt^2 (about 1e-9 over a month).
+    const Vec3 r {chief_au[0] * au_km, chief_au[1] * au_km, chief_au[2] * au_km};
+    const double d = norm(r);
+    const double k = sun_gm_km3_s2 / (d * d * d);
+    Matrix<3, 3> g;
+    for (std::size_t i = 0; i < 3; ++i)
+        for (std::size_t j = 0; j < 3; ++j)
+            g(i, j) = k * (3.0 * r[i] * r[j] / (d * d) - (i == j ? 1.0 : 0.0));
+
+    const double dt2 = dt * dt;
+    Matrix<n, n> phi = Matrix<n, n>::identity();
+    for (std::size_t i = 0; i < 3; ++i) {
+        for (std::size_t j = 0; j < 3; ++j) {
+            phi(i, j) += g(i, j) * dt2 / 2.0;
+            phi(i, 3 + j) += g(i, j) * dt2 * dt / 6.0;
+            phi(3 + i, j) += g(i, j) * dt;
+            phi(3 + i, 3 + j) += g(i, j) * dt2 / 2.0;
+        }
+        phi(i, 3 + i) += dt;
+        phi(i, 6 + i) += dt2 / 2.0;
+        phi(3 + i, 6 + i) += dt;
+    }
+    return phi;
+}
+
+void BaselineFilter::advance(double t)
+{
+    if (!(t >= time_))
+        throw std::invalid_argument("BaselineFilter: cannot advance backwards");
+    const double dt = t - time_;
+    if (dt == 0.0)
+        return;
+    // White acceleration noise per axis is q [dt^3/3, dt^2/2; dt^2/2, dt],
+    // which factors as U D U^T with U = [1, dt/2; 0, 1] and
+    // D = diag(q dt^3 / 12, q dt). The bias walk's leakage into position
+    // and velocity is below the acceleration noise and is left out.
+    Matrix<n, n> gamma = Matrix<n, n>::identity();
+    Vector<n> q;
+    for (std::size_t i = 0; i < 3; ++i) {
+        gamma(i, 3 + i) = dt / 2.0;
+        q[i] = config_.acceleration_psd * dt * dt * dt / 12.0;
+        q[3 + i] = config_.acceleration_psd * dt;
+        q[6 + i] = config_.bias_psd * dt;
+    }
+    filters_.predict(transition(config_.chief_position_au, dt), gamma, q);
+    time_ = t;
+}
+
+void BaselineFilter::process(std::span<const BaselineObservation> observations)
+{
+    static const perf::Stage stage("nav.baseline_filter");
+    perf::ScopedTimer timer(stage);
+    double last = time_;
+    for (const auto& o : observations) {
+        if (!(o.t >= last))
+            throw std::invalid_argument("BaselineFilter: observations must be sorted and not in the past");
+        if (o.deputy >= size())
+            throw std::out_of_range("BaselineFilter: deputy index out of range");
+        if (!(o.sigma > 0.0))
+            throw std::invalid_argument("BaselineFilter: observation sigma must be positive");
+        last = o.t;
+    }
+    std::size_t begin = 0;
+    while (begin < observations.size()) {
+        std::size_t end = begin + 1;
+        while (end < observations.size() && observations[end].t == observations[begin].t)
+            ++end;
+        epoch(observations.subspan(begin, end - begin));
+        begin = end;
+    }
+}
+
+void BaselineFilter::epoch(std::span<const BaselineObservation> observations)
+{
+    advance(observations.front().t);
+    ++stats_.epochs;
+    const std::size_t s = filters_.stride();
+    // Pass p applies each deputy's p-th observation of the epoch, so every
+    // pass is one batched scalar update, linearized about the estimate the
+    // previous pass left.
+    for (std::uint32_t pass = 0;; ++pass) {
+        std::fill(active_.begin(), active_.end(), 0);
+        std::fill(cursor_.begin(), cursor_.end(), 0);
+        std::size_t lanes = 0;
+        for (const auto& o : observations) {
+            if (cursor_[o.deputy]++ != pass)
+                continue;
+            const std::size_t f = o.deputy;
+            const Vector<n> x = filters_.state(f);
+            const RelativeState state {{x[0], x[1], x[2]}, {x[3], x[4], x[5]}};
+            double row[n];
+            jacobian(o.kind, state, row);
+            for (std::size_t i = 0; i < n; ++i)
+                h_[i * s + f] = row[i];
+            double innovation = o.value - predicted(o.kind, state);
+            if (o.kind == Observable::azimuth)
+                innovation = std::remainder(innovation, two_pi);
+            innovation_[f] = innovation;
+            variance_[f] = o.sigma * o.sigma;
+            active_[f] = 1;
+            ++lanes;
+        }
+        if (lanes == 0)
+            break;
+        const std::size_t applied = filters_.update(h_.data(), innovation_.data(), variance_.data(), active_.data(),
+                                                    config_.gate_sigma);
+        stats_.observations += lanes;
+        stats_.rejected += lanes - applied;
+        // Idle lanes must see zero rows in the next pass.
+        for (std::size_t f = 0; f < size(); ++f)
+            for (std::size_t i = 0; i < n; ++i)
+                h_[i * s + f] = 0.0;
+    }
+}
+
+BaselineEstimate BaselineFilter::estimate(std::size_t deputy) const
+{
+    const Vector<n> x = filters_.state(deputy);
+    const Vector<n> sigma = filters_.sigma(deputy);
+    BaselineEstimate e;
+    for (std::size_t i = 0; i < 3; ++i) {
+        e.state.position_km[i] = x[i];
+        e.state.velocity_km_s[i] = x[3 + i];
+        e.bias_km_s2[i] = x[6 + i];
+        e.position_sigma_km[i] = sigma[i];
+        e.velocity_sigma_km_s[i] = sigma[3 + i];
+    }
+    return e;
+}
+
+Vec3 BaselineFilter::baseline_km(std::size_t i, std::size_t j) const
+{
+    const Vector<n> a = filters_.state(i);
+    const Vector<n> b = filters_.state(j);
+    return {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+}
+
+Vec3 BaselineFilter::baseline_sigma_km(std::size_t i, std::size_t j) const
+{
+    const Vector<n> a = filters_.sigma(i);
+    const Vector<n> b = filters_.sigma(j);
+    Vec3 s;
+    for (std::size_t k = 0; k < 3; ++k)
+        s[k] = i == j ? 0.0 : std::sqrt(a[k] * a[k] + b[k] * b[k]);
+    return s;
+}
+
+} // namespace solarlens::nav
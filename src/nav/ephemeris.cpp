@@ -0,0 +1,102 @@
+#include "solarlens/nav/ephemeris.hpp"
+
+#include <cmath>
+#include <numbers>
+
+namespace solarlens::nav {
+
+namespace {
+
+struct Elements {
+    double a, e, i, l, peri, node;             ///< AU, -, deg, deg, deg, deg at J2000.
+    double a_dot, e_dot, i_dot, l_dot, peri_dot, node_dot; ///< Per Julian century.
+    double mass_ratio;                         ///< Sun mass / body mass.
+};
+
+// Table 1 of Standish, "Keplerian Elements for Approximate Positions of
+// the Major Planets"; mass ratios from DE405.
+constexpr Elements elements[planet_count] = {
+    {0.38709927, 0.20563593, 7.00497902, 252.25032350, 77.45779628, 48.33076593,
+     0.00000037, 0.00001906, -0.00594749, 149472.67411175, 0.16047689, -0.12534081, 6023600.0},
+    {0.72333566, 0.00677672, 3.39467605, 181.97909950, 131.60246718, 76.67984255,
+     0.00000390, -0.00004107, -0.00078890, 58517.81538729, 0.00268329, -0.27769418, 408523.71},
+    {1.00000261, 0.01671123, -0.00001531, 100.46457166, 102.93768193, 0.0,
+     0.00000562, -0.00004392, -0.01294668, 35999.37244981, 0.32327364, 0.0, 328900.56},
+    {1.52371034, 0.09339410, 1.84969142, -4.55343205, -23.94362959, 49.55953891,
+     0.00001847, 0.00007882, -0.00813131, 19140.30268499, 0.44441088, -0.29257343, 3098708.0},
+    {5.20288700, 0.04838624, 1.30439695, 34.39644051, 14.72847983, 100.47390909,
+     -0.00011607, -0.00013253, -0.00183714, 3034.74612775, 0.21252668, 0.20469106, 1047.3486},
+    {9.53667594, 0.05386179, 2.48599187, 49.95424423, 92.59887831, 113.66242448,
+     -0.00125060, -0.00050991, 0.00193609, 1222.49362201, -0.41897216, -0.28867794, 3497.898},
+    {19.18916464, 0.04725744, 0.77263783, 313.23810451, 170.95427630, 74.01692503,
+     -0.00196176, -0.00004397, -0.00242939, 428.48202785, 0.40805281, 0.04240589, 22902.98},
+    {30.06992276, 0.00859048, 1.77004347, -55.12002969, 44.96476227, 131.78422574,
+     0.00026291, 0.00005105, 0.00035372, 218.45945325, -0.32241464, -0.01262724, 19412.24},
+};
+
+constexpr double deg = std::numbers::pi / 180.0;
+constexpr double days_per_century = 36525.0;
+
+} // namespace
+
+const char* to_string(Planet planet) noexcept
+{
+    switch (planet) {
+    case Planet::mercury:
+        return "mercury";
+    case Planet::venus:
+        return "venus";
+    case Planet::earth_moon:
+        return "earth_moon";
+    case Planet::mars:
+        return "mars";
+    case Planet::jupiter:
+        return "jupiter";
+    case Planet::saturn:
+        return "saturn";
+    case Planet::uranus:
+        return "uranus";
+    case Planet::neptune:
+        return "neptune";
+    }
+    return "unknown";
+}
+
+double planet_gm(Planet planet) noexcept
+{
+    return sun_gm / elements[static_cast<std::size_t>(planet)].mass_ratio;
+}
+
+Vec3 planet_position(Planet planet, double t) noexcept
+{
+    const Elements& el = elements[static_cast<std::size_t>(planet)];
+    const double c = t / days_per_century;
+    const double a = el.a + el.a_dot * c;
+    const double e = el.e + el.e_dot * c;
+    const double i = (el.i + el.i_dot * c) * deg;
+    const double l = (el.l + el.l_dot * c) * deg;
+    const double peri = (el.peri + el.peri_dot * c) * deg;
+    const double node = (el.node + el.node_dot * c) * deg;
+
+    const double omega = peri - node; // Argument of perihelion.
+    const double m = std::remainder(l - peri, 2.0 * std::numbers::pi);
+    double ecc = m + e * std::sin(m);
+    for (int k = 0; k < 8; ++k) {
+        const double d = (ecc - e * std::sin(ecc) - m) / (1.0 - e * std::cos(ecc));
+        ecc -= d;
+        if (std::abs(d) < 1e-14)
+            break;
+    }
+    // Orbital plane, x towards perihelion.
+    const double xp = a * (std::cos(ecc) - e);
+    const double yp = a * std::sqrt(1.0 - e * e) * std::sin(ecc);
+
+    const double co = std::cos(omega), so = std::sin(omega);
+    const double cn = std::cos(node), sn = std::sin(node);
+    const double ci = std::cos(i), si = std::sin(i);
+    return {(co * cn - so * sn * ci) * xp + (-so * cn - co * sn * ci) * yp,
+            (co * sn + so * cn * ci) * xp + (-so * sn + co * cn * ci) * yp,
+            (so * si) * xp + (co * si) * yp};
+}
+
+} // namespace solarlens::nav
@@ -0,0 +1,50 @@
+// AVX2 + FMA kernel: four craft per step, scalar tail.
+
+#include <immintrin.h>
+
+#include "gravity_kernels.hpp"
+
+namespace solarlens::nav::detail {
+
+void gravity_avx2(std::size_t n, const double* x, const double* y, const double* z,
+                  const double* srp, double sun_gm, const GravityBodies& b, double* ax,
+                  double* ay, double* az)
+{
+    constexpr std::size_t lanes = 4;
+    const __m256d one = _mm256_set1_pd(1.0);
+    const __m256d gm_sun = _mm256_set1_pd(sun_gm);
+    const __m256d ind_x = _mm256_set1_pd(b.indirect[0]);
+    const __m256d ind_y = _mm256_set1_pd(b.indirect[1]);
+    const __m256d ind_z = _mm256_set1_pd(b.indirect[2]);
+    std::size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        const __m256d px = _mm256_loadu_pd(x + i);
+        const __m256d py = _mm256_loadu_pd(y + i);
+        const __m256d pz = _mm256_loadu_pd(z + i);
+        const __m256d r2 = _mm256_fmadd_pd(pz, pz, _mm256_fmadd_pd(py, py, _mm256_mul_pd(px, px)));
+        const __m256d inv_r = _mm256_div_pd(one, _mm256_sqrt_pd(r2));
+        const __m256d inv_r3 = _mm256_mul_pd(_mm256_mul_pd(inv_r, inv_r), inv_r);
+        const __m256d s = _mm256_mul_pd(_mm256_sub_pd(_mm256_loadu_pd(srp + i), gm_sun), inv_r3);
+        __m256d aix = _mm256_fmsub_pd(s, px, ind_x);
+        __m256d aiy = _mm256_fmsub_pd(s, py, ind_y);
+        __m256d aiz = _mm256_fmsub_pd(s, pz, ind_z);
+        for (std::size_t k = 0; k < b.count; ++k) {
+            const __m256d dx = _mm256_sub_pd(_mm256_set1_pd(b.x[k]), px);
+            const __m256d dy = _mm256_sub_pd(_mm256_set1_pd(b.y[k]), py);
+            const __m256d dz = _mm256_sub_pd(_mm256_set1_pd(b.z[k]), pz);
+            const __m256d d2 = _mm256_fmadd_pd(dz, dz, _mm256_fmadd_pd(dy, dy, _mm256_mul_pd(dx, dx)));
+            const __m256d inv_d = _mm256_div_pd(one, _mm256_sqrt_pd(d2));
+            const __m256d g = _mm256_mul_pd(_mm256_set1_pd(b.gm[k]),
+                                            _mm256_mul_pd(_mm256_mul_pd(inv_d, inv_d), inv_d));
+            aix = _mm256_fmadd_pd(g, dx, aix);
+            aiy = _mm256_fmadd_pd(g, dy, aiy);
+            aiz = _mm256_fmadd_pd(g, dz, aiz);
+        }
+        _mm256_storeu_pd(ax + i, aix);
+        _mm256_storeu_pd(ay + i, aiy);
+        _mm256_storeu_pd(az + i, aiz);
+    }
+    gravity_scalar(n - i, x + i, y + i, z + i, srp + i, sun_gm, b, ax + i, ay + i, az + i);
+}
+
+} // namespace solarlens::nav::detail
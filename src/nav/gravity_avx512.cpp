@@ -0,0 +1,62 @@
+// AVX-512F kernel: eight craft per step, scalar tail.
+
+#include <immintrin.h>
+
+#include "gravity_kernels.hpp"
+
+namespace solarlens::nav::detail {
+
+namespace {
+
+// _mm512_sqrt_pd passes an undefined register through the masked builtin,
+// which GCC 12 reports as maybe-uninitialized; the zero-masked form with
+// every lane set is the same instruction.
+__m512d sqrt_pd(__m512d v)
+{
+    return _mm512_maskz_sqrt_pd(__mmask8(0xFF), v);
+}
+
+} // namespace
+
+void gravity_avx512(std::size_t n, const double* x, const double* y, const double* z,
+                  const double* srp, double sun_gm, const GravityBodies& b, double* ax,
+                  double* ay, double* az)
+{
+    constexpr std::size_t lanes = 8;
+    const __m512d one = _mm512_set1_pd(1.0);
+    const __m512d gm_sun = _mm512_set1_pd(sun_gm);
+    const __m512d ind_x = _mm512_set1_pd(b.indirect[0]);
+    const __m512d ind_y = _mm512_set1_pd(b.indirect[1]);
+    const __m512d ind_z = _mm512_set1_pd(b.indirect[2]);
+    std::size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        const __m512d px = _mm512_loadu_pd(x + i);
+        const __m512d py = _mm512_loadu_pd(y + i);
+        const __m512d pz = _mm512_loadu_pd(z + i);
+        const __m512d r2 = _mm512_fmadd_pd(pz, pz, _mm512_fmadd_pd(py, py, _mm512_mul_pd(px, px)));
+        const __m512d inv_r = _mm512_div_pd(one, sqrt_pd(r2));
+        const __m512d inv_r3 = _mm512_mul_pd(_mm512_mul_pd(inv_r, inv_r), inv_r);
+        const __m512d s = _mm512_mul_pd(_mm512_sub_pd(_mm512_loadu_pd(srp + i), gm_sun), inv_r3);
+        __m512d aix = _mm512_fmsub_pd(s, px, ind_x);
+        __m512d aiy = _mm512_fmsub_pd(s, py, ind_y);
+        __m512d aiz = _mm512_fmsub_pd(s, pz, ind_z);
+        for (std::size_t k = 0; k < b.count; ++k) {
+            const __m512d dx = _mm512_sub_pd(_mm512_set1_pd(b.x[k]), px);
+            const __m512d dy = _mm512_sub_pd(_mm512_set1_pd(b.y[k]), py);
+            const __m512d dz = _mm512_sub_pd(_mm512_set1_pd(b.z[k]), pz);
+            const __m512d d2 = _mm512_fmadd_pd(dz, dz, _mm512_fmadd_pd(dy, dy, _mm512_mul_pd(dx, dx)));
+            const __m512d inv_d = _mm512_div_pd(one, sqrt_pd(d2));
+            const __m512d g = _mm512_mul_pd(_mm512_set1_pd(b.gm[k]),
+                                            _mm512_mul_pd(_mm512_mul_pd(inv_d, inv_d), inv_d));
+            aix = _mm512_fmadd_pd(g, dx, aix);
+            aiy = _mm512_fmadd_pd(g, dy, aiy);
+            aiz = _mm512_fmadd_pd(g, dz, aiz);
+        }
+        _mm512_storeu_pd(ax + i, aix);
+        _mm512_storeu_pd(ay + i, aiy);
+        _mm512_storeu_pd(az + i, aiz);
+    }
+    gravity_scalar(n - i, x + i, y + i, z + i, srp + i, sun_gm, b, ax + i, ay + i, az + i);
+}
+
+} // namespace solarlens::nav::detail
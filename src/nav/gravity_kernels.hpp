@@ -0,0 +1,45 @@
+#pragma once
+
+// Per-ISA acceleration kernels behind Propagator, built per translation
+// unit like the corona kernels; no inline code here.
+
+#include <cstddef>
+
+namespace solarlens::nav::detail {
+
+inline constexpr std::size_t max_bodies = 8;
+
+// Point masses acting on the swarm this stage; positions heliocentric.
+struct GravityBodies {
+    std::size_t count = 0;
+    double x[max_bodies] {};
+    double y[max_bodies] {};
+    double z[max_bodies] {};
+    double gm[max_bodies] {};
+    // Indirect term: the Sun's own acceleration towards the bodies,
+    // subtracted because the frame is heliocentric.
+    double indirect[3] {};
+};
+
+// a_i = -(sun_gm - srp_i) r_i / |r_i|^3 + sum_b gm_b (r_b - r_i) / |r_b - r_i|^3 - indirect.
+using GravityFn = void (*)(std::size_t n, const double* x, const double* y, const double* z,
+                           const double* srp, double sun_gm, const GravityBodies& bodies,
+                           double* ax, double* ay, double* az);
+
+void gravity_scalar(std::size_t, const double*, const double*, const double*, const double*,
+                    double, const GravityBodies&, double*, double*, double*);
+
+#if defined(SOLARLENS_HAVE_AVX2)
+void gravity_avx2(std::size_t, const double*, const double*, const double*, const double*,
+                  double, const GravityBodies&, double*, double*, double*);
+#endif
+#if defined(SOLARLENS_HAVE_AVX512)
+void gravity_avx512(std::size_t, const double*, const double*, const double*, const double*,
+                    double, const GravityBodies&, double*, double*, double*);
+#endif
+#if defined(SOLARLENS_HAVE_NEON)
+void gravity_neon(std::size_t, const double*, const double*, const double*, const double*,
+                  double, const GravityBodies&, double*, double*, double*);
+#endif
+
+} // namespace solarlens::nav::detail
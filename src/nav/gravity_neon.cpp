@@ -0,0 +1,50 @@
+// AArch64 NEON kernel: two craft per step, scalar tail.
+
+#include <arm_neon.h>
+
+#include "gravity_kernels.hpp"
+
+namespace solarlens::nav::detail {
+
+void gravity_neon(std::size_t n, const double* x, const double* y, const double* z,
+                  const double* srp, double sun_gm, const GravityBodies& b, double* ax,
+                  double* ay, double* az)
+{
+    constexpr std::size_t lanes = 2;
+    const float64x2_t one = vdupq_n_f64(1.0);
+    const float64x2_t gm_sun = vdupq_n_f64(sun_gm);
+    const float64x2_t ind_x = vdupq_n_f64(b.indirect[0]);
+    const float64x2_t ind_y = vdupq_n_f64(b.indirect[1]);
+    const float64x2_t ind_z = vdupq_n_f64(b.indirect[2]);
+    std::size_t i = 0;
+    for (; i + lanes <= n; i += lanes) {
+        const float64x2_t px = vld1q_f64(x + i);
+        const float64x2_t py = vld1q_f64(y + i);
+        const float64x2_t pz = vld1q_f64(z + i);
+        const float64x2_t r2 = vfmaq_f64(vfmaq_f64(vmulq_f64(px, px), py, py), pz, pz);
+        const float64x2_t inv_r = vdivq_f64(one, vsqrtq_f64(r2));
+        const float64x2_t inv_r3 = vmulq_f64(vmulq_f64(inv_r, inv_r), inv_r);
+        const float64x2_t s = vmulq_f64(vsubq_f64(vld1q_f64(srp + i), gm_sun), inv_r3);
+        float64x2_t aix = vsubq_f64(vmulq_f64(s, px), ind_x);
+        float64x2_t aiy = vsubq_f64(vmulq_f64(s, py), ind_y);
+        float64x2_t aiz = vsubq_f64(vmulq_f64(s, pz), ind_z);
+        for (std::size_t k = 0; k < b.count; ++k) {
+            const float64x2_t dx = vsubq_f64(vdupq_n_f64(b.x[k]), px);
+            const float64x2_t dy = vsubq_f64(vdupq_n_f64(b.y[k]), py);
+            const float64x2_t dz = vsubq_f64(vdupq_n_f64(b.z[k]), pz);
+            const float64x2_t d2 = vfmaq_f64(vfmaq_f64(vmulq_f64(dx, dx), dy, dy), dz, dz);
+            const float64x2_t inv_d = vdivq_f64(one, vsqrtq_f64(d2));
+            const float64x2_t g =
+                vmulq_f64(vdupq_n_f64(b.gm[k]), vmulq_f64(vmulq_f64(inv_d, inv_d), inv_d));
+            aix = vfmaq_f64(aix, g, dx);
+            aiy = vfmaq_f64(aiy, g, dy);
+            aiz = vfmaq_f64(aiz, g, dz);
+        }
+        vst1q_f64(ax + i, aix);
+        vst1q_f64(ay + i, aiy);
+        vst1q_f64(az + i, aiz);
+    }
+    gravity_scalar(n - i, x + i, y + i, z + i, srp + i, sun_gm, b, ax + i, ay + i, az + i);
+}
+
+} // namespace solarlens::nav::detail
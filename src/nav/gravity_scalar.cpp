@@ -0,0 +1,36 @@
+// Reference kernel and the tail for the SIMD ones.
+
+#include <cmath>
+
+#include "gravity_kernels.hpp"
+
+namespace solarlens::nav::detail {
+
+void gravity_scalar(std::size_t n, const double* x, const double* y, const double* z,
+                    const double* srp, double sun_gm, const GravityBodies& b, double* ax,
+                    double* ay, double* az)
+{
+    for (std::size_t i = 0; i < n; ++i) {
+        const double r2 = x[i] * x[i] + y[i] * y[i] + z[i] * z[i];
+        const double inv_r = 1.0 / std::sqrt(r2);
+        const double s = -(sun_gm - srp[i]) * inv_r * inv_r * inv_r;
+        double aix = s * x[i] - b.indirect[0];
+        double aiy = s * y[i] - b.indirect[1];
+        double aiz = s * z[i] - b.indirect[2];
+        for (std::size_t k = 0; k < b.count; ++k) {
+            const double dx = b.x[k] - x[i];
+            const double dy = b.y[k] - y[i];
+            const double dz = b.z[k] - z[i];
+            const double inv_d = 1.0 / std::sqrt(dx * dx + dy * dy + dz * dz);
+            const double g = b.gm[k] * inv_d * inv_d * inv_d;
+            aix += g * dx;
+            aiy += g * dy;
+            aiz += g * dz;
+        }
+        ax[i] = aix;
+        ay[i] = aiy;
+        az[i] = aiz;
+    }
+}
+
+} // namespace solarlens::nav::detail
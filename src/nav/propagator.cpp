@@ -0,0 +1,312 @@
+#include "solarlens/nav/propagator.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "gravity_kernels.hpp"
+#include "solarlens/core/snapshot.hpp"
+#include "solarlens/sched/scheduler.hpp"
+
+namespace solarlens::nav {
+
+namespace {
+
+// Solar radiation pressure at 1 AU, 4.56e-6 N/m^2, as AU/day^2 per m^2/kg.
+// Multiplied by (1 AU)^2 it is a GM-like coefficient in AU^3/day^2.
+constexpr double srp_per_area_mass = 4.56e-6 * 86400.0 * 86400.0 / 1.495978707e11;
+
+constexpr double mm_per_s_in_au_per_day = 1e-6 * 86400.0 / au_km;
+
+detail::GravityFn kernel_for(core::SimdLevel level)
+{
+    switch (level) {
+#if defined(SOLARLENS_HAVE_AVX512)
+    case core::SimdLevel::avx512:
+        return detail::gravity_avx512;
+#endif
+#if defined(SOLARLENS_HAVE_AVX2)
+    case core::SimdLevel::avx2:
+        return detail::gravity_avx2;
+#endif
+#if defined(SOLARLENS_HAVE_NEON)
+    case core::SimdLevel::neon:
+        return detail::gravity_neon;
+#endif
+    default:
+        return detail::gravity_scalar;
+    }
+}
+
+detail::GravityBodies bodies_at(double t, bool planets)
+{
+    detail::GravityBodies b;
+    if (!planets)
+        return b;
+    b.count = planet_count;
+    for (std::size_t k = 0; k < planet_count; ++k) {
+        const auto planet = static_cast<Planet>(k);
+        const Vec3 p = planet_position(planet, t);
+        const double gm = planet_gm(planet);
+        b.x[k] = p[0];
+        b.y[k] = p[1];
+        b.z[k] = p[2];
+        b.gm[k] = gm;
+        const double inv = 1.0 / std::sqrt(p[0] * p[0] + p[1] * p[1] + p[2] * p[2]);
+        const double g = gm * inv * inv * inv;
+        b.indirect[0] += g * p[0];
+        b.indirect[1] += g * p[1];
+        b.indirect[2] += g * p[2];
+    }
+    return b;
+}
+
+/// One RK4 integration of a swarm; the scratch arrays are reused across
+/// steps.
+class Rk4 {
+public:
+    Rk4(SwarmState& s, detail::GravityFn kernel, bool planets, bool srp)
+        : s_(s)
+        , kernel_(kernel)
+        , planets_(planets)
+        , n_(s.size())
+    {
+        for (std::vector<double>* v : {&px_, &py_, &pz_, &qx_, &qy_, &qz_, &ax_, &ay_, &az_,
+                                       &sx_, &sy_, &sz_, &svx_, &svy_, &svz_, &srp_})
+            v->resize(n_);
+        for (std::size_t i = 0; i < n_; ++i)
+            srp_[i] = srp ? srp_per_area_mass * s.cr_area_mass[i] : 0.0;
+    }
+
+    void step(double t, double h)
+    {
+        const detail::GravityBodies b0 = bodies_at(t, planets_);
+        const detail::GravityBodies bh = bodies_at(t + 0.5 * h, planets_);
+        const detail::GravityBodies b1 = bodies_at(t + h, planets_);
+
+        // Stage 1 at the current state: k1r = v, k1v = a(r).
+        accel(s_.x.data(), s_.y.data(), s_.z.data(), b0);
+        for (std::size_t i = 0; i < n_; ++i) {
+            sx_[i] = s_.vx[i];
+            sy_[i] = s_.vy[i];
+            sz_[i] = s_.vz[i];
+            svx_[i] = ax_[i];
+            svy_[i] = ay_[i];
+            svz_[i] = az_[i];
+        }
+        stage(0.5 * h, s_.vx.data(), s_.vy.data(), s_.vz.data(), bh, 2.0);
+        stage(0.5 * h, qx_.data(), qy_.data(), qz_.data(), bh, 2.0);
+        stage(h, qx_.data(), qy_.data(), qz_.data(), b1, 1.0);
+
+        const double w = h / 6.0;
+        for (std::size_t i = 0; i < n_; ++i) {
+            s_.x[i] += w * sx_[i];
+            s_.y[i] += w * sy_[i];
+            s_.z[i] += w * sz_[i];
+            s_.vx[i] += w * svx_[i];
+            s_.vy[i] += w * svy_[i];
+            s_.vz[i] += w * svz_[i];
+        }
+    }
+
+private:
+    void accel(const double* x, const double* y, const double* z, const detail::GravityBodies& b)
+    {
+        kernel_(n_, x, y, z, srp_.data(), sun_gm, b, ax_.data(), ay_.data(), az_.data());
+    }
+
+    /// Evaluates the next stage at r + c k_r, v + c k_v, where (k_r, k_v)
+    /// is the previous stage (velocity `kvx..`, acceleration in a*_), and
+    /// adds it to the sums with weight `weight`.
+    void stage(double c, const double* kvx, const double* kvy, const double* kvz,
+               const detail::GravityBodies& b, double weight)
+    {
+        for (std::size_t i = 0; i < n_; ++i) {
+            px_[i] = s_.x[i] + c * kvx[i];
+            py_[i] = s_.y[i] + c * kvy[i];
+            pz_[i] = s_.z[i] + c * kvz[i];
+            qx_[i] = s_.vx[i] + c * ax_[i];
+            qy_[i] = s_.vy[i] + c * ay_[i];
+            qz_[i] = s_.vz[i] + c * az_[i];
+        }
+        accel(px_.data(), py_.data(), pz_.data(), b);
+        for (std::size_t i = 0; i < n_; ++i) {
+            sx_[i] += weight * qx_[i];
+            sy_[i] += weight * qy_[i];
+            sz_[i] += weight * qz_[i];
+            svx_[i] += weight * ax_[i];
+            svy_[i] += weight * ay_[i];
+            svz_[i] += weight * az_[i];
+        }
+    }
+
+    SwarmState& s_;
+    detail::GravityFn kernel_;
+    bool planets_;
+    std::size_t n_;
+    std::vector<double> px_, py_, pz_; ///< Stage position.
+    std::vector<double> qx_, qy_, qz_; ///< Stage velocity.
+    std::vector<double> ax_, ay_, az_; ///< Stage acceleration.
+    std::vector<double> sx_, sy_, sz_, svx_, svy_, svz_; ///< Weighted stage sums.
+    std::vector<double> srp_;
+};
+
+std::uint64_t splitmix64(std::uint64_t x) noexcept
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+} // namespace
+
+void SwarmState::resize(std::size_t count)
+{
+    for (std::vector<double>* v : {&x, &y, &z, &vx, &vy, &vz, &cr_area_mass})
+        v->resize(count);
+}
+
+void SwarmState::set(std::size_t i, const StateVector& s, double cram) noexcept
+{
+    x[i] = s.r[0];
+    y[i] = s.r[1];
+    z[i] = s.r[2];
+    vx[i] = s.v[0];
+    vy[i] = s.v[1];
+    vz[i] = s.v[2];
+    cr_area_mass[i] = cram;
+}
+
+void SwarmState::append(const SwarmState& other)
+{
+    x.insert(x.end(), other.x.begin(), other.x.end());
+    y.insert(y.end(), other.y.begin(), other.y.end());
+    z.insert(z.end(), other.z.begin(), other.z.end());
+    vx.insert(vx.end(), other.vx.begin(), other.vx.end());
+    vy.insert(vy.end(), other.vy.begin(), other.vy.end());
+    vz.insert(vz.end(), other.vz.begin(), other.vz.end());
+    cr_area_mass.insert(cr_area_mass.end(), other.cr_area_mass.begin(), other.cr_area_mass.end());
+}
+
+void snapshot_swarm(const SwarmState& state, core::SnapshotWriter& writer, std::string_view section)
+{
+    core::SectionBuilder b;
+    for (const std::vector<double>* v : {&state.x, &state.y, &state.z, &state.vx, &state.vy, &state.vz,
+                                         &state.cr_area_mass})
+        b.put_array(std::span<const double>(*v));
+    writer.add(section, b);
+}
+
+SwarmState restore_swarm(const core::Snapshot& snapshot, std::string_view section)
+{
+    core::SectionReader r(snapshot.section(section), section);
+    SwarmState state;
+    for (std::vector<double>* v : {&state.x, &state.y, &state.z, &state.vx, &state.vy, &state.vz,
+                                   &state.cr_area_mass}) {
+        const std::span<const double> values = r.get_array<double>();
+        v->assign(values.begin(), values.end());
+        if (v->size() != state.x.size())
+            throw std::runtime_error("nav: swarm arrays differ in length in snapshot section " + std::string(section));
+    }
+    if (!r.done())
+        throw std::runtime_error("nav: trailing bytes in snapshot section " + std::string(section));
+    return state;
+}
+
+Propagator::Propagator(const PropagatorConfig& config)
+    : config_(config)
+{
+    if (!(config.step_days > 0))
+        throw std::invalid_argument("Propagator: step must be positive");
+    if (!core::simd_level_supported(config.simd))
+        throw std::invalid_argument(std::string("Propagator: SIMD level ")
+                                    + core::to_string(config.simd) + " not available");
+}
+
+void Propagator::propagate(SwarmState& state, double t0, double t1) const
+{
+    if (state.size() == 0 || t1 == t0)
+        return;
+    const auto steps = static_cast<std::size_t>(std::ceil(std::abs(t1 - t0) / config_.step_days - 1e-9));
+    const double h = (t1 - t0) / double(std::max<std::size_t>(steps, 1));
+    Rk4 rk(state, kernel_for(config_.simd), config_.planets, config_.radiation_pressure);
+    for (std::size_t k = 0; k < std::max<std::size_t>(steps, 1); ++k)
+        rk.step(t0 + double(k) * h, h);
+}
+
+void Propagator::acceleration(const SwarmState& state, double t, std::vector<double>& ax,
+                              std::vector<double>& ay, std::vector<double>& az) const
+{
+    const std::size_t n = state.size();
+    ax.resize(n);
+    ay.resize(n);
+    az.resize(n);
+    std::vector<double> srp(n);
+    for (std::size_t i = 0; i < n; ++i)
+        srp[i] = config_.radiation_pressure ? srp_per_area_mass * state.cr_area_mass[i] : 0.0;
+    kernel_for(config_.simd)(n, state.x.data(), state.y.data(), state.z.data(), srp.data(), sun_gm,
+                             bodies_at(t, config_.planets), ax.data(), ay.data(), az.data());
+}
+
+SwarmState propagate_dispersions(const Propagator& propagator, const SwarmState& nominal,
+                                 double t0, double t1, const DispersionConfig& config,
+                                 sched::Scheduler& scheduler)
+{
+    const std::size_t n = nominal.size();
+    SwarmState out(config.cases * n);
+    if (n == 0 || config.cases == 0)
+        return out;
+    // A few hundred craft per batch fills the SIMD loops without the
+    // arrays falling out of L2.
+    const std::size_t per_task =
+        config.cases_per_task != 0 ? config.cases_per_task : std::max<std::size_t>(1, 256 / n);
+    const double sr = config.position_sigma_km / au_km;
+    const double sv = config.velocity_sigma_mm_s * mm_per_s_in_au_per_day;
+
+    sched::parallel_for(scheduler, 0, config.cases, per_task, [&](std::size_t lo, std::size_t hi) {
+        SwarmState batch((hi - lo) * n);
+        for (std::size_t c = lo; c < hi; ++c) {
+            std::mt19937_64 rng(splitmix64(splitmix64(config.seed) ^ c));
+            std::normal_distribution<double> unit(0.0, 1.0);
+            for (std::size_t j = 0; j < n; ++j) {
+                const std::size_t i = (c - lo) * n + j;
+                batch.x[i] = nominal.x[j] + sr * unit(rng);
+                batch.y[i] = nominal.y[j] + sr * unit(rng);
+                batch.z[i] = nominal.z[j] + sr * unit(rng);
+                batch.vx[i] = nominal.vx[j] + sv * unit(rng);
+                batch.vy[i] = nominal.vy[j] + sv * unit(rng);
+                batch.vz[i] = nominal.vz[j] + sv * unit(rng);
+                batch.cr_area_mass[i] =
+                    nominal.cr_area_mass[j] * std::max(0.0, 1.0 + config.cr_area_mass_sigma * unit(rng));
+            }
+        }
+        propagator.propagate(batch, t0, t1);
+        const std::size_t base = lo * n;
+        std::copy(batch.x.begin(), batch.x.end(), out.x.begin() + base);
+        std::copy(batch.y.begin(), batch.y.end(), out.y.begin() + base);
+        std::copy(batch.z.begin(), batch.z.end(), out.z.begin() + base);
+        std::copy(batch.vx.begin(), batch.vx.end(), out.vx.begin() + base);
+        std::copy(batch.vy.begin(), batch.vy.end(), out.vy.begin() + base);
+        std::copy(batch.vz.begin(), batch.vz.end(), out.vz.begin() + base);
+        std::copy(batch.cr_area_mass.begin(), batch.cr_area_mass.end(),
+                  out.cr_area_mass.begin() + base);
+    });
+    return out;
+}
+
+double focal_line_offset_km(const Vec3& r, const Vec3& target) noexcept
+{
+    const double norm = std::sqrt(target[0] * target[0] + target[1] * target[1] + target[2] * target[2]);
+    const double along = (r[0] * target[0] + r[1] * target[1] + r[2] * target[2]) / norm;
+    double lateral2 = 0.0;
+    for (int k = 0; k < 3; ++k) {
+        const double d = r[k] - along * target[k] / norm;
+        lateral2 += d * d;
+    }
+    return std::sqrt(lateral2) * au_km;
+}
+
+} // namespace solarlens::nav
@@ -0,0 +1,169 @@
+#include "solarlens/perf/export.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <mutex>
+
+#include "registry.hpp"
+
+namespace solarlens::perf {
+
+namespace {
+
+// Prometheus metric names allow [a-zA-Z0-9_:] only.
+std::string metric_name(std::string_view name)
+{
+    std::string out(name);
+    for (char& c : out)
+        if (!((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_'))
+            c = '_';
+    return out;
+}
+
+// Escapes a string for a quoted Prometheus label or a JSON string; both
+// need backslash, quote and newline escaped.
+std::string quoted(std::string_view text)
+{
+    std::string out;
+    out.reserve(text.size());
+    for (char c : text) {
+        if (c == '\\' || c == '"')
+            out += '\\';
+        if (c == '\n')
+            out += "\\n";
+        else if (static_cast<unsigned char>(c) >= 0x20)
+            out += c;
+    }
+    return out;
+}
+
+std::string seconds(std::uint64_t ns)
+{
+    char buf[32];
+    std::snprintf(buf, sizeof buf, "%.9g", double(ns) * 1e-9);
+    return buf;
+}
+
+} // namespace
+
+const StageSnapshot* Snapshot::stage(std::string_view name) const noexcept
+{
+    const auto it = std::find_if(stages.begin(), stages.end(), [&](const auto& s) { return s.name == name; });
+    return it == stages.end() ? nullptr : &*it;
+}
+
+const CounterSnapshot* Snapshot::counter(std::string_view name) const noexcept
+{
+    const auto it = std::find_if(counters.begin(), counters.end(), [&](const auto& c) { return c.name == name; });
+    return it == counters.end() ? nullptr : &*it;
+}
+
+Snapshot snapshot()
+{
+    detail::Registry& r = detail::Registry::get();
+    std::lock_guard lock(r.mutex);
+    Snapshot s;
+    s.stages.resize(r.stage_names.size());
+    for (std::uint32_t i = 0; i < r.stage_names.size(); ++i) {
+        s.stages[i].name = r.stage_names[i];
+        if (i < r.retired_stages.size())
+            s.stages[i].nanoseconds = r.retired_stages[i];
+        for (const detail::ThreadBuffer* b : r.live)
+            if (const auto* rec = b->stages[i].load(std::memory_order_acquire))
+                rec->merge_into(s.stages[i].nanoseconds);
+    }
+    s.counters.resize(r.counter_names.size());
+    for (std::uint32_t i = 0; i < r.counter_names.size(); ++i) {
+        s.counters[i].name = r.counter_names[i];
+        s.counters[i].value = r.retired_counters[i];
+        for (const detail::ThreadBuffer* b : r.live)
+            s.counters[i].value += b->counters[i].load(std::memory_order_relaxed);
+    }
+    return s;
+}
+
+Trace collect_trace()
+{
+    detail::Registry& r = detail::Registry::get();
+    std::lock_guard lock(r.mutex);
+    Trace t;
+    t.stage_names = r.stage_names;
+    t.thread_names = r.thread_names;
+    t.events = r.retired_events;
+    for (const detail::ThreadBuffer* b : r.live)
+        if (const auto* ring = b->trace.load(std::memory_order_acquire))
+            ring->copy_out(b->thread, t.events);
+    std::stable_sort(t.events.begin(), t.events.end(),
+                     [](const TraceEvent& a, const TraceEvent& b) { return a.start_ns < b.start_ns; });
+    return t;
+}
+
+void reset()
+{
+    // Owners keep writing meanwhile, so a sample racing the reset may
+    // survive it; nothing is torn either way.
+    detail::Registry& r = detail::Registry::get();
+    std::lock_guard lock(r.mutex);
+    r.retired_stages.clear();
+    r.retired_counters.fill(0);
+    r.retired_events.clear();
+    for (detail::ThreadBuffer* b : r.live) {
+        for (auto& rec : b->stages)
+            if (auto* p = rec.load(std::memory_order_acquire))
+                p->clear();
+        for (auto& c : b->counters)
+            c.store(0, std::memory_order_relaxed);
+        if (auto* ring = b->trace.load(std::memory_order_acquire))
+            ring->head.store(0, std::memory_order_relaxed);
+    }
+}
+
+void write_prometheus(const Snapshot& snapshot, std::ostream& out, std::string_view prefix)
+{
+    const std::string base = metric_name(prefix);
+    if (!snapshot.stages.empty()) {
+        const std::string name = base + "_stage_seconds";
+        out << "# HELP " << name << " Pipeline stage latency.\n# TYPE " << name << " summary\n";
+        for (const auto& s : snapshot.stages) {
+            const std::string label = "stage=\"" + quoted(s.name) + "\"";
+            for (const double q : {0.5, 0.9, 0.99, 0.999})
+                out << name << '{' << label << ",quantile=\"" << q << "\"} "
+                    << seconds(s.nanoseconds.value_at_quantile(q)) << '\n';
+            out << name << "_sum{" << label << "} " << seconds(s.nanoseconds.sum()) << '\n';
+            out << name << "_count{" << label << "} " << s.nanoseconds.count() << '\n';
+        }
+    }
+    for (const auto& c : snapshot.counters) {
+        const std::string name = base + '_' + metric_name(c.name) + "_total";
+        out << "# TYPE " << name << " counter\n" << name << ' ' << c.value << '\n';
+    }
+}
+
+void write_chrome_trace(const Trace& trace, std::ostream& out)
+{
+    char buf[64];
+    out << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+    bool first = true;
+    const auto sep = [&] {
+        out << (first ? "\n" : ",\n");
+        first = false;
+    };
+    for (std::size_t t = 0; t < trace.thread_names.size(); ++t) {
+        sep();
+        out << "{\"ph\":\"M\",\"name\":\"thread_name\",\"pid\":1,\"tid\":" << t << ",\"args\":{\"name\":\""
+            << quoted(trace.thread_names[t]) << "\"}}";
+    }
+    for (const auto& e : trace.events) {
+        sep();
+        const std::string_view stage =
+            e.stage < trace.stage_names.size() ? std::string_view(trace.stage_names[e.stage]) : "?";
+        // Microseconds with nanosecond digits, as the format expects.
+        std::snprintf(buf, sizeof buf, "\"ts\":%.3f,\"dur\":%.3f", double(e.start_ns) * 1e-3,
+                      double(e.duration_ns) * 1e-3);
+        out << "{\"ph\":\"X\",\"name\":\"" << quoted(stage) << "\",\"pid\":1,\"tid\":" << e.thread << ',' << buf
+            << '}';
+    }
+    out << "\n]}\n";
+}
+
+} // namespace solarlens::perf
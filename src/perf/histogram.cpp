@@ -0,0 +1,31 @@
+#include "solarlens/perf/histogram.hpp"
+
+#include <cmath>
+
+namespace solarlens::perf {
+
+void HdrHistogram::merge(const HdrHistogram& other) noexcept
+{
+    if (other.count_ == 0)
+        return;
+    for (std::size_t i = 0; i < bucket_count; ++i)
+        counts_[i] += other.counts_[i];
+    add_totals(other.count_, other.sum_, other.min_, other.max_);
+}
+
+std::uint64_t HdrHistogram::value_at_quantile(double q) const noexcept
+{
+    if (count_ == 0)
+        return 0;
+    q = std::clamp(q, 0.0, 1.0);
+    const auto rank = std::max<std::uint64_t>(1, static_cast<std::uint64_t>(std::ceil(q * double(count_))));
+    std::uint64_t seen = 0;
+    for (std::size_t i = 0; i < bucket_count; ++i) {
+        seen += counts_[i];
+        if (seen >= rank)
+            return std::clamp(highest_in(i), min(), max_);
+    }
+    return max_;
+}
+
+} // namespace solarlens::perf
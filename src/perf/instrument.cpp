@@ -0,0 +1,185 @@
+#include "solarlens/perf/instrument.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+
+#include "registry.hpp"
+
+namespace solarlens::perf {
+
+namespace detail {
+
+void StageRecorder::merge_into(HdrHistogram& h) const noexcept
+{
+    const std::uint64_t n = count.load(std::memory_order_relaxed);
+    if (n == 0)
+        return;
+    for (std::size_t i = 0; i < buckets.size(); ++i)
+        if (const std::uint64_t c = buckets[i].load(std::memory_order_relaxed))
+            h.add_bucket(i, c);
+    h.add_totals(n, sum.load(std::memory_order_relaxed), min.load(std::memory_order_relaxed),
+                 max.load(std::memory_order_relaxed));
+}
+
+void StageRecorder::clear() noexcept
+{
+    for (auto& b : buckets)
+        b.store(0, std::memory_order_relaxed);
+    count.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    min.store(~std::uint64_t {0}, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+void TraceRing::copy_out(std::uint32_t thread, std::vector<TraceEvent>& out) const
+{
+    const std::uint64_t end = head.load(std::memory_order_acquire);
+    const std::uint64_t begin = end > trace_capacity ? end - trace_capacity : 0;
+    const std::size_t first = out.size();
+    for (std::uint64_t i = begin; i < end; ++i) {
+        const TraceSlot& s = slots[i % trace_capacity];
+        out.push_back({s.stage.load(std::memory_order_relaxed), thread, s.start.load(std::memory_order_relaxed),
+                       s.duration.load(std::memory_order_relaxed)});
+    }
+    // The owner may have lapped the copy; event i is intact only if the
+    // writer has not yet started on event i + capacity.
+    std::atomic_thread_fence(std::memory_order_acquire);
+    const std::uint64_t now = head.load(std::memory_order_relaxed);
+    const std::uint64_t stale = now >= trace_capacity ? now - trace_capacity + 1 : 0;
+    if (stale > begin)
+        out.erase(out.begin() + first, out.begin() + first + std::min<std::uint64_t>(stale - begin, end - begin));
+}
+
+ThreadBuffer::~ThreadBuffer()
+{
+    for (auto& s : stages)
+        delete s.load(std::memory_order_relaxed);
+    delete trace.load(std::memory_order_relaxed);
+}
+
+Registry& Registry::get()
+{
+    static Registry* registry = new Registry;
+    return *registry;
+}
+
+std::uint32_t Registry::intern(std::vector<std::string>& names, std::string_view name, std::uint32_t limit,
+                               const char* what)
+{
+    std::lock_guard lock(mutex);
+    const auto it = std::find(names.begin(), names.end(), name);
+    if (it != names.end())
+        return static_cast<std::uint32_t>(it - names.begin());
+    if (names.size() == limit)
+        throw std::length_error(std::string("perf: more than ") + std::to_string(limit) + " " + what);
+    names.emplace_back(name);
+    return static_cast<std::uint32_t>(names.size() - 1);
+}
+
+namespace {
+
+// Registers the thread's buffer on first use and retires it at exit.
+class LocalHandle {
+public:
+    LocalHandle()
+        : buffer_(std::make_unique<ThreadBuffer>())
+    {
+        Registry& r = Registry::get();
+        std::lock_guard lock(r.mutex);
+        buffer_->thread = static_cast<std::uint32_t>(r.thread_names.size());
+        r.thread_names.push_back("thread " + std::to_string(buffer_->thread));
+        r.live.push_back(buffer_.get());
+    }
+
+    ~LocalHandle()
+    {
+        Registry& r = Registry::get();
+        std::lock_guard lock(r.mutex);
+        r.live.erase(std::find(r.live.begin(), r.live.end(), buffer_.get()));
+        if (r.retired_stages.size() < r.stage_names.size())
+            r.retired_stages.resize(r.stage_names.size());
+        for (std::uint32_t s = 0; s < r.stage_names.size(); ++s)
+            if (const StageRecorder* rec = buffer_->stages[s].load(std::memory_order_relaxed))
+                rec->merge_into(r.retired_stages[s]);
+        for (std::uint32_t c = 0; c < max_counters; ++c)
+            r.retired_counters[c] += buffer_->counters[c].load(std::memory_order_relaxed);
+        if (const TraceRing* ring = buffer_->trace.load(std::memory_order_relaxed))
+            ring->copy_out(buffer_->thread, r.retired_events);
+        if (r.retired_events.size() > max_retired_events)
+            r.retired_events.erase(r.retired_events.begin(),
+                                   r.retired_events.end() - static_cast<std::ptrdiff_t>(max_retired_events));
+    }
+
+    ThreadBuffer& buffer() noexcept { return *buffer_; }
+
+private:
+    std::unique_ptr<ThreadBuffer> buffer_;
+};
+
+} // namespace
+
+ThreadBuffer& local()
+{
+    thread_local LocalHandle handle;
+    return handle.buffer();
+}
+
+} // namespace detail
+
+std::uint64_t now_ns() noexcept
+{
+    static const auto epoch = std::chrono::steady_clock::now();
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - epoch).count());
+}
+
+Stage::Stage(std::string_view name)
+    : id_(detail::Registry::get().intern(detail::Registry::get().stage_names, name, max_stages, "stages"))
+{
+}
+
+void Stage::record(std::uint64_t ns) const noexcept
+{
+    detail::local().stage(id_).record(ns);
+}
+
+Counter::Counter(std::string_view name)
+    : id_(detail::Registry::get().intern(detail::Registry::get().counter_names, name, max_counters, "counters"))
+{
+}
+
+void Counter::add(std::uint64_t n) const noexcept
+{
+    detail::bump(detail::local().counters[id_], n);
+}
+
+ScopedTimer::~ScopedTimer()
+{
+    const std::uint64_t end = now_ns();
+    detail::ThreadBuffer& buffer = detail::local();
+    buffer.stage(stage_.id()).record(end - start_);
+    if (detail::Registry::get().tracing.load(std::memory_order_relaxed))
+        buffer.ring().push(stage_.id(), start_, end - start_);
+}
+
+void set_tracing(bool enabled) noexcept
+{
+    detail::Registry::get().tracing.store(enabled, std::memory_order_relaxed);
+}
+
+bool tracing_enabled() noexcept
+{
+    return detail::Registry::get().tracing.load(std::memory_order_relaxed);
+}
+
+void set_thread_name(std::string_view name)
+{
+    detail::ThreadBuffer& buffer = detail::local();
+    detail::Registry& r = detail::Registry::get();
+    std::lock_guard lock(r.mutex);
+    r.thread_names[buffer.thread] = name;
+}
+
+} // namespace solarlens::perf
@@ -0,0 +1,137 @@
+#pragma once
+
+// Per-thread instrumentation buffers and the registry that finds them.
+//
+// Every field a recording thread touches is a relaxed atomic written only
+// by that thread (load + store, never a read-modify-write), so the hot
+// path is plain moves on x86 and exporters on other threads read it
+// without a data race. Lazily allocated parts are published with a
+// release store and read with acquire. Buffers are freed only at thread
+// exit, under the registry lock, after being merged into the retired
+// totals.
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "solarlens/perf/export.hpp"
+#include "solarlens/perf/histogram.hpp"
+#include "solarlens/perf/instrument.hpp"
+
+namespace solarlens::perf::detail {
+
+inline constexpr std::size_t max_retired_events = std::size_t(16) * trace_capacity;
+
+inline void bump(std::atomic<std::uint64_t>& v, std::uint64_t n) noexcept
+{
+    v.store(v.load(std::memory_order_relaxed) + n, std::memory_order_relaxed);
+}
+
+struct StageRecorder {
+    std::array<std::atomic<std::uint64_t>, HdrHistogram::bucket_count> buckets {};
+    std::atomic<std::uint64_t> count {0};
+    std::atomic<std::uint64_t> sum {0};
+    std::atomic<std::uint64_t> min {~std::uint64_t {0}};
+    std::atomic<std::uint64_t> max {0};
+
+    void record(std::uint64_t ns) noexcept
+    {
+        bump(buckets[HdrHistogram::index_of(ns)], 1);
+        bump(count, 1);
+        bump(sum, ns);
+        if (ns < min.load(std::memory_order_relaxed))
+            min.store(ns, std::memory_order_relaxed);
+        if (ns > max.load(std::memory_order_relaxed))
+            max.store(ns, std::memory_order_relaxed);
+    }
+
+    void merge_into(HdrHistogram& h) const noexcept;
+    void clear() noexcept;
+};
+
+struct TraceSlot {
+    std::atomic<std::uint32_t> stage {0};
+    std::atomic<std::uint64_t> start {0};
+    std::atomic<std::uint64_t> duration {0};
+};
+
+struct TraceRing {
+    std::array<TraceSlot, trace_capacity> slots {};
+    std::atomic<std::uint64_t> head {0}; // Events ever written.
+
+    void push(std::uint32_t stage, std::uint64_t start, std::uint64_t duration) noexcept
+    {
+        const std::uint64_t h = head.load(std::memory_order_relaxed);
+        // Pairs with the fence in copy_out: a reader that sees any of the
+        // stores below also sees that head had reached h.
+        std::atomic_thread_fence(std::memory_order_release);
+        TraceSlot& s = slots[h % trace_capacity];
+        s.stage.store(stage, std::memory_order_relaxed);
+        s.start.store(start, std::memory_order_relaxed);
+        s.duration.store(duration, std::memory_order_relaxed);
+        head.store(h + 1, std::memory_order_release);
+    }
+
+    // Appends the events that were not overwritten while copying.
+    void copy_out(std::uint32_t thread, std::vector<TraceEvent>& out) const;
+};
+
+struct ThreadBuffer {
+    std::uint32_t thread = 0; // Index into Registry::thread_names.
+    std::array<std::atomic<StageRecorder*>, max_stages> stages {};
+    std::array<std::atomic<std::uint64_t>, max_counters> counters {};
+    std::atomic<TraceRing*> trace {nullptr};
+
+    ThreadBuffer() = default;
+    ThreadBuffer(const ThreadBuffer&) = delete;
+    ThreadBuffer& operator=(const ThreadBuffer&) = delete;
+    ~ThreadBuffer();
+
+    StageRecorder& stage(std::uint32_t id)
+    {
+        StageRecorder* r = stages[id].load(std::memory_order_relaxed);
+        if (!r) {
+            r = new StageRecorder;
+            stages[id].store(r, std::memory_order_release);
+        }
+        return *r;
+    }
+
+    TraceRing& ring()
+    {
+        TraceRing* r = trace.load(std::memory_order_relaxed);
+        if (!r) {
+            r = new TraceRing;
+            trace.store(r, std::memory_order_release);
+        }
+        return *r;
+    }
+};
+
+struct Registry {
+    std::mutex mutex;
+    std::vector<std::string> stage_names;
+    std::vector<std::string> counter_names;
+    std::vector<ThreadBuffer*> live;
+    std::vector<std::string> thread_names; // Every thread ever seen.
+    // Totals of exited threads.
+    std::vector<HdrHistogram> retired_stages;
+    std::array<std::uint64_t, max_counters> retired_counters {};
+    std::vector<TraceEvent> retired_events; // At most max_retired_events, newest kept.
+    std::atomic<bool> tracing {false};
+
+    // Never destroyed, so thread exit during static destruction is safe.
+    static Registry& get();
+
+    std::uint32_t intern(std::vector<std::string>& names, std::string_view name, std::uint32_t limit,
+                         const char* what);
+};
+
+// The calling thread's buffer, registered on first use.
+ThreadBuffer& local();
+
+} // namespace solarlens::perf::detail
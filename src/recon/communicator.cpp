@@ -0,0 +1,154 @@
+#include "solarlens/recon/communicator.hpp"
+
+#include <algorithm>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+#include "communicator_mpi.hpp"
+
+namespace solarlens::recon {
+
+namespace {
+
+// State shared by every rank of a local group. Mailbox [from * size + to]
+// is a FIFO, so consecutive exchanges between a pair never mix.
+struct LocalGroup {
+    explicit LocalGroup(int ranks)
+        : size(ranks)
+        , mailboxes(std::size_t(ranks) * std::size_t(ranks))
+        , contributions(std::size_t(ranks))
+    {
+    }
+
+    int size;
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::vector<std::deque<std::vector<double>>> mailboxes;
+    std::vector<std::vector<double>> contributions;
+    std::vector<double> sum;
+    int arrived = 0;
+    std::uint64_t generation = 0;
+};
+
+class LocalCommunicator final : public Communicator {
+public:
+    LocalCommunicator(std::shared_ptr<LocalGroup> group, int rank)
+        : group_(std::move(group))
+        , rank_(rank)
+    {
+    }
+
+    int rank() const noexcept override { return rank_; }
+    int size() const noexcept override { return group_->size; }
+
+    void allreduce_sum(std::span<double> values) override
+    {
+        LocalGroup& g = *group_;
+        std::unique_lock lock(g.mutex);
+        g.contributions[std::size_t(rank_)].assign(values.begin(), values.end());
+        if (++g.arrived == g.size) {
+            // Summed in rank order, so every rank gets the same bits.
+            g.sum.assign(values.size(), 0.0);
+            for (const auto& c : g.contributions) {
+                if (c.size() != values.size())
+                    throw std::invalid_argument("communicator: allreduce lengths differ between ranks");
+                for (std::size_t i = 0; i < c.size(); ++i)
+                    g.sum[i] += c[i];
+            }
+            g.arrived = 0;
+            ++g.generation;
+            g.changed.notify_all();
+        } else {
+            const std::uint64_t generation = g.generation;
+            g.changed.wait(lock, [&] { return g.generation != generation; });
+        }
+        // The next round cannot complete, and overwrite the sum, until
+        // this rank has arrived at it.
+        std::copy(g.sum.begin(), g.sum.end(), values.begin());
+    }
+
+    void start_exchange(std::span<const HaloTransfer> transfers) override
+    {
+        if (!pending_.empty())
+            throw std::logic_error("communicator: exchange already in flight");
+        LocalGroup& g = *group_;
+        for (const HaloTransfer& t : transfers)
+            if (t.peer < 0 || t.peer >= g.size || t.peer == rank_)
+                throw std::invalid_argument("communicator: bad exchange peer " + std::to_string(t.peer));
+        {
+            std::lock_guard lock(g.mutex);
+            for (const HaloTransfer& t : transfers)
+                g.mailboxes[mailbox(rank_, t.peer)].emplace_back(t.send.begin(), t.send.end());
+        }
+        g.changed.notify_all();
+        pending_.assign(transfers.begin(), transfers.end());
+    }
+
+    void finish_exchange() override
+    {
+        LocalGroup& g = *group_;
+        std::unique_lock lock(g.mutex);
+        for (const HaloTransfer& t : pending_) {
+            auto& box = g.mailboxes[mailbox(t.peer, rank_)];
+            g.changed.wait(lock, [&] { return !box.empty(); });
+            const std::vector<double>& message = box.front();
+            if (message.size() != t.receive.size())
+                throw std::runtime_error("communicator: rank " + std::to_string(t.peer) + " sent "
+                                         + std::to_string(message.size()) + " values, expected "
+                                         + std::to_string(t.receive.size()));
+            std::copy(message.begin(), message.end(), t.receive.begin());
+            box.pop_front();
+        }
+        pending_.clear();
+    }
+
+    void barrier() override { allreduce_sum({}); }
+
+private:
+    std::size_t mailbox(int from, int to) const noexcept
+    {
+        return std::size_t(from) * std::size_t(group_->size) + std::size_t(to);
+    }
+
+    std::shared_ptr<LocalGroup> group_;
+    int rank_;
+    std::vector<HaloTransfer> pending_;
+};
+
+} // namespace
+
+std::vector<std::unique_ptr<Communicator>> make_local_group(int ranks)
+{
+    if (ranks <= 0)
+        throw std::invalid_argument("communicator: a group needs at least one rank");
+    auto group = std::make_shared<LocalGroup>(ranks);
+    std::vector<std::unique_ptr<Communicator>> out;
+    out.reserve(std::size_t(ranks));
+    for (int r = 0; r < ranks; ++r)
+        out.push_back(std::make_unique<LocalCommunicator>(group, r));
+    return out;
+}
+
+bool mpi_available() noexcept
+{
+#ifdef SOLARLENS_HAVE_MPI
+    return true;
+#else
+    return false;
+#endif
+}
+
+std::unique_ptr<Communicator> make_mpi_communicator()
+{
+#ifdef SOLARLENS_HAVE_MPI
+    return detail::make_mpi_communicator();
+#else
+    throw std::invalid_argument("communicator: MPI is not in this build");
+#endif
+}
+
+} // namespace solarlens::recon
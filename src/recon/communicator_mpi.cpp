@@ -0,0 +1,108 @@
+// MPI communicator, built only with SOLARLENS_WITH_MPI.
+//
+// Exchanges post one MPI_Irecv and one MPI_Isend per peer and complete
+// them with a single MPI_Waitall, so the strips of every neighbour move
+// concurrently and the caller can compute between start and finish.
+
+#include <mpi.h>
+
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "communicator_mpi.hpp"
+
+namespace solarlens::recon::detail {
+
+namespace {
+
+constexpr int halo_tag = 0x534c; // "SL"
+
+void check(int status, const char* what)
+{
+    if (status != MPI_SUCCESS)
+        throw std::runtime_error(std::string("mpi communicator: ") + what + " failed (" + std::to_string(status)
+                                 + ")");
+}
+
+class MpiCommunicator final : public Communicator {
+public:
+    MpiCommunicator()
+    {
+        int initialized = 0;
+        check(MPI_Initialized(&initialized), "MPI_Initialized");
+        if (!initialized)
+            throw std::runtime_error("mpi communicator: MPI_Init has not been called");
+        check(MPI_Comm_dup(MPI_COMM_WORLD, &comm_), "MPI_Comm_dup");
+        check(MPI_Comm_rank(comm_, &rank_), "MPI_Comm_rank");
+        check(MPI_Comm_size(comm_, &size_), "MPI_Comm_size");
+    }
+
+    ~MpiCommunicator() override
+    {
+        int finalized = 0;
+        MPI_Finalized(&finalized);
+        if (!finalized)
+            MPI_Comm_free(&comm_);
+    }
+
+    int rank() const noexcept override { return rank_; }
+    int size() const noexcept override { return size_; }
+
+    void allreduce_sum(std::span<double> values) override
+    {
+        if (values.empty())
+            return;
+        check(MPI_Allreduce(MPI_IN_PLACE, values.data(), static_cast<int>(values.size()), MPI_DOUBLE, MPI_SUM,
+                            comm_),
+              "MPI_Allreduce");
+    }
+
+    void start_exchange(std::span<const HaloTransfer> transfers) override
+    {
+        if (!requests_.empty())
+            throw std::logic_error("mpi communicator: exchange already in flight");
+        requests_.reserve(2 * transfers.size());
+        for (const HaloTransfer& t : transfers) {
+            if (t.peer < 0 || t.peer >= size_ || t.peer == rank_)
+                throw std::invalid_argument("mpi communicator: bad exchange peer " + std::to_string(t.peer));
+            MPI_Request& r = requests_.emplace_back();
+            check(MPI_Irecv(t.receive.data(), static_cast<int>(t.receive.size()), MPI_DOUBLE, t.peer, halo_tag,
+                            comm_, &r),
+                  "MPI_Irecv");
+        }
+        for (const HaloTransfer& t : transfers) {
+            MPI_Request& r = requests_.emplace_back();
+            // MPI-3 takes a const buffer.
+            check(MPI_Isend(t.send.data(), static_cast<int>(t.send.size()), MPI_DOUBLE, t.peer, halo_tag, comm_,
+                            &r),
+                  "MPI_Isend");
+        }
+    }
+
+    void finish_exchange() override
+    {
+        if (requests_.empty())
+            return;
+        check(MPI_Waitall(static_cast<int>(requests_.size()), requests_.data(), MPI_STATUSES_IGNORE),
+              "MPI_Waitall");
+        requests_.clear();
+    }
+
+    void barrier() override { check(MPI_Barrier(comm_), "MPI_Barrier"); }
+
+private:
+    MPI_Comm comm_ = MPI_COMM_NULL;
+    int rank_ = 0;
+    int size_ = 1;
+    std::vector<MPI_Request> requests_;
+};
+
+} // namespace
+
+std::unique_ptr<Communicator> make_mpi_communicator()
+{
+    return std::make_unique<MpiCommunicator>();
+}
+
+} // namespace solarlens::recon::detail
@@ -0,0 +1,14 @@
+#pragma once
+
+// MPI backend behind make_mpi_communicator(); only defined when the
+// library is built with SOLARLENS_WITH_MPI.
+
+#include <memory>
+
+#include "solarlens/recon/communicator.hpp"
+
+namespace solarlens::recon::detail {
+
+std::unique_ptr<Communicator> make_mpi_communicator();
+
+} // namespace solarlens::recon::detail
@@ -0,0 +1,119 @@
+#include "solarlens/recon/deconvolution.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <string>
+
+#include <unistd.h>
+
+#include "solarlens/recon/map_file.hpp"
+#include "solarlens/recon/ring_sample.hpp"
+#include "solarlens/recon/spill_store.hpp"
+#include "solarlens/sched/scheduler.hpp"
+#include "tile_workspace.hpp"
+
+namespace solarlens::recon {
+
+namespace {
+
+using detail::fixed_bytes;
+using detail::max_spill_buffer;
+using detail::min_spill_buffer;
+using detail::TileWorkspace;
+
+std::filesystem::path default_scratch_dir()
+{
+    return std::filesystem::temp_directory_path()
+        / ("solarlens-recon-" + std::to_string(::getpid()));
+}
+
+} // namespace
+
+DeconvolutionEngine::DeconvolutionEngine(const PsfKernel& psf, const DeconvolutionConfig& config)
+    : config_(config)
+    , kernel_(psf, config.kernel_oversample)
+    , plan_(detail::make_plan(config_.map_size, config_.tile_size, config_.memory_budget_bytes, kernel_))
+{
+    if (config_.scratch_dir.empty())
+        config_.scratch_dir = default_scratch_dir();
+}
+
+DeconvolutionReport DeconvolutionEngine::run(const std::filesystem::path& samples_in,
+                                             const std::filesystem::path& map_out)
+{
+    DeconvolutionReport report;
+    report.tile_size = plan_.tile_size();
+    report.halo = plan_.halo();
+
+    const std::size_t budget = config_.memory_budget_bytes;
+    const std::size_t area = plan_.max_region_area();
+    const std::size_t solve_fixed = fixed_bytes(kernel_) + area * solver_bytes_per_pixel;
+    if (solve_fixed + min_chunk_samples * sizeof(RingSample) > budget)
+        throw std::invalid_argument("DeconvolutionEngine: tile size exceeds memory budget");
+
+    // Phase 1: bin. The read chunk gets a minimum slice, buckets the rest.
+    const std::size_t read_chunk = min_chunk_samples;
+    const std::size_t spill_room = budget - read_chunk * sizeof(RingSample);
+    const std::size_t spill_buffer = std::min(
+        max_spill_buffer, spill_room / (plan_.tile_count() * sizeof(RingSample)));
+    if (spill_buffer < min_spill_buffer)
+        throw std::invalid_argument("DeconvolutionEngine: memory budget too small for tile count");
+
+    SpillStore store(plan_, config_.scratch_dir, spill_buffer);
+    {
+        RingSampleReader reader(samples_in);
+        std::vector<RingSample> chunk(read_chunk);
+        while (const std::size_t n = reader.read(chunk)) {
+            report.samples_read += n;
+            for (std::size_t i = 0; i < n; ++i) {
+                const std::size_t routed = store.add(chunk[i]);
+                report.samples_binned += routed;
+                report.samples_rejected += routed == 0;
+            }
+        }
+        store.flush();
+    }
+    report.peak_bytes = store.memory_bytes() + read_chunk * sizeof(RingSample);
+
+    // Phase 2: solve. Up to `slots` tiles are in flight at once, each slot
+    // owning an equal share of the budget. Whatever the solver state leaves
+    // of a share is its sample chunk; tiles whose bucket fits are loaded
+    // once and solved from memory, the rest are re-streamed from scratch on
+    // every iteration.
+    const std::size_t slot_need = solve_fixed + min_chunk_samples * sizeof(RingSample);
+    const std::size_t slots = detail::solve_slots(budget, slot_need, config_.scheduler,
+                                                  config_.max_parallel_tiles, plan_.tile_count());
+    const std::size_t chunk_samples = (budget / slots - solve_fixed) / sizeof(RingSample);
+
+    MapFileWriter map(map_out, plan_.map_size(), plan_.map_size());
+    report.tiles.resize(plan_.tile_count());
+    std::vector<std::size_t> slot_bytes(slots, 0);
+    std::atomic<std::size_t> next_tile {0};
+    const auto work = [&](std::size_t slot) {
+        TileWorkspace ws(kernel_, config_.solver);
+        for (std::size_t i; (i = next_tile.fetch_add(1, std::memory_order_relaxed)) < plan_.tile_count();)
+            report.tiles[i] = ws.solve(plan_.tile(i), store, chunk_samples, map);
+        slot_bytes[slot] = solve_fixed + ws.chunk.capacity() * sizeof(RingSample);
+    };
+    if (slots == 1) {
+        work(0);
+    } else {
+        sched::TaskGroup group(*config_.scheduler);
+        for (std::size_t s = 0; s < slots; ++s)
+            group.run([&work, s] { work(s); });
+        group.wait();
+    }
+    report.parallel_tiles = slots;
+    report.peak_bytes = std::max(report.peak_bytes,
+                                 std::accumulate(slot_bytes.begin(), slot_bytes.end(), std::size_t(0)));
+    map.close();
+    store.remove_files();
+    std::error_code ec;
+    std::filesystem::remove(config_.scratch_dir, ec);
+    return report;
+}
+
+} // namespace solarlens::recon
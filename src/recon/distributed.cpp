@@ -0,0 +1,342 @@
+#include "solarlens/recon/distributed.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "solarlens/perf/instrument.hpp"
+
+namespace solarlens::recon {
+
+namespace {
+
+bool usable(const RingSample& s)
+{
+    return std::isfinite(s.flux) && std::isfinite(s.sigma) && s.sigma > 0.0f;
+}
+
+TileRect intersect(const TileRect& a, const TileRect& b)
+{
+    TileRect r {std::max(a.x0, b.x0), std::max(a.y0, b.y0), std::min(a.x1, b.x1), std::min(a.y1, b.y1)};
+    if (r.x0 >= r.x1 || r.y0 >= r.y1)
+        return {};
+    return r;
+}
+
+TileRect grow(const TileRect& a, std::uint32_t by, std::uint32_t map_size)
+{
+    return {a.x0 > by ? a.x0 - by : 0, a.y0 > by ? a.y0 - by : 0, std::min(map_size, a.x1 + by),
+            std::min(map_size, a.y1 + by)};
+}
+
+} // namespace
+
+BlockGrid BlockGrid::for_ranks(std::uint32_t map_size, int ranks)
+{
+    if (ranks <= 0)
+        throw std::invalid_argument("distributed: need at least one rank");
+    const auto n = static_cast<std::uint32_t>(ranks);
+    std::uint32_t rows = static_cast<std::uint32_t>(std::sqrt(double(n)));
+    while (n % rows != 0)
+        --rows;
+    BlockGrid grid {map_size, n / rows, rows};
+    if (grid.columns > map_size || grid.rows > map_size)
+        throw std::invalid_argument("distributed: " + std::to_string(ranks) + " ranks do not fit a "
+                                    + std::to_string(map_size) + "-pixel map");
+    return grid;
+}
+
+TileRect BlockGrid::block(int rank) const
+{
+    if (rank < 0 || rank >= ranks())
+        throw std::out_of_range("distributed: rank " + std::to_string(rank) + " is not in the grid");
+    const auto c = static_cast<std::uint64_t>(rank) % columns;
+    const auto r = static_cast<std::uint64_t>(rank) / columns;
+    const auto edge = [&](std::uint64_t i, std::uint64_t parts) {
+        return static_cast<std::uint32_t>(i * map_size / parts);
+    };
+    return {edge(c, columns), edge(r, rows), edge(c + 1, columns), edge(r + 1, rows)};
+}
+
+DistributedSolver::DistributedSolver(const PsfKernel& psf, const DistributedConfig& config, Communicator& comm)
+    : comm_(comm)
+    , kernel_(psf, config.kernel_oversample)
+    , options_(config.solver)
+    , grid_(BlockGrid::for_ranks(config.map_size, comm.size()))
+    , block_(grid_.block(comm.rank()))
+    , halo_(static_cast<std::uint32_t>(std::ceil(kernel_.radius())))
+{
+    if (options_.max_iterations <= 0 || options_.tolerance <= 0 || options_.regularization < 0)
+        throw std::invalid_argument("distributed: invalid solver options");
+    if (options_.precision != Precision::fp64)
+        throw std::invalid_argument("distributed: only FP64 solves are supported");
+    ghost_ = grow(block_, halo_, grid_.map_size);
+    for (int peer = 0; peer < grid_.ranks(); ++peer) {
+        if (peer == comm.rank())
+            continue;
+        const TileRect theirs = grid_.block(peer);
+        Link link {peer, intersect(block_, grow(theirs, halo_, grid_.map_size)), intersect(theirs, ghost_), {}, {}};
+        // The halos are symmetric, so either both overlaps are empty or
+        // neither is.
+        if (link.owned.area() == 0)
+            continue;
+        link.owned_values.resize(link.owned.area());
+        link.ghost_values.resize(link.ghost.area());
+        links_.push_back(std::move(link));
+    }
+    transfers_.resize(links_.size());
+    const auto side = static_cast<std::size_t>(2 * halo_ + 1);
+    stencil_index_.reserve(side * side);
+    stencil_weight_.reserve(side * side);
+}
+
+void DistributedSolver::add_samples(std::span<const RingSample> samples)
+{
+    const double r = kernel_.radius();
+    for (const RingSample& s : samples) {
+        if (!usable(s) || !block_.contains(s.u, s.v))
+            continue;
+        const bool inside = std::ceil(s.u - r) >= double(block_.x0) && std::floor(s.u + r) < double(block_.x1)
+                            && std::ceil(s.v - r) >= double(block_.y0) && std::floor(s.v + r) < double(block_.y1);
+        (inside ? inner_ : edge_).push_back(s);
+    }
+}
+
+void DistributedSolver::load_samples(const std::filesystem::path& path)
+{
+    RingSampleReader reader(path);
+    std::vector<RingSample> chunk(std::size_t(1) << 16);
+    while (const std::size_t n = reader.read(chunk))
+        add_samples(std::span(chunk).first(n));
+}
+
+void DistributedSolver::build_stencil(const RingSample& s)
+{
+    stencil_index_.clear();
+    stencil_weight_.clear();
+    const double r = kernel_.radius();
+    const double r2 = kernel_.radius_squared();
+    const long x_lo = std::max<long>(ghost_.x0, static_cast<long>(std::ceil(s.u - r)));
+    const long x_hi = std::min<long>(long(ghost_.x1) - 1, static_cast<long>(std::floor(s.u + r)));
+    const long y_lo = std::max<long>(ghost_.y0, static_cast<long>(std::ceil(s.v - r)));
+    const long y_hi = std::min<long>(long(ghost_.y1) - 1, static_cast<long>(std::floor(s.v + r)));
+    const std::uint32_t w = ghost_.width();
+    for (long y = y_lo; y <= y_hi; ++y) {
+        const double dy = double(y) - s.v;
+        const std::uint32_t row = static_cast<std::uint32_t>(y - ghost_.y0) * w;
+        for (long x = x_lo; x <= x_hi; ++x) {
+            const double dx = double(x) - s.u;
+            const double d2 = dx * dx + dy * dy;
+            if (d2 >= r2)
+                continue;
+            stencil_index_.push_back(row + static_cast<std::uint32_t>(x - ghost_.x0));
+            stencil_weight_.push_back(kernel_(std::sqrt(d2)));
+        }
+    }
+}
+
+void DistributedSolver::scatter(std::span<const RingSample> samples, std::span<const double> v,
+                                std::span<double> q)
+{
+    for (const RingSample& s : samples) {
+        build_stencil(s);
+        const std::size_t n = stencil_index_.size();
+        double t = 0.0;
+        for (std::size_t k = 0; k < n; ++k)
+            t += stencil_weight_[k] * v[stencil_index_[k]];
+        t /= double(s.sigma) * double(s.sigma);
+        for (std::size_t k = 0; k < n; ++k)
+            q[stencil_index_[k]] += stencil_weight_[k] * t;
+    }
+}
+
+void DistributedSolver::apply(std::span<double> p, std::span<double> q, DistributedReport& report)
+{
+    // Start filling p's ghost ring, and work on the block's own samples
+    // while it travels.
+    for (std::size_t i = 0; i < links_.size(); ++i) {
+        Link& link = links_[i];
+        std::size_t k = 0;
+        for (std::uint32_t y = link.owned.y0; y < link.owned.y1; ++y)
+            for (std::uint32_t x = link.owned.x0; x < link.owned.x1; ++x)
+                link.owned_values[k++] = p[ghost_index(x, y)];
+        transfers_[i] = {link.peer, link.owned_values, link.ghost_values};
+        report.halo_values_sent += link.owned_values.size();
+    }
+    comm_.start_exchange(transfers_);
+    ++report.exchanges;
+
+    std::fill(q.begin(), q.end(), 0.0);
+    const double lambda = options_.regularization;
+    for (std::uint32_t y = block_.y0; y < block_.y1; ++y)
+        for (std::uint32_t x = block_.x0; x < block_.x1; ++x)
+            q[ghost_index(x, y)] = lambda * p[ghost_index(x, y)];
+    scatter(inner_, p, q);
+
+    comm_.finish_exchange();
+    for (const Link& link : links_) {
+        std::size_t k = 0;
+        for (std::uint32_t y = link.ghost.y0; y < link.ghost.y1; ++y)
+            for (std::uint32_t x = link.ghost.x0; x < link.ghost.x1; ++x)
+                p[ghost_index(x, y)] = link.ghost_values[k++];
+    }
+    scatter(edge_, p, q);
+    accumulate_ghosts(q, report);
+}
+
+void DistributedSolver::accumulate_ghosts(std::span<double> v, DistributedReport& report)
+{
+    for (std::size_t i = 0; i < links_.size(); ++i) {
+        Link& link = links_[i];
+        std::size_t k = 0;
+        for (std::uint32_t y = link.ghost.y0; y < link.ghost.y1; ++y)
+            for (std::uint32_t x = link.ghost.x0; x < link.ghost.x1; ++x)
+                link.ghost_values[k++] = v[ghost_index(x, y)];
+        transfers_[i] = {link.peer, link.ghost_values, link.owned_values};
+        report.halo_values_sent += link.ghost_values.size();
+    }
+    comm_.exchange(transfers_);
+    ++report.exchanges;
+    for (const Link& link : links_) {
+        std::size_t k = 0;
+        for (std::uint32_t y = link.owned.y0; y < link.owned.y1; ++y)
+            for (std::uint32_t x = link.owned.x0; x < link.owned.x1; ++x)
+                v[ghost_index(x, y)] += link.owned_values[k++];
+    }
+}
+
+double DistributedSolver::allreduce(std::span<double> values, DistributedReport& report)
+{
+    comm_.allreduce_sum(values);
+    ++report.allreduces;
+    return values[0];
+}
+
+DistributedReport DistributedSolver::solve(std::span<double> x)
+{
+    if (x.size() != block_.area())
+        throw std::invalid_argument("distributed: iterate size does not match the rank's block");
+    static const perf::Stage stage("recon.distributed_solve");
+    const perf::ScopedTimer timer(stage);
+
+    DistributedReport report;
+    report.block = block_;
+    report.local_samples = local_samples();
+    report.neighbours = links_.size();
+    const std::size_t area = ghost_.area();
+    r_.assign(area, 0.0);
+    p_.assign(area, 0.0);
+    q_.assign(area, 0.0);
+    diag_.assign(area, 0.0);
+
+    // Visits the block's pixels as (index into x, index into the ghost
+    // arrays).
+    const auto for_block = [&](auto&& fn) {
+        std::size_t j = 0;
+        for (std::uint32_t y = block_.y0; y < block_.y1; ++y) {
+            const std::size_t g0 = ghost_index(block_.x0, y);
+            for (std::uint32_t i = 0; i < block_.width(); ++i)
+                fn(j++, g0 + i);
+        }
+    };
+
+    // b = A^T W y into r_, diag(A^T W A) into diag_, each finished by
+    // collecting the contributions neighbours' samples made to the block.
+    for (const auto* samples : {&inner_, &edge_})
+        for (const RingSample& s : *samples) {
+            build_stencil(s);
+            const double w = 1.0 / (double(s.sigma) * double(s.sigma));
+            for (std::size_t k = 0; k < stencil_index_.size(); ++k) {
+                const double a = stencil_weight_[k];
+                r_[stencil_index_[k]] += a * w * s.flux;
+                diag_[stencil_index_[k]] += a * a * w;
+            }
+        }
+    accumulate_ghosts(r_, report);
+    accumulate_ghosts(diag_, report);
+    double local_init[2] = {0.0, double(report.local_samples)};
+    for_block([&](std::size_t, std::size_t g) {
+        diag_[g] += options_.regularization;
+        diag_[g] = diag_[g] > 0.0 ? diag_[g] : 1.0;
+        local_init[0] += r_[g] * r_[g];
+    });
+    const double b_norm = std::sqrt(allreduce(local_init, report));
+    report.solve.samples = static_cast<std::uint64_t>(local_init[1]);
+    if (b_norm == 0.0) {
+        std::fill(x.begin(), x.end(), 0.0);
+        return report;
+    }
+
+    // r = b - M x for the warm start.
+    for_block([&](std::size_t j, std::size_t g) { p_[g] = x[j]; });
+    apply(p_, q_, report);
+    double sums[2] = {0.0, 0.0};
+    for_block([&](std::size_t, std::size_t g) {
+        r_[g] -= q_[g];
+        p_[g] = r_[g] / diag_[g];
+        sums[0] += r_[g] * r_[g] / diag_[g];
+        sums[1] += r_[g] * r_[g];
+    });
+    double rz = allreduce(sums, report);
+    report.solve.relative_residual = std::sqrt(sums[1]) / b_norm;
+
+    while (report.solve.iterations < options_.max_iterations
+           && report.solve.relative_residual > options_.tolerance) {
+        apply(p_, q_, report);
+        double pq = 0.0;
+        for_block([&](std::size_t, std::size_t g) { pq += p_[g] * q_[g]; });
+        pq = allreduce(std::span(&pq, 1), report);
+        if (pq <= 0.0)
+            break;
+        const double alpha = rz / pq;
+        sums[0] = sums[1] = 0.0;
+        for_block([&](std::size_t j, std::size_t g) {
+            x[j] += alpha * p_[g];
+            r_[g] -= alpha * q_[g];
+            sums[0] += r_[g] * r_[g] / diag_[g];
+            sums[1] += r_[g] * r_[g];
+        });
+        const double rz_next = allreduce(sums, report);
+        ++report.solve.iterations;
+        report.solve.relative_residual = std::sqrt(sums[1]) / b_norm;
+        const double beta = rz_next / rz;
+        rz = rz_next;
+        for_block([&](std::size_t, std::size_t g) { p_[g] = r_[g] / diag_[g] + beta * p_[g]; });
+    }
+    return report;
+}
+
+void DistributedSolver::gather(std::span<const double> x, std::span<double> map, int root)
+{
+    if (x.size() != block_.area())
+        throw std::invalid_argument("distributed: block size does not match the rank's block");
+    const int rank = comm_.rank();
+    if (rank != root) {
+        const HaloTransfer t {root, x, {}};
+        comm_.exchange(std::span(&t, 1));
+        return;
+    }
+    const std::size_t side = grid_.map_size;
+    if (map.size() != side * side)
+        throw std::invalid_argument("distributed: gather target is not map_size^2");
+    std::vector<std::vector<double>> blocks(std::size_t(grid_.ranks()));
+    std::vector<HaloTransfer> transfers;
+    for (int peer = 0; peer < grid_.ranks(); ++peer) {
+        if (peer == rank)
+            continue;
+        blocks[std::size_t(peer)].resize(grid_.block(peer).area());
+        transfers.push_back({peer, {}, blocks[std::size_t(peer)]});
+    }
+    comm_.exchange(transfers);
+    blocks[std::size_t(rank)].assign(x.begin(), x.end());
+    for (int peer = 0; peer < grid_.ranks(); ++peer) {
+        const TileRect b = grid_.block(peer);
+        const std::vector<double>& v = blocks[std::size_t(peer)];
+        for (std::uint32_t y = b.y0; y < b.y1; ++y)
+            std::copy_n(v.begin() + std::ptrdiff_t(std::size_t(y - b.y0) * b.width()), b.width(),
+                        map.begin() + std::ptrdiff_t(y * side + b.x0));
+    }
+}
+
+} // namespace solarlens::recon
@@ -0,0 +1,274 @@
+#include "solarlens/recon/incremental.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include "solarlens/recon/map_file.hpp"
+#include "solarlens/recon/spill_store.hpp"
+#include "solarlens/sched/scheduler.hpp"
+#include "tile_workspace.hpp"
+
+namespace solarlens::recon {
+
+namespace {
+
+// State file: { "SLIN", u32 version, u32 map_size, u32 tile_size,
+// u32 support, u32 reserved, u64 total_samples, 32-byte settings digest },
+// then one u64 per tile: the bucket size its stored solution was solved
+// from.
+constexpr std::array<char, 4> state_magic = {'S', 'L', 'I', 'N'};
+constexpr std::uint32_t state_version = 2;
+constexpr std::size_t state_size = 64;
+
+struct State {
+    std::uint32_t map_size = 0;
+    std::uint32_t tile_size = 0;
+    std::uint32_t support = 0;
+    std::uint64_t total_samples = 0;
+    core::Digest settings;
+    std::vector<std::uint64_t> solved;
+};
+
+std::filesystem::path state_path(const std::filesystem::path& dir) { return dir / "state"; }
+
+bool read_state(const std::filesystem::path& path, State& out)
+{
+    if (!std::filesystem::exists(path))
+        return false;
+    const core::File file(path, core::File::Mode::read);
+    std::array<std::byte, state_size> h {};
+    file.pread_exact(h, 0);
+    std::uint32_t version = 0;
+    std::memcpy(&version, h.data() + 4, 4);
+    if (std::memcmp(h.data(), state_magic.data(), 4) != 0)
+        throw std::runtime_error("incremental state: bad magic in " + path.string());
+    if (version != state_version)
+        throw std::runtime_error("incremental state: unsupported version in " + path.string());
+    std::memcpy(&out.map_size, h.data() + 8, 4);
+    std::memcpy(&out.tile_size, h.data() + 12, 4);
+    std::memcpy(&out.support, h.data() + 16, 4);
+    std::memcpy(&out.total_samples, h.data() + 24, 8);
+    std::memcpy(out.settings.bytes.data(), h.data() + 32, 32);
+    const std::uint64_t tail = file.size() - state_size;
+    if (tail % sizeof(std::uint64_t) != 0)
+        throw std::runtime_error("incremental state: truncated " + path.string());
+    out.solved.resize(static_cast<std::size_t>(tail / sizeof(std::uint64_t)));
+    file.pread_exact(std::as_writable_bytes(std::span(out.solved)), state_size);
+    return true;
+}
+
+void write_state(const std::filesystem::path& path, const State& s)
+{
+    std::array<std::byte, state_size> h {};
+    std::memcpy(h.data(), state_magic.data(), 4);
+    std::memcpy(h.data() + 4, &state_version, 4);
+    std::memcpy(h.data() + 8, &s.map_size, 4);
+    std::memcpy(h.data() + 12, &s.tile_size, 4);
+    std::memcpy(h.data() + 16, &s.support, 4);
+    std::memcpy(h.data() + 24, &s.total_samples, 8);
+    std::memcpy(h.data() + 32, s.settings.bytes.data(), 32);
+    // Written beside the old state and renamed, so a crash leaves one
+    // complete copy.
+    std::filesystem::path tmp = path;
+    tmp += ".tmp";
+    {
+        core::File file(tmp, core::File::Mode::write);
+        file.write(h);
+        file.write(std::as_bytes(std::span(s.solved)));
+        file.sync();
+    }
+    std::filesystem::rename(tmp, path);
+}
+
+/// Everything besides the samples that a stored solution depends on.
+core::Digest settings_digest(const SampledKernel& kernel, const SolverOptions& solver)
+{
+    core::Sha256 h;
+    const auto field = [&h](const auto& value) { h.update(std::as_bytes(std::span(&value, 1))); };
+    field(kernel.radius());
+    h.update(std::as_bytes(kernel.table()));
+    field(solver.max_iterations);
+    field(solver.tolerance);
+    field(solver.regularization);
+    field(solver.precision);
+    field(solver.inner_tolerance);
+    field(solver.max_refinements);
+    return h.finish();
+}
+
+std::size_t solve_fixed_bytes(const SampledKernel& kernel, const TilePlan& plan)
+{
+    return detail::fixed_bytes(kernel) + plan.max_region_area() * solver_bytes_per_pixel;
+}
+
+} // namespace
+
+IncrementalReconstructor::IncrementalReconstructor(const PsfKernel& psf,
+                                                   const IncrementalConfig& config)
+    : config_(config)
+    , kernel_(psf, config.kernel_oversample)
+    , plan_(detail::make_plan(config_.map_size, config_.tile_size, config_.memory_budget_bytes, kernel_))
+{
+    if (config_.state_dir.empty())
+        throw std::invalid_argument("IncrementalReconstructor: state_dir is required");
+    const std::size_t budget = config_.memory_budget_bytes;
+    if (solve_fixed_bytes(kernel_, plan_) + min_chunk_samples * sizeof(RingSample) > budget)
+        throw std::invalid_argument("IncrementalReconstructor: tile size exceeds memory budget");
+    const std::size_t spill_room = budget - min_chunk_samples * sizeof(RingSample);
+    const std::size_t spill_buffer = std::min(
+        detail::max_spill_buffer, spill_room / (plan_.tile_count() * sizeof(RingSample)));
+    if (spill_buffer < detail::min_spill_buffer)
+        throw std::invalid_argument("IncrementalReconstructor: memory budget too small for tile count");
+
+    std::filesystem::create_directories(config_.state_dir);
+    settings_ = settings_digest(kernel_, config_.solver);
+    State state;
+    const bool resume = read_state(state_path(config_.state_dir), state);
+    if (resume) {
+        if (state.map_size != plan_.map_size() || state.tile_size != plan_.tile_size() ||
+            state.support != plan_.support() || state.solved.size() != plan_.tile_count())
+            throw std::runtime_error("incremental state in " + config_.state_dir.string() +
+                                     " was built with a different map, tile size or kernel");
+        if (state.settings != settings_ && !config_.accept_changed_settings)
+            throw std::runtime_error("incremental state in " + config_.state_dir.string() +
+                                     " was solved with different kernel or solver settings");
+        total_samples_ = state.total_samples;
+        solved_ = std::move(state.solved);
+    } else {
+        solved_.assign(plan_.tile_count(), 0);
+    }
+
+    store_ = std::make_unique<SpillStore>(plan_, config_.state_dir / "buckets", spill_buffer,
+                                          resume ? SpillStore::Open::resume : SpillStore::Open::fresh);
+    solutions_ = core::File(config_.state_dir / "solutions.f64",
+                            resume ? core::File::Mode::read_write : core::File::Mode::scratch);
+    // Sparse until tiles are first solved; unsolved slots read back as
+    // the zero starting guess.
+    solutions_.truncate(std::uint64_t(plan_.tile_count()) * plan_.max_region_area() * sizeof(double));
+    if (!resume || !std::filesystem::exists(map_path()))
+        MapFileWriter(map_path(), plan_.map_size(), plan_.map_size()).close();
+
+    // Buckets that grew since their tile was last solved were binned by an
+    // update that did not finish; new settings make every solution stale.
+    if (resume && state.settings != settings_)
+        std::fill(solved_.begin(), solved_.end(), 0);
+    dirty_.resize(plan_.tile_count());
+    for (std::size_t t = 0; t < plan_.tile_count(); ++t)
+        dirty_[t] = store_->count(t) != solved_[t];
+    if (!resume || state.settings != settings_)
+        save_state();
+}
+
+IncrementalReconstructor::~IncrementalReconstructor() = default;
+
+std::filesystem::path IncrementalReconstructor::map_path() const
+{
+    return config_.state_dir / "map.slmp";
+}
+
+UpdateReport IncrementalReconstructor::add(std::span<const RingSample> samples)
+{
+    UpdateReport report;
+    bin(samples, report);
+    store_->flush();
+    solve_dirty(report);
+    return report;
+}
+
+UpdateReport IncrementalReconstructor::add_file(const std::filesystem::path& samples_in)
+{
+    UpdateReport report;
+    RingSampleReader reader(samples_in);
+    std::vector<RingSample> chunk(min_chunk_samples);
+    while (const std::size_t n = reader.read(chunk))
+        bin(std::span(chunk).first(n), report);
+    store_->flush();
+    solve_dirty(report);
+    return report;
+}
+
+UpdateReport IncrementalReconstructor::refresh_all()
+{
+    for (std::size_t t = 0; t < plan_.tile_count(); ++t)
+        dirty_[t] = store_->count(t) > 0;
+    UpdateReport report;
+    solve_dirty(report);
+    return report;
+}
+
+void IncrementalReconstructor::bin(std::span<const RingSample> samples, UpdateReport& report)
+{
+    std::uint64_t added = 0;
+    for (const RingSample& s : samples) {
+        if (store_->add(s) == 0) {
+            ++report.samples_rejected;
+            continue;
+        }
+        ++added;
+        plan_.for_each_tile_using(s.u, s.v, [this](std::uint32_t tile) { dirty_[tile] = true; });
+    }
+    report.samples_added += added;
+    total_samples_ += added;
+}
+
+void IncrementalReconstructor::solve_dirty(UpdateReport& report)
+{
+    std::vector<std::uint32_t> tiles;
+    for (std::size_t t = 0; t < dirty_.size(); ++t)
+        if (dirty_[t])
+            tiles.push_back(static_cast<std::uint32_t>(t));
+
+    const std::size_t budget = config_.memory_budget_bytes;
+    const std::size_t solve_fixed = solve_fixed_bytes(kernel_, plan_);
+    const std::size_t slots = detail::solve_slots(
+        budget, solve_fixed + min_chunk_samples * sizeof(RingSample), config_.scheduler,
+        config_.max_parallel_tiles, tiles.size());
+    const std::size_t chunk_samples = (budget / slots - solve_fixed) / sizeof(RingSample);
+    const std::uint64_t slot_bytes = std::uint64_t(plan_.max_region_area()) * sizeof(double);
+
+    MapFileWriter map(map_path());
+    report.tiles.resize(tiles.size());
+    std::atomic<std::size_t> next {0};
+    const auto work = [&] {
+        detail::TileWorkspace ws(kernel_, config_.solver);
+        for (std::size_t i; (i = next.fetch_add(1, std::memory_order_relaxed)) < tiles.size();) {
+            const Tile tile = plan_.tile(tiles[i]);
+            ws.x.resize(tile.region.area());
+            const std::uint64_t at = tiles[i] * slot_bytes;
+            solutions_.pread_exact(std::as_writable_bytes(std::span(ws.x)), at);
+            report.tiles[i] = ws.solve(tile, *store_, chunk_samples, map, true);
+            solutions_.pwrite(std::as_bytes(std::span<const double>(ws.x)), at);
+        }
+    };
+    if (slots == 1 || tiles.size() < 2) {
+        work();
+    } else {
+        sched::TaskGroup group(*config_.scheduler);
+        for (std::size_t s = 0; s < slots; ++s)
+            group.run(work);
+        group.wait();
+    }
+    map.close();
+
+    for (const std::uint32_t t : tiles)
+        solved_[t] = store_->count(t);
+    std::fill(dirty_.begin(), dirty_.end(), false);
+    report.tiles_solved = tiles.size();
+    for (const TileReport& tr : report.tiles)
+        report.iterations += tr.solve.iterations;
+    report.samples_total = total_samples_;
+    save_state();
+}
+
+void IncrementalReconstructor::save_state()
+{
+    write_state(state_path(config_.state_dir),
+                {plan_.map_size(), plan_.tile_size(), plan_.support(), total_samples_, settings_, solved_});
+}
+
+} // namespace solarlens::recon
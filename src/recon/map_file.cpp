@@ -0,0 +1,90 @@
+#include "solarlens/recon/map_file.hpp"
+
+#include <array>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+namespace solarlens::recon {
+
+namespace {
+
+constexpr std::array<char, 4> magic = {'S', 'L', 'M', 'P'};
+constexpr std::uint64_t header_size = 16;
+
+void check_block(std::uint32_t width, std::uint32_t height, std::uint32_t x0, std::uint32_t y0,
+                 std::uint32_t w, std::uint32_t h, std::size_t pixels)
+{
+    if (std::uint64_t(x0) + w > width || std::uint64_t(y0) + h > height)
+        throw std::out_of_range("map file: block outside map");
+    if (pixels < std::size_t(w) * h)
+        throw std::invalid_argument("map file: block buffer too small");
+}
+
+void read_header(const core::File& file, std::uint32_t& width, std::uint32_t& height)
+{
+    std::array<std::byte, header_size> h {};
+    file.pread_exact(h, 0);
+    std::uint32_t version = 0;
+    std::memcpy(&version, h.data() + 4, 4);
+    std::memcpy(&width, h.data() + 8, 4);
+    std::memcpy(&height, h.data() + 12, 4);
+    const std::string path = file.path().string();
+    if (std::memcmp(h.data(), magic.data(), 4) != 0)
+        throw std::runtime_error("map file: bad magic in " + path);
+    if (version != map_file_version)
+        throw std::runtime_error("map file: unsupported version in " + path);
+    if (file.size() < header_size + std::uint64_t(width) * height * sizeof(float))
+        throw std::runtime_error("map file: truncated " + path);
+}
+
+} // namespace
+
+MapFileWriter::MapFileWriter(const std::filesystem::path& path, std::uint32_t width,
+                             std::uint32_t height)
+    : file_(path, core::File::Mode::write)
+    , width_(width)
+    , height_(height)
+{
+    std::array<std::byte, header_size> h {};
+    std::memcpy(h.data(), magic.data(), 4);
+    std::memcpy(h.data() + 4, &map_file_version, 4);
+    std::memcpy(h.data() + 8, &width, 4);
+    std::memcpy(h.data() + 12, &height, 4);
+    file_.pwrite(h, 0);
+    file_.truncate(header_size + std::uint64_t(width) * height * sizeof(float));
+}
+
+MapFileWriter::MapFileWriter(const std::filesystem::path& path)
+    : file_(path, core::File::Mode::read_write)
+{
+    read_header(file_, width_, height_);
+}
+
+void MapFileWriter::write_block(std::uint32_t x0, std::uint32_t y0, std::uint32_t w,
+                                std::uint32_t h, std::span<const float> pixels)
+{
+    check_block(width_, height_, x0, y0, w, h, pixels.size());
+    for (std::uint32_t row = 0; row < h; ++row) {
+        const auto offset = header_size + (std::uint64_t(y0 + row) * width_ + x0) * sizeof(float);
+        file_.pwrite(std::as_bytes(pixels.subspan(std::size_t(row) * w, w)), offset);
+    }
+}
+
+MapFileReader::MapFileReader(const std::filesystem::path& path)
+    : file_(path, core::File::Mode::read)
+{
+    read_header(file_, width_, height_);
+}
+
+void MapFileReader::read_block(std::uint32_t x0, std::uint32_t y0, std::uint32_t w,
+                               std::uint32_t h, std::span<float> pixels) const
+{
+    check_block(width_, height_, x0, y0, w, h, pixels.size());
+    for (std::uint32_t row = 0; row < h; ++row) {
+        const auto offset = header_size + (std::uint64_t(y0 + row) * width_ + x0) * sizeof(float);
+        file_.pread_exact(std::as_writable_bytes(pixels.subspan(std::size_t(row) * w, w)), offset);
+    }
+}
+
+} // namespace solarlens::recon
@@ -0,0 +1,291 @@
+#include "solarlens/recon/map_pyramid.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace solarlens::recon {
+
+namespace {
+
+// Bound on the level-0 block read at once while building resident levels.
+constexpr std::size_t max_block_pixels = std::size_t(1) << 22;
+
+std::uint32_t ceil_div(std::uint32_t a, std::uint32_t b) noexcept
+{
+    return (a + b - 1) / b;
+}
+
+// Pixel (x, y) of the level above an image of sw x sh: the mean of the
+// children that exist. Every path through the pyramid goes through here,
+// so resident and lazily built levels agree bit for bit.
+float mean4(const float* src, std::size_t stride, std::uint32_t sw, std::uint32_t sh, std::uint32_t x,
+            std::uint32_t y) noexcept
+{
+    const std::uint32_t cx = 2 * x;
+    const std::uint32_t cy = 2 * y;
+    const bool right = cx + 1 < sw;
+    const bool below = cy + 1 < sh;
+    const float* row = src + std::size_t(cy) * stride + cx;
+    float sum = row[0];
+    float count = 1.0f;
+    if (right) {
+        sum += row[1];
+        count += 1.0f;
+    }
+    if (below) {
+        sum += row[stride];
+        count += 1.0f;
+        if (right) {
+            sum += row[stride + 1];
+            count += 1.0f;
+        }
+    }
+    return sum / count;
+}
+
+// Halves a whole sw x sh image; `dst` is ceil(sw / 2) x ceil(sh / 2).
+void halve(const float* src, std::uint32_t sw, std::uint32_t sh, float* dst)
+{
+    const std::uint32_t dw = ceil_div(sw, 2);
+    const std::uint32_t dh = ceil_div(sh, 2);
+    for (std::uint32_t y = 0; y < dh; ++y)
+        for (std::uint32_t x = 0; x < dw; ++x)
+            dst[std::size_t(y) * dw + x] = mean4(src, sw, sw, sh, x, y);
+}
+
+std::uint64_t key_of(std::uint32_t level, std::uint32_t tx, std::uint32_t ty) noexcept
+{
+    return std::uint64_t(level) << 48 | std::uint64_t(ty) << 24 | tx;
+}
+
+bool overlaps(const TileRect& a, const TileRect& b) noexcept
+{
+    return a.x0 < b.x1 && b.x0 < a.x1 && a.y0 < b.y1 && b.y0 < a.y1;
+}
+
+} // namespace
+
+void PyramidConfig::validate() const
+{
+    if (tile_size == 0)
+        throw std::invalid_argument("map pyramid: tile_size must be positive");
+    if (std::size_t(tile_size) * tile_size * sizeof(float) > cache_bytes)
+        throw std::invalid_argument("map pyramid: cache_bytes must hold at least one tile");
+}
+
+MapPyramid::MapPyramid(const std::filesystem::path& map_path, const PyramidConfig& config)
+    : config_(config)
+    , map_(map_path)
+{
+    config_.validate();
+    Size size {map_.width(), map_.height()};
+    if (size.width == 0 || size.height == 0)
+        throw std::runtime_error("map pyramid: empty map " + map_path.string());
+    sizes_.push_back(size);
+    while (std::max(size.width, size.height) > config_.tile_size) {
+        size = {ceil_div(size.width, 2), ceil_div(size.height, 2)};
+        sizes_.push_back(size);
+    }
+    resident_ = levels() - 1;
+    while (resident_ > 0 && std::max(sizes_[resident_ - 1].width, sizes_[resident_ - 1].height) <= config_.preview_size)
+        --resident_;
+
+    for (std::uint32_t l = resident_; l < levels(); ++l)
+        preview_.emplace_back(std::size_t(sizes_[l].width) * sizes_[l].height, 0.0f);
+    build_resident({0, 0, sizes_[0].width, sizes_[0].height}, preview_);
+}
+
+std::uint32_t MapPyramid::tiles_x(std::uint32_t level) const
+{
+    return ceil_div(width(level), config_.tile_size);
+}
+
+std::uint32_t MapPyramid::tiles_y(std::uint32_t level) const
+{
+    return ceil_div(height(level), config_.tile_size);
+}
+
+TileRect MapPyramid::tile_rect(std::uint32_t level, std::uint32_t tx, std::uint32_t ty) const
+{
+    const std::uint32_t t = config_.tile_size;
+    const Size& s = sizes_[level];
+    return {tx * t, ty * t, std::min(s.width, (tx + 1) * t), std::min(s.height, (ty + 1) * t)};
+}
+
+void MapPyramid::build_resident(const TileRect& region, std::vector<std::vector<float>>& images) const
+{
+    // Level 0 is read in blocks aligned to the resident level's footprint,
+    // each halved down to a strip of resident-level pixels.
+    const std::uint32_t f = std::uint32_t(1) << resident_;
+    const Size full = sizes_[0];
+    const std::uint32_t x0 = region.x0 / f * f;
+    const std::uint32_t y0 = region.y0 / f * f;
+    const std::uint32_t x1 = std::min(full.width, ceil_div(region.x1, f) * f);
+    const std::uint32_t y1 = std::min(full.height, ceil_div(region.y1, f) * f);
+    const std::uint32_t chunk = std::max<std::uint32_t>(f, static_cast<std::uint32_t>(max_block_pixels / f / f * f));
+    const Size base = sizes_[resident_];
+    std::vector<float> block;
+    std::vector<float> half;
+    for (std::uint32_t y = y0; y < y1; y += f)
+        for (std::uint32_t x = x0; x < x1; x += chunk) {
+            std::uint32_t w = std::min(chunk, x1 - x);
+            std::uint32_t h = std::min(f, y1 - y);
+            block.resize(std::size_t(w) * h);
+            map_.read_block(x, y, w, h, block);
+            for (std::uint32_t l = 0; l < resident_; ++l) {
+                half.resize(std::size_t(ceil_div(w, 2)) * ceil_div(h, 2));
+                halve(block.data(), w, h, half.data());
+                block.swap(half);
+                w = ceil_div(w, 2);
+                h = ceil_div(h, 2);
+            }
+            std::copy_n(block.data(), w, images[0].data() + std::size_t(y / f) * base.width + x / f);
+        }
+
+    // Coarser resident levels from the one below, over the affected pixels.
+    TileRect r {x0 / f, y0 / f, ceil_div(x1, f), ceil_div(y1, f)};
+    for (std::uint32_t l = resident_ + 1; l < levels(); ++l) {
+        r = {r.x0 / 2, r.y0 / 2, ceil_div(r.x1, 2), ceil_div(r.y1, 2)};
+        const Size s = sizes_[l - 1];
+        const auto& src = images[l - 1 - resident_];
+        auto& dst = images[l - resident_];
+        for (std::uint32_t y = r.y0; y < r.y1; ++y)
+            for (std::uint32_t x = r.x0; x < r.x1; ++x)
+                dst[std::size_t(y) * sizes_[l].width + x] = mean4(src.data(), s.width, s.width, s.height, x, y);
+    }
+}
+
+std::shared_ptr<const PyramidTile> MapPyramid::tile(std::uint32_t level, std::uint32_t tx, std::uint32_t ty)
+{
+    if (level >= levels() || tx >= tiles_x(level) || ty >= tiles_y(level))
+        throw std::out_of_range("map pyramid: tile outside level");
+    return fetch(level, tx, ty, true);
+}
+
+std::shared_ptr<const PyramidTile> MapPyramid::fetch(std::uint32_t level, std::uint32_t tx, std::uint32_t ty,
+                                                     bool keep)
+{
+    const TileRect rect = tile_rect(level, tx, ty);
+
+    if (level >= resident_) {
+        auto t = std::make_shared<PyramidTile>();
+        *t = {level, rect.x0, rect.y0, rect.width(), rect.height(), std::vector<float>(rect.area())};
+        const std::uint32_t stride = sizes_[level].width;
+        std::lock_guard lock(mutex_);
+        ++stats_.hits;
+        const auto& image = preview_[level - resident_];
+        for (std::uint32_t y = 0; y < rect.height(); ++y)
+            std::copy_n(image.data() + std::size_t(rect.y0 + y) * stride + rect.x0, rect.width(),
+                        t->pixels.data() + std::size_t(y) * rect.width());
+        return t;
+    }
+
+    const std::uint64_t key = key_of(level, tx, ty);
+    std::uint64_t generation = 0;
+    {
+        std::lock_guard lock(mutex_);
+        if (auto it = cache_.find(key); it != cache_.end()) {
+            ++stats_.hits;
+            lru_.splice(lru_.begin(), lru_, it->second.lru);
+            return it->second.tile;
+        }
+        ++stats_.misses;
+        generation = generation_;
+    }
+    auto t = compute(level, tx, ty);
+    std::lock_guard lock(mutex_);
+    // A tile started before an invalidation may hold stale pixels; hand it
+    // out but do not cache it.
+    if (keep && generation == generation_ && !cache_.contains(key))
+        insert_locked(key, t);
+    return t;
+}
+
+std::shared_ptr<const PyramidTile> MapPyramid::compute(std::uint32_t level, std::uint32_t tx, std::uint32_t ty)
+{
+    const TileRect rect = tile_rect(level, tx, ty);
+    auto t = std::make_shared<PyramidTile>();
+    *t = {level, rect.x0, rect.y0, rect.width(), rect.height(), std::vector<float>(rect.area())};
+    if (level == 0) {
+        map_.read_block(rect.x0, rect.y0, rect.width(), rect.height(), t->pixels);
+        return t;
+    }
+
+    // Gather the children's pixels into one window, clipped to the level
+    // below exactly as a whole-level halving would be. Cached children are
+    // reused, but children made here are not cached: a coarse tile covers
+    // 4^L level-0 tiles and would otherwise flush the viewer's working set.
+    const std::uint32_t child = level - 1;
+    const std::uint32_t cw = std::min(2 * rect.x1, sizes_[child].width) - 2 * rect.x0;
+    const std::uint32_t ch = std::min(2 * rect.y1, sizes_[child].height) - 2 * rect.y0;
+    std::vector<float> window(std::size_t(cw) * ch);
+    for (std::uint32_t cy = 2 * ty; cy < std::min(2 * ty + 2, tiles_y(child)); ++cy)
+        for (std::uint32_t cx = 2 * tx; cx < std::min(2 * tx + 2, tiles_x(child)); ++cx) {
+            const auto c = fetch(child, cx, cy, false);
+            const std::uint32_t ox = c->x0 - 2 * rect.x0;
+            const std::uint32_t oy = c->y0 - 2 * rect.y0;
+            for (std::uint32_t y = 0; y < c->height; ++y)
+                std::copy_n(c->pixels.data() + std::size_t(y) * c->width, c->width,
+                            window.data() + std::size_t(oy + y) * cw + ox);
+        }
+    halve(window.data(), cw, ch, t->pixels.data());
+    return t;
+}
+
+void MapPyramid::insert_locked(std::uint64_t key, std::shared_ptr<const PyramidTile> tile)
+{
+    const std::size_t bytes = tile->pixels.size() * sizeof(float);
+    lru_.push_front(key);
+    cache_.emplace(key, Entry {std::move(tile), lru_.begin()});
+    stats_.cached_bytes += bytes;
+    while (stats_.cached_bytes > config_.cache_bytes && lru_.size() > 1) {
+        const auto victim = cache_.find(lru_.back());
+        stats_.cached_bytes -= victim->second.tile->pixels.size() * sizeof(float);
+        cache_.erase(victim);
+        lru_.pop_back();
+        ++stats_.evictions;
+    }
+}
+
+void MapPyramid::invalidate(const TileRect& region)
+{
+    const TileRect r {region.x0, region.y0, std::min(region.x1, sizes_[0].width),
+                      std::min(region.y1, sizes_[0].height)};
+    if (r.x0 >= r.x1 || r.y0 >= r.y1)
+        return;
+    // Serialise rebuilds so two overlapping updates cannot interleave
+    // their copies of the resident levels.
+    std::lock_guard rebuild(invalidate_mutex_);
+    std::vector<std::vector<float>> images;
+    {
+        std::lock_guard lock(mutex_);
+        images = preview_;
+    }
+    build_resident(r, images);
+
+    std::lock_guard lock(mutex_);
+    preview_ = std::move(images);
+    ++generation_;
+    for (auto it = cache_.begin(); it != cache_.end();) {
+        const PyramidTile& t = *it->second.tile;
+        const std::uint32_t l = t.level;
+        const TileRect footprint {t.x0 << l, t.y0 << l, (t.x0 + t.width) << l, (t.y0 + t.height) << l};
+        if (overlaps(footprint, r)) {
+            stats_.cached_bytes -= t.pixels.size() * sizeof(float);
+            lru_.erase(it->second.lru);
+            it = cache_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
+
+PyramidStats MapPyramid::stats() const
+{
+    std::lock_guard lock(mutex_);
+    PyramidStats s = stats_;
+    s.cached_tiles = cache_.size();
+    return s;
+}
+
+} // namespace solarlens::recon
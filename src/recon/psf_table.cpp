@@ -0,0 +1,289 @@
+#include "solarlens/recon/psf_table.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+
+#include <unistd.h>
+
+#include "solarlens/core/file.hpp"
+#include "solarlens/core/mapped_file.hpp"
+#include "solarlens/core/snapshot.hpp"
+
+namespace solarlens::recon {
+
+namespace {
+
+constexpr std::array<char, 8> magic = {'S', 'L', 'P', 'S', 'F', 'T', 'B', '\0'};
+constexpr std::size_t header_size = 112;
+constexpr std::uint64_t data_alignment = 4096;
+
+std::size_t value_count(const PsfGridSpec& spec)
+{
+    return std::size_t(spec.distance_au.count) * spec.wavelength_m.count * spec.offset_px.count;
+}
+
+void validate(const PsfGridSpec& spec)
+{
+    for (const GridAxis* a : {&spec.distance_au, &spec.wavelength_m, &spec.offset_px})
+        if (a->count == 0 || !(a->max >= a->min) || (a->count == 1 && a->max != a->min))
+            throw std::invalid_argument("psf table: invalid grid axis");
+    if (spec.offset_px.min != 0.0 || spec.offset_px.count < 2)
+        throw std::invalid_argument("psf table: offset axis must start at 0 with >= 2 nodes");
+    if (spec.distance_au.min <= 0 || spec.wavelength_m.min <= 0 || spec.pixel_pitch_m <= 0)
+        throw std::invalid_argument("psf table: distances, wavelengths and pitch must be positive");
+}
+
+std::array<std::byte, header_size> encode_header(const PsfGridSpec& spec)
+{
+    std::array<std::byte, header_size> h {};
+    std::byte* p = h.data();
+    const auto put = [&p](const auto& v) {
+        std::memcpy(p, &v, sizeof v);
+        p += sizeof v;
+    };
+    std::memcpy(p, magic.data(), magic.size());
+    p += magic.size();
+    put(psf_table_version);
+    put(std::uint32_t {0});
+    for (const GridAxis* a : {&spec.distance_au, &spec.wavelength_m, &spec.offset_px}) {
+        put(a->min);
+        put(a->max);
+        put(a->count);
+        put(std::uint32_t {0});
+    }
+    put(spec.pixel_pitch_m);
+    put(data_alignment);
+    put(std::uint64_t(value_count(spec) * sizeof(float)));
+    return h;
+}
+
+/// Fractional index of `x` on `axis`, clamped to the axis.
+void locate(const GridAxis& axis, double x, std::uint32_t& i, double& f) noexcept
+{
+    if (axis.count == 1 || x <= axis.min) {
+        i = 0;
+        f = 0.0;
+        return;
+    }
+    const double t = (x - axis.min) / axis.step();
+    if (t >= axis.count - 1) {
+        i = axis.count - 2;
+        f = 1.0;
+        return;
+    }
+    i = static_cast<std::uint32_t>(t);
+    f = t - i;
+}
+
+struct Parsed {
+    PsfGridSpec spec;
+    std::span<const float> values;
+};
+
+/// Checks a table image, from a file or a snapshot section.
+Parsed parse(std::span<const std::byte> bytes, const std::string& source)
+{
+    const auto bad = [&](const char* why) {
+        return std::runtime_error(std::string("psf table: ") + why + " in " + source);
+    };
+    if (bytes.size() < header_size || std::memcmp(bytes.data(), magic.data(), magic.size()) != 0)
+        throw bad("bad magic");
+    const std::byte* p = bytes.data() + magic.size();
+    const auto get = [&p](auto& v) {
+        std::memcpy(&v, p, sizeof v);
+        p += sizeof v;
+    };
+    std::uint32_t version = 0;
+    std::uint32_t reserved = 0;
+    get(version);
+    get(reserved);
+    if (version != psf_table_version)
+        throw bad("unsupported version");
+    PsfGridSpec spec;
+    for (GridAxis* a : {&spec.distance_au, &spec.wavelength_m, &spec.offset_px}) {
+        std::uint32_t pad = 0;
+        get(a->min);
+        get(a->max);
+        get(a->count);
+        get(pad);
+    }
+    std::uint64_t data_offset = 0;
+    std::uint64_t data_size = 0;
+    get(spec.pixel_pitch_m);
+    get(data_offset);
+    get(data_size);
+    try {
+        validate(spec);
+    } catch (const std::invalid_argument&) {
+        throw bad("invalid grid");
+    }
+    if (data_size != value_count(spec) * sizeof(float) || data_offset % alignof(float) != 0
+        || data_offset > bytes.size() || bytes.size() - data_offset < data_size)
+        throw bad("truncated data");
+
+    const auto* values = reinterpret_cast<const float*>(bytes.data() + data_offset);
+    return {spec, {values, value_count(spec)}};
+}
+
+
+} // namespace
+
+void build_psf_table(const PsfGridSpec& spec, const std::filesystem::path& path)
+{
+    validate(spec);
+    const std::uint32_t nd = spec.distance_au.count;
+    const std::uint32_t nw = spec.wavelength_m.count;
+    const std::uint32_t no = spec.offset_px.count;
+    std::vector<float> values(value_count(spec));
+
+    // Distances are independent; split them across cores.
+    const unsigned workers = std::max(1u, std::min(std::thread::hardware_concurrency(), nd));
+    std::vector<std::thread> threads;
+    for (unsigned w = 0; w < workers; ++w)
+        threads.emplace_back([&, w] {
+            for (std::uint32_t d = w; d < nd; d += workers)
+                for (std::uint32_t l = 0; l < nw; ++l) {
+                    const SglPsf psf({spec.distance_au.node(d), spec.wavelength_m.node(l),
+                                      spec.pixel_pitch_m, spec.offset_px.max + 1.0});
+                    float* row = values.data() + (std::size_t(d) * nw + l) * no;
+                    for (std::uint32_t o = 0; o < no; ++o)
+                        row[o] = static_cast<float>(psf.value(spec.offset_px.node(o)));
+                }
+        });
+    for (std::thread& t : threads)
+        t.join();
+
+    const std::filesystem::path tmp
+        = path.string() + ".tmp." + std::to_string(::getpid());
+    {
+        core::File f(tmp, core::File::Mode::write);
+        f.pwrite(encode_header(spec), 0);
+        f.pwrite(std::as_bytes(std::span<const float>(values)), data_alignment);
+        f.sync();
+        f.close();
+    }
+    std::filesystem::rename(tmp, path);
+}
+
+PsfTable::PsfTable(std::shared_ptr<const void> storage, const PsfGridSpec& spec, std::span<const float> values)
+    : storage_(std::move(storage))
+    , spec_(spec)
+    , values_(values)
+{
+}
+
+PsfTable PsfTable::open(const std::filesystem::path& path)
+{
+    auto file = std::make_shared<const core::MappedFile>(path);
+    const Parsed table = parse(file->bytes(), path.string());
+    return PsfTable(std::move(file), table.spec, table.values);
+}
+
+PsfTable PsfTable::open(std::shared_ptr<const core::Snapshot> snapshot, std::string_view section)
+{
+    const Parsed table = parse(snapshot->section(section),
+                               snapshot->path().string() + " section " + std::string(section));
+    return PsfTable(std::move(snapshot), table.spec, table.values);
+}
+
+void PsfTable::snapshot(core::SnapshotWriter& writer, std::string_view section) const
+{
+    const auto values = std::as_bytes(values_);
+    std::vector<std::byte> image(data_alignment + values.size());
+    const auto header = encode_header(spec_);
+    std::copy(header.begin(), header.end(), image.begin());
+    std::copy(values.begin(), values.end(), image.begin() + data_alignment);
+    writer.add(section, image);
+}
+
+PsfTable PsfTable::open_or_build(const std::filesystem::path& path, const PsfGridSpec& spec)
+{
+    if (std::filesystem::exists(path)) {
+        try {
+            PsfTable table = open(path);
+            if (table.spec() == spec)
+                return table;
+        } catch (const std::runtime_error&) {
+            // Stale or damaged; rebuild below.
+        }
+    }
+    build_psf_table(spec, path);
+    return open(path);
+}
+
+double PsfTable::lookup(double distance_au, double wavelength_m, double offset_px) const noexcept
+{
+    const GridAxis& oa = spec_.offset_px;
+    if (!(offset_px >= 0.0) || offset_px > oa.max)
+        return 0.0;
+    std::uint32_t di, wi, oi;
+    double df, wf, of;
+    locate(spec_.distance_au, distance_au, di, df);
+    locate(spec_.wavelength_m, wavelength_m, wi, wf);
+    locate(oa, offset_px, oi, of);
+
+    const std::uint32_t nw = spec_.wavelength_m.count;
+    const std::uint32_t no = oa.count;
+    const std::uint32_t d1 = std::min(di + 1, spec_.distance_au.count - 1);
+    const std::uint32_t w1 = std::min(wi + 1, nw - 1);
+    const auto at = [&](std::uint32_t d, std::uint32_t w) {
+        const float* row = values_.data() + (std::size_t(d) * nw + w) * no;
+        return row[oi] + of * (row[oi + 1] - row[oi]);
+    };
+    const double lo = at(di, wi) + wf * (at(di, w1) - at(di, wi));
+    const double hi = at(d1, wi) + wf * (at(d1, w1) - at(d1, wi));
+    return lo + df * (hi - lo);
+}
+
+void PsfTable::interpolate_row(double distance_au, double wavelength_m, std::span<double> out) const
+{
+    std::uint32_t di, wi;
+    double df, wf;
+    locate(spec_.distance_au, distance_au, di, df);
+    locate(spec_.wavelength_m, wavelength_m, wi, wf);
+    const std::uint32_t nw = spec_.wavelength_m.count;
+    const std::uint32_t no = spec_.offset_px.count;
+    const std::uint32_t d1 = std::min(di + 1, spec_.distance_au.count - 1);
+    const std::uint32_t w1 = std::min(wi + 1, nw - 1);
+    const float* r00 = values_.data() + (std::size_t(di) * nw + wi) * no;
+    const float* r01 = values_.data() + (std::size_t(di) * nw + w1) * no;
+    const float* r10 = values_.data() + (std::size_t(d1) * nw + wi) * no;
+    const float* r11 = values_.data() + (std::size_t(d1) * nw + w1) * no;
+    for (std::uint32_t o = 0; o < no; ++o) {
+        const double lo = r00[o] + wf * (r01[o] - r00[o]);
+        const double hi = r10[o] + wf * (r11[o] - r10[o]);
+        out[o] = lo + df * (hi - lo);
+    }
+}
+
+TablePsfKernel PsfTable::kernel(double distance_au, double wavelength_m) const
+{
+    std::vector<double> row(spec_.offset_px.count);
+    interpolate_row(distance_au, wavelength_m, row);
+    return TablePsfKernel(std::move(row), spec_.offset_px.step(), spec_.offset_px.max);
+}
+
+TablePsfKernel::TablePsfKernel(std::vector<double> row, double step, double support)
+    : row_(std::move(row))
+    , inv_step_(1.0 / step)
+    , support_(support)
+{
+}
+
+double TablePsfKernel::value(double rho) const
+{
+    if (!(rho >= 0.0) || rho >= support_)
+        return 0.0;
+    const double t = rho * inv_step_;
+    const auto i = std::min(static_cast<std::size_t>(t), row_.size() - 2);
+    const double f = t - static_cast<double>(i);
+    return row_[i] + f * (row_[i + 1] - row_[i]);
+}
+
+} // namespace solarlens::recon
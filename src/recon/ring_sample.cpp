@@ -0,0 +1,81 @@
+#include "solarlens/recon/ring_sample.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+namespace solarlens::recon {
+
+namespace {
+
+constexpr std::array<char, 4> magic = {'S', 'L', 'R', 'S'};
+constexpr std::size_t header_size = 16;
+
+std::array<std::byte, header_size> encode_header(std::uint64_t count)
+{
+    std::array<std::byte, header_size> h {};
+    std::memcpy(h.data(), magic.data(), magic.size());
+    std::memcpy(h.data() + 4, &ring_sample_file_version, 4);
+    std::memcpy(h.data() + 8, &count, 8);
+    return h;
+}
+
+} // namespace
+
+RingSampleWriter::RingSampleWriter(const std::filesystem::path& path)
+    : file_(path, core::File::Mode::write)
+{
+    file_.write(encode_header(0));
+}
+
+RingSampleWriter::~RingSampleWriter()
+{
+    try {
+        close();
+    } catch (...) {
+    }
+}
+
+void RingSampleWriter::append(std::span<const RingSample> samples)
+{
+    file_.write(std::as_bytes(samples));
+    count_ += samples.size();
+}
+
+void RingSampleWriter::close()
+{
+    if (!file_.is_open())
+        return;
+    file_.pwrite(encode_header(count_), 0);
+    file_.close();
+}
+
+RingSampleReader::RingSampleReader(const std::filesystem::path& path)
+    : file_(path, core::File::Mode::read)
+{
+    std::array<std::byte, header_size> h {};
+    file_.pread_exact(h, 0);
+    std::uint32_t version = 0;
+    std::memcpy(&version, h.data() + 4, 4);
+    std::memcpy(&count_, h.data() + 8, 8);
+    if (std::memcmp(h.data(), magic.data(), magic.size()) != 0)
+        throw std::runtime_error("ring sample file: bad magic in " + path.string());
+    if (version != ring_sample_file_version)
+        throw std::runtime_error("ring sample file: unsupported version in " + path.string());
+    if (file_.size() < header_size + count_ * sizeof(RingSample))
+        throw std::runtime_error("ring sample file: truncated " + path.string());
+}
+
+std::size_t RingSampleReader::read(std::span<RingSample> out)
+{
+    const auto n = static_cast<std::size_t>(std::min<std::uint64_t>(out.size(), remaining()));
+    if (n == 0)
+        return 0;
+    file_.pread_exact(std::as_writable_bytes(out.first(n)),
+                      header_size + next_ * sizeof(RingSample));
+    next_ += n;
+    return n;
+}
+
+} // namespace solarlens::recon
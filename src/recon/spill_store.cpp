@@ -0,0 +1,111 @@
+#include "solarlens/recon/spill_store.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <stdexcept>
+
+namespace solarlens::recon {
+
+namespace {
+
+std::filesystem::path bucket_path(const std::filesystem::path& dir, std::size_t tile)
+{
+    char name[32];
+    std::snprintf(name, sizeof name, "tile-%06zu.spill", tile);
+    return dir / name;
+}
+
+} // namespace
+
+SpillStore::SpillStore(const TilePlan& plan, const std::filesystem::path& dir,
+                       std::size_t buffer_samples, Open open)
+    : plan_(plan)
+    , dir_(dir)
+    , buffer_samples_(std::max<std::size_t>(buffer_samples, 1))
+    , buckets_(plan.tile_count())
+{
+    std::filesystem::create_directories(dir_);
+    const auto mode = open == Open::resume ? core::File::Mode::read_write : core::File::Mode::scratch;
+    for (std::size_t i = 0; i < buckets_.size(); ++i) {
+        Bucket& b = buckets_[i];
+        b.file = core::File(bucket_path(dir_, i), mode);
+        b.pending.reserve(buffer_samples_);
+        // A torn final record from an interrupted flush is dropped.
+        b.flushed = b.count = b.file.size() / sizeof(RingSample);
+    }
+}
+
+SpillStore::~SpillStore() = default;
+
+std::size_t SpillStore::add(const RingSample& sample)
+{
+    std::size_t routed = 0;
+    plan_.for_each_tile_using(sample.u, sample.v, [&](std::uint32_t tile) {
+        Bucket& b = buckets_[tile];
+        b.pending.push_back(sample);
+        ++b.count;
+        ++routed;
+        if (b.pending.size() == buffer_samples_)
+            flush_bucket(b);
+    });
+    return routed;
+}
+
+void SpillStore::flush()
+{
+    for (Bucket& b : buckets_)
+        flush_bucket(b);
+}
+
+void SpillStore::flush_bucket(Bucket& b)
+{
+    if (b.pending.empty())
+        return;
+    b.file.pwrite(std::as_bytes(std::span<const RingSample>(b.pending)), b.flushed * sizeof(RingSample));
+    b.flushed += b.pending.size();
+    b.pending.clear();
+}
+
+void SpillStore::for_each_chunk(std::size_t tile, std::span<RingSample> buffer,
+                                const std::function<void(std::span<const RingSample>)>& fn) const
+{
+    if (buffer.empty())
+        throw std::invalid_argument("SpillStore: empty chunk buffer");
+    const Bucket& b = buckets_.at(tile);
+    std::uint64_t next = 0;
+    while (next < b.flushed) {
+        const auto n = static_cast<std::size_t>(std::min<std::uint64_t>(buffer.size(), b.flushed - next));
+        b.file.pread_exact(std::as_writable_bytes(buffer.first(n)), next * sizeof(RingSample));
+        fn(buffer.first(n));
+        next += n;
+    }
+    if (!b.pending.empty())
+        fn(b.pending);
+}
+
+void SpillStore::load(std::size_t tile, std::span<RingSample> out) const
+{
+    const Bucket& b = buckets_.at(tile);
+    if (out.size() != b.count)
+        throw std::invalid_argument("SpillStore: load buffer does not match bucket size");
+    const auto flushed = static_cast<std::size_t>(b.flushed);
+    if (flushed > 0)
+        b.file.pread_exact(std::as_writable_bytes(out.first(flushed)), 0);
+    std::copy(b.pending.begin(), b.pending.end(), out.begin() + flushed);
+}
+
+std::size_t SpillStore::memory_bytes() const noexcept
+{
+    return buckets_.size() * buffer_samples_ * sizeof(RingSample);
+}
+
+void SpillStore::remove_files() noexcept
+{
+    for (std::size_t i = 0; i < buckets_.size(); ++i) {
+        buckets_[i].file = core::File();
+        std::error_code ec;
+        std::filesystem::remove(bucket_path(dir_, i), ec);
+    }
+}
+
+} // namespace solarlens::recon
@@ -0,0 +1,67 @@
+#include "solarlens/recon/tile_plan.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "solarlens/recon/ring_sample.hpp"
+
+namespace solarlens::recon {
+
+namespace {
+
+TileRect grow(const TileRect& r, std::uint32_t by, std::uint32_t limit)
+{
+    return {r.x0 > by ? r.x0 - by : 0, r.y0 > by ? r.y0 - by : 0,
+            std::min(limit, r.x1 + by), std::min(limit, r.y1 + by)};
+}
+
+} // namespace
+
+TilePlan::TilePlan(std::uint32_t map_size, std::uint32_t tile_size, std::uint32_t support)
+    : map_size_(map_size)
+    , tile_size_(tile_size)
+    , support_(support)
+{
+    if (map_size == 0 || tile_size == 0)
+        throw std::invalid_argument("TilePlan: map and tile size must be positive");
+    tile_size_ = std::min(tile_size, map_size);
+    per_side_ = (map_size_ + tile_size_ - 1) / tile_size_;
+    tiles_.reserve(std::size_t(per_side_) * per_side_);
+    for (std::uint32_t ty = 0; ty < per_side_; ++ty)
+        for (std::uint32_t tx = 0; tx < per_side_; ++tx) {
+            Tile t;
+            t.index = static_cast<std::uint32_t>(tiles_.size());
+            t.interior = {tx * tile_size_, ty * tile_size_,
+                          std::min(map_size_, (tx + 1) * tile_size_),
+                          std::min(map_size_, (ty + 1) * tile_size_)};
+            t.samples = grow(t.interior, support_, map_size_);
+            t.region = grow(t.interior, 2 * support_, map_size_);
+            tiles_.push_back(t);
+        }
+}
+
+std::size_t TilePlan::max_region_area() const noexcept
+{
+    std::size_t best = 0;
+    for (const Tile& t : tiles_)
+        best = std::max(best, t.region.area());
+    return best;
+}
+
+std::uint32_t tile_size_for_budget(std::uint32_t map_size, std::uint32_t support,
+                                   std::size_t budget_bytes, std::size_t fixed_bytes)
+{
+    std::uint32_t size = 16;
+    while (size < map_size)
+        size *= 2;
+    for (; size >= 16; size /= 2) {
+        const std::size_t side = std::min<std::size_t>(map_size, std::size_t(size) + 4 * support);
+        const std::size_t need = side * side * solver_bytes_per_pixel
+            + min_chunk_samples * sizeof(RingSample) + fixed_bytes;
+        if (need <= budget_bytes)
+            return std::min(size, map_size);
+    }
+    throw std::invalid_argument("memory budget too small for the smallest reconstruction tile");
+}
+
+} // namespace solarlens::recon
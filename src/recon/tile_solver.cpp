@@ -0,0 +1,281 @@
+#include "solarlens/recon/tile_solver.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <stdexcept>
+#include <type_traits>
+
+#include "solarlens/perf/instrument.hpp"
+
+namespace solarlens::recon {
+
+namespace {
+
+// Vector elements as the arithmetic type; std::uint16_t holds BF16 bits.
+double load(double v) noexcept { return v; }
+float load(float v) noexcept { return v; }
+float load(std::uint16_t bits) noexcept { return std::bit_cast<float>(std::uint32_t(bits) << 16); }
+
+void store(float& out, double v) noexcept { out = float(v); }
+
+// Round to nearest even; finite inputs only, which CG directions are.
+void store(std::uint16_t& out, double v) noexcept
+{
+    const auto bits = std::bit_cast<std::uint32_t>(float(v));
+    out = static_cast<std::uint16_t>((bits + 0x7fffu + ((bits >> 16) & 1u)) >> 16);
+}
+
+template <typename A, typename B>
+double dot(std::span<const A> a, std::span<const B> b)
+{
+    double s = 0.0;
+    for (std::size_t i = 0; i < a.size(); ++i)
+        s += double(load(a[i])) * double(load(b[i]));
+    return s;
+}
+
+double dot(const std::vector<double>& a, const std::vector<double>& b)
+{
+    return dot(std::span<const double>(a), std::span<const double>(b));
+}
+
+bool usable(const RingSample& s)
+{
+    return std::isfinite(s.flux) && std::isfinite(s.sigma) && s.sigma > 0.0f;
+}
+
+} // namespace
+
+TileSolver::TileSolver(const SampledKernel& kernel, const SolverOptions& options)
+    : kernel_(kernel)
+    , options_(options)
+{
+    if (options.max_iterations <= 0 || options.tolerance <= 0 || options.regularization < 0)
+        throw std::invalid_argument("TileSolver: invalid solver options");
+    if (options.precision != Precision::fp64
+        && (!(options.inner_tolerance > 0 && options.inner_tolerance < 1) || options.max_refinements <= 0))
+        throw std::invalid_argument("TileSolver: invalid mixed-precision options");
+    const auto side = static_cast<std::size_t>(2 * std::ceil(kernel.radius()) + 1);
+    stencil_index_.reserve(side * side);
+    stencil_weight_.reserve(side * side);
+}
+
+void TileSolver::build_stencil(const TileRect& region, const RingSample& s)
+{
+    stencil_index_.clear();
+    stencil_weight_.clear();
+    const double r = kernel_.radius();
+    const double r2 = kernel_.radius_squared();
+    const long x_lo = std::max<long>(region.x0, static_cast<long>(std::ceil(s.u - r)));
+    const long x_hi = std::min<long>(long(region.x1) - 1, static_cast<long>(std::floor(s.u + r)));
+    const long y_lo = std::max<long>(region.y0, static_cast<long>(std::ceil(s.v - r)));
+    const long y_hi = std::min<long>(long(region.y1) - 1, static_cast<long>(std::floor(s.v + r)));
+    const std::uint32_t w = region.width();
+    for (long y = y_lo; y <= y_hi; ++y) {
+        const double dy = double(y) - s.v;
+        const std::uint32_t row = static_cast<std::uint32_t>(y - region.y0) * w;
+        for (long x = x_lo; x <= x_hi; ++x) {
+            const double dx = double(x) - s.u;
+            const double d2 = dx * dx + dy * dy;
+            if (d2 >= r2)
+                continue;
+            stencil_index_.push_back(row + static_cast<std::uint32_t>(x - region.x0));
+            stencil_weight_.push_back(kernel_(std::sqrt(d2)));
+        }
+    }
+}
+
+template <typename P, typename Q>
+void TileSolver::apply(const TileRect& region, const SampleSource& samples, std::span<const P> p, std::span<Q> q)
+{
+    using T = decltype(load(Q {}));
+    const T lambda = T(options_.regularization);
+    for (std::size_t j = 0; j < q.size(); ++j)
+        q[j] = lambda * T(load(p[j]));
+    samples([&](std::span<const RingSample> chunk) {
+        for (const RingSample& s : chunk) {
+            if (!usable(s))
+                continue;
+            build_stencil(region, s);
+            const std::size_t n = stencil_index_.size();
+            T t = 0;
+            for (std::size_t k = 0; k < n; ++k)
+                t += T(stencil_weight_[k]) * T(load(p[stencil_index_[k]]));
+            t /= T(s.sigma) * T(s.sigma);
+            for (std::size_t k = 0; k < n; ++k)
+                q[stencil_index_[k]] += T(stencil_weight_[k]) * t;
+        }
+    });
+}
+
+SolveResult TileSolver::solve(const TileRect& region, const SampleSource& samples,
+                              std::span<double> x)
+{
+    const std::size_t area = region.area();
+    if (x.size() != area)
+        throw std::invalid_argument("TileSolver: iterate size does not match region");
+    static const perf::Stage stage("recon.tile_solve");
+    const perf::ScopedTimer timer(stage);
+    const bool mixed = options_.precision != Precision::fp64;
+    r_.assign(area, 0.0);
+
+    // b = A^T W y goes into r_, diag(A^T W A) + lambda into the diagonal of
+    // the precision the iterations run in.
+    SolveResult result;
+    const auto prepare = [&](auto& diag) {
+        diag.assign(area, options_.regularization);
+        samples([&](std::span<const RingSample> chunk) {
+            for (const RingSample& s : chunk) {
+                if (!usable(s))
+                    continue;
+                ++result.samples;
+                build_stencil(region, s);
+                const double w = 1.0 / (double(s.sigma) * double(s.sigma));
+                for (std::size_t k = 0; k < stencil_index_.size(); ++k) {
+                    const double a = stencil_weight_[k];
+                    r_[stencil_index_[k]] += a * w * s.flux;
+                    diag[stencil_index_[k]] += a * a * w;
+                }
+            }
+        });
+        for (auto& d : diag)
+            d = d > 0 ? d : 1;
+    };
+    if (mixed)
+        prepare(diag32_);
+    else
+        prepare(diag_);
+
+    const double b_norm = std::sqrt(dot(r_, r_));
+    if (b_norm == 0.0) {
+        std::fill(x.begin(), x.end(), 0.0);
+        return result;
+    }
+    if (options_.precision == Precision::fp64)
+        solve_fp64(region, samples, x, b_norm, result);
+    else if (options_.precision == Precision::fp32)
+        solve_mixed<float>(region, samples, x, b_norm, result);
+    else
+        solve_mixed<std::uint16_t>(region, samples, x, b_norm, result);
+    return result;
+}
+
+void TileSolver::solve_fp64(const TileRect& region, const SampleSource& samples, std::span<double> x,
+                            double b_norm, SolveResult& result)
+{
+    const std::size_t area = x.size();
+    p_.assign(area, 0.0);
+    q_.assign(area, 0.0);
+
+    // r = b - M x for the warm start.
+    apply(region, samples, std::span<const double>(x), std::span<double>(q_));
+    for (std::size_t j = 0; j < area; ++j) {
+        r_[j] -= q_[j];
+        p_[j] = r_[j] / diag_[j];
+    }
+    double rz = 0.0;
+    for (std::size_t j = 0; j < area; ++j)
+        rz += r_[j] * r_[j] / diag_[j];
+
+    result.relative_residual = std::sqrt(dot(r_, r_)) / b_norm;
+    while (result.iterations < options_.max_iterations
+           && result.relative_residual > options_.tolerance) {
+        apply(region, samples, std::span<const double>(p_), std::span<double>(q_));
+        const double pq = dot(p_, q_);
+        if (pq <= 0.0)
+            break;
+        const double alpha = rz / pq;
+        double rr = 0.0;
+        double rz_next = 0.0;
+        for (std::size_t j = 0; j < area; ++j) {
+            x[j] += alpha * p_[j];
+            r_[j] -= alpha * q_[j];
+            rr += r_[j] * r_[j];
+            rz_next += r_[j] * r_[j] / diag_[j];
+        }
+        ++result.iterations;
+        result.relative_residual = std::sqrt(rr) / b_norm;
+        const double beta = rz_next / rz;
+        rz = rz_next;
+        for (std::size_t j = 0; j < area; ++j)
+            p_[j] = r_[j] / diag_[j] + beta * p_[j];
+    }
+}
+
+template <typename P>
+void TileSolver::solve_mixed(const TileRect& region, const SampleSource& samples, std::span<double> x,
+                             double b_norm, SolveResult& result)
+{
+    const std::size_t area = x.size();
+    q_.assign(area, 0.0);
+    r32_.assign(area, 0.0f);
+    q32_.assign(area, 0.0f);
+    std::vector<P>& p = [this]() -> std::vector<P>& {
+        if constexpr (std::is_same_v<P, float>)
+            return p32_;
+        else
+            return p16_;
+    }();
+    p.assign(area, P {});
+
+    // CG with reliable updates: the low-precision residual is r32_ * scale,
+    // and whenever it has dropped by inner_tolerance it is replaced by the
+    // FP64 b - M x. The search direction carries over, so unlike restarted
+    // refinement each update keeps the Krylov space built so far.
+    double scale = 0.0;
+    double rz = 0.0;
+    double previous = HUGE_VAL;
+    for (;;) {
+        apply(region, samples, std::span<const double>(x), std::span<double>(q_));
+        for (std::size_t j = 0; j < area; ++j)
+            q_[j] = r_[j] - q_[j];
+        const double r_norm = std::sqrt(dot(q_, q_));
+        result.relative_residual = r_norm / b_norm;
+        ++result.refinements;
+        // An update that does not help means the low precision's floor.
+        if (result.relative_residual <= options_.tolerance || result.relative_residual >= previous
+            || result.refinements >= options_.max_refinements || result.iterations >= options_.max_iterations)
+            break;
+        previous = result.relative_residual;
+
+        // Rescale to the new residual; p keeps its direction and length.
+        const double rescale = scale / r_norm;
+        scale = r_norm;
+        rz = 0.0;
+        for (std::size_t j = 0; j < area; ++j) {
+            r32_[j] = float(q_[j] / r_norm);
+            const double z = double(r32_[j]) / diag32_[j];
+            rz += double(r32_[j]) * z;
+            store(p[j], result.refinements == 1 ? z : double(load(p[j])) * rescale);
+        }
+
+        double inner = 1.0;
+        const double target = std::max(options_.inner_tolerance, options_.tolerance * b_norm / r_norm);
+        while (result.iterations < options_.max_iterations && inner > target) {
+            apply(region, samples, std::span<const P>(p), std::span<float>(q32_));
+            const double pq = dot(std::span<const P>(p), std::span<const float>(q32_));
+            if (pq <= 0.0)
+                break;
+            const double alpha = rz / pq;
+            const auto alpha32 = float(alpha);
+            const double step = alpha * scale;
+            double rr = 0.0;
+            double rz_next = 0.0;
+            for (std::size_t j = 0; j < area; ++j) {
+                x[j] += step * double(load(p[j]));
+                r32_[j] -= alpha32 * q32_[j];
+                rr += double(r32_[j]) * r32_[j];
+                rz_next += double(r32_[j]) * r32_[j] / diag32_[j];
+            }
+            ++result.iterations;
+            inner = std::sqrt(rr);
+            const double beta = rz_next / rz;
+            rz = rz_next;
+            for (std::size_t j = 0; j < area; ++j)
+                store(p[j], double(r32_[j]) / diag32_[j] + beta * double(load(p[j])));
+        }
+    }
+}
+
+} // namespace solarlens::recon
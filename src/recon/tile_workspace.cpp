@@ -0,0 +1,83 @@
+#include "tile_workspace.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+#include "solarlens/sched/scheduler.hpp"
+
+namespace solarlens::recon::detail {
+
+std::uint32_t support_for(const SampledKernel& kernel)
+{
+    return static_cast<std::uint32_t>(std::ceil(kernel.radius()));
+}
+
+std::size_t fixed_bytes(const SampledKernel& kernel)
+{
+    const auto side = static_cast<std::size_t>(2 * std::ceil(kernel.radius()) + 1);
+    return kernel.memory_bytes() + side * side * (sizeof(double) + sizeof(std::uint32_t));
+}
+
+TilePlan make_plan(std::uint32_t map_size, std::uint32_t tile_size, std::size_t budget,
+                   const SampledKernel& kernel)
+{
+    const std::uint32_t support = support_for(kernel);
+    const std::uint32_t tile = tile_size != 0
+        ? tile_size
+        : tile_size_for_budget(map_size, support, budget, fixed_bytes(kernel));
+    return TilePlan(map_size, tile, support);
+}
+
+std::size_t solve_slots(std::size_t budget, std::size_t slot_need, sched::Scheduler* scheduler,
+                        std::size_t max_parallel, std::size_t tiles)
+{
+    if (scheduler == nullptr)
+        return 1;
+    std::size_t slots = scheduler->worker_count();
+    if (max_parallel != 0)
+        slots = std::min(slots, max_parallel);
+    return std::clamp<std::size_t>(std::min(slots, budget / slot_need), 1, std::max<std::size_t>(tiles, 1));
+}
+
+TileWorkspace::TileWorkspace(const SampledKernel& kernel, const SolverOptions& options)
+    : solver(kernel, options)
+{
+}
+
+TileReport TileWorkspace::solve(const Tile& tile, const SpillStore& store,
+                                std::size_t chunk_samples, MapFileWriter& map, bool warm_start)
+{
+    TileReport tr;
+    tr.tile = tile.index;
+    const std::uint64_t count = store.count(tile.index);
+    tr.in_memory = count <= chunk_samples;
+
+    SampleSource source;
+    if (tr.in_memory) {
+        chunk.resize(static_cast<std::size_t>(count));
+        store.load(tile.index, chunk);
+        source = [this](const SampleVisitor& visit) { visit(chunk); };
+    } else {
+        chunk.resize(chunk_samples);
+        source = [&](const SampleVisitor& visit) { store.for_each_chunk(tile.index, chunk, visit); };
+    }
+
+    if (!warm_start)
+        x.assign(tile.region.area(), 0.0);
+    else if (x.size() != tile.region.area())
+        throw std::invalid_argument("TileWorkspace: warm start does not match the tile region");
+    tr.solve = solver.solve(tile.region, source, x);
+
+    const TileRect& in = tile.interior;
+    const TileRect& re = tile.region;
+    interior.resize(in.area());
+    for (std::uint32_t y = in.y0; y < in.y1; ++y)
+        for (std::uint32_t xx = in.x0; xx < in.x1; ++xx)
+            interior[std::size_t(y - in.y0) * in.width() + (xx - in.x0)] = static_cast<float>(
+                x[std::size_t(y - re.y0) * re.width() + (xx - re.x0)]);
+    map.write_block(in.x0, in.y0, in.width(), in.height(), interior);
+    return tr;
+}
+
+} // namespace solarlens::recon::detail
@@ -0,0 +1,62 @@
+#pragma once
+
+// Pieces shared by DeconvolutionEngine and IncrementalReconstructor: tile
+// planning against a memory budget and the per-slot solve workspace.
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "solarlens/recon/deconvolution.hpp"
+#include "solarlens/recon/map_file.hpp"
+#include "solarlens/recon/psf_kernel.hpp"
+#include "solarlens/recon/ring_sample.hpp"
+#include "solarlens/recon/spill_store.hpp"
+#include "solarlens/recon/tile_plan.hpp"
+#include "solarlens/recon/tile_solver.hpp"
+
+namespace solarlens::sched {
+class Scheduler;
+}
+
+namespace solarlens::recon::detail {
+
+/// Bucket write buffers are sized between these, in samples.
+inline constexpr std::size_t min_spill_buffer = 256;
+inline constexpr std::size_t max_spill_buffer = 64 * 1024;
+
+/// Kernel support in whole pixels.
+std::uint32_t support_for(const SampledKernel& kernel);
+
+/// Per-solve bytes that do not scale with the region: kernel table and
+/// stencil scratch.
+std::size_t fixed_bytes(const SampledKernel& kernel);
+
+/// Plan for `map_size` with `tile_size`, or the largest tile that fits
+/// `budget` when `tile_size` is 0.
+TilePlan make_plan(std::uint32_t map_size, std::uint32_t tile_size, std::size_t budget,
+                   const SampledKernel& kernel);
+
+/// Tiles to solve concurrently: one per worker (capped by `max_parallel`
+/// when non-zero), as many as `budget` holds at `slot_need` bytes each,
+/// at least one and no more than `tiles`.
+std::size_t solve_slots(std::size_t budget, std::size_t slot_need, sched::Scheduler* scheduler,
+                        std::size_t max_parallel, std::size_t tiles);
+
+/// One solve slot's private state.
+struct TileWorkspace {
+    TileWorkspace(const SampledKernel& kernel, const SolverOptions& options);
+
+    /// Solves `tile` from its bucket and writes the interior to `map`.
+    /// With `warm_start` the caller has left the starting guess in `x`
+    /// (region area values); otherwise the solve starts from zero.
+    TileReport solve(const Tile& tile, const SpillStore& store, std::size_t chunk_samples,
+                     MapFileWriter& map, bool warm_start = false);
+
+    TileSolver solver;
+    std::vector<RingSample> chunk;
+    std::vector<double> x;
+    std::vector<float> interior;
+};
+
+} // namespace solarlens::recon::detail
@@ -0,0 +1,132 @@
+#include "solarlens/retrieval/forward_model.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+#include "transmission_kernels.hpp"
+
+namespace solarlens::retrieval {
+
+namespace {
+
+detail::TransmissionFn kernel_for(core::SimdLevel level)
+{
+    switch (level) {
+#if defined(SOLARLENS_HAVE_AVX512)
+    case core::SimdLevel::avx512:
+        return detail::transmission_avx512;
+#endif
+#if defined(SOLARLENS_HAVE_AVX2)
+    case core::SimdLevel::avx2:
+        return detail::transmission_avx2;
+#endif
+#if defined(SOLARLENS_HAVE_NEON)
+    case core::SimdLevel::neon:
+        return detail::transmission_neon;
+#endif
+    default:
+        return detail::transmission_scalar;
+    }
+}
+
+} // namespace
+
+const char* to_string(Param param) noexcept
+{
+    switch (param) {
+    case Param::log10_o2:
+        return "log10_o2";
+    case Param::log10_o3:
+        return "log10_o3";
+    case Param::log10_ch4:
+        return "log10_ch4";
+    case Param::log10_h2o:
+        return "log10_h2o";
+    case Param::log10_pressure:
+        return "log10_pressure";
+    case Param::temperature:
+        return "temperature";
+    case Param::surface_albedo:
+        return "surface_albedo";
+    case Param::cloud_fraction:
+        return "cloud_fraction";
+    }
+    return "?";
+}
+
+ForwardModel::ForwardModel(const OpacityTable& opacity, const ForwardConfig& config)
+    : opacity_(&opacity)
+    , config_(config)
+{
+    if (!(config.airmass > 0) || !(config.cloud_top > 0 && config.cloud_top <= 1))
+        throw std::invalid_argument("ForwardModel: airmass must be positive and cloud_top in (0, 1]");
+    if (!core::simd_level_supported(config.simd))
+        throw std::invalid_argument(std::string("ForwardModel: SIMD level ")
+                                    + core::to_string(config.simd) + " not available");
+    // Rayleigh optical depth of 1 bar of air, ~0.0088 lambda^-4.05 (um).
+    rayleigh_.assign(opacity.stride(), 0.0f);
+    for (std::size_t b = 0; b < opacity.bands(); ++b)
+        rayleigh_[b] = static_cast<float>(0.0088 * std::pow(opacity.wavelengths_um()[b], -4.05));
+}
+
+void ForwardModel::evaluate(std::span<const Theta> batch, std::span<float> out) const
+{
+    const std::size_t nb = bands();
+    if (out.size() < batch.size() * nb)
+        throw std::invalid_argument("ForwardModel: output span too small");
+    const auto kernel = kernel_for(config_.simd);
+    const auto& table = *opacity_;
+    const std::size_t stride = table.stride();
+    std::vector<float> clear(stride);
+    std::vector<float> cloud(stride);
+    std::vector<float> rayleigh(stride);
+
+    detail::TransmissionArgs args;
+    args.terms = detail::max_terms;
+    args.g_count = table.grid().g_points;
+    args.stride = stride;
+    args.g_weights = table.g_weights().data();
+    args.cloud_scale = static_cast<float>(config_.cloud_top);
+    args.grey_depth = rayleigh_.data();
+    args.clear = clear.data();
+    args.cloud = cloud.data();
+    args.grey_transmission = rayleigh.data();
+
+    const double m = config_.airmass;
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        const Theta& th = batch[i];
+        const double pressure = std::pow(10.0, th[std::size_t(Param::log10_pressure)]);
+        const GridCell c = table.locate(pressure, th[std::size_t(Param::temperature)]);
+        const float corner[4] = {(1 - c.fp) * (1 - c.ft), (1 - c.fp) * c.ft, c.fp * (1 - c.ft), c.fp * c.ft};
+        for (std::size_t s = 0; s < species_count; ++s) {
+            const auto sp = static_cast<Species>(s);
+            const double column = m * pressure * std::pow(10.0, th[s]);
+            const std::uint32_t ip[4] = {c.ip, c.ip, c.ip + 1, c.ip + 1};
+            const std::uint32_t it[4] = {c.it, c.it + 1, c.it, c.it + 1};
+            for (std::size_t k = 0; k < 4; ++k) {
+                args.slab[s * 4 + k] = table.row(sp, ip[k], it[k]);
+                args.coeff[s * 4 + k] = static_cast<float>(column * corner[k]);
+            }
+        }
+        args.grey_coeff = static_cast<float>(m * pressure);
+        kernel(args);
+
+        const float fc = static_cast<float>(std::clamp(th[std::size_t(Param::cloud_fraction)], 0.0, 1.0));
+        const float ground = (1 - fc) * static_cast<float>(std::clamp(th[std::size_t(Param::surface_albedo)], 0.0, 1.0));
+        const float deck = fc * static_cast<float>(config_.cloud_albedo);
+        float* spectrum = out.data() + i * nb;
+        for (std::size_t b = 0; b < nb; ++b)
+            spectrum[b] = ground * clear[b] + deck * cloud[b] + 0.5f * (1.0f - rayleigh[b]);
+    }
+}
+
+std::vector<float> ForwardModel::evaluate(const Theta& theta) const
+{
+    std::vector<float> out(bands());
+    evaluate(std::span<const Theta>(&theta, 1), out);
+    return out;
+}
+
+} // namespace solarlens::retrieval
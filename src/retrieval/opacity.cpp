@@ -0,0 +1,179 @@
+#include "solarlens/retrieval/opacity.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <stdexcept>
+
+namespace solarlens::retrieval {
+
+namespace {
+
+struct AbsorptionBand {
+    Species species;
+    double centre_um;
+    double width_um;        ///< Gaussian sigma.
+    double strength;        ///< Band-centre k at 250 K, 1 bar.
+    double t_exponent;      ///< k scales as (T / 250 K)^t_exponent.
+    double contrast;        ///< Spread of ln k across g at low pressure.
+};
+
+// Strengths are set so an Earth-like column (1 bar; O2 0.21, O3 0.3 ppm,
+// CH4 1.8 ppm, H2O 3000 ppm) gives the familiar band depths at airmass 2.
+constexpr AbsorptionBand absorption_bands[] = {
+    {Species::o2, 0.688, 0.004, 2.0, -0.5, 3.0},
+    {Species::o2, 0.762, 0.005, 18.0, -0.5, 3.5},
+    {Species::o2, 1.269, 0.008, 0.6, -0.5, 2.5},
+    {Species::o3, 0.600, 0.060, 3.0e5, 0.0, 0.3},
+    {Species::o3, 0.450, 0.030, 4.0e4, 0.0, 0.3},
+    {Species::ch4, 0.890, 0.010, 3.0e2, 0.3, 2.0},
+    {Species::ch4, 1.160, 0.020, 2.0e3, 0.3, 2.5},
+    {Species::ch4, 1.380, 0.025, 4.0e3, 0.3, 2.5},
+    {Species::ch4, 1.670, 0.030, 3.0e4, 0.3, 3.0},
+    {Species::ch4, 2.320, 0.040, 5.0e4, 0.3, 3.0},
+    {Species::h2o, 0.720, 0.008, 10.0, 0.8, 3.0},
+    {Species::h2o, 0.820, 0.010, 20.0, 0.8, 3.0},
+    {Species::h2o, 0.940, 0.020, 2.0e2, 0.8, 3.5},
+    {Species::h2o, 1.130, 0.025, 3.0e2, 0.8, 3.5},
+    {Species::h2o, 1.380, 0.040, 3.0e3, 0.8, 4.0},
+    {Species::h2o, 1.870, 0.050, 3.0e3, 0.8, 4.0},
+};
+
+/// Gauss-Legendre nodes and weights on [0, 1].
+void gauss_legendre(std::uint32_t n, std::vector<float>& nodes, std::vector<float>& weights)
+{
+    nodes.resize(n);
+    weights.resize(n);
+    for (std::uint32_t i = 0; i < n; ++i) {
+        double x = std::cos(std::numbers::pi * (i + 0.75) / (n + 0.5));
+        double dp = 0.0;
+        for (int iter = 0; iter < 100; ++iter) {
+            double p0 = 1.0;
+            double p1 = x;
+            for (std::uint32_t k = 2; k <= n; ++k) {
+                const double p2 = ((2.0 * k - 1.0) * x * p1 - (k - 1.0) * p0) / k;
+                p0 = p1;
+                p1 = p2;
+            }
+            const double pn = n == 1 ? x : p1;
+            const double pm = n == 1 ? 1.0 : p0;
+            dp = n * (x * pn - pm) / (x * x - 1.0);
+            const double dx = pn / dp;
+            x -= dx;
+            if (std::abs(dx) < 1e-15)
+                break;
+        }
+        // Ascending g on [0, 1].
+        nodes[n - 1 - i] = static_cast<float>(0.5 * (1.0 + x));
+        weights[n - 1 - i] = static_cast<float>(1.0 / ((1.0 - x * x) * dp * dp));
+    }
+}
+
+} // namespace
+
+const char* to_string(Species species) noexcept
+{
+    switch (species) {
+    case Species::o2:
+        return "O2";
+    case Species::o3:
+        return "O3";
+    case Species::ch4:
+        return "CH4";
+    case Species::h2o:
+        return "H2O";
+    }
+    return "?";
+}
+
+void OpacityGrid::validate() const
+{
+    if (pressures < 2 || temperatures < 2 || g_points < 1)
+        throw std::invalid_argument("opacity: grid needs >= 2 pressures and temperatures and >= 1 g point");
+    if (!(log10_p_max > log10_p_min) || !(t_max > t_min) || !(t_min > 0))
+        throw std::invalid_argument("opacity: grid axes must be increasing and temperatures positive");
+}
+
+OpacityTable::OpacityTable(std::vector<double> wavelengths_um, const OpacityGrid& grid)
+    : grid_(grid)
+    , wavelengths_(std::move(wavelengths_um))
+{
+    grid.validate();
+    if (wavelengths_.empty())
+        throw std::invalid_argument("opacity: no bands");
+    stride_ = (wavelengths_.size() + band_alignment - 1) / band_alignment * band_alignment;
+    gauss_legendre(grid.g_points, g_nodes_, g_weights_);
+    data_.assign(species_count * grid.pressures * grid.temperatures * grid.g_points * stride_, 0.0f);
+}
+
+GridCell OpacityTable::locate(double pressure_bar, double temperature_k) const noexcept
+{
+    const auto axis = [](double v, double lo, double hi, std::uint32_t n, std::uint32_t& i, float& f) {
+        const double t = (v - lo) / (hi - lo) * (n - 1);
+        if (!(t > 0)) {
+            i = 0;
+            f = 0.0f;
+        } else if (t >= n - 1) {
+            i = n - 2;
+            f = 1.0f;
+        } else {
+            i = static_cast<std::uint32_t>(t);
+            f = static_cast<float>(t - i);
+        }
+    };
+    GridCell c;
+    axis(std::log10(pressure_bar), grid_.log10_p_min, grid_.log10_p_max, grid_.pressures, c.ip, c.fp);
+    axis(temperature_k, grid_.t_min, grid_.t_max, grid_.temperatures, c.it, c.ft);
+    return c;
+}
+
+OpacityTable band_model_opacity(std::vector<double> wavelengths_um, const OpacityGrid& grid)
+{
+    OpacityTable table(std::move(wavelengths_um), grid);
+    const auto nodes = table.g_nodes();
+    const auto weights = table.g_weights();
+    const auto lambda = table.wavelengths_um();
+    for (std::size_t s = 0; s < species_count; ++s)
+        for (std::uint32_t ip = 0; ip < grid.pressures; ++ip) {
+            const double p = std::pow(10.0, grid.log10_p_min
+                                                + (grid.log10_p_max - grid.log10_p_min) * ip / (grid.pressures - 1));
+            // Pressure broadening fills in line cores, flattening k(g).
+            const double flatten = 1.0 / (1.0 + std::sqrt(p / 0.1));
+            for (std::uint32_t it = 0; it < grid.temperatures; ++it) {
+                const double t = grid.t_min + (grid.t_max - grid.t_min) * it / (grid.temperatures - 1);
+                float* row = table.row(static_cast<Species>(s), ip, it);
+                for (const auto& band : absorption_bands) {
+                    if (std::size_t(band.species) != s)
+                        continue;
+                    const double k0 = band.strength * std::pow(t / 250.0, band.t_exponent) * (1.0 + 0.05 * p);
+                    const double spread = band.contrast * flatten;
+                    double norm = 0.0;
+                    for (std::size_t g = 0; g < nodes.size(); ++g)
+                        norm += weights[g] * std::exp(spread * (2.0 * nodes[g] - 1.0));
+                    for (std::size_t b = 0; b < lambda.size(); ++b) {
+                        const double d = (lambda[b] - band.centre_um) / band.width_um;
+                        if (std::abs(d) > 6.0)
+                            continue;
+                        const double k = k0 * std::exp(-0.5 * d * d) / norm;
+                        for (std::size_t g = 0; g < nodes.size(); ++g)
+                            row[g * table.stride() + b] +=
+                                static_cast<float>(k * std::exp(spread * (2.0 * nodes[g] - 1.0)));
+                    }
+                }
+            }
+        }
+    return table;
+}
+
+std::vector<double> log_spaced_bands(double min_um, double max_um, std::size_t count)
+{
+    if (!(min_um > 0) || !(max_um > min_um) || count < 2)
+        throw std::invalid_argument("opacity: band range must be positive and increasing, count >= 2");
+    std::vector<double> out(count);
+    const double step = std::log(max_um / min_um) / (count - 1);
+    for (std::size_t i = 0; i < count; ++i)
+        out[i] = min_um * std::exp(step * i);
+    return out;
+}
+
+} // namespace solarlens::retrieval
@@ -0,0 +1,200 @@
+#include "solarlens/retrieval/sampler.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+#include <string>
+
+#include "solarlens/sched/scheduler.hpp"
+
+namespace solarlens::retrieval {
+
+namespace {
+
+std::uint64_t splitmix64(std::uint64_t x) noexcept
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+double chi2(std::span<const float> model, const Observation& obs) noexcept
+{
+    double sum = 0.0;
+    for (std::size_t b = 0; b < model.size(); ++b) {
+        const double r = (double(model[b]) - obs.reflectance[b]) / obs.sigma[b];
+        sum += r * r;
+    }
+    return sum;
+}
+
+ParameterSummary summarise(std::vector<double>& values)
+{
+    ParameterSummary s;
+    if (values.empty())
+        return s;
+    double sum = 0.0;
+    double sum2 = 0.0;
+    for (double v : values) {
+        sum += v;
+        sum2 += v * v;
+    }
+    const double n = double(values.size());
+    s.mean = sum / n;
+    s.sigma = std::sqrt(std::max(0.0, sum2 / n - s.mean * s.mean));
+    const auto quantile = [&](double q) {
+        const auto k = std::min(values.size() - 1, std::size_t(q * n));
+        std::nth_element(values.begin(), values.begin() + k, values.end());
+        return values[k];
+    };
+    s.p16 = quantile(0.16);
+    s.p50 = quantile(0.50);
+    s.p84 = quantile(0.84);
+    return s;
+}
+
+} // namespace
+
+bool Prior::contains(const Theta& theta) const noexcept
+{
+    for (std::size_t i = 0; i < parameter_count; ++i)
+        if (!(theta[i] >= lower[i] && theta[i] <= upper[i]))
+            return false;
+    return true;
+}
+
+void Prior::validate() const
+{
+    for (std::size_t i = 0; i < parameter_count; ++i)
+        if (!(lower[i] < upper[i]))
+            throw std::invalid_argument(std::string("retrieval: empty prior range for ")
+                                        + to_string(static_cast<Param>(i)));
+}
+
+void SamplerConfig::validate() const
+{
+    if (walkers < 2 * parameter_count || walkers % 2 != 0)
+        throw std::invalid_argument("retrieval: walkers must be even and at least twice the parameter count");
+    if (burn_in >= steps)
+        throw std::invalid_argument("retrieval: burn-in must be shorter than the run");
+    if (!(stretch > 1.0))
+        throw std::invalid_argument("retrieval: stretch scale must exceed 1");
+}
+
+EnsembleSampler::EnsembleSampler(const ForwardModel& model, const Prior& prior, const SamplerConfig& config)
+    : model_(&model)
+    , prior_(prior)
+    , config_(config)
+{
+    prior.validate();
+    config.validate();
+}
+
+RetrievalResult EnsembleSampler::run(const Observation& obs, std::uint64_t stream) const
+{
+    const std::size_t nb = model_->bands();
+    if (obs.reflectance.size() != nb || obs.sigma.size() != nb)
+        throw std::invalid_argument("retrieval: observation does not match the model's bands");
+
+    std::mt19937_64 rng(splitmix64(splitmix64(config_.seed) ^ stream));
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+    const std::size_t n = config_.walkers;
+    const std::size_t half = n / 2;
+    const double a = config_.stretch;
+
+    RetrievalResult result;
+    std::vector<Theta> walkers(n);
+    std::vector<double> log_l(n);
+    std::vector<float> spectra(n * nb);
+    const auto record_best = [&](const Theta& th, double c2) {
+        if (result.evaluations == 0 || c2 < result.best_chi2) {
+            result.best_chi2 = c2;
+            result.best = th;
+        }
+    };
+
+    for (auto& w : walkers)
+        for (std::size_t i = 0; i < parameter_count; ++i)
+            w[i] = prior_.lower[i] + (prior_.upper[i] - prior_.lower[i]) * unit(rng);
+    model_->evaluate(walkers, spectra);
+    for (std::size_t k = 0; k < n; ++k) {
+        const double c2 = chi2(std::span<const float>(spectra).subspan(k * nb, nb), obs);
+        log_l[k] = -0.5 * c2;
+        record_best(walkers[k], c2);
+        ++result.evaluations;
+    }
+
+    std::array<std::vector<double>, parameter_count> kept;
+    for (auto& v : kept)
+        v.reserve((config_.steps - config_.burn_in) * n);
+    std::vector<Theta> proposals(half);
+    std::vector<double> log_z(half);
+    std::vector<std::size_t> slot(half);
+    std::vector<Theta> batch;
+    batch.reserve(half);
+    std::uint64_t accepted = 0;
+    std::uint64_t proposed = 0;
+
+    for (std::size_t step = 0; step < config_.steps; ++step) {
+        for (std::size_t side = 0; side < 2; ++side) {
+            const std::size_t self = side * half;
+            const std::size_t other = (1 - side) * half;
+            batch.clear();
+            for (std::size_t k = 0; k < half; ++k) {
+                const double z = std::pow((a - 1.0) * unit(rng) + 1.0, 2.0) / a;
+                const Theta& xk = walkers[self + k];
+                const Theta& xj = walkers[other + std::size_t(unit(rng) * half) % half];
+                for (std::size_t i = 0; i < parameter_count; ++i)
+                    proposals[k][i] = xj[i] + z * (xk[i] - xj[i]);
+                log_z[k] = (parameter_count - 1.0) * std::log(z);
+                slot[k] = prior_.contains(proposals[k]) ? batch.size() : half;
+                if (slot[k] != half)
+                    batch.push_back(proposals[k]);
+            }
+            model_->evaluate(batch, spectra);
+            for (std::size_t k = 0; k < half; ++k) {
+                ++proposed;
+                if (slot[k] == half)
+                    continue;
+                const double c2 = chi2(std::span<const float>(spectra).subspan(slot[k] * nb, nb), obs);
+                record_best(proposals[k], c2);
+                ++result.evaluations;
+                const double log_q = log_z[k] - 0.5 * c2 - log_l[self + k];
+                if (std::log(unit(rng)) < log_q) {
+                    walkers[self + k] = proposals[k];
+                    log_l[self + k] = -0.5 * c2;
+                    ++accepted;
+                }
+            }
+        }
+        if (step < config_.burn_in)
+            continue;
+        for (const auto& w : walkers) {
+            for (std::size_t i = 0; i < parameter_count; ++i)
+                kept[i].push_back(w[i]);
+            if (config_.keep_samples)
+                result.samples.push_back(w);
+        }
+    }
+
+    for (std::size_t i = 0; i < parameter_count; ++i)
+        result.posterior[i] = summarise(kept[i]);
+    result.acceptance = proposed ? double(accepted) / double(proposed) : 0.0;
+    return result;
+}
+
+std::vector<RetrievalResult> retrieve_pixels(const EnsembleSampler& sampler,
+                                             std::span<const Observation> pixels,
+                                             sched::Scheduler& scheduler)
+{
+    std::vector<RetrievalResult> out(pixels.size());
+    sched::parallel_for(scheduler, 0, pixels.size(), 1, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t i = lo; i < hi; ++i)
+            out[i] = sampler.run(pixels[i], i);
+    });
+    return out;
+}
+
+} // namespace solarlens::retrieval
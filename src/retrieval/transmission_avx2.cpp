@@ -0,0 +1,59 @@
+// AVX2 + FMA kernel: eight bands per step.
+
+#include <immintrin.h>
+
+#include "transmission_kernels.hpp"
+
+namespace solarlens::retrieval::detail {
+
+namespace {
+
+// exp(x) for x <= 0 (Cephes expf polynomial, ~2 ulp); flushes to zero
+// below -87.
+__m256 exp_neg(__m256 x)
+{
+    const __m256 lo = _mm256_set1_ps(-87.0f);
+    const __m256 underflow = _mm256_cmp_ps(x, lo, _CMP_LT_OQ);
+    x = _mm256_max_ps(x, lo);
+    const __m256 n = _mm256_round_ps(_mm256_mul_ps(x, _mm256_set1_ps(1.44269504088896341f)),
+                                     _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m256 r = _mm256_fnmadd_ps(n, _mm256_set1_ps(0.693359375f), x);
+    r = _mm256_fnmadd_ps(n, _mm256_set1_ps(-2.12194440e-4f), r);
+    __m256 p = _mm256_set1_ps(1.9875691500e-4f);
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.3981999507e-3f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(8.3334519073e-3f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(4.1665795894e-2f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(1.6666665459e-1f));
+    p = _mm256_fmadd_ps(p, r, _mm256_set1_ps(5.0000001201e-1f));
+    const __m256 y = _mm256_add_ps(_mm256_fmadd_ps(_mm256_mul_ps(p, r), r, r), _mm256_set1_ps(1.0f));
+    const __m256i e = _mm256_slli_epi32(_mm256_add_epi32(_mm256_cvtps_epi32(n), _mm256_set1_epi32(127)), 23);
+    return _mm256_andnot_ps(underflow, _mm256_mul_ps(y, _mm256_castsi256_ps(e)));
+}
+
+} // namespace
+
+void transmission_avx2(const TransmissionArgs& a)
+{
+    constexpr std::size_t lanes = 8;
+    const __m256 cloud_scale = _mm256_set1_ps(-a.cloud_scale);
+    const __m256 grey_coeff = _mm256_set1_ps(a.grey_coeff);
+    for (std::size_t b = 0; b < a.stride; b += lanes) {
+        const __m256 grey_tau = _mm256_mul_ps(grey_coeff, _mm256_loadu_ps(a.grey_depth + b));
+        __m256 clear = _mm256_setzero_ps();
+        __m256 cloud = _mm256_setzero_ps();
+        for (std::size_t g = 0; g < a.g_count; ++g) {
+            const std::size_t at = g * a.stride + b;
+            __m256 tau = grey_tau;
+            for (std::size_t t = 0; t < a.terms; ++t)
+                tau = _mm256_fmadd_ps(_mm256_set1_ps(a.coeff[t]), _mm256_loadu_ps(a.slab[t] + at), tau);
+            const __m256 w = _mm256_set1_ps(a.g_weights[g]);
+            clear = _mm256_fmadd_ps(w, exp_neg(_mm256_sub_ps(_mm256_setzero_ps(), tau)), clear);
+            cloud = _mm256_fmadd_ps(w, exp_neg(_mm256_mul_ps(cloud_scale, tau)), cloud);
+        }
+        _mm256_storeu_ps(a.clear + b, clear);
+        _mm256_storeu_ps(a.cloud + b, cloud);
+        _mm256_storeu_ps(a.grey_transmission + b, exp_neg(_mm256_sub_ps(_mm256_setzero_ps(), grey_tau)));
+    }
+}
+
+} // namespace solarlens::retrieval::detail
@@ -0,0 +1,64 @@
+// AVX-512F kernel: sixteen bands per step.
+
+#include <immintrin.h>
+
+#include "transmission_kernels.hpp"
+
+namespace solarlens::retrieval::detail {
+
+namespace {
+
+// GCC 12 reports the undefined pass-through register of these masked
+// builtins as maybe-uninitialized; the zero-masked forms with every lane
+// set are the same instructions.
+constexpr __mmask16 all = 0xFFFF;
+
+// exp(x) for x <= 0, as in the AVX2 kernel.
+__m512 exp_neg(__m512 x)
+{
+    const __m512 lo = _mm512_set1_ps(-87.0f);
+    const __mmask16 keep = _mm512_cmp_ps_mask(x, lo, _CMP_GE_OQ);
+    x = _mm512_maskz_max_ps(all, x, lo);
+    const __m512 n = _mm512_maskz_roundscale_ps(all, _mm512_mul_ps(x, _mm512_set1_ps(1.44269504088896341f)),
+                                                _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+    __m512 r = _mm512_fnmadd_ps(n, _mm512_set1_ps(0.693359375f), x);
+    r = _mm512_fnmadd_ps(n, _mm512_set1_ps(-2.12194440e-4f), r);
+    __m512 p = _mm512_set1_ps(1.9875691500e-4f);
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(1.3981999507e-3f));
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(8.3334519073e-3f));
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(4.1665795894e-2f));
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(1.6666665459e-1f));
+    p = _mm512_fmadd_ps(p, r, _mm512_set1_ps(5.0000001201e-1f));
+    const __m512 y = _mm512_add_ps(_mm512_fmadd_ps(_mm512_mul_ps(p, r), r, r), _mm512_set1_ps(1.0f));
+    const __m512i biased = _mm512_add_epi32(_mm512_maskz_cvtps_epi32(all, n), _mm512_set1_epi32(127));
+    const __m512i e = _mm512_maskz_slli_epi32(all, biased, 23);
+    return _mm512_maskz_mul_ps(keep, y, _mm512_castsi512_ps(e));
+}
+
+} // namespace
+
+void transmission_avx512(const TransmissionArgs& a)
+{
+    constexpr std::size_t lanes = 16;
+    const __m512 cloud_scale = _mm512_set1_ps(-a.cloud_scale);
+    const __m512 grey_coeff = _mm512_set1_ps(a.grey_coeff);
+    for (std::size_t b = 0; b < a.stride; b += lanes) {
+        const __m512 grey_tau = _mm512_mul_ps(grey_coeff, _mm512_loadu_ps(a.grey_depth + b));
+        __m512 clear = _mm512_setzero_ps();
+        __m512 cloud = _mm512_setzero_ps();
+        for (std::size_t g = 0; g < a.g_count; ++g) {
+            const std::size_t at = g * a.stride + b;
+            __m512 tau = grey_tau;
+            for (std::size_t t = 0; t < a.terms; ++t)
+                tau = _mm512_fmadd_ps(_mm512_set1_ps(a.coeff[t]), _mm512_loadu_ps(a.slab[t] + at), tau);
+            const __m512 w = _mm512_set1_ps(a.g_weights[g]);
+            clear = _mm512_fmadd_ps(w, exp_neg(_mm512_sub_ps(_mm512_setzero_ps(), tau)), clear);
+            cloud = _mm512_fmadd_ps(w, exp_neg(_mm512_mul_ps(cloud_scale, tau)), cloud);
+        }
+        _mm512_storeu_ps(a.clear + b, clear);
+        _mm512_storeu_ps(a.cloud + b, cloud);
+        _mm512_storeu_ps(a.grey_transmission + b, exp_neg(_mm512_sub_ps(_mm512_setzero_ps(), grey_tau)));
+    }
+}
+
+} // namespace solarlens::retrieval::detail
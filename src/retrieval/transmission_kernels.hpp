@@ -0,0 +1,51 @@
+#pragma once
+
+// Per-ISA band transmission kernels behind ForwardModel, built per
+// translation unit like the corona and gravity kernels.
+
+#include <cstddef>
+
+#include "solarlens/retrieval/opacity.hpp"
+
+namespace solarlens::retrieval::detail {
+
+// Each species contributes its four bilinear grid corners.
+inline constexpr std::size_t max_terms = species_count * 4;
+
+// For every band b of `stride` (a multiple of 16), with a grey
+// (g-independent) optical depth d_b = grey_coeff * grey_depth[b] such as
+// Rayleigh:
+//   tau_g                = d_b + sum_t coeff[t] * slab[t][g * stride + b]
+//   clear[b]             = sum_g w_g exp(-tau_g)
+//   cloud[b]             = sum_g w_g exp(-cloud_scale * tau_g)
+//   grey_transmission[b] = exp(-d_b)
+struct TransmissionArgs {
+    std::size_t terms = 0;
+    const float* slab[max_terms] {};
+    float coeff[max_terms] {};
+    std::size_t g_count = 0;
+    std::size_t stride = 0;
+    const float* g_weights = nullptr;
+    float cloud_scale = 0.5f;
+    const float* grey_depth = nullptr;
+    float grey_coeff = 0.0f;
+    float* clear = nullptr;
+    float* cloud = nullptr;
+    float* grey_transmission = nullptr;
+};
+
+using TransmissionFn = void (*)(const TransmissionArgs& args);
+
+void transmission_scalar(const TransmissionArgs&);
+
+#if defined(SOLARLENS_HAVE_AVX2)
+void transmission_avx2(const TransmissionArgs&);
+#endif
+#if defined(SOLARLENS_HAVE_AVX512)
+void transmission_avx512(const TransmissionArgs&);
+#endif
+#if defined(SOLARLENS_HAVE_NEON)
+void transmission_neon(const TransmissionArgs&);
+#endif
+
+} // namespace solarlens::retrieval::detail
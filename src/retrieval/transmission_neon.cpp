@@ -0,0 +1,55 @@
+// AArch64 NEON kernel: four bands per step.
+
+#include <arm_neon.h>
+
+#include "transmission_kernels.hpp"
+
+namespace solarlens::retrieval::detail {
+
+namespace {
+
+// exp(x) for x <= 0, as in the AVX2 kernel.
+float32x4_t exp_neg(float32x4_t x)
+{
+    const float32x4_t lo = vdupq_n_f32(-87.0f);
+    const uint32x4_t keep = vcgeq_f32(x, lo);
+    x = vmaxq_f32(x, lo);
+    const float32x4_t n = vrndnq_f32(vmulq_n_f32(x, 1.44269504088896341f));
+    float32x4_t r = vfmsq_f32(x, n, vdupq_n_f32(0.693359375f));
+    r = vfmsq_f32(r, n, vdupq_n_f32(-2.12194440e-4f));
+    float32x4_t p = vdupq_n_f32(1.9875691500e-4f);
+    p = vfmaq_f32(vdupq_n_f32(1.3981999507e-3f), p, r);
+    p = vfmaq_f32(vdupq_n_f32(8.3334519073e-3f), p, r);
+    p = vfmaq_f32(vdupq_n_f32(4.1665795894e-2f), p, r);
+    p = vfmaq_f32(vdupq_n_f32(1.6666665459e-1f), p, r);
+    p = vfmaq_f32(vdupq_n_f32(5.0000001201e-1f), p, r);
+    const float32x4_t y = vaddq_f32(vfmaq_f32(r, vmulq_f32(p, r), r), vdupq_n_f32(1.0f));
+    const int32x4_t e = vshlq_n_s32(vaddq_s32(vcvtq_s32_f32(n), vdupq_n_s32(127)), 23);
+    const float32x4_t v = vmulq_f32(y, vreinterpretq_f32_s32(e));
+    return vreinterpretq_f32_u32(vandq_u32(keep, vreinterpretq_u32_f32(v)));
+}
+
+} // namespace
+
+void transmission_neon(const TransmissionArgs& a)
+{
+    constexpr std::size_t lanes = 4;
+    for (std::size_t b = 0; b < a.stride; b += lanes) {
+        const float32x4_t grey_tau = vmulq_n_f32(vld1q_f32(a.grey_depth + b), a.grey_coeff);
+        float32x4_t clear = vdupq_n_f32(0.0f);
+        float32x4_t cloud = vdupq_n_f32(0.0f);
+        for (std::size_t g = 0; g < a.g_count; ++g) {
+            const std::size_t at = g * a.stride + b;
+            float32x4_t tau = grey_tau;
+            for (std::size_t t = 0; t < a.terms; ++t)
+                tau = vfmaq_n_f32(tau, vld1q_f32(a.slab[t] + at), a.coeff[t]);
+            clear = vfmaq_n_f32(clear, exp_neg(vnegq_f32(tau)), a.g_weights[g]);
+            cloud = vfmaq_n_f32(cloud, exp_neg(vmulq_n_f32(tau, -a.cloud_scale)), a.g_weights[g]);
+        }
+        vst1q_f32(a.clear + b, clear);
+        vst1q_f32(a.cloud + b, cloud);
+        vst1q_f32(a.grey_transmission + b, exp_neg(vnegq_f32(grey_tau)));
+    }
+}
+
+} // namespace solarlens::retrieval::detail
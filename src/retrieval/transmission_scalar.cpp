@@ -0,0 +1,28 @@
+// Reference kernel.
+
+#include <cmath>
+
+#include "transmission_kernels.hpp"
+
+namespace solarlens::retrieval::detail {
+
+void transmission_scalar(const TransmissionArgs& a)
+{
+    for (std::size_t b = 0; b < a.stride; ++b) {
+        const float grey_tau = a.grey_coeff * a.grey_depth[b];
+        float clear = 0.0f;
+        float cloud = 0.0f;
+        for (std::size_t g = 0; g < a.g_count; ++g) {
+            float tau = grey_tau;
+            for (std::size_t t = 0; t < a.terms; ++t)
+                tau += a.coeff[t] * a.slab[t][g * a.stride + b];
+            clear += a.g_weights[g] * std::exp(-tau);
+            cloud += a.g_weights[g] * std::exp(-a.cloud_scale * tau);
+        }
+        a.clear[b] = clear;
+        a.cloud[b] = cloud;
+        a.grey_transmission[b] = std::exp(-grey_tau);
+    }
+}
+
+} // namespace solarlens::retrieval::detail
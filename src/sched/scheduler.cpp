@@ -0,0 +1,263 @@
+#include "solarlens/sched/scheduler.hpp"
+
+#include <algorithm>
+#include <string>
+
+#include "solarlens/perf/instrument.hpp"
+
+namespace solarlens::sched {
+
+namespace {
+
+/// Rounds of stealing an idle worker makes before it parks.
+constexpr int spin_rounds = 64;
+
+struct CurrentWorker {
+    const Scheduler* scheduler = nullptr;
+    std::size_t index = 0;
+};
+
+thread_local CurrentWorker current;
+
+std::uint64_t xorshift(std::uint64_t& s) noexcept
+{
+    s ^= s << 13;
+    s ^= s >> 7;
+    s ^= s << 17;
+    return s;
+}
+
+} // namespace
+
+Scheduler::Scheduler(std::size_t workers)
+{
+    workers = std::max<std::size_t>(workers, 1);
+    workers_.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) {
+        workers_.push_back(std::make_unique<Worker>());
+        workers_.back()->rng = 0x9e3779b97f4a7c15ull * (i + 1);
+    }
+    for (std::size_t i = 0; i < workers; ++i)
+        workers_[i]->thread = std::thread([this, i] { worker_loop(i); });
+}
+
+Scheduler::~Scheduler()
+{
+    stopping_.store(true, std::memory_order_seq_cst);
+    wake_epoch_.fetch_add(1, std::memory_order_seq_cst);
+    wake_epoch_.notify_all();
+    for (auto& w : workers_)
+        w->thread.join();
+}
+
+int Scheduler::current_worker() const noexcept
+{
+    return current.scheduler == this ? static_cast<int>(current.index) : -1;
+}
+
+void Scheduler::submit_node(TaskNode* node)
+{
+    outstanding_.fetch_add(1, std::memory_order_relaxed);
+    if (current.scheduler == this) {
+        workers_[current.index]->deque.push(node);
+    } else {
+        const std::lock_guard lock(injected_mutex_);
+        injected_.push_back(node);
+        injected_size_.fetch_add(1, std::memory_order_relaxed);
+    }
+    // Pairs with the sleeper registration in worker_loop(): either the
+    // sleeper sees the new task or this sees the sleeper.
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers_.load(std::memory_order_relaxed) > 0)
+        wake_one();
+}
+
+void Scheduler::wake_one()
+{
+    wake_epoch_.fetch_add(1, std::memory_order_seq_cst);
+    wake_epoch_.notify_one();
+}
+
+Scheduler::TaskNode* Scheduler::pop_injected()
+{
+    if (injected_size_.load(std::memory_order_relaxed) == 0)
+        return nullptr;
+    const std::lock_guard lock(injected_mutex_);
+    if (injected_.empty())
+        return nullptr;
+    TaskNode* node = injected_.front();
+    injected_.pop_front();
+    injected_size_.fetch_sub(1, std::memory_order_relaxed);
+    return node;
+}
+
+Scheduler::TaskNode* Scheduler::steal_from_others(std::size_t self, std::uint64_t& rng)
+{
+    const std::size_t n = workers_.size();
+    if (n < 2 && self < n)
+        return nullptr;
+    const std::size_t start = static_cast<std::size_t>(xorshift(rng) % n);
+    for (std::size_t k = 0; k < n; ++k) {
+        const std::size_t victim = (start + k) % n;
+        if (victim == self)
+            continue;
+        if (TaskNode* node = workers_[victim]->deque.steal()) {
+            if (self < n)
+                workers_[self]->steals.fetch_add(1, std::memory_order_relaxed);
+            return node;
+        }
+    }
+    if (self < n)
+        workers_[self]->failed_steals.fetch_add(1, std::memory_order_relaxed);
+    return nullptr;
+}
+
+Scheduler::TaskNode* Scheduler::find_work(std::size_t self)
+{
+    Worker& w = *workers_[self];
+    if (TaskNode* node = w.deque.take())
+        return node;
+    if (TaskNode* node = pop_injected())
+        return node;
+    return steal_from_others(self, w.rng);
+}
+
+bool Scheduler::any_work_visible() const noexcept
+{
+    if (injected_size_.load(std::memory_order_relaxed) != 0)
+        return true;
+    return std::any_of(workers_.begin(), workers_.end(),
+                       [](const auto& w) { return w->deque.size_approx() != 0; });
+}
+
+void Scheduler::execute(TaskNode* node, Worker* worker)
+{
+    node->run();
+    delete node;
+    if (worker != nullptr)
+        worker->executed.fetch_add(1, std::memory_order_relaxed);
+    if (outstanding_.fetch_sub(1, std::memory_order_acq_rel) == 1
+        && stopping_.load(std::memory_order_relaxed)) {
+        wake_epoch_.fetch_add(1, std::memory_order_seq_cst);
+        wake_epoch_.notify_all();
+    }
+}
+
+bool Scheduler::try_run_one()
+{
+    TaskNode* node = nullptr;
+    Worker* worker = nullptr;
+    if (current.scheduler == this) {
+        worker = workers_[current.index].get();
+        node = find_work(current.index);
+    } else {
+        thread_local std::uint64_t rng = 0x2545f4914f6cdd1dull;
+        node = pop_injected();
+        if (node == nullptr)
+            node = steal_from_others(workers_.size(), rng);
+    }
+    if (node == nullptr)
+        return false;
+    execute(node, worker);
+    return true;
+}
+
+void Scheduler::worker_loop(std::size_t index)
+{
+    current = {this, index};
+    perf::set_thread_name("sched worker " + std::to_string(index));
+    Worker& self = *workers_[index];
+    for (;;) {
+        TaskNode* node = nullptr;
+        for (int round = 0; round < spin_rounds && node == nullptr; ++round) {
+            node = find_work(index);
+            if (node == nullptr)
+                std::this_thread::yield();
+        }
+        if (node != nullptr) {
+            execute(node, &self);
+            continue;
+        }
+
+        // Park. Register as a sleeper first so a submitter either sees us
+        // or we see its task in the re-check below.
+        const std::uint32_t epoch = wake_epoch_.load(std::memory_order_seq_cst);
+        sleepers_.fetch_add(1, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const bool done = stopping_.load(std::memory_order_seq_cst)
+            && outstanding_.load(std::memory_order_acquire) == 0;
+        if (!done && !any_work_visible()) {
+            self.parks.fetch_add(1, std::memory_order_relaxed);
+            wake_epoch_.wait(epoch, std::memory_order_seq_cst);
+        }
+        sleepers_.fetch_sub(1, std::memory_order_relaxed);
+        if (done)
+            break;
+    }
+    current = {};
+}
+
+std::vector<WorkerMetrics> Scheduler::worker_metrics() const
+{
+    std::vector<WorkerMetrics> out;
+    out.reserve(workers_.size());
+    for (const auto& w : workers_)
+        out.push_back({w->deque.size_approx(), w->executed.load(std::memory_order_relaxed),
+                       w->steals.load(std::memory_order_relaxed),
+                       w->failed_steals.load(std::memory_order_relaxed),
+                       w->parks.load(std::memory_order_relaxed)});
+    return out;
+}
+
+TaskGroup::~TaskGroup()
+{
+    try {
+        wait();
+    } catch (...) {
+    }
+}
+
+void TaskGroup::record(std::exception_ptr e) noexcept
+{
+    const std::lock_guard lock(error_mutex_);
+    if (!error_)
+        error_ = std::move(e);
+}
+
+void TaskGroup::finish() noexcept
+{
+    std::size_t n = pending_.load(std::memory_order_relaxed);
+    while (n > 1)
+        if (pending_.compare_exchange_weak(n, n - 1, std::memory_order_acq_rel, std::memory_order_relaxed))
+            return;
+    // The last task wakes the waiter under wake_mutex_, which wait()
+    // takes before returning: the group may be destroyed as soon as wait()
+    // returns, so it must not return while notify_all() still touches it.
+    const std::lock_guard lock(wake_mutex_);
+    if (pending_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        pending_.notify_all();
+}
+
+void TaskGroup::wait()
+{
+    for (;;) {
+        const std::size_t n = pending_.load(std::memory_order_acquire);
+        if (n == 0)
+            break;
+        if (!scheduler_.try_run_one())
+            pending_.wait(n, std::memory_order_acquire);
+    }
+    {
+        // Once this is held, the last finish() is done with the group.
+        const std::lock_guard lock(wake_mutex_);
+    }
+    std::exception_ptr e;
+    {
+        const std::lock_guard lock(error_mutex_);
+        e = std::exchange(error_, nullptr);
+    }
+    if (e)
+        std::rethrow_exception(e);
+}
+
+} // namespace solarlens::sched
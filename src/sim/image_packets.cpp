@@ -0,0 +1,87 @@
+#include "solarlens/sim/image_packets.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+#include <utility>
+
+#include "solarlens/ingest/ccsds.hpp"
+
+namespace solarlens::sim {
+
+void send_frame(std::uint32_t frame, std::span<const std::uint16_t> counts, std::uint32_t width,
+                std::uint32_t height, std::uint32_t rows_per_packet, std::uint16_t& sequence,
+                ingest::TmEncoder& encoder, const ingest::CaduSink& sink)
+{
+    if (width == 0 || height == 0 || width > 0xFFFF || height > 0xFFFF || rows_per_packet == 0
+        || counts.size() < std::size_t(width) * height)
+        throw std::invalid_argument("image packets: bad frame shape");
+    if (image_packet_header_size + std::size_t(rows_per_packet) * width * 2 > 65536)
+        throw std::invalid_argument("image packets: packet too large");
+
+    std::vector<std::byte> data;
+    for (std::uint32_t row = 0; row < height; row += rows_per_packet) {
+        const std::uint32_t rows = std::min(rows_per_packet, height - row);
+        data.resize(image_packet_header_size + std::size_t(rows) * width * 2);
+        ingest::store_be16(data.data(), static_cast<std::uint16_t>(frame >> 16));
+        ingest::store_be16(data.data() + 2, static_cast<std::uint16_t>(frame));
+        ingest::store_be16(data.data() + 4, static_cast<std::uint16_t>(width));
+        ingest::store_be16(data.data() + 6, static_cast<std::uint16_t>(height));
+        ingest::store_be16(data.data() + 8, static_cast<std::uint16_t>(row));
+        ingest::store_be16(data.data() + 10, static_cast<std::uint16_t>(rows));
+        const std::uint16_t* src = counts.data() + std::size_t(row) * width;
+        std::byte* dst = data.data() + image_packet_header_size;
+        for (std::size_t i = 0; i < std::size_t(rows) * width; ++i)
+            ingest::store_be16(dst + 2 * i, src[i]);
+        encoder.add_packet(ingest::make_space_packet(image_apid, sequence, data), sink);
+        sequence = static_cast<std::uint16_t>((sequence + 1) & 0x3FFF);
+    }
+}
+
+bool FrameAssembler::add(const ingest::PacketRef& ref)
+{
+    if (ref.packet.apid() != image_apid)
+        return true;
+    const std::span<const std::byte> data = ref.packet.data();
+    if (data.size() < image_packet_header_size) {
+        ++malformed_;
+        return false;
+    }
+    const std::uint32_t index =
+        (std::uint32_t(ingest::load_be16(data.data())) << 16) | ingest::load_be16(data.data() + 2);
+    const std::uint32_t width = ingest::load_be16(data.data() + 4);
+    const std::uint32_t height = ingest::load_be16(data.data() + 6);
+    const std::uint32_t first = ingest::load_be16(data.data() + 8);
+    const std::uint32_t rows = ingest::load_be16(data.data() + 10);
+    if (width == 0 || rows == 0 || first + rows > height
+        || data.size() != image_packet_header_size + std::size_t(rows) * width * 2) {
+        ++malformed_;
+        return false;
+    }
+
+    const std::uint64_t key = (std::uint64_t(ref.spacecraft_id) << 32) | index;
+    Partial& p = partial_[key];
+    if (p.frame.pixels.empty()) {
+        p.frame = {ref.spacecraft_id, index, width, height, {}};
+        p.frame.pixels.resize(std::size_t(width) * height);
+    } else if (p.frame.width != width || p.frame.height != height) {
+        ++malformed_;
+        return false;
+    }
+    const std::byte* src = data.data() + image_packet_header_size;
+    float* dst = p.frame.pixels.data() + std::size_t(first) * width;
+    for (std::size_t i = 0; i < std::size_t(rows) * width; ++i)
+        dst[i] = float(ingest::load_be16(src + 2 * i));
+    p.rows_seen += rows;
+    if (p.rows_seen >= height) {
+        completed_.push_back(std::move(p.frame));
+        partial_.erase(key);
+    }
+    return true;
+}
+
+std::vector<FrameAssembler::Frame> FrameAssembler::take_completed()
+{
+    return std::exchange(completed_, {});
+}
+
+} // namespace solarlens::sim
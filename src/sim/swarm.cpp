@@ -0,0 +1,254 @@
+#include "solarlens/sim/swarm.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <stdexcept>
+
+namespace solarlens::sim {
+
+namespace {
+
+std::uint64_t splitmix64(std::uint64_t x) noexcept
+{
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+}
+
+/// Independent stream per (purpose, a, b) so frames can be rendered in
+/// any order.
+std::mt19937_64 stream(std::uint64_t seed, std::uint64_t purpose, std::uint64_t a,
+                       std::uint64_t b = 0)
+{
+    return std::mt19937_64(splitmix64(splitmix64(splitmix64(seed ^ purpose) ^ a) ^ b));
+}
+
+enum : std::uint64_t { planet_stream = 1, frame_stream = 2, raster_stream = 3, baseband_stream = 4 };
+
+} // namespace
+
+void SwarmConfig::validate() const
+{
+    if (spacecraft == 0 || frames_per_craft == 0)
+        throw std::invalid_argument("swarm: need at least one spacecraft and frame");
+    if (map_size < 8 || frame_size < 32)
+        throw std::invalid_argument("swarm: map or frame too small");
+    if (!(planet_radius > 0 && planet_radius <= 0.5))
+        throw std::invalid_argument("swarm: planet_radius must be in (0, 0.5]");
+    if (!(ring_width_px > 0) || !(ring_peak_counts > 0) || read_noise < 0 || jitter_px < 0)
+        throw std::invalid_argument("swarm: bad ring or noise parameters");
+    if (channels == 0 || (channels & (channels - 1)) != 0 || spectra == 0)
+        throw std::invalid_argument("swarm: channels must be a power of two");
+}
+
+calib::CoronaGeometry coronagraph_geometry(std::uint32_t frame_size, double ring_width_px)
+{
+    const std::uint32_t n = frame_size;
+    const float c = 0.5f * float(n) - 0.5f;
+    const float ring_r = 0.2f * float(n);
+    const float half = 4.0f * float(ring_width_px);
+    return {c, c, 0.08f * n, 0.10f * n, 0.48f * n, ring_r - half, ring_r + half};
+}
+
+SwarmSimulator::SwarmSimulator(const SwarmConfig& config)
+    : config_((config.validate(), config))
+    , psf_(config.psf)
+    , kernel_(psf_)
+{
+    const std::uint32_t n = config_.frame_size;
+    geometry_ = coronagraph_geometry(n, config_.ring_width_px);
+    const float c = geometry_.centre_x;
+
+    background_.resize(std::size_t(n) * n);
+    grad_x_.resize(background_.size());
+    grad_y_.resize(background_.size());
+    // K-corona ~ r^-2 plus a steeper inner F-corona term; both lie in the
+    // span of the calibration model, so photometry errors come from noise
+    // and jitter rather than model mismatch.
+    const auto corona = [&](double x, double y) {
+        const double r = std::max(1.0, std::hypot(x - c, y - c)) / geometry_.fit_inner;
+        const double u = 1.0 / (r * r);
+        return config_.corona_counts * (0.7 * u + 0.3 * u * u * u) + config_.zodiacal_counts;
+    };
+    for (std::uint32_t y = 0; y < n; ++y)
+        for (std::uint32_t x = 0; x < n; ++x) {
+            const std::size_t i = std::size_t(y) * n + x;
+            background_[i] = float(corona(x, y));
+            grad_x_[i] = float(0.5 * (corona(x + 1.0, y) - corona(x - 1.0, y)));
+            grad_y_[i] = float(0.5 * (corona(x, y + 1.0) - corona(x, y - 1.0)));
+        }
+
+    render_planet();
+    const double centre = 0.5 * (config_.map_size - 1);
+    ring_gain_ = config_.ring_peak_counts / std::max(flux_at(centre, centre), 1e-12);
+
+    auto rng = stream(config_.seed, baseband_stream, ~std::uint64_t(0));
+    std::uniform_real_distribution<double> frac(-0.5, 0.5);
+    delays_.resize(config_.spacecraft);
+    for (double& d : delays_)
+        d = frac(rng);
+}
+
+void SwarmSimulator::render_planet()
+{
+    const std::uint32_t m = config_.map_size;
+    const double centre = 0.5 * (m - 1);
+    const double radius = config_.planet_radius * m;
+    auto rng = stream(config_.seed, planet_stream, 0);
+    std::uniform_real_distribution<double> pos(-0.6, 0.6);
+    std::uniform_real_distribution<double> size(0.15, 0.35);
+    struct Blob {
+        double x, y, s;
+    };
+    std::vector<Blob> continents(4);
+    for (Blob& b : continents)
+        b = {pos(rng) * radius, pos(rng) * radius, size(rng) * radius};
+
+    planet_.assign(std::size_t(m) * m, 0.0f);
+    for (std::uint32_t y = 0; y < m; ++y)
+        for (std::uint32_t x = 0; x < m; ++x) {
+            const double dx = x - centre;
+            const double dy = y - centre;
+            const double rr = (dx * dx + dy * dy) / (radius * radius);
+            if (rr >= 1.0)
+                continue;
+            double albedo = 0.3;
+            for (const Blob& b : continents) {
+                const double d2 = ((dx - b.x) * (dx - b.x) + (dy - b.y) * (dy - b.y)) / (b.s * b.s);
+                albedo += 0.25 * std::exp(-0.5 * d2);
+            }
+            if (std::abs(dy) > 0.8 * radius)
+                albedo = 0.9;
+            const double limb = std::pow(1.0 - rr, 0.25);
+            planet_[std::size_t(y) * m + x] = float(albedo * limb);
+        }
+}
+
+void SwarmSimulator::position(std::size_t craft, std::size_t frame, float& u, float& v) const noexcept
+{
+    // Each craft owns a horizontal band and rasters it boustrophedon, with
+    // stops spread evenly over the band's area.
+    const double m = config_.map_size;
+    const double band = m / double(config_.spacecraft);
+    const double spacing = std::sqrt(m * band / double(config_.frames_per_craft));
+    const auto rows = std::max<std::size_t>(1, std::size_t(std::ceil(band / spacing)));
+    const std::size_t per_row = (config_.frames_per_craft + rows - 1) / rows;
+    const std::size_t row = frame / per_row;
+    std::size_t col = frame % per_row;
+    if (row % 2 == 1)
+        col = per_row - 1 - col;
+
+    auto rng = stream(config_.seed, raster_stream, craft, frame);
+    std::normal_distribution<double> scatter(0.0, config_.position_scatter_px);
+    const double x = (col + 0.5) * m / double(per_row) - 0.5 + scatter(rng);
+    const double y = craft * band + (row + 0.5) * band / double(rows) - 0.5 + scatter(rng);
+    u = float(std::clamp(x, 0.0, m - 1.0));
+    v = float(std::clamp(y, 0.0, m - 1.0));
+}
+
+double SwarmSimulator::flux_at(double u, double v) const noexcept
+{
+    const auto m = static_cast<std::int64_t>(config_.map_size);
+    const double r = kernel_.radius();
+    const auto x0 = std::max<std::int64_t>(0, std::int64_t(std::ceil(u - r)));
+    const auto x1 = std::min<std::int64_t>(m - 1, std::int64_t(std::floor(u + r)));
+    const auto y0 = std::max<std::int64_t>(0, std::int64_t(std::ceil(v - r)));
+    const auto y1 = std::min<std::int64_t>(m - 1, std::int64_t(std::floor(v + r)));
+    double sum = 0.0;
+    for (std::int64_t y = y0; y <= y1; ++y)
+        for (std::int64_t x = x0; x <= x1; ++x) {
+            const double d2 = (x - u) * (x - u) + (y - v) * (y - v);
+            if (d2 < kernel_.radius_squared())
+                sum += kernel_(std::sqrt(d2)) * planet_[std::size_t(y) * m + x];
+        }
+    return sum;
+}
+
+FrameTruth SwarmSimulator::render(std::size_t craft, std::size_t frame,
+                                  std::span<std::uint16_t> counts) const
+{
+    const std::uint32_t n = config_.frame_size;
+    if (counts.size() < std::size_t(n) * n)
+        throw std::invalid_argument("swarm: frame buffer too small");
+    FrameTruth t;
+    position(craft, frame, t.u, t.v);
+    t.flux = flux_at(t.u, t.v);
+
+    auto rng = stream(config_.seed, frame_stream, craft, frame);
+    std::normal_distribution<float> unit(0.0f, 1.0f);
+    t.jitter_x = float(config_.jitter_px) * unit(rng);
+    t.jitter_y = float(config_.jitter_px) * unit(rng);
+
+    const float cx = geometry_.centre_x + t.jitter_x;
+    const float cy = geometry_.centre_y + t.jitter_y;
+    const float ring_r = 0.5f * (geometry_.ring_inner + geometry_.ring_outer);
+    const float inv_w = 1.0f / float(config_.ring_width_px);
+    const float amplitude = float(ring_gain_ * t.flux);
+    const float read2 = float(config_.read_noise * config_.read_noise);
+    for (std::uint32_t y = 0; y < n; ++y)
+        for (std::uint32_t x = 0; x < n; ++x) {
+            const std::size_t i = std::size_t(y) * n + x;
+            float value = background_[i] - t.jitter_x * grad_x_[i] - t.jitter_y * grad_y_[i];
+            const float d = (std::hypot(float(x) - cx, float(y) - cy) - ring_r) * inv_w;
+            if (std::abs(d) < 6.0f)
+                value += amplitude * std::exp(-0.5f * d * d);
+            value += std::sqrt(read2 + std::max(value, 0.0f)) * unit(rng);
+            counts[i] = static_cast<std::uint16_t>(std::clamp(std::lround(value), 0L, 65535L));
+        }
+    return t;
+}
+
+RingPhotometry SwarmSimulator::measure_ring(core::ImageView<const float> frame) const
+{
+    const float ring_r = 0.5f * (geometry_.ring_inner + geometry_.ring_outer);
+    const double inv_w = 1.0 / config_.ring_width_px;
+    const auto y0 = std::uint32_t(std::max(0.0f, std::floor(geometry_.centre_y - geometry_.ring_outer)));
+    const auto y1 = std::min(frame.height, std::uint32_t(geometry_.centre_y + geometry_.ring_outer) + 2);
+    const auto x0 = std::uint32_t(std::max(0.0f, std::floor(geometry_.centre_x - geometry_.ring_outer)));
+    const auto x1 = std::min(frame.width, std::uint32_t(geometry_.centre_x + geometry_.ring_outer) + 2);
+
+    double pd = 0.0, pp = 0.0, dd = 0.0;
+    std::size_t count = 0;
+    for (std::uint32_t y = y0; y < y1; ++y)
+        for (std::uint32_t x = x0; x < x1; ++x) {
+            const double r = std::hypot(x - geometry_.centre_x, y - geometry_.centre_y);
+            const double value = frame(x, y);
+            if (r < geometry_.ring_inner || r > geometry_.ring_outer || !std::isfinite(value))
+                continue;
+            const double d = (r - ring_r) * inv_w;
+            const double p = std::exp(-0.5 * d * d);
+            pd += p * value;
+            pp += p * p;
+            dd += value * value;
+            ++count;
+        }
+    RingPhotometry out;
+    out.pixels = count;
+    if (count < 2 || pp <= 0.0)
+        return out;
+    const double amplitude = pd / pp;
+    // Residual sum of squares of the one-parameter fit: dd - pd^2 / pp.
+    const double variance = std::max(0.0, dd - pd * amplitude) / double(count - 1);
+    out.flux = amplitude / ring_gain_;
+    out.sigma = std::sqrt(variance / pp) / ring_gain_;
+    return out;
+}
+
+void SwarmSimulator::baseband(std::size_t integration, std::span<std::complex<float>> samples) const
+{
+    const std::size_t per_station = config_.channels * config_.spectra;
+    if (samples.size() < per_station * config_.spacecraft)
+        throw std::invalid_argument("swarm: baseband buffer too small");
+    auto rng = stream(config_.seed, baseband_stream, integration);
+    std::normal_distribution<float> unit(0.0f, 1.0f);
+    std::vector<std::complex<float>> sky(per_station);
+    for (auto& s : sky)
+        s = {unit(rng), unit(rng)};
+    for (std::size_t s = 0; s < config_.spacecraft; ++s)
+        for (std::size_t t = 0; t < per_station; ++t)
+            samples[s * per_station + t] = sky[t] + 0.5f * std::complex<float>(unit(rng), unit(rng));
+}
+
+} // namespace solarlens::sim
@@ -0,0 +1,465 @@
+#include "solarlens/tm/dictionary.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <ostream>
+#include <set>
+#include <sstream>
+#include <stdexcept>
+#include <string_view>
+
+#include "solarlens/core/snapshot.hpp"
+
+namespace solarlens::tm {
+
+namespace {
+
+/// Members every generated packet struct declares itself.
+constexpr std::string_view reserved_names[] = {"apid", "length", "layout", "Values", "decode"};
+
+bool is_identifier(std::string_view s)
+{
+    if (s.empty() || !(std::isalpha(static_cast<unsigned char>(s[0])) || s[0] == '_'))
+        return false;
+    return std::all_of(s.begin(), s.end(), [](char c) {
+        return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+    });
+}
+
+std::string camel_case(std::string_view snake)
+{
+    std::string out;
+    bool upper = true;
+    for (char c : snake) {
+        if (c == '_') {
+            upper = true;
+            continue;
+        }
+        out += upper ? static_cast<char>(std::toupper(static_cast<unsigned char>(c))) : c;
+        upper = false;
+    }
+    return out;
+}
+
+/// Shortest text that reads back as exactly `v` and is a double literal.
+std::string double_literal(double v)
+{
+    char buf[32];
+    for (int precision = 15; precision <= 17; ++precision) {
+        std::snprintf(buf, sizeof buf, "%.*g", precision, v);
+        if (std::strtod(buf, nullptr) == v)
+            break;
+    }
+    std::string s = buf;
+    if (s.find_first_of(".eE") == std::string::npos)
+        s += ".0";
+    return s;
+}
+
+const char* encoding_name(Encoding e)
+{
+    switch (e) {
+    case Encoding::unsigned_int:
+        return "Encoding::unsigned_int";
+    case Encoding::signed_int:
+        return "Encoding::signed_int";
+    case Encoding::ieee_float:
+        return "Encoding::ieee_float";
+    }
+    return "";
+}
+
+const char* value_type_name(const ParameterDef& p)
+{
+    if (!p.calibration.empty())
+        return "double";
+    switch (p.encoding) {
+    case Encoding::unsigned_int:
+        return "std::uint64_t";
+    case Encoding::signed_int:
+        return "std::int64_t";
+    case Encoding::ieee_float:
+        return p.bit_width == 32 ? "float" : "double";
+    }
+    return "";
+}
+
+class Parser {
+public:
+    Parser(std::istream& in, const std::string& source) : in_(in), source_(source) {}
+
+    Dictionary parse()
+    {
+        Dictionary dict;
+        PacketDef* packet = nullptr;
+        std::string line;
+        while (std::getline(in_, line)) {
+            ++line_no_;
+            if (const auto hash = line.find('#'); hash != std::string::npos)
+                line.resize(hash);
+            words_.clear();
+            std::istringstream ws(line);
+            for (std::string w; ws >> w;)
+                words_.push_back(std::move(w));
+            if (words_.empty())
+                continue;
+            at_ = 0;
+            const std::string keyword = next("keyword");
+            if (keyword == "dictionary") {
+                if (!dict.name.empty())
+                    fail("second dictionary line");
+                dict.name = identifier("dictionary name");
+            } else if (keyword == "packet") {
+                if (packet)
+                    fail("packet " + packet->name + " has no end");
+                packet = &dict.packets.emplace_back();
+                packet->name = identifier("packet name");
+                expect("apid");
+                const auto apid = number("apid");
+                if (apid > 0x7FF)
+                    fail("apid out of range");
+                packet->apid = static_cast<std::uint16_t>(apid);
+                expect("length");
+                packet->length = number("length");
+            } else if (keyword == "param") {
+                if (!packet)
+                    fail("param outside a packet");
+                packet->parameters.push_back(parameter());
+            } else if (keyword == "end") {
+                if (!packet)
+                    fail("end outside a packet");
+                packet = nullptr;
+            } else {
+                fail("unknown keyword '" + keyword + "'");
+            }
+            if (at_ != words_.size())
+                fail("unexpected '" + words_[at_] + "'");
+        }
+        if (packet)
+            fail("packet " + packet->name + " has no end");
+        if (dict.name.empty())
+            fail("missing dictionary line");
+        check(dict);
+        return dict;
+    }
+
+private:
+    ParameterDef parameter()
+    {
+        ParameterDef p;
+        p.name = identifier("parameter name");
+        if (std::find(std::begin(reserved_names), std::end(reserved_names), p.name) != std::end(reserved_names))
+            fail("parameter name '" + p.name + "' is reserved");
+        expect("at");
+        p.bit_offset = number("bit offset");
+        expect("width");
+        p.bit_width = number("bit width");
+        const std::string type = next("encoding");
+        if (type == "uint")
+            p.encoding = Encoding::unsigned_int;
+        else if (type == "int")
+            p.encoding = Encoding::signed_int;
+        else if (type == "float")
+            p.encoding = Encoding::ieee_float;
+        else
+            fail("unknown encoding '" + type + "'");
+        while (at_ < words_.size()) {
+            const std::string option = next("option");
+            if (option == "poly") {
+                while (at_ < words_.size() && words_[at_] != "unit")
+                    p.calibration.push_back(real("coefficient"));
+                if (p.calibration.empty())
+                    fail("poly needs at least one coefficient");
+            } else if (option == "unit") {
+                p.unit = next("unit");
+            } else {
+                fail("unknown option '" + option + "'");
+            }
+        }
+        if (p.bit_width < 1 || p.bit_width > 64)
+            fail("width must be 1..64 bits");
+        if ((p.bit_offset % 8 + p.bit_width + 7) / 8 > 8)
+            fail(p.name + " spans more than eight bytes");
+        if (p.encoding == Encoding::ieee_float && ((p.bit_width != 32 && p.bit_width != 64) || p.bit_offset % 8))
+            fail("float parameters must be byte-aligned 32- or 64-bit fields");
+        return p;
+    }
+
+    void check(const Dictionary& dict)
+    {
+        std::set<std::uint16_t> apids;
+        std::set<std::string> types;
+        for (const auto& packet : dict.packets) {
+            const std::string where = "packet " + packet.name;
+            if (!apids.insert(packet.apid).second)
+                throw error(where + ": duplicate apid");
+            if (!types.insert(camel_case(packet.name)).second)
+                throw error(where + ": name collides with another packet");
+            std::set<std::string_view> names;
+            for (const auto& p : packet.parameters) {
+                if (!names.insert(p.name).second)
+                    throw error(where + ": duplicate parameter " + p.name);
+                if ((p.bit_offset + p.bit_width + 7) / 8 > packet.length)
+                    throw error(where + ": " + p.name + " extends past the data field");
+            }
+        }
+    }
+
+    std::runtime_error error(const std::string& why) const
+    {
+        return std::runtime_error("telemetry dictionary: " + source_ + ": " + why);
+    }
+
+    [[noreturn]] void fail(const std::string& why) const
+    {
+        throw error("line " + std::to_string(line_no_) + ": " + why);
+    }
+
+    const std::string& next(const char* what)
+    {
+        if (at_ == words_.size())
+            fail(std::string("missing ") + what);
+        return words_[at_++];
+    }
+
+    void expect(const char* word)
+    {
+        if (next(word) != word)
+            fail(std::string("expected '") + word + "'");
+    }
+
+    std::string identifier(const char* what)
+    {
+        const std::string& s = next(what);
+        if (!is_identifier(s))
+            fail(std::string(what) + " '" + s + "' is not an identifier");
+        return s;
+    }
+
+    std::size_t number(const char* what)
+    {
+        const std::string& s = next(what);
+        const bool hex = s.size() > 2 && s[0] == '0' && (s[1] == 'x' || s[1] == 'X');
+        const char* first = s.data() + (hex ? 2 : 0);
+        std::size_t v = 0;
+        const auto [end, ec] = std::from_chars(first, s.data() + s.size(), v, hex ? 16 : 10);
+        if (ec != std::errc() || end != s.data() + s.size())
+            fail(std::string("bad ") + what + " '" + s + "'");
+        return v;
+    }
+
+    double real(const char* what)
+    {
+        const std::string& s = next(what);
+        char* end = nullptr;
+        const double v = std::strtod(s.c_str(), &end);
+        if (end != s.c_str() + s.size())
+            fail(std::string("bad ") + what + " '" + s + "'");
+        return v;
+    }
+
+    std::istream& in_;
+    const std::string& source_;
+    std::vector<std::string> words_;
+    std::size_t at_ = 0;
+    std::size_t line_no_ = 0;
+};
+
+} // namespace
+
+const PacketDef* Dictionary::find(std::uint16_t apid) const noexcept
+{
+    for (const auto& p : packets)
+        if (p.apid == apid)
+            return &p;
+    return nullptr;
+}
+
+std::size_t Dictionary::parameter_count() const noexcept
+{
+    std::size_t n = 0;
+    for (const auto& p : packets)
+        n += p.parameters.size();
+    return n;
+}
+
+Dictionary parse_dictionary(std::istream& in, const std::string& source)
+{
+    return Parser(in, source).parse();
+}
+
+Dictionary load_dictionary(const std::filesystem::path& path)
+{
+    std::ifstream in(path);
+    if (!in)
+        throw std::runtime_error("telemetry dictionary: cannot open " + path.string());
+    return parse_dictionary(in, path.string());
+}
+
+void snapshot_dictionary(const Dictionary& dictionary, core::SnapshotWriter& writer, std::string_view section)
+{
+    core::SectionBuilder b;
+    b.put_string(dictionary.name);
+    b.put(static_cast<std::uint32_t>(dictionary.packets.size()));
+    for (const PacketDef& packet : dictionary.packets) {
+        b.put_string(packet.name);
+        b.put(packet.apid);
+        b.put(static_cast<std::uint64_t>(packet.length));
+        b.put(static_cast<std::uint32_t>(packet.parameters.size()));
+        for (const ParameterDef& param : packet.parameters) {
+            b.put_string(param.name);
+            b.put(static_cast<std::uint64_t>(param.bit_offset));
+            b.put(static_cast<std::uint64_t>(param.bit_width));
+            b.put(param.encoding);
+            b.put_array(std::span<const double>(param.calibration));
+            b.put_string(param.unit);
+        }
+    }
+    writer.add(section, b);
+}
+
+Dictionary restore_dictionary(const core::Snapshot& snapshot, std::string_view section)
+{
+    core::SectionReader r(snapshot.section(section), section);
+    const auto bad = [&] {
+        return std::runtime_error("telemetry dictionary: malformed snapshot section " + std::string(section));
+    };
+    Dictionary dictionary;
+    dictionary.name = r.get_string();
+    dictionary.packets.resize(r.get<std::uint32_t>());
+    for (PacketDef& packet : dictionary.packets) {
+        packet.name = r.get_string();
+        packet.apid = r.get<std::uint16_t>();
+        packet.length = static_cast<std::size_t>(r.get<std::uint64_t>());
+        packet.parameters.resize(r.get<std::uint32_t>());
+        for (ParameterDef& param : packet.parameters) {
+            param.name = r.get_string();
+            param.bit_offset = static_cast<std::size_t>(r.get<std::uint64_t>());
+            param.bit_width = static_cast<std::size_t>(r.get<std::uint64_t>());
+            param.encoding = r.get<Encoding>();
+            const std::span<const double> calibration = r.get_array<double>();
+            param.calibration.assign(calibration.begin(), calibration.end());
+            param.unit = r.get_string();
+            // decode_parameter trusts these, so a damaged image must not get past here.
+            if (param.encoding > Encoding::ieee_float || param.bit_width < 1 || param.bit_width > 64
+                || param.bit_offset + param.bit_width > packet.length * 8)
+                throw bad();
+        }
+    }
+    if (!r.done())
+        throw bad();
+    return dictionary;
+}
+
+void write_decoder_header(const Dictionary& dictionary, std::ostream& out)
+{
+    out << "#pragma once\n\n"
+        << "// Generated by solarlens-tm-dict from dictionary " << dictionary.name << ". Do not edit.\n\n"
+        << "#include <cstddef>\n#include <cstdint>\n#include <span>\n\n"
+        << "#include \"solarlens/tm/parameter.hpp\"\n\n"
+        << "namespace solarlens::tm::dict::" << dictionary.name << " {\n";
+
+    for (const auto& packet : dictionary.packets) {
+        const std::string type = camel_case(packet.name);
+        out << "\nstruct " << type << "Values {\n";
+        for (const auto& p : packet.parameters)
+            out << "    " << value_type_name(p) << ' ' << p.name << ";\n";
+        out << "};\n\n";
+
+        char apid[8];
+        std::snprintf(apid, sizeof apid, "0x%03X", packet.apid);
+        out << "struct " << type << " {\n"
+            << "    static constexpr std::uint16_t apid = " << apid << ";\n"
+            << "    static constexpr std::size_t length = " << packet.length << ";\n\n";
+        for (const auto& p : packet.parameters) {
+            out << "    using " << p.name << " = Parameter<\"" << p.name << "\", " << p.bit_offset << ", "
+                << p.bit_width << ", " << encoding_name(p.encoding);
+            if (!p.calibration.empty()) {
+                out << ", Polynomial<";
+                for (std::size_t i = 0; i < p.calibration.size(); ++i)
+                    out << (i ? ", " : "") << double_literal(p.calibration[i]);
+                out << '>';
+            }
+            out << ">;";
+            if (!p.unit.empty())
+                out << "  // " << p.unit;
+            out << '\n';
+        }
+        out << "\n    using layout = PacketLayout<apid, length";
+        for (const auto& p : packet.parameters)
+            out << ", " << p.name;
+        out << ">;\n"
+            << "    using Values = " << type << "Values;\n\n"
+            << "    static constexpr Values decode(const std::byte* data) noexcept\n"
+            << "    {\n"
+            << "        Values v {};\n";
+        for (const auto& p : packet.parameters)
+            out << "        v." << p.name << " = " << p.name << "::value(data);\n";
+        out << "        return v;\n"
+            << "    }\n"
+            << "};\n";
+    }
+
+    out << "\n/// Decodes a packet data field by APID and calls `fn(Packet{}, values)`.\n"
+        << "/// Returns false for unknown APIDs and short data fields.\n"
+        << "template <typename Fn>\n"
+        << "bool dispatch(std::uint16_t apid, std::span<const std::byte> data, Fn&& fn)\n"
+        << "{\n"
+        << "    switch (apid) {\n";
+    for (const auto& packet : dictionary.packets) {
+        const std::string type = camel_case(packet.name);
+        out << "    case " << type << "::apid:\n"
+            << "        if (data.size() < " << type << "::length)\n"
+            << "            return false;\n"
+            << "        fn(" << type << " {}, " << type << "::decode(data.data()));\n"
+            << "        return true;\n";
+    }
+    out << "    default:\n"
+        << "        return false;\n"
+        << "    }\n"
+        << "}\n\n"
+        << "} // namespace solarlens::tm::dict::" << dictionary.name << '\n';
+}
+
+double decode_parameter(const ParameterDef& param, std::span<const std::byte> data) noexcept
+{
+    const std::size_t first = param.bit_offset / 8;
+    const std::size_t count = (param.bit_offset % 8 + param.bit_width + 7) / 8;
+    std::uint64_t word = 0;
+    for (std::size_t i = 0; i < count; ++i)
+        word = (word << 8) | std::to_integer<std::uint64_t>(data[first + i]);
+    const unsigned shift = static_cast<unsigned>(count * 8 - param.bit_offset % 8 - param.bit_width);
+    const std::uint64_t mask = param.bit_width == 64 ? ~std::uint64_t {0}
+                                                     : (std::uint64_t {1} << param.bit_width) - 1;
+    const std::uint64_t bits = (word >> shift) & mask;
+
+    double raw = 0.0;
+    switch (param.encoding) {
+    case Encoding::unsigned_int:
+        raw = static_cast<double>(bits);
+        break;
+    case Encoding::signed_int: {
+        const unsigned pad = static_cast<unsigned>(64 - param.bit_width);
+        raw = static_cast<double>(static_cast<std::int64_t>(bits << pad) >> pad);
+        break;
+    }
+    case Encoding::ieee_float:
+        raw = param.bit_width == 32 ? std::bit_cast<float>(static_cast<std::uint32_t>(bits))
+                                    : std::bit_cast<double>(bits);
+        break;
+    }
+    if (param.calibration.empty())
+        return raw;
+    double y = param.calibration.back();
+    for (std::size_t i = param.calibration.size() - 1; i-- > 0;)
+        y = y * raw + param.calibration[i];
+    return y;
+}
+
+} // namespace solarlens::tm
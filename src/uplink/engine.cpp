@@ -0,0 +1,410 @@
+#include "solarlens/uplink/engine.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <exception>
+#include <stdexcept>
+#include <utility>
+
+#include "solarlens/core/snapshot.hpp"
+#include "solarlens/nav/ephemeris.hpp"
+#include "solarlens/nav/propagator.hpp"
+#include "solarlens/perf/instrument.hpp"
+#include "solarlens/sched/scheduler.hpp"
+
+namespace solarlens::uplink {
+
+namespace {
+
+constexpr double light_seconds_per_au = 499.004783836;
+constexpr double seconds_per_day = 86400.0;
+
+// Heap order for std::push_heap / pop_heap: earliest time on top, ties by id.
+template <typename Timer>
+bool later(const Timer& a, const Timer& b) noexcept
+{
+    return a.time != b.time ? a.time > b.time : a.id > b.id;
+}
+
+std::uint64_t id_of(Sequence::Handle h) noexcept
+{
+    return h.promise().id;
+}
+
+} // namespace
+
+LightTimeModel constant_light_time(double distance_au)
+{
+    if (!(distance_au > 0.0))
+        throw std::invalid_argument("uplink: distance must be positive");
+    const double seconds = distance_au * light_seconds_per_au;
+    return [seconds](std::uint32_t, MissionTime) { return seconds; };
+}
+
+LightTimeModel predicted_light_time(const nav::SwarmState& predicted, double epoch_days)
+{
+    struct Track {
+        nav::Vec3 r;
+        nav::Vec3 v;
+    };
+    std::vector<Track> tracks(predicted.size());
+    for (std::size_t i = 0; i < tracks.size(); ++i) {
+        const nav::StateVector s = predicted.get(i);
+        tracks[i] = {s.r, s.v};
+    }
+    return [tracks = std::move(tracks), epoch_days](std::uint32_t spacecraft, MissionTime t) {
+        const Track& k = tracks.at(spacecraft);
+        const double days = t / seconds_per_day;
+        const nav::Vec3 earth = nav::planet_position(nav::Planet::earth_moon, days);
+        // Earth at emission, the spacecraft at reception: one fixed-point
+        // step, since the craft moves metres during the light time.
+        double light_days = 0.0;
+        for (int pass = 0; pass < 2; ++pass) {
+            const double dt = days + light_days - epoch_days;
+            double d2 = 0.0;
+            for (int a = 0; a < 3; ++a) {
+                const double d = k.r[a] + k.v[a] * dt - earth[a];
+                d2 += d * d;
+            }
+            light_days = std::sqrt(d2) * light_seconds_per_au / seconds_per_day;
+        }
+        return light_days * seconds_per_day;
+    };
+}
+
+void EngineConfig::validate() const
+{
+    if (!(command_gap_s >= 0.0))
+        throw std::invalid_argument("uplink: command gap must be non-negative");
+    if (wave_grain == 0)
+        throw std::invalid_argument("uplink: wave grain must be positive");
+}
+
+UplinkEngine::UplinkEngine(const EngineConfig& config, sched::Scheduler* scheduler)
+    : config_(config)
+    , light_time_(config.light_time ? config.light_time : constant_light_time(650.0))
+    , scheduler_(scheduler)
+{
+    config_.validate();
+}
+
+UplinkEngine::~UplinkEngine()
+{
+    // Destroying a root unwinds its frame, which destroys any child
+    // sequence it was awaiting.
+    for (auto& [id, root] : roots_)
+        root.destroy();
+}
+
+std::uint64_t UplinkEngine::spawn(Sequence sequence, int priority)
+{
+    const Sequence::Handle h = sequence.release();
+    if (!h)
+        throw std::invalid_argument("uplink: empty sequence");
+    std::lock_guard lock(queue_mutex_);
+    auto& p = h.promise();
+    p.engine = this;
+    p.id = next_id_++;
+    p.priority = priority;
+    p.root = h;
+    roots_.emplace(p.id, h);
+    ready_.push_back(h);
+    ++spawned_;
+    const std::size_t live = live_.fetch_add(1, std::memory_order_relaxed) + 1;
+    peak_live_ = std::max<std::uint64_t>(peak_live_, live);
+    return p.id;
+}
+
+void UplinkEngine::add_window(std::uint32_t spacecraft, const ContactWindow& window)
+{
+    if (!(window.end > window.start))
+        throw std::invalid_argument("uplink: contact window must end after it starts");
+    if (!(window.uplink_bps > 0.0))
+        throw std::invalid_argument("uplink: uplink rate must be positive");
+    std::lock_guard lock(queue_mutex_);
+    Craft& craft = crafts_[spacecraft];
+    const auto at = std::upper_bound(craft.slots.begin() + craft.first, craft.slots.end(), window.start,
+                                     [](MissionTime t, const Slot& s) { return t < s.window.start; });
+    craft.slots.insert(at, Slot {window, window.start});
+    // Stalled requests may fit now; grant_uplinks() takes them with the next batch.
+    requests_.insert(requests_.end(), stalled_.begin(), stalled_.end());
+    stalled_.clear();
+}
+
+UplinkEngine::UplinkAwaiter UplinkEngine::uplink(std::uint32_t spacecraft, std::uint32_t bytes)
+{
+    if (bytes == 0)
+        throw std::invalid_argument("uplink: empty command");
+    return {*this, spacecraft, bytes};
+}
+
+void UplinkEngine::schedule(Sequence::Handle h, MissionTime t)
+{
+    std::lock_guard lock(queue_mutex_);
+    timers_.push_back({t, id_of(h), h});
+    std::push_heap(timers_.begin(), timers_.end(), later<Timer>);
+}
+
+void UplinkEngine::make_ready(Sequence::Handle h)
+{
+    std::lock_guard lock(queue_mutex_);
+    ready_.push_back(h);
+}
+
+void UplinkEngine::request(UplinkAwaiter& awaiter, Sequence::Handle h)
+{
+    std::lock_guard lock(queue_mutex_);
+    requests_.push_back({&awaiter, h});
+}
+
+void UplinkEngine::grant_uplinks()
+{
+    std::vector<Request> batch;
+    {
+        std::lock_guard lock(queue_mutex_);
+        if (requests_.empty())
+            return;
+        batch.swap(requests_);
+    }
+    std::sort(batch.begin(), batch.end(), [](const Request& a, const Request& b) {
+        const auto& pa = a.handle.promise();
+        const auto& pb = b.handle.promise();
+        return pa.priority != pb.priority ? pa.priority > pb.priority : pa.id < pb.id;
+    });
+    std::lock_guard lock(queue_mutex_);
+    for (Request& r : batch) {
+        if (grant(r))
+            ++uplinks_;
+        else
+            stalled_.push_back(r);
+    }
+}
+
+bool UplinkEngine::grant(Request& r)
+{
+    const auto it = crafts_.find(r.awaiter->spacecraft);
+    if (it == crafts_.end())
+        return false;
+    Craft& craft = it->second;
+    while (craft.first < craft.slots.size() && craft.slots[craft.first].window.end <= now_)
+        ++craft.first;
+    const double bits = 8.0 * r.awaiter->bytes;
+    for (std::size_t i = craft.first; i < craft.slots.size(); ++i) {
+        Slot& slot = craft.slots[i];
+        const MissionTime start = std::max({slot.window.start, slot.cursor, now_});
+        const MissionTime end = start + bits / slot.window.uplink_bps;
+        if (end > slot.window.end)
+            continue;
+        slot.cursor = end + config_.command_gap_s;
+        r.awaiter->receipt = {slot.window.station, start, end, end + light_time_(r.awaiter->spacecraft, end)};
+        timers_.push_back({end, id_of(r.handle), r.handle});
+        std::push_heap(timers_.begin(), timers_.end(), later<Timer>);
+        return true;
+    }
+    return false;
+}
+
+std::size_t UplinkEngine::run_until(MissionTime horizon)
+{
+    static const perf::Stage stage("uplink.run");
+    perf::ScopedTimer timer(stage);
+
+    std::size_t resumed = 0;
+    std::vector<Sequence::Handle> wave;
+    for (;;) {
+        grant_uplinks();
+        {
+            std::lock_guard lock(queue_mutex_);
+            if (ready_.empty()) {
+                if (timers_.empty() || timers_.front().time > horizon)
+                    break;
+                now_ = timers_.front().time;
+                while (!timers_.empty() && timers_.front().time <= now_) {
+                    std::pop_heap(timers_.begin(), timers_.end(), later<Timer>);
+                    ready_.push_back(timers_.back().handle);
+                    timers_.pop_back();
+                }
+            }
+            wave.swap(ready_);
+        }
+        std::sort(wave.begin(), wave.end(),
+                  [](Sequence::Handle a, Sequence::Handle b) { return id_of(a) < id_of(b); });
+        resume_wave(wave);
+        resumed += wave.size();
+        ++waves_;
+        wave.clear();
+    }
+    if (std::isfinite(horizon) && horizon > now_)
+        now_ = horizon;
+    resumptions_.fetch_add(resumed, std::memory_order_relaxed);
+    return resumed;
+}
+
+void UplinkEngine::resume_wave(std::vector<Sequence::Handle>& wave)
+{
+    if (!scheduler_ || wave.size() <= config_.wave_grain) {
+        for (const Sequence::Handle h : wave)
+            resume_one(h);
+        return;
+    }
+    sched::parallel_for(*scheduler_, 0, wave.size(), config_.wave_grain, [&](std::size_t lo, std::size_t hi) {
+        for (std::size_t i = lo; i < hi; ++i)
+            resume_one(wave[i]);
+    });
+}
+
+void UplinkEngine::resume_one(Sequence::Handle h)
+{
+    // A sequence is in at most one queue at a time, so no other thread
+    // touches this root until the next wave.
+    const Sequence::Handle root = h.promise().root;
+    h.resume();
+    if (root.done())
+        finish(root);
+}
+
+void UplinkEngine::finish(Sequence::Handle root)
+{
+    auto& p = root.promise();
+    if (p.error) {
+        failed_.fetch_add(1, std::memory_order_relaxed);
+        std::string message;
+        try {
+            std::rethrow_exception(p.error);
+        } catch (const std::exception& e) {
+            message = e.what();
+        } catch (...) {
+            message = "unknown exception";
+        }
+        std::lock_guard lock(error_mutex_);
+        if (first_error_.empty())
+            first_error_ = "sequence " + std::to_string(p.id) + ": " + message;
+    }
+    {
+        std::lock_guard lock(queue_mutex_);
+        roots_.erase(p.id);
+    }
+    root.destroy();
+    live_.fetch_sub(1, std::memory_order_relaxed);
+    completed_.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::optional<MissionTime> UplinkEngine::next_event() const
+{
+    std::lock_guard lock(queue_mutex_);
+    if (!ready_.empty() || !requests_.empty())
+        return now_;
+    if (timers_.empty())
+        return std::nullopt;
+    return timers_.front().time;
+}
+
+std::size_t UplinkEngine::stalled() const
+{
+    std::lock_guard lock(queue_mutex_);
+    return stalled_.size();
+}
+
+void UplinkEngine::snapshot_timeline(core::SnapshotWriter& writer, std::string_view section) const
+{
+    std::lock_guard lock(queue_mutex_);
+    std::vector<std::uint32_t> ids;
+    for (const auto& [id, craft] : crafts_)
+        ids.push_back(id);
+    std::sort(ids.begin(), ids.end());
+
+    core::SectionBuilder b;
+    b.put(now_);
+    b.put(next_id_);
+    b.put(static_cast<std::uint32_t>(ids.size()));
+    for (const std::uint32_t id : ids) {
+        const Craft& craft = crafts_.at(id);
+        b.put(id);
+        b.put(static_cast<std::uint32_t>(craft.slots.size() - craft.first));
+        for (std::size_t i = craft.first; i < craft.slots.size(); ++i) {
+            const Slot& slot = craft.slots[i];
+            b.put(slot.window.start);
+            b.put(slot.window.end);
+            b.put(slot.window.station);
+            b.put(slot.window.uplink_bps);
+            b.put(slot.cursor);
+        }
+    }
+    writer.add(section, b);
+}
+
+void UplinkEngine::restore_timeline(const core::Snapshot& snapshot, std::string_view section)
+{
+    std::lock_guard lock(queue_mutex_);
+    if (!crafts_.empty() || spawned_ != 0)
+        throw std::logic_error("uplink: timelines restore only into a fresh engine");
+    core::SectionReader r(snapshot.section(section), section);
+    const auto now = r.get<MissionTime>();
+    const auto next_id = r.get<std::uint64_t>();
+    std::unordered_map<std::uint32_t, Craft> crafts;
+    for (auto n = r.get<std::uint32_t>(); n > 0; --n) {
+        Craft& craft = crafts[r.get<std::uint32_t>()];
+        craft.slots.resize(r.get<std::uint32_t>());
+        for (Slot& slot : craft.slots) {
+            slot.window.start = r.get<MissionTime>();
+            slot.window.end = r.get<MissionTime>();
+            slot.window.station = r.get<std::uint32_t>();
+            slot.window.uplink_bps = r.get<double>();
+            slot.cursor = r.get<MissionTime>();
+        }
+    }
+    if (!r.done())
+        throw std::runtime_error("uplink: trailing bytes in snapshot section " + std::string(section));
+    now_ = now;
+    next_id_ = next_id;
+    crafts_ = std::move(crafts);
+}
+
+EngineStats UplinkEngine::stats() const
+{
+    std::lock_guard lock(queue_mutex_);
+    EngineStats s;
+    s.spawned = spawned_;
+    s.completed = completed_.load(std::memory_order_relaxed);
+    s.failed = failed_.load(std::memory_order_relaxed);
+    s.resumptions = resumptions_.load(std::memory_order_relaxed);
+    s.waves = waves_;
+    s.uplinks = uplinks_;
+    s.peak_live = peak_live_;
+    return s;
+}
+
+std::string UplinkEngine::first_error() const
+{
+    std::lock_guard lock(error_mutex_);
+    return first_error_;
+}
+
+void Event::set()
+{
+    std::vector<Sequence::Handle> waiters;
+    {
+        std::lock_guard lock(mutex_);
+        set_ = true;
+        waiters.swap(waiters_);
+    }
+    for (const Sequence::Handle h : waiters)
+        engine_.make_ready(h);
+}
+
+bool Event::is_set() const
+{
+    std::lock_guard lock(mutex_);
+    return set_;
+}
+
+bool Event::Awaiter::await_suspend(Sequence::Handle h)
+{
+    std::lock_guard lock(event.mutex_);
+    if (event.set_)
+        return false;
+    event.waiters_.push_back(h);
+    return true;
+}
+
+} // namespace solarlens::uplink
@@ -0,0 +1,88 @@
+// solarlens-psf-table: precompute an SGL PSF table file.
+//
+//     solarlens-psf-table OUT [--distance MIN:MAX:COUNT] [--wavelength MIN:MAX:COUNT]
+//                             [--offset MAX:COUNT] [--pitch METRES]
+//
+// Distances are in AU, wavelengths in metres, offsets in map pixels.
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <string>
+
+#include "solarlens/recon/psf_table.hpp"
+
+namespace {
+
+using solarlens::recon::GridAxis;
+
+int usage()
+{
+    std::fprintf(stderr,
+                 "usage: solarlens-psf-table OUT [--distance MIN:MAX:COUNT]"
+                 " [--wavelength MIN:MAX:COUNT] [--offset MAX:COUNT] [--pitch METRES]\n");
+    return 2;
+}
+
+bool parse_axis(const char* text, GridAxis& axis)
+{
+    double min = 0.0;
+    double max = 0.0;
+    unsigned count = 0;
+    if (std::sscanf(text, "%lf:%lf:%u", &min, &max, &count) != 3)
+        return false;
+    axis = {min, max, count};
+    return true;
+}
+
+bool parse_offset(const char* text, GridAxis& axis)
+{
+    double max = 0.0;
+    unsigned count = 0;
+    if (std::sscanf(text, "%lf:%u", &max, &count) != 2)
+        return false;
+    axis = {0.0, max, count};
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+        return usage();
+    solarlens::recon::PsfGridSpec spec;
+    for (int i = 2; i < argc; i += 2) {
+        if (i + 1 >= argc)
+            return usage();
+        const std::string flag = argv[i];
+        const char* value = argv[i + 1];
+        bool ok = false;
+        if (flag == "--distance")
+            ok = parse_axis(value, spec.distance_au);
+        else if (flag == "--wavelength")
+            ok = parse_axis(value, spec.wavelength_m);
+        else if (flag == "--offset")
+            ok = parse_offset(value, spec.offset_px);
+        else if (flag == "--pitch")
+            ok = (spec.pixel_pitch_m = std::atof(value)) > 0.0;
+        if (!ok)
+            return usage();
+    }
+
+    try {
+        const auto start = std::chrono::steady_clock::now();
+        solarlens::recon::build_psf_table(spec, argv[1]);
+        const auto built = std::chrono::steady_clock::now();
+        const auto table = solarlens::recon::PsfTable::open(argv[1]);
+        const auto opened = std::chrono::steady_clock::now();
+        const auto ms = [](auto d) { return std::chrono::duration<double, std::milli>(d).count(); };
+        std::printf("%zu values: built in %.1f ms, mapped in %.3f ms\n", table.values().size(),
+                    ms(built - start), ms(opened - built));
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "solarlens-psf-table: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,658 @@
+// solarlens-replay: replay a recorded pass through the ground pipeline
+// and check it against a baseline.
+//
+//     solarlens-replay RECORDING [--batch-ms B] [--threads T] [--runs N]
+//                      [--json PATH] [--baseline PATH] [--tolerance F]
+//                      [--noise-ms M] [--commit ID]
+//                      [--corona CX,CY,OCC,FIT_IN,FIT_OUT,RING_IN,RING_OUT]
+//
+// Decodes RECORDING (ingest/pass_recording.hpp) as fast as it will go on
+// a virtual clock: the CADUs are cut into the batches a receiver draining
+// its ring every B ms would have seen, from the recorded arrival times
+// alone. Every batch runs ingest and frame reassembly, jitter
+// registration and corona calibration on a T-worker scheduler, exactly as
+// swarm_bench's ground segment does. The corona geometry defaults to the
+// swarm coronagraph's for the frame size. Batching depends only on the
+// recording, and no stage's results depend on the worker count or timing,
+// so every output (packets, frames, shifts, calibrated frames and models)
+// is folded into a SHA-256 digest that must be identical on every run.
+//
+// The pass is replayed N times, each with fresh pipeline state and cleared
+// instrumentation. Throughput and the library's own per-stage profile
+// (perf/) come from the fastest run. Since every run does the same work
+// batch for batch, each batch's latency per stage is its fastest over the
+// runs, which keeps the percentiles steady on a busy host. These go into
+// a JSON report (stdout by default) in the same form as the benches'
+// reports, tagged with --commit so reports can be kept per commit. With
+// --baseline, an earlier report of the same recording is compared with
+// this one. The outputs must match bit for bit. Throughput may not fall,
+// and no stage's p50 or p90 batch latency may rise, by more than the
+// fraction F (default 0.15). Latency changes under M ms (default 0.05) are
+// treated as noise. The p99, the maximum and the profile are reported to
+// show where time went, but are not compared: a pass has too few batches
+// for them to be stable. The comparison is added to the report.
+//
+// Exits 1 if runs disagree, outputs differ from the baseline or a
+// regression is flagged, and 2 for bad arguments or a baseline taken from
+// another recording or with other settings.
+
+#include <algorithm>
+#include <bit>
+#include <cctype>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+#include "solarlens/calib/corona.hpp"
+#include "solarlens/calib/registration.hpp"
+#include "solarlens/core/arena.hpp"
+#include "solarlens/core/digest.hpp"
+#include "solarlens/ingest/pass_recording.hpp"
+#include "solarlens/ingest/pipeline.hpp"
+#include "solarlens/perf/export.hpp"
+#include "solarlens/sched/scheduler.hpp"
+#include "solarlens/sim/image_packets.hpp"
+#include "solarlens/sim/swarm.hpp"
+
+namespace {
+
+using namespace solarlens;
+using Clock = std::chrono::steady_clock;
+
+double seconds_since(Clock::time_point t0)
+{
+    return std::chrono::duration<double>(Clock::now() - t0).count();
+}
+
+int usage()
+{
+    std::fprintf(stderr,
+                 "usage: solarlens-replay RECORDING [--batch-ms B] [--threads T] [--runs N] [--json PATH]\n"
+                 "                        [--baseline PATH] [--tolerance F] [--noise-ms M] [--commit ID]\n"
+                 "                        [--corona CX,CY,OCC,FIT_IN,FIT_OUT,RING_IN,RING_OUT]\n");
+    return 2;
+}
+
+/// Latency samples of one stage, one per batch.
+struct Stage {
+    const char* name;
+    std::vector<double> seconds;
+
+    double total() const
+    {
+        double s = 0.0;
+        for (double v : seconds)
+            s += v;
+        return s;
+    }
+
+    double percentile(double p) const
+    {
+        if (seconds.empty())
+            return 0.0;
+        std::vector<double> sorted = seconds;
+        std::sort(sorted.begin(), sorted.end());
+        const auto rank = static_cast<std::size_t>(std::ceil(p / 100.0 * sorted.size()));
+        return sorted[std::clamp<std::size_t>(rank, 1, sorted.size()) - 1];
+    }
+};
+
+struct Run {
+    double seconds = 0.0;
+    std::uint64_t batches = 0;
+    std::uint64_t overruns = 0; ///< Batches slower than their window.
+    std::uint64_t frames = 0;
+    std::uint64_t registered = 0;
+    std::uint64_t calibrated = 0;
+    ingest::IngestStats ingest;
+    std::vector<Stage> stages;
+    perf::Snapshot profile;
+    core::Digest output;
+};
+
+template <typename T>
+void hash_value(core::Sha256& h, const T& v)
+{
+    h.update(std::as_bytes(std::span(&v, 1)));
+}
+
+Run replay(const ingest::PassRecording& recording, std::uint64_t batch_ns,
+           const std::optional<calib::CoronaGeometry>& corona, sched::Scheduler& scheduler)
+{
+    perf::reset();
+    ingest::IngestPipeline pipeline(recording.link(), &scheduler);
+    ingest::PassReplay pass(recording, batch_ns);
+    sim::FrameAssembler assembler;
+    std::optional<calib::FrameRegistrar> registrar;
+    std::optional<calib::CoronaSubtractor> subtractor;
+    core::PassArena arena;
+    core::Sha256 output;
+
+    Run run;
+    run.stages = {{"batch", {}}, {"ingest", {}}, {"register", {}}, {"calibrate", {}}};
+    Stage& batch = run.stages[0];
+    Stage& ingest_stage = run.stages[1];
+    Stage& register_stage = run.stages[2];
+    Stage& calibrate = run.stages[3];
+    std::vector<core::ImageView<float>> views;
+    std::vector<std::uint32_t> streams;
+    std::vector<calib::FrameShift> shifts;
+    const double window_s = double(batch_ns) * 1e-9;
+
+    const auto start = Clock::now();
+    while (pass.next()) {
+        const auto batch_start = Clock::now();
+        auto t0 = batch_start;
+        pipeline.process(pass.cadus(), [&](std::span<const ingest::PacketRef> packets) {
+            for (const ingest::PacketRef& p : packets) {
+                hash_value(output, p.spacecraft_id);
+                output.update(p.packet.bytes());
+                assembler.add(p);
+            }
+        });
+        std::vector<sim::FrameAssembler::Frame> frames = assembler.take_completed();
+        ingest_stage.seconds.push_back(seconds_since(t0));
+
+        t0 = Clock::now();
+        views.clear();
+        streams.clear();
+        for (auto& f : frames) {
+            views.emplace_back(f.pixels.data(), f.width, f.height);
+            streams.push_back(f.spacecraft);
+            hash_value(output, f.spacecraft);
+            hash_value(output, f.index);
+            output.update(std::as_bytes(std::span(f.pixels)));
+        }
+        if (!frames.empty() && !registrar) {
+            // Sized from the first frame, as swarm_bench sizes its own.
+            const std::uint32_t n = frames.front().width;
+            calib::RegistrationConfig reg_cfg;
+            reg_cfg.size = std::uint32_t(1) << (31 - std::countl_zero(std::min(n, frames.front().height)));
+            reg_cfg.band = reg_cfg.size / 4;
+            registrar.emplace(reg_cfg);
+            subtractor.emplace(corona ? *corona : sim::coronagraph_geometry(n, sim::SwarmConfig {}.ring_width_px));
+        }
+        shifts.assign(frames.size(), {});
+        if (!frames.empty())
+            registrar->process(views, streams, shifts, scheduler);
+        for (const calib::FrameShift& s : shifts) {
+            hash_value(output, s.dx);
+            hash_value(output, s.dy);
+            hash_value(output, s.peak);
+            hash_value(output, s.registered);
+            run.registered += s.registered;
+        }
+        register_stage.seconds.push_back(seconds_since(t0));
+
+        t0 = Clock::now();
+        if (!frames.empty()) {
+            const std::vector<core::ImageView<const float>> raw(views.begin(), views.end());
+            const calib::CalibratedFrames calibrated = calib::calibrate_frames(*subtractor, raw, arena, scheduler);
+            for (std::size_t i = 0; i < frames.size(); ++i) {
+                const core::ImageView<float>& f = calibrated.frames[i];
+                output.update(std::as_bytes(std::span(f.data, std::size_t(f.width) * f.height)));
+                hash_value(output, calibrated.models[i].coeffs);
+                hash_value(output, calibrated.models[i].fit_pixels);
+            }
+            run.calibrated += calibrated.succeeded;
+        }
+        arena.reset();
+        calibrate.seconds.push_back(seconds_since(t0));
+
+        run.frames += frames.size();
+        const double dt = seconds_since(batch_start);
+        batch.seconds.push_back(dt);
+        run.overruns += dt > window_s;
+    }
+    run.seconds = seconds_since(start);
+    run.batches = pass.batches();
+    run.ingest = pipeline.stats();
+    run.profile = perf::snapshot();
+    run.output = output.finish();
+    return run;
+}
+
+// Flattens a JSON document into "a.b.c" -> text: strings unescaped,
+// numbers and literals as written, array elements as "a.0". Enough to
+// read back the reports this tool writes.
+class FlatJson {
+public:
+    explicit FlatJson(const std::string& text)
+        : text_(text)
+    {
+        value("");
+        skip_space();
+        if (at_ != text_.size())
+            fail();
+    }
+
+    const std::string* find(const std::string& key) const
+    {
+        const auto it = values_.find(key);
+        return it == values_.end() ? nullptr : &it->second;
+    }
+
+    std::optional<double> number(const std::string& key) const
+    {
+        const std::string* v = find(key);
+        if (v == nullptr)
+            return std::nullopt;
+        char* end = nullptr;
+        const double d = std::strtod(v->c_str(), &end);
+        return end != v->c_str() && *end == '\0' ? std::optional(d) : std::nullopt;
+    }
+
+private:
+    [[noreturn]] void fail() const
+    {
+        throw std::runtime_error("malformed JSON at byte " + std::to_string(at_));
+    }
+
+    char peek() const noexcept { return at_ < text_.size() ? text_[at_] : '\0'; }
+
+    void skip_space()
+    {
+        while (peek() == ' ' || peek() == '\n' || peek() == '\r' || peek() == '\t')
+            ++at_;
+    }
+
+    void expect(char c)
+    {
+        skip_space();
+        if (peek() != c)
+            fail();
+        ++at_;
+    }
+
+    std::string string()
+    {
+        expect('"');
+        std::string out;
+        while (peek() != '"') {
+            if (at_ == text_.size() || static_cast<unsigned char>(peek()) < 0x20)
+                fail();
+            const char c = text_[at_++];
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            static constexpr std::string_view from = "\"\\/bfnrt";
+            static constexpr std::string_view to = "\"\\/\b\f\n\r\t";
+            const char e = peek();
+            ++at_;
+            if (e == 'u')
+                append_utf8(out, code_point());
+            else if (const std::size_t k = from.find(e); e != '\0' && k != from.npos)
+                out += to[k];
+            else
+                fail();
+        }
+        ++at_;
+        return out;
+    }
+
+    std::uint32_t hex4()
+    {
+        if (text_.size() - at_ < 4)
+            fail();
+        std::uint32_t v = 0;
+        for (int i = 0; i < 4; ++i) {
+            const char c = text_[at_++];
+            v <<= 4;
+            if (c >= '0' && c <= '9')
+                v |= std::uint32_t(c - '0');
+            else if (c >= 'a' && c <= 'f')
+                v |= std::uint32_t(c - 'a' + 10);
+            else if (c >= 'A' && c <= 'F')
+                v |= std::uint32_t(c - 'A' + 10);
+            else
+                fail();
+        }
+        return v;
+    }
+
+    // After "\u": one code unit, or a surrogate pair spelled as two escapes.
+    std::uint32_t code_point()
+    {
+        const std::uint32_t high = hex4();
+        if (high >= 0xDC00 && high <= 0xDFFF)
+            fail();
+        if (high < 0xD800 || high > 0xDBFF)
+            return high;
+        if (text_.compare(at_, 2, "\\u") != 0)
+            fail();
+        at_ += 2;
+        const std::uint32_t low = hex4();
+        if (low < 0xDC00 || low > 0xDFFF)
+            fail();
+        return 0x10000 + ((high - 0xD800) << 10) + (low - 0xDC00);
+    }
+
+    static void append_utf8(std::string& out, std::uint32_t cp)
+    {
+        if (cp < 0x80) {
+            out += char(cp);
+        } else if (cp < 0x800) {
+            out += char(0xC0 | cp >> 6);
+            out += char(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            out += char(0xE0 | cp >> 12);
+            out += char(0x80 | (cp >> 6 & 0x3F));
+            out += char(0x80 | (cp & 0x3F));
+        } else {
+            out += char(0xF0 | cp >> 18);
+            out += char(0x80 | (cp >> 12 & 0x3F));
+            out += char(0x80 | (cp >> 6 & 0x3F));
+            out += char(0x80 | (cp & 0x3F));
+        }
+    }
+
+    void value(const std::string& path)
+    {
+        skip_space();
+        const std::string prefix = path.empty() ? path : path + '.';
+        if (peek() == '{') {
+            ++at_;
+            skip_space();
+            if (peek() == '}') {
+                ++at_;
+                return;
+            }
+            do {
+                const std::string key = string();
+                expect(':');
+                value(prefix + key);
+                skip_space();
+            } while (peek() == ',' && ++at_);
+            expect('}');
+        } else if (peek() == '[') {
+            ++at_;
+            skip_space();
+            if (peek() == ']') {
+                ++at_;
+                return;
+            }
+            std::size_t i = 0;
+            do {
+                value(prefix + std::to_string(i++));
+                skip_space();
+            } while (peek() == ',' && ++at_);
+            expect(']');
+        } else if (peek() == '"') {
+            values_[path] = string();
+        } else {
+            const std::size_t first = at_;
+            while (std::isalnum(static_cast<unsigned char>(peek())) || peek() == '-' || peek() == '+'
+                   || peek() == '.')
+                ++at_;
+            if (at_ == first)
+                fail();
+            values_[path] = text_.substr(first, at_ - first);
+        }
+    }
+
+    const std::string& text_;
+    std::size_t at_ = 0;
+    std::map<std::string, std::string> values_;
+};
+
+struct Metric {
+    std::string key;
+    double value = 0.0;
+    bool higher_is_better = false;
+};
+
+struct Change {
+    std::string key;
+    double baseline = 0.0;
+    double current = 0.0;
+};
+
+std::string escaped(const std::string& text)
+{
+    std::string out;
+    for (char c : text) {
+        if (static_cast<unsigned char>(c) < 0x20) {
+            char code[7];
+            std::snprintf(code, sizeof code, "\\u%04x", static_cast<unsigned>(c));
+            out += code;
+            continue;
+        }
+        if (c == '\\' || c == '"')
+            out += '\\';
+        out += c;
+    }
+    return out;
+}
+
+void write_stage(std::FILE* out, const std::string& name, const char* unit, std::uint64_t count, double total_s,
+                 double p50, double p90, double p99, double max, bool last)
+{
+    std::fprintf(out,
+                 "    \"%s\": {\"unit\": \"%s\", \"count\": %llu, \"total_s\": %.6f, "
+                 "\"p50_ms\": %.4f, \"p90_ms\": %.4f, \"p99_ms\": %.4f, \"max_ms\": %.4f}%s\n",
+                 escaped(name).c_str(), unit, static_cast<unsigned long long>(count), total_s, 1e3 * p50, 1e3 * p90,
+                 1e3 * p99, 1e3 * max, last ? "" : ",");
+}
+
+} // namespace
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argv[1][0] == '-')
+        return usage();
+    const std::string recording_path = argv[1];
+    double batch_ms = 100.0;
+    unsigned threads = std::thread::hardware_concurrency();
+    unsigned runs = 3;
+    std::string json_path;
+    std::string baseline_path;
+    std::string commit;
+    double tolerance = 0.15;
+    double noise_ms = 0.05;
+    std::optional<calib::CoronaGeometry> corona;
+    for (int i = 2; i < argc; i += 2) {
+        if (i + 1 >= argc)
+            return usage();
+        const std::string flag = argv[i];
+        const char* value = argv[i + 1];
+        if (flag == "--batch-ms")
+            batch_ms = std::atof(value);
+        else if (flag == "--threads")
+            threads = static_cast<unsigned>(std::atoi(value));
+        else if (flag == "--runs")
+            runs = static_cast<unsigned>(std::atoi(value));
+        else if (flag == "--json")
+            json_path = value;
+        else if (flag == "--baseline")
+            baseline_path = value;
+        else if (flag == "--tolerance")
+            tolerance = std::atof(value);
+        else if (flag == "--noise-ms")
+            noise_ms = std::atof(value);
+        else if (flag == "--commit")
+            commit = value;
+        else if (flag == "--corona") {
+            calib::CoronaGeometry g;
+            if (std::sscanf(value, "%f,%f,%f,%f,%f,%f,%f", &g.centre_x, &g.centre_y, &g.occulter, &g.fit_inner,
+                            &g.fit_outer, &g.ring_inner, &g.ring_outer)
+                != 7)
+                return usage();
+            corona = g;
+        } else
+            return usage();
+    }
+    const auto batch_ns = static_cast<std::uint64_t>(std::llround(batch_ms * 1e6));
+    if (batch_ns == 0 || runs == 0 || !(tolerance >= 0) || !(noise_ms >= 0))
+        return usage();
+    threads = std::max(1u, threads);
+
+    try {
+        const ingest::PassRecording recording(recording_path);
+        const std::string recording_digest = core::sha256(recording.bytes()).hex();
+        sched::Scheduler scheduler(threads);
+
+        std::vector<Run> results;
+        for (unsigned r = 0; r < runs; ++r)
+            results.push_back(replay(recording, batch_ns, corona, scheduler));
+        const bool deterministic = std::all_of(results.begin(), results.end(),
+                                               [&](const Run& r) { return r.output == results.front().output; });
+        const Run& best = *std::min_element(results.begin(), results.end(),
+                                            [](const Run& a, const Run& b) { return a.seconds < b.seconds; });
+        // Every run does the same work batch for batch, so each batch's
+        // fastest time over the runs is its time without interference.
+        std::vector<Stage> stages = results.front().stages;
+        for (const Run& r : results)
+            for (std::size_t i = 0; i < stages.size(); ++i)
+                for (std::size_t b = 0; b < stages[i].seconds.size(); ++b)
+                    stages[i].seconds[b] = std::min(stages[i].seconds[b], r.stages[i].seconds[b]);
+        const double pass_s = double(recording.duration_ns()) * 1e-9 + double(batch_ns) * 1e-9;
+        const double cadus_per_second = best.seconds > 0 ? double(recording.count()) / best.seconds : 0.0;
+        const double mbps = cadus_per_second * double(recording.link().cadu_size()) * 8e-6;
+
+        // Everything the baseline comparison looks at.
+        std::vector<Metric> metrics = {{"cadus_per_second", cadus_per_second, true}};
+        for (const Stage& s : stages) {
+            metrics.push_back({std::string("stages.") + s.name + ".p50_ms", 1e3 * s.percentile(50), false});
+            metrics.push_back({std::string("stages.") + s.name + ".p90_ms", 1e3 * s.percentile(90), false});
+        }
+
+        std::optional<FlatJson> baseline;
+        std::vector<Change> regressions;
+        bool baseline_exact = true;
+        if (!baseline_path.empty()) {
+            std::ifstream in(baseline_path, std::ios::binary);
+            if (!in)
+                throw std::runtime_error("cannot read baseline " + baseline_path);
+            const std::string text(std::istreambuf_iterator<char>(in), {});
+            try {
+                baseline.emplace(text);
+            } catch (const std::runtime_error& e) {
+                throw std::runtime_error("baseline " + baseline_path + ": " + e.what());
+            }
+            const std::string* digest = baseline->find("recording_digest");
+            if (digest == nullptr || *digest != recording_digest) {
+                std::fprintf(stderr, "solarlens-replay: baseline %s is not a replay of %s\n", baseline_path.c_str(),
+                             recording_path.c_str());
+                return 2;
+            }
+            if (baseline->number("config.batch_ms") != batch_ms
+                || baseline->number("config.threads") != double(threads)) {
+                std::fprintf(stderr, "solarlens-replay: baseline %s used another batch window or thread count\n",
+                             baseline_path.c_str());
+                return 2;
+            }
+            const std::string* output = baseline->find("output_digest");
+            baseline_exact = output != nullptr && *output == best.output.hex();
+            for (const Metric& m : metrics) {
+                const std::optional<double> base = baseline->number(m.key);
+                if (!base)
+                    continue;
+                const bool worse = m.higher_is_better
+                                       ? m.value < *base * (1.0 - tolerance)
+                                       : m.value > *base * (1.0 + tolerance) && m.value - *base > noise_ms;
+                if (worse)
+                    regressions.push_back({m.key, *base, m.value});
+            }
+        }
+
+        std::FILE* out = json_path.empty() ? stdout : std::fopen(json_path.c_str(), "w");
+        if (out == nullptr) {
+            std::perror(json_path.c_str());
+            return 1;
+        }
+        std::fprintf(out, "{\n  \"benchmark\": \"replay\",\n");
+        std::fprintf(out,
+                     "  \"config\": {\"recording\": \"%s\", \"commit\": \"%s\", \"batch_ms\": %.17g, "
+                     "\"threads\": %u, \"runs\": %u, \"cadus\": %zu, \"cadu_bytes\": %zu, \"pass_seconds\": %.6f},\n",
+                     escaped(recording_path).c_str(), escaped(commit).c_str(), batch_ms, threads, runs,
+                     recording.count(), recording.link().cadu_size(), pass_s);
+        std::fprintf(out, "  \"recording_digest\": \"%s\",\n  \"output_digest\": \"%s\",\n  \"deterministic\": %s,\n",
+                     recording_digest.c_str(), best.output.hex().c_str(), deterministic ? "true" : "false");
+        std::fprintf(out, "  \"cadus_per_second\": %.3f,\n  \"megabits_per_second\": %.3f,\n", cadus_per_second,
+                     mbps);
+        std::fprintf(out, "  \"processing_seconds\": %.6f,\n  \"real_time_factor\": %.3f,\n", best.seconds,
+                     best.seconds > 0 ? pass_s / best.seconds : 0.0);
+        std::fprintf(out, "  \"run_seconds\": [");
+        for (std::size_t r = 0; r < results.size(); ++r)
+            std::fprintf(out, "%s%.6f", r ? ", " : "", results[r].seconds);
+        std::fprintf(out, "],\n  \"batches\": %llu,\n  \"overruns\": %llu,\n",
+                     static_cast<unsigned long long>(best.batches), static_cast<unsigned long long>(best.overruns));
+        std::fprintf(out, "  \"stages\": {\n");
+        for (std::size_t i = 0; i < stages.size(); ++i) {
+            const Stage& s = stages[i];
+            write_stage(out, s.name, "batch", s.seconds.size(), s.total(), s.percentile(50), s.percentile(90),
+                        s.percentile(99), s.percentile(100), i + 1 == stages.size());
+        }
+        std::fprintf(out, "  },\n  \"profile\": {\n");
+        std::vector<const perf::StageSnapshot*> profiled;
+        for (const perf::StageSnapshot& s : best.profile.stages)
+            if (s.nanoseconds.count() != 0)
+                profiled.push_back(&s);
+        for (std::size_t i = 0; i < profiled.size(); ++i) {
+            const perf::HdrHistogram& h = profiled[i]->nanoseconds;
+            write_stage(out, profiled[i]->name, "call", h.count(), 1e-9 * double(h.sum()),
+                        1e-9 * double(h.value_at_quantile(0.5)), 1e-9 * double(h.value_at_quantile(0.9)),
+                        1e-9 * double(h.value_at_quantile(0.99)), 1e-9 * double(h.max()), i + 1 == profiled.size());
+        }
+        const ingest::IngestStats& is = best.ingest;
+        std::fprintf(out, "  },\n");
+        std::fprintf(out,
+                     "  \"ingest\": {\"cadus\": %llu, \"frames\": %llu, \"packets\": %llu, "
+                     "\"reassembled\": %llu, \"rs_corrected\": %llu, \"rs_failed\": %llu, "
+                     "\"crc_failed\": %llu, \"packets_dropped\": %llu},\n",
+                     static_cast<unsigned long long>(is.cadus), static_cast<unsigned long long>(is.frames),
+                     static_cast<unsigned long long>(is.packets), static_cast<unsigned long long>(is.reassembled),
+                     static_cast<unsigned long long>(is.rs_corrected),
+                     static_cast<unsigned long long>(is.rs_failed), static_cast<unsigned long long>(is.crc_failed),
+                     static_cast<unsigned long long>(is.packets_dropped));
+        std::fprintf(out, "  \"images\": {\"assembled\": %llu, \"registered\": %llu, \"calibrated\": %llu}%s\n",
+                     static_cast<unsigned long long>(best.frames), static_cast<unsigned long long>(best.registered),
+                     static_cast<unsigned long long>(best.calibrated), baseline ? "," : "");
+        if (baseline) {
+            const std::string* base_commit = baseline->find("config.commit");
+            std::fprintf(out,
+                         "  \"baseline\": {\"path\": \"%s\", \"commit\": \"%s\", \"exact\": %s, "
+                         "\"regressions\": [",
+                         escaped(baseline_path).c_str(), base_commit ? escaped(*base_commit).c_str() : "",
+                         baseline_exact ? "true" : "false");
+            for (std::size_t i = 0; i < regressions.size(); ++i)
+                std::fprintf(out, "%s\n    {\"metric\": \"%s\", \"baseline\": %.6g, \"current\": %.6g}", i ? "," : "",
+                             escaped(regressions[i].key).c_str(), regressions[i].baseline, regressions[i].current);
+            std::fprintf(out, "%s]}\n", regressions.empty() ? "" : "\n  ");
+        }
+        std::fprintf(out, "}\n");
+        if (out != stdout)
+            std::fclose(out);
+
+        int status = 0;
+        if (!deterministic) {
+            std::fprintf(stderr, "solarlens-replay: outputs differ between runs\n");
+            status = 1;
+        }
+        if (!baseline_exact) {
+            std::fprintf(stderr, "solarlens-replay: outputs differ from baseline %s\n", baseline_path.c_str());
+            status = 1;
+        }
+        for (const Change& c : regressions) {
+            std::fprintf(stderr, "solarlens-replay: regression in %s: %.6g -> %.6g (%+.1f%%)\n", c.key.c_str(),
+                         c.baseline, c.current, c.baseline != 0 ? 100.0 * (c.current / c.baseline - 1.0) : 0.0);
+            status = 1;
+        }
+        return status;
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "solarlens-replay: %s\n", e.what());
+        return 1;
+    }
+}
@@ -0,0 +1,46 @@
+// solarlens-tm-dict: generate compiled housekeeping decoders from a
+// telemetry dictionary.
+//
+//     solarlens-tm-dict DICTIONARY OUT.hpp
+//
+// OUT.hpp is only rewritten when its contents change, so regenerating an
+// unchanged dictionary does not trigger a rebuild of its users.
+
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <string>
+
+#include "solarlens/tm/dictionary.hpp"
+
+int main(int argc, char** argv)
+{
+    if (argc != 3) {
+        std::fprintf(stderr, "usage: solarlens-tm-dict DICTIONARY OUT.hpp\n");
+        return 2;
+    }
+    try {
+        const auto dictionary = solarlens::tm::load_dictionary(argv[1]);
+        std::ostringstream header;
+        solarlens::tm::write_decoder_header(dictionary, header);
+        const std::string text = header.str();
+
+        std::ifstream existing(argv[2], std::ios::binary);
+        if (existing && std::string(std::istreambuf_iterator<char>(existing), {}) == text)
+            return 0;
+        existing.close();
+        std::ofstream out(argv[2], std::ios::binary | std::ios::trunc);
+        if (!(out << text) || !out.flush()) {
+            std::fprintf(stderr, "solarlens-tm-dict: cannot write %s\n", argv[2]);
+            return 1;
+        }
+        std::printf("%s: %zu packets, %zu parameters\n", dictionary.name.c_str(),
+                    dictionary.packets.size(), dictionary.parameter_count());
+    } catch (const std::exception& e) {
+        std::fprintf(stderr, "solarlens-tm-dict: %s\n", e.what());
+        return 1;
+    }
+    return 0;
+}